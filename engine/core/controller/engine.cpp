@@ -220,6 +220,7 @@ namespace FIFE {
 		m_renderbackend->setImageCompressingEnabled(m_settings.isGLCompressImages());
 		m_renderbackend->setFramebufferEnabled(m_settings.isGLUseFramebuffer());
 		m_renderbackend->setNPOTEnabled(m_settings.isGLUseNPOT());
+		m_renderbackend->setVertexBuffersEnabled(m_settings.isGLUseVertexBuffers());
 		m_renderbackend->setTextureFiltering(m_settings.getGLTextureFiltering());
 		m_renderbackend->setMipmappingEnabled(m_settings.isGLUseMipmapping());
 		m_renderbackend->setMonochromeEnabled(m_settings.isGLUseMonochrome());
@@ -230,6 +231,9 @@ namespace FIFE {
 			m_renderbackend->setFrameLimitEnabled(true);
 			m_renderbackend->setFrameLimit(m_settings.getFrameLimit());
 		}
+		m_renderbackend->setDirtyRectsEnabled(m_settings.isDirtyRectsEnabled());
+		m_renderbackend->setAlphaMasksEnabled(m_settings.isAlphaMasksEnabled());
+		m_renderbackend->setAlphaMaskThreshold(m_settings.getAlphaMaskThreshold());
 
 		std::string driver = m_settings.getVideoDriver();
 		if (driver != ""){
@@ -363,6 +367,7 @@ namespace FIFE {
 	void Engine::pump() {
 		m_renderbackend->startFrame();
 		m_eventmanager->processEvents();
+		m_cursor->updateDirtyArea();
 		m_timemanager->update();
 		m_soundmanager->update();
 
@@ -76,6 +76,8 @@ namespace FIFE {
 		bool isGLUseFramebuffer() const;
 		void setGLUseNPOT(bool oglusenpot);
 		bool isGLUseNPOT() const;
+		void setGLUseVertexBuffers(bool oglusevertexbuffers);
+		bool isGLUseVertexBuffers() const;
 		void setGLTextureFiltering(FIFE::TextureFiltering filter);
 		FIFE::TextureFiltering getGLTextureFiltering() const;
 		void setGLUseMipmapping(bool mipmapping);
@@ -112,6 +114,12 @@ namespace FIFE {
 		bool isFrameLimitEnabled() const;
 		void setFrameLimit(uint16_t framelimit);
 		uint16_t getFrameLimit() const;
+		void setDirtyRectsEnabled(bool enabled);
+		bool isDirtyRectsEnabled() const;
+		void setAlphaMasksEnabled(bool enabled);
+		bool isAlphaMasksEnabled() const;
+		void setAlphaMaskThreshold(uint8_t threshold);
+		uint8_t getAlphaMaskThreshold() const;
 		void setMouseSensitivity(float sens);
 		float getMouseSensitivity() const;
 		void setMouseAccelerationEnabled(bool acceleration);
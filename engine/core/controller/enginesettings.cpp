@@ -56,6 +56,7 @@ namespace FIFE {
 		m_oglcompressimages(false),
 		m_ogluseframebuffer(true),
 		m_oglusenpot(true),
+		m_oglusevertexbuffers(false),
 		m_oglMipmapping(false),
 		m_oglMonochrome(false),
 		m_oglTextureFilter(TEXTURE_FILTER_NONE),
@@ -72,6 +73,9 @@ namespace FIFE {
 		m_lighting(0),
 		m_isframelimit(false),
 		m_framelimit(60),
+		m_dirtyRects(false),
+		m_alphaMasks(false),
+		m_alphaMaskThreshold(1),
 		m_mousesensitivity(0.0),
 		m_mouseacceleration(false),
 		m_nativeimagecursor(false),
@@ -173,6 +177,10 @@ namespace FIFE {
 		m_oglusenpot = oglusenpot;
 	}
 
+	void EngineSettings::setGLUseVertexBuffers(bool oglusevertexbuffers) {
+		m_oglusevertexbuffers = oglusevertexbuffers;
+	}
+
 	void EngineSettings::setGLTextureFiltering(TextureFiltering filter) {
 		m_oglTextureFilter = filter;
 	}
@@ -296,6 +304,30 @@ namespace FIFE {
 		return m_framelimit;
 	}
 
+	void EngineSettings::setDirtyRectsEnabled(bool enabled) {
+		m_dirtyRects = enabled;
+	}
+
+	bool EngineSettings::isDirtyRectsEnabled() const {
+		return m_dirtyRects;
+	}
+
+	void EngineSettings::setAlphaMasksEnabled(bool enabled) {
+		m_alphaMasks = enabled;
+	}
+
+	bool EngineSettings::isAlphaMasksEnabled() const {
+		return m_alphaMasks;
+	}
+
+	void EngineSettings::setAlphaMaskThreshold(uint8_t threshold) {
+		m_alphaMaskThreshold = threshold;
+	}
+
+	uint8_t EngineSettings::getAlphaMaskThreshold() const {
+		return m_alphaMaskThreshold;
+	}
+
 	void EngineSettings::setMouseSensitivity(float sens) {
 		m_mousesensitivity = sens;
 	}
@@ -206,6 +206,16 @@ namespace FIFE {
 			return m_oglusenpot;
 		}
 
+		/** Sets if OpenGL renderbackend should stream the vertex data through buffer objects (when available)
+		*/
+		void setGLUseVertexBuffers(bool oglusevertexbuffers);
+
+		/** Tells if OpenGL renderbackend should stream the vertex data through buffer objects
+		*/
+		bool isGLUseVertexBuffers() const {
+			return m_oglusevertexbuffers;
+		}
+
 		/** Sets texture filtering method for OpenGL renderbackend.
 		 */
 		void setGLTextureFiltering(TextureFiltering filter);
@@ -394,6 +404,30 @@ namespace FIFE {
 		 */
 		uint16_t getFrameLimit() const;
 
+		/** Sets whether only the damaged screen areas are redrawn, only supported by the SDL backend
+		 */
+		void setDirtyRectsEnabled(bool enabled);
+
+		/** Gets whether only the damaged screen areas are redrawn
+		 */
+		bool isDirtyRectsEnabled() const;
+
+		/** Sets whether the alpha masks of images are built when the images are loaded
+		 */
+		void setAlphaMasksEnabled(bool enabled);
+
+		/** Gets whether the alpha masks of images are built when the images are loaded
+		 */
+		bool isAlphaMasksEnabled() const;
+
+		/** Sets the minimum alpha of the pixels that are set in the alpha masks of images
+		 */
+		void setAlphaMaskThreshold(uint8_t threshold);
+
+		/** Gets the minimum alpha of the pixels that are set in the alpha masks of images
+		 */
+		uint8_t getAlphaMaskThreshold() const;
+
 		/** Sets mouse sensitivity
 		 */
 		void setMouseSensitivity(float sens);
@@ -445,6 +479,7 @@ namespace FIFE {
 		bool m_oglcompressimages;
 		bool m_ogluseframebuffer;
 		bool m_oglusenpot;
+		bool m_oglusevertexbuffers;
 		bool m_oglMipmapping;
 		bool m_oglMonochrome;
 		TextureFiltering m_oglTextureFilter;
@@ -465,6 +500,9 @@ namespace FIFE {
 		uint32_t m_lighting;
 		bool m_isframelimit;
 		uint16_t m_framelimit;
+		bool m_dirtyRects;
+		bool m_alphaMasks;
+		uint8_t m_alphaMaskThreshold;
 		float m_mousesensitivity;
 		bool m_mouseacceleration;
 		bool m_nativeimagecursor;
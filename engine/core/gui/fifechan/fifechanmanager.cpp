@@ -110,7 +110,7 @@ namespace FIFE {
 				m_had_widget = overWidget;
 			case SDL_MOUSEBUTTONUP:
 				// Always send the button up/down events to fifechan 
-				m_input->pushInput(evt);
+				pushInput(evt);
 
 				// Button was pressed over a widget and still is over a widget
 				// so we mark the event as processed.
@@ -134,14 +134,14 @@ namespace FIFE {
 				m_lastMotionY = evt.motion.y;
 				if (m_fcn_topcontainer->getWidgetAt(evt.motion.x,evt.motion.y)) {
 					m_had_mouse = true;
-					m_input->pushInput(evt);
+					pushInput(evt);
 					return true;
 				}
 				if( m_had_mouse ) {
 					// We only keep the mouse if a widget/window has requested
 					// dragging.
 					m_had_mouse = m_focushandler->getDraggedWidget() != 0;
-					m_input->pushInput(evt);
+					pushInput(evt);
 					return true;
 				}
 				return false;
@@ -149,19 +149,19 @@ namespace FIFE {
 			case SDL_KEYDOWN:
 			case SDL_KEYUP:
 				if(m_focushandler->getFocused()) {
-					m_input->pushInput(evt);
+					pushInput(evt);
 					return true;
 				}
 				return false;
 
 			case SDL_TEXTINPUT:
 				// don't consume TEXTINPUT
-				m_input->pushInput(evt);
+				pushInput(evt);
 				return false;
 
 			case SDL_WINDOWEVENT:
 				// don't consume WINDOWEVENTS
-				m_input->pushInput(evt);
+				pushInput(evt);
 				return false;
 
 			default:
@@ -169,6 +169,47 @@ namespace FIFE {
 		}
 	}
 
+	void FifechanManager::pushInput(SDL_Event& evt) {
+		m_input->pushInput(evt);
+		invalidateWidgetAreas();
+	}
+
+	void FifechanManager::getWidgetAreas(std::vector<Rect>& areas) const {
+		areas.clear();
+		std::set<fcn::Widget*>::const_iterator it = m_widgets.begin();
+		for (; it != m_widgets.end(); ++it) {
+			if ((*it)->isVisible()) {
+				int32_t x = 0;
+				int32_t y = 0;
+				(*it)->getAbsolutePosition(x, y);
+				areas.push_back(Rect(x, y, (*it)->getWidth(), (*it)->getHeight()));
+			}
+		}
+		if (m_console && m_console->isVisible()) {
+			int32_t x = 0;
+			int32_t y = 0;
+			m_console->getAbsolutePosition(x, y);
+			areas.push_back(Rect(x, y, m_console->getWidth(), m_console->getHeight()));
+		}
+	}
+
+	void FifechanManager::invalidateWidgetAreas() {
+		RenderBackend* renderbackend = RenderBackend::instance();
+		if (!renderbackend->isDirtyRectsEnabled()) {
+			return;
+		}
+		std::vector<Rect> areas;
+		getWidgetAreas(areas);
+		std::vector<Rect>::const_iterator it = m_widgetAreas.begin();
+		for (; it != m_widgetAreas.end(); ++it) {
+			renderbackend->addDirtyRect(*it);
+		}
+		for (it = areas.begin(); it != areas.end(); ++it) {
+			renderbackend->addDirtyRect(*it);
+		}
+		m_widgetAreas.swap(areas);
+	}
+
 	void FifechanManager::resizeTopContainer(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
 		if (m_backend == "SDL") {
 			static_cast<SdlGuiGraphics*>(m_gui_graphics)->updateTarget();
@@ -190,6 +231,7 @@ namespace FIFE {
 		if( !m_widgets.count(widget) ) {
 			m_fcn_topcontainer->add(widget);
 			m_widgets.insert(widget);
+			invalidateWidgetAreas();
 		}
 	}
 
@@ -197,6 +239,7 @@ namespace FIFE {
 		if( m_widgets.count(widget) ) {
 			m_widgets.erase(widget);
 			m_fcn_topcontainer->remove(widget);
+			invalidateWidgetAreas();
 		}
 	}
 
@@ -298,6 +341,14 @@ namespace FIFE {
 		if (!m_logic_executed)
 			m_fcn_gui->logic();
 		m_logic_executed = false;
+		// widgets that were moved by the logic are updated in the next frame
+		if (RenderBackend::instance()->isDirtyRectsEnabled()) {
+			std::vector<Rect> areas;
+			getWidgetAreas(areas);
+			if (areas != m_widgetAreas) {
+				invalidateWidgetAreas();
+			}
+		}
 		m_fcn_gui->draw();
 	}
 
@@ -24,6 +24,7 @@
 
 // Standard C++ library includes
 #include <set>
+#include <vector>
 
 // 3rd party library includes
 #include <fifechan.hpp>
@@ -34,6 +35,7 @@
 // Second block: files included from the same folder
 #include "util/base/fife_stdint.h"
 #include "util/base/singleton.h"
+#include "util/structures/rect.h"
 #include "eventchannel/sdl/isdleventlistener.h"
 
 #include "gui/guimanager.h"
@@ -197,6 +199,18 @@ namespace FIFE {
 		protected:
 			static int32_t convertFifechanKeyToFifeKey(int32_t value);
 
+			/** Pushes the event to fifechan and marks the widget areas as dirty.
+			 */
+			void pushInput(SDL_Event& evt);
+
+			/** Gets the screen areas of the visible top level widgets.
+			 */
+			void getWidgetAreas(std::vector<Rect>& areas) const;
+
+			/** Marks the last and the current widget areas as dirty, in dirty rect mode.
+			 */
+			void invalidateWidgetAreas();
+
 		private:
 			// The Fifechan GUI.
 			fcn::Gui* m_fcn_gui;
@@ -220,6 +234,8 @@ namespace FIFE {
 			std::vector<GuiFont*> m_fonts;
 			// Added widgets
 			std::set<fcn::Widget*> m_widgets;
+			// Screen areas of the visible widgets, in dirty rect mode
+			std::vector<Rect> m_widgetAreas;
 
 			// Used to accept mouse motion events that leave widget space
 			bool m_had_mouse;
@@ -41,6 +41,7 @@
 #include "util/resource/resourcemanager.h"
 
 #include "animationloader.h"
+#include "xmldocumentcache.h"
 
 namespace FIFE {
 	/** Logger to use for this source file.
@@ -49,40 +50,48 @@ namespace FIFE {
 	static Logger _log(LM_NATIVE_LOADERS);
 
 	AnimationLoader::AnimationLoader(VFS* vfs, ImageManager* imageManager, AnimationManager* animationManager)
-	: m_vfs(vfs), m_imageManager(imageManager), m_animationManager(animationManager) {
+	: m_vfs(vfs), m_imageManager(imageManager), m_animationManager(animationManager), m_documentCache(0) {
 
 	}
 
+	void AnimationLoader::setDocumentCache(XmlDocumentCache* cache) {
+		m_documentCache = cache;
+	}
+
 	bool AnimationLoader::isLoadable(const std::string& filename) {
 		bfs::path animPath(filename);
 
 		std::string animationFilename = animPath.string();
 		TiXmlDocument animFile;
 
-		try {
-			RawData* data = m_vfs->open(animationFilename);
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(animationFilename) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(animationFilename);
 
-			if (data) {
-				if (data->getDataLength() != 0) {
-					// TODO - this could be expanded to do more checks
-					animFile.Parse(data->readString(data->getDataLength()).c_str());
+				if (data) {
+					if (data->getDataLength() != 0) {
+						// TODO - this could be expanded to do more checks
+						animFile.Parse(data->readString(data->getDataLength()).c_str());
 
-					if (animFile.Error()) {
-						return false;
+						if (animFile.Error()) {
+							return false;
+						}
 					}
-				}
 
-				// done with data delete resource
-				delete data;
-				data = 0;
+					// done with data delete resource
+					delete data;
+					data = 0;
+				}
 			}
-		}
-		catch (NotFound&) {
-			return false;
+			catch (NotFound&) {
+				return false;
+			}
+			document = &animFile;
 		}
 		
 		// if we get here then loading the file went well
-		TiXmlElement* root = animFile.RootElement();
+		TiXmlElement* root = document->RootElement();
 
 		if (root && root->ValueStr() == "assets") {
 			if (root->FirstChildElement("animation")) {
@@ -102,36 +111,40 @@ namespace FIFE {
 
 		AnimationPtr animation;
 
-		try {
-			RawData* data = m_vfs->open(animationFilename);
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(animationFilename) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(animationFilename);
 
-			if (data) {
-				if (data->getDataLength() != 0) {
-					doc.Parse(data->readString(data->getDataLength()).c_str());
+				if (data) {
+					if (data->getDataLength() != 0) {
+						doc.Parse(data->readString(data->getDataLength()).c_str());
 
-					if (doc.Error()) {
-						return animation;
-					}
+						if (doc.Error()) {
+							return animation;
+						}
 
-					// done with data delete resource
-					delete data;
-					data = 0;
+						// done with data delete resource
+						delete data;
+						data = 0;
+					}
 				}
 			}
-		}
-		catch (NotFound& e) {
-			FL_ERR(_log, e.what());
+			catch (NotFound& e) {
+				FL_ERR(_log, e.what());
 
-			// TODO - should we abort here
-			//        or rethrow the exception
-			//        or just keep going
+				// TODO - should we abort here
+				//        or rethrow the exception
+				//        or just keep going
 
-			return animation;
+				return animation;
+			}
+			document = &doc;
 		}
 
 		// if we get here then everything loaded properly
 		// so we can just parse out the contents
-		TiXmlElement* root = doc.RootElement();
+		TiXmlElement* root = document->RootElement();
 
 		if (root && root->ValueStr() == "assets") {
 			animation = loadAnimation(filename, root->FirstChildElement("animation"));
@@ -149,36 +162,40 @@ namespace FIFE {
 
 		std::vector<AnimationPtr> animationVector;
 
-		try {
-			RawData* data = m_vfs->open(animationFilename);
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(animationFilename) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(animationFilename);
 
-			if (data) {
-				if (data->getDataLength() != 0) {
-					doc.Parse(data->readString(data->getDataLength()).c_str());
+				if (data) {
+					if (data->getDataLength() != 0) {
+						doc.Parse(data->readString(data->getDataLength()).c_str());
 
-					if (doc.Error()) {
-						return animationVector;
-					}
+						if (doc.Error()) {
+							return animationVector;
+						}
 
-					// done with data delete resource
-					delete data;
-					data = 0;
+						// done with data delete resource
+						delete data;
+						data = 0;
+					}
 				}
 			}
-		}
-		catch (NotFound& e) {
-			FL_ERR(_log, e.what());
+			catch (NotFound& e) {
+				FL_ERR(_log, e.what());
 
-			// TODO - should we abort here
-			//        or rethrow the exception
-			//        or just keep going
+				// TODO - should we abort here
+				//        or rethrow the exception
+				//        or just keep going
 
-			return animationVector;
+				return animationVector;
+			}
+			document = &doc;
 		}
 
 		// if we get here then everything loaded properly
 		// so we can just parse out the contents
-		TiXmlElement* root = doc.RootElement();
+		TiXmlElement* root = document->RootElement();
 
 		if (root && root->ValueStr() == "assets") {
 			for (TiXmlElement* animationElem = root->FirstChildElement("animation"); animationElem; animationElem = animationElem->NextSiblingElement("animation")) {
@@ -42,6 +42,7 @@ namespace FIFE {
 	class VFS;
 	class ImageManager;
 	class AnimationManager;
+	class XmlDocumentCache;
 
 	class AnimationLoader : public IAnimationLoader {
 	public:
@@ -62,12 +63,18 @@ namespace FIFE {
 		*/
 		virtual std::vector<AnimationPtr> loadMultiple(const std::string& filename);
 
+		/** Sets the cache that is asked for parsed documents before a file is read,
+		* 0 disables it
+		*/
+		void setDocumentCache(XmlDocumentCache* cache);
+
 	private:
 		AnimationPtr loadAnimation(const std::string& filename, TiXmlElement* animationElem);
 
 		VFS* m_vfs;
 		ImageManager* m_imageManager;
 		AnimationManager* m_animationManager;
+		XmlDocumentCache* m_documentCache;
 	};
 }
 
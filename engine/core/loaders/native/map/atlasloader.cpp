@@ -41,6 +41,7 @@
 #include "view/visual.h"
 
 #include "atlasloader.h"
+#include "xmldocumentcache.h"
 
 namespace FIFE {
 	/** Logger to use for this source file.
@@ -86,41 +87,49 @@ namespace FIFE {
 	}
 
 	AtlasLoader::AtlasLoader(Model* model, VFS* vfs, ImageManager* imageManager, AnimationManager* animationManager)
-	: m_model(model), m_vfs(vfs), m_imageManager(imageManager), m_animationManager(animationManager) {
+	: m_model(model), m_vfs(vfs), m_imageManager(imageManager), m_animationManager(animationManager), m_documentCache(0) {
 	}
 
 	AtlasLoader::~AtlasLoader() {
 	}
 
+	void AtlasLoader::setDocumentCache(XmlDocumentCache* cache) {
+		m_documentCache = cache;
+	}
+
 	bool AtlasLoader::isLoadable(const std::string& filename) {
 		bfs::path atlasPath(filename);
 		std::string atlasFilename = atlasPath.string();
 		TiXmlDocument atlasFile;
 
-		try {
-			RawData* data = m_vfs->open(atlasFilename);
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(atlasFilename) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(atlasFilename);
 
-			if (data) {
-				if (data->getDataLength() != 0) {
-					atlasFile.Parse(data->readString(data->getDataLength()).c_str());
+				if (data) {
+					if (data->getDataLength() != 0) {
+						atlasFile.Parse(data->readString(data->getDataLength()).c_str());
 
-					if (atlasFile.Error()) {
+						if (atlasFile.Error()) {
+							return false;
+						}
+					} else {
 						return false;
 					}
-				} else {
-					return false;
-				}
 
-				// done with data delete resource
-				delete data;
-				data = 0;
+					// done with data delete resource
+					delete data;
+					data = 0;
+				}
+			} catch (NotFound&) {
+				return false;
 			}
-		} catch (NotFound&) {
-			return false;
+			document = &atlasFile;
 		}
 
 		// if we get here then loading the file went well
-		TiXmlElement* root = atlasFile.RootElement();
+		TiXmlElement* root = document->RootElement();
 
 		if (root && root->ValueStr() == "assets") {
 			if (root->FirstChildElement("atlas")) {
@@ -144,36 +153,40 @@ namespace FIFE {
 		TiXmlDocument doc;
 		AtlasPtr atlas;
 
-		try {
-			RawData* data = m_vfs->open(atlasFilename);
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(atlasFilename) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(atlasFilename);
 
-			if (data) {
-				if (data->getDataLength() != 0) {
-					doc.Parse(data->readString(data->getDataLength()).c_str());
+				if (data) {
+					if (data->getDataLength() != 0) {
+						doc.Parse(data->readString(data->getDataLength()).c_str());
 
-					if (doc.Error()) {
-						return atlas;
-					}
+						if (doc.Error()) {
+							return atlas;
+						}
 
-					// done with data delete resource
-					delete data;
-					data = 0;
+						// done with data delete resource
+						delete data;
+						data = 0;
+					}
 				}
 			}
-		}
-		catch (NotFound& e) {
-			FL_ERR(_log, e.what());
+			catch (NotFound& e) {
+				FL_ERR(_log, e.what());
 
-			// TODO - should we abort here
-			//        or rethrow the exception
-			//        or just keep going
+				// TODO - should we abort here
+				//        or rethrow the exception
+				//        or just keep going
 
-			return atlas;
+				return atlas;
+			}
+			document = &doc;
 		}
 
 		// if we get here then everything loaded properly
 		// so we can just parse out the contents
-		TiXmlElement* root = doc.RootElement();
+		TiXmlElement* root = document->RootElement();
 
 		if (root && root->ValueStr() == "assets") {
 			atlas = loadAtlas(filename, root->FirstChildElement("atlas"));
@@ -195,36 +208,40 @@ namespace FIFE {
 		TiXmlDocument doc;
 		std::vector<AtlasPtr> atlasVector;
 
-		try {
-			RawData* data = m_vfs->open(atlasFilename);
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(atlasFilename) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(atlasFilename);
 
-			if (data) {
-				if (data->getDataLength() != 0) {
-					doc.Parse(data->readString(data->getDataLength()).c_str());
+				if (data) {
+					if (data->getDataLength() != 0) {
+						doc.Parse(data->readString(data->getDataLength()).c_str());
 
-					if (doc.Error()) {
-						return atlasVector;
-					}
+						if (doc.Error()) {
+							return atlasVector;
+						}
 
-					// done with data delete resource
-					delete data;
-					data = 0;
+						// done with data delete resource
+						delete data;
+						data = 0;
+					}
 				}
 			}
-		}
-		catch (NotFound& e) {
-			FL_ERR(_log, e.what());
+			catch (NotFound& e) {
+				FL_ERR(_log, e.what());
 
-			// TODO - should we abort here
-			//        or rethrow the exception
-			//        or just keep going
+				// TODO - should we abort here
+				//        or rethrow the exception
+				//        or just keep going
 
-			return atlasVector;
+				return atlasVector;
+			}
+			document = &doc;
 		}
 
 		// if we get here then everything loaded properly
 		// so we can just parse out the contents
-		TiXmlElement* root = doc.RootElement();
+		TiXmlElement* root = document->RootElement();
 
 		if (root && root->ValueStr() == "assets") {
 			for (TiXmlElement* atlasElem = root->FirstChildElement("atlas"); atlasElem; atlasElem = atlasElem->NextSiblingElement("atlas")) {
@@ -42,6 +42,7 @@ namespace FIFE {
 	class VFS;
 	class ImageManager;
 	class AnimationManager;
+	class XmlDocumentCache;
 
 	struct AtlasData {
 		Rect rect;
@@ -113,6 +114,11 @@ namespace FIFE {
 		*/
 		virtual std::vector<AtlasPtr> loadMultiple(const std::string& filename);
 
+		/** Sets the cache that is asked for parsed documents before a file is read,
+		* 0 disables it
+		*/
+		void setDocumentCache(XmlDocumentCache* cache);
+
 	private:
 		AtlasPtr loadAtlas(const std::string& filename, TiXmlElement* atlasElem);
 
@@ -120,6 +126,7 @@ namespace FIFE {
 		VFS* m_vfs;
 		ImageManager* m_imageManager;
 		AnimationManager* m_animationManager;
+		XmlDocumentCache* m_documentCache;
 	};
 
 	/** convenience function for creating the default fife atlas loader
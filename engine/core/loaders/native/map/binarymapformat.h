@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_BINARYMAPFORMAT_H_
+#define FIFE_BINARYMAPFORMAT_H_
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** Precompiled binary map format, written by tools/map_compiler.py and read by BinaryMapLoader.
+	 *
+	 * It holds the same data as a xml map file, but all defaults and attribute
+	 * fallbacks are already resolved by the compiler. All values are little endian.
+	 * Strings are interned, everything after the string table references them by
+	 * uint32 index, NO_STRING marks a missing string. Layout of version 1:
+	 *
+	 * @code
+	 * header:      magic "FIFEBMAP", uint32 version
+	 * strings:     uint32 count, per string uint32 length and the bytes
+	 * map:         str id, str loader name, uint32 element count
+	 * imports:     uint32 count, per import str file, str dir
+	 * layers:      uint32 count, per layer
+	 *              str id, str grid type,
+	 *              double x_offset, y_offset, z_offset, x_scale, y_scale, z_scale, rotation,
+	 *              uint8 PathingStrategy, uint8 SortingStrategy, uint8 LayerType, str interact id,
+	 *              uint32 object count, per object str namespace, str id,
+	 *              uint32 instance count, the instance records
+	 * instance:    uint32 object index, str id, double x, y, z, int32 rotation, int32 stackpos,
+	 *              str cost id, double cost, uint8 cellstack, uint8 InstanceFlags, uint16 reserved
+	 * cellcaches:  uint32 count, per cache
+	 *              str layer id, double default cost, double default speed, uint8 search narrow,
+	 *              uint32 cell count, per cell
+	 *              int32 x, y, uint8 CellFlags, uint8 CellBlocker, [double cost], [double speed],
+	 *              uint32 cost count, per cost str id, double value,
+	 *              uint32 area count, per area str id,
+	 *              uint32 transition count, per transition str layer id, int32 x, y, z, uint8 immediate
+	 * triggers:    uint32 count, per trigger
+	 *              str name, uint8 triggered, uint8 all instances, str attached instance, str attached layer,
+	 *              uint32 assign count, per assign str layer id, int32 x, y,
+	 *              uint32 enabled count, per enabled instance str layer id, str instance id,
+	 *              uint32 condition count, per condition int32 id
+	 * cameras:     uint32 count, per camera
+	 *              str id, int32 ref cell width, height, double tilt, zoom, rotation,
+	 *              uint8 CameraFlags, double ztoy, int32 viewport x, y, width, height
+	 * footer:      uint32 END
+	 * @endcode
+	 */
+	namespace BinaryMap {
+		//! file magic
+		static const char MAGIC[8] = { 'F', 'I', 'F', 'E', 'B', 'M', 'A', 'P' };
+		//! current format version, increase it on every format change
+		static const uint32_t VERSION = 1;
+		//! marks the end of the map
+		static const uint32_t END = 0x444E4521;
+		//! index of a missing string
+		static const uint32_t NO_STRING = 0xFFFFFFFF;
+		//! size of a instance record in bytes
+		static const uint32_t INSTANCE_RECORD_SIZE = 56;
+
+		enum LayerType {
+			LAYER_DEFAULT = 0,
+			LAYER_WALKABLE = 1,
+			LAYER_INTERACT = 2
+		};
+
+		//! marks the optional instance values that are set
+		enum InstanceFlags {
+			INSTANCE_ROTATION = 0x01,
+			INSTANCE_STACKPOS = 0x02,
+			INSTANCE_CELLSTACK = 0x04,
+			INSTANCE_COST = 0x08
+		};
+
+		enum CellFlags {
+			CELL_COST = 0x01,
+			CELL_SPEED = 0x02,
+			CELL_NARROW = 0x04
+		};
+
+		enum CellBlocker {
+			CELL_DEFAULT = 0,
+			CELL_NO_BLOCKER = 1,
+			CELL_BLOCKER = 2
+		};
+
+		enum CameraFlags {
+			CAMERA_ZTOY = 0x01,
+			CAMERA_VIEWPORT = 0x02
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,490 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstring>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/model.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/grids/cellgrid.h"
+#include "model/metamodel/object.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "model/structures/trigger.h"
+#include "model/structures/triggercontroller.h"
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+#include "util/structures/rect.h"
+#include "vfs/fife_boost_filesystem.h"
+#include "vfs/raw/binarystream.h"
+#include "vfs/raw/rawdata.h"
+#include "vfs/vfs.h"
+#include "video/renderbackend.h"
+#include "view/camera.h"
+#include "view/renderers/instancerenderer.h"
+#include "view/visual.h"
+
+#include "binarymapformat.h"
+#include "binarymaploader.h"
+
+namespace FIFE {
+	/** Logger to use for this source file.
+	 *  @relates Logger
+	 */
+	static Logger _log(LM_NATIVE_LOADERS);
+
+	namespace {
+		bool readHeader(BinaryReader& reader) {
+			uint8_t magic[sizeof(BinaryMap::MAGIC)];
+			reader.readInto(magic, sizeof(magic));
+			if (std::memcmp(magic, BinaryMap::MAGIC, sizeof(magic)) != 0) {
+				return false;
+			}
+			uint32_t version = reader.read32();
+			return version >= 1 && version <= BinaryMap::VERSION;
+		}
+
+		/** Object of a layer object table, with the values every instance needs.
+		 */
+		struct LayerObject {
+			Object* object;
+			int32_t defaultRotation;
+			bool defaultAction;
+		};
+	}
+
+	BinaryMapLoader::BinaryMapLoader(Model* model, VFS* vfs, ImageManager* imageManager, RenderBackend* renderBackend)
+	: MapLoader(model, vfs, imageManager, renderBackend) {
+	}
+
+	BinaryMapLoader::~BinaryMapLoader() {
+	}
+
+	bool BinaryMapLoader::isLoadable(const std::string& filename) const {
+		bool loadable = false;
+		try {
+			RawData* data = m_vfs->open(filename);
+			try {
+				BinaryReader reader(data);
+				loadable = readHeader(reader);
+			} catch (IndexOverflow&) {
+				loadable = false;
+			}
+			delete data;
+		} catch (NotFound& e) {
+			FL_ERR(_log, e.what());
+		}
+		return loadable;
+	}
+
+	Map* BinaryMapLoader::load(const std::string& filename) {
+		m_percentDoneListener.reset();
+		m_loadProfiler.reset();
+		m_loadProfiler.beginPhase("map");
+		// ends the last phase on every exit
+		LoadPhaseGuard phaseGuard(m_loadProfiler);
+
+		bfs::path mapPath(filename);
+		if (HasParentPath(mapPath)) {
+			m_mapDirectory = GetParentPath(mapPath).string();
+		}
+		std::string mapFilename = mapPath.string();
+
+		RawData* data = m_vfs->openMapped(mapFilename);
+		Map* map = NULL;
+		try {
+			BinaryReader reader(data);
+			if (!readHeader(reader)) {
+				throw InvalidFormat(mapFilename + " is no supported binary map");
+			}
+
+			uint32_t stringCount = reader.read32();
+			m_strings.resize(stringCount);
+			for (uint32_t i = 0; i < stringCount; ++i) {
+				m_strings[i] = reader.readString();
+			}
+
+			const std::string& mapId = readString(reader);
+			const std::string& loaderName = readString(reader);
+			if (!loaderName.empty()) {
+				m_loaderName = loaderName;
+			}
+			m_percentDoneListener.setTotalNumberOfElements(reader.read32());
+
+			map = m_model->createMap(mapId);
+			map->setFilename(mapFilename);
+
+			uint32_t importCount = reader.read32();
+			std::vector<std::string> importFiles;
+			for (uint32_t i = 0; i < importCount; ++i) {
+				const std::string& file = readString(reader);
+				const std::string& directory = readString(reader);
+				collectImportFiles(file, directory, importFiles);
+			}
+			loadImportFiles(importFiles);
+			linkMultiObjectParts();
+
+			m_loadProfiler.beginPhase("layers");
+			uint32_t layerCount = reader.read32();
+			for (uint32_t i = 0; i < layerCount; ++i) {
+				loadLayer(reader, map);
+				m_percentDoneListener.incrementCount();
+			}
+
+			m_loadProfiler.beginPhase("cellcaches");
+			map->initializeCellCaches();
+			uint32_t cacheCount = reader.read32();
+			for (uint32_t i = 0; i < cacheCount; ++i) {
+				loadCellCache(reader, map);
+			}
+			map->finalizeCellCaches();
+			for (std::vector<PendingTransition>::iterator it = m_transitions.begin(); it != m_transitions.end(); ++it) {
+				it->cell->createTransition(it->target, it->mc, it->immediate);
+			}
+
+			m_loadProfiler.beginPhase("triggers");
+			uint32_t triggerCount = reader.read32();
+			for (uint32_t i = 0; i < triggerCount; ++i) {
+				loadTrigger(reader, map);
+			}
+
+			m_loadProfiler.beginPhase("cameras");
+			uint32_t cameraCount = reader.read32();
+			for (uint32_t i = 0; i < cameraCount; ++i) {
+				loadCamera(reader, map);
+				m_percentDoneListener.incrementCount();
+			}
+
+			if (reader.read32() != BinaryMap::END) {
+				throw InvalidFormat(mapFilename + " has a invalid end marker");
+			}
+		} catch (...) {
+			m_strings.clear();
+			m_transitions.clear();
+			delete data;
+			throw;
+		}
+		m_strings.clear();
+		m_transitions.clear();
+		delete data;
+
+		return map;
+	}
+
+	const std::string& BinaryMapLoader::getString(uint32_t index) const {
+		static const std::string empty;
+		if (index == BinaryMap::NO_STRING) {
+			return empty;
+		}
+		if (index >= m_strings.size()) {
+			throw InvalidFormat("string index out of range in binary map");
+		}
+		return m_strings[index];
+	}
+
+	const std::string& BinaryMapLoader::readString(BinaryReader& reader) const {
+		return getString(reader.read32());
+	}
+
+	void BinaryMapLoader::loadLayer(BinaryReader& reader, Map* map) {
+		const std::string& layerId = readString(reader);
+		const std::string& gridType = readString(reader);
+		double xOffset = reader.readDouble();
+		double yOffset = reader.readDouble();
+		double zOffset = reader.readDouble();
+		double xScale = reader.readDouble();
+		double yScale = reader.readDouble();
+		double zScale = reader.readDouble();
+		double rotation = reader.readDouble();
+		PathingStrategy pathing = static_cast<PathingStrategy>(reader.read8());
+		SortingStrategy sorting = static_cast<SortingStrategy>(reader.read8());
+		uint8_t layerType = reader.read8();
+		const std::string& interactId = readString(reader);
+
+		CellGrid* grid = m_model->getCellGrid(gridType.empty() ? "square" : gridType);
+		if (!grid) {
+			throw InvalidFormat("unknown grid type " + gridType + " in binary map");
+		}
+		grid->setXShift(xOffset);
+		grid->setXScale(xScale);
+		grid->setYShift(yOffset);
+		grid->setYScale(yScale);
+		grid->setZShift(zOffset);
+		grid->setZScale(zScale);
+		grid->setRotation(rotation);
+
+		Layer* layer = map->createLayer(layerId, grid);
+		layer->setPathingStrategy(pathing);
+		layer->setSortingStrategy(sorting);
+		if (layerType == BinaryMap::LAYER_WALKABLE) {
+			layer->setWalkable(true);
+		} else if (layerType == BinaryMap::LAYER_INTERACT) {
+			layer->setInteract(true, interactId);
+		}
+
+		// resolve the objects once instead of for every instance
+		uint32_t objectCount = reader.read32();
+		std::vector<LayerObject> objects(objectCount);
+		for (uint32_t i = 0; i < objectCount; ++i) {
+			const std::string& nameSpace = readString(reader);
+			const std::string& objectId = readString(reader);
+			LayerObject& entry = objects[i];
+			entry.object = m_model->getObject(objectId, nameSpace);
+			entry.defaultRotation = 0;
+			entry.defaultAction = false;
+			if (!entry.object) {
+				FL_ERR(_log, LMsg("object ") << objectId << " in namespace " << nameSpace << " not found, its instances are skipped");
+				continue;
+			}
+			ObjectVisual* objVisual = entry.object->getVisual<ObjectVisual>();
+			if (objVisual) {
+				std::vector<int32_t> angles;
+				objVisual->getStaticImageAngles(angles);
+				if (!angles.empty()) {
+					entry.defaultRotation = angles[0];
+				}
+			}
+			entry.defaultAction = entry.object->getAction("default") != NULL;
+		}
+
+		uint32_t instanceCount = reader.read32();
+		for (uint32_t i = 0; i < instanceCount; ++i) {
+			uint32_t objectIndex = reader.read32();
+			const std::string& instanceId = readString(reader);
+			ExactModelCoordinate emc;
+			emc.x = reader.readDouble();
+			emc.y = reader.readDouble();
+			emc.z = reader.readDouble();
+			int32_t instRotation = reader.readInt32();
+			int32_t stackpos = reader.readInt32();
+			const std::string& costId = readString(reader);
+			double cost = reader.readDouble();
+			uint8_t cellStack = reader.read8();
+			uint8_t flags = reader.read8();
+			reader.skip(2);
+
+			m_percentDoneListener.incrementCount();
+			if (objectIndex >= objectCount) {
+				throw InvalidFormat("object index out of range in binary map");
+			}
+			const LayerObject& entry = objects[objectIndex];
+			if (!entry.object) {
+				continue;
+			}
+
+			Instance* inst = layer->createInstance(entry.object, emc, instanceId);
+			m_loadProfiler.addCount();
+			inst->setRotation((flags & BinaryMap::INSTANCE_ROTATION) ? instRotation : entry.defaultRotation);
+
+			InstanceVisual* instVisual = InstanceVisual::create(inst);
+			if (instVisual && (flags & BinaryMap::INSTANCE_STACKPOS)) {
+				instVisual->setStackPosition(stackpos);
+			}
+			if (flags & BinaryMap::INSTANCE_CELLSTACK) {
+				inst->setCellStackPosition(cellStack);
+			}
+			if (flags & BinaryMap::INSTANCE_COST) {
+				inst->setCost(costId, cost);
+			}
+			if (entry.defaultAction) {
+				Location target(layer);
+				inst->actRepeat("default", target);
+			}
+		}
+	}
+
+	void BinaryMapLoader::loadCellCache(BinaryReader& reader, Map* map) {
+		const std::string& layerId = readString(reader);
+		double cacheCost = reader.readDouble();
+		double cacheSpeed = reader.readDouble();
+		bool searchNarrow = reader.read8() != 0;
+
+		Layer* layer = map->getLayer(layerId);
+		CellCache* cache = layer ? layer->getCellCache() : NULL;
+		if (cache) {
+			cache->setSearchNarrowCells(searchNarrow);
+			cache->setDefaultCostMultiplier(cacheCost);
+			cache->setDefaultSpeedMultiplier(cacheSpeed);
+		}
+
+		uint32_t cellCount = reader.read32();
+		for (uint32_t i = 0; i < cellCount; ++i) {
+			ModelCoordinate mc;
+			mc.x = reader.readInt32();
+			mc.y = reader.readInt32();
+			uint8_t flags = reader.read8();
+			uint8_t blocker = reader.read8();
+			double cellCost = (flags & BinaryMap::CELL_COST) ? reader.readDouble() : 1.0;
+			double cellSpeed = (flags & BinaryMap::CELL_SPEED) ? reader.readDouble() : 1.0;
+
+			Cell* cell = cache ? cache->createCell(mc) : NULL;
+			if (cell) {
+				m_loadProfiler.addCount();
+				if (blocker == BinaryMap::CELL_NO_BLOCKER) {
+					cell->setCellType(CTYPE_CELL_NO_BLOCKER);
+				} else if (blocker == BinaryMap::CELL_BLOCKER) {
+					cell->setCellType(CTYPE_CELL_BLOCKER);
+				}
+				if (flags & BinaryMap::CELL_COST) {
+					cell->setCostMultiplier(cellCost);
+				}
+				if (flags & BinaryMap::CELL_SPEED) {
+					cell->setSpeedMultiplier(cellSpeed);
+				}
+				if (flags & BinaryMap::CELL_NARROW) {
+					cache->addNarrowCell(cell);
+				}
+			}
+
+			uint32_t costCount = reader.read32();
+			for (uint32_t j = 0; j < costCount; ++j) {
+				const std::string& costId = readString(reader);
+				double cost = reader.readDouble();
+				if (cell) {
+					cache->registerCost(costId, cost);
+					cache->addCellToCost(costId, cell);
+				}
+			}
+
+			uint32_t areaCount = reader.read32();
+			for (uint32_t j = 0; j < areaCount; ++j) {
+				const std::string& areaId = readString(reader);
+				if (cell) {
+					cache->addCellToArea(areaId, cell);
+				}
+			}
+
+			uint32_t transitionCount = reader.read32();
+			for (uint32_t j = 0; j < transitionCount; ++j) {
+				const std::string& targetId = readString(reader);
+				PendingTransition transition;
+				transition.cell = cell;
+				transition.mc.x = reader.readInt32();
+				transition.mc.y = reader.readInt32();
+				transition.mc.z = reader.readInt32();
+				transition.immediate = reader.read8() != 0;
+				transition.target = targetId.empty() ? layer : map->getLayer(targetId);
+				if (!transition.target) {
+					transition.target = layer;
+				}
+				if (cell) {
+					m_transitions.push_back(transition);
+				}
+			}
+		}
+	}
+
+	void BinaryMapLoader::loadTrigger(BinaryReader& reader, Map* map) {
+		const std::string& triggerName = readString(reader);
+		bool triggered = reader.read8() != 0;
+		bool allInstances = reader.read8() != 0;
+		const std::string& attachedInstance = readString(reader);
+		const std::string& attachedLayer = readString(reader);
+
+		Trigger* trigger = map->getTriggerController()->createTrigger(triggerName);
+		m_loadProfiler.addCount();
+		if (triggered) {
+			trigger->setTriggered();
+		}
+		if (allInstances) {
+			trigger->enableForAllInstances();
+		}
+		if (!attachedInstance.empty()) {
+			Layer* layer = map->getLayer(attachedLayer);
+			Instance* instance = layer ? layer->getInstance(attachedInstance) : NULL;
+			if (instance) {
+				trigger->attach(instance);
+			}
+		}
+
+		uint32_t assignCount = reader.read32();
+		for (uint32_t i = 0; i < assignCount; ++i) {
+			const std::string& layerId = readString(reader);
+			int32_t x = reader.readInt32();
+			int32_t y = reader.readInt32();
+			Layer* layer = map->getLayer(layerId);
+			if (layer) {
+				trigger->assign(layer, ModelCoordinate(x, y));
+			}
+		}
+
+		uint32_t enabledCount = reader.read32();
+		for (uint32_t i = 0; i < enabledCount; ++i) {
+			const std::string& layerId = readString(reader);
+			const std::string& instanceId = readString(reader);
+			Layer* layer = map->getLayer(layerId);
+			Instance* instance = layer ? layer->getInstance(instanceId) : NULL;
+			if (instance) {
+				trigger->enableForInstance(instance);
+			}
+		}
+
+		uint32_t conditionCount = reader.read32();
+		for (uint32_t i = 0; i < conditionCount; ++i) {
+			trigger->addTriggerCondition(static_cast<TriggerCondition>(reader.readInt32()));
+		}
+	}
+
+	void BinaryMapLoader::loadCamera(BinaryReader& reader, Map* map) {
+		const std::string& cameraId = readString(reader);
+		int32_t refCellWidth = reader.readInt32();
+		int32_t refCellHeight = reader.readInt32();
+		double tilt = reader.readDouble();
+		double zoom = reader.readDouble();
+		double rotation = reader.readDouble();
+		uint8_t flags = reader.read8();
+		double zToY = reader.readDouble();
+		Rect viewport;
+		viewport.x = reader.readInt32();
+		viewport.y = reader.readInt32();
+		viewport.w = reader.readInt32();
+		viewport.h = reader.readInt32();
+
+		if (!(flags & BinaryMap::CAMERA_VIEWPORT)) {
+			viewport = Rect(0, 0, m_renderBackend->getScreenWidth(), m_renderBackend->getScreenHeight());
+		}
+
+		Camera* cam = map->addCamera(cameraId, viewport);
+		m_loadProfiler.addCount();
+		cam->setCellImageDimensions(refCellWidth, refCellHeight);
+		cam->setRotation(rotation);
+		cam->setTilt(tilt);
+		cam->setZoom(zoom);
+		if (flags & BinaryMap::CAMERA_ZTOY) {
+			cam->setZToY(zToY);
+		}
+
+		// active instance renderer for camera
+		InstanceRenderer* instanceRenderer = InstanceRenderer::getInstance(cam);
+		if (instanceRenderer) {
+			instanceRenderer->activateAllLayers(map);
+		}
+	}
+}
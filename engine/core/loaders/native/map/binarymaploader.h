@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_BINARYMAPLOADER_H_
+#define FIFE_BINARYMAPLOADER_H_
+
+// Standard C++ library includes
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/metamodel/modelcoords.h"
+
+#include "maploader.h"
+
+namespace FIFE {
+	class BinaryReader;
+	class Cell;
+
+	/** Map loader for maps precompiled by tools/map_compiler.py.
+	 *
+	 * The file is mapped into memory and read without any text parsing. Objects are
+	 * resolved once per layer, instances are created from packed records.
+	 * Imports are still loaded with the object, animation and atlas loaders of MapLoader.
+	 * @see BinaryMap
+	 */
+	class BinaryMapLoader : public MapLoader {
+	public:
+		BinaryMapLoader(Model* model, VFS* vfs, ImageManager* imageManager, RenderBackend* renderBackend);
+
+		~BinaryMapLoader();
+
+		/**
+		* @see IMapLoader::isLoadable
+		*/
+		bool isLoadable(const std::string& filename) const;
+
+		/**
+		* @see IMapLoader::load
+		* @throws InvalidFormat if the file is no supported binary map
+		*/
+		Map* load(const std::string& filename);
+
+	private:
+		const std::string& getString(uint32_t index) const;
+		const std::string& readString(BinaryReader& reader) const;
+
+		void loadLayer(BinaryReader& reader, Map* map);
+		void loadCellCache(BinaryReader& reader, Map* map);
+		void loadTrigger(BinaryReader& reader, Map* map);
+		void loadCamera(BinaryReader& reader, Map* map);
+
+		//! interned strings of the current file
+		std::vector<std::string> m_strings;
+
+		//! transitions are created after the cellcaches are finalized
+		struct PendingTransition {
+			Cell* cell;
+			Layer* target;
+			ModelCoordinate mc;
+			bool immediate;
+		};
+		std::vector<PendingTransition> m_transitions;
+	};
+}
+
+#endif
@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <sstream>
+
+// Platform specific includes
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/base/stringutils.h"
+#include "video/imagemanager.h"
+#include "vfs/vfs.h"
+
+#include "loadprofiler.h"
+#include "percentdonelistener.h"
+
+namespace FIFE {
+
+	LoadPhase::LoadPhase()
+	: seconds(0.0), count(0), bytesRead(0), imagesCreated(0), imagesLoaded(0), processPeakMemory(0), peakMemoryGrowth(0) {
+	}
+
+	uint32_t LoadProfile::getPhaseCount() const {
+		return static_cast<uint32_t>(m_phases.size());
+	}
+
+	const LoadPhase& LoadProfile::getPhase(uint32_t index) const {
+		if (index >= m_phases.size()) {
+			throw IndexOverflow("load phase index out of range");
+		}
+		return m_phases[index];
+	}
+
+	double LoadProfile::getTotalSeconds() const {
+		double seconds = 0.0;
+		std::vector<LoadPhase>::const_iterator it = m_phases.begin();
+		for (; it != m_phases.end(); ++it) {
+			seconds += it->seconds;
+		}
+		return seconds;
+	}
+
+	std::string LoadProfile::toJson() const {
+		std::ostringstream out;
+		out << '[';
+		std::vector<LoadPhase>::const_iterator it = m_phases.begin();
+		for (; it != m_phases.end(); ++it) {
+			if (it != m_phases.begin()) {
+				out << ", ";
+			}
+			out << "{\"name\": ";
+			writeJsonString(out, it->name);
+			out << ", \"seconds\": " << it->seconds
+				<< ", \"count\": " << it->count
+				<< ", \"bytes_read\": " << it->bytesRead
+				<< ", \"images_created\": " << it->imagesCreated
+				<< ", \"images_loaded\": " << it->imagesLoaded
+				<< ", \"process_peak_memory\": " << it->processPeakMemory
+				<< ", \"peak_memory_growth\": " << it->peakMemoryGrowth << '}';
+		}
+		out << ']';
+		return out.str();
+	}
+
+	void LoadProfile::addPhase(const LoadPhase& phase) {
+		m_phases.push_back(phase);
+	}
+
+	void LoadProfile::clear() {
+		m_phases.clear();
+	}
+
+	LoadProfiler::LoadProfiler(VFS* vfs, ImageManager* imageManager, PercentDoneCallback* callback)
+	: m_vfs(vfs), m_imageManager(imageManager), m_callback(callback), m_running(false),
+	  m_startBytes(0), m_startPeakMemory(0), m_startImagesCreated(0), m_startImagesLoaded(0) {
+	}
+
+	void LoadProfiler::beginPhase(const std::string& name) {
+		if (m_running) {
+			endPhase();
+		}
+		m_running = true;
+		m_phase = LoadPhase();
+		m_phase.name = name;
+		m_startBytes = m_vfs ? m_vfs->getBytesRead() : 0;
+		m_startImagesCreated = m_imageManager ? static_cast<uint32_t>(m_imageManager->getTotalResources()) : 0;
+		m_startImagesLoaded = m_imageManager ? static_cast<uint32_t>(m_imageManager->getTotalResourcesLoaded()) : 0;
+		m_startPeakMemory = getPeakMemory();
+		m_start = std::chrono::steady_clock::now();
+	}
+
+	void LoadProfiler::addCount(uint32_t count) {
+		if (m_running) {
+			m_phase.count += count;
+		}
+	}
+
+	const LoadPhase* LoadProfiler::endPhase() {
+		if (!m_running) {
+			return 0;
+		}
+		m_running = false;
+		m_phase.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+		if (m_vfs) {
+			m_phase.bytesRead = m_vfs->getBytesRead() - m_startBytes;
+		}
+		if (m_imageManager) {
+			// the totals shrink if images are freed during the phase
+			uint32_t created = static_cast<uint32_t>(m_imageManager->getTotalResources());
+			uint32_t loaded = static_cast<uint32_t>(m_imageManager->getTotalResourcesLoaded());
+			m_phase.imagesCreated = created > m_startImagesCreated ? created - m_startImagesCreated : 0;
+			m_phase.imagesLoaded = loaded > m_startImagesLoaded ? loaded - m_startImagesLoaded : 0;
+		}
+		// the peak is process wide, the growth is what the phase added to it
+		m_phase.processPeakMemory = getPeakMemory();
+		m_phase.peakMemoryGrowth = m_phase.processPeakMemory > m_startPeakMemory ? m_phase.processPeakMemory - m_startPeakMemory : 0;
+		m_profile.addPhase(m_phase);
+
+		const LoadPhase& phase = m_profile.getPhase(m_profile.getPhaseCount() - 1);
+		if (m_callback) {
+			m_callback->firePhaseDone(phase);
+		}
+		return &phase;
+	}
+
+	bool LoadProfiler::isPhaseRunning() const {
+		return m_running;
+	}
+
+	const LoadProfile& LoadProfiler::getProfile() const {
+		return m_profile;
+	}
+
+	void LoadProfiler::reset() {
+		m_running = false;
+		m_profile.clear();
+	}
+
+	uint64_t LoadProfiler::getPeakMemory() {
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return counters.PeakWorkingSetSize;
+		}
+		return 0;
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) {
+			return 0;
+		}
+#if defined(__APPLE__)
+		// bytes on mac os
+		return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+		// kilobytes on linux and the bsds
+		return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+	}
+
+	LoadPhaseGuard::LoadPhaseGuard(LoadProfiler& profiler)
+	: m_profiler(profiler) {
+	}
+
+	LoadPhaseGuard::~LoadPhaseGuard() {
+		try {
+			m_profiler.endPhase();
+		} catch (...) {
+			// a listener must not throw out of the unwinding of a failed load
+		}
+	}
+}
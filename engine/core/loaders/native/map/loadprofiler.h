@@ -0,0 +1,172 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_LOAD_PROFILER_H
+#define FIFE_LOAD_PROFILER_H
+
+// Standard C++ library includes
+#include <chrono>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+	class VFS;
+	class ImageManager;
+	class PercentDoneCallback;
+
+	/** Measurements of one phase of a map load.
+	 */
+	struct LoadPhase {
+		LoadPhase();
+
+		//! name of the phase, e.g. "imports" or "layers"
+		std::string name;
+		//! wall clock time of the phase in seconds
+		double seconds;
+		//! number of elements the phase created, e.g. instances for "layers"
+		uint32_t count;
+		//! size of the files opened through the vfs during the phase
+		uint64_t bytesRead;
+		//! number of images created during the phase
+		uint32_t imagesCreated;
+		//! number of images loaded during the phase
+		uint32_t imagesLoaded;
+		//! peak resident memory of the whole process at the end of the phase, 0 if unknown
+		uint64_t processPeakMemory;
+		//! growth of the process peak memory during the phase, 0 if unknown or not grown
+		uint64_t peakMemoryGrowth;
+	};
+
+	/** The phases of a map load, in the order they finished.
+	 */
+	class LoadProfile {
+	public:
+		/** Returns the number of phases.
+		 */
+		uint32_t getPhaseCount() const;
+
+		/** Returns the phase with the given index.
+		 */
+		const LoadPhase& getPhase(uint32_t index) const;
+
+		/** Returns the summed time of all phases in seconds.
+		 */
+		double getTotalSeconds() const;
+
+		/** Returns the phases as json array of objects, one object per phase.
+		 */
+		std::string toJson() const;
+
+		/** Appends a phase.
+		 */
+		void addPhase(const LoadPhase& phase);
+
+		/** Removes all phases.
+		 */
+		void clear();
+
+	private:
+		std::vector<LoadPhase> m_phases;
+	};
+
+	/** Measures the phases of a map load.
+	 *
+	 * A phase starts with beginPhase and ends with endPhase, phases do not nest.
+	 * Beginning a phase ends the running one.
+	 */
+	class LoadProfiler {
+	public:
+		/** Constructor
+		 * @param vfs The vfs the read bytes are taken from, may be 0.
+		 * @param imageManager The image manager the image counts are taken from, may be 0.
+		 * @param callback Its listeners are told about each finished phase, may be 0.
+		 */
+		LoadProfiler(VFS* vfs, ImageManager* imageManager, PercentDoneCallback* callback = 0);
+
+		/** Starts a new phase.
+		 */
+		void beginPhase(const std::string& name);
+
+		/** Adds to the element count of the running phase.
+		 */
+		void addCount(uint32_t count = 1);
+
+		/** Ends the running phase, adds it to the profile and returns it.
+		 * Returns 0 if no phase is running.
+		 */
+		const LoadPhase* endPhase();
+
+		/** Returns true if a phase is running.
+		 */
+		bool isPhaseRunning() const;
+
+		/** Returns the finished phases.
+		 */
+		const LoadProfile& getProfile() const;
+
+		/** Removes all phases, e.g. before the next load.
+		 */
+		void reset();
+
+		/** Returns the peak resident memory of the process in bytes, 0 if unknown.
+		 */
+		static uint64_t getPeakMemory();
+
+	private:
+		VFS* m_vfs;
+		ImageManager* m_imageManager;
+		PercentDoneCallback* m_callback;
+		LoadProfile m_profile;
+		bool m_running;
+		//! values at the start of the running phase
+		LoadPhase m_phase;
+		std::chrono::steady_clock::time_point m_start;
+		uint64_t m_startBytes;
+		uint64_t m_startPeakMemory;
+		uint32_t m_startImagesCreated;
+		uint32_t m_startImagesLoaded;
+	};
+
+	/** Ends the running phase of the profiler when it goes out of scope,
+	 * so that early returns and exceptions of a load do not leave a phase open.
+	 */
+	class LoadPhaseGuard {
+	public:
+		LoadPhaseGuard(LoadProfiler& profiler);
+		~LoadPhaseGuard();
+
+	private:
+		LoadPhaseGuard(const LoadPhaseGuard& rhs); /* = delete */
+		LoadPhaseGuard& operator=(const LoadPhaseGuard& rhs); /* = delete */
+
+		LoadProfiler& m_profiler;
+	};
+}
+
+#endif
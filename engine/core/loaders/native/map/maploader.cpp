@@ -61,6 +61,7 @@
 #include "maploader.h"
 #include "animationloader.h"
 #include "objectloader.h"
+#include "xmldocumentcache.h"
 
 namespace FIFE {
 	/** Logger to use for this source file.
@@ -70,7 +71,7 @@ namespace FIFE {
 
 	MapLoader::MapLoader(Model* model, VFS* vfs, ImageManager* imageManager, RenderBackend* renderBackend)
 	: m_model(model), m_vfs(vfs), m_imageManager(imageManager), m_animationManager(AnimationManager::instance()), m_renderBackend(renderBackend),
-	  m_loaderName("fife"), m_mapDirectory("") {
+	  m_loadProfiler(vfs, imageManager, &m_percentDoneListener), m_loaderName("fife"), m_mapDirectory("") {
 		AnimationLoaderPtr animationLoader(new AnimationLoader(m_vfs, m_imageManager, m_animationManager));
 		AtlasLoaderPtr atlasLoader(new AtlasLoader(m_model, m_vfs, m_imageManager, m_animationManager));
 		m_objectLoader.reset(new ObjectLoader(m_model, m_vfs, m_imageManager, m_animationManager, animationLoader, atlasLoader));
@@ -86,6 +87,10 @@ namespace FIFE {
 		// reset percent done listener just in case
 		// it has residual data from last load
 		m_percentDoneListener.reset();
+		m_loadProfiler.reset();
+		m_loadProfiler.beginPhase("map");
+		// ends the last phase on every exit
+		LoadPhaseGuard phaseGuard(m_loadProfiler);
 
 		bfs::path mapPath(filename);
 
@@ -116,6 +121,7 @@ namespace FIFE {
 							<< std::endl;
 						FL_ERR(_log, oss.str());
 
+						delete data;
 						return map;
 					}
 				}
@@ -168,60 +174,18 @@ namespace FIFE {
 					map->setFilename(mapFilename);
 
 					std::string ns = "";
+					std::vector<std::string> importFiles;
 					for (const TiXmlElement *importElement = root->FirstChildElement("import"); importElement; importElement = importElement->NextSiblingElement("import")) {
 						const std::string* importDir = importElement->Attribute(std::string("dir"));
 						const std::string* importFile = importElement->Attribute(std::string("file"));
 
-						std::string directory = "";
-						if (importDir) {
-							directory = *importDir;
-						}
-
-						std::string file = "";
-						if (importFile) {
-							file = *importFile;
-						}
-
-						if (importDir && !importFile) {
-							bfs::path fullPath(m_mapDirectory);
-							fullPath /= directory;
-							loadImportDirectory(fullPath.string());
-						}
-						else if (importFile) {
-							bfs::path fullFilePath(file);
-							bfs::path fullDirPath(directory);
-							if (importDir) {
-								fullDirPath = bfs::path(m_mapDirectory);
-								fullDirPath /= directory;
-							}
-							else {
-								fullFilePath = bfs::path(m_mapDirectory);
-								fullFilePath /= file;
-							}
-							loadImportFile(fullFilePath.string(), fullDirPath.string());
-						}
+						collectImportFiles(importFile ? *importFile : "", importDir ? *importDir : "", importFiles);
 					}
+					loadImportFiles(importFiles);
 					// converts multiobject part id to object pointer
-					std::list<std::string> namespaces = m_model->getNamespaces();
-					std::list<std::string>::iterator name_it = namespaces.begin();
-					for (; name_it != namespaces.end(); ++name_it) {
-						std::list<Object*> objects = m_model->getObjects(*name_it);
-						std::list<Object*>::iterator object_it = objects.begin();
-						for (; object_it != objects.end(); ++object_it) {
-							if ((*object_it)->isMultiObject()) {
-								const std::list<std::string>& multiParts = (*object_it)->getMultiPartIds();
-								std::list<std::string>::const_iterator multi_it = multiParts.begin();
-								for (; multi_it != multiParts.end(); ++multi_it) {
-									Object* partObj = m_model->getObject(*multi_it, *name_it);
-									if (partObj) {
-										partObj->setMultiPart(true);
-										(*object_it)->addMultiPart(partObj);
-									}
-								}
-							}
-						}
-					}
+					linkMultiObjectParts();
 
+					m_loadProfiler.beginPhase("layers");
 					// iterate over elements looking for layers
 					for (const TiXmlElement* layerElement = root->FirstChildElement("layer"); layerElement; layerElement = layerElement->NextSiblingElement("layer")) {
 						// defaults
@@ -381,6 +345,7 @@ namespace FIFE {
 													}
 
 													if (inst) {
+														m_loadProfiler.addCount();
 														if (rRetVal != TIXML_SUCCESS) {
 															ObjectVisual* objVisual = object->getVisual<ObjectVisual>();
 															std::vector<int> angles;
@@ -441,6 +406,7 @@ namespace FIFE {
 						m_percentDoneListener.incrementCount();
 					}
 					
+					m_loadProfiler.beginPhase("cellcaches");
 					// init CellCaches
 					map->initializeCellCaches();
 					// add Cells from xml File
@@ -472,6 +438,7 @@ namespace FIFE {
 											if (success == TIXML_SUCCESS) {
 												ModelCoordinate mc(cellX, cellY);
 												Cell* cell = cache->createCell(mc);
+												m_loadProfiler.addCount();
 
 												const std::string* cellBlocker = cellElement->Attribute(std::string("blocker_type"));
 												if (cellBlocker) {
@@ -578,6 +545,7 @@ namespace FIFE {
 						}
 					}
 
+					m_loadProfiler.beginPhase("triggers");
 					for (const TiXmlElement* triggerElements = root->FirstChildElement("triggers"); triggerElements; triggerElements = triggerElements->NextSiblingElement("triggers")) {
 						TriggerController* triggerController = map->getTriggerController();
 						for (const TiXmlElement* triggerElement = triggerElements->FirstChildElement("trigger"); triggerElement; triggerElement = triggerElement->NextSiblingElement("trigger")) {
@@ -588,6 +556,7 @@ namespace FIFE {
 							triggerElement->QueryIntAttribute("all_instances", &allInstances);
 							
 							Trigger* trigger = triggerController->createTrigger(*triggerName);
+							m_loadProfiler.addCount();
 							if (triggered > 0) {
 								trigger->setTriggered();
 							}
@@ -644,7 +613,7 @@ namespace FIFE {
 						}
 					}
 
-
+					m_loadProfiler.beginPhase("cameras");
 					for (const TiXmlElement* cameraElement = root->FirstChildElement("camera"); cameraElement; cameraElement = cameraElement->NextSiblingElement("camera")) {
 						const std::string* cameraId = cameraElement->Attribute(std::string("id"));
 
@@ -698,6 +667,7 @@ namespace FIFE {
 
 
 							if (cam) {
+								m_loadProfiler.addCount();
 								cam->setCellImageDimensions(refCellWidth, refCellHeight);
 								cam->setRotation(rotation);
 								cam->setTilt(tilt);
@@ -808,6 +778,73 @@ namespace FIFE {
 		return false;
 	}
 
+	void MapLoader::collectImportFiles(const std::string& file, const std::string& directory, std::vector<std::string>& files) const {
+		if (!directory.empty() && file.empty()) {
+			bfs::path fullPath(m_mapDirectory);
+			fullPath /= directory;
+			listImportFiles(m_vfs, fullPath.string(), files);
+		}
+		else if (!file.empty()) {
+			bfs::path fullFilePath(file);
+			bfs::path fullDirPath(directory);
+			if (!directory.empty()) {
+				fullDirPath = bfs::path(m_mapDirectory);
+				fullDirPath /= directory;
+			}
+			else {
+				fullFilePath = bfs::path(m_mapDirectory);
+				fullFilePath /= file;
+			}
+			bfs::path importFilePath(fullDirPath);
+			importFilePath /= fullFilePath;
+			files.push_back(importFilePath.string());
+		}
+	}
+
+	void MapLoader::loadImportFiles(const std::vector<std::string>& files) {
+		ObjectLoader* objectLoader = dynamic_cast<ObjectLoader*>(m_objectLoader.get());
+		if (objectLoader) {
+			// measures the phases imports and objects
+			objectLoader->setLoadProfiler(&m_loadProfiler);
+			try {
+				objectLoader->loadImportFiles(files);
+			}
+			catch (...) {
+				objectLoader->setLoadProfiler(0);
+				throw;
+			}
+			objectLoader->setLoadProfiler(0);
+			return;
+		}
+		m_loadProfiler.beginPhase("objects");
+		std::vector<std::string>::const_iterator it = files.begin();
+		for (; it != files.end(); ++it) {
+			loadImportFile(*it);
+		}
+	}
+
+	void MapLoader::linkMultiObjectParts() {
+		std::list<std::string> namespaces = m_model->getNamespaces();
+		std::list<std::string>::iterator name_it = namespaces.begin();
+		for (; name_it != namespaces.end(); ++name_it) {
+			std::list<Object*> objects = m_model->getObjects(*name_it);
+			std::list<Object*>::iterator object_it = objects.begin();
+			for (; object_it != objects.end(); ++object_it) {
+				if ((*object_it)->isMultiObject()) {
+					const std::list<std::string>& multiParts = (*object_it)->getMultiPartIds();
+					std::list<std::string>::const_iterator multi_it = multiParts.begin();
+					for (; multi_it != multiParts.end(); ++multi_it) {
+						Object* partObj = m_model->getObject(*multi_it, *name_it);
+						if (partObj) {
+							partObj->setMultiPart(true);
+							(*object_it)->addMultiPart(partObj);
+						}
+					}
+				}
+			}
+		}
+	}
+
 	void MapLoader::loadImportFile(const std::string& file, const std::string& directory) {
 		if (!file.empty()) {
 			bfs::path importFilePath(directory);
@@ -829,28 +866,10 @@ namespace FIFE {
 	void MapLoader::loadImportDirectory(const std::string& directory) {
 		if (!directory.empty()) {
 			bfs::path importDirectory(directory);
-			std::string importDirectoryString = importDirectory.string();
-
-			std::set<std::string> files = m_vfs->listFiles(importDirectoryString);
-
-			// load all xml files in the directory
-			std::set<std::string>::iterator iter;
-			for (iter = files.begin(); iter != files.end(); ++iter) {
-				// TODO - vtchill - may need a way to allow clients to load things other
-				// than .xml and .zip files
-				std::string ext = bfs::extension(*iter);
-				if (ext == ".xml" || ext == ".zip") {
-					loadImportFile(*iter, importDirectoryString);
-				}
-			}
 
-			std::set<std::string> nestedDirectories = m_vfs->listDirectories(importDirectoryString);
-			for (iter  = nestedDirectories.begin(); iter != nestedDirectories.end(); ++iter) {
-				// do not attempt to load anything from a .svn directory
-				if ((*iter).find(".svn") == std::string::npos) {
-					loadImportDirectory(importDirectoryString + "/" + *iter);
-				}
-			}
+			std::vector<std::string> files;
+			listImportFiles(m_vfs, importDirectory.string(), files);
+			loadImportFiles(files);
 		}
 	}
 
@@ -863,6 +882,17 @@ namespace FIFE {
 
 	}
 
+	void MapLoader::setLazyObjectLoading(bool lazy) {
+		ObjectLoader* objectLoader = dynamic_cast<ObjectLoader*>(m_objectLoader.get());
+		if (objectLoader) {
+			objectLoader->setLazyLoading(lazy);
+		}
+	}
+
+	const LoadProfile& MapLoader::getLoadProfile() const {
+		return m_loadProfiler.getProfile();
+	}
+
 	MapLoader* createDefaultMapLoader(Model* model, VFS* vfs, ImageManager* imageManager, RenderBackend* renderBackend) {
 		return (new MapLoader(model, vfs, imageManager, renderBackend));
 	}
@@ -35,6 +35,7 @@
 
 #include "imaploader.h"
 #include "ianimationloader.h"
+#include "loadprofiler.h"
 #include "percentdonelistener.h"
 
 namespace FIFE {
@@ -118,7 +119,30 @@ namespace FIFE {
 		*/
 		const std::string& getLoaderName() const;
 
-	private:
+		/** enables or disables lazy loading of the imported objects,
+		* only has an effect with the native object loader, see ObjectLoader::setLazyLoading
+		*/
+		void setLazyObjectLoading(bool lazy);
+
+		/** returns the measured phases of the last load, see PercentDoneListener::OnPhaseDone
+		*/
+		const LoadProfile& getLoadProfile() const;
+
+	protected:
+		/** appends the files of a map import to files, the import is a file, a directory
+		* or a file inside a directory, the paths are relative to the map directory
+		*/
+		void collectImportFiles(const std::string& file, const std::string& directory, std::vector<std::string>& files) const;
+
+		/** loads the import files in the given order, with the native object loader
+		* the files are parsed in parallel beforehand
+		*/
+		void loadImportFiles(const std::vector<std::string>& files);
+
+		/** converts the multi object part ids of all objects to object pointers
+		*/
+		void linkMultiObjectParts();
+
 		Model* m_model;
 		VFS* m_vfs;
 		ImageManager* m_imageManager;
@@ -126,6 +150,7 @@ namespace FIFE {
 		ObjectLoaderPtr m_objectLoader;
 		RenderBackend* m_renderBackend;
 		PercentDoneCallback m_percentDoneListener;
+		LoadProfiler m_loadProfiler;
 
 		std::string m_loaderName;
 		std::string m_mapDirectory;
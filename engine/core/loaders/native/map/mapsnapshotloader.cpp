@@ -0,0 +1,507 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstring>
+#include <list>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/model.h"
+#include "model/metamodel/ipather.h"
+#include "model/metamodel/object.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/location.h"
+#include "model/structures/map.h"
+#include "model/structures/trigger.h"
+#include "model/structures/triggercontroller.h"
+#include "pathfinder/route.h"
+#include "savers/native/map/mapsnapshotformat.h"
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+#include "vfs/raw/binarystream.h"
+#include "vfs/raw/rawdata.h"
+#include "vfs/vfs.h"
+#include "view/visual.h"
+
+#include "mapsnapshotloader.h"
+
+namespace FIFE {
+	static Logger _log(LM_NATIVE_LOADERS);
+
+	namespace {
+		Cell* readCell(BinaryReader& reader, Layer* layer) {
+			ModelCoordinate mc;
+			mc.x = reader.readInt32();
+			mc.y = reader.readInt32();
+			if (!layer || !layer->getCellCache()) {
+				return NULL;
+			}
+			return layer->getCellCache()->getCell(mc);
+		}
+
+		/** Reads the magic and version, returns false if the file is no supported snapshot.
+		 */
+		bool readHeader(BinaryReader& reader, uint32_t& version) {
+			uint8_t magic[sizeof(MapSnapshot::MAGIC)];
+			reader.readInto(magic, sizeof(magic));
+			if (std::memcmp(magic, MapSnapshot::MAGIC, sizeof(magic)) != 0) {
+				return false;
+			}
+			version = reader.read32();
+			return version >= 1 && version <= MapSnapshot::VERSION;
+		}
+	}
+
+	MapSnapshotLoader::MapSnapshotLoader(Model* model, VFS* vfs) :
+		m_model(model),
+		m_vfs(vfs) {
+	}
+
+	MapSnapshotLoader::~MapSnapshotLoader() {
+	}
+
+	bool MapSnapshotLoader::isLoadable(const std::string& filename) const {
+		if (!m_vfs->exists(filename)) {
+			return false;
+		}
+		RawData* data = m_vfs->open(filename);
+		bool loadable = false;
+		try {
+			BinaryReader reader(data);
+			uint32_t version = 0;
+			loadable = readHeader(reader, version);
+		} catch (const Exception&) {
+			loadable = false;
+		}
+		delete data;
+		return loadable;
+	}
+
+	void MapSnapshotLoader::load(Map* map, const std::string& filename) {
+		RawData* data = m_vfs->openMapped(filename);
+		try {
+			BinaryReader reader(data);
+			uint32_t version = 0;
+			if (!readHeader(reader, version)) {
+				throw InvalidFormat(filename + " is no supported map snapshot");
+			}
+
+			std::string mapId = reader.readString();
+			if (mapId != map->getId()) {
+				FL_WARN(_log, LMsg("snapshot ") << filename << " was saved from map " << mapId << ", loading it into " << map->getId());
+			}
+			float timeMultiplier = reader.readFloat();
+
+			uint32_t layerCount = reader.read32();
+			m_layers.assign(layerCount, NULL);
+			for (uint32_t i = 0; i < layerCount; ++i) {
+				std::string layerId = reader.readString();
+				m_layers[i] = map->getLayer(layerId);
+				if (!m_layers[i]) {
+					FL_WARN(_log, LMsg("snapshot layer ") << layerId << " does not exist, its content is skipped");
+				}
+			}
+
+			clearMap(map);
+			map->setTimeMultiplier(timeMultiplier);
+
+			m_instances.assign(layerCount, std::vector<Instance*>());
+			for (uint32_t i = 0; i < layerCount; ++i) {
+				uint32_t count = reader.read32();
+				m_instances[i].reserve(count);
+				for (uint32_t j = 0; j < count; ++j) {
+					m_instances[i].push_back(readInstance(reader, m_layers[i]));
+				}
+			}
+
+			// the leaders exist now
+			for (std::vector<PendingFollow>::iterator it = m_follows.begin(); it != m_follows.end(); ++it) {
+				Instance* leader = getInstance(it->leaderLayer, it->leaderIndex);
+				if (!leader) {
+					continue;
+				}
+				it->instance->follow(it->action, leader, it->speed);
+				it->instance->setActionRuntime(it->runtime);
+			}
+
+			uint32_t cacheCount = reader.read32();
+			for (uint32_t i = 0; i < cacheCount; ++i) {
+				readCellCache(reader);
+			}
+
+			uint32_t triggerCount = reader.read32();
+			for (uint32_t i = 0; i < triggerCount; ++i) {
+				readTrigger(reader, map);
+			}
+
+			if (reader.read32() != MapSnapshot::SNAPSHOT_END) {
+				throw InvalidFormat(filename + " has a invalid map snapshot end marker");
+			}
+			FL_LOG(_log, LMsg("loaded snapshot ") << filename << " into map " << map->getId());
+		} catch (...) {
+			m_layers.clear();
+			m_instances.clear();
+			m_follows.clear();
+			delete data;
+			throw;
+		}
+		m_layers.clear();
+		m_instances.clear();
+		m_follows.clear();
+		delete data;
+	}
+
+	void MapSnapshotLoader::clearMap(Map* map) {
+		// triggers first, attached ones listen to the instances
+		TriggerController* triggerController = map->getTriggerController();
+		std::vector<std::string> triggers = triggerController->getAllTriggerNames();
+		for (std::vector<std::string>::iterator it = triggers.begin(); it != triggers.end(); ++it) {
+			triggerController->deleteTrigger(*it);
+		}
+
+		const std::list<Layer*>& layers = map->getLayers();
+		for (std::list<Layer*>::const_iterator it = layers.begin(); it != layers.end(); ++it) {
+			(*it)->deleteInstances();
+		}
+
+		// only object areas and blockers depend on instances, the rest is reset here
+		for (std::list<Layer*>::const_iterator it = layers.begin(); it != layers.end(); ++it) {
+			CellCache* cache = (*it)->getCellCache();
+			if (!cache) {
+				continue;
+			}
+			cache->unregisterAllCosts();
+			std::vector<std::string> areas = cache->getAreas();
+			for (std::vector<std::string>::iterator ait = areas.begin(); ait != areas.end(); ++ait) {
+				cache->removeArea(*ait);
+			}
+			cache->resetNarrowCells();
+
+			const std::vector<Cell*>& cells = cache->getCells();
+			for (std::vector<Cell*>::const_iterator cell = cells.begin(); cell != cells.end(); ++cell) {
+				(*cell)->resetCostMultiplier();
+				(*cell)->resetSpeedMultiplier();
+				(*cell)->deleteTransition();
+				CellTypeInfo cti = (*cell)->getCellType();
+				if (cti == CTYPE_CELL_NO_BLOCKER || cti == CTYPE_CELL_BLOCKER) {
+					(*cell)->setCellType(CTYPE_NO_BLOCKER);
+				}
+			}
+		}
+	}
+
+	Instance* MapSnapshotLoader::readInstance(BinaryReader& reader, Layer* layer) {
+		std::string id = reader.readString();
+		std::string nameSpace = reader.readString();
+		std::string objectId = reader.readString();
+		ExactModelCoordinate emc;
+		emc.x = reader.readDouble();
+		emc.y = reader.readDouble();
+		emc.z = reader.readDouble();
+		int32_t rotation = reader.readInt32();
+		uint8_t flags = reader.read8();
+		uint8_t cellStack = reader.read8();
+		int32_t stackPos = reader.readInt32();
+		uint8_t transparency = reader.read8();
+		float timeMultiplier = reader.readFloat();
+		std::string costId;
+		double cost = 0.0;
+		if (flags & MapSnapshot::INSTANCE_SPECIAL_COST) {
+			costId = reader.readString();
+			cost = reader.readDouble();
+		}
+
+		Instance* instance = NULL;
+		Object* object = layer ? m_model->getObject(objectId, nameSpace) : NULL;
+		if (object) {
+			instance = layer->createInstance(object, emc, id);
+			instance->setRotation(rotation);
+			InstanceVisual* visual = InstanceVisual::create(instance);
+			if (visual) {
+				visual->setStackPosition(stackPos);
+				if (transparency != 0) {
+					visual->setTransparency(transparency);
+				}
+				if (!(flags & MapSnapshot::INSTANCE_VISIBLE)) {
+					visual->setVisible(false);
+				}
+			}
+			instance->setCellStackPosition(cellStack);
+			instance->setBlocking((flags & MapSnapshot::INSTANCE_BLOCKING) != 0);
+			instance->setOverrideBlocking((flags & MapSnapshot::INSTANCE_OVERRIDE_BLOCKING) != 0);
+			if (flags & MapSnapshot::INSTANCE_SPECIAL_COST) {
+				instance->setCost(costId, cost);
+			} else if (instance->isSpecialCost()) {
+				instance->resetCost();
+			}
+			if (timeMultiplier != 1.0f) {
+				instance->setTimeMultiplier(timeMultiplier);
+			}
+		} else if (layer) {
+			FL_WARN(_log, LMsg("object ") << objectId << " in namespace " << nameSpace << " does not exist, instance " << id << " is skipped");
+		}
+
+		if (flags & MapSnapshot::INSTANCE_ACTION) {
+			readAction(reader, instance);
+		}
+		return instance;
+	}
+
+	void MapSnapshotLoader::readAction(BinaryReader& reader, Instance* instance) {
+		uint8_t kind = reader.read8();
+		std::string actionId = reader.readString();
+		uint32_t runtime = reader.read32();
+		if (instance && !instance->getObject()->getAction(actionId)) {
+			FL_WARN(_log, LMsg("action ") << actionId << " does not exist, instance " << instance->getId() << " stays idle");
+			instance = NULL;
+		}
+
+		if (kind == MapSnapshot::ACTION_ONCE || kind == MapSnapshot::ACTION_REPEAT) {
+			if (instance) {
+				if (kind == MapSnapshot::ACTION_REPEAT) {
+					instance->actRepeat(actionId, instance->getRotation());
+				} else {
+					instance->actOnce(actionId, instance->getRotation());
+				}
+				instance->setActionRuntime(runtime);
+			}
+			return;
+		}
+
+		double speed = reader.readDouble();
+		if (kind == MapSnapshot::ACTION_FOLLOW) {
+			PendingFollow follow;
+			follow.instance = instance;
+			follow.action = actionId;
+			follow.runtime = runtime;
+			follow.speed = speed;
+			follow.leaderLayer = reader.read32();
+			follow.leaderIndex = reader.read32();
+			if (instance) {
+				m_follows.push_back(follow);
+			}
+			return;
+		}
+
+		if (kind != MapSnapshot::ACTION_MOVE) {
+			throw InvalidFormat("unknown action kind in map snapshot");
+		}
+
+		uint32_t targetLayer = reader.read32();
+		ExactModelCoordinate emc;
+		emc.x = reader.readDouble();
+		emc.y = reader.readDouble();
+		emc.z = reader.readDouble();
+		std::string costId = reader.readString();
+		uint32_t walked = reader.read32();
+		uint32_t nodeCount = reader.read32();
+
+		Path path;
+		bool validPath = true;
+		for (uint32_t i = 0; i < nodeCount; ++i) {
+			uint32_t nodeLayer = reader.read32();
+			ModelCoordinate mc;
+			mc.x = reader.readInt32();
+			mc.y = reader.readInt32();
+			mc.z = reader.readInt32();
+			if (nodeLayer >= m_layers.size() || !m_layers[nodeLayer]) {
+				validPath = false;
+				continue;
+			}
+			Location node(m_layers[nodeLayer]);
+			node.setLayerCoordinates(mc);
+			path.push_back(node);
+		}
+
+		if (!instance || targetLayer >= m_layers.size() || !m_layers[targetLayer]) {
+			return;
+		}
+
+		Location target(m_layers[targetLayer]);
+		target.setExactLayerCoordinates(emc);
+		instance->move(actionId, target, speed, costId);
+		Route* route = instance->getRoute();
+		if (!route) {
+			FL_WARN(_log, LMsg("route of instance ") << instance->getId() << " could not be restored");
+			return;
+		}
+
+		// replace the new search with the saved path, moves that were still
+		// searching their route keep the search started by move
+		if (validPath && !path.empty()) {
+			if (route->getSessionId() != -1) {
+				instance->getObject()->getPather()->cancelSession(route->getSessionId());
+				route->setSessionId(-1);
+			}
+			route->setPath(path);
+			if (walked > 1) {
+				route->walkToNextNode(static_cast<int32_t>(walked) - 1);
+			}
+		}
+		instance->setActionRuntime(runtime);
+	}
+
+	void MapSnapshotLoader::readCellCache(BinaryReader& reader) {
+		uint32_t layerIndex = reader.read32();
+		Layer* layer = layerIndex < m_layers.size() ? m_layers[layerIndex] : NULL;
+		CellCache* cache = layer ? layer->getCellCache() : NULL;
+
+		double defaultCost = reader.readDouble();
+		double defaultSpeed = reader.readDouble();
+		bool searchNarrow = reader.read8() != 0;
+		if (cache) {
+			cache->setDefaultCostMultiplier(defaultCost);
+			cache->setDefaultSpeedMultiplier(defaultSpeed);
+			cache->setSearchNarrowCells(searchNarrow);
+		} else if (layer) {
+			FL_WARN(_log, LMsg("layer ") << layer->getId() << " has no cellcache, its snapshot state is skipped");
+		}
+
+		uint32_t costCount = reader.read32();
+		for (uint32_t i = 0; i < costCount; ++i) {
+			std::string costId = reader.readString();
+			double cost = reader.readDouble();
+			if (cache) {
+				cache->registerCost(costId, cost);
+			}
+			uint32_t cellCount = reader.read32();
+			for (uint32_t j = 0; j < cellCount; ++j) {
+				Cell* cell = readCell(reader, layer);
+				if (cell) {
+					cache->addCellToCost(costId, cell);
+				}
+			}
+		}
+
+		uint32_t areaCount = reader.read32();
+		for (uint32_t i = 0; i < areaCount; ++i) {
+			std::string areaId = reader.readString();
+			uint32_t cellCount = reader.read32();
+			for (uint32_t j = 0; j < cellCount; ++j) {
+				Cell* cell = readCell(reader, layer);
+				if (cell) {
+					cache->addCellToArea(areaId, cell);
+				}
+			}
+		}
+
+		uint32_t cellCount = reader.read32();
+		for (uint32_t i = 0; i < cellCount; ++i) {
+			Cell* cell = readCell(reader, layer);
+			uint8_t flags = reader.read8();
+			if (flags & MapSnapshot::CELL_COST_MULTIPLIER) {
+				double multi = reader.readDouble();
+				if (cell) {
+					cell->setCostMultiplier(multi);
+				}
+			}
+			if (flags & MapSnapshot::CELL_SPEED_MULTIPLIER) {
+				double multi = reader.readDouble();
+				if (cell) {
+					cell->setSpeedMultiplier(multi);
+				}
+			}
+			if ((flags & MapSnapshot::CELL_NARROW) && cell) {
+				cache->addNarrowCell(cell);
+			}
+			if (flags & MapSnapshot::CELL_TRANSITION) {
+				uint32_t targetIndex = reader.read32();
+				ModelCoordinate mc;
+				mc.x = reader.readInt32();
+				mc.y = reader.readInt32();
+				mc.z = reader.readInt32();
+				bool immediate = reader.read8() != 0;
+				Layer* target = targetIndex < m_layers.size() ? m_layers[targetIndex] : NULL;
+				if (cell && target && target->getCellCache()) {
+					cell->createTransition(target, mc, immediate);
+				}
+			}
+			if (flags & MapSnapshot::CELL_TYPE) {
+				CellTypeInfo cti = static_cast<CellTypeInfo>(reader.read8());
+				if (cell) {
+					cell->setCellType(cti);
+				}
+			}
+		}
+	}
+
+	void MapSnapshotLoader::readTrigger(BinaryReader& reader, Map* map) {
+		std::string name = reader.readString();
+		Trigger* trigger = map->getTriggerController()->createTrigger(name);
+		uint8_t flags = reader.read8();
+		if (flags & MapSnapshot::TRIGGER_ATTACHED) {
+			uint32_t layerIndex = reader.read32();
+			uint32_t instanceIndex = reader.read32();
+			Instance* instance = getInstance(layerIndex, instanceIndex);
+			if (instance) {
+				trigger->attach(instance);
+			}
+		}
+		if (flags & MapSnapshot::TRIGGER_ALL_INSTANCES) {
+			trigger->enableForAllInstances();
+		}
+
+		uint32_t conditionCount = reader.read32();
+		for (uint32_t i = 0; i < conditionCount; ++i) {
+			trigger->addTriggerCondition(static_cast<TriggerCondition>(reader.readInt32()));
+		}
+
+		uint32_t cellCount = reader.read32();
+		for (uint32_t i = 0; i < cellCount; ++i) {
+			uint32_t layerIndex = reader.read32();
+			Layer* layer = layerIndex < m_layers.size() ? m_layers[layerIndex] : NULL;
+			Cell* cell = readCell(reader, layer);
+			if (cell) {
+				trigger->assign(cell);
+			}
+		}
+
+		uint32_t instanceCount = reader.read32();
+		for (uint32_t i = 0; i < instanceCount; ++i) {
+			uint32_t layerIndex = reader.read32();
+			uint32_t instanceIndex = reader.read32();
+			Instance* instance = getInstance(layerIndex, instanceIndex);
+			if (instance) {
+				trigger->enableForInstance(instance);
+			}
+		}
+
+		// no listeners are registered yet, so this only restores the state
+		if (flags & MapSnapshot::TRIGGER_TRIGGERED) {
+			trigger->setTriggered();
+		}
+	}
+
+	Instance* MapSnapshotLoader::getInstance(uint32_t layer, uint32_t index) const {
+		if (layer >= m_instances.size() || index >= m_instances[layer].size()) {
+			return NULL;
+		}
+		return m_instances[layer][index];
+	}
+}
@@ -0,0 +1,104 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MAPSNAPSHOTLOADER_H_
+#define FIFE_MAPSNAPSHOTLOADER_H_
+
+// Standard C++ library includes
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+namespace FIFE {
+	class Model;
+	class Map;
+	class VFS;
+	class Layer;
+	class Instance;
+	class BinaryReader;
+
+	/** Restores the runtime state of a map from a snapshot written by MapSnapshotSaver.
+	 *
+	 * The instances, triggers and modified cellcache state of the map are replaced
+	 * by the ones of the snapshot. The layers and objects must already exist, e.g.
+	 * by loading the map file first. Unknown layers and objects are skipped with a warning.
+	 */
+	class MapSnapshotLoader {
+	public:
+		MapSnapshotLoader(Model* model, VFS* vfs);
+
+		~MapSnapshotLoader();
+
+		/** Checks if the file is a snapshot with a supported version.
+		 */
+		bool isLoadable(const std::string& filename) const;
+
+		/** Replaces the runtime state of the map with the one of the snapshot.
+		 * @param map The map to restore.
+		 * @param filename The snapshot file.
+		 * @throws InvalidFormat if the file is no snapshot or has a unsupported version
+		 * @throws IndexOverflow if the file is truncated
+		 */
+		void load(Map* map, const std::string& filename);
+
+	private:
+		/** Removes the instances, triggers and custom cellcache state of the map.
+		 */
+		void clearMap(Map* map);
+
+		Instance* readInstance(BinaryReader& reader, Layer* layer);
+
+		void readAction(BinaryReader& reader, Instance* instance);
+
+		void readCellCache(BinaryReader& reader);
+
+		void readTrigger(BinaryReader& reader, Map* map);
+
+		Instance* getInstance(uint32_t layer, uint32_t index) const;
+
+		Model* m_model;
+		VFS* m_vfs;
+
+		//! layers of the snapshot layer table, NULL for unknown layers
+		std::vector<Layer*> m_layers;
+		//! instances of the snapshot per layer, NULL for skipped instances
+		std::vector<std::vector<Instance*> > m_instances;
+
+		//! follow actions, applied after all instances exist
+		struct PendingFollow {
+			Instance* instance;
+			std::string action;
+			uint32_t runtime;
+			double speed;
+			uint32_t leaderLayer;
+			uint32_t leaderIndex;
+		};
+		std::vector<PendingFollow> m_follows;
+	};
+}
+
+#endif
@@ -20,6 +20,7 @@
 ***************************************************************************/
 
 // Standard C++ library includes
+#include <set>
 
 // 3rd party library includes
 #include <tinyxml.h>
@@ -43,6 +44,8 @@
 #include "atlasloader.h"
 #include "objectloader.h"
 #include "animationloader.h"
+#include "loadprofiler.h"
+#include "xmldocumentcache.h"
 
 namespace FIFE {
 	/** Logger to use for this source file.
@@ -51,7 +54,7 @@ namespace FIFE {
 	static Logger _log(LM_NATIVE_LOADERS);
 
 	ObjectLoader::ObjectLoader(Model* model, VFS* vfs, ImageManager* imageManager, AnimationManager* animationManager, const AnimationLoaderPtr& animationLoader, const AtlasLoaderPtr& atlasLoader)
-	: m_model(model), m_vfs(vfs), m_imageManager(imageManager), m_animationManager(animationManager) {
+	: m_model(model), m_vfs(vfs), m_imageManager(imageManager), m_animationManager(animationManager), m_documentCache(0), m_lazyLoading(false), m_loadProfiler(0), m_createdObjects(0) {
 		assert(m_model && m_vfs && m_imageManager && m_animationManager);
 
 		if (animationLoader) {
@@ -70,7 +73,12 @@ namespace FIFE {
 	}
 
 	ObjectLoader::~ObjectLoader() {
-
+		// the model clears our deferred objects when it is destroyed first,
+		// so it is only used here while it is still alive
+		if (!m_deferredObjects.empty()) {
+			m_model->removeObjectProvider(this);
+		}
+		clearDeferredObjects();
 	}
 
 	void ObjectLoader::setAnimationLoader(const AnimationLoaderPtr& animationLoader) {
@@ -98,15 +106,29 @@ namespace FIFE {
 
 		TiXmlDocument objectFile;
 
-		try {
-			RawData* data = m_vfs->open(objectPath.string());
-
-			if (data) {
-				if (data->getDataLength() != 0) {
-					objectFile.Parse(data->readString(data->getDataLength()).c_str());
-
-					if (objectFile.Error()) {
-						 std::ostringstream oss;
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(objectPath.string()) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(objectPath.string());
+
+				if (data) {
+					if (data->getDataLength() != 0) {
+						objectFile.Parse(data->readString(data->getDataLength()).c_str());
+
+						if (objectFile.Error()) {
+							 std::ostringstream oss;
+							oss << " Failed to load"
+								<< objectPath.string()
+								<< " : " << __FILE__
+								<< " [" << __LINE__ << "]"
+								<< std::endl;
+							FL_ERR(_log, oss.str());
+
+							return false;
+						}
+					}
+					else {
+						std::ostringstream oss;
 						oss << " Failed to load"
 							<< objectPath.string()
 							<< " : " << __FILE__
@@ -116,6 +138,10 @@ namespace FIFE {
 
 						return false;
 					}
+
+					// done with data delete resource
+					delete data;
+					data = 0;
 				}
 				else {
 					std::ostringstream oss;
@@ -128,12 +154,8 @@ namespace FIFE {
 
 					return false;
 				}
-
-				// done with data delete resource
-				delete data;
-				data = 0;
 			}
-			else {
+			catch (NotFound&) {
 				std::ostringstream oss;
 				oss << " Failed to load"
 					<< objectPath.string()
@@ -142,27 +164,17 @@ namespace FIFE {
 					<< std::endl;
 				FL_ERR(_log, oss.str());
 
+				// TODO - should we abort here
+				//        or rethrow the exception
+				//        or just keep going
+
 				return false;
 			}
-		}
-		catch (NotFound&) {
-			std::ostringstream oss;
-			oss << " Failed to load"
-				<< objectPath.string()
-				<< " : " << __FILE__
-				<< " [" << __LINE__ << "]"
-				<< std::endl;
-			FL_ERR(_log, oss.str());
-
-			// TODO - should we abort here
-			//        or rethrow the exception
-			//        or just keep going
-
-			return false;
+			document = &objectFile;
 		}
 
 		// if we get here then loading the file went well
-		TiXmlElement* root = objectFile.RootElement();
+		TiXmlElement* root = document->RootElement();
 
 		if (root && root->ValueStr() == "assets") {
 			if (root->FirstChildElement("object")) {
@@ -178,37 +190,41 @@ namespace FIFE {
 
 		TiXmlDocument objectFile;
 
-		try {
-			RawData* data = m_vfs->open(objectPath.string());
+		TiXmlDocument* document = m_documentCache ? m_documentCache->get(objectPath.string()) : 0;
+		if (!document) {
+			try {
+				RawData* data = m_vfs->open(objectPath.string());
 
-			if (data) {
-				if (data->getDataLength() != 0) {
-					objectFile.Parse(data->readString(data->getDataLength()).c_str());
+				if (data) {
+					if (data->getDataLength() != 0) {
+						objectFile.Parse(data->readString(data->getDataLength()).c_str());
 
-					if (objectFile.Error()) {
-						return;
+						if (objectFile.Error()) {
+							return;
+						}
 					}
-				}
 
-				// done with data delete resource
-				delete data;
-				data = 0;
+					// done with data delete resource
+					delete data;
+					data = 0;
+				}
 			}
-		}
-		catch (NotFound&) {
-			std::ostringstream oss;
-			oss << " Failed to load"
-				<< objectPath.string()
-				<< " : " << __FILE__
-				<< " [" << __LINE__ << "]"
-				<< std::endl;
-			FL_ERR(_log, oss.str());
-
-			// TODO - should we abort here
-			//        or rethrow the exception
-			//        or just keep going
+			catch (NotFound&) {
+				std::ostringstream oss;
+				oss << " Failed to load"
+					<< objectPath.string()
+					<< " : " << __FILE__
+					<< " [" << __LINE__ << "]"
+					<< std::endl;
+				FL_ERR(_log, oss.str());
 
-			return;
+				// TODO - should we abort here
+				//        or rethrow the exception
+				//        or just keep going
+
+				return;
+			}
+			document = &objectFile;
 		}
 		std::string objectDirectory = "";
 		if (HasParentPath(objectPath)) {
@@ -216,7 +232,7 @@ namespace FIFE {
 		}
 
 		// if we get here then loading the file went well
-		TiXmlElement* root = objectFile.RootElement();
+		TiXmlElement* root = document->RootElement();
 		if (root) {
 			for (const TiXmlElement *importElement = root->FirstChildElement("import"); importElement; importElement = importElement->NextSiblingElement("import")) {
 				const std::string* importDir = importElement->Attribute(std::string("dir"));
@@ -252,424 +268,524 @@ namespace FIFE {
 		}
 
 		if (root && root->ValueStr() == "assets") {
+			if (m_lazyLoading) {
+				// only the ids are indexed, the objects are created on first use
+				deferObjects(filename, *document);
+				return;
+			}
 			for (TiXmlElement* objectElem = root->FirstChildElement("object"); objectElem; objectElem = objectElem->NextSiblingElement("object")) {
-				const std::string* objectId = objectElem->Attribute(std::string("id"));
-				const std::string* namespaceId = objectElem->Attribute(std::string("namespace"));
-
-				Object* obj = NULL;
-				if (objectId && namespaceId) {
-					const std::string* parentId = objectElem->Attribute(std::string("parent"));
-
-					if (parentId) {
-						Object* parent = m_model->getObject(*parentId, *namespaceId);
-						if (parent) {
-							try {
-								obj = m_model->createObject(*objectId, *namespaceId, parent);
-							}
-							catch  (NameClash&) {
-								// TODO - handle exception
-								assert(false);
-							}
-						}
-					} else {
-						// this will make sure the object has not already been loaded
-						if (m_model->getObject(*objectId, *namespaceId) == NULL) {
-							try {
-								obj = m_model->createObject(*objectId, *namespaceId);
-							}
-							catch (NameClash &e) {
-								FL_ERR(_log, e.what());
+				loadObject(filename, root, objectElem);
+			}
+		}
+	}
 
-								// TODO - handle exception
-								assert(false);
-							}
+	Object* ObjectLoader::loadObject(const std::string& filename, TiXmlElement* root, TiXmlElement* objectElem) {
+		bfs::path objectPath(filename);
+
+		const std::string* objectId = objectElem->Attribute(std::string("id"));
+		const std::string* namespaceId = objectElem->Attribute(std::string("namespace"));
+
+		Object* obj = NULL;
+		if (objectId && namespaceId) {
+			const std::string* parentId = objectElem->Attribute(std::string("parent"));
+
+			if (parentId) {
+				Object* parent = m_model->getObject(*parentId, *namespaceId);
+				if (parent) {
+					try {
+						obj = m_model->createObject(*objectId, *namespaceId, parent);
+					}
+					catch  (NameClash&) {
+						// TODO - handle exception
+						assert(false);
+					}
+				}
+			} else {
+				// this will make sure the object has not already been loaded
+				if (m_model->getObject(*objectId, *namespaceId) == NULL) {
+					try {
+						obj = m_model->createObject(*objectId, *namespaceId);
+					}
+					catch (NameClash &e) {
+						FL_ERR(_log, e.what());
+
+						// TODO - handle exception
+						assert(false);
+					}
+				}
+			}
+		}
+
+		if (obj) {
+			++m_createdObjects;
+			obj->setFilename(objectPath.string());
+			ObjectVisual::create(obj);
+
+			int isBlocking = 0;
+			objectElem->QueryIntAttribute("blocking", &isBlocking);
+			obj->setBlocking(isBlocking!=0);
+
+			int isStatic = 0;
+			objectElem->QueryIntAttribute("static", &isStatic);
+			obj->setStatic(isStatic!=0);
+
+			const std::string* pather = objectElem->Attribute(std::string("pather"));
+
+			if (pather) {
+				obj->setPather(m_model->getPather(*pather));
+			}
+			else {
+				obj->setPather(m_model->getPather("RoutePather"));
+			}
+		
+			const std::string* costId = objectElem->Attribute(std::string("cost_id"));
+			if (costId) {
+				obj->setCostId(*costId);
+				double cost = 1.0;
+				int success = objectElem->QueryDoubleAttribute("cost", &cost);
+				if (success == TIXML_SUCCESS) {
+					obj->setCost(cost);
+				}
+			}
+		
+			const std::string* areaId = objectElem->Attribute(std::string("area_id"));
+			if (areaId) {
+				obj->setArea(*areaId);
+			}
+
+			double speed = 1.0;
+			int success = root->QueryDoubleAttribute("speed", &speed);
+			if (success == TIXML_SUCCESS) {
+				obj->setSpeed(speed);
+			}
+
+			// loop over all walkable areas
+			for (TiXmlElement* walkableElement = objectElem->FirstChildElement("walkable_area"); walkableElement; walkableElement = walkableElement->NextSiblingElement("walkable_area")) {
+				const std::string* walkableId = walkableElement->Attribute(std::string("id"));
+				if (walkableId) {
+					obj->addWalkableArea(*walkableId);
+				}
+			}
+
+			int cellStack = 0;
+			objectElem->QueryIntAttribute("cellstack", &cellStack);
+			obj->setCellStackPosition(cellStack);
+		
+			double ax = 0;
+			double ay = 0;
+			double az = 0;
+
+			int xRetVal = objectElem->QueryValueAttribute("anchor_x", &ax);
+			int yRetVal = objectElem->QueryValueAttribute("anchor_y", &ay);
+			if (xRetVal == TIXML_SUCCESS && yRetVal == TIXML_SUCCESS) {
+				obj->setRotationAnchor(ExactModelCoordinate(ax, ay, az));
+			}
+
+			int isRestrictedRotation = 0;
+			objectElem->QueryIntAttribute("restricted_rotation", &isRestrictedRotation);
+			obj->setRestrictedRotation(isRestrictedRotation!=0);
+
+			int zStep = 0;
+			int zRetVal = objectElem->QueryIntAttribute("z_step_limit", &zStep);
+			if (zRetVal == TIXML_SUCCESS) {
+				obj->setZStepRange(zStep);
+			}
+
+			// loop over all multi parts
+			for (TiXmlElement* multiElement = objectElem->FirstChildElement("multipart"); multiElement; multiElement = multiElement->NextSiblingElement("multipart")) {
+				const std::string* partId = multiElement->Attribute(std::string("id"));
+				if (partId) {
+					obj->addMultiPartId(*partId);
+				}
+				for (TiXmlElement* multiRotation = multiElement->FirstChildElement("rotation"); multiRotation; multiRotation = multiRotation->NextSiblingElement("rotation")) {
+					int rotation = 0;
+					multiRotation->QueryIntAttribute("rot", &rotation);
+					// relative coordinates which are used to position the object
+					for (TiXmlElement* multiCoordinate = multiRotation->FirstChildElement("occupied_coord"); multiCoordinate; multiCoordinate = multiCoordinate->NextSiblingElement("occupied_coord")) {
+						int x = 0;
+						int y = 0;
+						xRetVal = multiCoordinate->QueryValueAttribute("x", &x);
+						yRetVal = multiCoordinate->QueryValueAttribute("y", &y);
+						if (xRetVal == TIXML_SUCCESS && yRetVal == TIXML_SUCCESS) {
+							int z = 0;
+							multiCoordinate->QueryIntAttribute("z", &z);
+							obj->addMultiPartCoordinate(rotation, ModelCoordinate(x, y, z));
 						}
 					}
 				}
+			}
 
-				if (obj) {
-					obj->setFilename(objectPath.string());
-					ObjectVisual::create(obj);
+			// loop over all image tags
+			for (TiXmlElement* imageElement = objectElem->FirstChildElement("image"); imageElement; imageElement = imageElement->NextSiblingElement("image")) {
+				const std::string* sourceId = imageElement->Attribute(std::string("source"));
 
-					int isBlocking = 0;
-					objectElem->QueryIntAttribute("blocking", &isBlocking);
-					obj->setBlocking(isBlocking!=0);
+				if (sourceId) {
+					bfs::path imagePath(filename);
 
-					int isStatic = 0;
-					objectElem->QueryIntAttribute("static", &isStatic);
-					obj->setStatic(isStatic!=0);
+					if (HasParentPath(imagePath)) {
+						imagePath = GetParentPath(imagePath) / *sourceId;
+					} else {
+						imagePath = bfs::path(*sourceId);
+					}
 
-					const std::string* pather = objectElem->Attribute(std::string("pather"));
+					if (!bfs::exists(imagePath)) {
+						imagePath= bfs::path(*sourceId);
+					}
 
-					if (pather) {
-						obj->setPather(m_model->getPather(*pather));
+					ImagePtr imagePtr;
+					if(!m_imageManager->exists(imagePath.string())) {
+						imagePtr = m_imageManager->create(imagePath.string());
 					}
 					else {
-						obj->setPather(m_model->getPather("RoutePather"));
+						imagePtr = m_imageManager->getPtr(imagePath.string());
 					}
-				
-					const std::string* costId = objectElem->Attribute(std::string("cost_id"));
-					if (costId) {
-						obj->setCostId(*costId);
-						double cost = 1.0;
-						int success = objectElem->QueryDoubleAttribute("cost", &cost);
+
+					if (imagePtr) {
+						int xOffset = 0;
+						int success = imageElement->QueryIntAttribute("x_offset", &xOffset);
+
 						if (success == TIXML_SUCCESS) {
-							obj->setCost(cost);
+							imagePtr->setXShift(xOffset);
 						}
-					}
-				
-					const std::string* areaId = objectElem->Attribute(std::string("area_id"));
-					if (areaId) {
-						obj->setArea(*areaId);
-					}
 
-					double speed = 1.0;
-					int success = root->QueryDoubleAttribute("speed", &speed);
-					if (success == TIXML_SUCCESS) {
-						obj->setSpeed(speed);
-					}
+						int yOffset = 0;
+						success = imageElement->QueryIntAttribute("y_offset", &yOffset);
 
-					// loop over all walkable areas
-					for (TiXmlElement* walkableElement = objectElem->FirstChildElement("walkable_area"); walkableElement; walkableElement = walkableElement->NextSiblingElement("walkable_area")) {
-						const std::string* walkableId = walkableElement->Attribute(std::string("id"));
-						if (walkableId) {
-							obj->addWalkableArea(*walkableId);
+						if (success == TIXML_SUCCESS) {
+							imagePtr->setYShift(yOffset);
 						}
-					}
 
-					int cellStack = 0;
-					objectElem->QueryIntAttribute("cellstack", &cellStack);
-					obj->setCellStackPosition(cellStack);
-				
-					double ax = 0;
-					double ay = 0;
-					double az = 0;
-
-					int xRetVal = objectElem->QueryValueAttribute("anchor_x", &ax);
-					int yRetVal = objectElem->QueryValueAttribute("anchor_y", &ay);
-					if (xRetVal == TIXML_SUCCESS && yRetVal == TIXML_SUCCESS) {
-						obj->setRotationAnchor(ExactModelCoordinate(ax, ay, az));
-					}
+						int direction = 0;
+						success = imageElement->QueryIntAttribute("direction", &direction);
 
-					int isRestrictedRotation = 0;
-					objectElem->QueryIntAttribute("restricted_rotation", &isRestrictedRotation);
-					obj->setRestrictedRotation(isRestrictedRotation!=0);
+						if (success == TIXML_SUCCESS) {
+							ObjectVisual* objVisual = obj->getVisual<ObjectVisual>();
 
-					int zStep = 0;
-					int zRetVal = objectElem->QueryIntAttribute("z_step_limit", &zStep);
-					if (zRetVal == TIXML_SUCCESS) {
-						obj->setZStepRange(zStep);
+							if (objVisual) {
+								objVisual->addStaticImage(direction, static_cast<int32_t>(imagePtr->getHandle()));
+							}
+						}
 					}
+				}
+			}
 
-					// loop over all multi parts
-					for (TiXmlElement* multiElement = objectElem->FirstChildElement("multipart"); multiElement; multiElement = multiElement->NextSiblingElement("multipart")) {
-						const std::string* partId = multiElement->Attribute(std::string("id"));
-						if (partId) {
-							obj->addMultiPartId(*partId);
-						}
-						for (TiXmlElement* multiRotation = multiElement->FirstChildElement("rotation"); multiRotation; multiRotation = multiRotation->NextSiblingElement("rotation")) {
-							int rotation = 0;
-							multiRotation->QueryIntAttribute("rot", &rotation);
-							// relative coordinates which are used to position the object
-							for (TiXmlElement* multiCoordinate = multiRotation->FirstChildElement("occupied_coord"); multiCoordinate; multiCoordinate = multiCoordinate->NextSiblingElement("occupied_coord")) {
-								int x = 0;
-								int y = 0;
-								xRetVal = multiCoordinate->QueryValueAttribute("x", &x);
-								yRetVal = multiCoordinate->QueryValueAttribute("y", &y);
-								if (xRetVal == TIXML_SUCCESS && yRetVal == TIXML_SUCCESS) {
-									int z = 0;
-									multiCoordinate->QueryIntAttribute("z", &z);
-									obj->addMultiPartCoordinate(rotation, ModelCoordinate(x, y, z));
-								}
+			for (TiXmlElement* actionElement = objectElem->FirstChildElement("action"); actionElement; actionElement = actionElement->NextSiblingElement("action")) {
+				const std::string* actionId = actionElement->Attribute(std::string("id"));
+				
+				if (actionId) {
+					int isDefault = 0;
+					actionElement->QueryIntAttribute("default", &isDefault);
+					Action* action = obj->createAction(*actionId, (isDefault != 0));
+					
+					// Fetch ActionAudio data
+					TiXmlElement* soundElement = actionElement->FirstChildElement("sound");
+					if (soundElement) {
+						const std::string* clip = soundElement->Attribute(std::string("source"));
+						if (clip) {
+							ActionAudio* audio = new ActionAudio();
+							action->adoptAudio(audio);
+							audio->setSoundFileName(*clip);
+
+							const std::string* group = soundElement->Attribute(std::string("group"));
+							if (group) {
+								audio->setGroupName(*group);
+							}
+
+							float value = 0;
+							int success = soundElement->QueryValueAttribute("volume", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setGain(value);
+							success = soundElement->QueryValueAttribute("max_volume", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setMaxGain(value);
+							success = soundElement->QueryValueAttribute("min_volume", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setMinGain(value);
+							success = soundElement->QueryValueAttribute("ref_distance", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setReferenceDistance(value);
+							success = soundElement->QueryValueAttribute("max_distance", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setMaxDistance(value);
+							success = soundElement->QueryValueAttribute("rolloff", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setRolloff(value);
+							success = soundElement->QueryValueAttribute("pitch", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setPitch(value);
+							success = soundElement->QueryValueAttribute("cone_inner_angle", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setConeInnerAngle(value);
+							success = soundElement->QueryValueAttribute("cone_outer_angle", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setConeOuterAngle(value);
+							success = soundElement->QueryValueAttribute("cone_outer_gain", &value);
+							if (success == TIXML_SUCCESS)
+								audio->setConeOuterGain(value);
+
+							int boolValue = 0;
+							success = soundElement->QueryIntAttribute("looping", &boolValue);
+							if (success == TIXML_SUCCESS)
+								audio->setLooping(boolValue != 0);
+							success = soundElement->QueryIntAttribute("relative_position", &boolValue);
+							if (success == TIXML_SUCCESS)
+								audio->setRelativePositioning(boolValue != 0);
+							success = soundElement->QueryIntAttribute("direction", &boolValue);
+							if (success == TIXML_SUCCESS)
+								audio->setDirection(boolValue != 0);
+
+							double vx = 0;
+							double vy = 0;
+							double vz = 0;
+							if (soundElement->QueryValueAttribute("x_velocity", &vx) == TIXML_SUCCESS && soundElement->QueryValueAttribute("y_velocity", &vy) == TIXML_SUCCESS) {
+								soundElement->QueryValueAttribute("z_velocity", &vz);
+								audio->setVelocity(AudioSpaceCoordinate(vx, vy, vz));
 							}
 						}
 					}
 
-					// loop over all image tags
-					for (TiXmlElement* imageElement = objectElem->FirstChildElement("image"); imageElement; imageElement = imageElement->NextSiblingElement("image")) {
-						const std::string* sourceId = imageElement->Attribute(std::string("source"));
+					// Create and fetch ActionVisual
+					ActionVisual::create(action);
+
+					for (TiXmlElement* animElement = actionElement->FirstChildElement("animation"); animElement; animElement = animElement->NextSiblingElement("animation")) {
+						// Fetch already created animation
+						const std::string* animationId = animElement->Attribute(std::string("animation_id"));
+						if (animationId) {
+							AnimationPtr animation = m_animationManager->getPtr(*animationId);
+							if (animation) {
+								ActionVisual* actionVisual = action->getVisual<ActionVisual>();
+								if (actionVisual) {
+									actionVisual->addAnimation(animation->getDirection(), animation);
+									action->setDuration(animation->getDuration());
+									continue;
+								}
+							}
+						}
 
+						// Create animated spritesheet
+						const std::string* sourceId = animElement->Attribute(std::string("atlas"));
 						if (sourceId) {
-							bfs::path imagePath(filename);
+							bfs::path atlasPath(filename);
 
-							if (HasParentPath(imagePath)) {
-								imagePath = GetParentPath(imagePath) / *sourceId;
+							if (HasParentPath(atlasPath)) {
+								atlasPath = GetParentPath(atlasPath) / *sourceId;
 							} else {
-								imagePath = bfs::path(*sourceId);
+								atlasPath = bfs::path(*sourceId);
 							}
 
-							if (!bfs::exists(imagePath)) {
-								imagePath= bfs::path(*sourceId);
-							}
-
-							ImagePtr imagePtr;
-							if(!m_imageManager->exists(imagePath.string())) {
-								imagePtr = m_imageManager->create(imagePath.string());
-							}
-							else {
-								imagePtr = m_imageManager->getPtr(imagePath.string());
+							ImagePtr atlasImgPtr;
+							// we need to load this since its shared image
+							if (!m_imageManager->exists(atlasPath.string())) {
+								atlasImgPtr = m_imageManager->create(atlasPath.string());
+							} else {
+								atlasImgPtr = m_imageManager->getPtr(atlasPath.string());
 							}
 
-							if (imagePtr) {
-								int xOffset = 0;
-								int success = imageElement->QueryIntAttribute("x_offset", &xOffset);
+							int animFrames = 0;
+							int animDelay = 0;
+							int animXoffset = 0;
+							int animYoffset = 0;
+							int frameWidth = 0;
+							int frameHeight = 0;
+
+							animElement->QueryValueAttribute("width", &frameWidth);
+							animElement->QueryValueAttribute("height", &frameHeight);
+							animElement->QueryValueAttribute("frames", &animFrames);
+							animElement->QueryValueAttribute("delay", &animDelay);
+							animElement->QueryValueAttribute("x_offset", &animXoffset);
+							animElement->QueryValueAttribute("y_offset", &animYoffset);
+							int nDir = 0;
+
+							for (TiXmlElement* dirElement = animElement->FirstChildElement("direction");
+								dirElement; dirElement = dirElement->NextSiblingElement("direction")) {
+									int dir;
+									dirElement->QueryIntAttribute("dir", &dir);
+
+									static char tmp[64];
+									snprintf(tmp, 64, "%03d", dir);
+									std::string aniId = *objectId + ":" + *actionId + ":" + std::string(tmp);
+									AnimationPtr animation = m_animationManager->create(aniId);
+
+									int frames;
+									int success = dirElement->QueryValueAttribute("frames", &frames);
+									if(success != TIXML_SUCCESS) {
+										frames = animFrames;
+									}
 
-								if (success == TIXML_SUCCESS) {
-									imagePtr->setXShift(xOffset);
-								}
+									int delay;
+									success = dirElement->QueryValueAttribute("delay", &delay);
+									if(success != TIXML_SUCCESS) {
+										delay = animDelay;
+									}
 
-								int yOffset = 0;
-								success = imageElement->QueryIntAttribute("y_offset", &yOffset);
+									int xoffset;
+									success = dirElement->QueryValueAttribute("x_offset", &xoffset);
+									if(success != TIXML_SUCCESS) {
+										xoffset = animXoffset;
+									}
 
-								if (success == TIXML_SUCCESS) {
-									imagePtr->setYShift(yOffset);
-								}
+									int yoffset;
+									success = dirElement->QueryValueAttribute("y_offset", &yoffset);
+									if(success != TIXML_SUCCESS) {
+										yoffset = animYoffset;
+									}
 
-								int direction = 0;
-								success = imageElement->QueryIntAttribute("direction", &direction);
+									int action_frame;
+									success = dirElement->QueryValueAttribute("action_frame", &action_frame);
+									if(success == TIXML_SUCCESS) {
+										animation->setActionFrame(action_frame);
+									}
 
-								if (success == TIXML_SUCCESS) {
-									ObjectVisual* objVisual = obj->getVisual<ObjectVisual>();
+									for (int iframe = 0; iframe < frames; ++iframe) {
+										static char tmpBuf[64];
+										snprintf(tmpBuf, 64, "%03d:%04d", dir, iframe);
+
+										std::string frameId = *objectId + ":" + *actionId + ":" + std::string(tmpBuf);
+										Rect region(frameWidth * iframe, frameHeight * nDir, frameWidth, frameHeight);
+										ImagePtr framePtr;
+										if (!m_imageManager->exists(frameId)) {
+											framePtr = m_imageManager->create(frameId);
+											framePtr->useSharedImage(atlasImgPtr, region);
+											framePtr->setXShift(xoffset);
+											framePtr->setYShift(yoffset);
+										} else {
+											framePtr = m_imageManager->getPtr(frameId);
+										}
+										animation->addFrame(framePtr, delay);
+									}
 
-									if (objVisual) {
-										objVisual->addStaticImage(direction, static_cast<int32_t>(imagePtr->getHandle()));
+									ActionVisual* actionVisual = action->getVisual<ActionVisual>();
+									if(actionVisual) {
+										actionVisual->addAnimation(dir, animation);
+										action->setDuration(animation->getDuration());
 									}
-								}
+									++nDir;
 							}
+							continue;
 						}
-					}
 
-					for (TiXmlElement* actionElement = objectElem->FirstChildElement("action"); actionElement; actionElement = actionElement->NextSiblingElement("action")) {
-						const std::string* actionId = actionElement->Attribute(std::string("id"));
-						
-						if (actionId) {
-							int isDefault = 0;
-							actionElement->QueryIntAttribute("default", &isDefault);
-							Action* action = obj->createAction(*actionId, (isDefault != 0));
+						// Load animation.xml with frames
+						sourceId = animElement->Attribute(std::string("source"));
+						if (sourceId) {
+							int direction = 0;
+							int success = animElement->QueryValueAttribute("direction", &direction);
 							
-							// Fetch ActionAudio data
-							TiXmlElement* soundElement = actionElement->FirstChildElement("sound");
-							if (soundElement) {
-								const std::string* clip = soundElement->Attribute(std::string("source"));
-								if (clip) {
-									ActionAudio* audio = new ActionAudio();
-									action->adoptAudio(audio);
-									audio->setSoundFileName(*clip);
-
-									const std::string* group = soundElement->Attribute(std::string("group"));
-									if (group) {
-										audio->setGroupName(*group);
-									}
+							bfs::path animPath(filename);
 
-									float value = 0;
-									int success = soundElement->QueryValueAttribute("volume", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setGain(value);
-									success = soundElement->QueryValueAttribute("max_volume", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setMaxGain(value);
-									success = soundElement->QueryValueAttribute("min_volume", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setMinGain(value);
-									success = soundElement->QueryValueAttribute("ref_distance", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setReferenceDistance(value);
-									success = soundElement->QueryValueAttribute("max_distance", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setMaxDistance(value);
-									success = soundElement->QueryValueAttribute("rolloff", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setRolloff(value);
-									success = soundElement->QueryValueAttribute("pitch", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setPitch(value);
-									success = soundElement->QueryValueAttribute("cone_inner_angle", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setConeInnerAngle(value);
-									success = soundElement->QueryValueAttribute("cone_outer_angle", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setConeOuterAngle(value);
-									success = soundElement->QueryValueAttribute("cone_outer_gain", &value);
-									if (success == TIXML_SUCCESS)
-										audio->setConeOuterGain(value);
-
-									int boolValue = 0;
-									success = soundElement->QueryIntAttribute("looping", &boolValue);
-									if (success == TIXML_SUCCESS)
-										audio->setLooping(boolValue != 0);
-									success = soundElement->QueryIntAttribute("relative_position", &boolValue);
-									if (success == TIXML_SUCCESS)
-										audio->setRelativePositioning(boolValue != 0);
-									success = soundElement->QueryIntAttribute("direction", &boolValue);
-									if (success == TIXML_SUCCESS)
-										audio->setDirection(boolValue != 0);
-
-									double vx = 0;
-									double vy = 0;
-									double vz = 0;
-									if (soundElement->QueryValueAttribute("x_velocity", &vx) == TIXML_SUCCESS && soundElement->QueryValueAttribute("y_velocity", &vy) == TIXML_SUCCESS) {
-										soundElement->QueryValueAttribute("z_velocity", &vz);
-										audio->setVelocity(AudioSpaceCoordinate(vx, vy, vz));
-									}
-								}
+							if (HasParentPath(animPath)) {
+								animPath = GetParentPath(animPath) / *sourceId;
+							} else {
+								animPath = bfs::path(*sourceId);
 							}
 
-							// Create and fetch ActionVisual
-							ActionVisual::create(action);
-
-							for (TiXmlElement* animElement = actionElement->FirstChildElement("animation"); animElement; animElement = animElement->NextSiblingElement("animation")) {
-								// Fetch already created animation
-								const std::string* animationId = animElement->Attribute(std::string("animation_id"));
-								if (animationId) {
-									AnimationPtr animation = m_animationManager->getPtr(*animationId);
-									if (animation) {
-										ActionVisual* actionVisual = action->getVisual<ActionVisual>();
-										if (actionVisual) {
-											actionVisual->addAnimation(animation->getDirection(), animation);
-											action->setDuration(animation->getDuration());
-											continue;
-										}
-									}
+							AnimationPtr animation;
+							if (m_animationLoader && m_animationLoader->isLoadable(animPath.string())) {
+								animation = m_animationLoader->load(animPath.string());
+							}
+
+							if (action && animation) {
+								if (success != TIXML_SUCCESS) {
+									direction = animation->getDirection();
+								}
+								ActionVisual* actionVisual = action->getVisual<ActionVisual>();
+								if (actionVisual) {
+									actionVisual->addAnimation(direction, animation);
+									action->setDuration(animation->getDuration());
 								}
+							}
+						}
+					}
+				}
+			}
+		}
 
-								// Create animated spritesheet
-								const std::string* sourceId = animElement->Attribute(std::string("atlas"));
-								if (sourceId) {
-									bfs::path atlasPath(filename);
+		return obj;
+	}
 
-									if (HasParentPath(atlasPath)) {
-										atlasPath = GetParentPath(atlasPath) / *sourceId;
-									} else {
-										atlasPath = bfs::path(*sourceId);
-									}
+	void ObjectLoader::setLoadProfiler(LoadProfiler* profiler) {
+		m_loadProfiler = profiler;
+	}
 
-									ImagePtr atlasImgPtr;
-									// we need to load this since its shared image
-									if (!m_imageManager->exists(atlasPath.string())) {
-										atlasImgPtr = m_imageManager->create(atlasPath.string());
-									} else {
-										atlasImgPtr = m_imageManager->getPtr(atlasPath.string());
-									}
+	void ObjectLoader::setLazyLoading(bool lazy) {
+		m_lazyLoading = lazy;
+	}
 
-									int animFrames = 0;
-									int animDelay = 0;
-									int animXoffset = 0;
-									int animYoffset = 0;
-									int frameWidth = 0;
-									int frameHeight = 0;
-
-									animElement->QueryValueAttribute("width", &frameWidth);
-									animElement->QueryValueAttribute("height", &frameHeight);
-									animElement->QueryValueAttribute("frames", &animFrames);
-									animElement->QueryValueAttribute("delay", &animDelay);
-									animElement->QueryValueAttribute("x_offset", &animXoffset);
-									animElement->QueryValueAttribute("y_offset", &animYoffset);
-									int nDir = 0;
-
-									for (TiXmlElement* dirElement = animElement->FirstChildElement("direction");
-										dirElement; dirElement = dirElement->NextSiblingElement("direction")) {
-											int dir;
-											dirElement->QueryIntAttribute("dir", &dir);
-
-											static char tmp[64];
-											snprintf(tmp, 64, "%03d", dir);
-											std::string aniId = *objectId + ":" + *actionId + ":" + std::string(tmp);
-											AnimationPtr animation = m_animationManager->create(aniId);
-
-											int frames;
-											int success = dirElement->QueryValueAttribute("frames", &frames);
-											if(success != TIXML_SUCCESS) {
-												frames = animFrames;
-											}
-
-											int delay;
-											success = dirElement->QueryValueAttribute("delay", &delay);
-											if(success != TIXML_SUCCESS) {
-												delay = animDelay;
-											}
-
-											int xoffset;
-											success = dirElement->QueryValueAttribute("x_offset", &xoffset);
-											if(success != TIXML_SUCCESS) {
-												xoffset = animXoffset;
-											}
-
-											int yoffset;
-											success = dirElement->QueryValueAttribute("y_offset", &yoffset);
-											if(success != TIXML_SUCCESS) {
-												yoffset = animYoffset;
-											}
-
-											int action_frame;
-											success = dirElement->QueryValueAttribute("action_frame", &action_frame);
-											if(success == TIXML_SUCCESS) {
-												animation->setActionFrame(action_frame);
-											}
-
-											for (int iframe = 0; iframe < frames; ++iframe) {
-												static char tmpBuf[64];
-												snprintf(tmpBuf, 64, "%03d:%04d", dir, iframe);
-
-												std::string frameId = *objectId + ":" + *actionId + ":" + std::string(tmpBuf);
-												Rect region(frameWidth * iframe, frameHeight * nDir, frameWidth, frameHeight);
-												ImagePtr framePtr;
-												if (!m_imageManager->exists(frameId)) {
-													framePtr = m_imageManager->create(frameId);
-													framePtr->useSharedImage(atlasImgPtr, region);
-													framePtr->setXShift(xoffset);
-													framePtr->setYShift(yoffset);
-												} else {
-													framePtr = m_imageManager->getPtr(frameId);
-												}
-												animation->addFrame(framePtr, delay);
-											}
-
-											ActionVisual* actionVisual = action->getVisual<ActionVisual>();
-											if(actionVisual) {
-												actionVisual->addAnimation(dir, animation);
-												action->setDuration(animation->getDuration());
-											}
-											++nDir;
-									}
-									continue;
-								}
+	bool ObjectLoader::isLazyLoading() const {
+		return m_lazyLoading;
+	}
 
-								// Load animation.xml with frames
-								sourceId = animElement->Attribute(std::string("source"));
-								if (sourceId) {
-									int direction = 0;
-									int success = animElement->QueryValueAttribute("direction", &direction);
-									
-									bfs::path animPath(filename);
-
-									if (HasParentPath(animPath)) {
-										animPath = GetParentPath(animPath) / *sourceId;
-									} else {
-										animPath = bfs::path(*sourceId);
-									}
+	Object* ObjectLoader::provideObject(const std::string& id, const std::string& name_space) {
+		DeferredObjectMap::iterator it = m_deferredObjects.find(std::make_pair(name_space, id));
+		if (it == m_deferredObjects.end()) {
+			return NULL;
+		}
+		DeferredObject deferred = it->second;
+		m_deferredObjects.erase(it);
+
+		DeferredFile* file = deferred.file;
+		Object* obj = loadObject(file->filename, file->document->RootElement(), deferred.element);
+		if (obj && obj->isMultiObject()) {
+			// the parts are created on demand too
+			const std::list<std::string>& multiParts = obj->getMultiPartIds();
+			std::list<std::string>::const_iterator partIt = multiParts.begin();
+			for (; partIt != multiParts.end(); ++partIt) {
+				Object* partObj = m_model->getObject(*partIt, name_space);
+				if (partObj) {
+					partObj->setMultiPart(true);
+					obj->addMultiPart(partObj);
+				}
+			}
+		}
 
-									AnimationPtr animation;
-									if (m_animationLoader && m_animationLoader->isLoadable(animPath.string())) {
-										animation = m_animationLoader->load(animPath.string());
-									}
+		if (--file->pending == 0) {
+			delete file->document;
+			delete file;
+		}
+		return obj;
+	}
 
-									if (action && animation) {
-										if (success != TIXML_SUCCESS) {
-											direction = animation->getDirection();
-										}
-										ActionVisual* actionVisual = action->getVisual<ActionVisual>();
-										if (actionVisual) {
-											actionVisual->addAnimation(direction, animation);
-											action->setDuration(animation->getDuration());
-										}
-									}
-								}
-							}
-						}
-					}
+	void ObjectLoader::forgetObjects() {
+		clearDeferredObjects();
+	}
+
+	void ObjectLoader::clearDeferredObjects() {
+		std::set<DeferredFile*> files;
+		DeferredObjectMap::iterator it = m_deferredObjects.begin();
+		for (; it != m_deferredObjects.end(); ++it) {
+			files.insert(it->second.file);
+		}
+		m_deferredObjects.clear();
+		std::set<DeferredFile*>::iterator fileIt = files.begin();
+		for (; fileIt != files.end(); ++fileIt) {
+			delete (*fileIt)->document;
+			delete *fileIt;
+		}
+	}
+
+	void ObjectLoader::deferObjects(const std::string& filename, const TiXmlDocument& document) {
+		DeferredFile* file = new DeferredFile();
+		file->filename = filename;
+		file->document = new TiXmlDocument(document);
+		file->pending = 0;
+
+		TiXmlElement* root = file->document->RootElement();
+		for (TiXmlElement* objectElem = root->FirstChildElement("object"); objectElem; objectElem = objectElem->NextSiblingElement("object")) {
+			const std::string* objectId = objectElem->Attribute(std::string("id"));
+			const std::string* namespaceId = objectElem->Attribute(std::string("namespace"));
+			if (objectId && namespaceId && m_model->addDeferredObject(*objectId, *namespaceId, this)) {
+				DeferredObject deferred;
+				deferred.file = file;
+				deferred.element = objectElem;
+				if (m_deferredObjects.insert(std::make_pair(std::make_pair(*namespaceId, *objectId), deferred)).second) {
+					++file->pending;
 				}
 			}
 		}
+
+		if (file->pending == 0) {
+			delete file->document;
+			delete file;
+		}
 	}
 
 	void ObjectLoader::loadImportFile(const std::string& file, const std::string& directory) {
@@ -693,28 +809,97 @@ namespace FIFE {
 	void ObjectLoader::loadImportDirectory(const std::string& directory) {
 		if (!directory.empty()) {
 			bfs::path importDirectory(directory);
-			std::string importDirectoryString = importDirectory.string();
-
-			std::set<std::string> files = m_vfs->listFiles(importDirectoryString);
-
-			// load all xml files in the directory
-			std::set<std::string>::iterator iter;
-			for (iter = files.begin(); iter != files.end(); ++iter) {
-				// TODO - vtchill - may need a way to allow clients to load things other
-				// than .xml and .zip files
-				std::string ext = bfs::extension(*iter);
-				if (ext == ".xml" || ext == ".zip") {
-					loadImportFile(*iter, importDirectoryString);
-				}
+
+			std::vector<std::string> files;
+			listImportFiles(m_vfs, importDirectory.string(), files);
+			loadImportFiles(files);
+		}
+	}
+
+	void ObjectLoader::loadImportFiles(const std::vector<std::string>& files) {
+		if (m_documentCache) {
+			// nested import of an object file, uses the cache of the outer import
+			prefetchImportFiles(files);
+			std::vector<std::string>::const_iterator it = files.begin();
+			for (; it != files.end(); ++it) {
+				loadImportFile(*it);
 			}
+			return;
+		}
 
-			std::set<std::string> nestedDirectories = m_vfs->listDirectories(importDirectoryString);
-			for (iter  = nestedDirectories.begin(); iter != nestedDirectories.end(); ++iter) {
-				// do not attempt to load anything from a .svn directory
-				if ((*iter).find(".svn") == std::string::npos) {
-					loadImportDirectory(importDirectoryString + "/" + *iter);
+		XmlDocumentCache cache(m_vfs);
+		setDocumentCache(&cache);
+		try {
+			if (m_loadProfiler) {
+				m_loadProfiler->beginPhase("imports");
+				m_loadProfiler->addCount(static_cast<uint32_t>(files.size()));
+			}
+			prefetchImportFiles(files);
+
+			if (m_loadProfiler) {
+				m_loadProfiler->beginPhase("objects");
+			}
+			uint32_t createdObjects = m_createdObjects;
+			// merged into the model in the given order
+			std::vector<std::string>::const_iterator it = files.begin();
+			for (; it != files.end(); ++it) {
+				loadImportFile(*it);
+			}
+			if (m_loadProfiler) {
+				m_loadProfiler->addCount(m_createdObjects - createdObjects);
+			}
+		}
+		catch (...) {
+			setDocumentCache(0);
+			throw;
+		}
+		setDocumentCache(0);
+	}
+
+	void ObjectLoader::setDocumentCache(XmlDocumentCache* cache) {
+		m_documentCache = cache;
+		AnimationLoader* animationLoader = dynamic_cast<AnimationLoader*>(m_animationLoader.get());
+		if (animationLoader) {
+			animationLoader->setDocumentCache(cache);
+		}
+		AtlasLoader* atlasLoader = dynamic_cast<AtlasLoader*>(m_atlasLoader.get());
+		if (atlasLoader) {
+			atlasLoader->setDocumentCache(cache);
+		}
+	}
+
+	void ObjectLoader::prefetchImportFiles(const std::vector<std::string>& files) {
+		m_documentCache->prefetch(files);
+		if (m_lazyLoading) {
+			// animations are loaded with their objects
+			return;
+		}
+
+		// the animation files of the actions are only known after the objects are parsed
+		std::vector<std::string> animationFiles;
+		std::vector<std::string>::const_iterator it = files.begin();
+		for (; it != files.end(); ++it) {
+			TiXmlDocument* document = m_documentCache->get(*it);
+			TiXmlElement* root = document ? document->RootElement() : 0;
+			if (!root || root->ValueStr() != "assets") {
+				continue;
+			}
+			bfs::path objectPath(*it);
+			for (TiXmlElement* objectElem = root->FirstChildElement("object"); objectElem; objectElem = objectElem->NextSiblingElement("object")) {
+				for (TiXmlElement* actionElement = objectElem->FirstChildElement("action"); actionElement; actionElement = actionElement->NextSiblingElement("action")) {
+					for (TiXmlElement* animElement = actionElement->FirstChildElement("animation"); animElement; animElement = animElement->NextSiblingElement("animation")) {
+						const std::string* sourceId = animElement->Attribute(std::string("source"));
+						if (sourceId) {
+							bfs::path animPath(*sourceId);
+							if (HasParentPath(objectPath)) {
+								animPath = GetParentPath(objectPath) / *sourceId;
+							}
+							animationFiles.push_back(animPath.string());
+						}
+					}
 				}
 			}
 		}
+		m_documentCache->prefetch(animationFiles);
 	}
 }
@@ -23,7 +23,10 @@
 #define FIFE_OBJECT_LOADER_H_
 
 // Standard C++ library includes
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 // 3rd party library includes
 
@@ -31,20 +34,27 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "model/metamodel/iobjectprovider.h"
+#include "util/base/fife_stdint.h"
 #include "util/base/sharedptr.h"
 
 #include "iobjectloader.h"
 #include "ianimationloader.h"
 #include "iatlasloader.h"
 
+class TiXmlDocument;
+class TiXmlElement;
+
 namespace FIFE {
 
 	class Model;
 	class VFS;
 	class ImageManager;
 	class AnimationManager;
+	class XmlDocumentCache;
+	class LoadProfiler;
 
-	class ObjectLoader : public IObjectLoader {
+	class ObjectLoader : public IObjectLoader, public IObjectProvider {
 	public:
 		ObjectLoader(Model* model, VFS* vfs, ImageManager* imageManager, AnimationManager* animationManager, const AnimationLoaderPtr& animationLoader=AnimationLoaderPtr(), const AtlasLoaderPtr& atlasLoader=AtlasLoaderPtr());
 
@@ -89,13 +99,87 @@ namespace FIFE {
 		*/
 		void loadImportDirectory(const std::string& directory);
 
+		/** loads the object, atlas or animation files in the given order,
+		* the files and the animations they reference are parsed in parallel beforehand
+		*/
+		void loadImportFiles(const std::vector<std::string>& files);
+
+		/** enables or disables lazy loading, disabled by default
+		* with lazy loading, load only registers the object ids of a file at the model,
+		* an object with its visual and actions is created when the model requests it,
+		* see Model::getObject and Model::preloadObjects
+		*/
+		void setLazyLoading(bool lazy);
+
+		/** returns true if lazy loading is enabled
+		*/
+		bool isLazyLoading() const;
+
+		/** 
+		* @see IObjectProvider::provideObject
+		*/
+		virtual Object* provideObject(const std::string& id, const std::string& name_space);
+
+		/** 
+		* @see IObjectProvider::forgetObjects
+		*/
+		virtual void forgetObjects();
+
+		/** sets the profiler that measures the phases "imports" and "objects" of loadImportFiles,
+		* 0 disables it. The "objects" phase keeps running after loadImportFiles returns.
+		*/
+		void setLoadProfiler(LoadProfiler* profiler);
+
 	private:
+		//! parsed object file that still has deferred objects
+		struct DeferredFile {
+			std::string filename;
+			TiXmlDocument* document;
+			//! number of objects of the file that are not created yet
+			uint32_t pending;
+		};
+
+		struct DeferredObject {
+			DeferredFile* file;
+			TiXmlElement* element;
+		};
+
+		//! deferred objects by namespace and identifier
+		typedef std::map<std::pair<std::string, std::string>, DeferredObject> DeferredObjectMap;
+
+		/** creates an object with its visual and actions from its xml element, returns 0 on failure
+		*/
+		Object* loadObject(const std::string& filename, TiXmlElement* root, TiXmlElement* objectElem);
+
+		/** registers the objects of the document at the model as deferred objects
+		*/
+		void deferObjects(const std::string& filename, const TiXmlDocument& document);
+
+		/** deletes the deferred objects and the documents they keep
+		*/
+		void clearDeferredObjects();
+
+		/** sets the document cache of this loader and of the native animation and atlas loaders
+		*/
+		void setDocumentCache(XmlDocumentCache* cache);
+
+		/** parses the files and the animation files referenced by their objects into the document cache
+		*/
+		void prefetchImportFiles(const std::vector<std::string>& files);
+
 		Model* m_model;
 		VFS* m_vfs;
 		ImageManager* m_imageManager;
 		AnimationManager* m_animationManager;
 		AnimationLoaderPtr m_animationLoader;
 		AtlasLoaderPtr m_atlasLoader;
+		//! only set while loadImportFiles runs
+		XmlDocumentCache* m_documentCache;
+		bool m_lazyLoading;
+		LoadProfiler* m_loadProfiler;
+		//! number of objects loadObject created
+		uint32_t m_createdObjects;
+		DeferredObjectMap m_deferredObjects;
 	};
 }
 
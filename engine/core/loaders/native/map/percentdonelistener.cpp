@@ -40,6 +40,10 @@ namespace FIFE
 
 	}
 
+	void PercentDoneListener::OnPhaseDone(const LoadPhase& phase) {
+
+	}
+
 	PercentDoneCallback::PercentDoneCallback()
 	: m_totalElements(0), m_percent(1), m_numberOfEvents(0), m_count(0) {
 
@@ -115,6 +119,13 @@ namespace FIFE
 		}
 	}
 
+	void PercentDoneCallback::firePhaseDone(const LoadPhase& phase) {
+		ListenerContainer::iterator iter = m_listeners.begin();
+		for ( ; iter != m_listeners.end(); ++iter) {
+			(*iter)->OnPhaseDone(phase);
+		}
+	}
+
 	void PercentDoneCallback::fireEvent(uint32_t percent) {
 		ListenerContainer::iterator iter = m_listeners.begin();
 		for ( ; iter != m_listeners.end(); ++iter) {
@@ -33,10 +33,17 @@
 // Second block: files included from the same folder
 
 namespace FIFE {
+	struct LoadPhase;
+
 	class PercentDoneListener {
 	public:
 		virtual ~PercentDoneListener();
 		virtual void OnEvent(unsigned int percentDone) = 0;
+
+		/** Called when a phase of the load is done, e.g. "imports" or "layers".
+		 * The default implementation does nothing.
+		 */
+		virtual void OnPhaseDone(const LoadPhase& phase);
 	};
 
 	class PercentDoneCallback {
@@ -50,6 +57,7 @@ namespace FIFE {
 		void reset();
 		void addListener(PercentDoneListener* listener);
 		void removeListener(PercentDoneListener* listener);
+		void firePhaseDone(const LoadPhase& phase);
 
 	private:
 		void fireEvent(uint32_t percent);
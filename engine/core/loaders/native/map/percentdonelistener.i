@@ -23,11 +23,14 @@
 #include "loaders/native/map/percentdonelistener.h"
 %}
 
+%include "loaders/native/map/loadprofiler.i"
+
 namespace FIFE {
 	%feature("director") PercentDoneListener;
 	class PercentDoneListener {
 	public:
 		virtual ~PercentDoneListener();
 		virtual void OnEvent(unsigned int percentDone) = 0;
+		virtual void OnPhaseDone(const LoadPhase& phase);
 	};
 }
\ No newline at end of file
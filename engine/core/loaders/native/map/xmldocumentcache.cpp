@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <functional>
+#include <memory>
+#include <set>
+
+// 3rd party library includes
+#include <tinyxml.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/concurrency/workerpool.h"
+#include "vfs/fife_boost_filesystem.h"
+#include "vfs/vfs.h"
+#include "vfs/raw/rawdata.h"
+
+#include "xmldocumentcache.h"
+
+namespace FIFE {
+
+	XmlDocumentCache::XmlDocumentCache(VFS* vfs)
+	: m_vfs(vfs), m_workerPool(NULL) {
+	}
+
+	XmlDocumentCache::~XmlDocumentCache() {
+		std::map<std::string, TiXmlDocument*>::iterator it = m_documents.begin();
+		for (; it != m_documents.end(); ++it) {
+			delete it->second;
+		}
+		delete m_workerPool;
+	}
+
+	void XmlDocumentCache::prefetch(const std::vector<std::string>& files) {
+		std::vector<std::string> missing;
+		std::set<std::string> seen;
+		std::vector<std::string>::const_iterator it = files.begin();
+		for (; it != files.end(); ++it) {
+			if (m_documents.find(*it) == m_documents.end() && seen.insert(*it).second) {
+				missing.push_back(*it);
+			}
+		}
+		if (missing.empty()) {
+			return;
+		}
+
+		// opened here, warnings about missing files are logged on the calling thread
+		std::vector<std::unique_ptr<RawData> > data(missing.size());
+		for (uint32_t i = 0; i < missing.size(); ++i) {
+			try {
+				data[i].reset(m_vfs->openMapped(missing[i]));
+			}
+			catch (Exception&) {
+				// the loader runs into the same error and reports it
+			}
+		}
+
+		std::vector<TiXmlDocument*> documents(missing.size(), static_cast<TiXmlDocument*>(0));
+		if (missing.size() > 1) {
+			if (!m_workerPool) {
+				m_workerPool = new WorkerPool();
+			}
+			m_workerPool->parallelFor(static_cast<uint32_t>(missing.size()),
+				std::bind(&XmlDocumentCache::parseFile, this, std::cref(data), std::ref(documents), std::placeholders::_1));
+		} else {
+			parseFile(data, documents, 0);
+		}
+
+		// merged in file order, failed files stay uncached
+		for (uint32_t i = 0; i < missing.size(); ++i) {
+			if (documents[i]) {
+				m_documents.insert(std::make_pair(missing[i], documents[i]));
+			}
+		}
+	}
+
+	TiXmlDocument* XmlDocumentCache::get(const std::string& file) const {
+		std::map<std::string, TiXmlDocument*>::const_iterator it = m_documents.find(file);
+		if (it != m_documents.end()) {
+			return it->second;
+		}
+		return 0;
+	}
+
+	void XmlDocumentCache::parseFile(const std::vector<std::unique_ptr<RawData> >& data, std::vector<TiXmlDocument*>& documents, uint32_t index) const {
+		RawData* file = data[index].get();
+		if (!file || file->getDataLength() == 0) {
+			return;
+		}
+
+		std::string text;
+		file->read(text);
+		TiXmlDocument* document = new TiXmlDocument();
+		document->Parse(text.c_str());
+		if (document->Error()) {
+			delete document;
+			return;
+		}
+		documents[index] = document;
+	}
+
+	void listImportFiles(VFS* vfs, const std::string& directory, std::vector<std::string>& files) {
+		if (directory.empty()) {
+			return;
+		}
+		std::set<std::string> dirFiles = vfs->listFiles(directory);
+		std::set<std::string>::iterator iter;
+		for (iter = dirFiles.begin(); iter != dirFiles.end(); ++iter) {
+			std::string ext = bfs::extension(*iter);
+			if (ext == ".xml" || ext == ".zip") {
+				bfs::path importFilePath(directory);
+				importFilePath /= *iter;
+				files.push_back(importFilePath.string());
+			}
+		}
+
+		std::set<std::string> nestedDirectories = vfs->listDirectories(directory);
+		for (iter = nestedDirectories.begin(); iter != nestedDirectories.end(); ++iter) {
+			// do not attempt to load anything from a .svn directory
+			if ((*iter).find(".svn") == std::string::npos) {
+				listImportFiles(vfs, directory + "/" + *iter, files);
+			}
+		}
+	}
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_XMLDOCUMENTCACHE_H_
+#define FIFE_XMLDOCUMENTCACHE_H_
+
+// Standard C++ library includes
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+class TiXmlDocument;
+
+namespace FIFE {
+	class RawData;
+	class VFS;
+	class WorkerPool;
+
+	/** Holds parsed xml documents of import files.
+	 *
+	 * The files are parsed on a worker pool by prefetch(), the loaders then take
+	 * the documents from the cache instead of parsing the files again.
+	 * Files that could not be read or parsed are not cached, so the loaders report
+	 * the error as before.
+	 * The files are opened memory mapped on the calling thread, so the vfs and its
+	 * sources only log there. The workers page the data in while they parse it.
+	 */
+	class XmlDocumentCache {
+	public:
+		/** Constructor
+		 * @param vfs The vfs the files are read from.
+		 */
+		XmlDocumentCache(VFS* vfs);
+
+		/** Destructor, deletes the cached documents.
+		 */
+		~XmlDocumentCache();
+
+		/** Reads and parses the given files in parallel and adds them to the cache.
+		 * Files that are already cached are skipped.
+		 */
+		void prefetch(const std::vector<std::string>& files);
+
+		/** Returns the document of the file or 0 if it is not cached.
+		 */
+		TiXmlDocument* get(const std::string& file) const;
+
+	private:
+		/** Worker task of prefetch, parses data[index] into documents[index].
+		 * Does not use the vfs and does not log.
+		 */
+		void parseFile(const std::vector<std::unique_ptr<RawData> >& data, std::vector<TiXmlDocument*>& documents, uint32_t index) const;
+
+		VFS* m_vfs;
+		//! created on the first prefetch with more than one file
+		WorkerPool* m_workerPool;
+		std::map<std::string, TiXmlDocument*> m_documents;
+	};
+
+	/** Appends the .xml and .zip files of the directory and its sub directories to files,
+	 * in the order the import loaders load them.
+	 */
+	void listImportFiles(VFS* vfs, const std::string& directory, std::vector<std::string>& files);
+}
+
+#endif
@@ -0,0 +1,62 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MODEL_IOBJECTPROVIDER_H
+#define FIFE_MODEL_IOBJECTPROVIDER_H
+
+// Standard C++ library includes
+#include <string>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+namespace FIFE {
+	class Object;
+
+	/** Creates deferred objects on demand.
+	 *
+	 * A provider registers object ids with Model::addDeferredObject, the model
+	 * asks it to create an object the first time the object is requested.
+	 */
+	class IObjectProvider {
+	public:
+		virtual ~IObjectProvider() {};
+
+		/** Creates the object in the model and returns it, 0 if that fails.
+		 * Called at most once per registered object.
+		 * @param id The identifier of the object.
+		 * @param name_space The namespace of the object.
+		 */
+		virtual Object* provideObject(const std::string& id, const std::string& name_space) = 0;
+
+		/** Called when the model dropped all deferred objects of the provider,
+		 * e.g. by Model::deleteObjects or when the model is destroyed.
+		 * The provider releases what it kept for them and must not use the model afterwards.
+		 */
+		virtual void forgetObjects() = 0;
+	};
+}
+
+#endif
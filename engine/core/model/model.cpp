@@ -20,6 +20,8 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <functional>
+#include <set>
 
 // 3rd party library includes
 
@@ -30,12 +32,14 @@
 #include "util/structures/purge.h"
 #include "util/log/logger.h"
 #include "model/metamodel/ipather.h"
+#include "model/metamodel/iobjectprovider.h"
 #include "model/metamodel/object.h"
 #include "model/metamodel/grids/cellgrid.h"
 #include "structures/map.h"
 #include "structures/layer.h"
 #include "structures/instance.h"
 #include "util/base/exception.h"
+#include "util/concurrency/workerpool.h"
 #include "view/rendererbase.h"
 #include "video/renderbackend.h"
 
@@ -70,12 +74,16 @@ namespace FIFE {
 		m_lastNamespace(NULL),
 		m_timeprovider(NULL),
 		m_renderbackend(renderbackend),
-		m_renderers(renderers){
+		m_renderers(renderers),
+		m_workerPool(NULL) {
 
 		m_mapObserver = new ModelMapObserver(this);
 	}
 
 	Model::~Model() {
+		// providers can outlive the model, afterwards they must not call back
+		forgetObjectProviders();
+
 		// first remove the map observer, we delete all grids anyway
 		for (std::list<Map*>::iterator it = m_maps.begin(); it != m_maps.end(); ++it) {
 			(*it)->removeChangeListener(m_mapObserver);
@@ -88,6 +96,7 @@ namespace FIFE {
 		purge(m_pathers);
 		purge(m_createdGrids);
 		purge(m_adoptedGrids);
+		delete m_workerPool;
 	}
 
 	Map* Model::createMap(const std::string& identifier) {
@@ -274,9 +283,25 @@ namespace FIFE {
 			nspace = m_namespaces.erase(nspace);
 		}
 		m_lastNamespace = 0;
+
+		// the providers drop their side of the deferred objects too
+		forgetObjectProviders();
 		return true;
 	}
 
+	void Model::forgetObjectProviders() {
+		std::set<IObjectProvider*> providers;
+		deferredmap_t::iterator it = m_deferredObjects.begin();
+		for (; it != m_deferredObjects.end(); ++it) {
+			providers.insert(it->second);
+		}
+		m_deferredObjects.clear();
+		std::set<IObjectProvider*>::iterator pit = providers.begin();
+		for (; pit != providers.end(); ++pit) {
+			(*pit)->forgetObjects();
+		}
+	}
+
 	Object* Model::getObject(const std::string& id, const std::string& name_space) {
 		namespace_t* nspace = selectNamespace(name_space);
 		if(nspace) {
@@ -284,7 +309,55 @@ namespace FIFE {
 			if( it !=  nspace->second.end() )
 				return it->second;
 		}
-		return NULL;
+		return createDeferredObject(id, name_space);
+	}
+
+	bool Model::addDeferredObject(const std::string& identifier, const std::string& name_space, IObjectProvider* provider) {
+		const namespace_t* nspace = selectNamespace(name_space);
+		if (nspace && nspace->second.find(identifier) != nspace->second.end()) {
+			return false;
+		}
+		return m_deferredObjects.insert(std::make_pair(std::make_pair(name_space, identifier), provider)).second;
+	}
+
+	void Model::removeObjectProvider(IObjectProvider* provider) {
+		deferredmap_t::iterator it = m_deferredObjects.begin();
+		while (it != m_deferredObjects.end()) {
+			if (it->second == provider) {
+				m_deferredObjects.erase(it++);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	bool Model::isObjectDeferred(const std::string& id, const std::string& name_space) const {
+		return m_deferredObjects.find(std::make_pair(name_space, id)) != m_deferredObjects.end();
+	}
+
+	void Model::preloadObjects(const std::string& name_space, const std::list<std::string>& ids) {
+		std::list<std::string> pending(ids);
+		if (pending.empty()) {
+			deferredmap_t::const_iterator it = m_deferredObjects.lower_bound(std::make_pair(name_space, std::string()));
+			for (; it != m_deferredObjects.end() && it->first.first == name_space; ++it) {
+				pending.push_back(it->first.second);
+			}
+		}
+		std::list<std::string>::const_iterator it = pending.begin();
+		for (; it != pending.end(); ++it) {
+			createDeferredObject(*it, name_space);
+		}
+	}
+
+	Object* Model::createDeferredObject(const std::string& id, const std::string& name_space) {
+		deferredmap_t::iterator it = m_deferredObjects.find(std::make_pair(name_space, id));
+		if (it == m_deferredObjects.end()) {
+			return NULL;
+		}
+		// erased first, so lookups of the provider do not recurse
+		IObjectProvider* provider = it->second;
+		m_deferredObjects.erase(it);
+		return provider->provideObject(id, name_space);
 	}
 
 	std::list<Object*> Model::getObjects(const std::string& name_space) const {
@@ -325,9 +398,13 @@ namespace FIFE {
 	}
 
 	void Model::update() {
-		std::list<Map*>::iterator it = m_maps.begin();
-		for(; it != m_maps.end(); ++it) {
-			(*it)->update();
+		if (m_workerPool && m_maps.size() > 1) {
+			updateMapsParallel();
+		} else {
+			std::list<Map*>::iterator it = m_maps.begin();
+			for(; it != m_maps.end(); ++it) {
+				(*it)->update();
+			}
 		}
 		std::vector<IPather*>::iterator jt = m_pathers.begin();
 		for(; jt != m_pathers.end(); ++jt) {
@@ -335,5 +412,35 @@ namespace FIFE {
 		}
 	}
 
+	void Model::updateMapsParallel() {
+		std::vector<Map*> maps(m_maps.begin(), m_maps.end());
+		std::vector<Map*>::iterator it = maps.begin();
+		for (; it != maps.end(); ++it) {
+			(*it)->beginUpdate();
+		}
+		m_workerPool->parallelFor(static_cast<uint32_t>(maps.size()),
+			std::bind(&Model::updateMapLayers, std::cref(maps), std::placeholders::_1));
+		for (it = maps.begin(); it != maps.end(); ++it) {
+			(*it)->endUpdate();
+		}
+	}
+
+	void Model::updateMapLayers(const std::vector<Map*>& maps, uint32_t index) {
+		maps[index]->updateLayers(true);
+	}
+
+	void Model::setParallelMapUpdate(bool enabled, uint32_t threads) {
+		delete m_workerPool;
+		m_workerPool = NULL;
+		if (enabled) {
+			m_workerPool = new WorkerPool(threads);
+			FL_LOG(_log, LMsg("parallel map update with ") << m_workerPool->getThreadCount() << " worker threads");
+		}
+	}
+
+	bool Model::isParallelMapUpdate() const {
+		return m_workerPool != NULL;
+	}
+
 } //FIFE
 
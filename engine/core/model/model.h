@@ -47,6 +47,8 @@ namespace FIFE {
 	class ModelMapObserver;
 	class IPather;
 	class Object;
+	class WorkerPool;
+	class IObjectProvider;
 
 	/**
 	 * A model is a facade for everything in the model.
@@ -119,13 +121,34 @@ namespace FIFE {
 		bool deleteObjects();
 
 		/** Get an object by its id. Returns 0 if object is not found.
+		 * A deferred object is created by its provider on the first call.
 		 */
 		Object* getObject(const std::string& id, const std::string& name_space);
 
 		/** Get all the objects in the given namespace.
+		 * Deferred objects that are not created yet are not included.
 		 */
 		std::list<Object*> getObjects(const std::string& name_space) const;
 
+		/** Registers an object that is created by the provider the first time it is requested.
+		 * @return false if an object with this id already exists or is registered.
+		 */
+		bool addDeferredObject(const std::string& identifier, const std::string& name_space, IObjectProvider* provider);
+
+		/** Removes all deferred objects of the provider, the provider must call this before it is deleted.
+		 */
+		void removeObjectProvider(IObjectProvider* provider);
+
+		/** Returns true if the object is registered but not created yet.
+		 */
+		bool isObjectDeferred(const std::string& id, const std::string& name_space) const;
+
+		/** Creates deferred objects ahead of time, e.g. before a map is shown.
+		 * @param name_space The namespace of the objects.
+		 * @param ids The identifiers of the objects, if empty all deferred objects of the namespace are created.
+		 */
+		void preloadObjects(const std::string& name_space, const std::list<std::string>& ids = std::list<std::string>());
+
 		/** Adds pather to model. Moves ownership to model
 		 */
 		void adoptPather(IPather* pather);
@@ -150,6 +173,22 @@ namespace FIFE {
 		 */
 		void update();
 
+		/** Enables or disables the parallel update of the maps.
+		 * If enabled, the layers of independent maps are updated on a worker pool.
+		 * Instance transfers, listener callbacks, cellcache updates and camera rendering
+		 * are still done on the main thread, map by map at the end of the update.
+		 * Pathers are updated after all maps, as before.
+		 * Listeners are therefore called a bit later than in the serial update, but in
+		 * the same order. Maps must not access each other while they are updated.
+		 * @param enabled A boolean, true to update the maps in parallel.
+		 * @param threads Number of worker threads, 0 picks a value based on the hardware.
+		 */
+		void setParallelMapUpdate(bool enabled, uint32_t threads = 0);
+
+		/** Returns true if the maps are updated in parallel. @see setParallelMapUpdate
+		 */
+		bool isParallelMapUpdate() const;
+
 		/** Sets speed for the model. With speed 1.0, everything runs with normal speed.
 		 * With speed 2.0, clock is ticking twice as fast. With 0, everything gets paused.
 		 * Negavtive values are not supported (throws NotSupported exception).
@@ -179,6 +218,22 @@ namespace FIFE {
 		/// Convenience function to retrieve a pointer to a namespace or NULL if it doesn't exist
 		const namespace_t* selectNamespace(const std::string& name_space) const;
 
+		/// Deferred objects by namespace and identifier
+		typedef std::map<std::pair<std::string, std::string>, IObjectProvider*> deferredmap_t;
+		deferredmap_t m_deferredObjects;
+
+		/// Tells all providers to forget their deferred objects and clears them
+		void forgetObjectProviders();
+
+		/// Lets the provider create a deferred object, NULL if the object is not deferred
+		Object* createDeferredObject(const std::string& id, const std::string& name_space);
+
+		/// Updates the maps, the layers of each map are updated on the worker pool
+		void updateMapsParallel();
+
+		/// Worker task of updateMapsParallel
+		static void updateMapLayers(const std::vector<Map*>& maps, uint32_t index);
+
 		std::vector<IPather*> m_pathers;
 		std::vector<CellGrid*> m_createdGrids;
 		std::vector<CellGrid*> m_adoptedGrids;
@@ -188,6 +243,9 @@ namespace FIFE {
 		RenderBackend* m_renderbackend;
 
 		std::vector<RendererBase*> m_renderers;
+
+		//! worker pool for the parallel map update, NULL if disabled
+		WorkerPool* m_workerPool;
 	};
 
 }; //FIFE
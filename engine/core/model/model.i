@@ -56,6 +56,8 @@ namespace FIFE {
 		bool deleteObjects();
 		Object* getObject(const std::string& id, const std::string& name_space);
 		std::list<Object*> getObjects(const std::string& name_space) const;
+		bool isObjectDeferred(const std::string& id, const std::string& name_space) const;
+		void preloadObjects(const std::string& name_space, const std::list<std::string>& ids = std::list<std::string>());
 
 		uint32_t getMapCount() const;
 		void deleteMaps();
@@ -66,6 +68,9 @@ namespace FIFE {
 		
 		void setTimeMultiplier(float multip);
 		double getTimeMultiplier() const;
+
+		void setParallelMapUpdate(bool enabled, uint32_t threads = 0);
+		bool isParallelMapUpdate() const;
 		
 	};
 }
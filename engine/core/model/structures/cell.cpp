@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 
 // 3rd party library includes
 
@@ -39,43 +40,50 @@ namespace FIFE {
 
 	static Logger _log(LM_STRUCTURES);
 
+	// relative position of each neighbor bit, in the order of CellGrid::getAccessibleCoordinates
+	static const int32_t NEIGHBOR_X[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+	static const int32_t NEIGHBOR_Y[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
 	Cell::Cell(int32_t coordint, ModelCoordinate coordinate, Layer* layer):
 		m_coordId(coordint),
 		m_coordinate(coordinate),
+		m_type(CTYPE_NO_BLOCKER),
+		m_inserted(false),
+		m_protect(false),
+		m_neighbors(0),
 		m_layer(layer),
 		m_zone(NULL),
-		m_transition(NULL),
-		m_inserted(false),
-		m_protect(false) {
+		m_sideData(NULL) {
 	}
 
 	Cell::~Cell() {
-		// calls CellDeleteListener, e.g. for transition
-		if (!m_deleteListeners.empty()) {
-			std::vector<CellDeleteListener*>::iterator it = m_deleteListeners.begin();
-			for (; it != m_deleteListeners.end(); ++it) {
-				if (*it) {
-					(*it)->onCellDeleted(this);
+		if (m_sideData) {
+			// calls CellDeleteListener, e.g. for transition
+			CellSideData* data = m_sideData;
+			++data->calling;
+			for (uint32_t i = 0; i < data->deleteListeners.size(); ++i) {
+				if (data->deleteListeners[i]) {
+					data->deleteListeners[i]->onCellDeleted(this);
 				}
 			}
+			--data->calling;
 		}
 		// remove cell from zone
 		if (m_zone) {
 			m_zone->removeCell(this);
 		}
-		// delete m_transition;
-		if (m_transition) {
-			deleteTransition();
-		}
+		// delete transition
+		deleteTransition();
 		// remove cell from cache (costs, narrow, area)
 		m_layer->getCellCache()->removeCell(this);
+		delete m_sideData;
 	}
 
 	void Cell::addInstances(const std::list<Instance*>& instances) {
 		CellCache* cache = m_layer->getCellCache();
 		for (std::list<Instance*>::const_iterator it = instances.begin(); it != instances.end(); ++it) {
-			std::pair<std::set<Instance*>::iterator, bool> ret = m_instances.insert(*it);
-			if (ret.second) {
+			if (std::find(m_instances.begin(), m_instances.end(), *it) == m_instances.end()) {
+				m_instances.push_back(*it);
 				if ((*it)->isSpecialCost()) {
 					cache->registerCost((*it)->getCostId(), (*it)->getCost());
 					cache->addCellToCost((*it)->getCostId(), this);
@@ -93,8 +101,8 @@ namespace FIFE {
 	}
 
 	void Cell::addInstance(Instance* instance) {
-		std::pair<std::set<Instance*>::iterator, bool> ret = m_instances.insert(instance);
-		if (ret.second) {
+		if (std::find(m_instances.begin(), m_instances.end(), instance) == m_instances.end()) {
+			m_instances.push_back(instance);
 			CellCache* cache = m_layer->getCellCache();
 			if (instance->isSpecialCost()) {
 				cache->registerCost(instance->getCostId(), instance->getCost());
@@ -116,10 +124,12 @@ namespace FIFE {
 	}
 
 	void Cell::removeInstance(Instance* instance) {
-		if (m_instances.erase(instance) == 0) {
+		CellInstances::iterator instit = std::find(m_instances.begin(), m_instances.end(), instance);
+		if (instit == m_instances.end()) {
 			FL_ERR(_log, "Tried to remove an instance from cell, but given instance could not be found.");
 			return;
 		}
+		m_instances.erase(instit);
 		CellCache* cache = m_layer->getCellCache();
 		if (instance->isSpecialCost()) {
 			cache->removeCellFromCost(instance->getCostId(), this);
@@ -128,7 +138,7 @@ namespace FIFE {
 			cache->resetSpeedMultiplier(this);
 			// try to find other speed value
 			if (!m_instances.empty()) {
-				std::set<Instance*>::iterator it = m_instances.begin();
+				CellInstances::iterator it = m_instances.begin();
 				for (; it != m_instances.end(); ++it) {
 					if ((*it)->isSpecialSpeed()) {
 						cache->setSpeedMultiplier(this, (*it)->getSpeed());
@@ -145,13 +155,11 @@ namespace FIFE {
 	}
 
 	bool Cell::isNeighbor(Cell* cell) {
-		std::vector<Cell*>::iterator it = m_neighbors.begin();
-		for (; it != m_neighbors.end(); ++it) {
-			if (*it == cell) {
-				return true;
-			}
+		if (m_sideData && m_sideData->transitionCell == cell) {
+			return true;
 		}
-		return false;
+		int32_t bit = getNeighborBit(cell);
+		return bit != -1 && (m_neighbors & (1 << bit)) != 0;
 	}
 
 	void Cell::updateCellBlockingInfo() {
@@ -160,7 +168,7 @@ namespace FIFE {
 		if (!m_instances.empty()) {
 			int32_t pos = -1;
 			bool cellblock = (m_type == CTYPE_CELL_NO_BLOCKER || m_type == CTYPE_CELL_BLOCKER);
-			for (std::set<Instance*>::iterator it = m_instances.begin(); it != m_instances.end(); ++it) {
+			for (CellInstances::iterator it = m_instances.begin(); it != m_instances.end(); ++it) {
 				if (cellblock) {
 					continue;
 				}
@@ -206,7 +214,9 @@ namespace FIFE {
 		if (old_type != m_type) {
 			bool block = (m_type == CTYPE_STATIC_BLOCKER ||
 				m_type == CTYPE_DYNAMIC_BLOCKER || m_type == CTYPE_CELL_BLOCKER);
-			m_layer->getCellCache()->setBlockingUpdate(true);
+			CellCache* cache = m_layer->getCellCache();
+			cache->setBlockingUpdate(true);
+			cache->markCellChanged(this);
 			callOnBlockingChanged(block);
 		}
 	}
@@ -214,16 +224,23 @@ namespace FIFE {
 	void Cell::updateCellInfo() {
 		updateCellBlockingInfo();
 
-		if (!m_deleteListeners.empty()) {
-			m_deleteListeners.erase(
-				std::remove(m_deleteListeners.begin(), m_deleteListeners.end(),
-				(CellDeleteListener*)NULL),	m_deleteListeners.end());
+		// removed listeners stay in place while they are called
+		if (!m_sideData || m_sideData->calling != 0) {
+			return;
 		}
-		if (!m_changeListeners.empty()) {
-			m_changeListeners.erase(
-				std::remove(m_changeListeners.begin(), m_changeListeners.end(),
-				(CellChangeListener*)NULL),	m_changeListeners.end());
+		std::vector<CellDeleteListener*>& deleteListeners = m_sideData->deleteListeners;
+		if (!deleteListeners.empty()) {
+			deleteListeners.erase(
+				std::remove(deleteListeners.begin(), deleteListeners.end(),
+				(CellDeleteListener*)NULL),	deleteListeners.end());
 		}
+		std::vector<CellChangeListener*>& changeListeners = m_sideData->changeListeners;
+		if (!changeListeners.empty()) {
+			changeListeners.erase(
+				std::remove(changeListeners.begin(), changeListeners.end(),
+				(CellChangeListener*)NULL),	changeListeners.end());
+		}
+		releaseSideData();
 	}
 
 	bool Cell::defaultCost() {
@@ -292,10 +309,17 @@ namespace FIFE {
 	}
 
 	void Cell::setCellType(CellTypeInfo type) {
+		if (m_type == type) {
+			return;
+		}
 		m_type = type;
+		CellCache* cache = m_layer->getCellCache();
+		if (cache) {
+			cache->markCellChanged(this);
+		}
 	}
 
-	const std::set<Instance*>& Cell::getInstances() {
+	const CellInstances& Cell::getInstances() {
 		return m_instances;
 	}
 
@@ -312,24 +336,33 @@ namespace FIFE {
 	}
 
 	void Cell::addNeighbor(Cell* cell) {
-		m_neighbors.push_back(cell);
-	}
-
-	const std::vector<Cell*>& Cell::getNeighbors() {
-		return m_neighbors;
+		int32_t bit = getNeighborBit(cell);
+		if (bit != -1) {
+			m_neighbors |= static_cast<uint8_t>(1 << bit);
+		}
 	}
 
-	void Cell::resetNeighbors() {
-		m_neighbors.clear();
-		if (m_transition) {
-			CellCache* cache = m_transition->m_layer->getCellCache();
-			if (cache) {
-				Cell* cell = cache->getCell(m_transition->m_mc);
-				if (cell) {
-					m_neighbors.push_back(cell);
+	CellNeighbors Cell::getNeighbors() {
+		CellNeighbors neighbors;
+		// the transition cell comes first, like it did after the neighbors were rebuilt
+		if (m_sideData && m_sideData->transitionCell) {
+			neighbors.push_back(m_sideData->transitionCell);
+		}
+		if (m_neighbors) {
+			CellCache* cache = m_layer->getCellCache();
+			const std::vector<Cell*>& cells = cache->getCells();
+			int32_t width = static_cast<int32_t>(cache->getWidth());
+			for (int32_t bit = 0; bit < 8; ++bit) {
+				if (m_neighbors & (1 << bit)) {
+					neighbors.push_back(cells[m_coordId + NEIGHBOR_X[bit] + NEIGHBOR_Y[bit] * width]);
 				}
 			}
 		}
+		return neighbors;
+	}
+
+	void Cell::resetNeighbors() {
+		m_neighbors = 0;
 	}
 
 	Layer* Cell::getLayer() {
@@ -337,6 +370,12 @@ namespace FIFE {
 	}
 
 	void Cell::createTransition(Layer* layer, const ModelCoordinate& mc, bool immediate) {
+		deleteTransition();
+
+		Cell* c = layer->getCellCache()->getCell(mc);
+		if (!c) {
+			return;
+		}
 		TransitionInfo* trans = new TransitionInfo(layer);
 		// if layers are the same then it's a portal
 		if (layer != m_layer) {
@@ -345,49 +384,37 @@ namespace FIFE {
 		trans->m_immediate = immediate;
 		trans->m_mc = mc;
 
-		deleteTransition();
-
-		m_transition = trans;
-
-		Cell* c = layer->getCellCache()->getCell(mc);
-		if (c) {
-			m_neighbors.push_back(c);
-			c->addDeleteListener(this);
-			m_layer->getCellCache()->addTransition(this);
-		} else {
-			delete m_transition;
-			m_transition = NULL;
-		}
+		CellSideData* data = getSideData();
+		data->transition = trans;
+		data->transitionCell = c;
+		c->addDeleteListener(this);
+		m_layer->getCellCache()->addTransition(this);
 	}
 
 	void Cell::deleteTransition() {
-		if (m_transition) {
-			Cell* oldc = m_transition->m_layer->getCellCache()->getCell(m_transition->m_mc);
-			std::vector<Cell*>::iterator it = m_neighbors.begin();
-			for (; it != m_neighbors.end(); ++it) {
-				if (*it == oldc) {
-					m_neighbors.erase(it);
-					break;
-				}
-			}
-			oldc->removeDeleteListener(this);
+		if (m_sideData && m_sideData->transition) {
+			m_sideData->transitionCell->removeDeleteListener(this);
 			m_layer->getCellCache()->removeTransition(this);
-			delete m_transition;
-			m_transition = NULL;
+			delete m_sideData->transition;
+			m_sideData->transition = NULL;
+			m_sideData->transitionCell = NULL;
 		}
 	}
 
 	TransitionInfo* Cell::getTransition() {
-		return m_transition;
+		return m_sideData ? m_sideData->transition : NULL;
 	}
 
 	void Cell::addDeleteListener(CellDeleteListener* listener) {
-		m_deleteListeners.push_back(listener);
+		getSideData()->deleteListeners.push_back(listener);
 	}
 
 	void Cell::removeDeleteListener(CellDeleteListener* listener) {
-		std::vector<CellDeleteListener*>::iterator it = m_deleteListeners.begin();
-		for (; it != m_deleteListeners.end(); ++it) {
+		if (!m_sideData) {
+			return;
+		}
+		std::vector<CellDeleteListener*>::iterator it = m_sideData->deleteListeners.begin();
+		for (; it != m_sideData->deleteListeners.end(); ++it) {
 			if (*it == listener) {
 				*it = NULL;
 				break;
@@ -396,22 +423,21 @@ namespace FIFE {
 	}
 
 	void Cell::onCellDeleted(Cell* cell) {
-		std::vector<Cell*>::iterator it = m_neighbors.begin();
-		for (; it != m_neighbors.end(); ++it) {
-			if (*it == cell) {
-				deleteTransition();
-				break;
-			}
+		if (m_sideData && m_sideData->transitionCell == cell) {
+			deleteTransition();
 		}
 	}
 
 	void Cell::addChangeListener(CellChangeListener* listener) {
-		m_changeListeners.push_back(listener);
+		getSideData()->changeListeners.push_back(listener);
 	}
 
 	void Cell::removeChangeListener(CellChangeListener* listener) {
-		std::vector<CellChangeListener*>::iterator it = m_changeListeners.begin();
-		for (; it != m_changeListeners.end(); ++it) {
+		if (!m_sideData) {
+			return;
+		}
+		std::vector<CellChangeListener*>::iterator it = m_sideData->changeListeners.begin();
+		for (; it != m_sideData->changeListeners.end(); ++it) {
 			if (*it == listener) {
 				*it = NULL;
 				break;
@@ -420,44 +446,75 @@ namespace FIFE {
 	}
 
 	void Cell::callOnInstanceEntered(Instance* instance) {
-		if (m_changeListeners.empty()) {
+		if (!m_sideData || m_sideData->changeListeners.empty()) {
 			return;
 		}
-
-		std::vector<CellChangeListener*>::iterator i = m_changeListeners.begin();
-		while (i != m_changeListeners.end()) {
-			if (*i) {
-				(*i)->onInstanceEnteredCell(this, instance);
+		// listeners may be added while iterating, so use indices. The side data
+		// is not compacted or freed until the loop is done.
+		CellSideData* data = m_sideData;
+		++data->calling;
+		for (uint32_t i = 0; i < data->changeListeners.size(); ++i) {
+			if (data->changeListeners[i]) {
+				data->changeListeners[i]->onInstanceEnteredCell(this, instance);
 			}
-			++i;
 		}
+		--data->calling;
 	}
 
 	void Cell::callOnInstanceExited(Instance* instance) {
-		if (m_changeListeners.empty()) {
+		if (!m_sideData || m_sideData->changeListeners.empty()) {
 			return;
 		}
-
-		std::vector<CellChangeListener*>::iterator i = m_changeListeners.begin();
-		while (i != m_changeListeners.end()) {
-			if (*i) {
-				(*i)->onInstanceExitedCell(this, instance);
+		CellSideData* data = m_sideData;
+		++data->calling;
+		for (uint32_t i = 0; i < data->changeListeners.size(); ++i) {
+			if (data->changeListeners[i]) {
+				data->changeListeners[i]->onInstanceExitedCell(this, instance);
 			}
-			++i;
 		}
+		--data->calling;
 	}
 
 	void Cell::callOnBlockingChanged(bool blocks) {
-		if (m_changeListeners.empty()) {
+		if (!m_sideData || m_sideData->changeListeners.empty()) {
 			return;
 		}
-
-		std::vector<CellChangeListener*>::iterator i = m_changeListeners.begin();
-		while (i != m_changeListeners.end()) {
-			if (*i) {
-				(*i)->onBlockingChangedCell(this, m_type, blocks);
+		CellSideData* data = m_sideData;
+		++data->calling;
+		for (uint32_t i = 0; i < data->changeListeners.size(); ++i) {
+			if (data->changeListeners[i]) {
+				data->changeListeners[i]->onBlockingChangedCell(this, m_type, blocks);
 			}
-			++i;
 		}
+		--data->calling;
+	}
+
+	CellSideData* Cell::getSideData() {
+		if (!m_sideData) {
+			m_sideData = new CellSideData();
+		}
+		return m_sideData;
+	}
+
+	void Cell::releaseSideData() {
+		if (m_sideData && m_sideData->calling == 0 && !m_sideData->transition &&
+			m_sideData->deleteListeners.empty() && m_sideData->changeListeners.empty()) {
+			delete m_sideData;
+			m_sideData = NULL;
+		}
+	}
+
+	int32_t Cell::getNeighborBit(const Cell* cell) const {
+		if (cell == this || cell->m_layer != m_layer) {
+			return -1;
+		}
+		int32_t x = cell->m_coordinate.x - m_coordinate.x;
+		int32_t y = cell->m_coordinate.y - m_coordinate.y;
+		if (x < -1 || x > 1 || y < -1 || y > 1) {
+			return -1;
+		}
+		// 3x3 block in x-major order without the center
+		int32_t bit = (x + 1) * 3 + (y + 1);
+		return bit > 4 ? bit - 1 : bit;
 	}
 } // FIFE
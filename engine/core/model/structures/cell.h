@@ -35,6 +35,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/fifeclass.h"
+#include "util/structures/smallvector.h"
 #include "model/metamodel/modelcoords.h"
 
 
@@ -118,6 +119,30 @@ namespace FIFE {
 		virtual void onBlockingChangedCell(Cell* cell, CellTypeInfo type, bool blocks) = 0;
 	};
 
+	//! instances on a cell, most cells hold none or one
+	typedef SmallVector<Instance*, 1> CellInstances;
+
+	//! neighbors of a cell, up to eight grid neighbors and one transition
+	typedef SmallVector<Cell*, 9> CellNeighbors;
+
+	/** Rarely used data of a cell. It is allocated on first use,
+	 * so cells without transition and listeners don't pay for it.
+	 */
+	struct CellSideData {
+		CellSideData(): transition(NULL), transitionCell(NULL), calling(0) {}
+
+		//! transition, NULL if there is none
+		TransitionInfo* transition;
+		//! target cell of the transition
+		Cell* transitionCell;
+		//! delete listener
+		std::vector<CellDeleteListener*> deleteListeners;
+		//! change listener
+		std::vector<CellChangeListener*> changeListeners;
+		//! number of running listener loops, the listeners are not compacted or freed meanwhile
+		uint32_t calling;
+	};
+
 	/** A basic cell on a CellCache.
 	 */
 	class Cell: public FifeClass, public CellDeleteListener {
@@ -248,9 +273,9 @@ namespace FIFE {
 			void setCellType(CellTypeInfo type);
 
 			/** Returns all instances on this cell.
-			 * @return A const reference to a set that refer to the instances on this cell.
+			 * @return A const reference to a small vector that refer to the instances on this cell.
 			 */
-			const std::set<Instance*>& getInstances();
+			const CellInstances& getInstances();
 
 			/** Sets the cell identifier.
 			 * @param id A unique int value that is used as identifier. Based on the cell position.
@@ -268,14 +293,18 @@ namespace FIFE {
 			const ModelCoordinate getLayerCoordinates() const;
 
 			/** Adds a neighbor cell to this cell.
+			 * The neighbor has to be one of the eight adjacent cells on the same CellCache.
 			 * @param cell A pointer to the cell that should added as neighbor.
 			 */
 			void addNeighbor(Cell* cell);
 
-			/** Returns the layer coordinates of this cell.
-			 * @return A const reference to a set of all neighbor cells.
+			/** Returns the neighbors of this cell.
+			 * The transition cell comes first if there is one, followed by the grid neighbors.
+			 * They are stored as bits and resolved through the CellCache in the order of
+			 * CellGrid::getAccessibleCoordinates.
+			 * @return A small vector of all neighbor cells.
 			 */
-			const std::vector<Cell*>& getNeighbors();
+			CellNeighbors getNeighbors();
 
 			/** Removes all neighbors from cell.
 			 */
@@ -353,20 +382,26 @@ namespace FIFE {
 
 			void updateCellBlockingInfo();
 
+			/** Returns the side data, creates it if needed.
+			 */
+			CellSideData* getSideData();
+
+			/** Frees the side data if it holds nothing.
+			 */
+			void releaseSideData();
+
+			/** Returns the neighbor bit for the relative position or -1 if it is not adjacent.
+			 */
+			int32_t getNeighborBit(const Cell* cell) const;
+
 			//! holds coordinate as a unique integer id
 			int32_t m_coordId;
 			
 			//! holds coordinate
 			ModelCoordinate m_coordinate;
 
-			//! parent layer
-			Layer* m_layer;
-
-			//! parent Zone
-			Zone* m_zone;
-
-			//! Pointer to Transistion
-			TransitionInfo* m_transition;
+			//! CellType
+			CellTypeInfo m_type;
 
 			//! already inserted
 			bool m_inserted;
@@ -374,20 +409,20 @@ namespace FIFE {
 			//! protected
 			bool m_protect;
 
-			//! CellType
-			CellTypeInfo m_type;
+			//! grid neighbors, one bit for each adjacent cell
+			uint8_t m_neighbors;
 
-			// contained Instances
-			std::set<Instance*> m_instances;
+			//! parent layer
+			Layer* m_layer;
 
-			//! neighbor cells
-			std::vector<Cell*> m_neighbors;
+			//! parent Zone
+			Zone* m_zone;
 
-			//! delete listener
-			std::vector<CellDeleteListener*> m_deleteListeners;
+			//! transition and listeners, NULL if unused
+			CellSideData* m_sideData;
 
-			//! change listener
-			std::vector<CellChangeListener*> m_changeListeners;
+			//! contained Instances
+			CellInstances m_instances;
 	};
 
 } // FIFE
@@ -66,7 +66,6 @@ namespace FIFE {
 			void removeInstance(Instance* instance);
 
 			bool isNeighbor(Cell* cell);
-			std::vector<Cell*> getNeighbors();
 			void updateCellInfo();
 			int32_t getCellId();
 			const ModelCoordinate getLayerCoordinates() const;
@@ -79,7 +78,6 @@ namespace FIFE {
 			double getSpeedMultiplier();
 			void resetSpeedMultiplier();
 			
-			const std::set<Instance*>& getInstances();
 			void setCellType(CellTypeInfo type);
 			CellTypeInfo getCellType();
 			Layer* getLayer();
@@ -91,6 +89,17 @@ namespace FIFE {
 			void addDeleteListener(CellDeleteListener* listener);
 			void removeDeleteListener(CellDeleteListener* listener);
 	};
+
+	%extend Cell {
+		std::vector<Cell*> getNeighbors() {
+			FIFE::CellNeighbors neighbors = $self->getNeighbors();
+			return std::vector<FIFE::Cell*>(neighbors.begin(), neighbors.end());
+		}
+		std::vector<Instance*> getInstances() {
+			const FIFE::CellInstances& instances = $self->getInstances();
+			return std::vector<FIFE::Instance*>(instances.begin(), instances.end());
+		}
+	}
 }
 
 namespace std {
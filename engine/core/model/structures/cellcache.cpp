@@ -20,6 +20,9 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <functional>
+#include <new>
+#include <unordered_map>
 
 // 3rd party library includes
 
@@ -28,6 +31,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "model/metamodel/grids/cellgrid.h"
+#include "util/concurrency/workerpool.h"
 #include "util/log/logger.h"
 #include "util/structures/purge.h"
 
@@ -42,6 +46,82 @@ namespace FIFE {
 
 	static Logger _log(LM_STRUCTURES);
 
+	/** A block of memory with one cell slot per cell index.
+	 * Cells are constructed in place and keep their address until they are destroyed,
+	 * so a resized cache can keep cells of an older arena alive.
+	 */
+	class CellArena {
+	public:
+		CellArena(uint32_t capacity):
+			m_cells(static_cast<Cell*>(::operator new(static_cast<size_t>(capacity) * sizeof(Cell)))),
+			m_capacity(capacity),
+			m_alive(0) {
+		}
+
+		~CellArena() {
+			::operator delete(m_cells);
+		}
+
+		/** Constructs a cell in the given slot. Different slots can be used in parallel,
+		 * the caller reports the number of constructed cells with addAlive().
+		 */
+		Cell* construct(uint32_t slot, const ModelCoordinate& mc, Layer* layer) {
+			return new (m_cells + slot) Cell(static_cast<int32_t>(slot), mc, layer);
+		}
+
+		void addAlive(uint32_t count) {
+			m_alive += count;
+		}
+
+		/** Destroys the cell and returns true if the arena is empty afterwards.
+		 */
+		bool destroy(Cell* cell) {
+			cell->~Cell();
+			return --m_alive == 0;
+		}
+
+		bool owns(const Cell* cell) const {
+			std::less<const Cell*> less;
+			return !less(cell, m_cells) && less(cell, m_cells + m_capacity);
+		}
+
+	private:
+		//! cell slots
+		Cell* m_cells;
+		//! number of slots
+		uint32_t m_capacity;
+		//! number of constructed cells
+		uint32_t m_alive;
+	};
+
+	//! instances of a layer sorted by their layer coordinates
+	typedef std::unordered_map<uint64_t, std::vector<Instance*> > InstanceBucketMap;
+
+	static uint64_t bucketKey(const ModelCoordinate& mc) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(mc.x)) << 32) | static_cast<uint32_t>(mc.y);
+	}
+
+	/** Shared state of the row bands while cells are built.
+	 */
+	struct CellCache::CellBuildContext {
+		//! relative neighbor coordinates, indexed by (x & 1) | ((y & 1) << 1)
+		std::vector<ModelCoordinate> offsets[4];
+		//! rows per band
+		uint32_t bandRows;
+		//! number of constructed cells per band
+		std::vector<uint32_t> created;
+		//! instances of interact layers per band, as pairs of cell index and instance
+		std::vector<std::vector<std::pair<uint32_t, Instance*> > > interactInstances;
+		//! instances of each interact layer
+		std::vector<InstanceBucketMap> interactBuckets;
+		//! per cell, 1 if the cell is a narrow cell
+		std::vector<uint8_t> narrow;
+		//! neighbors are checked against m_neighborZ
+		bool zCheck;
+		//! narrow cells are searched
+		bool searchNarrow;
+	};
+
 	class CellCacheChangeListener : public LayerChangeListener {
 	public:
 		CellCacheChangeListener(Layer* layer)	{
@@ -349,8 +429,8 @@ namespace FIFE {
 			} else {
 				Zone* z1 = cell->getZone();
 				Zone* z2 = NULL;
-				const std::vector<Cell*>& neighbors = cell->getNeighbors();
-				std::vector<Cell*>::const_iterator it = neighbors.begin();
+				const CellNeighbors& neighbors = cell->getNeighbors();
+				CellNeighbors::const_iterator it = neighbors.begin();
 				for (; it != neighbors.end(); ++it) {
 					Zone* z = (*it)->getZone();
 					if (z && z != z1) {
@@ -372,8 +452,12 @@ namespace FIFE {
 		m_layer(layer),
 		m_defaultCostMulti(1.0),
 		m_defaultSpeedMulti(1.0),
+		m_arena(NULL),
 		m_neighborZ(-1),
 		m_blockingUpdate(false),
+		m_revision(0),
+		m_layoutRevision(0),
+		m_bandRevisions(),
 		m_sizeUpdate(false),
 		m_searchNarrow(true),
 		m_staticSize(false) {
@@ -408,10 +492,8 @@ namespace FIFE {
 		m_width = ABS(m_size.w - m_size.x) + 1;
 		m_height = ABS(m_size.h - m_size.y) + 1;
 
-		m_cells.resize(m_width);
-		for (uint32_t i = 0; i < m_width; ++i) {
-			m_cells[i].resize(m_height, NULL);
-		}
+		m_cells.resize(m_width * m_height, NULL);
+		markLayoutChanged();
 	}
 
 	CellCache::~CellCache() {
@@ -449,15 +531,17 @@ namespace FIFE {
 		m_cellAreas.clear();
 		// delete cells
 		if (!m_cells.empty()) {
-			std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
+			std::vector<Cell*>::iterator it = m_cells.begin();
 			for (; it != m_cells.end(); ++it) {
-				std::vector<Cell*>::iterator cit = (*it).begin();
-				for (; cit != (*it).end(); ++cit) {
-					delete *cit;
+				if (*it) {
+					destroyCell(*it);
 				}
 			}
 			m_cells.clear();
 		}
+		purge(m_arenas);
+		m_arenas.clear();
+		m_arena = NULL;
 		// reset default cost and speed
 		m_defaultCostMulti = 1.0;
 		m_defaultSpeedMulti = 1.0;
@@ -486,24 +570,27 @@ namespace FIFE {
 			uint32_t w = ABS(newsize.w - newsize.x) + 1;
 			uint32_t h = ABS(newsize.h - newsize.y) + 1;
 
-			std::vector<std::vector<Cell*> > cells;
-			cells.resize(w);
-			for (uint32_t i = 0; i < w; ++i) {
-				cells[i].resize(h, NULL);
-			}
+			std::vector<Cell*> cells(w * h, NULL);
+			// new cells go into a new arena, transferred cells stay where they are
+			CellArena* arena = NULL;
 			const std::vector<Layer*>& interacts = m_layer->getInteractLayers();
 			for(uint32_t y = 0; y < h; ++y) {
 				for(uint32_t x = 0; x < w; ++x) {
 					// transfer cells
 					ModelCoordinate mc(newsize.x+x, newsize.y+y);
 					Cell* cell = NULL;
+					uint32_t index = x + y * w;
 					int32_t old_x = mc.x - m_size.x;
 					int32_t old_y = mc.y - m_size.y;
 					// out of range in the old size, so we create a new cell
 					if (old_x < 0 || old_x >= static_cast<int32_t>(m_width) || old_y < 0 || old_y >= static_cast<int32_t>(m_height)) {
-						int32_t coordId = x + y * w;
-						cell = new Cell(coordId, mc, m_layer);
-						cells[x][y] = cell;
+						if (!arena) {
+							arena = new CellArena(w * h);
+							m_arenas.push_back(arena);
+						}
+						cell = arena->construct(index, mc, m_layer);
+						arena->addAlive(1);
+						cells[index] = cell;
 
 						std::list<Instance*> cell_instances;
 						m_layer->getInstanceTree()->findInstances(mc, 0, 0, cell_instances);
@@ -529,174 +616,296 @@ namespace FIFE {
 						}
 					// transfer ownership
 					} else {
-						cell = m_cells[static_cast<uint32_t>(old_x)][static_cast<uint32_t>(old_y)];
-						m_cells[static_cast<uint32_t>(old_x)][static_cast<uint32_t>(old_y)] = NULL;
-						cells[x][y] = cell;
-						int32_t coordId = x + y * w;
-						cell->setCellId(coordId);
+						uint32_t old_index = static_cast<uint32_t>(old_x) + static_cast<uint32_t>(old_y) * m_width;
+						cell = m_cells[old_index];
+						m_cells[old_index] = NULL;
+						cells[index] = cell;
+						cell->setCellId(static_cast<int32_t>(index));
 						cell->resetNeighbors();
 					}
 				}
 			}
-			// delete old unused cells
-			std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
+			// delete old unused cells, destroyCell frees the old arenas once they are empty
+			m_arena = arena;
+			std::vector<Cell*>::iterator it = m_cells.begin();
 			for (; it != m_cells.end(); ++it) {
-				std::vector<Cell*>::iterator cit = (*it).begin();
-				for (; cit != (*it).end(); ++cit) {
-					if (*cit) {
-						delete *cit;
-						*cit = NULL;
-					}
+				if (*it) {
+					destroyCell(*it);
 				}
 			}
 			// use new values
-			m_cells = cells;
+			m_cells.swap(cells);
 			m_size = newsize;
 			m_width = w;
 			m_height = h;
+			markLayoutChanged();
 
-			bool zCheck = m_neighborZ != -1;
 			// fill neighbors into cells
-			it = m_cells.begin();
-			for (; it != m_cells.end(); ++it) {
-				std::vector<Cell*>::iterator cit = (*it).begin();
-				for (; cit != (*it).end(); ++cit) {
-					int32_t cellZ = (*cit)->getLayerCoordinates().z;
-					std::vector<ModelCoordinate> coordinates;
-					m_layer->getCellGrid()->getAccessibleCoordinates((*cit)->getLayerCoordinates(), coordinates);
-					for (std::vector<ModelCoordinate>::iterator mi = coordinates.begin(); mi != coordinates.end(); ++mi) {
-						Cell* c = getCell(*mi);
-						if (*cit == c || !c) {
-							continue;
-						}
-						if (zCheck) {
-							if (ABS(c->getLayerCoordinates().z - cellZ) > m_neighborZ) {
-								continue;
-							}
-						}
-						(*cit)->addNeighbor(c);
+			CellBuildContext context;
+			fillNeighborOffsets(context);
+			context.bandRows = m_height;
+			context.zCheck = m_neighborZ != -1;
+			context.searchNarrow = false;
+			connectCellBand(context, 0);
+		}
+	}
+
+	void CellCache::createCells(WorkerPool* pool) {
+		const uint32_t count = m_width * m_height;
+		if (count == 0) {
+			return;
+		}
+		markLayoutChanged();
+		if (!m_arena) {
+			m_arena = new CellArena(count);
+			m_arenas.push_back(m_arena);
+		}
+
+		// split the rows into bands, a few more than threads to balance the work
+		uint32_t bands = 1;
+		if (pool) {
+			bands = std::min(m_height, (pool->getThreadCount() + 1) * 4);
+		}
+		CellBuildContext context;
+		fillNeighborOffsets(context);
+		context.bandRows = (m_height + bands - 1) / bands;
+		bands = (m_height + context.bandRows - 1) / context.bandRows;
+		context.created.resize(bands, 0);
+		context.interactInstances.resize(bands);
+		context.narrow.resize(count, 0);
+		context.zCheck = false;
+		context.searchNarrow = m_searchNarrow;
+
+		// sort the instances of the interact layers by coordinates, the bands only read them
+		const std::vector<Layer*>& interacts = m_layer->getInteractLayers();
+		context.interactBuckets.resize(interacts.size());
+		for (uint32_t i = 0; i < interacts.size(); ++i) {
+			const std::vector<Instance*>& instances = interacts[i]->getInstances();
+			std::vector<Instance*>::const_iterator it = instances.begin();
+			for (; it != instances.end(); ++it) {
+				context.interactBuckets[i][bucketKey((*it)->getLocationRef().getLayerCoordinates())].push_back(*it);
+			}
+		}
+
+		// construct cells
+		if (pool) {
+			pool->parallelFor(bands, std::bind(&CellCache::createCellBand, this, std::ref(context), std::placeholders::_1));
+		} else {
+			createCellBand(context, 0);
+		}
+		for (uint32_t i = 0; i < bands; ++i) {
+			m_arena->addAlive(context.created[i]);
+		}
+
+		// fill Instances into Cells, this registers costs, speeds and areas on the cache
+		std::vector<std::pair<uint32_t, Instance*> > entries;
+		const std::vector<Instance*>& instances = m_layer->getInstances();
+		entries.reserve(instances.size());
+		std::vector<Instance*>::const_iterator instit = instances.begin();
+		for (; instit != instances.end(); ++instit) {
+			const ModelCoordinate& mc = (*instit)->getLocationRef().getLayerCoordinates();
+			int32_t x = mc.x - m_size.x;
+			int32_t y = mc.y - m_size.y;
+			if (x < 0 || x >= static_cast<int32_t>(m_width) || y < 0 || y >= static_cast<int32_t>(m_height)) {
+				continue;
+			}
+			entries.push_back(std::make_pair(static_cast<uint32_t>(x) + static_cast<uint32_t>(y) * m_width, *instit));
+		}
+		for (uint32_t i = 0; i < bands; ++i) {
+			entries.insert(entries.end(), context.interactInstances[i].begin(), context.interactInstances[i].end());
+		}
+		std::sort(entries.begin(), entries.end());
+		std::vector<std::pair<uint32_t, Instance*> >::const_iterator entryit = entries.begin();
+		while (entryit != entries.end()) {
+			uint32_t index = entryit->first;
+			std::list<Instance*> cell_instances;
+			for (; entryit != entries.end() && entryit->first == index; ++entryit) {
+				cell_instances.push_back(entryit->second);
+			}
+			m_cells[index]->addInstances(cell_instances);
+		}
+
+		// fill neighbors into cells
+		if (pool) {
+			pool->parallelFor(bands, std::bind(&CellCache::connectCellBand, this, std::ref(context), std::placeholders::_1));
+		} else {
+			connectCellBand(context, 0);
+		}
+		// add cells to narrow cells and add listener for zone change
+		for (uint32_t i = 0; i < count; ++i) {
+			if (context.narrow[i]) {
+				addNarrowCell(m_cells[i]);
+			}
+		}
+
+		// create Zones
+		std::vector<Cell*>::iterator it = m_cells.begin();
+		for (; it != m_cells.end(); ++it) {
+			Cell* cell = *it;
+			if (cell->getZone() || cell->isInserted()) {
+				continue;
+			}
+			if (cell->getCellType() == CTYPE_STATIC_BLOCKER || cell->getCellType() == CTYPE_CELL_BLOCKER) {
+				continue;
+			}
+			Zone* zone = createZone();
+			cell->setInserted(true);
+			std::stack<Cell*> cellstack;
+			cellstack.push(cell);
+			while(!cellstack.empty()) {
+				Cell* c = cellstack.top();
+				cellstack.pop();
+				zone->addCell(c);
+
+				const CellNeighbors& neighbors = c->getNeighbors();
+				for (CellNeighbors::const_iterator nit = neighbors.begin(); nit != neighbors.end(); ++nit) {
+					Cell* nc = *nit;
+					if (!nc->isInserted() &&
+						nc->getCellType() != CTYPE_STATIC_BLOCKER && nc->getCellType() != CTYPE_CELL_BLOCKER) {
+						nc->setInserted(true);
+						cellstack.push(nc);
 					}
 				}
 			}
 		}
 	}
 
-	void CellCache::createCells() {
+	Cell* CellCache::constructCell(uint32_t index, const ModelCoordinate& mc) {
+		if (!m_arena) {
+			m_arena = new CellArena(m_width * m_height);
+			m_arenas.push_back(m_arena);
+		}
+		Cell* cell = m_arena->construct(index, mc, m_layer);
+		m_arena->addAlive(1);
+		m_cells[index] = cell;
+		return cell;
+	}
+
+	void CellCache::destroyCell(Cell* cell) {
+		std::vector<CellArena*>::iterator it = m_arenas.begin();
+		for (; it != m_arenas.end(); ++it) {
+			if ((*it)->owns(cell)) {
+				if ((*it)->destroy(cell) && *it != m_arena) {
+					delete *it;
+					m_arenas.erase(it);
+				}
+				return;
+			}
+		}
+		// added from outside
+		delete cell;
+	}
+
+	void CellCache::fillNeighborOffsets(CellBuildContext& context) {
+		// the accessible coordinates only depend on the parity of the position (hex grids)
+		CellGrid* grid = m_layer->getCellGrid();
+		std::vector<ModelCoordinate> coordinates;
+		for (int32_t parity = 0; parity < 4; ++parity) {
+			ModelCoordinate origin(parity & 1, parity >> 1);
+			grid->getAccessibleCoordinates(origin, coordinates);
+			std::vector<ModelCoordinate>& offsets = context.offsets[parity];
+			offsets.clear();
+			std::vector<ModelCoordinate>::iterator it = coordinates.begin();
+			for (; it != coordinates.end(); ++it) {
+				if (it->x == origin.x && it->y == origin.y) {
+					continue;
+				}
+				offsets.push_back(ModelCoordinate(it->x - origin.x, it->y - origin.y));
+			}
+		}
+	}
+
+	void CellCache::createCellBand(CellBuildContext& context, uint32_t band) {
+		const uint32_t firstRow = band * context.bandRows;
+		const uint32_t lastRow = std::min(firstRow + context.bandRows, m_height);
 		const std::vector<Layer*>& interacts = m_layer->getInteractLayers();
-		for(uint32_t y = 0; y < m_height; ++y) {
-			for(uint32_t x = 0; x < m_width; ++x) {
+		std::vector<std::pair<uint32_t, Instance*> >& found = context.interactInstances[band];
+		uint32_t created = 0;
+		for (uint32_t y = firstRow; y < lastRow; ++y) {
+			for (uint32_t x = 0; x < m_width; ++x) {
+				uint32_t index = x + y * m_width;
 				ModelCoordinate mc(m_size.x+x, m_size.y+y);
-				Cell* cell = getCell(mc);
-				if (!cell) {
-					cell = new Cell(convertCoordToInt(mc), mc, m_layer);
-					m_cells[x][y] = cell;
+				if (!m_cells[index]) {
+					m_cells[index] = m_arena->construct(index, mc, m_layer);
+					++created;
 				}
-				// fill Instances into Cell
-				std::list<Instance*> cell_instances;
-				m_layer->getInstanceTree()->findInstances(mc, 0, 0, cell_instances);
-				if (!interacts.empty()) {
-					// fill interact Instances into Cell
-					std::vector<Layer*>::const_iterator it = interacts.begin();
-					std::list<Instance*> interact_instances;
-					for(; it != interacts.end(); ++it) {
-						// convert coordinates
-						ExactModelCoordinate emc(FIFE::intPt2doublePt(mc));
-						ModelCoordinate inter_mc = (*it)->getCellGrid()->toLayerCoordinates(m_layer->getCellGrid()->toMapCoordinates(emc));
-						// check interact layer for instances
-						(*it)->getInstanceTree()->findInstances(inter_mc, 0, 0, interact_instances);
-						if (!interact_instances.empty()) {
-							cell_instances.insert(cell_instances.end(), interact_instances.begin(), interact_instances.end());
-							interact_instances.clear();
-						}
-					}
+				if (interacts.empty()) {
+					continue;
 				}
-				if (!cell_instances.empty()) {
-					// add instances to cell
-					cell->addInstances(cell_instances);
+				// find interact Instances for the Cell
+				ExactModelCoordinate emc = m_layer->getCellGrid()->toMapCoordinates(FIFE::intPt2doublePt(mc));
+				for (uint32_t i = 0; i < interacts.size(); ++i) {
+					ModelCoordinate inter_mc = interacts[i]->getCellGrid()->toLayerCoordinates(emc);
+					InstanceBucketMap::const_iterator bucket = context.interactBuckets[i].find(bucketKey(inter_mc));
+					if (bucket == context.interactBuckets[i].end()) {
+						continue;
+					}
+					std::vector<Instance*>::const_iterator it = bucket->second.begin();
+					for (; it != bucket->second.end(); ++it) {
+						found.push_back(std::make_pair(index, *it));
+					}
 				}
 			}
 		}
-		// fill neighbors into cells
-		std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
-		for (; it != m_cells.end(); ++it) {
-			std::vector<Cell*>::iterator cit = (*it).begin();
-			for (; cit != (*it).end(); ++cit) {
+		context.created[band] = created;
+	}
+
+	void CellCache::connectCellBand(CellBuildContext& context, uint32_t band) {
+		const uint32_t firstRow = band * context.bandRows;
+		const uint32_t lastRow = std::min(firstRow + context.bandRows, m_height);
+		for (uint32_t y = firstRow; y < lastRow; ++y) {
+			for (uint32_t x = 0; x < m_width; ++x) {
+				uint32_t index = x + y * m_width;
+				Cell* cell = m_cells[index];
+				int32_t cellZ = cell->getLayerCoordinates().z;
 				uint8_t accessible = 0;
-				bool selfblocker = (*cit)->getCellType() == CTYPE_STATIC_BLOCKER || (*cit)->getCellType() == CTYPE_CELL_BLOCKER;
-				std::vector<ModelCoordinate> coordinates;
-				m_layer->getCellGrid()->getAccessibleCoordinates((*cit)->getLayerCoordinates(), coordinates);
-				for (std::vector<ModelCoordinate>::iterator mi = coordinates.begin(); mi != coordinates.end(); ++mi) {
-					Cell* c = getCell(*mi);
-					if (*cit == c || !c) {
+				bool selfblocker = cell->getCellType() == CTYPE_STATIC_BLOCKER || cell->getCellType() == CTYPE_CELL_BLOCKER;
+				int32_t parity = ((m_size.x + x) & 1) | (((m_size.y + y) & 1) << 1);
+				const std::vector<ModelCoordinate>& offsets = context.offsets[parity];
+				std::vector<ModelCoordinate>::const_iterator it = offsets.begin();
+				for (; it != offsets.end(); ++it) {
+					int32_t nx = static_cast<int32_t>(x) + it->x;
+					int32_t ny = static_cast<int32_t>(y) + it->y;
+					if (nx < 0 || nx >= static_cast<int32_t>(m_width) || ny < 0 || ny >= static_cast<int32_t>(m_height)) {
 						continue;
 					}
+					Cell* c = m_cells[static_cast<uint32_t>(nx) + static_cast<uint32_t>(ny) * m_width];
+					if (!c) {
+						continue;
+					}
+					if (context.zCheck) {
+						if (ABS(c->getLayerCoordinates().z - cellZ) > m_neighborZ) {
+							continue;
+						}
+					}
 					if (!selfblocker && c->getCellType() != CTYPE_STATIC_BLOCKER &&
 						c->getCellType() != CTYPE_CELL_BLOCKER) {
 						++accessible;
 					}
-					(*cit)->addNeighbor(c);
+					cell->addNeighbor(c);
 				}
-				// add cell to narrow cells and add listener for zone change
-				if (m_searchNarrow && !selfblocker && accessible < 3) {
-					addNarrowCell(*cit);
-				}
-			}
-		}
-		// create Zones
-		it = m_cells.begin();
-		for (; it != m_cells.end(); ++it) {
-			std::vector<Cell*>::iterator cit = (*it).begin();
-			for (; cit != (*it).end(); ++cit) {
-				Cell* cell = *cit;
-				if (cell->getZone() || cell->isInserted()) {
-					continue;
-				}
-				if (cell->getCellType() == CTYPE_STATIC_BLOCKER || cell->getCellType() == CTYPE_CELL_BLOCKER) {
-					continue;
-				}
-				Zone* zone = createZone();
-				cell->setInserted(true);
-				std::stack<Cell*> cellstack;
-				cellstack.push(cell);
-				while(!cellstack.empty()) {
-					Cell* c = cellstack.top();
-					cellstack.pop();
-					zone->addCell(c);
-
-					const std::vector<Cell*>& neighbors = c->getNeighbors();
-					for (std::vector<Cell*>::const_iterator nit = neighbors.begin(); nit != neighbors.end(); ++nit) {
-						Cell* nc = *nit;
-						if (!nc->isInserted() &&
-							nc->getCellType() != CTYPE_STATIC_BLOCKER && nc->getCellType() != CTYPE_CELL_BLOCKER) {
-							nc->setInserted(true);
-							cellstack.push(nc);
-						}
-					}
+				if (context.searchNarrow && !selfblocker && accessible < 3) {
+					context.narrow[index] = 1;
 				}
 			}
 		}
 	}
 
 	void CellCache::forceUpdate() {
-		std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
+		std::vector<Cell*>::iterator it = m_cells.begin();
 		for (; it != m_cells.end(); ++it) {
-			std::vector<Cell*>::iterator cit = (*it).begin();
-			for (; cit != (*it).end(); ++cit) {
-				(*cit)->updateCellInfo();
-			}
+			(*it)->updateCellInfo();
 		}
 	}
 
 	void CellCache::addCell(Cell* cell) {
-		ModelCoordinate mc = cell->getLayerCoordinates();
-		m_cells[(mc.x-m_size.x)][(mc.y-m_size.y)] = cell;
+		m_cells[convertCoordToInt(cell->getLayerCoordinates())] = cell;
 	}
 
 	Cell* CellCache::createCell(const ModelCoordinate& mc) {
 		Cell* cell = getCell(mc);
 		if (!cell) {
-			cell = new Cell(convertCoordToInt(mc), mc, m_layer);
-			m_cells[(mc.x-m_size.x)][(mc.y-m_size.y)] = cell;
+			cell = constructCell(static_cast<uint32_t>(convertCoordToInt(mc)), mc);
 		}
 		return cell;
 	}
@@ -709,10 +918,10 @@ namespace FIFE {
 			return NULL;
 		}
 
-		return m_cells[static_cast<uint32_t>(x)][static_cast<uint32_t>(y)];
+		return m_cells[static_cast<uint32_t>(x) + static_cast<uint32_t>(y) * m_width];
 	}
 
-	const std::vector<std::vector<Cell*> >& CellCache::getCells() {
+	const std::vector<Cell*>& CellCache::getCells() {
 		return m_cells;
 	}
 
@@ -1152,6 +1361,7 @@ namespace FIFE {
 
 	void CellCache::setDefaultCostMultiplier(double multi) {
 		m_defaultCostMulti = multi;
+		markLayoutChanged();
 	}
 
 	double CellCache::getDefaultCostMultiplier() {
@@ -1160,6 +1370,7 @@ namespace FIFE {
 
 	void CellCache::setDefaultSpeedMultiplier(double multi) {
 		m_defaultSpeedMulti = multi;
+		markLayoutChanged();
 	}
 
 	double CellCache::getDefaultSpeedMultiplier() {
@@ -1181,6 +1392,7 @@ namespace FIFE {
 			double& old = insertiter.first->second;
 			old = multi;
 		}
+		markCellChanged(cell);
 	}
 
 	double CellCache::getCostMultiplier(Cell* cell) {
@@ -1193,7 +1405,9 @@ namespace FIFE {
 	}
 
 	void CellCache::resetCostMultiplier(Cell* cell) {
-		m_costMultipliers.erase(cell);
+		if (m_costMultipliers.erase(cell) != 0) {
+			markCellChanged(cell);
+		}
 	}
 
 	bool CellCache::isDefaultSpeed(Cell* cell) {
@@ -1211,6 +1425,7 @@ namespace FIFE {
 			double& old = insertiter.first->second;
 			old = multi;
 		}
+		markCellChanged(cell);
 	}
 
 	double CellCache::getSpeedMultiplier(Cell* cell) {
@@ -1223,7 +1438,9 @@ namespace FIFE {
 	}
 
 	void CellCache::resetSpeedMultiplier(Cell* cell) {
-		m_speedMultipliers.erase(cell);
+		if (m_speedMultipliers.erase(cell) != 0) {
+			markCellChanged(cell);
+		}
 	}
 
 	void CellCache::addTransition(Cell* cell) {
@@ -1318,8 +1535,8 @@ namespace FIFE {
 
 		Zone* newZone = createZone();
 		std::stack<Cell*> cellstack;
-		const std::vector<Cell*>& neighbors = cell->getNeighbors();
-		for (std::vector<Cell*>::const_iterator nit = neighbors.begin(); nit != neighbors.end(); ++nit) {
+		const CellNeighbors& neighbors = cell->getNeighbors();
+		for (CellNeighbors::const_iterator nit = neighbors.begin(); nit != neighbors.end(); ++nit) {
 			Cell* nc = *nit;
 			if (nc->isInserted() && !nc->isZoneProtected() &&
 				nc->getCellType() != CTYPE_STATIC_BLOCKER && nc->getCellType() != CTYPE_CELL_BLOCKER) {
@@ -1338,8 +1555,8 @@ namespace FIFE {
 			if (c->isZoneProtected()) {
 				continue;
 			}
-			const std::vector<Cell*>& neigh = c->getNeighbors();
-			for (std::vector<Cell*>::const_iterator nit = neigh.begin(); nit != neigh.end(); ++nit) {
+			const CellNeighbors& neigh = c->getNeighbors();
+			for (CellNeighbors::const_iterator nit = neigh.begin(); nit != neigh.end(); ++nit) {
 				Cell* nc = *nit;
 				if (nc->getZone() == currentZone && nc->isInserted() &&
 					nc->getCellType() != CTYPE_STATIC_BLOCKER && nc->getCellType() != CTYPE_CELL_BLOCKER) {
@@ -1528,6 +1745,36 @@ namespace FIFE {
 		return m_staticSize;
 	}
 
+	uint32_t CellCache::getRevision() const {
+		return m_revision;
+	}
+
+	uint32_t CellCache::getLayoutRevision() const {
+		return m_layoutRevision;
+	}
+
+	uint32_t CellCache::getBandRevision(uint32_t band) const {
+		if (band >= m_bandRevisions.size()) {
+			return m_layoutRevision;
+		}
+		return m_bandRevisions[band];
+	}
+
+	void CellCache::markCellChanged(Cell* cell) {
+		int32_t id = cell->getCellId();
+		if (id < 0 || static_cast<uint32_t>(id) >= m_cells.size() || m_cells[id] != cell) {
+			return;
+		}
+		++m_revision;
+		m_bandRevisions[static_cast<uint32_t>(id) / m_width / REVISION_BAND_ROWS] = m_revision;
+	}
+
+	void CellCache::markLayoutChanged() {
+		++m_revision;
+		m_layoutRevision = m_revision;
+		m_bandRevisions.assign((m_height + REVISION_BAND_ROWS - 1) / REVISION_BAND_ROWS, m_revision);
+	}
+
 	void CellCache::setBlockingUpdate(bool update) {
 		m_blockingUpdate = update;
 	}
@@ -45,6 +45,9 @@
 
 namespace FIFE {
 
+	class CellArena;
+	class WorkerPool;
+
 	/** A Zone is an abstract depiction of a CellCache or of a part of it.
 	 */
 	class Zone {
@@ -135,8 +138,11 @@ namespace FIFE {
 			void resize(const Rect& rec);
 
 			/** Creates cells for this CellCache based on the size of the assigned layer.
+			 * The missing cells are constructed in one contiguous block. If a pool is given,
+			 * construction and neighbor search are split across its threads by row bands.
+			 * @param pool A pointer to the WorkerPool or NULL to create the cells serially.
 			 */
-			void createCells();
+			void createCells(WorkerPool* pool = NULL);
 
 			/** Updates all cells.
 			 */
@@ -160,9 +166,10 @@ namespace FIFE {
 			Cell* getCell(const ModelCoordinate& mc);
 
 			/** Returns all cells of this CellCache.
-			 * @return A const reference to a two dimensional vector which contain all cells.
+			 * The cells are stored row by row, the index of a cell is its cell id.
+			 * @return A const reference to a vector which contain all cells.
 			 */
-			const std::vector<std::vector<Cell*> >& getCells();
+			const std::vector<Cell*>& getCells();
 
 			/** Removes cell from CellCache.
 			 * Removes cell from cost table, special cost and speed,
@@ -603,6 +610,27 @@ namespace FIFE {
 			 */
 			bool isStaticSize();
 
+			/** Returns the revision of the latest change of cell types or multipliers.
+			 */
+			uint32_t getRevision() const;
+
+			/** Returns the revision of the latest change that affects all cells,
+			 * e.g. a resize or a new default multiplier.
+			 */
+			uint32_t getLayoutRevision() const;
+
+			/** Returns the revision of the latest change inside the given band.
+			 * A band holds REVISION_BAND_ROWS rows of cells.
+			 */
+			uint32_t getBandRevision(uint32_t band) const;
+
+			/** Marks the cell as changed, used by read snapshots to copy only changed bands.
+			 */
+			void markCellChanged(Cell* cell);
+
+			//! number of cell rows per revision band
+			static const uint32_t REVISION_BAND_ROWS = 16;
+
 			void setBlockingUpdate(bool update);
 			void setSizeUpdate(bool update);
 			void update();
@@ -611,10 +639,49 @@ namespace FIFE {
 			typedef StringCellMultimap::iterator StringCellIterator;
 			typedef std::pair<StringCellIterator, StringCellIterator> StringCellPair;
 
+			struct CellBuildContext;
+
 			/** Returns the current size.
 			 * @return A rect that contains the min, max coordinates.
 			 */
 			Rect calculateCurrentSize();
+
+			/** Marks all cells as changed, called if the size or the defaults change.
+			 */
+			void markLayoutChanged();
+
+			/** Constructs a cell in the arena slot that belongs to the index.
+			 * The arena is created on first use and covers the current size.
+			 * @param index The cell index, x + y * width.
+			 * @param mc A const reference to the layer coordinates of the cell.
+			 * @return A pointer to the new cell.
+			 */
+			Cell* constructCell(uint32_t index, const ModelCoordinate& mc);
+
+			/** Destroys the cell and frees its arena if no other cell lives in it.
+			 * Cells which were added with addCell() are deleted.
+			 * @param cell A pointer to the cell.
+			 */
+			void destroyCell(Cell* cell);
+
+			/** Fills the relative neighbor coordinates for each parity of x and y.
+			 * @param context The build context that receives the offsets.
+			 */
+			void fillNeighborOffsets(CellBuildContext& context);
+
+			/** Constructs the missing cells of a row band and collects the interact instances.
+			 * Runs in parallel for different bands.
+			 * @param context The build context.
+			 * @param band The index of the row band.
+			 */
+			void createCellBand(CellBuildContext& context, uint32_t band);
+
+			/** Fills the neighbors of all cells in a row band.
+			 * Runs in parallel for different bands.
+			 * @param context The build context.
+			 * @param band The index of the row band.
+			 */
+			void connectCellBand(CellBuildContext& context, uint32_t band);
 			
 			//! walkable layer
 			Layer* m_layer;
@@ -628,8 +695,14 @@ namespace FIFE {
 			//! change listener
 			LayerChangeListener* m_cellListener;
 
-			// cells on this cache
-			std::vector<std::vector<Cell*> > m_cells;
+			//! cells on this cache, row by row
+			std::vector<Cell*> m_cells;
+
+			//! memory blocks that hold the cells
+			std::vector<CellArena*> m_arenas;
+
+			//! arena of the current size, new cells are constructed in it
+			CellArena* m_arena;
 
 			//! Rect holds the min and max size
 			//! x = min.x, w = max.x, y = min.y, h = max.y
@@ -647,6 +720,15 @@ namespace FIFE {
 			//! indicates blocking update
 			bool m_blockingUpdate;
 
+			//! revision of the latest change
+			uint32_t m_revision;
+
+			//! revision of the latest change of all cells
+			uint32_t m_layoutRevision;
+
+			//! revision of the latest change per band of rows
+			std::vector<uint32_t> m_bandRevisions;
+
 			//! indicates size update
 			bool m_sizeUpdate;
 
@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <functional>
 #include <iostream>
 
 // 3rd party library includes
@@ -33,6 +34,7 @@
 #include "util/log/logger.h"
 #include "util/base/exception.h"
 #include "util/math/fife_math.h"
+#include "util/structures/objectpool.h"
 #include "util/time/timemanager.h"
 #include "model/metamodel/grids/cellgrid.h"
 #include "model/metamodel/ipather.h"
@@ -72,13 +74,29 @@ namespace FIFE {
 				}
 				delete m_route;
 			}
-			delete m_target;
+		}
+
+		// ActionInfos are created for every action, so they come from a pool
+		static void* operator new(std::size_t size) {
+			return ObjectPool<ActionInfo>::instance().allocate(size);
+		}
+
+		static void operator delete(void* ptr, std::size_t size) {
+			ObjectPool<ActionInfo>::instance().deallocate(ptr, size);
+		}
+
+		// sets the target location, stored inside the ActionInfo
+		void setTarget(const Location& target) {
+			m_targetLocation = target;
+			m_target = &m_targetLocation;
 		}
 
 		// Current action, owned by object
 		Action* m_action;
-		// target location for ongoing movement
+		// target location for ongoing movement, points to m_targetLocation or is NULL
 		Location* m_target;
+		// storage for the target location
+		Location m_targetLocation;
 		// current movement speed
 		double m_speed;
 		// should action be repeated? used only for non-moving actions, moving ones repeat until movement is finished
@@ -177,20 +195,13 @@ namespace FIFE {
 			m_blocking = source.m_blocking;
 		}
 
-		if (source.m_changeInfo != ICHANGE_NO_CHANGES) {
-			std::vector<InstanceChangeListener*>::iterator i = m_changeListeners.begin();
-			while (i != m_changeListeners.end()) {
-				if (NULL != *i)
-				{
-					(*i)->onInstanceChanged(&source, source.m_changeInfo);
-				}
-				++i;
+		if (source.m_changeInfo != ICHANGE_NO_CHANGES && !m_changeListeners.empty()) {
+			Map* map = source.getDeferringMap();
+			if (map) {
+				map->deferCall(&source, std::bind(&Instance::notifyInstanceChanged, &source));
+			} else {
+				source.notifyInstanceChanged();
 			}
-			// Really remove "removed" listeners.
-			m_changeListeners.erase(
-				std::remove(m_changeListeners.begin(),m_changeListeners.end(),
-					(InstanceChangeListener*)NULL),
-				m_changeListeners.end());
 		}
 	}
 
@@ -261,6 +272,12 @@ namespace FIFE {
 			}
 		}
 
+		// drop listener calls that are still queued for this instance
+		Map* map = m_location.getMap();
+		if (map) {
+			map->removeDeferredCalls(this);
+		}
+
 		delete m_activity;
 		delete m_visual;
 		if (m_ownObject) {
@@ -465,7 +482,7 @@ namespace FIFE {
 			}
 		}
 		initializeAction(actionName);
-		m_activity->m_actionInfo->m_target = new Location(target);
+		m_activity->m_actionInfo->setTarget(target);
 		m_activity->m_actionInfo->m_speed = speed;
 		FL_DBG(_log, LMsg("starting action ") <<  actionName << " from" << m_location << " to " << target << " with speed " << speed);
 
@@ -493,7 +510,7 @@ namespace FIFE {
 
 	void Instance::follow(const std::string& actionName, Instance* leader, const double speed) {
 		initializeAction(actionName);
-		m_activity->m_actionInfo->m_target = new Location(leader->getLocationRef());
+		m_activity->m_actionInfo->setTarget(leader->getLocationRef());
 		m_activity->m_actionInfo->m_speed = speed;
 		m_activity->m_actionInfo->m_leader = leader;
 		leader->addDeleteListener(this);
@@ -502,7 +519,7 @@ namespace FIFE {
 
 	void Instance::follow(const std::string& actionName, Route* route, const double speed) {
 		initializeAction(actionName);
-		m_activity->m_actionInfo->m_target = new Location(route->getEndNode());
+		m_activity->m_actionInfo->setTarget(route->getEndNode());
 		m_activity->m_actionInfo->m_speed = speed;
 		m_activity->m_actionInfo->m_route = route;
 		m_activity->m_actionInfo->m_delete_route = false;
@@ -799,9 +816,14 @@ namespace FIFE {
 		// it is the same action as the finalized action
 		m_activity->m_action = NULL;
 
+		Map* map = getDeferringMap();
 		// stop audio
 		if (action->getAudio() && m_activity->m_soundSource) {
-			m_activity->m_soundSource->setActionAudio(NULL);
+			if (map) {
+				map->deferCall(this, std::bind(&Instance::stopFinishedActionAudio, this));
+			} else {
+				m_activity->m_soundSource->setActionAudio(NULL);
+			}
 		}
 
 		if (isMultiObject()) {
@@ -810,6 +832,45 @@ namespace FIFE {
 				(*multi_it)->finalizeAction();
 			}
 		}
+		if (map && !m_activity->m_actionListeners.empty()) {
+			map->deferCall(this, std::bind(&Instance::notifyActionFinished, this, action));
+		} else {
+			notifyActionFinished(action);
+		}
+	}
+
+	Map* Instance::getDeferringMap() const {
+		Map* map = m_location.getMap();
+		if (map && map->isDeferringCalls()) {
+			return map;
+		}
+		return NULL;
+	}
+
+	void Instance::notifyInstanceChanged() {
+		if (!m_activity) {
+			return;
+		}
+		std::vector<InstanceChangeListener*>& listeners = m_activity->m_changeListeners;
+		std::vector<InstanceChangeListener*>::iterator i = listeners.begin();
+		while (i != listeners.end()) {
+			if (NULL != *i)
+			{
+				(*i)->onInstanceChanged(this, m_changeInfo);
+			}
+			++i;
+		}
+		// Really remove "removed" listeners.
+		listeners.erase(
+			std::remove(listeners.begin(), listeners.end(),
+				(InstanceChangeListener*)NULL),
+			listeners.end());
+	}
+
+	void Instance::notifyActionFinished(Action* action) {
+		if (!m_activity) {
+			return;
+		}
 		std::vector<InstanceActionListener*>::iterator i = m_activity->m_actionListeners.begin();
 		while (i != m_activity->m_actionListeners.end()) {
 			if(*i)
@@ -823,6 +884,12 @@ namespace FIFE {
 			m_activity->m_actionListeners.end());
 	}
 
+	void Instance::stopFinishedActionAudio() {
+		if (m_activity && m_activity->m_soundSource && !m_activity->m_actionInfo) {
+			m_activity->m_soundSource->setActionAudio(NULL);
+		}
+	}
+
 	void Instance::cancelAction() {
 		FL_DBG(_log, "cancel action");
 		assert(m_activity);
@@ -879,6 +946,20 @@ namespace FIFE {
 		return 0;
 	}
 
+	bool Instance::isActionRepeating() const {
+		if (m_activity && m_activity->m_actionInfo) {
+			return m_activity->m_actionInfo->m_repeating;
+		}
+		return false;
+	}
+
+	Instance* Instance::getFollowedInstance() const {
+		if (m_activity && m_activity->m_actionInfo) {
+			return m_activity->m_actionInfo->m_leader;
+		}
+		return NULL;
+	}
+
 	void Instance::setFacingLocation(const Location& loc) {
 		setRotation(getAngleBetween(m_location, loc));
 	}
@@ -1209,6 +1290,10 @@ namespace FIFE {
 		visual->convertToOverlays(color);
 	}
 
+	ObjectPoolStats Instance::getActionPoolStats() {
+		return ObjectPool<ActionInfo>::instance().getStats();
+	}
+
 	void Instance::createOwnObject() {
 		if (!m_ownObject) {
 			m_ownObject = true;
@@ -32,6 +32,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/fifeclass.h"
+#include "util/structures/objectpool.h"
 
 #include "model/metamodel/object.h"
 #include "model/metamodel/ivisual.h"
@@ -234,6 +235,14 @@ namespace FIFE {
 		 */
 		double getMovementSpeed() const;
 
+		/** Returns true if the current action repeats, see actRepeat.
+		 */
+		bool isActionRepeating() const;
+
+		/** Returns the instance that is followed by the current action, or NULL.
+		 */
+		Instance* getFollowedInstance() const;
+
 		/** Gets the time in milliseconds how long action has been active
 		 *  In case there is no current action, returns -1
 		 * @return action runtime
@@ -508,6 +517,10 @@ namespace FIFE {
 		/** Indicates if there exists a color overlay for given action or animation overlay.
 		 */
 		bool isColorOverlay(const std::string& actionName);
+
+		/** Returns the counters of the pool that holds the per action runtime data.
+		 */
+		static ObjectPoolStats getActionPoolStats();
 		
 	private:
 		std::string m_id;
@@ -602,6 +615,14 @@ namespace FIFE {
 		Instance& operator=(const Instance&);
 		//! Finalize current action
 		void finalizeAction();
+		//! Returns the map if listener calls have to be deferred, otherwise NULL. @see Map::updateLayers
+		Map* getDeferringMap() const;
+		//! Calls the change listeners with the current change info
+		void notifyInstanceChanged();
+		//! Calls the action listeners for the finished action
+		void notifyActionFinished(Action* action);
+		//! Stops the audio of the finished action, unless a new action is running
+		void stopFinishedActionAudio();
 		//! Cancel current action
 		void cancelAction();
 		//! Initialize action for use
@@ -105,6 +105,8 @@ namespace FIFE {
 		void removeDeleteListener(InstanceDeleteListener* listener);
 		Action* getCurrentAction() const;
 		double getMovementSpeed() const;
+		bool isActionRepeating() const;
+		Instance* getFollowedInstance() const;
 		void setFacingLocation(const Location& loc);
 		Location getFacingLocation();
 		uint32_t getActionRuntime();
@@ -165,6 +167,8 @@ namespace FIFE {
 		void convertToOverlays(const std::string& actionName, bool color);
 		bool isAnimationOverlay(const std::string& actionName);
 		bool isColorOverlay(const std::string& actionName);
+
+		static ObjectPoolStats getActionPoolStats();
 	};
 }
 
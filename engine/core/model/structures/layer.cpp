@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <functional>
 
 // 3rd party library includes
 
@@ -54,12 +55,14 @@ namespace FIFE {
 		m_grid(grid),
 		m_pathingStrategy(CELL_EDGES_ONLY),
 		m_sortingStrategy(SORTING_CAMERA),
+		m_screenIndexStrategy(SCREEN_INDEX_QUADTREE),
 		m_walkable(false),
 		m_interact(false),
 		m_walkableId(""),
 		m_cellCache(NULL),
 		m_changeListeners(),
 		m_changedInstances(),
+		m_journal(),
 		m_changed(false),
 		m_static(false) {
 	}
@@ -127,6 +130,7 @@ namespace FIFE {
 			(*i)->onInstanceCreate(this, instance);
 			++i;
 		}
+		m_journal.recordCreate(instance);
 		m_changed = true;
 		return instance;
 	}
@@ -152,6 +156,7 @@ namespace FIFE {
 			(*i)->onInstanceCreate(this, instance);
 			++i;
 		}
+		m_journal.recordCreate(instance);
 		m_changed = true;
 		return true;
 	}
@@ -162,7 +167,9 @@ namespace FIFE {
 		// to avoid this we have to update the instance first and send
 		// the result to the LayerChangeListeners.
 		if (instance->isActive()) {
-			if (instance->update() != ICHANGE_NO_CHANGES) {
+			InstanceChangeInfo changes = instance->update();
+			if (changes != ICHANGE_NO_CHANGES) {
+				m_journal.recordChange(instance, changes);
 				std::vector<Instance*> updateInstances;
 				updateInstances.push_back(instance);
 				std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
@@ -178,7 +185,11 @@ namespace FIFE {
 			(*i)->onInstanceDelete(this, instance);
 			++i;
 		}
+		m_journal.recordDelete(instance);
 		setInstanceActivityStatus(instance, false);
+		// a deferred change notification must not see the instance anymore
+		m_changedInstances.erase(std::remove(m_changedInstances.begin(),
+			m_changedInstances.end(), instance), m_changedInstances.end());
 		std::vector<Instance*>::iterator it = m_instances.begin();
 		for(; it != m_instances.end(); ++it) {
 			if(*it == instance) {
@@ -196,7 +207,9 @@ namespace FIFE {
 		// to avoid this we have to update the instance first and send
 		// the result to the LayerChangeListeners.
 		if (instance->isActive()) {
-			if (instance->update() != ICHANGE_NO_CHANGES) {
+			InstanceChangeInfo changes = instance->update();
+			if (changes != ICHANGE_NO_CHANGES) {
+				m_journal.recordChange(instance, changes);
 				std::vector<Instance*> updateInstances;
 				updateInstances.push_back(instance);
 				std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
@@ -212,7 +225,11 @@ namespace FIFE {
 			(*i)->onInstanceDelete(this, instance);
 			++i;
 		}
+		m_journal.recordDelete(instance);
 		setInstanceActivityStatus(instance, false);
+		// a deferred change notification must not see the instance anymore
+		m_changedInstances.erase(std::remove(m_changedInstances.begin(),
+			m_changedInstances.end(), instance), m_changedInstances.end());
 		std::vector<Instance*>::iterator it = m_instances.begin();
 		for(; it != m_instances.end(); ++it) {
 			if(*it == instance) {
@@ -230,6 +247,43 @@ namespace FIFE {
 		return m_instances;
 	}
 
+	void Layer::deleteInstances() {
+		// same as deleteInstance, but without searching every instance
+		std::vector<Instance*> instances;
+		instances.swap(m_instances);
+		m_changedInstances.clear();
+		// all instances go away, so the journal forgets them at once instead of one by one
+		m_journal.forgetInstances();
+		std::vector<Instance*>::iterator it = instances.begin();
+		for (; it != instances.end(); ++it) {
+			Instance* instance = *it;
+			if (instance->isActive()) {
+				InstanceChangeInfo changes = instance->update();
+				if (changes != ICHANGE_NO_CHANGES) {
+					m_journal.recordChange(instance, changes);
+					std::vector<Instance*> updateInstances;
+					updateInstances.push_back(instance);
+					std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
+					while (i != m_changeListeners.end()) {
+						(*i)->onLayerChanged(this, updateInstances);
+						++i;
+					}
+				}
+			}
+
+			std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
+			while (i != m_changeListeners.end()) {
+				(*i)->onInstanceDelete(this, instance);
+				++i;
+			}
+			m_journal.recordDelete(instance);
+			setInstanceActivityStatus(instance, false);
+			m_instanceTree->removeInstance(instance);
+			delete instance;
+		}
+		m_changed = true;
+	}
+
 	void Layer::setInstanceActivityStatus(Instance* instance, bool active) {
 		if(active) {
 			m_activeInstances.insert(instance);
@@ -484,8 +538,8 @@ namespace FIFE {
 		if (m_cellCache) {
 			Cell* cell = m_cellCache->getCell(cellCoordinate);
 			if (cell) {
-				const std::set<Instance*>& blocker = cell->getInstances();
-				for (std::set<Instance*>::const_iterator it = blocker.begin(); it != blocker.end(); ++it) {
+				const CellInstances& blocker = cell->getInstances();
+				for (CellInstances::const_iterator it = blocker.begin(); it != blocker.end(); ++it) {
 					if ((*it)->isBlocking()) {
 						blockingInstances.push_back(*it);
 					}
@@ -520,6 +574,14 @@ namespace FIFE {
 		return m_sortingStrategy;
 	}
 
+	void Layer::setScreenIndexStrategy(ScreenIndexStrategy strategy) {
+		m_screenIndexStrategy = strategy;
+	}
+
+	ScreenIndexStrategy Layer::getScreenIndexStrategy() const {
+		return m_screenIndexStrategy;
+	}
+
 	void Layer::setWalkable(bool walkable) {
 		m_walkable = walkable;
 	}
@@ -596,7 +658,9 @@ namespace FIFE {
 		std::vector<Instance*> inactiveInstances;
 		std::set<Instance*>::iterator it = m_activeInstances.begin();
 		for(; it != m_activeInstances.end(); ++it) {
-			if ((*it)->update() != ICHANGE_NO_CHANGES) {
+			InstanceChangeInfo changes = (*it)->update();
+			if (changes != ICHANGE_NO_CHANGES) {
+				m_journal.recordChange(*it, changes);
 				m_changedInstances.push_back(*it);
 				m_changed = true;
 			} else if (!(*it)->isActive()) {
@@ -604,10 +668,10 @@ namespace FIFE {
 			}
 		}
 		if (!m_changedInstances.empty()) {
-			std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
-			while (i != m_changeListeners.end()) {
-				(*i)->onLayerChanged(this, m_changedInstances);
-				++i;
+			if (m_map->isDeferringCalls()) {
+				m_map->deferCall(NULL, std::bind(&Layer::notifyChangedInstances, this));
+			} else {
+				notifyChangedInstances();
 			}
 			//std::cout << "Layer named " << Id() << " changed = 1\n";
 		}
@@ -625,6 +689,14 @@ namespace FIFE {
 		return retval;
 	}
 
+	void Layer::notifyChangedInstances() {
+		std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
+		while (i != m_changeListeners.end()) {
+			(*i)->onLayerChanged(this, m_changedInstances);
+			++i;
+		}
+	}
+
 	void Layer::addChangeListener(LayerChangeListener* listener) {
 		m_changeListeners.push_back(listener);
 	}
@@ -648,6 +720,10 @@ namespace FIFE {
 		return m_changedInstances;
 	}
 
+	LayerJournal* Layer::getJournal() {
+		return &m_journal;
+	}
+
 	void Layer::setStatic(bool stati) {
 		m_static = stati;
 	}
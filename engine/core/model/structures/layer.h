@@ -40,6 +40,7 @@
 #include "model/metamodel/object.h"
 
 #include "instance.h"
+#include "layerjournal.h"
 
 namespace FIFE {
 
@@ -66,6 +67,16 @@ namespace FIFE {
 		SORTING_CAMERA_AND_LOCATION
 	};
 
+	/** Defines how the layer cache of a camera finds the instances in the viewport
+	 *
+	 * SCREEN_INDEX_QUADTREE keeps the instances in a quadtree
+	 * SCREEN_INDEX_GRID keeps the instances in a uniform grid of screen buckets, faster for many moving instances
+	 */
+	enum ScreenIndexStrategy {
+		SCREEN_INDEX_QUADTREE,
+		SCREEN_INDEX_GRID
+	};
+
 	/** Listener interface for changes happening on a layer
 	 */
 	class LayerChangeListener {
@@ -160,6 +171,10 @@ namespace FIFE {
 			 */
 			void deleteInstance(Instance* instance);
 
+			/** Remove and delete all instances of the layer. Faster than deleting them one by one.
+			 */
+			void deleteInstances();
+
 			/** Get the list of instances on this layer
 			 */
 			const std::vector<Instance*>& getInstances() const;
@@ -284,6 +299,16 @@ namespace FIFE {
 			 */
 			SortingStrategy getSortingStrategy() const;
 
+			/** Sets the screen index strategy for the layer
+			 * @see ScreenIndexStrategy
+			 */
+			void setScreenIndexStrategy(ScreenIndexStrategy strategy);
+
+			/** Gets the screen index strategy for the layer
+			 * @see ScreenIndexStrategy
+			 */
+			ScreenIndexStrategy getScreenIndexStrategy() const;
+
 			/** Sets walkable for the layer. Only a walkable layer, can create a CellCache and
 			 *  only on a walkable, instances can move. Also interact layer can only be added to walkables.
 			 * @param walkable A boolean that mark a layer as walkable.
@@ -359,6 +384,12 @@ namespace FIFE {
 			 */
 			std::vector<Instance*>& getChangedInstances();
 
+			/** Returns the change journal of this layer.
+			 * Consumers can pull the instance changes since their last read instead of being a listener.
+			 * The journal is disabled until a capacity is set.
+			 */
+			LayerJournal* getJournal();
+
 			/** Sets the activity status for given instance on this layer.
 			 * @param instance A pointer to the Instance whose activity is to be changed.
 			 * @param active A boolean, true if the instance should be set active otherwise false.
@@ -378,6 +409,10 @@ namespace FIFE {
 			bool isStatic();
 
 		protected:
+			/** Informs the change listeners about the changed instances of the latest update.
+			 */
+			void notifyChangedInstances();
+
 			//! string identifier
 			std::string m_id;
 			//! pointer to map
@@ -398,6 +433,8 @@ namespace FIFE {
 			PathingStrategy m_pathingStrategy;
 			//! sorting strategy for rendering
 			SortingStrategy m_sortingStrategy;
+			//! screen index strategy for rendering
+			ScreenIndexStrategy m_screenIndexStrategy;
 			//! is walkable true/false
 			bool m_walkable;
 			//! is interact true/false
@@ -412,6 +449,8 @@ namespace FIFE {
 			std::vector<LayerChangeListener*> m_changeListeners;
 			//! holds changed instances after each update
 			std::vector<Instance*> m_changedInstances;
+			//! journal of created, deleted and changed instances
+			LayerJournal m_journal;
 			//! true if layer (or it's instance) information was changed during previous update round
 			bool m_changed;
 			//! true if layer is static
@@ -28,6 +28,7 @@
 %include "model/metamodel/grids/cellgrids.i"
 %include "util/structures/utilstructures.i"
 %include "util/base/utilbase.i"
+%include "model/structures/layerjournal.i"
 
 namespace FIFE {
 
@@ -48,6 +49,11 @@ namespace FIFE {
 		SORTING_CAMERA_AND_LOCATION
 	};
 
+	enum ScreenIndexStrategy {
+		SCREEN_INDEX_QUADTREE,
+		SCREEN_INDEX_GRID
+	};
+
 	%feature("director") LayerChangeListener;
 	class LayerChangeListener {
 	public:
@@ -75,6 +81,7 @@ namespace FIFE {
 			Instance* createInstance(Object* object, const ExactModelCoordinate& p, const std::string& id="");
 			bool addInstance(Instance* instance, const ExactModelCoordinate& p);
 			void deleteInstance(Instance* object);
+			void deleteInstances();
 			void removeInstance(Instance* object);
 
 			const std::vector<Instance*>& getInstances() const;
@@ -101,6 +108,9 @@ namespace FIFE {
 			void setSortingStrategy(SortingStrategy strategy);
 			SortingStrategy getSortingStrategy() const;
 
+			void setScreenIndexStrategy(ScreenIndexStrategy strategy);
+			ScreenIndexStrategy getScreenIndexStrategy() const;
+
 			void setWalkable(bool walkable);
 			bool isWalkable();
 			
@@ -120,6 +130,7 @@ namespace FIFE {
 			void removeChangeListener(LayerChangeListener* listener);
 			bool isChanged();
 			std::vector<Instance*>& getChangedInstances();
+			LayerJournal* getJournal();
 
 			void setStatic(bool stati);
 			bool isStatic();
@@ -0,0 +1,186 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "layerjournal.h"
+
+namespace FIFE {
+
+	LayerJournal::LayerJournal(uint32_t capacity):
+		m_entries(),
+		m_capacity(capacity),
+		m_sequence(0),
+		m_first(0),
+		m_references() {
+		m_entries.reserve(m_capacity);
+	}
+
+	LayerJournal::~LayerJournal() {
+	}
+
+	void LayerJournal::setCapacity(uint32_t capacity) {
+		m_entries.clear();
+		if (capacity != m_capacity) {
+			std::vector<LayerJournalEntry>().swap(m_entries);
+			m_entries.reserve(capacity);
+		}
+		m_references.clear();
+		m_capacity = capacity;
+		m_first = m_sequence;
+	}
+
+	uint32_t LayerJournal::getCapacity() const {
+		return m_capacity;
+	}
+
+	bool LayerJournal::isEnabled() const {
+		return m_capacity != 0;
+	}
+
+	uint64_t LayerJournal::getSequence() const {
+		return m_sequence;
+	}
+
+	uint64_t LayerJournal::getOldestSequence() const {
+		if (m_sequence - m_first > m_capacity) {
+			return m_sequence - m_capacity;
+		}
+		return m_first;
+	}
+
+	bool LayerJournal::isLost(uint64_t cursor) const {
+		return cursor < getOldestSequence();
+	}
+
+	void LayerJournal::recordCreate(Instance* instance) {
+		if (m_capacity != 0) {
+			push(instance->getFifeId(), instance, LJ_CREATE, ICHANGE_NO_CHANGES);
+		}
+	}
+
+	void LayerJournal::recordDelete(Instance* instance) {
+		if (m_capacity != 0) {
+			forget(instance);
+			push(instance->getFifeId(), NULL, LJ_DELETE, ICHANGE_NO_CHANGES);
+		}
+	}
+
+	void LayerJournal::recordChange(Instance* instance, InstanceChangeInfo changes) {
+		if (m_capacity != 0 && changes != ICHANGE_NO_CHANGES) {
+			push(instance->getFifeId(), instance, getEvents(changes), changes);
+		}
+	}
+
+	void LayerJournal::forgetInstances() {
+		std::vector<LayerJournalEntry>::iterator it = m_entries.begin();
+		for (; it != m_entries.end(); ++it) {
+			it->instance = NULL;
+		}
+		m_references.clear();
+	}
+
+	uint64_t LayerJournal::read(uint64_t cursor, uint32_t maxCount, std::vector<LayerJournalEntry>& entries) const {
+		uint64_t start = std::min(std::max(cursor, getOldestSequence()), m_sequence);
+		uint64_t end = m_sequence;
+		if (maxCount != 0 && end - start > maxCount) {
+			end = start + maxCount;
+		}
+		entries.reserve(entries.size() + static_cast<size_t>(end - start));
+		for (uint64_t sequence = start; sequence < end; ++sequence) {
+			entries.push_back(m_entries[getSlot(sequence)]);
+		}
+		return end;
+	}
+
+	uint32_t LayerJournal::getEvents(InstanceChangeInfo changes) {
+		uint32_t events = LJ_NONE;
+		if (changes & (ICHANGE_LOC | ICHANGE_CELL)) {
+			events |= LJ_MOVE;
+		}
+		if (changes & ICHANGE_ACTION) {
+			events |= LJ_ACTION;
+		}
+		if (changes & (ICHANGE_ROTATION | ICHANGE_TRANSPARENCY | ICHANGE_VISIBLE | ICHANGE_STACKPOS | ICHANGE_VISUAL)) {
+			events |= LJ_VISUAL;
+		}
+		if (changes & (ICHANGE_SPEED | ICHANGE_TIME_MULTIPLIER | ICHANGE_SAYTEXT | ICHANGE_BLOCK)) {
+			events |= LJ_OTHER;
+		}
+		return events;
+	}
+
+	uint32_t LayerJournal::getSlot(uint64_t sequence) const {
+		return static_cast<uint32_t>((sequence - m_first) % m_capacity);
+	}
+
+	void LayerJournal::push(fifeid_t instanceId, Instance* instance, uint32_t events, InstanceChangeInfo changes) {
+		LayerJournalEntry entry;
+		entry.sequence = m_sequence;
+		entry.events = events;
+		entry.changes = changes;
+		entry.instanceId = instanceId;
+		entry.instance = instance;
+
+		if (m_entries.size() < m_capacity) {
+			m_entries.push_back(entry);
+		} else {
+			LayerJournalEntry& old = m_entries[getSlot(m_sequence)];
+			if (old.instance) {
+				std::unordered_map<Instance*, uint32_t>::iterator it = m_references.find(old.instance);
+				if (--it->second == 0) {
+					m_references.erase(it);
+				}
+			}
+			old = entry;
+		}
+		if (instance) {
+			++m_references[instance];
+		}
+		++m_sequence;
+	}
+
+	void LayerJournal::forget(Instance* instance) {
+		std::unordered_map<Instance*, uint32_t>::iterator it = m_references.find(instance);
+		if (it == m_references.end()) {
+			return;
+		}
+		uint32_t remaining = it->second;
+		m_references.erase(it);
+		// newest entries first, changes of a deleted instance are usually recent
+		uint64_t oldest = getOldestSequence();
+		for (uint64_t sequence = m_sequence; sequence > oldest && remaining > 0; --sequence) {
+			LayerJournalEntry& entry = m_entries[getSlot(sequence - 1)];
+			if (entry.instance == instance) {
+				entry.instance = NULL;
+				--remaining;
+			}
+		}
+	}
+} // FIFE
@@ -0,0 +1,164 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_LAYERJOURNAL_H
+#define FIFE_LAYERJOURNAL_H
+
+// Standard C++ library includes
+#include <vector>
+#include <unordered_map>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/base/fifeclass.h"
+
+#include "instance.h"
+
+namespace FIFE {
+
+	/** Kinds of journal events, used as bit mask.
+	 */
+	enum LayerJournalEvent {
+		LJ_NONE = 0x0000,
+		LJ_CREATE = 0x0001,
+		LJ_DELETE = 0x0002,
+		LJ_MOVE = 0x0004,
+		LJ_ACTION = 0x0008,
+		LJ_VISUAL = 0x0010,
+		LJ_OTHER = 0x0020
+	};
+
+	/** One entry of the layer journal.
+	 */
+	struct LayerJournalEntry {
+		//! sequence number of the entry, increases by one per entry
+		uint64_t sequence;
+		//! LayerJournalEvent bits
+		uint32_t events;
+		//! instance change info of the update, zero for create and delete
+		InstanceChangeInfo changes;
+		//! FifeClass id of the instance, stays valid after the instance is deleted
+		fifeid_t instanceId;
+		//! the instance, NULL once the instance was removed from the layer
+		Instance* instance;
+	};
+
+	/** Bounded ring buffer of instance changes on a layer.
+	 *
+	 * Consumers keep a cursor (the sequence of the next entry they want to read)
+	 * and pull the entries that were added since in batches. If a consumer falls
+	 * behind by more than the capacity, the oldest entries are lost, this can be
+	 * detected with isLost().
+	 */
+	class LayerJournal {
+	public:
+		/** Constructor
+		 * @param capacity Maximal number of entries, 0 disables the journal.
+		 */
+		LayerJournal(uint32_t capacity = 0);
+
+		/** Destructor
+		 */
+		~LayerJournal();
+
+		/** Sets the maximal number of entries. This clears the journal, but keeps the sequence.
+		 * 0 disables the journal.
+		 */
+		void setCapacity(uint32_t capacity);
+
+		/** Returns the maximal number of entries.
+		 */
+		uint32_t getCapacity() const;
+
+		/** Returns true if the journal records entries.
+		 */
+		bool isEnabled() const;
+
+		/** Returns the sequence the next entry will get. A new consumer starts with this cursor.
+		 */
+		uint64_t getSequence() const;
+
+		/** Returns the sequence of the oldest entry that is still stored.
+		 */
+		uint64_t getOldestSequence() const;
+
+		/** Returns true if entries between the cursor and the oldest stored entry were overwritten.
+		 */
+		bool isLost(uint64_t cursor) const;
+
+		/** Adds a create entry.
+		 */
+		void recordCreate(Instance* instance);
+
+		/** Adds a delete entry and clears the instance pointer of all stored entries of the instance.
+		 */
+		void recordDelete(Instance* instance);
+
+		/** Adds an entry for the changes of an instance update.
+		 */
+		void recordChange(Instance* instance, InstanceChangeInfo changes);
+
+		/** Clears the instance pointer of all stored entries. Used by Layer::deleteInstances
+		 * before all instances of the layer are deleted.
+		 */
+		void forgetInstances();
+
+		/** Copies up to maxCount entries starting at cursor into entries.
+		 * If the cursor is lost, reading starts at the oldest stored entry.
+		 * @param cursor The sequence of the first entry to read.
+		 * @param maxCount Maximal number of entries, 0 reads all.
+		 * @param entries The entries are appended to this vector.
+		 * @return The cursor for the next read.
+		 */
+		uint64_t read(uint64_t cursor, uint32_t maxCount, std::vector<LayerJournalEntry>& entries) const;
+
+		/** Converts instance change info to LayerJournalEvent bits.
+		 */
+		static uint32_t getEvents(InstanceChangeInfo changes);
+
+	private:
+		//! returns the ring buffer index of a stored sequence
+		uint32_t getSlot(uint64_t sequence) const;
+		//! adds an entry, overwrites the oldest one if the journal is full
+		void push(fifeid_t instanceId, Instance* instance, uint32_t events, InstanceChangeInfo changes);
+		//! clears the instance pointer of all stored entries of the instance
+		void forget(Instance* instance);
+
+		//! ring buffer, entry of sequence s is stored at (s - m_first) % m_capacity
+		std::vector<LayerJournalEntry> m_entries;
+		//! maximal number of entries
+		uint32_t m_capacity;
+		//! sequence of the next entry
+		uint64_t m_sequence;
+		//! sequence of the first entry after the journal was cleared
+		uint64_t m_first;
+		//! number of stored entries that point to an instance
+		std::unordered_map<Instance*, uint32_t> m_references;
+	};
+
+} // FIFE
+
+#endif
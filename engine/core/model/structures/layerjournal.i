@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+%module fife
+%{
+#include "model/structures/layerjournal.h"
+%}
+
+%include "util/base/utilbase.i"
+
+namespace FIFE {
+
+	class Instance;
+
+	enum LayerJournalEvent {
+		LJ_NONE = 0x0000,
+		LJ_CREATE = 0x0001,
+		LJ_DELETE = 0x0002,
+		LJ_MOVE = 0x0004,
+		LJ_ACTION = 0x0008,
+		LJ_VISUAL = 0x0010,
+		LJ_OTHER = 0x0020
+	};
+
+	struct LayerJournalEntry {
+		uint64_t sequence;
+		uint32_t events;
+		uint32_t changes;
+		fifeid_t instanceId;
+		Instance* instance;
+	};
+
+	class LayerJournal {
+	public:
+		LayerJournal(uint32_t capacity = 0);
+		~LayerJournal();
+
+		void setCapacity(uint32_t capacity);
+		uint32_t getCapacity() const;
+		bool isEnabled() const;
+		uint64_t getSequence() const;
+		uint64_t getOldestSequence() const;
+		bool isLost(uint64_t cursor) const;
+		uint64_t read(uint64_t cursor, uint32_t maxCount, std::vector<LayerJournalEntry>& entries) const;
+		static uint32_t getEvents(uint32_t changes);
+	};
+}
+
+namespace std {
+	%template(LayerJournalEntryVector) vector<FIFE::LayerJournalEntry>;
+}
@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <memory>
 #include <string>
 
 // 3rd party library includes
@@ -30,6 +31,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/exception.h"
+#include "util/concurrency/workerpool.h"
 #include "util/structures/purge.h"
 #include "util/structures/rect.h"
 #include "view/camera.h"
@@ -40,10 +42,14 @@
 #include "layer.h"
 #include "cellcache.h"
 #include "instance.h"
+#include "mapreadsnapshot.h"
 #include "triggercontroller.h"
 
 namespace FIFE {
 
+	//! cell caches with at least this many cells are built with worker threads
+	static const uint32_t PARALLEL_CELL_COUNT = 256 * 256;
+
 	Map::Map(const std::string& identifier, RenderBackend* renderBackend,
 			const std::vector<RendererBase*>& renderers, TimeProvider* tp_master):
 		m_id(identifier),
@@ -53,7 +59,10 @@ namespace FIFE {
 		m_changedLayers(),
 		m_renderBackend(renderBackend),
 		m_renderers(renderers),
-		m_changed(false) {
+		m_changed(false),
+		m_deferCalls(false),
+		m_readSnapshots(false),
+		m_readSnapshotVersion(0) {
 
 		m_triggerController = new TriggerController(this);
 	}
@@ -172,6 +181,12 @@ namespace FIFE {
 	}
 
 	bool Map::update() {
+		beginUpdate();
+		updateLayers(false);
+		return endUpdate();
+	}
+
+	void Map::beginUpdate() {
 		m_changedLayers.clear();
 		// transfer instances from one layer to another
 		if (!m_transferInstances.empty()) {
@@ -188,22 +203,45 @@ namespace FIFE {
 			}
 			m_transferInstances.clear();
 		}
-		std::vector<CellCache*> cellCaches;
+	}
+
+	void Map::updateLayers(bool deferCalls) {
+		m_deferCalls = deferCalls;
 		std::list<Layer*>::iterator it = m_layers.begin();
 		// update Layers
 		for(; it != m_layers.end(); ++it) {
 			if ((*it)->update()) {
 				m_changedLayers.push_back(*it);
 			}
+		}
+		m_deferCalls = false;
+	}
+
+	bool Map::endUpdate() {
+		// run the listener calls in the order they were queued,
+		// new calls can not be queued anymore
+		for (std::vector<DeferredCall>::size_type i = 0; i < m_deferredCalls.size(); ++i) {
+			std::function<void()> call;
+			call.swap(m_deferredCalls[i].call);
+			if (call) {
+				call();
+			}
+		}
+		m_deferredCalls.clear();
+
+		// loop over Caches and update
+		std::list<Layer*>::iterator it = m_layers.begin();
+		for(; it != m_layers.end(); ++it) {
 			CellCache* cache = (*it)->getCellCache();
 			if (cache) {
-				cellCaches.push_back(cache);
+				cache->update();
 			}
 		}
-		// loop over Caches and update
-		for (std::vector<CellCache*>::iterator cacheIt = cellCaches.begin();
-			cacheIt != cellCaches.end(); ++cacheIt) {
-			(*cacheIt)->update();
+		// publish the read snapshot before listeners and cameras can change the model again
+		if (m_readSnapshots) {
+			std::shared_ptr<const MapReadSnapshot> previous = std::atomic_load(&m_readSnapshot);
+			std::shared_ptr<const MapReadSnapshot> snapshot(new MapReadSnapshot(this, previous.get(), m_readSnapshotVersion++));
+			std::atomic_store(&m_readSnapshot, snapshot);
 		}
 		if (!m_changedLayers.empty()) {
 			std::vector<MapChangeListener*>::iterator i = m_changeListeners.begin();
@@ -227,6 +265,37 @@ namespace FIFE {
 		return retval;
 	}
 
+	void Map::setReadSnapshotsEnabled(bool enabled) {
+		m_readSnapshots = enabled;
+		if (!enabled) {
+			std::atomic_store(&m_readSnapshot, std::shared_ptr<const MapReadSnapshot>());
+		}
+	}
+
+	bool Map::areReadSnapshotsEnabled() const {
+		return m_readSnapshots;
+	}
+
+	std::shared_ptr<const MapReadSnapshot> Map::getReadSnapshot() const {
+		return std::atomic_load(&m_readSnapshot);
+	}
+
+	void Map::deferCall(Instance* instance, const std::function<void()>& call) {
+		DeferredCall deferred;
+		deferred.instance = instance;
+		deferred.call = call;
+		m_deferredCalls.push_back(deferred);
+	}
+
+	void Map::removeDeferredCalls(Instance* instance) {
+		std::vector<DeferredCall>::iterator it = m_deferredCalls.begin();
+		for (; it != m_deferredCalls.end(); ++it) {
+			if (it->instance == instance) {
+				it->call = std::function<void()>();
+			}
+		}
+	}
+
 	void Map::addChangeListener(MapChangeListener* listener) {
 		m_changeListeners.push_back(listener);
 	}
@@ -344,12 +413,16 @@ namespace FIFE {
 	}
 
 	void Map::finalizeCellCaches() {
-		// create Cells and generate neighbours
+		// create Cells and generate neighbours, large caches are split across worker threads
+		std::unique_ptr<WorkerPool> pool;
 		std::list<Layer*>::iterator layit = m_layers.begin();
 		for (; layit != m_layers.end(); ++layit) {
 			CellCache* cache = (*layit)->getCellCache();
 			if (cache) {
-				cache->createCells();
+				if (!pool && cache->getWidth() * cache->getHeight() >= PARALLEL_CELL_COUNT) {
+					pool.reset(new WorkerPool());
+				}
+				cache->createCells(pool.get());
 				cache->forceUpdate();
 			}
 		}
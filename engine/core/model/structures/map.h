@@ -23,7 +23,9 @@
 #define FIFE_MAP_MAP_H
 
 // Standard C++ library includes
+#include <functional>
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -50,6 +52,7 @@ namespace FIFE {
 	class Camera;
 	class Instance;
 	class TriggerController;
+	class MapReadSnapshot;
 
 	/** Listener interface for changes happening on map
 	 */
@@ -142,6 +145,39 @@ namespace FIFE {
 			 */
 			bool update();
 
+			/** First step of a split update, see Model::setParallelMapUpdate.
+			 * Transfers instances between layers. Must run on the main thread.
+			 */
+			void beginUpdate();
+
+			/** Second step of a split update. Updates the layers and their instances.
+			 * @param deferCalls If true, listener calls are queued until endUpdate().
+			 * The map can then be updated on a worker thread, as long as no other
+			 * thread touches the same map.
+			 */
+			void updateLayers(bool deferCalls);
+
+			/** Last step of a split update. Runs the deferred listener calls, updates the
+			 * cellcaches, informs the map listeners and renders the cameras.
+			 * Must run on the main thread.
+			 * @returns true, if map was changed
+			 */
+			bool endUpdate();
+
+			/** Returns true while the layers are updated with deferred listener calls.
+			 */
+			bool isDeferringCalls() const { return m_deferCalls; }
+
+			/** Queues a call that runs in endUpdate() on the main thread.
+			 * @param instance The instance the call belongs to or NULL.
+			 * @param call The call.
+			 */
+			void deferCall(Instance* instance, const std::function<void()>& call);
+
+			/** Drops the queued calls of the given instance. Called if the instance is deleted.
+			 */
+			void removeDeferredCalls(Instance* instance);
+
 			/** Sets speed for the map. See Model::setTimeMultiplier.
 			 */
 			void setTimeMultiplier(float multip) { m_timeProvider.setMultiplier(multip); }
@@ -219,6 +255,21 @@ namespace FIFE {
 			 */
 			TriggerController* getTriggerController() const { return m_triggerController; };
 
+			/** Enables or disables read snapshots. If enabled, a new snapshot
+			 * is published at the end of every update.
+			 * @param enabled A boolean, true to create snapshots, otherwise false.
+			 */
+			void setReadSnapshotsEnabled(bool enabled);
+
+			/** Returns true if read snapshots are created.
+			 */
+			bool areReadSnapshotsEnabled() const;
+
+			/** Returns the latest read snapshot or NULL if snapshots are disabled.
+			 * Can be called from any thread, the snapshot stays valid as long as it is held.
+			 */
+			std::shared_ptr<const MapReadSnapshot> getReadSnapshot() const;
+
 		private:
 			std::string m_id;
 			std::string m_filename;
@@ -250,7 +301,28 @@ namespace FIFE {
 			//! holds instances which should be transferred on the next update
 			std::map<Instance*, Location> m_transferInstances;
 
+			//! a listener call that was queued during the layer update
+			struct DeferredCall {
+				Instance* instance;
+				std::function<void()> call;
+			};
+
+			//! calls queued by the layer update, see updateLayers()
+			std::vector<DeferredCall> m_deferredCalls;
+
+			//! true, while the listener calls are deferred
+			bool m_deferCalls;
+
 			TriggerController* m_triggerController;
+
+			//! true, if read snapshots are created
+			bool m_readSnapshots;
+
+			//! version of the next read snapshot
+			uint64_t m_readSnapshotVersion;
+
+			//! latest read snapshot, only accessed with std::atomic_load and std::atomic_store
+			std::shared_ptr<const MapReadSnapshot> m_readSnapshot;
 	};
 
 }
@@ -0,0 +1,268 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "mapreadsnapshot.h"
+#include "map.h"
+#include "layer.h"
+#include "instance.h"
+#include "cellcache.h"
+
+namespace FIFE {
+
+	static bool instanceCellLess(const InstanceReadState& a, const InstanceReadState& b) {
+		if (a.cell.y != b.cell.y) {
+			return a.cell.y < b.cell.y;
+		}
+		return a.cell.x < b.cell.x;
+	}
+
+	LayerReadSnapshot::LayerReadSnapshot(Layer* layer, const LayerReadSnapshot* previous, bool instancesChanged):
+		m_layerId(layer->getId()),
+		m_layerFifeId(layer->getFifeId()) {
+		// instances
+		if (previous && !instancesChanged) {
+			m_instances = previous->m_instances;
+		} else {
+			std::shared_ptr<InstanceData> data(new InstanceData());
+			const std::vector<Instance*>& instances = layer->getInstances();
+			data->instances.reserve(instances.size());
+			std::vector<Instance*>::const_iterator it = instances.begin();
+			for (; it != instances.end(); ++it) {
+				const Location& loc = (*it)->getLocationRef();
+				InstanceReadState state;
+				state.fifeId = (*it)->getFifeId();
+				state.instance = *it;
+				state.position = loc.getExactLayerCoordinates();
+				state.cell = loc.getLayerCoordinates();
+				state.rotation = (*it)->getRotation();
+				state.blocking = (*it)->isBlocking();
+				data->instances.push_back(state);
+			}
+			std::stable_sort(data->instances.begin(), data->instances.end(), instanceCellLess);
+			m_instances = data;
+		}
+
+		// cells
+		CellCache* cache = layer->getCellCache();
+		if (!cache) {
+			return;
+		}
+		const CellData* old = previous ? previous->m_cells.get() : NULL;
+		if (old && (old->cacheId != cache->getFifeId() || old->layoutRevision != cache->getLayoutRevision())) {
+			old = NULL;
+		}
+		if (old && old->revision == cache->getRevision()) {
+			m_cells = previous->m_cells;
+			return;
+		}
+
+		std::shared_ptr<CellData> data(new CellData());
+		data->cacheId = cache->getFifeId();
+		data->layoutRevision = cache->getLayoutRevision();
+		data->revision = cache->getRevision();
+		data->area = cache->getSize();
+		data->width = static_cast<uint32_t>(data->area.w - data->area.x + 1);
+		const uint32_t height = static_cast<uint32_t>(data->area.h - data->area.y + 1);
+		const uint32_t bandCount = (height + CellCache::REVISION_BAND_ROWS - 1) / CellCache::REVISION_BAND_ROWS;
+		const std::vector<Cell*>& cells = cache->getCells();
+		data->bands.reserve(bandCount);
+		for (uint32_t band = 0; band < bandCount; ++band) {
+			uint32_t revision = cache->getBandRevision(band);
+			if (old && old->bands[band]->revision == revision) {
+				data->bands.push_back(old->bands[band]);
+				continue;
+			}
+			uint32_t first = band * CellCache::REVISION_BAND_ROWS * data->width;
+			uint32_t last = std::min(first + CellCache::REVISION_BAND_ROWS * data->width, static_cast<uint32_t>(cells.size()));
+			std::shared_ptr<CellBand> copy(new CellBand());
+			copy->revision = revision;
+			copy->types.reserve(last - first);
+			copy->costs.reserve(last - first);
+			copy->speeds.reserve(last - first);
+			for (uint32_t i = first; i < last; ++i) {
+				Cell* cell = cells[i];
+				copy->types.push_back(static_cast<uint8_t>(cell->getCellType()));
+				copy->costs.push_back(cache->getCostMultiplier(cell));
+				copy->speeds.push_back(cache->getSpeedMultiplier(cell));
+			}
+			data->bands.push_back(copy);
+		}
+		m_cells = data;
+	}
+
+	const std::string& LayerReadSnapshot::getLayerId() const {
+		return m_layerId;
+	}
+
+	fifeid_t LayerReadSnapshot::getLayerFifeId() const {
+		return m_layerFifeId;
+	}
+
+	const std::vector<InstanceReadState>& LayerReadSnapshot::getInstances() const {
+		return m_instances->instances;
+	}
+
+	std::vector<InstanceReadState> LayerReadSnapshot::getInstancesAt(const ModelCoordinate& mc) const {
+		return getInstancesIn(Rect(mc.x, mc.y, 1, 1));
+	}
+
+	std::vector<InstanceReadState> LayerReadSnapshot::getInstancesIn(const Rect& rec) const {
+		std::vector<InstanceReadState> result;
+		const std::vector<InstanceReadState>& instances = m_instances->instances;
+		InstanceReadState key;
+		for (int32_t y = rec.y; y < rec.y + rec.h; ++y) {
+			key.cell = ModelCoordinate(rec.x, y);
+			std::vector<InstanceReadState>::const_iterator it =
+				std::lower_bound(instances.begin(), instances.end(), key, instanceCellLess);
+			for (; it != instances.end() && it->cell.y == y && it->cell.x < rec.x + rec.w; ++it) {
+				result.push_back(*it);
+			}
+		}
+		return result;
+	}
+
+	bool LayerReadSnapshot::sharesInstances(const LayerReadSnapshot& other) const {
+		return m_instances == other.m_instances;
+	}
+
+	bool LayerReadSnapshot::hasCells() const {
+		return m_cells.get() != NULL;
+	}
+
+	const Rect& LayerReadSnapshot::getCellArea() const {
+		static const Rect empty;
+		return m_cells ? m_cells->area : empty;
+	}
+
+	bool LayerReadSnapshot::isInCellArea(const ModelCoordinate& mc) const {
+		const CellBand* band;
+		uint32_t index;
+		return findCell(mc, band, index);
+	}
+
+	CellTypeInfo LayerReadSnapshot::getCellType(const ModelCoordinate& mc) const {
+		const CellBand* band;
+		uint32_t index;
+		if (!findCell(mc, band, index)) {
+			return CTYPE_NO_BLOCKER;
+		}
+		return static_cast<CellTypeInfo>(band->types[index]);
+	}
+
+	bool LayerReadSnapshot::isCellBlocking(const ModelCoordinate& mc) const {
+		CellTypeInfo type = getCellType(mc);
+		return type == CTYPE_STATIC_BLOCKER || type == CTYPE_DYNAMIC_BLOCKER || type == CTYPE_CELL_BLOCKER;
+	}
+
+	double LayerReadSnapshot::getCellCostMultiplier(const ModelCoordinate& mc) const {
+		const CellBand* band;
+		uint32_t index;
+		if (!findCell(mc, band, index)) {
+			return 1.0;
+		}
+		return band->costs[index];
+	}
+
+	double LayerReadSnapshot::getCellSpeedMultiplier(const ModelCoordinate& mc) const {
+		const CellBand* band;
+		uint32_t index;
+		if (!findCell(mc, band, index)) {
+			return 1.0;
+		}
+		return band->speeds[index];
+	}
+
+	uint32_t LayerReadSnapshot::getCellBandCount() const {
+		return m_cells ? static_cast<uint32_t>(m_cells->bands.size()) : 0;
+	}
+
+	bool LayerReadSnapshot::sharesCellBand(const LayerReadSnapshot& other, uint32_t band) const {
+		if (band >= getCellBandCount() || band >= other.getCellBandCount()) {
+			return false;
+		}
+		return m_cells->bands[band] == other.m_cells->bands[band];
+	}
+
+	bool LayerReadSnapshot::findCell(const ModelCoordinate& mc, const CellBand*& band, uint32_t& index) const {
+		if (!m_cells) {
+			return false;
+		}
+		const CellData& data = *m_cells;
+		if (mc.x < data.area.x || mc.x > data.area.w || mc.y < data.area.y || mc.y > data.area.h) {
+			return false;
+		}
+		uint32_t x = static_cast<uint32_t>(mc.x - data.area.x);
+		uint32_t y = static_cast<uint32_t>(mc.y - data.area.y);
+		band = data.bands[y / CellCache::REVISION_BAND_ROWS].get();
+		index = x + (y % CellCache::REVISION_BAND_ROWS) * data.width;
+		return true;
+	}
+
+	MapReadSnapshot::MapReadSnapshot(Map* map, const MapReadSnapshot* previous, uint64_t version):
+		m_version(version) {
+		const std::vector<Layer*>& changed = map->getChangedLayers();
+		const std::list<Layer*>& layers = map->getLayers();
+		m_layers.reserve(layers.size());
+		std::list<Layer*>::const_iterator it = layers.begin();
+		for (; it != layers.end(); ++it) {
+			const LayerReadSnapshot* old = NULL;
+			if (previous) {
+				std::vector<std::shared_ptr<const LayerReadSnapshot> >::const_iterator oit = previous->m_layers.begin();
+				for (; oit != previous->m_layers.end(); ++oit) {
+					if ((*oit)->getLayerFifeId() == (*it)->getFifeId()) {
+						old = oit->get();
+						break;
+					}
+				}
+			}
+			bool instancesChanged = std::find(changed.begin(), changed.end(), *it) != changed.end();
+			m_layers.push_back(std::shared_ptr<const LayerReadSnapshot>(new LayerReadSnapshot(*it, old, instancesChanged)));
+		}
+	}
+
+	uint64_t MapReadSnapshot::getVersion() const {
+		return m_version;
+	}
+
+	const std::vector<std::shared_ptr<const LayerReadSnapshot> >& MapReadSnapshot::getLayers() const {
+		return m_layers;
+	}
+
+	const LayerReadSnapshot* MapReadSnapshot::getLayer(const std::string& id) const {
+		std::vector<std::shared_ptr<const LayerReadSnapshot> >::const_iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			if ((*it)->getLayerId() == id) {
+				return it->get();
+			}
+		}
+		return NULL;
+	}
+} // FIFE
@@ -0,0 +1,228 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MAPREADSNAPSHOT_H
+#define FIFE_MAPREADSNAPSHOT_H
+
+// Standard C++ library includes
+#include <memory>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fifeclass.h"
+#include "util/structures/rect.h"
+#include "model/metamodel/modelcoords.h"
+
+#include "cell.h"
+
+namespace FIFE {
+
+	class Map;
+	class Layer;
+	class Instance;
+
+	/** Read only state of one instance.
+	 */
+	struct InstanceReadState {
+		//! FifeClass id of the instance
+		fifeid_t fifeId;
+		//! handle of the instance, only to compare or to use on the main thread
+		Instance* instance;
+		//! exact layer coordinates
+		ExactModelCoordinate position;
+		//! layer coordinates
+		ModelCoordinate cell;
+		//! rotation in degrees
+		int32_t rotation;
+		//! true if the instance is blocking
+		bool blocking;
+	};
+
+	/** Frame consistent, read only copy of a layer.
+	 *
+	 * The instance and the cell data are shared between snapshots as long as they
+	 * did not change. Cells are copied in bands of CellCache::REVISION_BAND_ROWS rows,
+	 * so a moving blocker only copies its band. All methods are const and can be called
+	 * from any thread while the main thread updates the map.
+	 */
+	class LayerReadSnapshot {
+	public:
+		/** Returns the identifier of the layer.
+		 */
+		const std::string& getLayerId() const;
+
+		/** Returns the FifeClass id of the layer.
+		 */
+		fifeid_t getLayerFifeId() const;
+
+		/** Returns all instances, sorted by their layer coordinates (y first).
+		 */
+		const std::vector<InstanceReadState>& getInstances() const;
+
+		/** Returns the instances at the given layer coordinates.
+		 */
+		std::vector<InstanceReadState> getInstancesAt(const ModelCoordinate& mc) const;
+
+		/** Returns the instances inside the rect. Width and height are exclusive,
+		 * Rect(x, y, 1, 1) is the cell at x, y.
+		 */
+		std::vector<InstanceReadState> getInstancesIn(const Rect& rec) const;
+
+		/** Returns true if both snapshots use the same copy of the instances.
+		 */
+		bool sharesInstances(const LayerReadSnapshot& other) const;
+
+		/** Returns true if the layer had a cellcache.
+		 */
+		bool hasCells() const;
+
+		/** Returns the cellcache size, x = min.x, w = max.x, y = min.y, h = max.y.
+		 */
+		const Rect& getCellArea() const;
+
+		/** Returns true if the cellcache covered the coordinates.
+		 */
+		bool isInCellArea(const ModelCoordinate& mc) const;
+
+		/** Returns the cell type, CTYPE_NO_BLOCKER outside of the cell area.
+		 */
+		CellTypeInfo getCellType(const ModelCoordinate& mc) const;
+
+		/** Returns true if the cell is blocked, false outside of the cell area.
+		 */
+		bool isCellBlocking(const ModelCoordinate& mc) const;
+
+		/** Returns the cost multiplier of the cell, 1.0 outside of the cell area.
+		 */
+		double getCellCostMultiplier(const ModelCoordinate& mc) const;
+
+		/** Returns the speed multiplier of the cell, 1.0 outside of the cell area.
+		 */
+		double getCellSpeedMultiplier(const ModelCoordinate& mc) const;
+
+		/** Returns the number of cell bands, 0 without cellcache.
+		 */
+		uint32_t getCellBandCount() const;
+
+		/** Returns true if both snapshots use the same copy of the cell band.
+		 */
+		bool sharesCellBand(const LayerReadSnapshot& other, uint32_t band) const;
+
+	private:
+		friend class MapReadSnapshot;
+
+		//! instances of the layer
+		struct InstanceData {
+			//! all instances, sorted by cell
+			std::vector<InstanceReadState> instances;
+		};
+
+		//! cells of some rows
+		struct CellBand {
+			//! cellcache revision the band was copied at
+			uint32_t revision;
+			//! CellTypeInfo per cell
+			std::vector<uint8_t> types;
+			//! cost multiplier per cell
+			std::vector<double> costs;
+			//! speed multiplier per cell
+			std::vector<double> speeds;
+		};
+
+		//! cells of the layer
+		struct CellData {
+			//! cellcache the cells were copied from
+			fifeid_t cacheId;
+			//! layout revision of the cellcache
+			uint32_t layoutRevision;
+			//! revision of the cellcache
+			uint32_t revision;
+			//! cellcache size, x = min.x, w = max.x, y = min.y, h = max.y
+			Rect area;
+			//! number of cells per row
+			uint32_t width;
+			//! bands of CellCache::REVISION_BAND_ROWS rows
+			std::vector<std::shared_ptr<const CellBand> > bands;
+		};
+
+		/** Creates the snapshot of a layer, unchanged data is taken from the previous snapshot.
+		 * @param layer The layer to copy.
+		 * @param previous The previous snapshot of the layer or NULL.
+		 * @param instancesChanged True if the instances changed since the previous snapshot.
+		 */
+		LayerReadSnapshot(Layer* layer, const LayerReadSnapshot* previous, bool instancesChanged);
+
+		//! returns the band and the index inside of the band or false if the cell is outside of the area
+		bool findCell(const ModelCoordinate& mc, const CellBand*& band, uint32_t& index) const;
+
+		//! identifier of the layer
+		std::string m_layerId;
+		//! FifeClass id of the layer
+		fifeid_t m_layerFifeId;
+		//! shared instance data
+		std::shared_ptr<const InstanceData> m_instances;
+		//! shared cell data, NULL without cellcache
+		std::shared_ptr<const CellData> m_cells;
+	};
+
+	/** Frame consistent, read only copy of the map state for worker threads.
+	 *
+	 * Snapshots are created by the map at the end of every update if enabled,
+	 * see Map::setReadSnapshotsEnabled(). Workers get the latest one with
+	 * Map::getReadSnapshot() and can keep it as long as they want.
+	 */
+	class MapReadSnapshot {
+	public:
+		/** Creates the snapshot of a map, unchanged layers are shared with the previous snapshot.
+		 * @param map The map to copy.
+		 * @param previous The previous snapshot of the map or NULL.
+		 * @param version The version of the new snapshot.
+		 */
+		MapReadSnapshot(Map* map, const MapReadSnapshot* previous, uint64_t version);
+
+		/** Returns the version, increases by one per map update.
+		 */
+		uint64_t getVersion() const;
+
+		/** Returns the layers in map order.
+		 */
+		const std::vector<std::shared_ptr<const LayerReadSnapshot> >& getLayers() const;
+
+		/** Returns the layer with the given identifier or NULL.
+		 */
+		const LayerReadSnapshot* getLayer(const std::string& id) const;
+
+	private:
+		//! version of the snapshot
+		uint64_t m_version;
+		//! layers in map order
+		std::vector<std::shared_ptr<const LayerReadSnapshot> > m_layers;
+	};
+
+} // FIFE
+
+#endif
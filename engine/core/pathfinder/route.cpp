@@ -31,6 +31,7 @@
 #include "model/metamodel/object.h"
 #include "model/structures/layer.h"
 #include "model/structures/location.h"
+#include "util/structures/objectpool.h"
 
 #include "route.h"
 
@@ -54,6 +55,14 @@ namespace FIFE {
 	Route::~Route() {
 	}
 
+	void* Route::operator new(std::size_t size) {
+		return ObjectPool<Route>::instance().allocate(size);
+	}
+
+	void Route::operator delete(void* ptr, std::size_t size) {
+		ObjectPool<Route>::instance().deallocate(ptr, size);
+	}
+
 	void Route::setRouteStatus(RouteStatusInfo status) {
 		if (m_status != status) {
 			m_status = status;
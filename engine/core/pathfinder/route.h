@@ -23,6 +23,7 @@
 #define FIFE_ROUTE_H
 
 // Standard C++ library includes
+#include <cstddef>
 #include <list>
 
 // 3rd party library includes
@@ -73,6 +74,11 @@ namespace FIFE {
 		 */
 		~Route();
 
+		/** Routes are created for every movement, so they come from an ObjectPool.
+		 */
+		static void* operator new(std::size_t size);
+		static void operator delete(void* ptr, std::size_t size);
+
 		/** Sets route status.
 		 * @param status The seach status that should be set.
 		 */
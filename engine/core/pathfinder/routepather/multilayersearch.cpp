@@ -35,6 +35,7 @@
 #include "model/structures/map.h"
 #include "pathfinder/route.h"
 #include "util/math/fife_math.h"
+#include "util/structures/objectpool.h"
 
 #include "multilayersearch.h"
 
@@ -58,8 +59,8 @@ namespace FIFE {
 		// if end zone is invalid (static blocker) then change it
 		if (!m_endZone) {
 			Cell* endcell = m_endCache->getCell(m_to.getLayerCoordinates());
-			const std::vector<Cell*>& neighbors = endcell->getNeighbors();
-			for (std::vector<Cell*>::const_iterator it = neighbors.begin();
+			const CellNeighbors& neighbors = endcell->getNeighbors();
+			for (CellNeighbors::const_iterator it = neighbors.begin();
 				it != neighbors.end(); ++it) {
 				Zone* tmpzone = (*it)->getZone();
 				if (tmpzone) {
@@ -81,8 +82,8 @@ namespace FIFE {
 		}
 		// if it is a protected cell it can have a second startzone
 		if (m_betweenTargets.empty() && startCell->isZoneProtected()) {
-			const std::vector<Cell*>& neighbors = startCell->getNeighbors();
-			for (std::vector<Cell*>::const_iterator it = neighbors.begin();
+			const CellNeighbors& neighbors = startCell->getNeighbors();
+			for (CellNeighbors::const_iterator it = neighbors.begin();
 				it != neighbors.end(); ++it) {
 				Zone* tmpzone = (*it)->getZone();
 				if (tmpzone) {
@@ -122,6 +123,14 @@ namespace FIFE {
 		m_next = 0;
 	}
 
+	void* MultiLayerSearch::operator new(std::size_t size) {
+		return ObjectPool<MultiLayerSearch>::instance().allocate(size);
+	}
+
+	void MultiLayerSearch::operator delete(void* ptr, std::size_t size) {
+		ObjectPool<MultiLayerSearch>::instance().deallocate(ptr, size);
+	}
+
 	void MultiLayerSearch::updateSearch() {
 		if (m_sortedFrontier.empty()) {
 			if (!m_foundLast || m_lastDestCoordInt == m_destCoordInt || getSearchStatus() == search_status_failed) {
@@ -184,11 +193,11 @@ namespace FIFE {
 		bool zLimited = maxZ != -1;
 		uint8_t blockerThreshold = m_ignoreDynamicBlockers ? 2 : 1;
 		bool limitedArea = m_route->isAreaLimited();
-		const std::vector<Cell*>& adjacents = nextCell->getNeighbors();
+		const CellNeighbors& adjacents = nextCell->getNeighbors();
 		if (adjacents.empty()) {
 			return;
 		}
-		for (std::vector<Cell*>::const_iterator i = adjacents.begin(); i != adjacents.end(); ++i) {
+		for (CellNeighbors::const_iterator i = adjacents.begin(); i != adjacents.end(); ++i) {
 			if (*i == NULL) {
 				continue;
 			}
@@ -43,6 +43,7 @@
 namespace FIFE {
 
 	int32_t RoutePather::makeSessionId() {
+		std::lock_guard<std::mutex> lock(m_sessionMutex);
 		return m_nextFreeSessionId++;
 	}
 
@@ -55,6 +56,7 @@ namespace FIFE {
 	}
 
 	void RoutePather::update() {
+		std::lock_guard<std::mutex> lock(m_sessionMutex);
 		int32_t ticksleft = m_maxTicks;
 		while (ticksleft > 0) {
 			if(m_sessions.empty()) {
@@ -88,6 +90,7 @@ namespace FIFE {
 
 	bool RoutePather::cancelSession(const int32_t sessionId) {
 		if (sessionId >= 0) {
+			std::lock_guard<std::mutex> lock(m_sessionMutex);
 			return invalidateSessionId(sessionId);
 		}
 		return false;
@@ -133,8 +136,11 @@ namespace FIFE {
 	}
 
 	bool RoutePather::solveRoute(Route* route, int32_t priority, bool immediate) {
-		if (sessionIdValid(route->getSessionId())) {
-			return false;
+		{
+			std::lock_guard<std::mutex> lock(m_sessionMutex);
+			if (sessionIdValid(route->getSessionId())) {
+				return false;
+			}
 		}
 
 		const Location& start = route->getStartNode();
@@ -166,8 +172,8 @@ namespace FIFE {
 				// look for special cases (start is zone border or end is static blocker)
 				if (!endZone || startCell->isZoneProtected()) {
 					bool found = false;
-					const std::vector<Cell*>& neighbors = endCell->getNeighbors();
-					for (std::vector<Cell*>::const_iterator it = neighbors.begin();
+					const CellNeighbors& neighbors = endCell->getNeighbors();
+					for (CellNeighbors::const_iterator it = neighbors.begin();
 						it != neighbors.end(); ++it) {
 						Zone* tmpZone = (*it)->getZone();
 						if (tmpZone) {
@@ -179,8 +185,8 @@ namespace FIFE {
 						}
 					}
 					if (!found && startCell->isZoneProtected()) {
-						const std::vector<Cell*>& neighbors = startCell->getNeighbors();
-						for (std::vector<Cell*>::const_iterator it = neighbors.begin();
+						const CellNeighbors& neighbors = startCell->getNeighbors();
+						for (CellNeighbors::const_iterator it = neighbors.begin();
 							it != neighbors.end(); ++it) {
 							Zone* tmpZone = (*it)->getZone();
 							if (tmpZone) {
@@ -215,13 +221,13 @@ namespace FIFE {
 				}
 			}
 			if (!sameAreas) {
-				const std::vector<Cell*>& neighbors = endCell->getNeighbors();
+				const CellNeighbors& neighbors = endCell->getNeighbors();
 				if (neighbors.empty()) {
 					return false;
 				}
 				area_it = areas.begin();
 				for (; area_it != areas.end(); ++area_it) {
-					std::vector<Cell*>::const_iterator neigh_it = neighbors.begin();
+					CellNeighbors::const_iterator neigh_it = neighbors.begin();
 					for (; neigh_it != neighbors.end(); ++neigh_it) {
 						if (endCache->isCellInArea(*area_it, *neigh_it)) {
 							sameAreas = true;
@@ -263,14 +269,14 @@ namespace FIFE {
 			delete newSearch;
 			return true;
 		}
+		std::lock_guard<std::mutex> lock(m_sessionMutex);
 		m_sessions.pushElement(SessionQueue::value_type(newSearch, priority));
 		addSessionId(sessionId);
 		return true;
 	}
 
 	bool RoutePather::followRoute(const Location& current, Route* route, double speed, Location& nextLocation) {
-		Path path = route->getPath();
-		if (path.empty()) {
+		if (route->getPathLength() == 0) {
 			return false;
 		}
 		if (Mathd::Equal(speed, 0.0)) {
@@ -441,4 +447,16 @@ namespace FIFE {
 	std::string RoutePather::getName() const {
 		return "RoutePather";
 	}
+
+	ObjectPoolStats RoutePather::getRoutePoolStats() {
+		return ObjectPool<Route>::instance().getStats();
+	}
+
+	ObjectPoolStats RoutePather::getSingleLayerSearchPoolStats() {
+		return ObjectPool<SingleLayerSearch>::instance().getStats();
+	}
+
+	ObjectPoolStats RoutePather::getMultiLayerSearchPoolStats() {
+		return ObjectPool<MultiLayerSearch>::instance().getStats();
+	}
 }
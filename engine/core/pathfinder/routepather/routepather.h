@@ -24,6 +24,7 @@
 
 // Standard C++ library includes
 #include <map>
+#include <mutex>
 #include <vector>
 
 // 3rd party library includes
@@ -34,6 +35,7 @@
 // Second block: files included from the same folder
 #include "model/metamodel/ipather.h"
 #include "model/structures/location.h"
+#include "util/structures/objectpool.h"
 #include "util/structures/priorityqueue.h"
 
 namespace FIFE {
@@ -112,6 +114,18 @@ namespace FIFE {
 		 */
 		std::string getName() const;
 
+		/** Returns the counters of the pool that holds the routes.
+		 */
+		static ObjectPoolStats getRoutePoolStats();
+
+		/** Returns the counters of the pool that holds the single layer searches.
+		 */
+		static ObjectPoolStats getSingleLayerSearchPoolStats();
+
+		/** Returns the counters of the pool that holds the multi layer searches.
+		 */
+		static ObjectPoolStats getMultiLayerSearchPoolStats();
+
 	private:
 		//! A path is a list with locations. Each location holds the coordinate for one cell.
 		typedef std::list<Location> Path;
@@ -171,6 +185,9 @@ namespace FIFE {
 
 		//! The maximum number of ticks allowed.
 		int32_t m_maxTicks;
+
+		//! Guards the sessions, routes can be solved while maps update in parallel.
+		std::mutex m_sessionMutex;
 	};
 }
 #endif
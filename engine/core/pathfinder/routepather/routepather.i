@@ -33,5 +33,9 @@ namespace FIFE {
 		RoutePather();
 		virtual ~RoutePather();
 		std::string getName() const;
+
+		static ObjectPoolStats getRoutePoolStats();
+		static ObjectPoolStats getSingleLayerSearchPoolStats();
+		static ObjectPoolStats getMultiLayerSearchPoolStats();
 	};
 }
@@ -34,6 +34,7 @@
 #include "model/structures/cell.h"
 #include "pathfinder/route.h"
 #include "util/math/fife_math.h"
+#include "util/structures/objectpool.h"
 
 #include "singlelayersearch.h"
 
@@ -87,8 +88,8 @@ namespace FIFE {
 		bool zLimited = maxZ != -1;
 		uint8_t blockerThreshold = m_ignoreDynamicBlockers ? 2 : 1;
 		bool limitedArea = m_route->isAreaLimited();
-		const std::vector<Cell*>& adjacents = nextCell->getNeighbors();
-		for (std::vector<Cell*>::const_iterator i = adjacents.begin(); i != adjacents.end(); ++i) {
+		const CellNeighbors& adjacents = nextCell->getNeighbors();
+		for (CellNeighbors::const_iterator i = adjacents.begin(); i != adjacents.end(); ++i) {
 			if (*i == NULL) {
 				continue;
 			}
@@ -191,6 +192,14 @@ namespace FIFE {
 		}
 	}
 
+	void* SingleLayerSearch::operator new(std::size_t size) {
+		return ObjectPool<SingleLayerSearch>::instance().allocate(size);
+	}
+
+	void SingleLayerSearch::operator delete(void* ptr, std::size_t size) {
+		ObjectPool<SingleLayerSearch>::instance().deallocate(ptr, size);
+	}
+
 	void SingleLayerSearch::calcPath() {
 		int32_t current = m_destCoordInt;
 		int32_t end = m_startCoordInt;
@@ -54,6 +54,11 @@ namespace FIFE {
 		 */
 		~SingleLayerSearch();
 
+		/** Searches are created for every pathing session, so they come from an ObjectPool.
+		 */
+		static void* operator new(std::size_t size);
+		static void operator delete(void* ptr, std::size_t size);
+
 		/** Updates the search.
 		 *
 		 * Each update checks all neighbors of the last checked coordinate and selects the most favorable.
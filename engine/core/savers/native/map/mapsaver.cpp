@@ -249,119 +249,116 @@ namespace FIFE {
 			const std::set<Cell*>& narrowCells = cache->getNarrowCells();
 			bool saveNarrows = !cache->isSearchNarrowCells() && !narrowCells.empty();
 
-			const std::vector<std::vector<Cell*> >& cells = cache->getCells();
-			std::vector<std::vector<Cell*> >::const_iterator it = cells.begin();
-			for (; it != cells.end(); ++it) {
-				std::vector<Cell*>::const_iterator cit = (*it).begin();
-				for (; cit != (*it).end(); ++cit) {
-					Cell* cell = *cit;
-					std::list<std::string> costIds = cache->getCosts();
-					bool costsEmpty = costIds.empty();
-					bool defaultCost = cell->defaultCost();
-					bool defaultSpeed = cell->defaultSpeed();
-
-					// check if area is part of the cell or object
-					std::vector<std::string> areaIds = cache->getCellAreas(cell);
-					std::vector<std::string> cellAreaIds;
-					bool areasEmpty = areaIds.empty();
-					if (!areasEmpty) {
-						const std::set<Instance*>& cellInstances = cell->getInstances();
-						if (!cellInstances.empty()) {
-							std::vector<std::string>::iterator area_it = areaIds.begin();
-							for (; area_it != areaIds.end(); ++area_it) {
-								bool objectArea = false;
-								std::set<Instance*>::const_iterator instance_it = cellInstances.begin();
-								for (; instance_it != cellInstances.end(); ++instance_it) {
-									if ((*instance_it)->getObject()->getArea() == *area_it) {
-										objectArea = true;
-										break;
-									}
-								}
-								if (!objectArea) {
-									cellAreaIds.push_back(*area_it);
+			const std::vector<Cell*>& cells = cache->getCells();
+			std::vector<Cell*>::const_iterator cit = cells.begin();
+			for (; cit != cells.end(); ++cit) {
+				Cell* cell = *cit;
+				std::list<std::string> costIds = cache->getCosts();
+				bool costsEmpty = costIds.empty();
+				bool defaultCost = cell->defaultCost();
+				bool defaultSpeed = cell->defaultSpeed();
+
+				// check if area is part of the cell or object
+				std::vector<std::string> areaIds = cache->getCellAreas(cell);
+				std::vector<std::string> cellAreaIds;
+				bool areasEmpty = areaIds.empty();
+				if (!areasEmpty) {
+					const CellInstances& cellInstances = cell->getInstances();
+					if (!cellInstances.empty()) {
+						std::vector<std::string>::iterator area_it = areaIds.begin();
+						for (; area_it != areaIds.end(); ++area_it) {
+							bool objectArea = false;
+							CellInstances::const_iterator instance_it = cellInstances.begin();
+							for (; instance_it != cellInstances.end(); ++instance_it) {
+								if ((*instance_it)->getObject()->getArea() == *area_it) {
+									objectArea = true;
+									break;
 								}
 							}
-						} else {
-							cellAreaIds = areaIds;
+							if (!objectArea) {
+								cellAreaIds.push_back(*area_it);
+							}
 						}
-						areasEmpty = cellAreaIds.empty();
+					} else {
+						cellAreaIds = areaIds;
 					}
+					areasEmpty = cellAreaIds.empty();
+				}
 
-					CellTypeInfo cti = cell->getCellType();
-					bool cellBlocker = (cti != CTYPE_CELL_NO_BLOCKER && cti != CTYPE_CELL_BLOCKER);
-					TransitionInfo* transition = cell->getTransition();
-					bool isNarrow = false;
-					if (saveNarrows) {
-						std::set<Cell*>::const_iterator narrow_it = narrowCells.find(cell);
-						if (narrow_it != narrowCells.end()) {
-							isNarrow = true;
-						}
-					}
-					if (costsEmpty && defaultCost && defaultSpeed && areasEmpty &&
-						cellBlocker && !transition && !isNarrow) {
-						continue;
-					}
-					// add cell tag to document
-					ModelCoordinate cellCoord = cell->getLayerCoordinates();
-					TiXmlElement* cellElement = new TiXmlElement("cell");
-					cellElement->SetAttribute("x", cellCoord.x);
-					cellElement->SetAttribute("y", cellCoord.y);
-					if (!defaultCost) {
-						cellElement->SetDoubleAttribute("default_cost", cell->getCostMultiplier());
-					}
-					if (!defaultSpeed) {
-						cellElement->SetDoubleAttribute("default_speed", cell->getSpeedMultiplier());
+				CellTypeInfo cti = cell->getCellType();
+				bool cellBlocker = (cti != CTYPE_CELL_NO_BLOCKER && cti != CTYPE_CELL_BLOCKER);
+				TransitionInfo* transition = cell->getTransition();
+				bool isNarrow = false;
+				if (saveNarrows) {
+					std::set<Cell*>::const_iterator narrow_it = narrowCells.find(cell);
+					if (narrow_it != narrowCells.end()) {
+						isNarrow = true;
 					}
+				}
+				if (costsEmpty && defaultCost && defaultSpeed && areasEmpty &&
+					cellBlocker && !transition && !isNarrow) {
+					continue;
+				}
+				// add cell tag to document
+				ModelCoordinate cellCoord = cell->getLayerCoordinates();
+				TiXmlElement* cellElement = new TiXmlElement("cell");
+				cellElement->SetAttribute("x", cellCoord.x);
+				cellElement->SetAttribute("y", cellCoord.y);
+				if (!defaultCost) {
+					cellElement->SetDoubleAttribute("default_cost", cell->getCostMultiplier());
+				}
+				if (!defaultSpeed) {
+					cellElement->SetDoubleAttribute("default_speed", cell->getSpeedMultiplier());
+				}
 
-					if (!cellBlocker) {
-						if (cti == CTYPE_CELL_NO_BLOCKER) {
-							cellElement->SetAttribute("blocker_type", "no_blocker");
-						} else {
-							cellElement->SetAttribute("blocker_type", "blocker");
-						}
-					}
-					if (isNarrow) {
-						cellElement->SetAttribute("narrow", true);
+				if (!cellBlocker) {
+					if (cti == CTYPE_CELL_NO_BLOCKER) {
+						cellElement->SetAttribute("blocker_type", "no_blocker");
+					} else {
+						cellElement->SetAttribute("blocker_type", "blocker");
 					}
-					// add cost tag
-					if (!costsEmpty) {
-						std::list<std::string>::iterator cost_it = costIds.begin();
-						for (; cost_it != costIds.end(); ++cost_it) {
-							if (cache->existsCostForCell(*cost_it, cell)) {
-								TiXmlElement* costElement = new TiXmlElement("cost");
-								costElement->SetAttribute("id", *cost_it);
-								costElement->SetDoubleAttribute("value", cache->getCost(*cost_it));
-								cellElement->LinkEndChild(costElement);
-							}
+				}
+				if (isNarrow) {
+					cellElement->SetAttribute("narrow", true);
+				}
+				// add cost tag
+				if (!costsEmpty) {
+					std::list<std::string>::iterator cost_it = costIds.begin();
+					for (; cost_it != costIds.end(); ++cost_it) {
+						if (cache->existsCostForCell(*cost_it, cell)) {
+							TiXmlElement* costElement = new TiXmlElement("cost");
+							costElement->SetAttribute("id", *cost_it);
+							costElement->SetDoubleAttribute("value", cache->getCost(*cost_it));
+							cellElement->LinkEndChild(costElement);
 						}
 					}
-					// add area tag
-					if (!areasEmpty) {
-						std::vector<std::string>::iterator area_it = cellAreaIds.begin();
-						for (; area_it != cellAreaIds.end(); ++area_it) {
-							TiXmlElement* areaElement = new TiXmlElement("area");
-							areaElement->SetAttribute("id", *area_it);
-							areaElement->LinkEndChild(areaElement);
-						}
+				}
+				// add area tag
+				if (!areasEmpty) {
+					std::vector<std::string>::iterator area_it = cellAreaIds.begin();
+					for (; area_it != cellAreaIds.end(); ++area_it) {
+						TiXmlElement* areaElement = new TiXmlElement("area");
+						areaElement->SetAttribute("id", *area_it);
+						areaElement->LinkEndChild(areaElement);
 					}
-					// add transition tag
-					if (transition) {
-						TiXmlElement* transitionElement = new TiXmlElement("transition");
-						transitionElement->SetAttribute("id", transition->m_layer->getId());
-						transitionElement->SetAttribute("x", transition->m_mc.x);
-						transitionElement->SetAttribute("y", transition->m_mc.y);
-						if (transition->m_mc.z != 0) {
-							transitionElement->SetAttribute("z", transition->m_mc.z);
-						}
-						if (transition->m_immediate) {
-							transitionElement->SetAttribute("immediate", true);
-						} else {
-							transitionElement->SetAttribute("immediate", false);
-						}
-						cellElement->LinkEndChild(transitionElement);
+				}
+				// add transition tag
+				if (transition) {
+					TiXmlElement* transitionElement = new TiXmlElement("transition");
+					transitionElement->SetAttribute("id", transition->m_layer->getId());
+					transitionElement->SetAttribute("x", transition->m_mc.x);
+					transitionElement->SetAttribute("y", transition->m_mc.y);
+					if (transition->m_mc.z != 0) {
+						transitionElement->SetAttribute("z", transition->m_mc.z);
+					}
+					if (transition->m_immediate) {
+						transitionElement->SetAttribute("immediate", true);
+					} else {
+						transitionElement->SetAttribute("immediate", false);
 					}
-					cellcacheElement->LinkEndChild(cellElement);
+					cellElement->LinkEndChild(transitionElement);
 				}
+				cellcacheElement->LinkEndChild(cellElement);
 			}
 			cellcachesElement->LinkEndChild(cellcacheElement);
         }
@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MAPSNAPSHOTFORMAT_H_
+#define FIFE_MAPSNAPSHOTFORMAT_H_
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** Binary map snapshot format, shared by MapSnapshotSaver and MapSnapshotLoader.
+	 *
+	 * All values are little endian, strings are stored as uint32 length and bytes.
+	 * Layers are referenced by their index in the layer table, instances by their
+	 * index in the instance list of their layer. Layout of version 1:
+	 *
+	 * @code
+	 * header:      magic "FIFESNAP", uint32 version, string map id, float map time multiplier
+	 * layers:      uint32 count, string id per layer
+	 * instances:   per layer uint32 count and the instance records
+	 * cellcaches:  uint32 count, per cache the layer, defaults, costs, areas and modified cells
+	 * triggers:    uint32 count, the trigger records
+	 * footer:      uint32 SNAPSHOT_END
+	 * @endcode
+	 */
+	namespace MapSnapshot {
+		//! file magic
+		static const char MAGIC[8] = { 'F', 'I', 'F', 'E', 'S', 'N', 'A', 'P' };
+		//! current format version, increase it on every format change
+		static const uint32_t VERSION = 1;
+		//! marks the end of the snapshot
+		static const uint32_t SNAPSHOT_END = 0x444E4521;
+		//! reference to no layer or instance
+		static const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+		//! instance record flags
+		enum InstanceFlags {
+			INSTANCE_BLOCKING = 0x01,
+			INSTANCE_OVERRIDE_BLOCKING = 0x02,
+			INSTANCE_SPECIAL_COST = 0x04,
+			INSTANCE_VISIBLE = 0x08,
+			INSTANCE_ACTION = 0x10
+		};
+
+		//! kind of the current action of an instance
+		enum ActionKind {
+			ACTION_ONCE = 0,
+			ACTION_REPEAT = 1,
+			ACTION_MOVE = 2,
+			ACTION_FOLLOW = 3
+		};
+
+		//! modified cell record flags
+		enum CellFlags {
+			CELL_COST_MULTIPLIER = 0x01,
+			CELL_SPEED_MULTIPLIER = 0x02,
+			CELL_NARROW = 0x04,
+			CELL_TRANSITION = 0x08,
+			CELL_TYPE = 0x10
+		};
+
+		//! trigger record flags
+		enum TriggerFlags {
+			TRIGGER_TRIGGERED = 0x01,
+			TRIGGER_ALL_INSTANCES = 0x02,
+			TRIGGER_ATTACHED = 0x04
+		};
+	}
+}
+
+#endif
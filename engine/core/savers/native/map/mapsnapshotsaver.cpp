@@ -0,0 +1,389 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <map>
+#include <set>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "model/structures/trigger.h"
+#include "model/structures/triggercontroller.h"
+#include "pathfinder/route.h"
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+#include "view/visual.h"
+#include "vfs/raw/binarystream.h"
+
+#include "mapsnapshotformat.h"
+#include "mapsnapshotsaver.h"
+
+namespace FIFE {
+	static Logger _log(LM_NATIVE_SAVERS);
+
+	namespace {
+		typedef std::map<Layer*, uint32_t> LayerIndexMap;
+		typedef std::map<Instance*, std::pair<uint32_t, uint32_t> > InstanceIndexMap;
+
+		uint32_t getLayerIndex(const LayerIndexMap& layers, Layer* layer) {
+			LayerIndexMap::const_iterator it = layers.find(layer);
+			return it != layers.end() ? it->second : MapSnapshot::NO_INDEX;
+		}
+
+		void writeInstanceRef(BinaryWriter& writer, const InstanceIndexMap& instances, Instance* instance) {
+			InstanceIndexMap::const_iterator it = instances.find(instance);
+			if (it != instances.end()) {
+				writer.write32(it->second.first);
+				writer.write32(it->second.second);
+			} else {
+				writer.write32(MapSnapshot::NO_INDEX);
+				writer.write32(MapSnapshot::NO_INDEX);
+			}
+		}
+
+		void writeCell(BinaryWriter& writer, Cell* cell) {
+			ModelCoordinate mc = cell->getLayerCoordinates();
+			writer.writeInt32(mc.x);
+			writer.writeInt32(mc.y);
+		}
+
+		void writeAction(BinaryWriter& writer, const LayerIndexMap& layers, const InstanceIndexMap& instances, Instance* instance) {
+			Action* action = instance->getCurrentAction();
+			Instance* leader = instance->getFollowedInstance();
+			Route* route = instance->getRoute();
+
+			uint8_t kind = MapSnapshot::ACTION_ONCE;
+			if (leader && instances.find(leader) != instances.end()) {
+				kind = MapSnapshot::ACTION_FOLLOW;
+			} else if (route || leader) {
+				// follows on external routes or leaders outside of the map are restored as move,
+				// routes that are still searched are solved again by the loader
+				kind = MapSnapshot::ACTION_MOVE;
+			} else if (instance->isActionRepeating()) {
+				kind = MapSnapshot::ACTION_REPEAT;
+			}
+
+			writer.write8(kind);
+			writer.writeString(action->getId());
+			writer.write32(instance->getActionRuntime());
+			if (kind == MapSnapshot::ACTION_ONCE || kind == MapSnapshot::ACTION_REPEAT) {
+				return;
+			}
+
+			writer.writeDouble(instance->getMovementSpeed());
+			if (kind == MapSnapshot::ACTION_FOLLOW) {
+				writeInstanceRef(writer, instances, leader);
+				return;
+			}
+
+			Location target = route ? route->getEndNode() : instance->getTargetLocation();
+			ExactModelCoordinate emc = target.getExactLayerCoordinates();
+			writer.write32(getLayerIndex(layers, target.getLayer()));
+			writer.writeDouble(emc.x);
+			writer.writeDouble(emc.y);
+			writer.writeDouble(emc.z);
+			writer.writeString(route ? route->getCostId() : "");
+			writer.write32(route ? route->getWalkedLength() : 0);
+
+			Path path;
+			if (route) {
+				path = route->getPath();
+			}
+			writer.write32(static_cast<uint32_t>(path.size()));
+			for (Path::const_iterator it = path.begin(); it != path.end(); ++it) {
+				ModelCoordinate mc = it->getLayerCoordinates();
+				writer.write32(getLayerIndex(layers, it->getLayer()));
+				writer.writeInt32(mc.x);
+				writer.writeInt32(mc.y);
+				writer.writeInt32(mc.z);
+			}
+		}
+
+		void writeInstance(BinaryWriter& writer, const LayerIndexMap& layers, const InstanceIndexMap& instances, Instance* instance) {
+			Object* obj = instance->getObject();
+			writer.writeString(instance->getId());
+			writer.writeString(obj->getNamespace());
+			writer.writeString(obj->getId());
+
+			ExactModelCoordinate emc = instance->getLocationRef().getExactLayerCoordinates();
+			writer.writeDouble(emc.x);
+			writer.writeDouble(emc.y);
+			writer.writeDouble(emc.z);
+			writer.writeInt32(instance->getRotation());
+
+			InstanceVisual* visual = instance->getVisual<InstanceVisual>();
+			uint8_t flags = 0;
+			if (instance->isBlocking()) {
+				flags |= MapSnapshot::INSTANCE_BLOCKING;
+			}
+			if (instance->isOverrideBlocking()) {
+				flags |= MapSnapshot::INSTANCE_OVERRIDE_BLOCKING;
+			}
+			if (instance->isSpecialCost()) {
+				flags |= MapSnapshot::INSTANCE_SPECIAL_COST;
+			}
+			if (!visual || visual->isVisible()) {
+				flags |= MapSnapshot::INSTANCE_VISIBLE;
+			}
+			if (instance->getCurrentAction()) {
+				flags |= MapSnapshot::INSTANCE_ACTION;
+			}
+			writer.write8(flags);
+			writer.write8(instance->getCellStackPosition());
+			writer.writeInt32(visual ? visual->getStackPosition() : 0);
+			writer.write8(visual ? visual->getTransparency() : 0);
+			writer.writeFloat(instance->getTimeMultiplier());
+
+			if (flags & MapSnapshot::INSTANCE_SPECIAL_COST) {
+				writer.writeString(instance->getCostId());
+				writer.writeDouble(instance->getCost());
+			}
+			if (flags & MapSnapshot::INSTANCE_ACTION) {
+				writeAction(writer, layers, instances, instance);
+			}
+		}
+
+		void writeCellCache(BinaryWriter& writer, const LayerIndexMap& layers, Layer* layer, CellCache* cache) {
+			writer.write32(getLayerIndex(layers, layer));
+			writer.writeDouble(cache->getDefaultCostMultiplier());
+			writer.writeDouble(cache->getDefaultSpeedMultiplier());
+			writer.write8(cache->isSearchNarrowCells() ? 1 : 0);
+
+			std::list<std::string> costs = cache->getCosts();
+			writer.write32(static_cast<uint32_t>(costs.size()));
+			for (std::list<std::string>::iterator it = costs.begin(); it != costs.end(); ++it) {
+				writer.writeString(*it);
+				writer.writeDouble(cache->getCost(*it));
+				std::vector<Cell*> cells = cache->getCostCells(*it);
+				writer.write32(static_cast<uint32_t>(cells.size()));
+				for (std::vector<Cell*>::iterator cit = cells.begin(); cit != cells.end(); ++cit) {
+					writeCell(writer, *cit);
+				}
+			}
+
+			// areas that come from objects are recreated with the instances
+			std::vector<std::string> areas = cache->getAreas();
+			writer.write32(static_cast<uint32_t>(areas.size()));
+			for (std::vector<std::string>::iterator it = areas.begin(); it != areas.end(); ++it) {
+				std::vector<Cell*> cells = cache->getAreaCells(*it);
+				std::vector<Cell*> cellAreaCells;
+				for (std::vector<Cell*>::iterator cit = cells.begin(); cit != cells.end(); ++cit) {
+					bool objectArea = false;
+					const CellInstances& cellInstances = (*cit)->getInstances();
+					for (CellInstances::const_iterator iit = cellInstances.begin(); iit != cellInstances.end(); ++iit) {
+						if ((*iit)->getObject()->getArea() == *it) {
+							objectArea = true;
+							break;
+						}
+					}
+					if (!objectArea) {
+						cellAreaCells.push_back(*cit);
+					}
+				}
+				writer.writeString(*it);
+				writer.write32(static_cast<uint32_t>(cellAreaCells.size()));
+				for (std::vector<Cell*>::iterator cit = cellAreaCells.begin(); cit != cellAreaCells.end(); ++cit) {
+					writeCell(writer, *cit);
+				}
+			}
+
+			// collect the cells that differ from the defaults
+			const std::set<Cell*>& narrowCells = cache->getNarrowCells();
+			std::vector<std::pair<Cell*, uint8_t> > modified;
+			const std::vector<Cell*>& cells = cache->getCells();
+			for (std::vector<Cell*>::const_iterator cit = cells.begin(); cit != cells.end(); ++cit) {
+				Cell* cell = *cit;
+				uint8_t flags = 0;
+				if (!cell->defaultCost()) {
+					flags |= MapSnapshot::CELL_COST_MULTIPLIER;
+				}
+				if (!cell->defaultSpeed()) {
+					flags |= MapSnapshot::CELL_SPEED_MULTIPLIER;
+				}
+				if (narrowCells.find(cell) != narrowCells.end()) {
+					flags |= MapSnapshot::CELL_NARROW;
+				}
+				if (cell->getTransition()) {
+					flags |= MapSnapshot::CELL_TRANSITION;
+				}
+				CellTypeInfo cti = cell->getCellType();
+				if (cti == CTYPE_CELL_NO_BLOCKER || cti == CTYPE_CELL_BLOCKER) {
+					flags |= MapSnapshot::CELL_TYPE;
+				}
+				if (flags != 0) {
+					modified.push_back(std::make_pair(cell, flags));
+				}
+			}
+
+			writer.write32(static_cast<uint32_t>(modified.size()));
+			for (std::vector<std::pair<Cell*, uint8_t> >::iterator it = modified.begin(); it != modified.end(); ++it) {
+				Cell* cell = it->first;
+				uint8_t flags = it->second;
+				writeCell(writer, cell);
+				writer.write8(flags);
+				if (flags & MapSnapshot::CELL_COST_MULTIPLIER) {
+					writer.writeDouble(cell->getCostMultiplier());
+				}
+				if (flags & MapSnapshot::CELL_SPEED_MULTIPLIER) {
+					writer.writeDouble(cell->getSpeedMultiplier());
+				}
+				if (flags & MapSnapshot::CELL_TRANSITION) {
+					TransitionInfo* transition = cell->getTransition();
+					writer.write32(getLayerIndex(layers, transition->m_layer));
+					writer.writeInt32(transition->m_mc.x);
+					writer.writeInt32(transition->m_mc.y);
+					writer.writeInt32(transition->m_mc.z);
+					writer.write8(transition->m_immediate ? 1 : 0);
+				}
+				if (flags & MapSnapshot::CELL_TYPE) {
+					writer.write8(static_cast<uint8_t>(cell->getCellType()));
+				}
+			}
+		}
+
+		void writeTrigger(BinaryWriter& writer, const LayerIndexMap& layers, const InstanceIndexMap& instances, Trigger* trigger) {
+			writer.writeString(trigger->getName());
+			uint8_t flags = 0;
+			if (trigger->isTriggered()) {
+				flags |= MapSnapshot::TRIGGER_TRIGGERED;
+			}
+			if (trigger->isEnabledForAllInstances()) {
+				flags |= MapSnapshot::TRIGGER_ALL_INSTANCES;
+			}
+			if (trigger->getAttached()) {
+				flags |= MapSnapshot::TRIGGER_ATTACHED;
+			}
+			writer.write8(flags);
+			if (flags & MapSnapshot::TRIGGER_ATTACHED) {
+				writeInstanceRef(writer, instances, trigger->getAttached());
+			}
+
+			const std::vector<TriggerCondition>& conditions = trigger->getTriggerConditions();
+			writer.write32(static_cast<uint32_t>(conditions.size()));
+			for (std::vector<TriggerCondition>::const_iterator it = conditions.begin(); it != conditions.end(); ++it) {
+				writer.writeInt32(static_cast<int32_t>(*it));
+			}
+
+			const std::vector<Cell*>& cells = trigger->getAssignedCells();
+			writer.write32(static_cast<uint32_t>(cells.size()));
+			for (std::vector<Cell*>::const_iterator it = cells.begin(); it != cells.end(); ++it) {
+				writer.write32(getLayerIndex(layers, (*it)->getLayer()));
+				writeCell(writer, *it);
+			}
+
+			const std::vector<Instance*>& enabled = trigger->getEnabledInstances();
+			writer.write32(static_cast<uint32_t>(enabled.size()));
+			for (std::vector<Instance*>::const_iterator it = enabled.begin(); it != enabled.end(); ++it) {
+				writeInstanceRef(writer, instances, *it);
+			}
+		}
+	}
+
+	MapSnapshotSaver::MapSnapshotSaver() {
+	}
+
+	MapSnapshotSaver::~MapSnapshotSaver() {
+	}
+
+	void MapSnapshotSaver::save(const Map& map, const std::string& filename) {
+		const std::list<Layer*>& layers = map.getLayers();
+
+		// layers and instances are referenced by index
+		LayerIndexMap layerIndices;
+		InstanceIndexMap instanceIndices;
+		uint32_t layerIndex = 0;
+		for (std::list<Layer*>::const_iterator it = layers.begin(); it != layers.end(); ++it, ++layerIndex) {
+			layerIndices[*it] = layerIndex;
+			uint32_t instanceIndex = 0;
+			const std::vector<Instance*>& instances = (*it)->getInstances();
+			for (std::vector<Instance*>::const_iterator iit = instances.begin(); iit != instances.end(); ++iit) {
+				// parts of multi objects are created by their main instance
+				if ((*iit)->getObject()->isMultiPart()) {
+					continue;
+				}
+				instanceIndices[*iit] = std::make_pair(layerIndex, instanceIndex++);
+			}
+		}
+
+		BinaryWriter writer(filename);
+		writer.writeBytes(reinterpret_cast<const uint8_t*>(MapSnapshot::MAGIC), sizeof(MapSnapshot::MAGIC));
+		writer.write32(MapSnapshot::VERSION);
+		writer.writeString(map.getId());
+		writer.writeFloat(map.getTimeMultiplier());
+
+		writer.write32(static_cast<uint32_t>(layers.size()));
+		for (std::list<Layer*>::const_iterator it = layers.begin(); it != layers.end(); ++it) {
+			writer.writeString((*it)->getId());
+		}
+
+		uint32_t instanceCount = 0;
+		for (std::list<Layer*>::const_iterator it = layers.begin(); it != layers.end(); ++it) {
+			const std::vector<Instance*>& instances = (*it)->getInstances();
+			std::vector<Instance*> saved;
+			saved.reserve(instances.size());
+			for (std::vector<Instance*>::const_iterator iit = instances.begin(); iit != instances.end(); ++iit) {
+				if (!(*iit)->getObject()->isMultiPart()) {
+					saved.push_back(*iit);
+				}
+			}
+			writer.write32(static_cast<uint32_t>(saved.size()));
+			for (std::vector<Instance*>::iterator iit = saved.begin(); iit != saved.end(); ++iit) {
+				writeInstance(writer, layerIndices, instanceIndices, *iit);
+			}
+			instanceCount += static_cast<uint32_t>(saved.size());
+		}
+
+		std::vector<Layer*> cacheLayers;
+		for (std::list<Layer*>::const_iterator it = layers.begin(); it != layers.end(); ++it) {
+			if ((*it)->getCellCache()) {
+				cacheLayers.push_back(*it);
+			}
+		}
+		writer.write32(static_cast<uint32_t>(cacheLayers.size()));
+		for (std::vector<Layer*>::iterator it = cacheLayers.begin(); it != cacheLayers.end(); ++it) {
+			writeCellCache(writer, layerIndices, *it, (*it)->getCellCache());
+		}
+
+		std::vector<Trigger*> triggers = map.getTriggerController()->getAllTriggers();
+		writer.write32(static_cast<uint32_t>(triggers.size()));
+		for (std::vector<Trigger*>::iterator it = triggers.begin(); it != triggers.end(); ++it) {
+			writeTrigger(writer, layerIndices, instanceIndices, *it);
+		}
+
+		writer.write32(MapSnapshot::SNAPSHOT_END);
+		writer.flush();
+
+		FL_LOG(_log, LMsg("saved snapshot of map ") << map.getId() << " with " << instanceCount << " instances, "
+			<< writer.getPosition() << " bytes");
+	}
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MAPSNAPSHOTSAVER_H_
+#define FIFE_MAPSNAPSHOTSAVER_H_
+
+// Standard C++ library includes
+#include <string>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+namespace FIFE {
+	class Map;
+
+	/** Writes the runtime state of a map into a binary snapshot.
+	 *
+	 * In contrast to MapSaver this is meant for save games, not for map authoring.
+	 * The snapshot contains the instances with their current actions and routes,
+	 * the cellcache costs, areas, transitions and cell types, the triggers and the
+	 * time multipliers. The map itself, its layers and the objects must already
+	 * exist when the snapshot is loaded by MapSnapshotLoader.
+	 *
+	 * Listeners, say texts and cameras are not part of the snapshot.
+	 */
+	class MapSnapshotSaver {
+	public:
+		/** Constructor
+		 */
+		MapSnapshotSaver();
+
+		/** Destructor
+		 */
+		~MapSnapshotSaver();
+
+		/** Saves the runtime state of the map.
+		 * @param map The map to save.
+		 * @param filename The file to write, an existing file is overwritten.
+		 * @throws CannotOpenFile
+		 */
+		void save(const Map& map, const std::string& filename);
+	};
+}
+
+#endif
@@ -30,5 +30,5 @@
 #include "fifeclass.h"
 
 namespace FIFE {
-	fifeid_t FifeClass::m_curid = 0;
+	std::atomic<fifeid_t> FifeClass::m_curid(0);
 }//FIFE
@@ -23,6 +23,7 @@
 #define FIFE_CLASS_H
 
 // Standard C++ library includes
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 
@@ -51,7 +52,8 @@ namespace FIFE {
 
 	private:
 		fifeid_t m_fifeid;
-		static fifeid_t m_curid;
+		// atomic, instances may be created while maps update in parallel
+		static std::atomic<fifeid_t> m_curid;
 	};
 }
 
@@ -21,6 +21,7 @@
 
 // Standard C++ library includes
 #include <cstdio>
+#include <ostream>
 
 // FIFE includes
 // These includes are split up in two parts, separated by one empty line
@@ -78,4 +79,21 @@ namespace FIFE {
 
 		return tokens;
 	}
+
+	void writeJsonString(std::ostream& out, const std::string& value) {
+		out << '"';
+		for (std::string::const_iterator it = value.begin(); it != value.end(); ++it) {
+			unsigned char c = static_cast<unsigned char>(*it);
+			if (c == '"' || c == '\\') {
+				out << '\\' << *it;
+			} else if (c < 0x20) {
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				out << buffer;
+			} else {
+				out << *it;
+			}
+		}
+		out << '"';
+	}
 }
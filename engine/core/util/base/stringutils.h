@@ -23,6 +23,7 @@
 #define FIFE_STRINGUTILS_H_
 
 // Standard C++ library includes
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,10 @@ namespace FIFE {
 	typedef std::vector<int32_t> IntVector;
 	int makeInt32(const std::string& str);
 	IntVector tokenize(const std::string& str, char delim, char group = 0);
+
+	/** Writes the value as quoted json string, quotes, backslashes and control characters are escaped.
+	 */
+	void writeJsonString(std::ostream& out, const std::string& value);
 }
 
 #endif
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "workerpool.h"
+
+namespace FIFE {
+
+	WorkerPool::WorkerPool(uint32_t threads):
+		m_task(NULL),
+		m_taskCount(0),
+		m_nextIndex(0),
+		m_busyWorkers(0),
+		m_batch(0),
+		m_quit(false) {
+
+		if (threads == 0) {
+			uint32_t hardware = std::thread::hardware_concurrency();
+			threads = hardware > 1 ? hardware - 1 : 1;
+		}
+		m_threads.reserve(threads);
+		for (uint32_t i = 0; i < threads; ++i) {
+			m_threads.push_back(std::thread(&WorkerPool::workerLoop, this));
+		}
+	}
+
+	WorkerPool::~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_wakeCondition.notify_all();
+		std::vector<std::thread>::iterator it = m_threads.begin();
+		for (; it != m_threads.end(); ++it) {
+			it->join();
+		}
+	}
+
+	uint32_t WorkerPool::getThreadCount() const {
+		return static_cast<uint32_t>(m_threads.size());
+	}
+
+	void WorkerPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& task) {
+		if (count == 0) {
+			return;
+		}
+		// not worth waking anybody up
+		if (count == 1 || m_threads.empty()) {
+			for (uint32_t i = 0; i < count; ++i) {
+				task(i);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_task = &task;
+			m_taskCount = count;
+			m_nextIndex = 0;
+			m_busyWorkers = static_cast<uint32_t>(m_threads.size());
+			m_exception = std::exception_ptr();
+			++m_batch;
+		}
+		m_wakeCondition.notify_all();
+
+		runTasks();
+
+		std::exception_ptr exception;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_busyWorkers > 0) {
+				m_doneCondition.wait(lock);
+			}
+			m_task = NULL;
+			exception = m_exception;
+			m_exception = std::exception_ptr();
+		}
+		if (exception) {
+			std::rethrow_exception(exception);
+		}
+	}
+
+	void WorkerPool::workerLoop() {
+		uint64_t batch = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (!m_quit && m_batch == batch) {
+					m_wakeCondition.wait(lock);
+				}
+				if (m_quit) {
+					return;
+				}
+				batch = m_batch;
+			}
+
+			runTasks();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_busyWorkers == 0) {
+				m_doneCondition.notify_one();
+			}
+		}
+	}
+
+	void WorkerPool::runTasks() {
+		while (true) {
+			uint32_t index = m_nextIndex++;
+			if (index >= m_taskCount) {
+				break;
+			}
+			try {
+				(*m_task)(index);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_exception) {
+					m_exception = std::current_exception();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_WORKERPOOL_H
+#define FIFE_WORKERPOOL_H
+
+// Standard C++ library includes
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** A small pool of persistent worker threads.
+	 *
+	 * The pool runs batches of independent tasks, see parallelFor(). The calling
+	 * thread takes part in the work, so a pool with N threads runs N+1 tasks at once.
+	 * The threads sleep between batches.
+	 */
+	class WorkerPool {
+	public:
+		/** Constructor
+		 * @param threads Number of worker threads. With 0 the pool uses one thread
+		 * less than the hardware supports, because the calling thread works too.
+		 */
+		explicit WorkerPool(uint32_t threads = 0);
+
+		/** Destructor, joins the worker threads.
+		 */
+		~WorkerPool();
+
+		/** Returns the number of worker threads, without the calling thread.
+		 */
+		uint32_t getThreadCount() const;
+
+		/** Calls task(index) for every index in [0, count) and returns when all calls are done.
+		 * The order in which the tasks run is undefined. The first exception thrown by
+		 * a task is rethrown on the calling thread after the batch has finished.
+		 * Must not be called from inside a task.
+		 */
+		void parallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+
+	private:
+		/** Main loop of a worker thread.
+		 */
+		void workerLoop();
+
+		/** Runs tasks of the current batch until none is left.
+		 */
+		void runTasks();
+
+		//! worker threads
+		std::vector<std::thread> m_threads;
+		//! guards the batch state below
+		std::mutex m_mutex;
+		//! wakes the workers when a batch starts or the pool shuts down
+		std::condition_variable m_wakeCondition;
+		//! wakes the calling thread when all workers are done
+		std::condition_variable m_doneCondition;
+		//! task of the current batch
+		const std::function<void(uint32_t)>* m_task;
+		//! number of tasks in the current batch
+		uint32_t m_taskCount;
+		//! next task index that is handed out
+		std::atomic<uint32_t> m_nextIndex;
+		//! number of workers that still work on the current batch
+		uint32_t m_busyWorkers;
+		//! increased for each batch, so the workers can tell a new batch from a spurious wake up
+		uint64_t m_batch;
+		//! true if the workers should quit
+		bool m_quit;
+		//! first exception thrown by a task of the current batch
+		std::exception_ptr m_exception;
+	};
+}
+
+#endif
@@ -0,0 +1,257 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_OBJECTPOOL_H
+#define FIFE_OBJECTPOOL_H
+
+// Standard C++ library includes
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** Snapshot of the counters of an ObjectPool.
+	 */
+	struct ObjectPoolStats {
+		ObjectPoolStats():
+			used(0),
+			peak(0),
+			capacity(0),
+			chunks(0),
+			chunkSize(0),
+			allocations(0) {
+		}
+
+		//! objects in use
+		uint32_t used;
+		//! highest number of objects in use
+		uint32_t peak;
+		//! objects the pool can hold without growing
+		uint32_t capacity;
+		//! chunks taken from the heap
+		uint32_t chunks;
+		//! objects per chunk
+		uint32_t chunkSize;
+		//! served allocations
+		uint64_t allocations;
+	};
+
+	/** Type specific pool for frequently created and destroyed runtime objects.
+	 *
+	 * Memory is taken from the heap in chunks and handed out slot by slot through
+	 * a free list. Freed slots are kept for reuse, so once the pool has grown to
+	 * the steady state no further heap allocation happens.
+	 * Classes use the pool by forwarding their operator new and delete:
+	 *
+	 * @code
+	 * static void* operator new(std::size_t size) { return ObjectPool<Foo>::instance().allocate(size); }
+	 * static void operator delete(void* ptr, std::size_t size) { ObjectPool<Foo>::instance().deallocate(ptr, size); }
+	 * @endcode
+	 *
+	 * Requests of another size, e.g. from derived classes, are passed to the global operators.
+	 * The pool is guarded by a mutex, since maps may be updated in parallel.
+	 */
+	template<typename T>
+	class ObjectPool {
+	public:
+		/** Returns the pool for the type.
+		 */
+		static ObjectPool<T>& instance() {
+			static ObjectPool<T> pool;
+			return pool;
+		}
+
+		/** Returns memory for one object.
+		 *
+		 * @param size The requested size in bytes.
+		 */
+		void* allocate(std::size_t size) {
+			if (size != sizeof(T)) {
+				return ::operator new(size);
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_free) {
+				grow();
+			}
+			Slot* slot = m_free;
+			m_free = slot->next;
+			++m_allocations;
+			if (++m_used > m_peak) {
+				m_peak = m_used;
+			}
+			return slot;
+		}
+
+		/** Returns the memory of one object to the pool.
+		 *
+		 * @param ptr The memory previously returned by allocate.
+		 * @param size The size that was requested.
+		 */
+		void deallocate(void* ptr, std::size_t size) {
+			if (!ptr) {
+				return;
+			}
+			if (size != sizeof(T)) {
+				::operator delete(ptr);
+				return;
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			assert(m_used > 0);
+			Slot* slot = static_cast<Slot*>(ptr);
+			slot->next = m_free;
+			m_free = slot;
+			--m_used;
+		}
+
+		/** Returns the number of objects that are currently in use.
+		 */
+		uint32_t getUsedCount() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_used;
+		}
+
+		/** Returns the highest number of objects that were in use at the same time.
+		 */
+		uint32_t getPeakCount() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_peak;
+		}
+
+		/** Returns the number of objects the pool can hold without growing.
+		 */
+		uint32_t getCapacity() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_capacity;
+		}
+
+		/** Returns the number of chunks that were taken from the heap.
+		 */
+		uint32_t getChunkCount() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return static_cast<uint32_t>(m_chunks.size());
+		}
+
+		/** Returns the total number of allocations served by the pool.
+		 */
+		uint64_t getAllocationCount() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_allocations;
+		}
+
+		/** Returns all counters, read together under the pool lock.
+		 */
+		ObjectPoolStats getStats() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			ObjectPoolStats stats;
+			stats.used = m_used;
+			stats.peak = m_peak;
+			stats.capacity = m_capacity;
+			stats.chunks = static_cast<uint32_t>(m_chunks.size());
+			stats.chunkSize = m_chunkSize;
+			stats.allocations = m_allocations;
+			return stats;
+		}
+
+		/** Sets the number of objects per chunk, used for the next chunks.
+		 */
+		void setChunkSize(uint32_t size) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_chunkSize = size > 0 ? size : 1;
+		}
+
+		/** Returns the number of objects per chunk.
+		 */
+		uint32_t getChunkSize() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_chunkSize;
+		}
+
+	private:
+		union Slot {
+			Slot* next;
+			typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+		};
+
+		ObjectPool():
+			m_free(0),
+			m_chunkSize(64),
+			m_capacity(0),
+			m_used(0),
+			m_peak(0),
+			m_allocations(0) {
+		}
+
+		~ObjectPool() {
+			// objects that outlive the pool keep their memory
+			if (m_used != 0) {
+				return;
+			}
+			for (typename std::vector<Slot*>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it) {
+				delete[] *it;
+			}
+		}
+
+		ObjectPool(const ObjectPool&);
+		ObjectPool& operator=(const ObjectPool&);
+
+		void grow() {
+			Slot* chunk = new Slot[m_chunkSize];
+			m_chunks.push_back(chunk);
+			m_capacity += m_chunkSize;
+			for (uint32_t i = m_chunkSize; i > 0; --i) {
+				chunk[i - 1].next = m_free;
+				m_free = &chunk[i - 1];
+			}
+		}
+
+		//! first free slot
+		Slot* m_free;
+		//! memory chunks taken from the heap
+		std::vector<Slot*> m_chunks;
+		//! objects per chunk
+		uint32_t m_chunkSize;
+		//! objects in all chunks, chunks can differ in size
+		uint32_t m_capacity;
+		//! objects in use
+		uint32_t m_used;
+		//! highest number of objects in use
+		uint32_t m_peak;
+		//! served allocations
+		uint64_t m_allocations;
+		//! guards the free list and the counters, also taken by the const getters
+		mutable std::mutex m_mutex;
+	};
+
+} // FIFE
+
+#endif
@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "radixsort.h"
+
+namespace FIFE {
+	//! below this size std::stable_sort is faster than the histogram setup
+	static const uint32_t RADIX_SORT_MIN_SIZE = 64;
+	//! number of 8 bit digits of a key: 4 tertiary, 8 secondary and 8 primary
+	static const uint32_t RADIX_SORT_DIGITS = 20;
+
+	static inline uint32_t getDigit(const RadixSortEntry& entry, uint32_t digit) {
+		if (digit < 4) {
+			return (entry.tertiary >> (digit * 8)) & 0xFF;
+		} else if (digit < 12) {
+			return static_cast<uint32_t>(entry.secondary >> ((digit - 4) * 8)) & 0xFF;
+		}
+		return static_cast<uint32_t>(entry.primary >> ((digit - 12) * 8)) & 0xFF;
+	}
+
+	void radixSort(std::vector<RadixSortEntry>& entries, std::vector<RadixSortEntry>& scratch) {
+		const uint32_t count = entries.size();
+		if (count < RADIX_SORT_MIN_SIZE) {
+			std::stable_sort(entries.begin(), entries.end());
+			return;
+		}
+
+		// one pass collects the histograms of all digits
+		std::vector<uint32_t> histograms(RADIX_SORT_DIGITS * 256, 0);
+		for (uint32_t i = 0; i < count; ++i) {
+			const RadixSortEntry& entry = entries[i];
+			uint32_t* histogram = &histograms[0];
+			for (uint32_t digit = 0; digit < RADIX_SORT_DIGITS; ++digit, histogram += 256) {
+				++histogram[getDigit(entry, digit)];
+			}
+		}
+
+		scratch.resize(count);
+		RadixSortEntry* source = &entries[0];
+		RadixSortEntry* target = &scratch[0];
+		for (uint32_t digit = 0; digit < RADIX_SORT_DIGITS; ++digit) {
+			uint32_t* histogram = &histograms[digit * 256];
+			// all entries share this digit, the pass would not change the order
+			if (histogram[getDigit(source[0], digit)] == count) {
+				continue;
+			}
+			uint32_t offset = 0;
+			for (uint32_t i = 0; i < 256; ++i) {
+				uint32_t size = histogram[i];
+				histogram[i] = offset;
+				offset += size;
+			}
+			for (uint32_t i = 0; i < count; ++i) {
+				target[histogram[getDigit(source[i], digit)]++] = source[i];
+			}
+			std::swap(source, target);
+		}
+
+		if (source != &entries[0]) {
+			entries.swap(scratch);
+		}
+	}
+}
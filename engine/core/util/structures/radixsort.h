@@ -0,0 +1,93 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_RADIXSORT_H
+#define FIFE_RADIXSORT_H
+
+// Standard C++ library includes
+#include <cstring>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** Sort key of one item, compared lexicographically from primary to tertiary.
+	 * The index refers to the sorted item and is not part of the key.
+	 */
+	struct RadixSortEntry {
+		//! most significant part of the key
+		uint64_t primary;
+		//! compared if the primary keys are equal
+		uint64_t secondary;
+		//! compared if the primary and secondary keys are equal
+		uint32_t tertiary;
+		//! index of the sorted item
+		uint32_t index;
+	};
+
+	/** Compares the keys of two entries, the index is ignored.
+	 */
+	inline bool operator<(const RadixSortEntry& lhs, const RadixSortEntry& rhs) {
+		if (lhs.primary != rhs.primary) {
+			return lhs.primary < rhs.primary;
+		}
+		if (lhs.secondary != rhs.secondary) {
+			return lhs.secondary < rhs.secondary;
+		}
+		return lhs.tertiary < rhs.tertiary;
+	}
+
+	/** Maps a double to an unsigned key with the same order. 0.0 and -0.0 get the same key.
+	 */
+	inline uint64_t radixKey(double value) {
+		if (value == 0.0) {
+			value = 0.0;
+		}
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+	}
+
+	/** Maps a signed integer to an unsigned key with the same order.
+	 */
+	inline uint32_t radixKey(int32_t value) {
+		return static_cast<uint32_t>(value) ^ 0x80000000U;
+	}
+
+	/** Stable sort of the entries by their keys.
+	 *
+	 * Least significant digit radix sort with 8 bit digits. Digits which are the same
+	 * for all entries are skipped, so unused key parts cost only the histogram pass.
+	 * Small inputs are sorted with std::stable_sort.
+	 * @param entries The entries to sort.
+	 * @param scratch Buffer of the sort, can be kept by the caller to avoid allocations.
+	 */
+	void radixSort(std::vector<RadixSortEntry>& entries, std::vector<RadixSortEntry>& scratch);
+}
+
+#endif
@@ -0,0 +1,157 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_SMALLVECTOR_H
+#define FIFE_SMALLVECTOR_H
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** Vector with room for N elements inside the object itself.
+	 *
+	 * Up to N elements are stored inline, only larger vectors take memory from the heap.
+	 * The inline buffer shares its storage with the heap pointer, so the object is
+	 * N pointers (at least one) plus 8 bytes large.
+	 * Only trivially copyable element types are supported, e.g. pointers.
+	 */
+	template<typename T, uint32_t N>
+	class SmallVector {
+	public:
+		typedef T value_type;
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		SmallVector(): m_size(0), m_capacity(N) {
+		}
+
+		SmallVector(const SmallVector& other): m_size(0), m_capacity(N) {
+			assign(other.begin(), other.end());
+		}
+
+		~SmallVector() {
+			if (isHeap()) {
+				delete[] m_heap;
+			}
+		}
+
+		SmallVector& operator=(const SmallVector& other) {
+			if (this != &other) {
+				m_size = 0;
+				assign(other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		iterator begin() { return data(); }
+		iterator end() { return data() + m_size; }
+		const_iterator begin() const { return data(); }
+		const_iterator end() const { return data() + m_size; }
+
+		uint32_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		uint32_t capacity() const { return m_capacity; }
+
+		T& operator[](uint32_t index) { assert(index < m_size); return data()[index]; }
+		const T& operator[](uint32_t index) const { assert(index < m_size); return data()[index]; }
+
+		T& front() { return (*this)[0]; }
+		T& back() { return (*this)[m_size - 1]; }
+
+		void push_back(const T& value) {
+			if (m_size == m_capacity) {
+				grow(m_capacity * 2);
+			}
+			data()[m_size++] = value;
+		}
+
+		/** Removes the element and keeps the order of the others.
+		 * @return Iterator to the element that followed the removed one.
+		 */
+		iterator erase(iterator it) {
+			assert(it >= begin() && it < end());
+			std::memmove(it, it + 1, (end() - it - 1) * sizeof(T));
+			--m_size;
+			return it;
+		}
+
+		/** Removes all elements, heap memory is kept.
+		 */
+		void clear() {
+			m_size = 0;
+		}
+
+		void reserve(uint32_t capacity) {
+			if (capacity > m_capacity) {
+				grow(capacity);
+			}
+		}
+
+	private:
+		static_assert(std::is_trivially_copyable<T>::value, "SmallVector only supports trivially copyable types");
+
+		bool isHeap() const { return m_capacity > N; }
+
+		T* data() { return isHeap() ? m_heap : m_inline; }
+		const T* data() const { return isHeap() ? m_heap : m_inline; }
+
+		void assign(const_iterator first, const_iterator last) {
+			reserve(static_cast<uint32_t>(last - first));
+			std::copy(first, last, data());
+			m_size = static_cast<uint32_t>(last - first);
+		}
+
+		void grow(uint32_t capacity) {
+			T* heap = new T[capacity];
+			std::copy(begin(), end(), heap);
+			if (isHeap()) {
+				delete[] m_heap;
+			}
+			m_heap = heap;
+			m_capacity = capacity;
+		}
+
+		union {
+			//! inline elements, used while m_capacity is N
+			T m_inline[N];
+			//! heap elements, used when m_capacity is larger than N
+			T* m_heap;
+		};
+		//! number of elements
+		uint32_t m_size;
+		//! number of elements that fit without growing
+		uint32_t m_capacity;
+	};
+}
+
+#endif
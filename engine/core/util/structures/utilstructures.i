@@ -22,6 +22,7 @@
 %{
 #include "util/structures/point.h"
 #include "util/structures/rect.h"
+#include "util/structures/objectpool.h"
 %}
 
 namespace FIFE {
@@ -114,6 +115,16 @@ namespace FIFE {
 	%template(Rect) RectType<int32_t>;
 	%template(FloatRect) RectType<float>;
 	%template(DoubleRect) RectType<double>;
+
+	struct ObjectPoolStats {
+		ObjectPoolStats();
+		uint32_t used;
+		uint32_t peak;
+		uint32_t capacity;
+		uint32_t chunks;
+		uint32_t chunkSize;
+		uint64_t allocations;
+	};
 }
 
 namespace std {
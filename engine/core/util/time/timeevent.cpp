@@ -36,11 +36,18 @@ namespace FIFE {
 
 	TimeEvent::TimeEvent(int32_t period):
 		m_period(period),
-		m_last_updated(TimeManager::instance()->getTime()) {
+		m_last_updated(TimeManager::instance()->getTime()),
+		m_manager(0),
+		m_prev(0),
+		m_next(0),
+		m_list(0),
+		m_fire_time(0) {
 	}
 
 	TimeEvent::~TimeEvent() {
-		return;
+		if (m_manager) {
+			m_manager->unregisterEvent(this);
+		}
 	}
 
 	void TimeEvent::managerUpdateEvent(uint32_t time) {
@@ -55,6 +62,9 @@ namespace FIFE {
 
 	void TimeEvent::setPeriod(int32_t period) {
 		m_period = period;
+		if (m_manager) {
+			m_manager->rescheduleEvent(this);
+		}
 	}
 
 	int32_t TimeEvent::getPeriod() {
@@ -67,6 +77,9 @@ namespace FIFE {
 
 	void TimeEvent::setLastUpdateTime(uint32_t ms) {
 		m_last_updated = ms;
+		if (m_manager) {
+			m_manager->rescheduleEvent(this);
+		}
 	}
 
 
@@ -34,6 +34,8 @@
 
 namespace FIFE {
 
+	class TimeManager;
+
 	/** Interface for events to be registered with TimeManager.
 	*
 	* To register a class with TimeManager firstly derive a class
@@ -95,11 +97,24 @@ namespace FIFE {
 		void setLastUpdateTime(uint32_t ms);
 
     private:
+		friend class TimeManager;
+
 		// The period of the event. See the class description.
 		int32_t m_period;
 
 		// The last time the class was updated.
 		uint32_t m_last_updated;
+
+		// The manager the event is registered with, or 0.
+		TimeManager* m_manager;
+
+		// Intrusive list links, used by the TimeManager.
+		TimeEvent* m_prev;
+		TimeEvent* m_next;
+		TimeEvent** m_list;
+
+		// The time the event is due, used by the TimeManager.
+		uint32_t m_fire_time;
     };
 
 }//FIFE
@@ -20,8 +20,6 @@
  ***************************************************************************/
 
 // Standard C++ library includes
-#include <algorithm>
-#include <cassert>
 
 // 3rd party library includes
 #include <SDL.h>
@@ -42,61 +40,234 @@ namespace FIFE {
 	TimeManager::TimeManager():
 		m_current_time (0),
 		m_time_delta(UNDEFINED_TIME_DELTA),
-		m_average_frame_time(0) {
+		m_average_frame_time(0),
+		m_wheel_time(0),
+		m_event_count(0),
+		m_frame_events(0),
+		m_idle_events(0),
+		m_due_events(0),
+		m_current_event(0) {
+		for (uint32_t level = 0; level < WHEEL_LEVELS; ++level) {
+			for (uint32_t slot = 0; slot < WHEEL_SIZE; ++slot) {
+				m_wheel[level][slot] = 0;
+			}
+		}
 	}
 
 	TimeManager::~TimeManager() {
+		// events can outlive the manager, make sure they don't call back
+		for (uint32_t level = 0; level < WHEEL_LEVELS; ++level) {
+			for (uint32_t slot = 0; slot < WHEEL_SIZE; ++slot) {
+				releaseEvents(m_wheel[level][slot]);
+			}
+		}
+		releaseEvents(m_frame_events);
+		releaseEvents(m_idle_events);
+		releaseEvents(m_due_events);
+		if (m_current_event) {
+			m_current_event->m_manager = 0;
+		}
 	}
 
 	void TimeManager::update() {
+		update(SDL_GetTicks());
+	}
+
+	void TimeManager::update(uint32_t time) {
 		// if first update...
 		double avg_multiplier = 0.985;
 		if (m_current_time == 0) {
-			m_current_time = SDL_GetTicks();
 			avg_multiplier = 0;
 			m_time_delta = 0;
 		} else {
-			m_time_delta = m_current_time;
-			m_current_time = SDL_GetTicks();
-			m_time_delta = m_current_time - m_time_delta;
+			m_time_delta = time - m_current_time;
 		}
+		m_current_time = time;
 		m_average_frame_time = m_average_frame_time * avg_multiplier +
 			double(m_time_delta) * (1.0 - avg_multiplier);
 
-		// Update live events.
+		// Collect the events that are due this frame.
+		advanceWheel(m_current_time);
+		while (m_frame_events) {
+			TimeEvent* event = m_frame_events;
+			unlinkEvent(event);
+			linkEvent(m_due_events, event);
+		}
+
+		// Update due events.
 		//
-		// It is very important to NOT use iterators (over a vector)
-		// here, as an event might add enough events to resize the vector.
-		// -> Ugly segfault
-		for (size_t i = 0; i < m_events_list.size(); ++i) {
-			TimeEvent* event = m_events_list[ i ];
-			if( event ) {
-				event->managerUpdateEvent(m_current_time);
+		// Each event is removed from the due list before it is updated,
+		// so it can register, unregister or even delete other events and
+		// itself. If it is still registered afterwards it is scheduled again.
+		while (m_due_events) {
+			TimeEvent* event = m_due_events;
+			unlinkEvent(event);
+			m_current_event = event;
+			event->managerUpdateEvent(m_current_time);
+			if (m_current_event == event) {
+				m_current_event = 0;
+				scheduleEvent(event);
 			}
 		}
-
-		// Remove dead events
-		std::vector<TimeEvent*>::iterator it;
-		it = std::remove( m_events_list.begin(), m_events_list.end(), static_cast<TimeEvent*>(0));
-		m_events_list.erase( it, m_events_list.end());
+		m_current_event = 0;
 	}
 
 	void TimeManager::registerEvent(TimeEvent* event) {
-		// Register.
-		m_events_list.push_back(event);
+		if (event->m_manager == this) {
+			return;
+		}
+		if (event->m_manager) {
+			event->m_manager->unregisterEvent(event);
+		}
+		event->m_manager = this;
+		++m_event_count;
+		scheduleEvent(event);
 	}
 
 	void TimeManager::unregisterEvent(TimeEvent* event) {
-		// Unregister.
-		for (size_t i = 0; i < m_events_list.size(); ++i) {
-			TimeEvent*& event_i = m_events_list[ i ];
-			if( event_i == event) {
-				event_i = 0;
-				return;
+		if (event->m_manager != this) {
+			return;
+		}
+		if (event == m_current_event) {
+			m_current_event = 0;
+		} else {
+			unlinkEvent(event);
+		}
+		event->m_manager = 0;
+		--m_event_count;
+	}
+
+	void TimeManager::rescheduleEvent(TimeEvent* event) {
+		// the current event is scheduled after its update anyway
+		if (event->m_manager != this || event == m_current_event) {
+			return;
+		}
+		unlinkEvent(event);
+		scheduleEvent(event);
+	}
+
+	void TimeManager::scheduleEvent(TimeEvent* event) {
+		int32_t period = event->getPeriod();
+		if (period < 0) {
+			linkEvent(m_idle_events, event);
+			return;
+		} else if (period == 0) {
+			linkEvent(m_frame_events, event);
+			return;
+		}
+
+		uint32_t fireTime = event->getLastUpdateTime() + static_cast<uint32_t>(period);
+		event->m_fire_time = fireTime;
+		int32_t delta = static_cast<int32_t>(fireTime - m_wheel_time);
+		if (delta <= 0) {
+			linkEvent(m_due_events, event);
+			return;
+		}
+
+		uint32_t level = 0;
+		while (level < WHEEL_LEVELS - 1 && static_cast<uint32_t>(delta) >= (1u << (WHEEL_BITS * (level + 1)))) {
+			++level;
+		}
+		uint32_t slot = (fireTime >> (WHEEL_BITS * level)) & WHEEL_MASK;
+		linkEvent(m_wheel[level][slot], event);
+	}
+
+	void TimeManager::advanceWheel(uint32_t time) {
+		uint32_t gap = time - m_wheel_time;
+		if (static_cast<int32_t>(gap) <= 0) {
+			return;
+		}
+		// long hitches or the first update, cheaper to reschedule everything
+		if (gap >= WHEEL_SIZE * WHEEL_SIZE) {
+			rebuildWheel(time);
+			return;
+		}
+
+		while (m_wheel_time != time) {
+			++m_wheel_time;
+			uint32_t slot = m_wheel_time & WHEEL_MASK;
+			if (slot == 0) {
+				// level 0 wrapped, pull down the next block of events
+				for (uint32_t level = 1; level < WHEEL_LEVELS; ++level) {
+					uint32_t index = (m_wheel_time >> (WHEEL_BITS * level)) & WHEEL_MASK;
+					cascadeWheel(level, index);
+					if (index != 0) {
+						break;
+					}
+				}
+			}
+			while (m_wheel[0][slot]) {
+				TimeEvent* event = m_wheel[0][slot];
+				unlinkEvent(event);
+				linkEvent(m_due_events, event);
 			}
 		}
 	}
 
+	void TimeManager::cascadeWheel(uint32_t level, uint32_t slot) {
+		TimeEvent*& list = m_wheel[level][slot];
+		while (list) {
+			TimeEvent* event = list;
+			unlinkEvent(event);
+			scheduleEvent(event);
+		}
+	}
+
+	void TimeManager::rebuildWheel(uint32_t time) {
+		TimeEvent* events = 0;
+		for (uint32_t level = 0; level < WHEEL_LEVELS; ++level) {
+			for (uint32_t slot = 0; slot < WHEEL_SIZE; ++slot) {
+				TimeEvent*& list = m_wheel[level][slot];
+				while (list) {
+					TimeEvent* event = list;
+					unlinkEvent(event);
+					linkEvent(events, event);
+				}
+			}
+		}
+		m_wheel_time = time;
+		while (events) {
+			TimeEvent* event = events;
+			unlinkEvent(event);
+			scheduleEvent(event);
+		}
+	}
+
+	void TimeManager::linkEvent(TimeEvent*& list, TimeEvent* event) {
+		event->m_prev = 0;
+		event->m_next = list;
+		event->m_list = &list;
+		if (list) {
+			list->m_prev = event;
+		}
+		list = event;
+	}
+
+	void TimeManager::unlinkEvent(TimeEvent* event) {
+		if (!event->m_list) {
+			return;
+		}
+		if (event->m_prev) {
+			event->m_prev->m_next = event->m_next;
+		} else {
+			*event->m_list = event->m_next;
+		}
+		if (event->m_next) {
+			event->m_next->m_prev = event->m_prev;
+		}
+		event->m_prev = 0;
+		event->m_next = 0;
+		event->m_list = 0;
+	}
+
+	void TimeManager::releaseEvents(TimeEvent*& list) {
+		while (list) {
+			TimeEvent* event = list;
+			unlinkEvent(event);
+			event->m_manager = 0;
+		}
+	}
+
 	uint32_t TimeManager::getTime() const {
 		return m_current_time;
 	}
@@ -110,9 +281,7 @@ namespace FIFE {
 	}
 
 	void TimeManager::printStatistics() const {
-		FL_LOG(_log, LMsg("Timers: ") << m_events_list.size());
+		FL_LOG(_log, LMsg("Timers: ") << m_event_count);
 	}
 
 } //FIFE
-
-
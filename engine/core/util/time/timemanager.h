@@ -23,7 +23,6 @@
 #define FIFE_TIMEMANAGER_H
 
 // Standard C++ library includes
-#include <vector>
 
 // 3rd party library includes
 
@@ -45,6 +44,13 @@ namespace FIFE {
 	 * Users of this class will have to manually register and
 	 * unregister events.
 	 *
+	 * Periodic events are kept in a hierarchical timing wheel keyed
+	 * by their next fire time, so an update only touches the events
+	 * that are due. Events with period 0 are kept in a separate list
+	 * and updated every frame, events with a negative period are
+	 * never updated. Registration and unregistration are O(1) and
+	 * may happen from within TimeEvent::updateEvent().
+	 *
 	 * @see TimeEvent
 	 */
 	class TimeManager : public DynamicSingleton<TimeManager> {
@@ -61,6 +67,14 @@ namespace FIFE {
 		 */
 		void update();
 
+		/** Updates the timer objects and events to the given time.
+		 *
+		 * Same as update(), but the time is given by the caller instead of
+		 * taken from SDL, e.g. to step the time in tests.
+		 * @param time The current time in milliseconds, must not go back.
+		 */
+		void update(uint32_t time);
+
 		/** Adds a TimeEvent.
 		 *
 		 * The event will be updated regularly, depending on its settings.
@@ -75,6 +89,13 @@ namespace FIFE {
 		 */
 		void unregisterEvent(TimeEvent* event);
 
+		/** Called by TimeEvent if its period or last update time changed.
+		 *
+		 * Moves the event to the wheel slot matching its new fire time.
+		 * @param event The registered TimeEvent object.
+		 */
+		void rescheduleEvent(TimeEvent* event);
+
 		/** Get the time.
 		 *
 		 * @return The time in milliseconds.
@@ -98,6 +119,45 @@ namespace FIFE {
 		void printStatistics() const;
 
 	private:
+		/// Number of bits per wheel level.
+		static const uint32_t WHEEL_BITS = 8;
+		/// Number of slots per wheel level.
+		static const uint32_t WHEEL_SIZE = 1 << WHEEL_BITS;
+		/// Mask for the slot index of a wheel level.
+		static const uint32_t WHEEL_MASK = WHEEL_SIZE - 1;
+		/// Number of wheel levels, together they cover the whole 32bit time range.
+		static const uint32_t WHEEL_LEVELS = 4;
+
+		/** Puts the event into the list that matches its period and fire time.
+		 */
+		void scheduleEvent(TimeEvent* event);
+
+		/** Advances the wheel tick by tick up to the given time and
+		 * moves all expired events into the due list.
+		 */
+		void advanceWheel(uint32_t time);
+
+		/** Redistributes all events of a slot to the lower levels.
+		 */
+		void cascadeWheel(uint32_t level, uint32_t slot);
+
+		/** Sets the wheel to the given time and reschedules all events.
+		 * Used if the time gap is too big to advance tick by tick.
+		 */
+		void rebuildWheel(uint32_t time);
+
+		/** Adds the event to the front of the list.
+		 */
+		static void linkEvent(TimeEvent*& list, TimeEvent* event);
+
+		/** Removes the event from the list it is linked into.
+		 */
+		static void unlinkEvent(TimeEvent* event);
+
+		/** Detaches all events of the list from this manager.
+		 */
+		static void releaseEvents(TimeEvent*& list);
+
 		/// Current time in milliseconds.
 		uint32_t m_current_time;
 		/// Time since last frame in milliseconds.
@@ -105,8 +165,21 @@ namespace FIFE {
 		/// Average frame time in milliseconds.
 		double m_average_frame_time;
 
-		/// List of active TimeEvents.
-		std::vector<TimeEvent*> m_events_list;
+		/// Time up to which the wheel was advanced.
+		uint32_t m_wheel_time;
+		/// Number of registered TimeEvents.
+		uint32_t m_event_count;
+
+		/// Wheel slots containing the periodic TimeEvents.
+		TimeEvent* m_wheel[WHEEL_LEVELS][WHEEL_SIZE];
+		/// TimeEvents that are updated every frame.
+		TimeEvent* m_frame_events;
+		/// TimeEvents that are never updated.
+		TimeEvent* m_idle_events;
+		/// TimeEvents that have to be updated this frame.
+		TimeEvent* m_due_events;
+		/// TimeEvent that is currently updated.
+		TimeEvent* m_current_event;
 	};
 
 }//FIFE
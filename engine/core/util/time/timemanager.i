@@ -31,6 +31,7 @@ namespace FIFE {
 		TimeManager();
 		virtual ~TimeManager();
 		void update();
+		void update(uint32_t time);
 		uint32_t getTime() const;
 		uint32_t getTimeDelta() const;
 		double getAverageFrameTime() const;
@@ -0,0 +1,252 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cstring>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+
+#include "binarystream.h"
+#include "rawdata.h"
+
+namespace FIFE {
+	// size of the read and write buffers
+	static const uint32_t BUFFER_SIZE = 64 * 1024;
+
+	BinaryReader::BinaryReader(RawData* data):
+		m_data(data),
+		m_block(0),
+		m_bufferPos(0),
+		m_bufferEnd(0),
+		m_dataPos(data->getCurrentIndex()) {
+		const uint8_t* memory = data->getMemory();
+		if (memory) {
+			// the whole data is the buffer
+			m_block = memory + m_dataPos;
+			m_bufferEnd = data->getDataLength() - m_dataPos;
+		} else {
+			m_buffer.resize(BUFFER_SIZE);
+			m_block = &m_buffer[0];
+		}
+	}
+
+	void BinaryReader::fill(uint32_t len) {
+		if (m_buffer.empty()) {
+			// reading from memory, there is nothing more
+			throw IndexOverflow(__FUNCTION__);
+		}
+		// keep the unread rest
+		uint32_t rest = m_bufferEnd - m_bufferPos;
+		if (rest > 0) {
+			std::memmove(&m_buffer[0], &m_buffer[m_bufferPos], rest);
+		}
+		m_dataPos += m_bufferPos;
+		m_bufferPos = 0;
+		m_bufferEnd = rest;
+
+		uint32_t available = m_data->getDataLength() - m_data->getCurrentIndex();
+		if (rest + available < len) {
+			throw IndexOverflow(__FUNCTION__);
+		}
+		if (m_buffer.size() < len) {
+			m_buffer.resize(len);
+			m_block = &m_buffer[0];
+		}
+		uint32_t count = std::min(available, static_cast<uint32_t>(m_buffer.size()) - rest);
+		m_data->readInto(&m_buffer[rest], count);
+		m_bufferEnd += count;
+	}
+
+	void BinaryReader::readInto(uint8_t* buffer, uint32_t len) {
+		if (m_bufferEnd - m_bufferPos < len) {
+			fill(len);
+		}
+		std::memcpy(buffer, m_block + m_bufferPos, len);
+		m_bufferPos += len;
+	}
+
+	uint8_t BinaryReader::read8() {
+		if (m_bufferPos == m_bufferEnd) {
+			fill(1);
+		}
+		return m_block[m_bufferPos++];
+	}
+
+	uint16_t BinaryReader::read16() {
+		uint8_t b[2];
+		readInto(b, 2);
+		return static_cast<uint16_t>(b[0] | (b[1] << 8));
+	}
+
+	uint32_t BinaryReader::read32() {
+		uint8_t b[4];
+		readInto(b, 4);
+		return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+			(static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+	}
+
+	uint64_t BinaryReader::read64() {
+		uint64_t low = read32();
+		uint64_t high = read32();
+		return low | (high << 32);
+	}
+
+	int32_t BinaryReader::readInt32() {
+		return static_cast<int32_t>(read32());
+	}
+
+	float BinaryReader::readFloat() {
+		uint32_t bits = read32();
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	double BinaryReader::readDouble() {
+		uint64_t bits = read64();
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	std::string BinaryReader::readString() {
+		uint32_t len = read32();
+		if (len == 0) {
+			return std::string();
+		}
+		if (m_bufferEnd - m_bufferPos < len) {
+			fill(len);
+		}
+		std::string value(reinterpret_cast<const char*>(m_block + m_bufferPos), len);
+		m_bufferPos += len;
+		return value;
+	}
+
+	uint32_t BinaryReader::getPosition() const {
+		return m_dataPos + m_bufferPos;
+	}
+
+	void BinaryReader::skip(uint32_t len) {
+		if (m_bufferEnd - m_bufferPos < len) {
+			fill(len);
+		}
+		m_bufferPos += len;
+	}
+
+	BinaryWriter::BinaryWriter(const std::string& filename):
+		m_filename(filename),
+		m_file(0),
+		m_written(0) {
+		#if defined(_MSC_VER) && (_MSC_VER >= 1400 )
+			m_file = _fsopen(filename.c_str(), "wb", _SH_DENYNO);
+		#else
+			m_file = fopen(filename.c_str(), "wb");
+		#endif
+		if (!m_file) {
+			throw CannotOpenFile(filename);
+		}
+		m_buffer.reserve(BUFFER_SIZE);
+	}
+
+	BinaryWriter::~BinaryWriter() {
+		try {
+			flush();
+		} catch (const CannotOpenFile&) {
+			// nothing we can do in the destructor
+		}
+		fclose(m_file);
+	}
+
+	void BinaryWriter::write8(uint8_t value) {
+		if (m_buffer.size() >= BUFFER_SIZE) {
+			flush();
+		}
+		m_buffer.push_back(value);
+	}
+
+	void BinaryWriter::write16(uint16_t value) {
+		uint8_t b[2] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) };
+		writeBytes(b, 2);
+	}
+
+	void BinaryWriter::write32(uint32_t value) {
+		uint8_t b[4] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+			static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) };
+		writeBytes(b, 4);
+	}
+
+	void BinaryWriter::write64(uint64_t value) {
+		write32(static_cast<uint32_t>(value));
+		write32(static_cast<uint32_t>(value >> 32));
+	}
+
+	void BinaryWriter::writeInt32(int32_t value) {
+		write32(static_cast<uint32_t>(value));
+	}
+
+	void BinaryWriter::writeFloat(float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		write32(bits);
+	}
+
+	void BinaryWriter::writeDouble(double value) {
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		write64(bits);
+	}
+
+	void BinaryWriter::writeString(const std::string& value) {
+		write32(static_cast<uint32_t>(value.size()));
+		writeBytes(reinterpret_cast<const uint8_t*>(value.data()), static_cast<uint32_t>(value.size()));
+	}
+
+	void BinaryWriter::writeBytes(const uint8_t* buffer, uint32_t len) {
+		if (m_buffer.size() + len > BUFFER_SIZE) {
+			flush();
+		}
+		m_buffer.insert(m_buffer.end(), buffer, buffer + len);
+	}
+
+	void BinaryWriter::flush() {
+		if (m_buffer.empty()) {
+			return;
+		}
+		size_t count = fwrite(&m_buffer[0], 1, m_buffer.size(), m_file);
+		m_written += static_cast<uint32_t>(count);
+		bool failed = count != m_buffer.size();
+		m_buffer.clear();
+		if (failed) {
+			throw CannotOpenFile(m_filename);
+		}
+	}
+
+	uint32_t BinaryWriter::getPosition() const {
+		return m_written + static_cast<uint32_t>(m_buffer.size());
+	}
+}
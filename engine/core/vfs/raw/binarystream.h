@@ -0,0 +1,174 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VFS_RAW_BINARYSTREAM_H
+#define FIFE_VFS_RAW_BINARYSTREAM_H
+
+// Standard C++ library includes
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	class RawData;
+
+	/** Buffered reader for little endian binary files.
+	 *
+	 * Reads the RawData in blocks, so the many small reads of a binary format don't
+	 * each go down to the data source. If the data is available in memory, e.g. a
+	 * file opened with VFS::openMapped(), it is read directly without any copy.
+	 * Strings are stored as uint32 length followed by the bytes.
+	 * Counterpart of BinaryWriter.
+	 */
+	class BinaryReader {
+	public:
+		/** Constructor
+		 * @param data The data to read from, it is not owned by the reader.
+		 */
+		BinaryReader(RawData* data);
+
+		/** Reads 1 byte. @throws IndexOverflow at the end of the data */
+		uint8_t read8();
+
+		/** Reads a little endian uint16_t. @throws IndexOverflow */
+		uint16_t read16();
+
+		/** Reads a little endian uint32_t. @throws IndexOverflow */
+		uint32_t read32();
+
+		/** Reads a little endian uint64_t. @throws IndexOverflow */
+		uint64_t read64();
+
+		/** Reads a little endian int32_t. @throws IndexOverflow */
+		int32_t readInt32();
+
+		/** Reads a little endian IEEE float. @throws IndexOverflow */
+		float readFloat();
+
+		/** Reads a little endian IEEE double. @throws IndexOverflow */
+		double readDouble();
+
+		/** Reads a length prefixed string. @throws IndexOverflow */
+		std::string readString();
+
+		/** Reads len bytes into buffer. @throws IndexOverflow */
+		void readInto(uint8_t* buffer, uint32_t len);
+
+		/** Returns the number of bytes that were read.
+		 */
+		uint32_t getPosition() const;
+
+		/** Skips len bytes. @throws IndexOverflow */
+		void skip(uint32_t len);
+
+	private:
+		/** Refills the buffer with at least len bytes.
+		 */
+		void fill(uint32_t len);
+
+		RawData* m_data;
+		std::vector<uint8_t> m_buffer;
+		//! start of the buffer or of the data in memory
+		const uint8_t* m_block;
+		//! read position inside the buffer
+		uint32_t m_bufferPos;
+		//! number of valid bytes inside the buffer
+		uint32_t m_bufferEnd;
+		//! position of the buffer start inside the data
+		uint32_t m_dataPos;
+	};
+
+	/** Buffered writer for little endian binary files.
+	 *
+	 * Data is collected in a buffer and written to the file in blocks.
+	 * Counterpart of BinaryReader.
+	 */
+	class BinaryWriter {
+	public:
+		/** Constructor, opens the file.
+		 * @param filename The file to write, an existing file is overwritten.
+		 * @throws CannotOpenFile
+		 */
+		BinaryWriter(const std::string& filename);
+
+		/** Destructor, flushes and closes the file.
+		 */
+		~BinaryWriter();
+
+		/** Writes 1 byte */
+		void write8(uint8_t value);
+
+		/** Writes a uint16_t as little endian */
+		void write16(uint16_t value);
+
+		/** Writes a uint32_t as little endian */
+		void write32(uint32_t value);
+
+		/** Writes a uint64_t as little endian */
+		void write64(uint64_t value);
+
+		/** Writes a int32_t as little endian */
+		void writeInt32(int32_t value);
+
+		/** Writes a IEEE float as little endian */
+		void writeFloat(float value);
+
+		/** Writes a IEEE double as little endian */
+		void writeDouble(double value);
+
+		/** Writes the string as uint32 length followed by the bytes.
+		 */
+		void writeString(const std::string& value);
+
+		/** Writes len bytes from buffer.
+		 */
+		void writeBytes(const uint8_t* buffer, uint32_t len);
+
+		/** Writes the buffered data to the file.
+		 * @throws CannotOpenFile if the data could not be written
+		 */
+		void flush();
+
+		/** Returns the number of bytes that were written, including the buffered ones.
+		 */
+		uint32_t getPosition() const;
+
+	private:
+		BinaryWriter(const BinaryWriter&);
+		BinaryWriter& operator=(const BinaryWriter&);
+
+		std::string m_filename;
+		FILE* m_file;
+		std::vector<uint8_t> m_buffer;
+		uint32_t m_written;
+	};
+}
+
+#endif
@@ -80,6 +80,10 @@ namespace FIFE {
 		return m_index_current;
 	}
 
+	const uint8_t* RawData::getMemory() const {
+		return m_datasource->getMemory();
+	}
+
 	void RawData::setIndex(uint32_t index) {
 		if (index > getDataLength())
 			throw IndexOverflow(__FUNCTION__);
@@ -72,6 +72,14 @@ namespace FIFE {
 			 */
 			uint32_t getCurrentIndex() const;
 
+			/** get direct access to the complete data
+			 *
+			 * Only available if the data source keeps the data in memory, e.g. for
+			 * memory mapped files. The current index is not used or changed.
+			 * @return the data or NULL
+			 */
+			const uint8_t* getMemory() const;
+
 			/** set the current index
 			 *
 			 * @param index the new index
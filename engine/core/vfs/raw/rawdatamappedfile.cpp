@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstring>
+
+// Platform specific includes
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+
+#include "rawdatamappedfile.h"
+
+namespace FIFE {
+
+#if defined(_WIN32)
+	RawDataMappedFile::RawDataMappedFile(const std::string& file) :
+		m_file(file),
+		m_data(0),
+		m_filesize(0),
+		m_fileHandle(INVALID_HANDLE_VALUE),
+		m_mappingHandle(0) {
+		m_fileHandle = CreateFileA(m_file.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if (m_fileHandle == INVALID_HANDLE_VALUE) {
+			throw CannotOpenFile(m_file);
+		}
+		m_filesize = GetFileSize(m_fileHandle, 0);
+		if (m_filesize == 0) {
+			return;
+		}
+		m_mappingHandle = CreateFileMappingA(m_fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+		if (m_mappingHandle) {
+			m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		}
+		if (!m_data) {
+			if (m_mappingHandle) {
+				CloseHandle(m_mappingHandle);
+			}
+			CloseHandle(m_fileHandle);
+			throw CannotOpenFile(m_file);
+		}
+	}
+
+	RawDataMappedFile::~RawDataMappedFile() {
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+			CloseHandle(m_mappingHandle);
+		}
+		CloseHandle(m_fileHandle);
+	}
+#else
+	RawDataMappedFile::RawDataMappedFile(const std::string& file) :
+		m_file(file),
+		m_data(0),
+		m_filesize(0) {
+		int fd = open(m_file.c_str(), O_RDONLY);
+		if (fd == -1) {
+			throw CannotOpenFile(m_file);
+		}
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			close(fd);
+			throw CannotOpenFile(m_file);
+		}
+		m_filesize = static_cast<uint32_t>(info.st_size);
+		if (m_filesize > 0) {
+			void* data = mmap(0, m_filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				close(fd);
+				throw CannotOpenFile(m_file);
+			}
+			m_data = static_cast<const uint8_t*>(data);
+		}
+		// the mapping stays valid without the descriptor
+		close(fd);
+	}
+
+	RawDataMappedFile::~RawDataMappedFile() {
+		if (m_data) {
+			munmap(const_cast<uint8_t*>(m_data), m_filesize);
+		}
+	}
+#endif
+
+	uint32_t RawDataMappedFile::getSize() const {
+		return m_filesize;
+	}
+
+	void RawDataMappedFile::readInto(uint8_t* buffer, uint32_t start, uint32_t length) {
+		std::memcpy(buffer, m_data + start, length);
+	}
+
+	const uint8_t* RawDataMappedFile::getMemory() const {
+		return m_data;
+	}
+
+}
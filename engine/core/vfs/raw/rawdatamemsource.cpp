@@ -51,4 +51,8 @@ namespace FIFE {
 		return m_data;
 	}
 
+	const uint8_t* RawDataMemSource::getMemory() const {
+		return m_data;
+	}
+
 }
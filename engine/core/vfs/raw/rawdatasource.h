@@ -58,6 +58,12 @@ namespace FIFE {
 			 */
 			virtual void readInto(uint8_t* buffer, uint32_t start, uint32_t length) = 0;
 
+			/** get direct access to the complete data
+			 *
+			 * @return the data if the source keeps it in memory, NULL otherwise
+			 */
+			virtual const uint8_t* getMemory() const;
+
 	};
 
 }
@@ -33,6 +33,7 @@
 // Second block: files included from the same folder
 #include "util/base/exception.h"
 #include "util/log/logger.h"
+#include "vfs/raw/rawdata.h"
 
 #include "vfs.h"
 #include "vfssource.h"
@@ -44,7 +45,7 @@ namespace FIFE {
 	 */
 	static Logger _log(LM_VFS);
 
-	VFS::VFS() : m_sources() {}
+	VFS::VFS() : m_sources(), m_bytesRead(0) {}
 
 	VFS::~VFS() {
 		cleanup();
@@ -176,7 +177,29 @@ namespace FIFE {
 		if (!source)
 			throw NotFound(path);
 
-		return source->open(path);
+		RawData* data = source->open(path);
+		if (data) {
+			m_bytesRead += data->getDataLength();
+		}
+		return data;
+	}
+
+	RawData* VFS::openMapped(const std::string& path) {
+		FL_DBG(_log, LMsg("Mapping: ") << path);
+
+		VFSSource* source = getSourceForFile(path);
+		if (!source)
+			throw NotFound(path);
+
+		RawData* data = source->openMapped(path);
+		if (data) {
+			m_bytesRead += data->getDataLength();
+		}
+		return data;
+	}
+
+	uint64_t VFS::getBytesRead() const {
+		return m_bytesRead;
 	}
 
 	std::set<std::string> VFS::listFiles(const std::string& pathstr) const {
@@ -23,6 +23,7 @@
 #define FIFE_VFS_VFS_H
 
 // Standard C++ library includes
+#include <atomic>
 #include <string>
 #include <vector>
 #include <set>
@@ -34,6 +35,7 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
 #include "util/base/singleton.h"
 
 
@@ -118,6 +120,17 @@ namespace FIFE {
 			 */
 			RawData* open(const std::string& path);
 
+			/** Open a file mapped into memory
+			 *
+			 * Falls back to open() for sources that can not map files, e.g. archives.
+			 * RawData::getMemory() gives direct access to the data in both cases,
+			 * if the source supports it.
+			 * @param path the file to open
+			 * @return the opened file; delete this when done.
+			 * @throws NotFound if the file cannot be found
+			 */
+			RawData* openMapped(const std::string& path);
+
 			/** Get a filelist of the given directory
 			 *
 			 * @param path the directory
@@ -158,6 +171,10 @@ namespace FIFE {
 			 */
 			bool hasSource(const std::string& path) const;
 
+			/** Returns the total size of all files opened through the vfs.
+			 * Used to measure the data read while loading, see LoadProfiler.
+			 */
+			uint64_t getBytesRead() const;
 
 		private:
 			typedef std::vector<VFSSourceProvider*> type_providers;
@@ -166,6 +183,9 @@ namespace FIFE {
 			typedef std::vector<VFSSource*> type_sources;
 			type_sources m_sources;
 
+			//! total size of the opened files, files may be opened from worker threads
+			std::atomic<uint64_t> m_bytesRead;
+
 			std::set<std::string> filterList(const std::set<std::string>& list, const std::string& fregex) const;
 			VFSSource* getSourceForFile(const std::string& file) const;
 	};
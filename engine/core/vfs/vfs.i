@@ -53,6 +53,8 @@ namespace FIFE {
 
 		std::set<std::string> listFiles(const std::string& path) const;
 		std::set<std::string> listDirectories(const std::string& path) const;
+
+		uint64_t getBytesRead() const;
 	};
 }
 
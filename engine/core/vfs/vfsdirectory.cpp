@@ -29,6 +29,7 @@
 // Second block: files included from the same folder
 #include "vfs/raw/rawdata.h"
 #include "vfs/raw/rawdatafile.h"
+#include "vfs/raw/rawdatamappedfile.h"
 #include "util/log/logger.h"
 #include "util/base/exception.h"
 
@@ -68,6 +69,10 @@ namespace FIFE {
 		return new RawData(new RawDataFile(m_root + file));
 	}
 
+	RawData* VFSDirectory::openMapped(const std::string& file) const {
+		return new RawData(new RawDataMappedFile(m_root + file));
+	}
+
 	std::set<std::string> VFSDirectory::listFiles(const std::string& path) const {
 		return list(path, false);
 	}
@@ -61,6 +61,10 @@ namespace FIFE {
 			 * @param filename The file to open.
 			 */
 			virtual RawData* open(const std::string& filename) const;
+			/** Opens a file mapped into memory.
+			 * @param filename The file to open.
+			 */
+			virtual RawData* openMapped(const std::string& filename) const;
 
 			/** List files in a directory
 			 * @param path The directory to list the files in
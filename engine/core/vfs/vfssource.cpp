@@ -40,6 +40,10 @@ namespace FIFE {
 		m_vfs->removeSource(this);
 	}
 
+	RawData* VFSSource::openMapped(const std::string& file) const {
+		return open(file);
+	}
+
 }
 
 std::string FIFE::VFSSource::fixPath(std::string path) const
@@ -67,6 +67,15 @@ namespace FIFE {
 			 */
 			virtual RawData* open(const std::string& file) const = 0;
 
+			/** open a file inside this source mapped into memory
+			 *
+			 * The default implementation just calls open().
+			 * @param file the file to open
+			 * @return a new RawData*
+			 * @throws CannotOpenFile if the file can't be found
+			 */
+			virtual RawData* openMapped(const std::string& file) const;
+
 			/** list all files in a directory of this source
 			 * 
 			 * @param path path to list files in
@@ -56,6 +56,12 @@ namespace FIFE {
 		delete m_zipfile;
 	}
 
+	void ZipSource::readEntry(uint32_t offset, uint8_t* buffer, uint32_t size) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_zipfile->setIndex(offset);
+		m_zipfile->readInto(buffer, size);
+	}
+
 	bool ZipSource::fileExists(const std::string& file) const {
 		bfs::path path(file);
 		return (m_zipTree.getNode(path.string()) != 0);
@@ -70,12 +76,11 @@ namespace FIFE {
 		if (node) {
 			const ZipEntryData& entryData = node->getZipEntryData();
 
-			m_zipfile->setIndex(entryData.offset);
 			uint8_t* data = new uint8_t[entryData.size_real]; // beware of me - one day i WILL cause memory leaks
 			if (entryData.comp == 8) { // compressed using deflate
 				FL_DBG(_log, LMsg("trying to uncompress file ") <<  path << " (compressed with method " << entryData.comp << ")");
 				std::unique_ptr<uint8_t[]> compdata(new uint8_t[entryData.size_comp]);
-				m_zipfile->readInto(compdata.get(), entryData.size_comp);
+				readEntry(entryData.offset, compdata.get(), entryData.size_comp);
 
 				z_stream zstream;
 				zstream.next_in = compdata.get();
@@ -107,7 +112,7 @@ namespace FIFE {
 
 				inflateEnd(&zstream);
 			} else if (entryData.comp == 0) { // uncompressed
-				m_zipfile->readInto(data, entryData.size_real);
+				readEntry(entryData.offset, data, entryData.size_real);
 			} else {
 				FL_ERR(_log, LMsg("unsupported compression"));
 				delete[] data;
@@ -25,6 +25,7 @@
 // Standard C++ library includes
 //
 #include <map>
+#include <mutex>
 
 // 3rd party library includes
 //
@@ -55,15 +56,20 @@ namespace FIFE {
         std::set<std::string> listFiles(const std::string& path) const;
         std::set<std::string> listDirectories(const std::string& path) const;
 
+        /// open may be called from multiple threads, the reads from the archive are serialized.
         virtual RawData* open(const std::string& path) const;
 
     private:
         void readIndex();
         bool readFileToIndex();
+        /// reads size bytes at offset of the archive, serialized by m_mutex
+        void readEntry(uint32_t offset, uint8_t* buffer, uint32_t size) const;
 
     private:
         ZipTree m_zipTree;
 		RawData* m_zipfile;
+		//! guards the read position of m_zipfile
+		mutable std::mutex m_mutex;
 
 	};
 
@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "alphamask.h"
+
+namespace FIFE {
+
+	AlphaMask::AlphaMask():
+		m_width(0),
+		m_height(0),
+		m_stride(0),
+		m_threshold(1) {
+	}
+
+	void AlphaMask::create(SDL_Surface* surface, const Rect& area, uint8_t threshold) {
+		clear();
+		m_threshold = threshold > 0 ? threshold : 1;
+		if (!surface) {
+			return;
+		}
+		Rect region = area;
+		if (!region.intersectInplace(Rect(0, 0, surface->w, surface->h))) {
+			return;
+		}
+		m_width = area.w;
+		m_height = area.h;
+		m_stride = (m_width + 31) >> 5;
+		m_bits.assign(static_cast<size_t>(m_stride) * m_height, 0);
+
+		const SDL_PixelFormat* format = surface->format;
+		const int32_t bpp = format->BytesPerPixel;
+		// 32 bit with alpha channel can be read without SDL_GetRGBA
+		const bool direct = bpp == 4 && format->Amask != 0;
+		SDL_LockSurface(surface);
+		for (int32_t y = region.y; y < region.y + region.h; ++y) {
+			const Uint8* row = static_cast<const Uint8*>(surface->pixels) + y * surface->pitch;
+			uint32_t* bits = &m_bits[(y - area.y) * m_stride];
+			for (int32_t x = region.x; x < region.x + region.w; ++x) {
+				const Uint8* p = row + x * bpp;
+				uint8_t a = 0;
+				if (direct) {
+					Uint32 pixel = *reinterpret_cast<const Uint32*>(p);
+					a = static_cast<uint8_t>(((pixel & format->Amask) >> format->Ashift) << format->Aloss);
+				} else {
+					Uint32 pixel = 0;
+					switch (bpp) {
+						case 1: pixel = *p; break;
+						case 2: pixel = *reinterpret_cast<const Uint16*>(p); break;
+						case 3:
+							if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
+								pixel = p[0] << 16 | p[1] << 8 | p[2];
+							} else {
+								pixel = p[0] | p[1] << 8 | p[2] << 16;
+							}
+							break;
+						default: pixel = *reinterpret_cast<const Uint32*>(p); break;
+					}
+					uint8_t r, g, b;
+					SDL_GetRGBA(pixel, format, &r, &g, &b, &a);
+				}
+				if (a >= m_threshold) {
+					int32_t mx = x - area.x;
+					bits[mx >> 5] |= 1u << (mx & 31);
+				}
+			}
+		}
+		SDL_UnlockSurface(surface);
+	}
+
+	void AlphaMask::clear() {
+		m_bits.clear();
+		m_width = 0;
+		m_height = 0;
+		m_stride = 0;
+	}
+
+	bool AlphaMask::isAnySet(const Rect& rect) const {
+		Rect area = rect;
+		if (!area.intersectInplace(Rect(0, 0, m_width, m_height))) {
+			return false;
+		}
+		const int32_t firstWord = area.x >> 5;
+		const int32_t lastWord = (area.right() - 1) >> 5;
+		// bits of the rect in the first and the last word
+		const uint32_t firstMask = ~0u << (area.x & 31);
+		const uint32_t lastMask = ~0u >> (31 - ((area.right() - 1) & 31));
+		for (int32_t y = area.y; y < area.bottom(); ++y) {
+			const uint32_t* bits = &m_bits[y * m_stride];
+			if (firstWord == lastWord) {
+				if (bits[firstWord] & firstMask & lastMask) {
+					return true;
+				}
+				continue;
+			}
+			if ((bits[firstWord] & firstMask) || (bits[lastWord] & lastMask)) {
+				return true;
+			}
+			for (int32_t w = firstWord + 1; w < lastWord; ++w) {
+				if (bits[w]) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	size_t AlphaMask::getSize() const {
+		return m_bits.size() * sizeof(uint32_t);
+	}
+}
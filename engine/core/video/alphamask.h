@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VIDEO_ALPHAMASK_H
+#define FIFE_VIDEO_ALPHAMASK_H
+
+// Standard C++ library includes
+#include <vector>
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+
+namespace FIFE {
+
+	/** One bit per pixel, set if the alpha of the pixel is at least the threshold.
+	 * Used for hit tests without reading the pixels of the image surface.
+	 */
+	class AlphaMask {
+	public:
+		AlphaMask();
+
+		/** Builds the mask from an area of the surface.
+		 * @param surface The surface to read.
+		 * @param area The area of the surface, e.g. the subimage area of an atlas.
+		 * @param threshold Minimum alpha of a set pixel, at least 1.
+		 */
+		void create(SDL_Surface* surface, const Rect& area, uint8_t threshold);
+
+		/** Removes the mask.
+		 */
+		void clear();
+
+		int32_t getWidth() const { return m_width; }
+		int32_t getHeight() const { return m_height; }
+		uint8_t getThreshold() const { return m_threshold; }
+
+		/** Returns true if the pixel is set, pixels outside of the mask are not set.
+		 */
+		bool isSet(int32_t x, int32_t y) const {
+			if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+				return false;
+			}
+			return (m_bits[y * m_stride + (x >> 5)] >> (x & 31)) & 1;
+		}
+
+		/** Returns true if any pixel of the rect is set.
+		 */
+		bool isAnySet(const Rect& rect) const;
+
+		/** Returns the memory used by the mask in bytes.
+		 */
+		size_t getSize() const;
+
+	private:
+		//! bits of the pixels, rows start at a new word
+		std::vector<uint32_t> m_bits;
+		int32_t m_width;
+		int32_t m_height;
+		//! words per row
+		int32_t m_stride;
+		uint8_t m_threshold;
+	};
+}
+
+#endif
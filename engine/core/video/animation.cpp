@@ -147,6 +147,13 @@ namespace FIFE {
 		return image;
 	}
 
+	Image* Animation::getFrameImage(int32_t index) const {
+		if (isValidIndex(index)) {
+			return m_frames[index].image.get();
+		}
+		return NULL;
+	}
+
 	ImagePtr Animation::getFrameByTimestamp(uint32_t timestamp) {
 		ImagePtr val;
 		if ((static_cast<int32_t>(timestamp) <= m_animation_endtime) && (m_animation_endtime > 0)) {
@@ -88,6 +88,11 @@ namespace FIFE {
 		 */
 		ImagePtr getFrame(int32_t index);
 
+		/** Gets the frame image that matches the given index without loading it and without
+		 * taking a reference, returns 0 if no matches found. Can be called from worker threads.
+		 */
+		Image* getFrameImage(int32_t index) const;
+
 		/** Gets the frame image that matches the given timestamp.
 		 */
 		ImagePtr getFrameByTimestamp(uint32_t timestamp);
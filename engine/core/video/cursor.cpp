@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 
 // 3rd party library includes
 #include <SDL.h>
@@ -239,6 +240,56 @@ namespace FIFE {
 		}
 	}
 
+	void Cursor::updateDirtyArea() {
+		if (!m_renderbackend->isDirtyRectsEnabled()) {
+			return;
+		}
+		int32_t mx = 0;
+		int32_t my = 0;
+		SDL_GetMouseState(&mx, &my);
+
+		Rect area;
+		bool animated = false;
+		ImagePtr img;
+		if (m_drag_type == CURSOR_IMAGE) {
+			img = m_cursor_drag_image;
+		} else if (m_drag_type == CURSOR_ANIMATION) {
+			int32_t animtime = (m_timemanager->getTime() - m_drag_animtime) % m_cursor_drag_animation->getDuration();
+			img = m_cursor_drag_animation->getFrameByTimestamp(animtime);
+			animated = true;
+		}
+		if (img != 0) {
+			area = Rect(mx + m_drag_offset_x + img->getXShift(), my + m_drag_offset_y + img->getYShift(), img->getWidth(), img->getHeight());
+		}
+
+		img.reset();
+		if (!m_native_image_cursor_enabled) {
+			if (m_cursor_type == CURSOR_IMAGE) {
+				img = m_cursor_image;
+			} else if (m_cursor_type == CURSOR_ANIMATION) {
+				int32_t animtime = (m_timemanager->getTime() - m_animtime) % m_cursor_animation->getDuration();
+				img = m_cursor_animation->getFrameByTimestamp(animtime);
+				animated = true;
+			}
+		}
+		if (img != 0) {
+			Rect cursorArea(mx + img->getXShift(), my + img->getYShift(), img->getWidth(), img->getHeight());
+			if (area.w == 0 || area.h == 0) {
+				area = cursorArea;
+			} else {
+				int32_t x = std::min(area.x, cursorArea.x);
+				int32_t y = std::min(area.y, cursorArea.y);
+				area = Rect(x, y, std::max(area.right(), cursorArea.right()) - x, std::max(area.bottom(), cursorArea.bottom()) - y);
+			}
+		}
+
+		if (animated || !(area == m_dirtyArea)) {
+			m_renderbackend->addDirtyRect(m_dirtyArea);
+			m_renderbackend->addDirtyRect(area);
+			m_dirtyArea = area;
+		}
+	}
+
 	uint32_t Cursor::getNativeId(uint32_t cursor_id) {
 		switch (cursor_id) {
 			case NC_ARROW:
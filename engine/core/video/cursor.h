@@ -30,6 +30,7 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/structures/rect.h"
 
 #include "animation.h"
 
@@ -179,6 +180,11 @@ namespace FIFE {
 		 */
 		bool isNativeImageCursorEnabled() const;
 
+		/** Reports the screen area of the cursor to the render backend if it changed.
+		 * Only used in dirty rect mode, has to be called before the frame is drawn.
+		 */
+		void updateDirtyArea();
+
 	protected:
 		/** Sets the cursor to a native type.
 		  * @param cursor_id One of the values in NativeCursor
@@ -227,6 +233,8 @@ namespace FIFE {
 		bool m_invalidated;
 		bool m_native_image_cursor_enabled;
 		ImagePtr m_native_cursor_image;
+		// screen area of the drawn cursor and drag images
+		Rect m_dirtyArea;
 	};
 
 } //FIFE
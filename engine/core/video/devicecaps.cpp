@@ -32,6 +32,9 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/exception.h"
+#ifdef HAVE_OPENGL
+#include "video/opengl/fife_opengl.h"
+#endif
 
 #include "devicecaps.h"
 
@@ -339,4 +342,20 @@ namespace FIFE {
 		return rec;
 	}
 
+	bool DeviceCaps::isVertexBufferStreamingSupported() {
+#ifdef HAVE_OPENGL
+		return GLEW_VERSION_1_5 || GLEW_ARB_vertex_buffer_object;
+#else
+		return false;
+#endif
+	}
+
+	bool DeviceCaps::isBufferRangeMappingSupported() {
+#ifdef HAVE_OPENGL
+		return GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range;
+#else
+		return false;
+#endif
+	}
+
 } //FIFE
@@ -227,6 +227,16 @@ namespace FIFE {
 		 */
 		Rect getDisplayBounds(uint8_t display = 0) const;
 
+		/** Returns true if vertex data can be streamed through OpenGL buffer objects.
+		 * Needs a current OpenGL context, always false without OpenGL support.
+		 */
+		static bool isVertexBufferStreamingSupported();
+
+		/** Returns true if ranges of OpenGL buffer objects can be mapped for writing.
+		 * Needs a current OpenGL context, always false without OpenGL support.
+		 */
+		static bool isBufferRangeMappingSupported();
+
 	private:
 		std::vector<ScreenMode> m_screenModes;
 		std::string m_videoDriverName;
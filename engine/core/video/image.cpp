@@ -21,8 +21,10 @@
 
 // Standard C++ library includes
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 // 3rd party library includes
 #include <SDL.h>
@@ -35,6 +37,7 @@
 #include "loaders/native/video/imageloader.h"
 
 #include "image.h"
+#include "renderbackend.h"
 
 namespace FIFE {
 
@@ -43,7 +46,9 @@ namespace FIFE {
 		m_surface(NULL),
 		m_xshift(0),
 		m_yshift(0),
-		m_shared(false){
+		m_shared(false),
+		m_opaqueSurface(NULL),
+		m_alphaMaskSurface(NULL) {
 	}
 
 	Image::Image(const std::string& name, IResourceLoader* loader):
@@ -51,7 +56,9 @@ namespace FIFE {
 		m_surface(NULL),
 		m_xshift(0),
 		m_yshift(0),
-		m_shared(false){
+		m_shared(false),
+		m_opaqueSurface(NULL),
+		m_alphaMaskSurface(NULL) {
 	}
 
 	Image::Image(SDL_Surface* surface):
@@ -59,7 +66,9 @@ namespace FIFE {
 		m_surface(NULL),
 		m_xshift(0),
 		m_yshift(0),
-		m_shared(false){
+		m_shared(false),
+		m_opaqueSurface(NULL),
+		m_alphaMaskSurface(NULL) {
 		reset(surface);
 	}
 
@@ -68,7 +77,9 @@ namespace FIFE {
 		m_surface(NULL),
 		m_xshift(0),
 		m_yshift(0),
-		m_shared(false){
+		m_shared(false),
+		m_opaqueSurface(NULL),
+		m_alphaMaskSurface(NULL) {
 		reset(surface);
 	}
 
@@ -78,7 +89,9 @@ namespace FIFE {
 		m_surface(NULL),
 		m_xshift(0),
 		m_yshift(0),
-		m_shared(false){
+		m_shared(false),
+		m_opaqueSurface(NULL),
+		m_alphaMaskSurface(NULL) {
 		SDL_Surface* surface = SDL_CreateRGBSurface(0, width,height, 32,
 		                                            RMASK, GMASK, BMASK ,AMASK);
 		SDL_LockSurface(surface);
@@ -95,7 +108,9 @@ namespace FIFE {
 		m_surface(NULL),
 		m_xshift(0),
 		m_yshift(0),
-		m_shared(false) {
+		m_shared(false),
+		m_opaqueSurface(NULL),
+		m_alphaMaskSurface(NULL) {
 		SDL_Surface* surface = SDL_CreateRGBSurface(0, width,height, 32,
 		                                            RMASK, GMASK, BMASK ,AMASK);
 		SDL_LockSurface(surface);
@@ -115,6 +130,9 @@ namespace FIFE {
 		m_xshift = 0;
 		m_yshift = 0;
 		m_surface = surface;
+		m_opaqueSurface = NULL;
+		m_alphaMaskSurface = NULL;
+		m_alphaMask.clear();
 	}
 
 	Image::~Image() {
@@ -130,6 +148,10 @@ namespace FIFE {
 			loader.load(this);
 		}
 		m_state = IResource::RES_LOADED;
+		if (RenderBackend::instance()->isAlphaMasksEnabled()) {
+			Point offset;
+			getAlphaMask(offset);
+		}
 	}
 
 	void Image::free() {
@@ -224,6 +246,57 @@ namespace FIFE {
 		SDL_GetRGBA(pixel, m_surface->format, r, g, b, a);
 	}
 
+	SDL_Surface* Image::createRGBASurface() {
+		const int32_t w = getWidth();
+		const int32_t h = getHeight();
+		if (!m_surface || w <= 0 || h <= 0) {
+			return NULL;
+		}
+		Rect area = m_shared ? m_subimagerect : Rect(0, 0, w, h);
+		SDL_Surface* copy = SDL_CreateRGBSurface(0, w, h, 32, RMASK, GMASK, BMASK, AMASK);
+		if (!copy) {
+			return NULL;
+		}
+		area.intersectInplace(Rect(0, 0, m_surface->w, m_surface->h));
+
+		const SDL_PixelFormat* format = m_surface->format;
+		const bool sameFormat = format->BytesPerPixel == 4 && format->Rmask == RMASK &&
+			format->Gmask == GMASK && format->Bmask == BMASK && format->Amask == AMASK;
+		SDL_LockSurface(m_surface);
+		for (int32_t y = 0; y < area.h; ++y) {
+			const uint8_t* src = static_cast<const uint8_t*>(m_surface->pixels) + (area.y + y) * m_surface->pitch + area.x * format->BytesPerPixel;
+			uint8_t* dst = static_cast<uint8_t*>(copy->pixels) + y * copy->pitch;
+			if (sameFormat) {
+				memcpy(dst, src, area.w * 4);
+				continue;
+			}
+			for (int32_t x = 0; x < area.w; ++x, src += format->BytesPerPixel, dst += 4) {
+				uint32_t pixel = 0;
+				switch (format->BytesPerPixel) {
+				case 1:
+					pixel = *src;
+					break;
+				case 2:
+					pixel = *reinterpret_cast<const Uint16*>(src);
+					break;
+				case 3:
+					if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
+						pixel = src[0] << 16 | src[1] << 8 | src[2];
+					} else {
+						pixel = src[0] | src[1] << 8 | src[2] << 16;
+					}
+					break;
+				default:
+					pixel = *reinterpret_cast<const Uint32*>(src);
+					break;
+				}
+				SDL_GetRGBA(pixel, format, &dst[0], &dst[1], &dst[2], &dst[3]);
+			}
+		}
+		SDL_UnlockSurface(m_surface);
+		return copy;
+	}
+
 	void Image::saveImage(const std::string& filename) {
 		saveAsPng(filename, *m_surface);
 	}
@@ -298,6 +371,121 @@ namespace FIFE {
 		fclose(fp);
 	}
 
+	const Rect& Image::getOpaqueRect() {
+		if (m_opaqueSurface != m_surface || !m_surface) {
+			calculateOpaqueRect();
+		}
+		return m_opaqueRect;
+	}
+
+	void Image::calculateOpaqueRect() {
+		m_opaqueRect = Rect(0, 0, 0, 0);
+		m_opaqueSurface = m_surface;
+		if (!m_surface) {
+			return;
+		}
+		Rect area = m_shared ? m_subimagerect : Rect(0, 0, m_surface->w, m_surface->h);
+		if (!area.intersectInplace(Rect(0, 0, m_surface->w, m_surface->h)) || area.w <= 0 || area.h <= 0) {
+			return;
+		}
+
+		const SDL_PixelFormat* format = m_surface->format;
+		Uint32 colorKey = 0;
+		const bool hasColorKey = SDL_GetColorKey(m_surface, &colorKey) == 0;
+		if (format->Amask == 0 && !hasColorKey) {
+			// without alpha channel and color key every pixel is opaque
+			m_opaqueRect = Rect(0, 0, area.w, area.h);
+			return;
+		}
+
+		// largest rectangle in the histogram of opaque pixel columns, row by row
+		const int32_t bpp = format->BytesPerPixel;
+		std::vector<int32_t> heights(area.w + 1, 0);
+		std::vector<int32_t> stack;
+		int32_t best = 0;
+		SDL_LockSurface(m_surface);
+		for (int32_t y = 0; y < area.h; ++y) {
+			const Uint8* row = static_cast<const Uint8*>(m_surface->pixels) + (y + area.y) * m_surface->pitch + area.x * bpp;
+			for (int32_t x = 0; x < area.w; ++x) {
+				const Uint8* p = row + x * bpp;
+				Uint32 pixel = 0;
+				switch (bpp) {
+					case 1: pixel = *p; break;
+					case 2: pixel = *reinterpret_cast<const Uint16*>(p); break;
+					case 3:
+						if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
+							pixel = p[0] << 16 | p[1] << 8 | p[2];
+						} else {
+							pixel = p[0] | p[1] << 8 | p[2] << 16;
+						}
+						break;
+					default: pixel = *reinterpret_cast<const Uint32*>(p); break;
+				}
+				bool opaque = (pixel & format->Amask) == format->Amask && !(hasColorKey && pixel == colorKey);
+				heights[x] = opaque ? heights[x] + 1 : 0;
+			}
+			// the last column has height 0 and empties the stack
+			stack.clear();
+			for (int32_t x = 0; x <= area.w; ++x) {
+				while (!stack.empty() && heights[stack.back()] >= heights[x]) {
+					int32_t h = heights[stack.back()];
+					stack.pop_back();
+					int32_t left = stack.empty() ? 0 : stack.back() + 1;
+					if (h * (x - left) > best) {
+						best = h * (x - left);
+						m_opaqueRect = Rect(left, y - h + 1, x - left, h);
+					}
+				}
+				stack.push_back(x);
+			}
+		}
+		SDL_UnlockSurface(m_surface);
+	}
+
+	bool Image::isAlphaMaskHit(int32_t x, int32_t y) {
+		// the mask of an atlas is larger than the subimage
+		if (m_shared && (x < 0 || y < 0 || x >= m_subimagerect.w || y >= m_subimagerect.h)) {
+			return false;
+		}
+		Point offset;
+		const AlphaMask& mask = getAlphaMask(offset);
+		return mask.isSet(x + offset.x, y + offset.y);
+	}
+
+	bool Image::isAlphaMaskHit(const Rect& area) {
+		Rect r = area;
+		if (m_shared && !r.intersectInplace(getArea())) {
+			return false;
+		}
+		Point offset;
+		const AlphaMask& mask = getAlphaMask(offset);
+		return mask.isAnySet(Rect(r.x + offset.x, r.y + offset.y, r.w, r.h));
+	}
+
+	const AlphaMask& Image::getAlphaMask(Point& offset) {
+		if (m_shared) {
+			Image* shared = getSharedImage();
+			if (shared) {
+				const AlphaMask& mask = shared->getAlphaMask(offset);
+				offset.x += m_subimagerect.x;
+				offset.y += m_subimagerect.y;
+				return mask;
+			}
+		}
+		offset = Point(0, 0);
+		const uint8_t threshold = RenderBackend::instance()->getAlphaMaskThreshold();
+		if (m_surface && (m_alphaMaskSurface != m_surface || m_alphaMask.getThreshold() != threshold)) {
+			m_alphaMaskSurface = m_surface;
+			if (m_shared) {
+				// shared image without access to the atlas, the mask only covers the subimage
+				m_alphaMask.create(m_surface, m_subimagerect, threshold);
+			} else {
+				m_alphaMask.create(m_surface, Rect(0, 0, m_surface->w, m_surface->h), threshold);
+			}
+		}
+		return m_alphaMask;
+	}
+
 	std::string Image::createUniqueImageName() {
 		// automated counting for name generation, in case the user doesn't provide a name
 		static uint32_t uniqueNumber = 0;
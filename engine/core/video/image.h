@@ -39,6 +39,8 @@
 #include "util/structures/point.h"
 #include "util/structures/rect.h"
 
+#include "alphamask.h"
+
 namespace FIFE {
 	class Image;
 	typedef SharedPtr<Image> ImagePtr;
@@ -131,6 +133,11 @@ namespace FIFE {
 
 		void getPixelRGBA(int32_t x, int32_t y, uint8_t* r, uint8_t* g, uint8_t* b, uint8_t* a);
 
+		/** Returns a new 32 bit surface with a copy of the pixels, NULL if the image has no pixels.
+		 * The channels are stored as R, G, B, A bytes and the caller owns the surface.
+		 */
+		SDL_Surface* createRGBASurface();
+
 		virtual size_t getSize();
 		virtual void load();
 		virtual void free();
@@ -155,6 +162,23 @@ namespace FIFE {
 		 */
 		virtual void copySubimage(uint32_t xoffset, uint32_t yoffset, const ImagePtr& img);
 
+		/** Returns the largest rectangle of the image that contains only opaque pixels.
+		 * It is calculated on first use and again if the surface changed, so only images
+		 * that occlusion culling looks at pay for the scan.
+		 * The rectangle is relative to the image and empty if no pixel is opaque.
+		 */
+		const Rect& getOpaqueRect();
+
+		/** Returns true if the alpha of the pixel is at least the alpha mask threshold of the render backend.
+		 * The test uses the alpha mask of the image, subimages of an atlas use the mask of the atlas.
+		 * Pixels outside of the image are no hit.
+		 */
+		bool isAlphaMaskHit(int32_t x, int32_t y);
+
+		/** Returns true if any pixel of the area is an alpha mask hit.
+		 */
+		bool isAlphaMaskHit(const Rect& area);
+
 	protected:
 		// The SDL Surface used.
 		SDL_Surface* m_surface;
@@ -176,8 +200,28 @@ namespace FIFE {
 		// Area which this image occupy in shared image
 		Rect m_subimagerect;
 
+		/** Returns the image this one shares its data with, NULL if there is none.
+		 */
+		virtual Image* getSharedImage() { return NULL; }
+
 	private:
 		std::string createUniqueImageName();
+		void calculateOpaqueRect();
+
+		/** Returns the alpha mask and its offset for this image, built on first use
+		 * and again if the surface or the threshold changed. The mask is kept if the
+		 * surface is detached, so hit tests still work after the texture upload.
+		 */
+		const AlphaMask& getAlphaMask(Point& offset);
+
+		// Largest fully opaque area of the image
+		Rect m_opaqueRect;
+		// Surface the opaque area was calculated for
+		SDL_Surface* m_opaqueSurface;
+		// Pixels at or above the alpha mask threshold, empty for subimages of an atlas
+		AlphaMask m_alphaMask;
+		// Surface the alpha mask was built from
+		SDL_Surface* m_alphaMaskSurface;
 	};
 }
 
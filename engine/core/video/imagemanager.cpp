@@ -20,9 +20,12 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
+#include <list>
 #include <map>
 
 // 3rd party library includes
+#include <SDL.h>
 #include <tinyxml.h>
 
 // FIFE includes
@@ -43,6 +46,65 @@ namespace FIFE {
 	 */
 	static Logger _log(LM_RESMGR);
 
+	// number of downscaled variants per image
+	const uint32_t MAX_LOD_LEVEL = 4;
+
+	/** Returns a copy of the image area as RGBA surface, NULL if the image has no pixels.
+	 */
+	static SDL_Surface* copyToRGBA(const ImagePtr& image) {
+		if (image->isSharedImage()) {
+			image->forceLoadInternal();
+		}
+		if (image->getState() != IResource::RES_LOADED || image->getWidth() == 0 || image->getHeight() == 0) {
+			return NULL;
+		}
+		return image->createRGBASurface();
+	}
+
+	/** Halves the size of a RGBA surface with a 2x2 box filter. The colors are weighted
+	 * by their alpha, so transparent pixels do not darken the edges.
+	 */
+	static SDL_Surface* downscaleSurface(SDL_Surface* source) {
+		const int32_t sw = source->w;
+		const int32_t sh = source->h;
+		const int32_t dw = std::max(1, (sw + 1) / 2);
+		const int32_t dh = std::max(1, (sh + 1) / 2);
+		SDL_Surface* target = SDL_CreateRGBSurface(0, dw, dh, 32, RMASK, GMASK, BMASK, AMASK);
+		if (!target) {
+			return NULL;
+		}
+		SDL_LockSurface(source);
+		SDL_LockSurface(target);
+		// the masks store the channels as R, G, B, A bytes on every platform
+		for (int32_t y = 0; y < dh; ++y) {
+			const uint8_t* row0 = static_cast<const uint8_t*>(source->pixels) + (2 * y) * source->pitch;
+			const uint8_t* row1 = static_cast<const uint8_t*>(source->pixels) + std::min(2 * y + 1, sh - 1) * source->pitch;
+			uint8_t* out = static_cast<uint8_t*>(target->pixels) + y * target->pitch;
+			for (int32_t x = 0; x < dw; ++x) {
+				const int32_t x0 = 2 * x * 4;
+				const int32_t x1 = std::min(2 * x + 1, sw - 1) * 4;
+				const uint8_t* px[4] = { row0 + x0, row0 + x1, row1 + x0, row1 + x1 };
+				uint32_t alpha = 0;
+				uint32_t color[3] = { 0, 0, 0 };
+				for (int32_t i = 0; i < 4; ++i) {
+					const uint32_t a = px[i][3];
+					alpha += a;
+					color[0] += px[i][0] * a;
+					color[1] += px[i][1] * a;
+					color[2] += px[i][2] * a;
+				}
+				for (int32_t c = 0; c < 3; ++c) {
+					out[c] = alpha ? static_cast<uint8_t>((color[c] + alpha / 2) / alpha) : 0;
+				}
+				out[3] = static_cast<uint8_t>((alpha + 2) / 4);
+				out += 4;
+			}
+		}
+		SDL_UnlockSurface(target);
+		SDL_UnlockSurface(source);
+		return target;
+	}
+
 	ImageManager::~ImageManager() {
 
 	}
@@ -57,7 +119,7 @@ namespace FIFE {
 			totalSize += it->second->getSize();
 		}
 
-		return totalSize;
+		return totalSize + m_lodMemory;
 	}
 
 	size_t ImageManager::getTotalResourcesCreated() const {
@@ -193,6 +255,7 @@ namespace FIFE {
 		ImageNameMapIterator nit = m_imgNameMap.find(name);
 
 		if (nit != m_imgNameMap.end()) {
+			removeLodImages(nit->second->getHandle());
 			if ( nit->second->getState() == IResource::RES_LOADED) {
 				nit->second->free();
 			}
@@ -207,6 +270,7 @@ namespace FIFE {
 		ImageHandleMapIterator it = m_imgHandleMap.find(handle);
 
 		if ( it != m_imgHandleMap.end()) {
+			removeLodImages(handle);
 			if ( it->second->getState() == IResource::RES_LOADED) {
 				it->second->free();
 			}
@@ -219,6 +283,7 @@ namespace FIFE {
 	}
 
 	void ImageManager::reloadAll() {
+		removeLodImages();
 		ImageHandleMapIterator it = m_imgHandleMap.begin(),
 			itend = m_imgHandleMap.end();
 
@@ -248,6 +313,7 @@ namespace FIFE {
 		ImageNameMapIterator nit = m_imgNameMap.find(name);
 
 		if (nit != m_imgNameMap.end()) {
+			removeLodImages(nit->second->getHandle());
 			if ( nit->second->getState() == IResource::RES_LOADED) {
 				nit->second->free();
 			}
@@ -260,6 +326,7 @@ namespace FIFE {
 	void ImageManager::free(ResourceHandle handle) {
 		ImageHandleMapConstIterator it = m_imgHandleMap.find(handle);
 		if (it != m_imgHandleMap.end()) {
+			removeLodImages(handle);
 			if ( it->second->getState() == IResource::RES_LOADED) {
 				it->second->free();
 			}
@@ -270,6 +337,7 @@ namespace FIFE {
 	}
 
 	void ImageManager::freeAll() {
+		removeLodImages();
 		ImageHandleMapIterator it = m_imgHandleMap.begin(),
 			itend = m_imgHandleMap.end();
 
@@ -292,6 +360,7 @@ namespace FIFE {
 		int32_t count = 0;
 		for ( ; it != itend; ++it) {
 			if (it->second.useCount() == 2 && it->second->getState() == IResource::RES_LOADED ){
+				removeLodImages(it->first);
 				it->second->free();
 				count++;
 			}
@@ -305,6 +374,7 @@ namespace FIFE {
 		ImageNameMapIterator nit = m_imgNameMap.find(resource->getName());
 
 		if (it != m_imgHandleMap.end()) {
+			removeLodImages(it->first);
 			m_imgHandleMap.erase(it);
 
 			if (nit != m_imgNameMap.end()) {
@@ -323,6 +393,7 @@ namespace FIFE {
 		ImageNameMapIterator nit = m_imgNameMap.find(name);
 		if (nit != m_imgNameMap.end()) {
 			handle = nit->second->getHandle();
+			removeLodImages(handle);
 			m_imgNameMap.erase(nit);
 		}
 		else {
@@ -346,6 +417,7 @@ namespace FIFE {
 
 		if (it != m_imgHandleMap.end()) {
 			name = it->second->getName();
+			removeLodImages(handle);
 			m_imgHandleMap.erase(it);
 		}
 		else {
@@ -368,6 +440,7 @@ namespace FIFE {
 
 		size_t count = m_imgHandleMap.size();
 
+		removeLodImages();
 		m_imgHandleMap.clear();
 		m_imgNameMap.clear();
 
@@ -449,6 +522,14 @@ namespace FIFE {
 		return ImagePtr();
 	}
 
+	Image* ImageManager::find(ResourceHandle handle) const {
+		ImageHandleMapConstIterator it = m_imgHandleMap.find(handle);
+		if (it != m_imgHandleMap.end()) {
+			return it->second.get();
+		}
+		return NULL;
+	}
+
 	ResourceHandle ImageManager::getResourceHandle(const std::string& name) {
 		ImageNameMapIterator nit = m_imgNameMap.find(name);
 		if (nit != m_imgNameMap.end()) {
@@ -488,6 +569,124 @@ namespace FIFE {
 			}
 		}
 
+		std::map<LodKey, LodImage>::iterator lit = m_lodImages.begin();
+		for (; lit != m_lodImages.end(); ++lit) {
+			lit->second.image->invalidate();
+		}
+	}
+
+	void ImageManager::setLodEnabled(bool enabled) {
+		m_lod = enabled;
+		if (!m_lod) {
+			removeLodImages();
+		}
+	}
+
+	bool ImageManager::isLodEnabled() const {
+		return m_lod;
+	}
+
+	void ImageManager::setLodMemoryLimit(size_t limit) {
+		m_lodMemoryLimit = limit;
+		evictLodImages();
+	}
+
+	size_t ImageManager::getLodMemoryLimit() const {
+		return m_lodMemoryLimit;
+	}
+
+	size_t ImageManager::getLodMemoryUsed() const {
+		return m_lodMemory;
+	}
+
+	uint32_t ImageManager::getLodLevel(double zoom) const {
+		uint32_t level = 0;
+		double scale = 0.5;
+		// the variant is never smaller than the zoomed image
+		while (level < MAX_LOD_LEVEL && zoom <= scale + 1e-9) {
+			++level;
+			scale *= 0.5;
+		}
+		return level;
+	}
+
+	ImagePtr ImageManager::getLodImage(const ImagePtr& image, uint32_t level) {
+		if (!m_lod || level == 0 || !image) {
+			return image;
+		}
+		level = std::min(level, MAX_LOD_LEVEL);
+		const LodKey key(image->getHandle(), level);
+		std::map<LodKey, LodImage>::iterator it = m_lodImages.find(key);
+		if (it != m_lodImages.end()) {
+			m_lodUsage.splice(m_lodUsage.begin(), m_lodUsage, it->second.use);
+			return it->second.image;
+		}
+
+		// each level is filtered from the next larger one
+		ImagePtr larger = level == 1 ? image : getLodImage(image, level - 1);
+		if (level > 1 && larger == image) {
+			return image;
+		}
+		// checked before the copy, the image is looked up every frame
+		const uint32_t width = larger->getWidth();
+		const uint32_t height = larger->getHeight();
+		if (width <= 1 && height <= 1) {
+			return image;
+		}
+		// a variant above the limit would be evicted right away and created again next frame
+		const size_t size = static_cast<size_t>(std::max(1u, (width + 1) / 2)) * std::max(1u, (height + 1) / 2) * 4;
+		if (size > m_lodMemoryLimit) {
+			return image;
+		}
+		SDL_Surface* source = copyToRGBA(larger);
+		if (!source) {
+			return image;
+		}
+		SDL_Surface* surface = NULL;
+		if (source->w > 1 || source->h > 1) {
+			surface = downscaleSurface(source);
+		}
+		SDL_FreeSurface(source);
+		if (!surface) {
+			return image;
+		}
+
+		LodImage lod;
+		// the render backend can convert and free the surface
+		lod.size = surface->h * surface->pitch;
+		lod.image = ImagePtr(RenderBackend::instance()->createImage(surface));
+		lod.image->setState(IResource::RES_LOADED);
+		m_lodUsage.push_front(key);
+		lod.use = m_lodUsage.begin();
+		m_lodImages.insert(std::make_pair(key, lod));
+		m_lodMemory += lod.size;
+		evictLodImages();
+		return lod.image;
+	}
+
+	void ImageManager::removeLodImages() {
+		m_lodImages.clear();
+		m_lodUsage.clear();
+		m_lodMemory = 0;
+	}
+
+	void ImageManager::removeLodImages(ResourceHandle handle) {
+		std::map<LodKey, LodImage>::iterator it = m_lodImages.lower_bound(LodKey(handle, 0));
+		while (it != m_lodImages.end() && it->first.first == handle) {
+			m_lodMemory -= it->second.size;
+			m_lodUsage.erase(it->second.use);
+			m_lodImages.erase(it++);
+		}
+	}
+
+	void ImageManager::evictLodImages() {
+		// a new variant fits into the limit, so it is never evicted by its own creation
+		while (m_lodMemory > m_lodMemoryLimit && !m_lodUsage.empty()) {
+			std::map<LodKey, LodImage>::iterator it = m_lodImages.find(m_lodUsage.back());
+			m_lodMemory -= it->second.size;
+			m_lodImages.erase(it);
+			m_lodUsage.pop_back();
+		}
 	}
 
 } //FIFE
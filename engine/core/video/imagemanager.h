@@ -23,8 +23,10 @@
 #define FIFE_IMAGE_MANAGER_H
 
 // Standard C++ library includes
+#include <list>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 // 3rd party library includes
@@ -56,7 +58,7 @@ namespace FIFE {
 
 		/** Default constructor.
 		 */
-		ImageManager() : IResourceManager() { }
+		ImageManager() : IResourceManager(), m_lod(false), m_lodMemory(0), m_lodMemoryLimit(32 * 1024 * 1024) { }
 
 		/** Destructor.
 		 */
@@ -362,6 +364,14 @@ namespace FIFE {
 		virtual ImagePtr getPtr(const std::string& name);
 		virtual ImagePtr getPtr(ResourceHandle handle);
 
+		/** Gets the Image without loading it and without taking a reference.
+		 * Can be called from worker threads while no images are added or removed.
+		 *
+		 * @param handle The handle of the resource
+		 * @return The Image or 0 if the handle is undefined
+		 */
+		Image* find(ResourceHandle handle) const;
+
 		/** Gets an Image handle by name
 		 *
 		 * Returns the Image handle associated with the name
@@ -376,7 +386,64 @@ namespace FIFE {
 		virtual void invalidate(ResourceHandle handle);
 		virtual void invalidateAll();
 
+		/** Enables or disables the downscaled variants of images for zoomed out cameras.
+		 */
+		void setLodEnabled(bool enabled);
+
+		/** Returns true if downscaled variants are used.
+		 */
+		bool isLodEnabled() const;
+
+		/** Sets the memory limit of the downscaled variants in bytes.
+		 * Above the limit the least recently used variants are removed.
+		 */
+		void setLodMemoryLimit(size_t limit);
+
+		/** Returns the memory limit of the downscaled variants in bytes.
+		 */
+		size_t getLodMemoryLimit() const;
+
+		/** Returns the memory used by the downscaled variants in bytes.
+		 */
+		size_t getLodMemoryUsed() const;
+
+		/** Returns the variant level that fits the zoom.
+		 * Level 0 is the image itself, every level halves the width and height.
+		 */
+		uint32_t getLodLevel(double zoom) const;
+
+		/** Returns the downscaled variant of the image, it is box-filtered from the next
+		 * larger variant on first use. Returns the image itself for level 0, if variants are
+		 * disabled, the image can not be scaled or the variant is larger than the memory limit.
+		 * Callers should not keep the variant, otherwise removing or evicting it does not
+		 * free its memory.
+		 */
+		ImagePtr getLodImage(const ImagePtr& image, uint32_t level);
+
+		/** Removes all downscaled variants.
+		 */
+		void removeLodImages();
+
 	private:
+		typedef std::pair<ResourceHandle, uint32_t> LodKey;
+
+		struct LodImage {
+			// the downscaled image
+			ImagePtr image;
+			// memory used by the image
+			size_t size;
+			// position in m_lodUsage
+			std::list<LodKey>::iterator use;
+		};
+
+		/** Removes the variants of the image.
+		 */
+		void removeLodImages(ResourceHandle handle);
+
+		/** Removes the least recently used variants until the memory limit is reached.
+		 */
+		void evictLodImages();
+
 		typedef std::map< ResourceHandle, ImagePtr > ImageHandleMap;
 		typedef std::map< ResourceHandle, ImagePtr >::iterator ImageHandleMapIterator;
 		typedef std::map< ResourceHandle, ImagePtr >::const_iterator ImageHandleMapConstIterator;
@@ -390,6 +457,16 @@ namespace FIFE {
 		ImageHandleMap m_imgHandleMap;
 
 		ImageNameMap m_imgNameMap;
+
+		// are the downscaled variants used
+		bool m_lod;
+		// downscaled variants of the images
+		std::map<LodKey, LodImage> m_lodImages;
+		// variant keys, the most recently used first
+		std::list<LodKey> m_lodUsage;
+		// memory of the variants and its limit
+		size_t m_lodMemory;
+		size_t m_lodMemoryLimit;
 	};
 
 } //FIFE
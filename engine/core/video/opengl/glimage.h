@@ -80,6 +80,10 @@ namespace FIFE {
 		const GLfloat* getTexCoords() const;
 		bool isCompressed() const { return m_compressed; }
 		void setCompressed(bool compressed) { m_compressed = compressed; }
+
+	protected:
+		virtual Image* getSharedImage() { return m_atlas_img.get(); }
+
 	private:
 		// texture coords to use
 		GLfloat m_tex_coords[4];
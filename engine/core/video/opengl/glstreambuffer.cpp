@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstring>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "glstreambuffer.h"
+
+namespace FIFE {
+
+	// uploads start at multiples of this, suits all vertex and index types
+	static const uint32_t STREAM_ALIGNMENT = 16;
+
+	GLStreamBuffer::GLStreamBuffer(GLenum target):
+		m_target(target),
+		m_id(0),
+		m_size(0),
+		m_offset(0),
+		m_mapRange(false) {
+	}
+
+	void GLStreamBuffer::create(uint32_t size, bool mapRange) {
+		destroy();
+		m_size = size;
+		m_offset = 0;
+		m_mapRange = mapRange;
+		glGenBuffers(1, &m_id);
+		glBindBuffer(m_target, m_id);
+		glBufferData(m_target, m_size, NULL, GL_STREAM_DRAW);
+	}
+
+	void GLStreamBuffer::destroy() {
+		if (m_id != 0) {
+			glDeleteBuffers(1, &m_id);
+			m_id = 0;
+		}
+		m_size = 0;
+		m_offset = 0;
+	}
+
+	void GLStreamBuffer::reserve(uint32_t size, uint32_t uploads) {
+		glBindBuffer(m_target, m_id);
+		const uint32_t needed = size + uploads * STREAM_ALIGNMENT;
+		if (m_offset + needed > m_size) {
+			orphan(needed);
+		}
+	}
+
+	GLintptr GLStreamBuffer::upload(const void* data, uint32_t size) {
+		glBindBuffer(m_target, m_id);
+		uint32_t offset = (m_offset + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+		if (offset + size > m_size) {
+			orphan(size);
+			offset = 0;
+		}
+		if (m_mapRange) {
+			// the range was not written since the last orphaning, so no synchronization is needed
+			void* dst = glMapBufferRange(m_target, offset, size,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			if (dst) {
+				memcpy(dst, data, size);
+				glUnmapBuffer(m_target);
+			} else {
+				glBufferSubData(m_target, offset, size, data);
+			}
+		} else {
+			glBufferSubData(m_target, offset, size, data);
+		}
+		m_offset = offset + size;
+		return offset;
+	}
+
+	void GLStreamBuffer::orphan(uint32_t size) {
+		// the driver keeps the old storage until the GPU is done with it
+		while (m_size < size) {
+			m_size *= 2;
+		}
+		glBufferData(m_target, m_size, NULL, GL_STREAM_DRAW);
+		m_offset = 0;
+	}
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VIDEO_RENDERBACKENDS_OPENGL_GLSTREAMBUFFER_H
+#define FIFE_VIDEO_RENDERBACKENDS_OPENGL_GLSTREAMBUFFER_H
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+#include "fife_opengl.h"
+
+namespace FIFE {
+
+	/** A buffer object that vertex or index data is streamed through.
+	 *
+	 * The uploads of a frame are written one after the other. If an upload does not fit
+	 * behind the last one, the buffer is orphaned and the writing starts at the beginning,
+	 * so data the GPU may still read is never overwritten.
+	 */
+	class GLStreamBuffer {
+	public:
+		/** Constructor
+		 * @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+		 */
+		GLStreamBuffer(GLenum target);
+
+		/** Creates the buffer object, needs a current OpenGL context.
+		 * @param size Initial size in bytes, the buffer grows if an upload is larger.
+		 * @param mapRange Uploads with glMapBufferRange instead of glBufferSubData.
+		 */
+		void create(uint32_t size, bool mapRange);
+
+		/** Deletes the buffer object.
+		 */
+		void destroy();
+
+		/** Returns the id of the buffer object, 0 if it is not created.
+		 */
+		GLuint getId() const { return m_id; }
+
+		/** Binds the buffer and makes sure the next uploads fit without orphaning it.
+		 * Data that is drawn together has to be reserved together, because orphaning
+		 * the buffer invalidates the offsets of the earlier uploads.
+		 * @param size Summed size of the uploads in bytes, without alignment.
+		 * @param uploads Number of the uploads.
+		 */
+		void reserve(uint32_t size, uint32_t uploads);
+
+		/** Binds the buffer and copies the data into it.
+		 * @return The offset of the data in the buffer.
+		 */
+		GLintptr upload(const void* data, uint32_t size);
+
+	private:
+		/** Orphans the buffer storage and grows it to at least the given size.
+		 */
+		void orphan(uint32_t size);
+
+		// GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+		GLenum m_target;
+		GLuint m_id;
+		// size of the buffer storage
+		uint32_t m_size;
+		// write position of the next upload
+		uint32_t m_offset;
+		bool m_mapRange;
+	};
+}
+
+#endif
@@ -76,7 +76,13 @@ namespace FIFE {
 	};
 
 	RenderBackendOpenGL::RenderBackendOpenGL(const SDL_Color& colorkey)
-		: RenderBackend(colorkey), m_maskOverlay(0){
+		: RenderBackend(colorkey), m_maskOverlay(0),
+		m_vertexStreaming(false),
+		m_streaming(false),
+		m_vertexStream(GL_ARRAY_BUFFER),
+		m_indexStream(GL_ELEMENT_ARRAY_BUFFER),
+		m_indexBuffer(0),
+		m_indicebufferId(0) {
 
 		m_state.tex_enabled[0] = false;
 		m_state.tex_enabled[1] = false;
@@ -119,6 +125,11 @@ namespace FIFE {
 
 	RenderBackendOpenGL::~RenderBackendOpenGL() {
 		glDeleteTextures(1, &m_maskOverlay);
+		if (m_vertexStreaming) {
+			m_vertexStream.destroy();
+			m_indexStream.destroy();
+			glDeleteBuffers(1, &m_indicebufferId);
+		}
 		if(GLEW_EXT_framebuffer_object && m_useframebuffer) {
 			glDeleteFramebuffers(1, &m_fbo_id);
 		}
@@ -334,11 +345,26 @@ namespace FIFE {
 			index += 4;
 		}
 
-		// currently unused, create buffer and send data
-		//glGenBuffers(1, &m_indicebufferId);
-		//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indicebufferId);
-		//glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), &indices[0], GL_STATIC_DRAW);
-		//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		// the buffer objects survive a recreated window, because the context is kept
+		if (m_usevertexbuffers && !m_vertexStreaming) {
+			if (DeviceCaps::isVertexBufferStreamingSupported()) {
+				const bool mapRange = DeviceCaps::isBufferRangeMappingSupported();
+				// 4 MB for vertices and 1 MB for indices, they grow if needed
+				m_vertexStream.create(4 * 1024 * 1024, mapRange);
+				m_indexStream.create(1024 * 1024, mapRange);
+				// the static indices are uploaded once
+				glGenBuffers(1, &m_indicebufferId);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indicebufferId);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(uint32_t), &m_indices[0], GL_STATIC_DRAW);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				m_vertexStreaming = true;
+				FL_LOG(_log, LMsg("RenderBackendOpenGL") << "Streaming vertex data through buffer objects"
+					<< (mapRange ? " with mapped ranges" : ""));
+			} else {
+				FL_WARN(_log, LMsg("RenderBackendOpenGL") << "Buffer objects are not supported, using vertex arrays");
+			}
+		}
 	}
 
 	void RenderBackendOpenGL::startFrame() {
@@ -503,6 +529,7 @@ namespace FIFE {
 			}
 			m_state.texture[texUnit] = texId;
 			glBindTexture(GL_TEXTURE_2D, texId);
+			++m_counters.textureBinds;
 		}
 	}
 
@@ -510,6 +537,7 @@ namespace FIFE {
 		if(m_state.texture[m_state.active_tex] != texId) {
 			m_state.texture[m_state.active_tex] = texId;
 			glBindTexture(GL_TEXTURE_2D, texId);
+			++m_counters.textureBinds;
 		}
 	}
 
@@ -655,6 +683,9 @@ namespace FIFE {
 	}
 
 	void RenderBackendOpenGL::setVertexPointer(GLint size, GLsizei stride, const GLvoid* ptr) {
+		if (m_streaming) {
+			ptr = getStreamOffset(m_vertexRanges, ptr);
+		}
 		if(m_state.vertex_pointer != ptr || m_state.vertex_pointer_size != size)	{
 			m_state.vertex_pointer = ptr;
 			m_state.vertex_pointer_size = size;
@@ -663,6 +694,9 @@ namespace FIFE {
 	}
 
 	void RenderBackendOpenGL::setColorPointer(GLsizei stride, const GLvoid* ptr) {
+		if (m_streaming) {
+			ptr = getStreamOffset(m_vertexRanges, ptr);
+		}
 		if(m_state.color_pointer != ptr) {
 			m_state.color_pointer = ptr;
 			glColorPointer(4, GL_UNSIGNED_BYTE, stride, ptr);
@@ -670,6 +704,9 @@ namespace FIFE {
 	}
 
 	void RenderBackendOpenGL::setTexCoordPointer(uint32_t texUnit, GLsizei stride, const GLvoid* ptr) {
+		if (m_streaming) {
+			ptr = getStreamOffset(m_vertexRanges, ptr);
+		}
 		if(m_state.tex_pointer[texUnit] != ptr) {
 			if(m_state.active_tex != texUnit) {
 				m_state.active_tex = texUnit;
@@ -931,7 +968,7 @@ namespace FIFE {
 			if (render) {
 				if (*currentElements > 0) {
 					//render
-					glDrawElements(mode, *currentElements, GL_UNSIGNED_INT, indexBuffer + *currentIndex);
+					drawElements(mode, *currentElements, indexBuffer + *currentIndex);
 					*currentIndex += *currentElements;
 				}
 				// switch mode
@@ -1139,7 +1176,7 @@ namespace FIFE {
 			}
 		}
 		// render
-		glDrawElements(mode, *currentElements, GL_UNSIGNED_INT, indexBuffer + *currentIndex);
+		drawElements(mode, *currentElements, indexBuffer + *currentIndex);
 
 		// reset all states
 		if (overlay_type != OVERLAY_TYPE_NONE) {
@@ -1199,7 +1236,7 @@ namespace FIFE {
 			if (ro.texture_id != texture_id) {
 				if (*currentElements > 0) {
 					//render
-					glDrawElements(GL_TRIANGLES, *currentElements, GL_UNSIGNED_INT, &m_indices[*currentIndex]);
+					drawElements(GL_TRIANGLES, *currentElements, &m_indices[*currentIndex]);
 					*currentIndex += *currentElements;
 				}
 
@@ -1220,7 +1257,7 @@ namespace FIFE {
 		}
 
 		// render
-		glDrawElements(GL_TRIANGLES, *currentElements, GL_UNSIGNED_INT, &m_indices[*currentIndex]);
+		drawElements(GL_TRIANGLES, *currentElements, &m_indices[*currentIndex]);
 
 		//reset all states
 		disableLighting();
@@ -1250,7 +1287,8 @@ namespace FIFE {
 		std::vector<RenderZObjectTest>::iterator iter = m_renderZ_objects.begin();
 		for ( ; iter != m_renderZ_objects.end(); ++iter) {
 			bindTexture(iter->texture_id);
-			glDrawArrays(GL_QUADS, iter->index, iter->elements);
+			// the quads are drawn as two triangles each
+			drawElements(GL_TRIANGLES, iter->elements / 4 * 6, &m_indices[iter->index / 4 * 6]);
 		}
 		m_renderZ_objects.clear();
 
@@ -1293,7 +1331,7 @@ namespace FIFE {
 			if (ro.texture_id != texture_id) {
 				if (*currentElements > 0) {
 					//render
-					glDrawElements(GL_TRIANGLES, *currentElements, GL_UNSIGNED_INT, &m_indices[*currentIndex]);
+					drawElements(GL_TRIANGLES, *currentElements, &m_indices[*currentIndex]);
 					*currentIndex += *currentElements;
 				}
 
@@ -1314,7 +1352,7 @@ namespace FIFE {
 		}
 
 		// render
-		glDrawElements(GL_TRIANGLES, *currentElements, GL_UNSIGNED_INT, &m_indices[*currentIndex]);
+		drawElements(GL_TRIANGLES, *currentElements, &m_indices[*currentIndex]);
 
 		//reset all states
 		disableLighting();
@@ -1382,7 +1420,7 @@ namespace FIFE {
 			if (render) {
 				if (*currentElements > 0) {
 					//render
-					glDrawElements(GL_TRIANGLES, *currentElements, GL_UNSIGNED_INT, &m_indices[*currentIndex]);
+					drawElements(GL_TRIANGLES, *currentElements, &m_indices[*currentIndex]);
 					*currentIndex += *currentElements;
 				}
 				// multitexturing
@@ -1450,7 +1488,7 @@ namespace FIFE {
 			}
 		}
 		// render
-		glDrawElements(GL_TRIANGLES, *currentElements, GL_UNSIGNED_INT, &m_indices[*currentIndex]);
+		drawElements(GL_TRIANGLES, *currentElements, &m_indices[*currentIndex]);
 
 		//reset all states
 		if (overlay_type != OVERLAY_TYPE_NONE) {
@@ -1468,6 +1506,12 @@ namespace FIFE {
 	}
 
 	void RenderBackendOpenGL::renderVertexArrays() {
+		++m_counters.flushes;
+		if (m_renderZ_objects.empty() && m_renderTextureObjectsZ.empty() && m_renderMultitextureObjectsZ.empty() &&
+			m_renderTextureColorObjectsZ.empty() && m_renderObjects.empty()) {
+			return;
+		}
+		beginStreaming();
 		// z stuff
 		if (!m_renderZ_objects.empty()) {
 			renderWithZTest();
@@ -1486,6 +1530,128 @@ namespace FIFE {
 		if (!m_renderObjects.empty()) {
 			renderWithoutZ();
 		}
+		endStreaming();
+	}
+
+	void RenderBackendOpenGL::beginStreaming() {
+		if (!m_vertexStreaming) {
+			return;
+		}
+		// everything is reserved first, orphaning a buffer would invalidate the earlier offsets
+		m_vertexStream.reserve(m_renderZ_datas.size() * sizeof(renderDataZ) +
+			m_renderTextureDatasZ.size() * sizeof(renderDataZ) +
+			m_renderTextureColorDatasZ.size() * sizeof(renderDataColorZ) +
+			m_renderMultitextureDatasZ.size() * sizeof(renderData2TCZ) +
+			m_renderPrimitiveDatas.size() * sizeof(renderDataP) +
+			m_renderTextureDatas.size() * sizeof(renderDataT) +
+			m_renderTextureColorDatas.size() * sizeof(renderDataTC) +
+			m_renderMultitextureDatas.size() * sizeof(renderData2TC), 8);
+		streamVertices(m_renderZ_datas);
+		streamVertices(m_renderTextureDatasZ);
+		streamVertices(m_renderTextureColorDatasZ);
+		streamVertices(m_renderMultitextureDatasZ);
+		streamVertices(m_renderPrimitiveDatas);
+		streamVertices(m_renderTextureDatas);
+		streamVertices(m_renderTextureColorDatas);
+		streamVertices(m_renderMultitextureDatas);
+
+		m_indexStream.reserve((m_pIndices.size() + m_tIndices.size() + m_tcIndices.size() + m_tc2Indices.size()) * sizeof(uint32_t), 4);
+		streamIndices(m_pIndices);
+		streamIndices(m_tIndices);
+		streamIndices(m_tcIndices);
+		streamIndices(m_tc2Indices);
+		StreamRange range;
+		range.begin = reinterpret_cast<const char*>(&m_indices[0]);
+		range.end = range.begin + m_indices.size() * sizeof(uint32_t);
+		range.buffer = m_indicebufferId;
+		range.offset = 0;
+		m_indexRanges.push_back(range);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexStream.getId());
+		m_indexBuffer = m_indexStream.getId();
+		resetPointers();
+		m_streaming = true;
+	}
+
+	void RenderBackendOpenGL::endStreaming() {
+		if (!m_streaming) {
+			return;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		m_indexBuffer = 0;
+		m_vertexRanges.clear();
+		m_indexRanges.clear();
+		resetPointers();
+		m_streaming = false;
+	}
+
+	void RenderBackendOpenGL::resetPointers() {
+		// no pointer or buffer offset has this value
+		const GLvoid* invalid = reinterpret_cast<const GLvoid*>(~static_cast<uintptr_t>(0));
+		m_state.vertex_pointer = invalid;
+		m_state.color_pointer = invalid;
+		for (uint32_t i = 0; i < 4; ++i) {
+			m_state.tex_pointer[i] = invalid;
+		}
+	}
+
+	template<typename T>
+	void RenderBackendOpenGL::streamVertices(const std::vector<T>& data) {
+		if (data.empty()) {
+			return;
+		}
+		StreamRange range;
+		range.begin = reinterpret_cast<const char*>(&data[0]);
+		range.end = range.begin + data.size() * sizeof(T);
+		range.buffer = m_vertexStream.getId();
+		range.offset = m_vertexStream.upload(&data[0], data.size() * sizeof(T));
+		m_vertexRanges.push_back(range);
+	}
+
+	void RenderBackendOpenGL::streamIndices(const std::vector<uint32_t>& data) {
+		if (data.empty()) {
+			return;
+		}
+		StreamRange range;
+		range.begin = reinterpret_cast<const char*>(&data[0]);
+		range.end = range.begin + data.size() * sizeof(uint32_t);
+		range.buffer = m_indexStream.getId();
+		range.offset = m_indexStream.upload(&data[0], data.size() * sizeof(uint32_t));
+		m_indexRanges.push_back(range);
+	}
+
+	const GLvoid* RenderBackendOpenGL::getStreamOffset(const std::vector<StreamRange>& ranges, const void* ptr, GLuint* buffer) const {
+		const char* p = static_cast<const char*>(ptr);
+		std::vector<StreamRange>::const_iterator it = ranges.begin();
+		for (; it != ranges.end(); ++it) {
+			if (p >= it->begin && p < it->end) {
+				if (buffer) {
+					*buffer = it->buffer;
+				}
+				return reinterpret_cast<const GLvoid*>(it->offset + (p - it->begin));
+			}
+		}
+		// only empty arrays are not uploaded, nothing is drawn from them
+		return 0;
+	}
+
+	void RenderBackendOpenGL::drawElements(GLenum mode, uint32_t count, const uint32_t* indices) {
+		if (count == 0) {
+			return;
+		}
+		if (m_streaming) {
+			GLuint buffer = m_indexBuffer;
+			const GLvoid* offset = getStreamOffset(m_indexRanges, indices, &buffer);
+			if (buffer != m_indexBuffer) {
+				m_indexBuffer = buffer;
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+			}
+			glDrawElements(mode, count, GL_UNSIGNED_INT, offset);
+		} else {
+			glDrawElements(mode, count, GL_UNSIGNED_INT, indices);
+		}
+		addDrawCall(count);
 	}
 
 	bool RenderBackendOpenGL::putPixel(int32_t x, int32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
@@ -2594,6 +2760,7 @@ namespace FIFE {
 
 		m_img_target = img;
 		m_target_discard = discard;
+		++m_counters.renderTargetSwitches;
 
 		// to render on something, we need to make sure its loaded already in gpu memory
 		m_img_target->forceLoadInternal();
@@ -2652,6 +2819,7 @@ namespace FIFE {
 
 		// flush down what we batched
 		renderVertexArrays();
+		++m_counters.renderTargetSwitches;
 
 		if (GLEW_EXT_framebuffer_object && m_useframebuffer) {
 			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
@@ -2692,11 +2860,13 @@ namespace FIFE {
 		} else {
 			glEnable(GL_TEXTURE_2D);
 			glBindTexture(GL_TEXTURE_2D, texId);
+			++m_counters.textureBinds;
 			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 			glTexCoordPointer(2, GL_DOUBLE, sizeof(GuiVertex), &vertices[0].texCoords);
 		}
 		
 		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, &indices[0]);
+		addDrawCall(indices.size());
 		
 		glPopMatrix();
 	}
@@ -33,6 +33,7 @@
 #include "video/renderbackend.h"
 
 #include "fife_opengl.h"
+#include "glstreambuffer.h"
 
 namespace FIFE {
 	class ScreenMode;
@@ -131,6 +132,20 @@ namespace FIFE {
 		GLuint m_maskOverlay;
 		void prepareForOverlays();
 
+		/** Uploads the batched data into the stream buffers, if vertex buffers are used.
+		 * Until endStreaming() the client array pointers are translated to buffer offsets.
+		 */
+		void beginStreaming();
+		void endStreaming();
+		/** Forces the next set*Pointer calls to update the pointers.
+		 */
+		void resetPointers();
+		template<typename T> void streamVertices(const std::vector<T>& data);
+		void streamIndices(const std::vector<uint32_t>& data);
+		/** Draws the indexed vertices, from client memory or from the index buffers.
+		 */
+		void drawElements(GLenum mode, uint32_t count, const uint32_t* indices);
+
 		void renderWithoutZ();
 
 		void renderWithZ();
@@ -272,7 +287,30 @@ namespace FIFE {
 			bool color_enabled;
 		} m_state;
 
+		// client memory that was uploaded into a buffer object
+		struct StreamRange {
+			const char* begin;
+			const char* end;
+			GLuint buffer;
+			GLintptr offset;
+		};
+		/** Returns the buffer offset for the client pointer, 0 if it was not uploaded.
+		 */
+		const GLvoid* getStreamOffset(const std::vector<StreamRange>& ranges, const void* ptr, GLuint* buffer = 0) const;
+
+		// vertex data is streamed through buffer objects
+		bool m_vertexStreaming;
+		// between beginStreaming and endStreaming
+		bool m_streaming;
+		GLStreamBuffer m_vertexStream;
+		GLStreamBuffer m_indexStream;
+		std::vector<StreamRange> m_vertexRanges;
+		std::vector<StreamRange> m_indexRanges;
+		// bound element array buffer while streaming
+		GLuint m_indexBuffer;
+
 		GLuint m_fbo_id;
+		//! buffer object with m_indices, if vertex buffers are used
 		GLuint m_indicebufferId;
 		//! static indices for vertex data with z
 		std::vector<uint32_t> m_indices;
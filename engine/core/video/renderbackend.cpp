@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 
 // 3rd party library includes
 
@@ -31,6 +32,42 @@
 #include "video/devicecaps.h"
 
 namespace FIFE {
+	//! more dirty rects are merged into one
+	static const uint32_t MAX_DIRTY_RECTS = 32;
+
+	static Rect boundingRect(const Rect& a, const Rect& b) {
+		int32_t x = std::min(a.x, b.x);
+		int32_t y = std::min(a.y, b.y);
+		return Rect(x, y, std::max(a.right(), b.right()) - x, std::max(a.bottom(), b.bottom()) - y);
+	}
+
+	RenderCounters::RenderCounters():
+		drawCalls(0),
+		vertices(0),
+		textureBinds(0),
+		renderTargetSwitches(0),
+		flushes(0) {
+	}
+
+	RenderCounters RenderCounters::operator-(const RenderCounters& rhs) const {
+		RenderCounters result;
+		result.drawCalls = drawCalls - rhs.drawCalls;
+		result.vertices = vertices - rhs.vertices;
+		result.textureBinds = textureBinds - rhs.textureBinds;
+		result.renderTargetSwitches = renderTargetSwitches - rhs.renderTargetSwitches;
+		result.flushes = flushes - rhs.flushes;
+		return result;
+	}
+
+	RenderCounters& RenderCounters::operator+=(const RenderCounters& rhs) {
+		drawCalls += rhs.drawCalls;
+		vertices += rhs.vertices;
+		textureBinds += rhs.textureBinds;
+		renderTargetSwitches += rhs.renderTargetSwitches;
+		flushes += rhs.flushes;
+		return *this;
+	}
+
 	RenderBackend::RenderBackend(const SDL_Color& colorkey):
 		m_window(NULL),
 		m_screen(NULL),
@@ -38,7 +75,10 @@ namespace FIFE {
 		m_compressimages(false),
 		m_useframebuffer(false),
 		m_usenpot(false),
+		m_usevertexbuffers(false),
 		m_isalphaoptimized(false),
+		m_alphamasks(false),
+		m_alphamaskthreshold(1),
 		m_iscolorkeyenabled(false),
 		m_colorkey(colorkey),
 		m_isMipmapping(false),
@@ -48,6 +88,7 @@ namespace FIFE {
 		m_isDepthBuffer(false),
 		m_alphaValue(0.3),
 		m_vSync(false),
+		m_dirtyRects(false),
 		m_isframelimit(false),
 		m_frame_start(0),
 		m_framelimit(60) {
@@ -67,12 +108,18 @@ namespace FIFE {
 	}
 
 	void RenderBackend::startFrame() {
+		m_counters = RenderCounters();
 		if (m_isframelimit) {
 			m_frame_start = SDL_GetTicks();
 		}
 	}
 
 	void RenderBackend::endFrame () {
+		m_frameCounters = m_counters;
+		if (m_dirtyRects) {
+			m_lastDirtyAreas.swap(m_dirtyAreas);
+			m_dirtyAreas.clear();
+		}
 		if (m_isframelimit) {
 			uint16_t frame_time = SDL_GetTicks() - m_frame_start;
 			const float frame_limit = 1000.0f/m_framelimit;
@@ -233,6 +280,77 @@ namespace FIFE {
 		return m_framelimit;
 	}
 
+	void RenderBackend::setDirtyRectsEnabled(bool) {
+	}
+
+	bool RenderBackend::isDirtyRectsEnabled() const {
+		return m_dirtyRects;
+	}
+
+	const RenderCounters& RenderBackend::getRenderCounters() const {
+		return m_counters;
+	}
+
+	const RenderCounters& RenderBackend::getFrameCounters() const {
+		return m_frameCounters;
+	}
+
+	void RenderBackend::addDirtyRect(const Rect& rect) {
+		if (!m_dirtyRects) {
+			return;
+		}
+		Rect area = rect;
+		if (!area.intersectInplace(getArea()) || area.w <= 0 || area.h <= 0) {
+			return;
+		}
+		// merges the overlapping rects
+		std::vector<Rect>::iterator it = m_dirtyAreas.begin();
+		while (it != m_dirtyAreas.end()) {
+			if (it->intersects(area)) {
+				area = boundingRect(area, *it);
+				m_dirtyAreas.erase(it);
+				it = m_dirtyAreas.begin();
+			} else {
+				++it;
+			}
+		}
+		m_dirtyAreas.push_back(area);
+		if (m_dirtyAreas.size() > MAX_DIRTY_RECTS) {
+			for (it = m_dirtyAreas.begin(); it != m_dirtyAreas.end(); ++it) {
+				area = boundingRect(area, *it);
+			}
+			m_dirtyAreas.assign(1, area);
+		}
+	}
+
+	void RenderBackend::invalidateScreen() {
+		addDirtyRect(getArea());
+	}
+
+	bool RenderBackend::isDirty(const Rect& area) const {
+		if (!m_dirtyRects) {
+			return true;
+		}
+		// the backend clears and redraws the bounding box of the dirty rects
+		Rect dirty = getDirtyArea();
+		return dirty.w > 0 && dirty.h > 0 && dirty.intersects(area);
+	}
+
+	Rect RenderBackend::getDirtyArea() const {
+		if (m_dirtyAreas.empty() && m_lastDirtyAreas.empty()) {
+			return Rect();
+		}
+		Rect area = m_dirtyAreas.empty() ? m_lastDirtyAreas.front() : m_dirtyAreas.front();
+		std::vector<Rect>::const_iterator it = m_dirtyAreas.begin();
+		for (; it != m_dirtyAreas.end(); ++it) {
+			area = boundingRect(area, *it);
+		}
+		for (it = m_lastDirtyAreas.begin(); it != m_lastDirtyAreas.end(); ++it) {
+			area = boundingRect(area, *it);
+		}
+		return area;
+	}
+
 	SDL_Surface* RenderBackend::getScreenSurface() {
 		return m_screen;
 	}
@@ -23,6 +23,7 @@
 #define FIFE_VIDEO_RENDERBACKEND_H
 
 // Standard C++ library includes
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -117,6 +118,29 @@ namespace FIFE {
 		DoublePoint texCoords;
 	};
 
+	/** Counters of the work a render backend did.
+	 */
+	class RenderCounters {
+	public:
+		RenderCounters();
+
+		//! number of draw calls, e.g. glDrawElements or SDL_RenderCopy
+		uint32_t drawCalls;
+		//! number of vertices or indices passed to the draw calls
+		uint32_t vertices;
+		//! number of texture binds that changed the bound texture
+		uint32_t textureBinds;
+		//! number of attached and detached render targets
+		uint32_t renderTargetSwitches;
+		//! number of renderVertexArrays calls
+		uint32_t flushes;
+
+		/** Returns the work done since the given counters were taken.
+		 */
+		RenderCounters operator-(const RenderCounters& rhs) const;
+		RenderCounters& operator+=(const RenderCounters& rhs);
+	};
+
 	 /** Abstract interface for all the renderbackends. */
 	class RenderBackend: public DynamicSingleton<RenderBackend> {
 	public:
@@ -365,6 +389,33 @@ namespace FIFE {
 		 */
 		bool isNPOTEnabled() const { return m_usenpot; }
 
+		/** Enables or disables streaming the vertex data through buffer objects, if available.
+		 * Otherwise the data is drawn from client memory. Has to be set before the screen is created.
+		 */
+		void setVertexBuffersEnabled(bool enabled) { m_usevertexbuffers = enabled; }
+
+		/** @see setVertexBuffersEnabled
+		 */
+		bool isVertexBuffersEnabled() const { return m_usevertexbuffers; }
+
+		/** Enables or disables building the alpha masks of images when they are loaded.
+		 * Otherwise the mask of an image is built on first use.
+		 */
+		void setAlphaMasksEnabled(bool enabled) { m_alphamasks = enabled; }
+
+		/** @see setAlphaMasksEnabled
+		 */
+		bool isAlphaMasksEnabled() const { return m_alphamasks; }
+
+		/** Sets the minimum alpha of the pixels that are set in the alpha masks of images.
+		 * Existing masks are rebuilt on their next use.
+		 */
+		void setAlphaMaskThreshold(uint8_t threshold) { m_alphamaskthreshold = std::max<uint8_t>(threshold, 1); }
+
+		/** @see setAlphaMaskThreshold
+		 */
+		uint8_t getAlphaMaskThreshold() const { return m_alphamaskthreshold; }
+
 		/** Sets the texture filtering method.
 		 * Supports none, bilinear, trilinear and anisotropic filtering.
 		 * Note! Works only for OpenGL backends.
@@ -469,6 +520,51 @@ namespace FIFE {
 		 */
 		uint16_t getFrameLimit() const;
 
+		/** Sets whether only the damaged screen areas are redrawn.
+		 * The last frame is kept and drawing is clipped to the dirty rects.
+		 * Only supported by the SDL backend, the other backends ignore it.
+		 * Content changes of the view renderers are not tracked, see RendererBase.
+		 */
+		virtual void setDirtyRectsEnabled(bool enabled);
+
+		/** Gets whether only the damaged screen areas are redrawn
+		 */
+		bool isDirtyRectsEnabled() const;
+
+		/** Marks a screen area as damaged. It is redrawn in this and in the next frame,
+		 * so areas that are reported after the drawing started are also updated.
+		 */
+		void addDirtyRect(const Rect& rect);
+
+		/** Marks the whole screen as damaged.
+		 */
+		void invalidateScreen();
+
+		/** Returns true if the area intersects the dirty area or if dirty rects are disabled.
+		 * The dirty area is cleared and redrawn as a whole, see getDirtyArea.
+		 */
+		bool isDirty(const Rect& area) const;
+
+		/** Returns the bounding box of the dirty rects that are redrawn in this frame.
+		 */
+		Rect getDirtyArea() const;
+
+		/** Returns the counters of the current frame.
+		 * The difference of two calls gives the work done in between.
+		 */
+		const RenderCounters& getRenderCounters() const;
+
+		/** Returns the counters of the last finished frame.
+		 */
+		const RenderCounters& getFrameCounters() const;
+
+		/** Counts a draw call, used by the backends and their images.
+		 */
+		void addDrawCall(uint32_t vertices) {
+			++m_counters.drawCalls;
+			m_counters.vertices += vertices;
+		}
+
 		/** Returns screen render surface
 		 */
 		 SDL_Surface* getScreenSurface();
@@ -510,7 +606,10 @@ namespace FIFE {
 		bool m_compressimages;
 		bool m_useframebuffer;
 		bool m_usenpot;
+		bool m_usevertexbuffers;
 		bool m_isalphaoptimized;
+		bool m_alphamasks;
+		uint8_t m_alphamaskthreshold;
 		bool m_iscolorkeyenabled;
 		SDL_Color m_colorkey;
 		ScreenMode m_screenMode;
@@ -547,6 +646,18 @@ namespace FIFE {
 		std::stack<ClipInfo> m_clipstack;
 
 		ClipInfo m_guiClip;
+
+		// only damaged areas are redrawn
+		bool m_dirtyRects;
+		// damaged areas of the current frame
+		std::vector<Rect> m_dirtyAreas;
+		// damaged areas of the previous frame
+		std::vector<Rect> m_lastDirtyAreas;
+
+		// work of the current frame
+		RenderCounters m_counters;
+		// work of the last finished frame
+		RenderCounters m_frameCounters;
 	private:
 		bool m_isframelimit;
 		uint32_t m_frame_start;
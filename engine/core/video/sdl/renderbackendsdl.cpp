@@ -45,10 +45,14 @@ namespace FIFE {
 
 	RenderBackendSDL::RenderBackendSDL(const SDL_Color& colorkey) :
 		RenderBackend(colorkey),
-		m_renderer(NULL) {
+		m_renderer(NULL),
+		m_frameTexture(NULL) {
 	}
 
 	RenderBackendSDL::~RenderBackendSDL() {
+		if (m_frameTexture) {
+			SDL_DestroyTexture(m_frameTexture);
+		}
 		SDL_DestroyRenderer(m_renderer);
 		SDL_DestroyWindow(m_window);
 		deinit();
@@ -71,6 +75,7 @@ namespace FIFE {
 	}
 
 	void RenderBackendSDL::clearBackBuffer() {
+		invalidateScreen();
 		SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 255);
 		SDL_RenderClear(m_renderer);
 	}
@@ -96,6 +101,10 @@ namespace FIFE {
 		uint32_t flags = mode.getSDLFlags();
 		// in case of recreating
 		if (m_window) {
+			if (m_frameTexture) {
+				SDL_DestroyTexture(m_frameTexture);
+				m_frameTexture = NULL;
+			}
 			SDL_DestroyRenderer(m_renderer);
 			SDL_DestroyWindow(m_window);
 			m_screen = NULL;
@@ -173,13 +182,67 @@ namespace FIFE {
 
 	void RenderBackendSDL::startFrame() {
 		RenderBackend::startFrame();
+		if (!m_dirtyRects) {
+			return;
+		}
+		if (!m_frameTexture) {
+			m_frameTexture = SDL_CreateTexture(m_renderer, m_rgba_format.format, SDL_TEXTUREACCESS_TARGET, getWidth(), getHeight());
+			if (!m_frameTexture) {
+				throw SDLException(SDL_GetError());
+			}
+			SDL_SetTextureBlendMode(m_frameTexture, SDL_BLENDMODE_NONE);
+			invalidateScreen();
+		}
+		SDL_SetRenderTarget(m_renderer, m_frameTexture);
+		// clears the damaged areas, drawing is clipped to them
+		setClipArea(getArea(), true);
 	}
 
 	void RenderBackendSDL::endFrame() {
+		if (m_dirtyRects && m_frameTexture) {
+			SDL_SetRenderTarget(m_renderer, NULL);
+			SDL_RenderSetClipRect(m_renderer, NULL);
+			SDL_RendererInfo info;
+			SDL_GetRendererInfo(m_renderer, &info);
+			if ((info.flags & SDL_RENDERER_SOFTWARE) == SDL_RENDERER_SOFTWARE) {
+				// the window surface keeps its content, so only the damaged areas are copied
+				copyFrameAreas(m_dirtyAreas);
+				copyFrameAreas(m_lastDirtyAreas);
+			} else {
+				// the content of the back buffer is undefined after presenting
+				SDL_RenderCopy(m_renderer, m_frameTexture, NULL, NULL);
+			}
+		}
 		SDL_RenderPresent(m_renderer);
 		RenderBackend::endFrame();
 	}
 
+	void RenderBackendSDL::copyFrameAreas(const std::vector<Rect>& areas) {
+		std::vector<Rect>::const_iterator it = areas.begin();
+		for (; it != areas.end(); ++it) {
+			SDL_Rect rect;
+			rect.x = it->x;
+			rect.y = it->y;
+			rect.w = it->w;
+			rect.h = it->h;
+			SDL_RenderCopy(m_renderer, m_frameTexture, &rect, &rect);
+		}
+	}
+
+	void RenderBackendSDL::setDirtyRectsEnabled(bool enabled) {
+		if (m_dirtyRects == enabled) {
+			return;
+		}
+		m_dirtyRects = enabled;
+		m_dirtyAreas.clear();
+		m_lastDirtyAreas.clear();
+		if (!enabled && m_frameTexture) {
+			SDL_DestroyTexture(m_frameTexture);
+			m_frameTexture = NULL;
+		}
+		invalidateScreen();
+	}
+
 	Image* RenderBackendSDL::createImage(IResourceLoader* loader) {
 		return new SDLImage(loader);
 	}
@@ -225,6 +288,7 @@ namespace FIFE {
 	}
 
 	void RenderBackendSDL::renderVertexArrays() {
+		++m_counters.flushes;
 	}
 
 	void RenderBackendSDL::addImageToArray(uint32_t id, const Rect& rec, float const* st, uint8_t alpha, uint8_t const* rgba) {
@@ -650,11 +714,16 @@ namespace FIFE {
 	}
 
 	void RenderBackendSDL::setClipArea(const Rect& cliparea, bool clear) {
+		Rect area = cliparea;
+		if (m_dirtyRects && m_target == m_screen) {
+			// only the damaged areas are drawn
+			area.intersectInplace(getDirtyArea());
+		}
 		SDL_Rect rect;
-		rect.x = cliparea.x;
-		rect.y = cliparea.y;
-		rect.w = cliparea.w;
-		rect.h = cliparea.h;
+		rect.x = area.x;
+		rect.y = area.y;
+		rect.w = area.w;
+		rect.h = area.h;
 		SDL_RenderSetClipRect(m_renderer, &rect);
 		if (clear) {
 			if (m_isbackgroundcolor) {
@@ -667,21 +736,30 @@ namespace FIFE {
 	}
 
 	void RenderBackendSDL::attachRenderTarget(ImagePtr& img, bool discard) {
+		++m_counters.renderTargetSwitches;
 		SDLImage* image = static_cast<SDLImage*>(img.get());
 		m_target = img->getSurface();
 		SDL_Texture* texture = image->getTexture();
 		if (!texture) {
 			texture = SDL_CreateTexture(m_renderer, m_rgba_format.format, SDL_TEXTUREACCESS_TARGET, m_target->w, m_target->h);
+			// the target is drawn with its alpha, so it can be used above other layers
+			SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
 			image->setTexture(texture);
 		}
 		SDL_SetRenderTarget(m_renderer, texture);
-		setClipArea(img->getArea(), discard);
+		setClipArea(img->getArea(), false);
+		if (discard) {
+			// clears to transparent instead of the background color
+			SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 0);
+			SDL_RenderClear(m_renderer);
+		}
 	}
 
 	void RenderBackendSDL::detachRenderTarget(){
+		++m_counters.renderTargetSwitches;
 		SDL_RenderPresent(m_renderer);
 		m_target = m_screen;
-		SDL_SetRenderTarget(m_renderer, NULL);
+		SDL_SetRenderTarget(m_renderer, m_dirtyRects ? m_frameTexture : NULL);
 	}
 	
 	void RenderBackendSDL::renderGuiGeometry(const std::vector<GuiVertex>& vertices, const std::vector<int>& indices, const DoublePoint& translation, ImagePtr texture) {
@@ -96,12 +96,20 @@ namespace FIFE {
 
 		virtual void renderGuiGeometry(const std::vector<GuiVertex>& vertices, const std::vector<int>& indices, const DoublePoint& translation, ImagePtr texture);
 
+		virtual void setDirtyRectsEnabled(bool enabled);
+
 		SDL_Renderer* getRenderer() { return m_renderer; }
 		
 	protected:
 		virtual void setClipArea(const Rect& cliparea, bool clear);
 
+		/** Copies the areas of the kept frame to the window.
+		 */
+		void copyFrameAreas(const std::vector<Rect>& areas);
+
 		SDL_Renderer* m_renderer;
+		// keeps the last frame in dirty rect mode
+		SDL_Texture* m_frameTexture;
 	};
 
 }
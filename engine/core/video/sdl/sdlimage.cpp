@@ -146,6 +146,7 @@ namespace FIFE {
 		if (SDL_RenderCopy(renderer, m_texture, &srcRect, &tarRect) != 0) {
 			throw SDLException(SDL_GetError());
 		}
+		RenderBackend::instance()->addDrawCall(4);
 	}
 
 	size_t SDLImage::getSize() {
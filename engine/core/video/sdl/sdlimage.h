@@ -59,6 +59,9 @@ namespace FIFE {
 		SDL_Texture* getTexture();
 		void setTexture(SDL_Texture* texture);
 
+	protected:
+		virtual Image* getSharedImage() { return m_atlas_img.get(); }
+
 	private:
 		void resetSdlimage();
 		void validateShared();
@@ -129,6 +129,15 @@ namespace FIFE {
 		virtual void invalidate(const std::string& name);
 		virtual void invalidate(ResourceHandle handle);
 		virtual void invalidateAll();
+
+		void setLodEnabled(bool enabled);
+		bool isLodEnabled() const;
+		void setLodMemoryLimit(size_t limit);
+		size_t getLodMemoryLimit() const;
+		size_t getLodMemoryUsed() const;
+		uint32_t getLodLevel(double zoom) const;
+		ImagePtr getLodImage(const ImagePtr& image, uint32_t level);
+		void removeLodImages();
 	};
 	
 	class Animation: public IResource {
@@ -201,6 +210,16 @@ namespace FIFE {
 		TEXTURE_FILTER_ANISOTROPIC = 3
 	};
 
+	class RenderCounters {
+	public:
+		RenderCounters();
+		uint32_t drawCalls;
+		uint32_t vertices;
+		uint32_t textureBinds;
+		uint32_t renderTargetSwitches;
+		uint32_t flushes;
+	};
+
 	class RenderBackend {
 	public:
 		virtual ~RenderBackend();
@@ -223,6 +242,12 @@ namespace FIFE {
 		bool isFramebufferEnabled() const;
 		void setNPOTEnabled(bool enabled);
 		bool isNPOTEnabled() const;
+		void setVertexBuffersEnabled(bool enabled);
+		bool isVertexBuffersEnabled() const;
+		void setAlphaMasksEnabled(bool enabled);
+		bool isAlphaMasksEnabled() const;
+		void setAlphaMaskThreshold(uint8_t threshold);
+		uint8_t getAlphaMaskThreshold() const;
 		void setTextureFiltering(TextureFiltering filter);
 		TextureFiltering getTextureFiltering() const;
 		void setMipmappingEnabled(bool enabled);
@@ -242,6 +267,12 @@ namespace FIFE {
 		bool isFrameLimitEnabled() const;
 		void setFrameLimit(uint16_t framelimit);
 		uint16_t getFrameLimit() const;
+		void setDirtyRectsEnabled(bool enabled);
+		bool isDirtyRectsEnabled() const;
+		void addDirtyRect(const Rect& rect);
+		void invalidateScreen();
+		const RenderCounters& getRenderCounters() const;
+		const RenderCounters& getFrameCounters() const;
 	};
 	
 	enum MouseCursorType {
@@ -339,6 +370,8 @@ namespace FIFE {
 		int32_t getDesktopWidth(uint8_t display = 0) const;
 		int32_t getDesktopHeight(uint8_t display = 0) const;
 		Rect getDisplayBounds(uint8_t display = 0) const;
+		static bool isVertexBufferStreamingSupported();
+		static bool isBufferRangeMappingSupported();
 	};
 	
 	class AtlasBlock {
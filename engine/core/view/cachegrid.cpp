@@ -0,0 +1,193 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "cachegrid.h"
+
+namespace FIFE {
+	//! buckets per axis of a new grid
+	static const int32_t INITIAL_SIZE = 16;
+
+	static inline int32_t floorDiv(int32_t value, int32_t divisor) {
+		int32_t q = value / divisor;
+		return (value % divisor != 0 && value < 0) ? q - 1 : q;
+	}
+
+	const int32_t CacheGrid::MAX_SIZE;
+	const int32_t CacheGrid::LARGE_BUCKET;
+	const int32_t CacheGrid::NO_BUCKET;
+
+	CacheGrid::CacheGrid(int32_t bucketSize):
+		m_bucketSize(std::max(bucketSize, 1)),
+		m_originX(0),
+		m_originY(0),
+		m_width(0),
+		m_height(0) {
+	}
+
+	void CacheGrid::update(int32_t index, const Rect& bbox) {
+		if (static_cast<int32_t>(m_itemBucket.size()) <= index) {
+			m_itemBucket.resize(index + 1, NO_BUCKET);
+			m_itemSlot.resize(index + 1, 0);
+			m_itemX.resize(index + 1, 0);
+			m_itemY.resize(index + 1, 0);
+		}
+
+		int32_t bucket = LARGE_BUCKET;
+		if (bbox.w <= m_bucketSize && bbox.h <= m_bucketSize) {
+			int32_t bx = floorDiv(bbox.x, m_bucketSize);
+			int32_t by = floorDiv(bbox.y, m_bucketSize);
+			m_itemX[index] = bx;
+			m_itemY[index] = by;
+			if (m_width == 0 || bx < m_originX || by < m_originY ||
+				bx >= m_originX + m_width || by >= m_originY + m_height) {
+				grow(bx, by);
+			}
+			bucket = getBucket(bx, by);
+		}
+
+		if (bucket != m_itemBucket[index]) {
+			remove(index);
+			insert(index, bucket);
+		}
+	}
+
+	void CacheGrid::remove(int32_t index) {
+		if (index >= static_cast<int32_t>(m_itemBucket.size()) || m_itemBucket[index] == NO_BUCKET) {
+			return;
+		}
+		int32_t bucket = m_itemBucket[index];
+		std::vector<int32_t>& items = bucket == LARGE_BUCKET ? m_large : m_buckets[bucket];
+		int32_t slot = m_itemSlot[index];
+		// moves the last item into the free slot
+		int32_t last = items.back();
+		items[slot] = last;
+		m_itemSlot[last] = slot;
+		items.pop_back();
+		m_itemBucket[index] = NO_BUCKET;
+	}
+
+	void CacheGrid::clear() {
+		m_buckets.clear();
+		m_large.clear();
+		m_itemBucket.clear();
+		m_itemSlot.clear();
+		m_itemX.clear();
+		m_itemY.clear();
+		m_originX = 0;
+		m_originY = 0;
+		m_width = 0;
+		m_height = 0;
+	}
+
+	void CacheGrid::collect(const Rect& area, std::vector<int32_t>& indices) const {
+		indices.insert(indices.end(), m_large.begin(), m_large.end());
+		if (m_width == 0) {
+			return;
+		}
+		// items start at most one bucket before the area
+		int32_t x0 = std::max(floorDiv(area.x, m_bucketSize) - 1, m_originX) - m_originX;
+		int32_t y0 = std::max(floorDiv(area.y, m_bucketSize) - 1, m_originY) - m_originY;
+		int32_t x1 = std::min(floorDiv(area.right(), m_bucketSize), m_originX + m_width - 1) - m_originX;
+		int32_t y1 = std::min(floorDiv(area.bottom(), m_bucketSize), m_originY + m_height - 1) - m_originY;
+		// the border buckets also hold the items outside of the grid
+		x0 = std::min(x0, m_width - 1);
+		y0 = std::min(y0, m_height - 1);
+		x1 = std::max(x1, 0);
+		y1 = std::max(y1, 0);
+		for (int32_t y = y0; y <= y1; ++y) {
+			const std::vector<int32_t>* row = &m_buckets[y * m_width];
+			for (int32_t x = x0; x <= x1; ++x) {
+				indices.insert(indices.end(), row[x].begin(), row[x].end());
+			}
+		}
+	}
+
+	uint32_t CacheGrid::getBucketCount() const {
+		return m_buckets.size();
+	}
+
+	int32_t CacheGrid::getBucket(int32_t bx, int32_t by) const {
+		int32_t x = std::min(std::max(bx - m_originX, 0), m_width - 1);
+		int32_t y = std::min(std::max(by - m_originY, 0), m_height - 1);
+		return y * m_width + x;
+	}
+
+	void CacheGrid::insert(int32_t index, int32_t bucket) {
+		std::vector<int32_t>& items = bucket == LARGE_BUCKET ? m_large : m_buckets[bucket];
+		m_itemBucket[index] = bucket;
+		m_itemSlot[index] = items.size();
+		items.push_back(index);
+	}
+
+	void CacheGrid::grow(int32_t bx, int32_t by) {
+		int32_t minX = bx - INITIAL_SIZE / 2;
+		int32_t minY = by - INITIAL_SIZE / 2;
+		int32_t maxX = minX + INITIAL_SIZE - 1;
+		int32_t maxY = minY + INITIAL_SIZE - 1;
+		if (m_width != 0) {
+			// grows by at least the half size, so items can move without a rebuild per step
+			minX = m_originX;
+			minY = m_originY;
+			maxX = m_originX + m_width - 1;
+			maxY = m_originY + m_height - 1;
+			if (bx < minX) {
+				minX = std::max(std::min(bx, minX - m_width / 2), maxX + 1 - MAX_SIZE);
+			} else if (bx > maxX) {
+				maxX = std::min(std::max(bx, maxX + m_width / 2), minX + MAX_SIZE - 1);
+			}
+			if (by < minY) {
+				minY = std::max(std::min(by, minY - m_height / 2), maxY + 1 - MAX_SIZE);
+			} else if (by > maxY) {
+				maxY = std::min(std::max(by, maxY + m_height / 2), minY + MAX_SIZE - 1);
+			}
+			if (minX == m_originX && minY == m_originY &&
+				maxX == m_originX + m_width - 1 && maxY == m_originY + m_height - 1) {
+				// the grid has its maximal size, the item goes into a border bucket
+				return;
+			}
+		}
+
+		m_originX = minX;
+		m_originY = minY;
+		m_width = maxX - minX + 1;
+		m_height = maxY - minY + 1;
+		m_buckets.clear();
+		m_buckets.resize(m_width * m_height);
+		// places the items again, items clamped to the old border can get their own bucket now
+		const int32_t count = m_itemBucket.size();
+		for (int32_t i = 0; i < count; ++i) {
+			int32_t bucket = m_itemBucket[i];
+			if (bucket >= 0) {
+				insert(i, getBucket(m_itemX[i], m_itemY[i]));
+			}
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VIEW_CACHEGRID_H
+#define FIFE_VIEW_CACHEGRID_H
+
+// Standard C++ library includes
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+
+namespace FIFE {
+
+	/** Uniform grid of screen space buckets, an alternative to the quadtree of the LayerCache.
+	 *
+	 * Each item is stored in the bucket of the top left corner of its bounding box,
+	 * items that are larger than a bucket are kept in a separate list.
+	 * Buckets and the per item positions are flat arrays, so moving an item only
+	 * swaps two indices. The grid grows with the items up to MAX_SIZE buckets per axis,
+	 * items outside of that are stored in the border buckets.
+	 */
+	class CacheGrid {
+	public:
+		//! maximal number of buckets per axis
+		static const int32_t MAX_SIZE = 512;
+
+		/** Constructor
+		 * @param bucketSize Width and height of a bucket in screen pixels.
+		 */
+		CacheGrid(int32_t bucketSize = 128);
+
+		/** Inserts the item or moves it to the bucket of the new bounding box.
+		 * @param index Item index, should be small because per item arrays are indexed by it.
+		 * @param bbox Bounding box of the item.
+		 */
+		void update(int32_t index, const Rect& bbox);
+
+		/** Removes the item, does nothing if it is not in the grid.
+		 */
+		void remove(int32_t index);
+
+		/** Removes all items.
+		 */
+		void clear();
+
+		/** Appends the items that can intersect the area. The list can contain items that do not intersect it.
+		 */
+		void collect(const Rect& area, std::vector<int32_t>& indices) const;
+
+		/** Returns the number of buckets.
+		 */
+		uint32_t getBucketCount() const;
+
+	private:
+		//! bucket id of items in m_large
+		static const int32_t LARGE_BUCKET = -2;
+		//! bucket id of items that are not in the grid
+		static const int32_t NO_BUCKET = -1;
+
+		int32_t getBucket(int32_t bx, int32_t by) const;
+		void insert(int32_t index, int32_t bucket);
+		void grow(int32_t bx, int32_t by);
+
+		//! width and height of a bucket
+		int32_t m_bucketSize;
+		//! bucket coordinates of the first bucket
+		int32_t m_originX;
+		int32_t m_originY;
+		//! number of buckets per axis
+		int32_t m_width;
+		int32_t m_height;
+		//! item indices per bucket, row by row
+		std::vector<std::vector<int32_t> > m_buckets;
+		//! items larger than a bucket
+		std::vector<int32_t> m_large;
+		//! per item the bucket id
+		std::vector<int32_t> m_itemBucket;
+		//! per item the position in its bucket
+		std::vector<int32_t> m_itemSlot;
+		//! per item the bucket coordinates, used to rebuild the grid after it grew
+		std::vector<int32_t> m_itemX;
+		std::vector<int32_t> m_itemY;
+	};
+}
+
+#endif
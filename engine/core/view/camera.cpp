@@ -36,6 +36,7 @@
 #include "model/structures/instancetree.h"
 #include "model/structures/instance.h"
 #include "model/structures/location.h"
+#include "util/concurrency/workerpool.h"
 #include "util/log/logger.h"
 #include "util/math/fife_math.h"
 #include "util/math/angles.h"
@@ -44,6 +45,7 @@
 #include "video/image.h"
 #include "video/animation.h"
 #include "video/imagemanager.h"
+#include "view/renderers/instancerenderer.h"
 
 #include "camera.h"
 #include "layercache.h"
@@ -55,6 +57,69 @@ namespace FIFE {
 
 	// to avoid std::bad_alloc errors, we determine the maximum size of batches
 	const uint32_t MAX_BATCH_SIZE = 100000;
+	// size of the screen cells used for occlusion culling
+	const int32_t OCCLUSION_CELL_SIZE = 16;
+
+	/** Marks the screen cells covered by the opaque area of the item's image.
+	 * Only items the InstanceRenderer draws as a single opaque image qualify.
+	 */
+	static void coverOpaqueArea(CoverageBuffer& coverage, RenderItem& item) {
+		if (!item.image || item.transparency != 255 || item.m_overlay) {
+			return;
+		}
+		const Rect& opaque = item.image->getOpaqueRect();
+		int32_t w = item.image->getWidth();
+		int32_t h = item.image->getHeight();
+		if (opaque.w <= 0 || opaque.h <= 0 || w <= 0 || h <= 0) {
+			return;
+		}
+		// scales the opaque area to the zoomed size, rounded inwards
+		const Rect& dim = item.dimensions;
+		int32_t left = dim.x + (opaque.x * dim.w + w - 1) / w;
+		int32_t top = dim.y + (opaque.y * dim.h + h - 1) / h;
+		int32_t right = dim.x + (opaque.right() * dim.w) / w;
+		int32_t bottom = dim.y + (opaque.bottom() * dim.h) / h;
+		coverage.cover(Rect(left, top, right - left, bottom - top));
+	}
+
+	/** Maps a position relative to the item to the item's image, the same way the pixel picking does.
+	 */
+	static Point mapToImage(const RenderItem& item, const ImagePtr& image, int32_t x, int32_t y, bool zoomed) {
+		if (zoomed) {
+			x = static_cast<int32_t>(round(static_cast<double>(x) / item.dimensions.w * image->getWidth()));
+			y = static_cast<int32_t>(round(static_cast<double>(y) / item.dimensions.h * image->getHeight()));
+		}
+		return Point(x, y);
+	}
+
+	/** Tests the alpha mask of the image against the screen area, the area must be inside the item.
+	 */
+	static bool hitsAlphaMask(const RenderItem& item, const ImagePtr& image, const Rect& area, bool zoomed) {
+		if (image->isSharedImage()) {
+			image->forceLoadInternal();
+		}
+		Point p1 = mapToImage(item, image, area.x - item.dimensions.x, area.y - item.dimensions.y, zoomed);
+		if (area.w == 1 && area.h == 1) {
+			return image->isAlphaMaskHit(p1.x, p1.y);
+		}
+		Point p2 = mapToImage(item, image, area.right() - 1 - item.dimensions.x, area.bottom() - 1 - item.dimensions.y, zoomed);
+		return image->isAlphaMaskHit(Rect(p1.x, p1.y, p2.x - p1.x + 1, p2.y - p1.y + 1));
+	}
+
+	/** Tests the image or the animation overlay of the item against the screen area.
+	 */
+	static bool hitsItem(const RenderItem& item, const Rect& area, bool zoomed) {
+		std::vector<ImagePtr>* ao = item.getAnimationOverlay();
+		if (!ao) {
+			return hitsAlphaMask(item, item.image, area, zoomed);
+		}
+		for (std::vector<ImagePtr>::iterator it = ao->begin(); it != ao->end(); ++it) {
+			if (hitsAlphaMask(item, *it, area, zoomed)) {
+				return true;
+			}
+		}
+		return false;
+	}
 
 	class MapObserver : public MapChangeListener {
 		Camera* m_camera;
@@ -105,6 +170,14 @@ namespace FIFE {
 		m_pipeline(),
 		m_updated(false),
 		m_layerToInstances(),
+		m_workerPool(NULL),
+		m_occlusionCulling(false),
+		m_coverage(OCCLUSION_CELL_SIZE),
+		m_visibleInstances(),
+		m_occlusionCandidates(0),
+		m_occluded(0),
+		m_pickingBuffer(false),
+		m_statisticsEnabled(false),
 		m_lighting(false),
 		m_light_colors(),
 		m_col_overlay(false),
@@ -132,6 +205,7 @@ namespace FIFE {
 		}
 		m_renderers.clear();
 		delete m_map_observer;
+		delete m_workerPool;
 	}
 
 	void Camera::init() {
@@ -347,6 +421,89 @@ namespace FIFE {
 		return m_enabled;
 	}
 
+	void Camera::setParallelUpdate(bool enabled, uint32_t threads) {
+		delete m_workerPool;
+		m_workerPool = NULL;
+		if (enabled) {
+			m_workerPool = new WorkerPool(threads);
+			FL_LOG(_log, LMsg("parallel layer cache update with ") << m_workerPool->getThreadCount() << " worker threads");
+		}
+		std::map<Layer*, LayerCache*>::iterator it = m_cache.begin();
+		for (; it != m_cache.end(); ++it) {
+			it->second->setWorkerPool(m_workerPool);
+		}
+	}
+
+	bool Camera::isParallelUpdate() const {
+		return m_workerPool != NULL;
+	}
+
+	void Camera::setOcclusionCulling(bool enabled) {
+		m_occlusionCulling = enabled;
+		m_visibleInstances.clear();
+		m_occlusionCandidates = 0;
+		m_occluded = 0;
+	}
+
+	bool Camera::isOcclusionCulling() const {
+		return m_occlusionCulling;
+	}
+
+	uint32_t Camera::getOcclusionCandidateCount() const {
+		return m_occlusionCandidates;
+	}
+
+	void Camera::setPickingBufferEnabled(bool enabled) {
+		m_pickingBuffer = enabled;
+		m_idBuffers.clear();
+	}
+
+	bool Camera::isPickingBufferEnabled() const {
+		return m_pickingBuffer;
+	}
+
+	void Camera::setRenderStatisticsEnabled(bool enabled) {
+		m_statisticsEnabled = enabled;
+		m_statistics.clear();
+	}
+
+	bool Camera::isRenderStatisticsEnabled() const {
+		return m_statisticsEnabled;
+	}
+
+	const RenderStatistics& Camera::getRenderStatistics() const {
+		return m_statistics;
+	}
+
+	void Camera::beginRenderStatistic() {
+		m_statisticStart = std::chrono::steady_clock::now();
+		m_statisticCounters = m_renderbackend->getRenderCounters();
+	}
+
+	void Camera::endRenderStatistic(const std::string& layer, const std::string& renderer, uint32_t items, uint32_t culled) {
+		RenderStatistic statistic;
+		statistic.layer = layer;
+		statistic.renderer = renderer;
+		statistic.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_statisticStart).count();
+		statistic.items = items;
+		statistic.culled = culled;
+		statistic.counters = m_renderbackend->getRenderCounters() - m_statisticCounters;
+		m_statistics.addStatistic(statistic);
+	}
+
+	InstanceIdBuffer& Camera::getIdBuffer(Layer* layer) {
+		InstanceIdBuffer& buffer = m_idBuffers[layer];
+		const RenderList& layer_instances = m_layerToInstances[layer];
+		if (!buffer.isValid(layer_instances.size())) {
+			buffer.build(m_viewport, layer_instances);
+		}
+		return buffer;
+	}
+
+	uint32_t Camera::getOccludedCount() const {
+		return m_occluded;
+	}
+
 	void Camera::setPosition(const ExactModelCoordinate& position) {
 		if (Mathd::Equal(m_position.x, position.x) && Mathd::Equal(m_position.y, position.y)) {
 			return;
@@ -527,6 +684,18 @@ namespace FIFE {
 		bool special_alpha = alpha != 0;
 
 		const RenderList& layer_instances = m_layerToInstances[&layer];
+		if (m_pickingBuffer && std::max<uint8_t>(alpha, 1) == m_renderbackend->getAlphaMaskThreshold()) {
+			const Point point(screen_coords.x, screen_coords.y);
+			std::vector<uint32_t> ids;
+			getIdBuffer(&layer).getIds(point, ids);
+			for (std::vector<uint32_t>::const_iterator it = ids.begin(); it != ids.end(); ++it) {
+				const RenderItem& vc = *layer_instances[*it];
+				if (vc.dimensions.contains(point) && hitsItem(vc, Rect(point.x, point.y, 1, 1), zoomed)) {
+					instances.push_back(vc.instance);
+				}
+			}
+			return;
+		}
 		RenderList::const_iterator instance_it = layer_instances.end();
 		while (instance_it != layer_instances.begin()) {
 			--instance_it;
@@ -582,6 +751,18 @@ namespace FIFE {
 		bool special_alpha = alpha != 0;
 
 		const RenderList& layer_instances = m_layerToInstances[&layer];
+		if (m_pickingBuffer && std::max<uint8_t>(alpha, 1) == m_renderbackend->getAlphaMaskThreshold()) {
+			std::vector<uint32_t> ids;
+			getIdBuffer(&layer).getIds(screen_rect, ids);
+			for (std::vector<uint32_t>::const_iterator it = ids.begin(); it != ids.end(); ++it) {
+				const RenderItem& vc = *layer_instances[*it];
+				Rect area = vc.dimensions;
+				if (area.intersectInplace(screen_rect) && hitsItem(vc, area, zoomed)) {
+					instances.push_back(vc.instance);
+				}
+			}
+			return;
+		}
 		RenderList::const_iterator instance_it = layer_instances.end();
 		while (instance_it != layer_instances.begin()) {
 			--instance_it;
@@ -720,6 +901,7 @@ namespace FIFE {
 
 	void Camera::onRendererPipelinePositionChanged(RendererBase* renderer) {
 		m_pipeline.sort(pipelineSort);
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	void Camera::onRendererEnabledChanged(RendererBase* renderer) {
@@ -731,6 +913,7 @@ namespace FIFE {
 		} else {
 			m_pipeline.remove(renderer);
 		}
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	RendererBase* Camera::getRenderer(const std::string& name) {
@@ -747,6 +930,7 @@ namespace FIFE {
 	void Camera::addLayer(Layer* layer) {
 		m_cache[layer] = new LayerCache(this);
 		m_cache[layer]->setLayer(layer);
+		m_cache[layer]->setWorkerPool(m_workerPool);
 		m_layerToInstances[layer] = RenderList();
 		refresh();
 	}
@@ -755,6 +939,8 @@ namespace FIFE {
 		delete m_cache[layer];
 		m_cache.erase(layer);
 		m_layerToInstances.erase(layer);
+		m_visibleInstances.erase(layer);
+		m_idBuffers.erase(layer);
 		if (m_location.getLayer() == layer) {
 			m_location.reset();
 		}
@@ -789,6 +975,7 @@ namespace FIFE {
 		m_overlay_color.g = green;
 		m_overlay_color.b = blue;
 		m_overlay_color.a = alpha;
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	std::vector<uint8_t> Camera::getOverlayColor() {
@@ -808,12 +995,14 @@ namespace FIFE {
 
 	void Camera::resetOverlayColor() {
 		m_col_overlay = false;
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	void Camera::setOverlayImage(int32_t id, bool fill) {
 		m_img_overlay = true;
 		m_img_id = id;
 		m_img_fill = fill;
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	int32_t Camera::getOverlayImage() {
@@ -827,6 +1016,7 @@ namespace FIFE {
 	void Camera::resetOverlayImage() {
 		m_img_overlay = false;
 		m_img_id = -1;
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	void Camera::setOverlayAnimation(AnimationPtr anim, bool fill) {
@@ -834,6 +1024,7 @@ namespace FIFE {
 		m_ani_ptr = anim;
 		m_ani_fill = fill;
 		m_start_time = 0;
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	AnimationPtr Camera::getOverlayAnimation() {
@@ -843,6 +1034,7 @@ namespace FIFE {
 	void Camera::resetOverlayAnimation() {
 		m_ani_overlay = false;
 		m_ani_ptr.reset();
+		m_renderbackend->addDirtyRect(m_viewport);
 	}
 
 	void Camera::renderOverlay() {
@@ -900,58 +1092,83 @@ namespace FIFE {
 		}
 	}
 
-	void Camera::renderStaticLayer(Layer* layer, bool update) {
+	Point Camera::getStaticTileOrigin(const RenderTileCache& tiles, const RenderTileCache::Tile& tile) {
+		ScreenPoint base = virtualScreenToScreen(DoublePoint3D(0.0, 0.0, 0.0));
+		return tiles.getScreenOrigin(tile, Point(base.x, base.y));
+	}
+
+	void Camera::renderStaticLayer(Layer* layer) {
 		// ToDo: Remove this function from the camera class to something like engine pre-render.
-		// ToDo: Check if partial rendering of only updated RenderItems to existing FBO is possible/faster in our case.
-		// ToDo: Add and fix support for SDL backend, for SDL it works only on the lowest layer(alpha/transparent bug).
-		LayerCache* cache = m_cache[layer];
-		ImagePtr cacheImage = cache->getCacheImage();
-		if (!cacheImage.get()) {
-			// the cacheImage name will be, camera id + _virtual_layer_image_ + layer id
-			cacheImage = ImageManager::instance()->loadBlank(m_id+"_virtual_layer_image_"+layer->getId(), m_viewport.w, m_viewport.h);
-			cache->setCacheImage(cacheImage);
-			update = true;
-		}
-		if (update) {
-			// for the case that the viewport size is not the same as the screen size,
-			// we have to change the values for OpenGL backend
-			Rect rec(0, m_renderbackend->getHeight()-m_viewport.h, m_viewport.w, m_viewport.h);
-			if (m_renderbackend->getName() == "SDL") {
-				rec = m_viewport;
-			}
-			m_renderbackend->attachRenderTarget(cacheImage, true);
-			// here we use the new viewport size
-			m_renderbackend->pushClipArea(rec, false);
-			// render stuff to texture
-			RenderList& instancesToRender = m_layerToInstances[layer];
-			// split the RenderList into smaller parts
-			if (instancesToRender.size() > MAX_BATCH_SIZE) {
-				uint8_t batches = ceil(instancesToRender.size() / static_cast<float>(MAX_BATCH_SIZE));
-				uint32_t residual = instancesToRender.size() % MAX_BATCH_SIZE;
-				for (uint8_t i = 0; i < batches; ++i) {
-					uint32_t start = i*MAX_BATCH_SIZE;
-					uint32_t end = start + ((i+1 == batches) ? residual : MAX_BATCH_SIZE);
-					RenderList tempList(instancesToRender.begin() + start, instancesToRender.begin() + end);
-					std::list<RendererBase*>::iterator r_it = m_pipeline.begin();
-					for (; r_it != m_pipeline.end(); ++r_it) {
-						if ((*r_it)->isActivedLayer(layer)) {
-							(*r_it)->render(this, layer, tempList);
-							m_renderbackend->renderVertexArrays();
-						}
-					}
-				}
-			} else {
-				std::list<RendererBase*>::iterator r_it = m_pipeline.begin();
-				for (; r_it != m_pipeline.end(); ++r_it) {
-					if ((*r_it)->isActivedLayer(layer)) {
-						(*r_it)->render(this, layer, instancesToRender);
-						m_renderbackend->renderVertexArrays();
-					}
-				}
+		RenderTileCache& tiles = m_cache[layer]->getTileCache();
+		tiles.setTileSize(tiles.getImageSize() / m_zoom);
+
+		// the tiles that cover the viewport
+		DoublePoint3D a = screenToVirtualScreen(Point3D(m_viewport.x, m_viewport.y));
+		DoublePoint3D b = screenToVirtualScreen(Point3D(m_viewport.right(), m_viewport.bottom()));
+		Rect area;
+		area.x = static_cast<int32_t>(floor(std::min(a.x, b.x)));
+		area.y = static_cast<int32_t>(floor(std::min(a.y, b.y)));
+		area.w = static_cast<int32_t>(ceil(std::max(a.x, b.x))) - area.x;
+		area.h = static_cast<int32_t>(ceil(std::max(a.y, b.y))) - area.y;
+		const std::vector<RenderTileCache::Tile*>& visible = tiles.update(area);
+
+		// only the InstanceRenderer is cached, other renderers draw the layer every frame
+		InstanceRenderer* renderer = InstanceRenderer::getInstance(this);
+		if (!renderer || !renderer->isEnabled() || !renderer->isActivedLayer(layer)) {
+			return;
+		}
+		if (m_statisticsEnabled) {
+			beginRenderStatistic();
+		}
+		uint32_t updated = 0;
+		std::vector<RenderTileCache::Tile*>::const_iterator it = visible.begin();
+		for (; it != visible.end(); ++it) {
+			if ((*it)->dirty) {
+				renderStaticTile(layer, **it, getStaticTileOrigin(tiles, **it));
+				++updated;
 			}
-			m_renderbackend->detachRenderTarget();
-			m_renderbackend->popClipArea();
 		}
+		if (m_statisticsEnabled) {
+			endRenderStatistic(layer->getId(), "tiles", updated, 0);
+		}
+	}
+
+	void Camera::renderStaticTile(Layer* layer, RenderTileCache::Tile& tile, const Point& origin) {
+		LayerCache* cache = m_cache[layer];
+		const int32_t size = static_cast<int32_t>(cache->getTileCache().getImageSize());
+		// one pixel more, because of the rounding of the screen coordinates
+		Rect area = cache->getTileCache().getTileArea(tile);
+		area.x -= 1;
+		area.y -= 1;
+		area.w += 2;
+		area.h += 2;
+		RenderList& instances = m_staticTileInstances;
+		cache->collectRenderItems(area, instances);
+
+		// moves the instances into the tile
+		for (RenderList::iterator it = instances.begin(); it != instances.end(); ++it) {
+			(*it)->dimensions.x -= origin.x;
+			(*it)->dimensions.y -= origin.y;
+		}
+
+		// the clip area of the OpenGL backend is inverted, top with bottom
+		Rect rec(0, m_renderbackend->getHeight() - size, size, size);
+		if (m_renderbackend->getName() == "SDL") {
+			rec = Rect(0, 0, size, size);
+		}
+		m_renderbackend->attachRenderTarget(tile.image, true);
+		m_renderbackend->pushClipArea(rec, false);
+		InstanceRenderer::getInstance(this)->render(this, layer, instances);
+		m_renderbackend->renderVertexArrays();
+		m_renderbackend->detachRenderTarget();
+		m_renderbackend->popClipArea();
+
+		for (RenderList::iterator it = instances.begin(); it != instances.end(); ++it) {
+			(*it)->dimensions.x += origin.x;
+			(*it)->dimensions.y += origin.y;
+		}
+		instances.clear();
+		tile.dirty = false;
 	}
 
 	void Camera::updateRenderLists() {
@@ -969,21 +1186,80 @@ namespace FIFE {
 				cache = m_cache[*layer_it];
 				FL_ERR(_log, LMsg("Layer Cache miss! (This shouldn't happen!)") << (*layer_it)->getId());
 			}
+			// static layers are updated too, changed instances mark their render tiles as dirty
 			RenderList& instancesToRender = m_layerToInstances[*layer_it];
-			if ((*layer_it)->isStatic() && m_transform == NoneTransform) {
-				continue;
-			}
 			cache->update(m_transform, instancesToRender);
 		}
 		resetUpdates();
 	}
 
+	void Camera::cullOccludedInstances() {
+		m_occlusionCandidates = 0;
+		m_occluded = 0;
+		m_coverage.reset(m_viewport);
+		InstanceRenderer* renderer = InstanceRenderer::getInstance(this);
+		// with depth buffer the render lists are not sorted, so only instances of higher layers hide others
+		bool sorted = !(m_renderbackend->getName() == "OpenGL" && m_renderbackend->isDepthBufferEnabled());
+
+		// from the front to the back
+		const std::list<Layer*>& layers = m_map->getLayers();
+		std::list<Layer*>::const_reverse_iterator layer_it = layers.rbegin();
+		for (; layer_it != layers.rend(); ++layer_it) {
+			Layer* layer = *layer_it;
+			RenderList& visible = m_visibleInstances[layer];
+			visible.clear();
+			if (layer->isStatic()) {
+				continue;
+			}
+			const RenderList& instances = m_layerToInstances[layer];
+			m_occlusionCandidates += instances.size();
+			bool occluders = renderer && renderer->isEnabled() && renderer->isActivedLayer(layer) &&
+				!renderer->hasTransparentAreas(layer);
+
+			RenderList::const_reverse_iterator it = instances.rbegin();
+			for (; it != instances.rend(); ++it) {
+				if (m_coverage.isCovered((*it)->dimensions)) {
+					++m_occluded;
+					continue;
+				}
+				visible.push_back(*it);
+				if (occluders && sorted) {
+					coverOpaqueArea(m_coverage, **it);
+				}
+			}
+			std::reverse(visible.begin(), visible.end());
+			if (occluders && !sorted) {
+				for (RenderList::const_iterator vit = visible.begin(); vit != visible.end(); ++vit) {
+					coverOpaqueArea(m_coverage, **vit);
+				}
+			}
+		}
+		FL_DBG(_log, LMsg("occlusion culling removed ") << m_occluded << " of " << m_occlusionCandidates << " instances");
+	}
+
 	void Camera::render() {
+		// in dirty rect mode a transformed camera or an animated overlay redraws the whole viewport
+		if (m_transform != NoneTransform || m_ani_overlay) {
+			m_renderbackend->addDirtyRect(m_viewport);
+		}
+		m_statistics.clear();
 		updateRenderLists();
+		// the picking buffers are rebuilt on the next pick
+		for (std::map<Layer*, InstanceIdBuffer>::iterator it = m_idBuffers.begin(); it != m_idBuffers.end(); ++it) {
+			it->second.invalidate();
+		}
 
 		if (!m_map) {
 			return;
 		}
+		// nothing changed on the viewport
+		if (!m_renderbackend->isDirty(m_viewport)) {
+			return;
+		}
+
+		if (m_occlusionCulling) {
+			cullOccludedInstances();
+		}
 
 		uint32_t lm = m_renderbackend->getLightingModel();
 		if (lm != 0) {
@@ -996,10 +1272,9 @@ namespace FIFE {
 		const std::list<Layer*>& layers = m_map->getLayers();
 		std::list<Layer*>::const_iterator layer_it = layers.begin();
 		for ( ; layer_it != layers.end(); ++layer_it) {
-			// layer with static flag will rendered as one texture
+			// layer with static flag will be rendered into cached tiles
 			if ((*layer_it)->isStatic()) {
-				renderStaticLayer(*layer_it, m_updated);
-				continue;
+				renderStaticLayer(*layer_it);
 			}
 		}
 
@@ -1007,26 +1282,75 @@ namespace FIFE {
 
 		layer_it = layers.begin();
 		for ( ; layer_it != layers.end(); ++layer_it) {
-			// layer with static flag will rendered as one texture
+			const uint32_t layerInstances = (*layer_it)->getInstances().size();
+			// layer with static flag, the instances are drawn as cached tiles
 			if ((*layer_it)->isStatic()) {
-				m_cache[*layer_it]->getCacheImage()->render(m_viewport);
-				m_renderbackend->renderVertexArrays();
+				const RenderTileCache& tiles = m_cache[*layer_it]->getTileCache();
+				const int32_t size = static_cast<int32_t>(tiles.getImageSize());
+				RendererBase* instanceRenderer = InstanceRenderer::getInstance(this);
+				if (m_statisticsEnabled) {
+					m_statistics.setCulled((*layer_it)->getId(), layerInstances - m_layerToInstances[*layer_it].size());
+				}
+				std::list<RendererBase*>::iterator r_it = m_pipeline.begin();
+				for (; r_it != m_pipeline.end(); ++r_it) {
+					if (!(*r_it)->isActivedLayer(*layer_it)) {
+						continue;
+					}
+					if (m_statisticsEnabled) {
+						beginRenderStatistic();
+					}
+					uint32_t items = 0;
+					if (*r_it == instanceRenderer) {
+						const std::vector<RenderTileCache::Tile*>& visible = tiles.getVisibleTiles();
+						std::vector<RenderTileCache::Tile*>::const_iterator tile_it = visible.begin();
+						for (; tile_it != visible.end(); ++tile_it) {
+							Point origin = getStaticTileOrigin(tiles, **tile_it);
+							(*tile_it)->image->render(Rect(origin.x, origin.y, size, size));
+						}
+						items = visible.size();
+					} else {
+						(*r_it)->render(this, *layer_it, m_layerToInstances[*layer_it]);
+						items = m_layerToInstances[*layer_it].size();
+					}
+					m_renderbackend->renderVertexArrays();
+					if (m_statisticsEnabled) {
+						endRenderStatistic((*layer_it)->getId(), (*r_it)->getName(), items,
+							layerInstances - m_layerToInstances[*layer_it].size());
+					}
+				}
 				continue;
 			}
-			RenderList& instancesToRender = m_layerToInstances[*layer_it];
-			// split the RenderList into smaller parts
-			if (instancesToRender.size() > MAX_BATCH_SIZE) {
-				uint8_t batches = ceil(instancesToRender.size() / static_cast<float>(MAX_BATCH_SIZE));
-				uint32_t residual = instancesToRender.size() % MAX_BATCH_SIZE;
-				for (uint8_t i = 0; i < batches; ++i) {
-					uint32_t start = i*MAX_BATCH_SIZE;
-					uint32_t end = start + ((i+1 == batches) ? residual : MAX_BATCH_SIZE);
-					RenderList tempList(instancesToRender.begin() + start, instancesToRender.begin() + end);
+			RenderList& allInstances = m_layerToInstances[*layer_it];
+			// only the InstanceRenderer skips hidden instances, other renderers still draw
+			// their text, outlines and markers for them
+			RenderList& visibleInstances = m_occlusionCulling ? m_visibleInstances[*layer_it] : allInstances;
+			RendererBase* instanceRenderer = InstanceRenderer::getInstance(this);
+			const uint32_t culled = layerInstances - visibleInstances.size();
+			if (m_statisticsEnabled) {
+				m_statistics.setCulled((*layer_it)->getId(), culled);
+			}
+			// split the RenderLists into smaller parts
+			if (allInstances.size() > MAX_BATCH_SIZE) {
+				uint32_t batches = (allInstances.size() + MAX_BATCH_SIZE - 1) / MAX_BATCH_SIZE;
+				for (uint32_t i = 0; i < batches; ++i) {
 					std::list<RendererBase*>::iterator r_it = m_pipeline.begin();
 					for (; r_it != m_pipeline.end(); ++r_it) {
 						if ((*r_it)->isActivedLayer(*layer_it)) {
+							RenderList& instancesToRender = (*r_it == instanceRenderer) ? visibleInstances : allInstances;
+							uint32_t start = i * MAX_BATCH_SIZE;
+							if (start >= instancesToRender.size()) {
+								continue;
+							}
+							uint32_t end = std::min(start + MAX_BATCH_SIZE, static_cast<uint32_t>(instancesToRender.size()));
+							RenderList tempList(instancesToRender.begin() + start, instancesToRender.begin() + end);
+							if (m_statisticsEnabled) {
+								beginRenderStatistic();
+							}
 							(*r_it)->render(this, *layer_it, tempList);
 							m_renderbackend->renderVertexArrays();
+							if (m_statisticsEnabled) {
+								endRenderStatistic((*layer_it)->getId(), (*r_it)->getName(), tempList.size(), culled);
+							}
 						}
 					}
 				}
@@ -1034,15 +1358,28 @@ namespace FIFE {
 				std::list<RendererBase*>::iterator r_it = m_pipeline.begin();
 				for (; r_it != m_pipeline.end(); ++r_it) {
 					if ((*r_it)->isActivedLayer(*layer_it)) {
+						RenderList& instancesToRender = (*r_it == instanceRenderer) ? visibleInstances : allInstances;
+						if (m_statisticsEnabled) {
+							beginRenderStatistic();
+						}
 						(*r_it)->render(this, *layer_it, instancesToRender);
 						m_renderbackend->renderVertexArrays();
+						if (m_statisticsEnabled) {
+							endRenderStatistic((*layer_it)->getId(), (*r_it)->getName(), instancesToRender.size(), culled);
+						}
 					}
 				}
 			}
 		}
 
+		if (m_statisticsEnabled) {
+			beginRenderStatistic();
+		}
 		renderOverlay();
 		m_renderbackend->renderVertexArrays();
+		if (m_statisticsEnabled) {
+			endRenderStatistic("", "overlay", 0, 0);
+		}
 		if (m_lighting && lm != 0) {
 			m_renderbackend->resetLighting();
 		}
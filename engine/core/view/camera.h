@@ -26,6 +26,7 @@
 #include <string>
 #include <map>
 #include <algorithm>
+#include <chrono>
 
 // 3rd party library includes
 #include <SDL.h>
@@ -39,7 +40,11 @@
 #include "util/math/matrix.h"
 #include "video/animation.h"
 
+#include "coveragebuffer.h"
+#include "instanceidbuffer.h"
 #include "rendererbase.h"
+#include "renderstatistics.h"
+#include "rendertilecache.h"
 
 namespace FIFE {
 
@@ -49,6 +54,7 @@ namespace FIFE {
 	class RenderBackend;
 	class LayerCache;
 	class MapObserver;
+	class WorkerPool;
 	typedef std::map<Layer*, RenderList > t_layer_to_instances;
 
 	/** Camera describes properties of a view port shown in the main screen
@@ -277,6 +283,65 @@ namespace FIFE {
 		 */
 		bool isEnabled();
 
+		/** Enables or disables the parallel update of the layer caches.
+		 * Animations and screen coordinates of changed instances are then resolved by worker threads.
+		 * @param enabled A boolean, true to use worker threads, otherwise false.
+		 * @param threads Number of worker threads, 0 uses one less than the hardware supports.
+		 */
+		void setParallelUpdate(bool enabled, uint32_t threads = 0);
+
+		/** Returns true if the layer caches are updated in parallel.
+		 */
+		bool isParallelUpdate() const;
+
+		/** Enables or disables occlusion culling.
+		 * Instances that are completely hidden behind opaque images of instances in front of them
+		 * are then not drawn by the InstanceRenderer, the other renderers still get them. Only opaque instances of layers, where the InstanceRenderer
+		 * is active and has no transparent areas, hide other instances.
+		 * @param enabled A boolean, true to enable occlusion culling, otherwise false.
+		 */
+		void setOcclusionCulling(bool enabled);
+
+		/** Returns true if occlusion culling is enabled.
+		 */
+		bool isOcclusionCulling() const;
+
+		/** Returns the number of instances in the render lists before the occlusion culling of the last render.
+		 */
+		uint32_t getOcclusionCandidateCount() const;
+
+		/** Returns the number of instances that were removed by the occlusion culling of the last render.
+		 */
+		uint32_t getOccludedCount() const;
+
+		/** Enables or disables the picking buffer.
+		 * getMatchingInstances then only tests the instances of the touched screen cells and
+		 * uses the alpha masks of the images instead of reading pixels. The buffer of a layer is
+		 * built on the first pick after a render. Only picks with an alpha that matches the
+		 * alpha mask threshold of the render backend use the buffer, 0 counts as 1.
+		 * @param enabled A boolean, true to enable the picking buffer, otherwise false.
+		 */
+		void setPickingBufferEnabled(bool enabled);
+
+		/** Returns true if the picking buffer is enabled.
+		 */
+		bool isPickingBufferEnabled() const;
+
+		/** Enables or disables the render statistics.
+		 * Each render then measures the time and the render backend work per layer and renderer.
+		 * @param enabled A boolean, true to enable the statistics, otherwise false.
+		 */
+		void setRenderStatisticsEnabled(bool enabled);
+
+		/** Returns true if the render statistics are enabled.
+		 */
+		bool isRenderStatisticsEnabled() const;
+
+		/** Returns the statistics of the last render.
+		 * They are empty if the statistics are disabled or if the viewport was not redrawn.
+		 */
+		const RenderStatistics& getRenderStatistics() const;
+
 		/** Returns reference to RenderList.
 		 */
 		RenderList& getRenderListRef(Layer* layer);
@@ -451,9 +516,34 @@ namespace FIFE {
 		 */
 		void renderOverlay();
 
-		/** Renders the layer part that is on screen as one image.
+		/** Updates the render tiles of a static layer that are on screen and renders the dirty ones.
 		 */
-		void renderStaticLayer(Layer* layer, bool update);
+		void renderStaticLayer(Layer* layer);
+
+		/** Starts a measurement of the render statistics.
+		 */
+		void beginRenderStatistic();
+
+		/** Ends the measurement and adds it to the render statistics.
+		 */
+		void endRenderStatistic(const std::string& layer, const std::string& renderer, uint32_t items, uint32_t culled);
+
+		/** Renders the instances of a static layer into the image of the tile.
+		 * @param origin Screen position of the tile's top left corner.
+		 */
+		void renderStaticTile(Layer* layer, RenderTileCache::Tile& tile, const Point& origin);
+
+		/** Returns the screen position of the tile's top left corner.
+		 */
+		Point getStaticTileOrigin(const RenderTileCache& tiles, const RenderTileCache::Tile& tile);
+
+		/** Fills the visible render lists with the instances that are not hidden by opaque instances in front of them.
+		 */
+		void cullOccludedInstances();
+
+		/** Returns the picking buffer of the layer, rebuilt if the render list changed.
+		 */
+		InstanceIdBuffer& getIdBuffer(Layer* layer);
 
 		DoubleMatrix m_matrix;
 		DoubleMatrix m_inverse_matrix;
@@ -495,6 +585,34 @@ namespace FIFE {
 		std::map<Layer*,LayerCache*> m_cache;
 		MapObserver* m_map_observer;
 
+		// worker pool for the layer cache updates, NULL if disabled
+		WorkerPool* m_workerPool;
+
+		// is occlusion culling enabled
+		bool m_occlusionCulling;
+		// screen cells covered by opaque instances
+		CoverageBuffer m_coverage;
+		// render lists without the occluded instances, used by the InstanceRenderer
+		t_layer_to_instances m_visibleInstances;
+		// instances of the static layer tile that is rendered
+		RenderList m_staticTileInstances;
+		// number of instances before and after the occlusion culling
+		uint32_t m_occlusionCandidates;
+		uint32_t m_occluded;
+
+		// is the picking buffer enabled
+		bool m_pickingBuffer;
+		// picking buffers of the layers
+		std::map<Layer*, InstanceIdBuffer> m_idBuffers;
+
+		// are the render statistics enabled
+		bool m_statisticsEnabled;
+		// statistics of the last render
+		RenderStatistics m_statistics;
+		// start of the running measurement
+		std::chrono::steady_clock::time_point m_statisticStart;
+		RenderCounters m_statisticCounters;
+
 		// is lighting enable
 		bool m_lighting;
 		// caches the light color for the camera
@@ -26,6 +26,7 @@
 %}
 
 %include "view/rendererbase.i"
+%include "view/renderstatistics.i"
 
 namespace FIFE {
 	typedef Point3D ScreenPoint;
@@ -67,6 +68,17 @@ namespace FIFE {
 		ExactModelCoordinate toMapCoordinates(ScreenPoint screen_coords, bool z_calculated=true);
 		void setEnabled(bool enabled);
 		bool isEnabled();
+		void setParallelUpdate(bool enabled, uint32_t threads = 0);
+		bool isParallelUpdate() const;
+		void setOcclusionCulling(bool enabled);
+		bool isOcclusionCulling() const;
+		uint32_t getOcclusionCandidateCount() const;
+		uint32_t getOccludedCount() const;
+		void setPickingBufferEnabled(bool enabled);
+		bool isPickingBufferEnabled() const;
+		void setRenderStatisticsEnabled(bool enabled);
+		bool isRenderStatisticsEnabled() const;
+		const RenderStatistics& getRenderStatistics() const;
 		
 		void getMatchingInstances(ScreenPoint screen_coords, Layer& layer, std::list<Instance*>& instances, uint8_t alpha = 0);
 		void getMatchingInstances(Rect screen_rect, Layer& layer, std::list<Instance*>& instances, uint8_t alpha = 0);
@@ -0,0 +1,99 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "coveragebuffer.h"
+
+namespace FIFE {
+
+	CoverageBuffer::CoverageBuffer(int32_t cellSize):
+		m_cellSize(std::max(cellSize, 1)),
+		m_area(0, 0, 0, 0),
+		m_width(0),
+		m_height(0) {
+	}
+
+	void CoverageBuffer::reset(const Rect& area) {
+		m_area = area;
+		m_width = std::max((area.w + m_cellSize - 1) / m_cellSize, 0);
+		m_height = std::max((area.h + m_cellSize - 1) / m_cellSize, 0);
+		m_cells.assign(m_width * m_height, 0);
+	}
+
+	void CoverageBuffer::cover(const Rect& rect) {
+		if (rect.w <= 0 || rect.h <= 0) {
+			return;
+		}
+		// cells completely inside, parts outside of the area are not drawn and count as covered
+		int32_t left = rect.x - m_area.x;
+		int32_t top = rect.y - m_area.y;
+		int32_t right = left + rect.w;
+		int32_t bottom = top + rect.h;
+		if (right <= 0 || bottom <= 0) {
+			return;
+		}
+		int32_t x0 = (left <= 0) ? 0 : (left + m_cellSize - 1) / m_cellSize;
+		int32_t y0 = (top <= 0) ? 0 : (top + m_cellSize - 1) / m_cellSize;
+		int32_t x1 = (right >= m_area.w) ? m_width : right / m_cellSize;
+		int32_t y1 = (bottom >= m_area.h) ? m_height : bottom / m_cellSize;
+		if (x0 >= x1) {
+			return;
+		}
+		for (int32_t y = y0; y < y1; ++y) {
+			std::fill(m_cells.begin() + y * m_width + x0, m_cells.begin() + y * m_width + x1, 1);
+		}
+	}
+
+	bool CoverageBuffer::isCovered(const Rect& rect) const {
+		if (rect.w <= 0 || rect.h <= 0) {
+			return false;
+		}
+		int32_t left = std::max(rect.x - m_area.x, 0);
+		int32_t top = std::max(rect.y - m_area.y, 0);
+		int32_t right = std::min(rect.x - m_area.x + rect.w, m_area.w);
+		int32_t bottom = std::min(rect.y - m_area.y + rect.h, m_area.h);
+		if (left >= right || top >= bottom) {
+			return false;
+		}
+		int32_t x0 = left / m_cellSize;
+		int32_t y0 = top / m_cellSize;
+		int32_t x1 = (right - 1) / m_cellSize;
+		int32_t y1 = (bottom - 1) / m_cellSize;
+		for (int32_t y = y0; y <= y1; ++y) {
+			const uint8_t* row = &m_cells[y * m_width];
+			for (int32_t x = x0; x <= x1; ++x) {
+				if (!row[x]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VIEW_COVERAGEBUFFER_H
+#define FIFE_VIEW_COVERAGEBUFFER_H
+
+// Standard C++ library includes
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+
+namespace FIFE {
+
+	/** Coarse screen space buffer that records which cells are covered by opaque pixels.
+	 *
+	 * Cells are only marked if a rectangle covers them completely and a rectangle is only
+	 * covered if all cells it touches are marked, so the test is conservative.
+	 */
+	class CoverageBuffer {
+	public:
+		/** Constructor
+		 * @param cellSize Width and height of a cell in screen pixels.
+		 */
+		CoverageBuffer(int32_t cellSize = 16);
+
+		/** Sets the covered screen area and clears all cells.
+		 */
+		void reset(const Rect& area);
+
+		/** Marks all cells that are completely inside of the rectangle.
+		 */
+		void cover(const Rect& rect);
+
+		/** Returns true if all cells the rectangle touches are marked.
+		 * Rectangles outside of the area are never covered.
+		 */
+		bool isCovered(const Rect& rect) const;
+
+	private:
+		//! width and height of a cell
+		int32_t m_cellSize;
+		//! screen area of the buffer
+		Rect m_area;
+		//! number of cells per row and column
+		int32_t m_width;
+		int32_t m_height;
+		//! one byte per cell, 1 if covered
+		std::vector<uint8_t> m_cells;
+	};
+}
+
+#endif
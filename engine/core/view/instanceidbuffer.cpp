@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <functional>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "instanceidbuffer.h"
+
+namespace FIFE {
+
+	InstanceIdBuffer::InstanceIdBuffer(int32_t cellSize):
+		m_cellSize(cellSize),
+		m_columns(0),
+		m_rows(0),
+		m_itemCount(0),
+		m_valid(false) {
+	}
+
+	void InstanceIdBuffer::build(const Rect& area, const RenderList& renderlist) {
+		m_area = area;
+		m_columns = std::max(1, (area.w + m_cellSize - 1) / m_cellSize);
+		m_rows = std::max(1, (area.h + m_cellSize - 1) / m_cellSize);
+		m_itemCount = renderlist.size();
+		m_valid = true;
+
+		// counts the items per cell
+		const uint32_t cells = m_columns * m_rows;
+		m_offsets.assign(cells + 1, 0);
+		m_itemCells.resize(m_itemCount);
+		for (uint32_t i = 0; i < m_itemCount; ++i) {
+			Rect& range = m_itemCells[i];
+			int32_t x0, y0, x1, y1;
+			if (!getCellRange(renderlist[i]->dimensions, x0, y0, x1, y1)) {
+				range = Rect(0, 0, 0, 0);
+				continue;
+			}
+			range = Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+			for (int32_t y = y0; y <= y1; ++y) {
+				for (int32_t x = x0; x <= x1; ++x) {
+					++m_offsets[y * m_columns + x + 1];
+				}
+			}
+		}
+		for (uint32_t c = 0; c < cells; ++c) {
+			m_offsets[c + 1] += m_offsets[c];
+		}
+
+		// fills the cells in render order
+		m_ids.resize(m_offsets[cells]);
+		std::vector<uint32_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+		for (uint32_t i = 0; i < m_itemCount; ++i) {
+			const Rect& range = m_itemCells[i];
+			for (int32_t y = range.y; y < range.bottom(); ++y) {
+				for (int32_t x = range.x; x < range.right(); ++x) {
+					m_ids[fill[y * m_columns + x]++] = i;
+				}
+			}
+		}
+	}
+
+	void InstanceIdBuffer::invalidate() {
+		m_valid = false;
+	}
+
+	bool InstanceIdBuffer::isValid(uint32_t itemCount) const {
+		return m_valid && m_itemCount == itemCount;
+	}
+
+	void InstanceIdBuffer::getIds(const Point& point, std::vector<uint32_t>& ids) const {
+		ids.clear();
+		if (!m_valid || point.x < m_area.x || point.y < m_area.y || point.x >= m_area.right() || point.y >= m_area.bottom()) {
+			return;
+		}
+		const int32_t cell = ((point.y - m_area.y) / m_cellSize) * m_columns + (point.x - m_area.x) / m_cellSize;
+		ids.assign(m_ids.rbegin() + (m_ids.size() - m_offsets[cell + 1]), m_ids.rbegin() + (m_ids.size() - m_offsets[cell]));
+	}
+
+	void InstanceIdBuffer::getIds(const Rect& rect, std::vector<uint32_t>& ids) const {
+		ids.clear();
+		int32_t x0, y0, x1, y1;
+		if (!m_valid || !getCellRange(rect, x0, y0, x1, y1)) {
+			return;
+		}
+		for (int32_t y = y0; y <= y1; ++y) {
+			for (int32_t x = x0; x <= x1; ++x) {
+				const int32_t cell = y * m_columns + x;
+				ids.insert(ids.end(), m_ids.begin() + m_offsets[cell], m_ids.begin() + m_offsets[cell + 1]);
+			}
+		}
+		std::sort(ids.begin(), ids.end(), std::greater<uint32_t>());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+	}
+
+	bool InstanceIdBuffer::getCellRange(const Rect& rect, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const {
+		Rect r = rect;
+		if (r.w <= 0 || r.h <= 0 || !r.intersectInplace(m_area)) {
+			return false;
+		}
+		x0 = (r.x - m_area.x) / m_cellSize;
+		y0 = (r.y - m_area.y) / m_cellSize;
+		x1 = std::min(m_columns - 1, (r.right() - 1 - m_area.x) / m_cellSize);
+		y1 = std::min(m_rows - 1, (r.bottom() - 1 - m_area.y) / m_cellSize);
+		return true;
+	}
+}
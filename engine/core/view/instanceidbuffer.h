@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VIEW_INSTANCEIDBUFFER_H
+#define FIFE_VIEW_INSTANCEIDBUFFER_H
+
+// Standard C++ library includes
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+
+#include "renderitem.h"
+
+namespace FIFE {
+
+	/** Coarse screen grid of a render list for picking.
+	 *
+	 * Every cell holds the ids of the items that overlap it, the id is the position
+	 * of the item in the render list. So a pick only tests the items of one or a few cells.
+	 */
+	class InstanceIdBuffer {
+	public:
+		/** Constructor
+		 * @param cellSize Width and height of a cell in screen pixels.
+		 */
+		InstanceIdBuffer(int32_t cellSize = 32);
+
+		/** Fills the buffer with the items of the render list.
+		 * @param area The screen area of the buffer, usually the viewport.
+		 */
+		void build(const Rect& area, const RenderList& renderlist);
+
+		/** Marks the buffer as outdated, e.g. after the render list was updated.
+		 */
+		void invalidate();
+
+		/** Returns true if the buffer was built and the render list size didn't change since.
+		 */
+		bool isValid(uint32_t itemCount) const;
+
+		/** Gets the ids of the items whose cell contains the point, the topmost item first.
+		 */
+		void getIds(const Point& point, std::vector<uint32_t>& ids) const;
+
+		/** Gets the ids of the items whose cells intersect the rect, the topmost item first.
+		 */
+		void getIds(const Rect& rect, std::vector<uint32_t>& ids) const;
+
+	private:
+		bool getCellRange(const Rect& rect, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const;
+
+		int32_t m_cellSize;
+		Rect m_area;
+		int32_t m_columns;
+		int32_t m_rows;
+		//! start of every cell in m_ids, one more entry than cells
+		std::vector<uint32_t> m_offsets;
+		//! ids of all cells, per cell in render order
+		std::vector<uint32_t> m_ids;
+		//! cell range of each item, used while building
+		std::vector<Rect> m_itemCells;
+		uint32_t m_itemCount;
+		bool m_valid;
+	};
+}
+
+#endif
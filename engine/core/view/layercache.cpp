@@ -20,7 +20,9 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 #include <cfloat>
+#include <functional>
 
 // 3rd party library includes
 
@@ -35,6 +37,7 @@
 #include "model/structures/instance.h"
 #include "model/structures/location.h"
 #include "util/base/exception.h"
+#include "util/concurrency/workerpool.h"
 #include "util/log/logger.h"
 #include "util/math/fife_math.h"
 #include "util/math/angles.h"
@@ -53,6 +56,15 @@ namespace FIFE {
 	 *  @relates Logger
 	 */
 	static Logger _log(LM_CAMERA);
+
+	//! entries are only updated in parallel if at least this many need an update
+	static const uint32_t PARALLEL_ENTRY_COUNT = 512;
+	//! number of entries per worker task
+	static const uint32_t ENTRY_JOB_BLOCK = 64;
+	//! bucket size of the screen grid, in virtual screen pixels
+	static const int32_t SCREEN_GRID_BUCKET = 128;
+	//! render lists are repaired instead of sorted if at most every n-th item changed
+	static const uint32_t INCREMENTAL_SORT_RATIO = 32;
 	
 	class CacheLayerChangeListener : public LayerChangeListener {
 	public:
@@ -79,24 +91,18 @@ namespace FIFE {
 		LayerCache* m_cache;
 	};
 
-	/** Comparison functions for sorting
-	*/
-	// used screenpoint z for sorting, calculated from camera
-	class InstanceDistanceSortCamera {
-	public:
-		inline bool operator()(RenderItem* const & lhs, RenderItem* const & rhs) {
-			if (Mathd::Equal(lhs->screenpoint.z, rhs->screenpoint.z)) {
-				InstanceVisual* liv = lhs->instance->getVisual<InstanceVisual>();
-				InstanceVisual* riv = rhs->instance->getVisual<InstanceVisual>();
-				return liv->getStackPosition() < riv->getStackPosition();
-			}
-			return lhs->screenpoint.z < rhs->screenpoint.z;
-		}
-	};
-	// used instance location and camera rotation for sorting
-	class InstanceDistanceSortLocation {
+	/** Builds the sort keys of render items.
+	 * Items are ordered by the screenpoint z, the instance location or both, see SortingStrategy.
+	 * The stack position is the last part of every key.
+	 */
+	class RenderItemSortKey {
 	public:
-		InstanceDistanceSortLocation(double rotation) {
+		RenderItemSortKey(SortingStrategy strategy, double rotation) {
+			m_strategy = strategy;
+			xtox = 0;
+			xtoy = 0;
+			ytox = 0;
+			ytoy = 0;
 			if ((rotation >= 0) && (rotation <= 60)) { // 30 deg
 				xtox = 0;
 				xtoy = -1;
@@ -130,55 +136,96 @@ namespace FIFE {
 			}
 		}
 
-		inline bool operator()(RenderItem* const & lhs, RenderItem* const & rhs) {
-			ExactModelCoordinate lpos = lhs->instance->getLocationRef().getExactLayerCoordinates();
-			ExactModelCoordinate rpos = rhs->instance->getLocationRef().getExactLayerCoordinates();
-			lpos.x += lpos.y / 2;
-			rpos.x += rpos.y / 2;
-			InstanceVisual* liv = lhs->instance->getVisual<InstanceVisual>();
-			InstanceVisual* riv = rhs->instance->getVisual<InstanceVisual>();
-			int32_t lvc = ceil(xtox*lpos.x + ytox*lpos.y) + ceil(xtoy*lpos.x + ytoy*lpos.y) + liv->getStackPosition();
-			int32_t rvc = ceil(xtox*rpos.x + ytox*rpos.y) + ceil(xtoy*rpos.x + ytoy*rpos.y) + riv->getStackPosition();
-			if (lvc == rvc) {
-				if (Mathd::Equal(lpos.z, rpos.z)) {
-					return liv->getStackPosition() < riv->getStackPosition();
-				}
-				return lpos.z < rpos.z;
+		inline void operator()(RenderItem* item, RadixSortEntry& entry) const {
+			int32_t stackpos = item->instance->getVisual<InstanceVisual>()->getStackPosition();
+			entry.tertiary = radixKey(stackpos);
+			switch (m_strategy) {
+				case SORTING_LOCATION: {
+					// used instance location and camera rotation for sorting
+					ExactModelCoordinate pos = item->instance->getLocationRef().getExactLayerCoordinates();
+					pos.x += pos.y / 2;
+					int32_t vc = ceil(xtox*pos.x + ytox*pos.y) + ceil(xtoy*pos.x + ytoy*pos.y) + stackpos;
+					entry.primary = radixKey(vc);
+					entry.secondary = radixKey(pos.z);
+				} break;
+				case SORTING_CAMERA_AND_LOCATION: {
+					// used screenpoint z for sorting and as fallback first the instance location z and then the stack position
+					entry.primary = radixKey(item->screenpoint.z);
+					entry.secondary = radixKey(item->instance->getLocationRef().getExactLayerCoordinatesRef().z);
+				} break;
+				default: {
+					// used screenpoint z for sorting, calculated from camera
+					entry.primary = radixKey(item->screenpoint.z);
+					entry.secondary = 0;
+				} break;
 			}
-			return lvc < rvc;
 		}
 	private:
+		SortingStrategy m_strategy;
 		double xtox;
 		double xtoy;
 		double ytox;
 		double ytoy;
 	};
-	// used screenpoint z for sorting and as fallback first the instance location z and then the stack position
-	class InstanceDistanceSortCameraAndLocation {
-	public:
-		inline bool operator()(RenderItem* const & lhs, RenderItem* const & rhs) {
-			if (Mathd::Equal(lhs->screenpoint.z, rhs->screenpoint.z)) {
-				const ExactModelCoordinate& lpos = lhs->instance->getLocationRef().getExactLayerCoordinatesRef();
-				const ExactModelCoordinate& rpos = rhs->instance->getLocationRef().getExactLayerCoordinatesRef();
-				if (Mathd::Equal(lpos.z, rpos.z)) {
-					InstanceVisual* liv = lhs->instance->getVisual<InstanceVisual>();
-					InstanceVisual* riv = rhs->instance->getVisual<InstanceVisual>();
-					return liv->getStackPosition() < riv->getStackPosition();
-				}
-				return lpos.z < rpos.z;
+
+	void LayerCache::DirtyEntries::insert(int32_t index) {
+		if (static_cast<int32_t>(m_flags.size()) <= index) {
+			m_flags.resize(index + 1, 0);
+		}
+		if (m_flags[index]) {
+			return;
+		}
+		m_flags[index] = 1;
+		++m_count;
+		// erased indices stay in the list, it is compacted before it gets too long
+		if (m_indices.size() >= 2 * m_count + 64) {
+			compact();
+		}
+		m_indices.push_back(index);
+	}
+
+	void LayerCache::DirtyEntries::erase(int32_t index) {
+		if (index < static_cast<int32_t>(m_flags.size()) && m_flags[index]) {
+			m_flags[index] = 0;
+			--m_count;
+		}
+	}
+
+	void LayerCache::DirtyEntries::clear() {
+		m_flags.assign(m_flags.size(), 0);
+		m_indices.clear();
+		m_count = 0;
+	}
+
+	void LayerCache::DirtyEntries::getIndices(std::vector<int32_t>& indices) {
+		compact();
+		indices = m_indices;
+	}
+
+	void LayerCache::DirtyEntries::compact() {
+		std::vector<int32_t>::iterator last = m_indices.begin();
+		for (std::vector<int32_t>::iterator it = m_indices.begin(); it != m_indices.end(); ++it) {
+			if (m_flags[*it]) {
+				*last++ = *it;
 			}
-			return lhs->screenpoint.z < rhs->screenpoint.z;
 		}
-	};
+		m_indices.erase(last, m_indices.end());
+		std::sort(m_indices.begin(), m_indices.end());
+		m_indices.erase(std::unique(m_indices.begin(), m_indices.end()), m_indices.end());
+	}
 
 	LayerCache::LayerCache(Camera* camera) {
 		m_camera = camera;
 		m_layer = 0;
 		m_layerObserver = 0;
 		m_tree = 0;
+		m_grid = 0;
+		m_screenIndex = SCREEN_INDEX_QUADTREE;
+		m_workerPool = 0;
 		m_zMin = 0.0;
 		m_zMax = 0.0;
 		m_zoom = camera->getZoom();
+		m_lodLevel = ImageManager::instance()->getLodLevel(m_zoom);
 		m_zoomed = !Mathd::Equal(m_zoom, 1.0);
 		m_straightZoom = Mathd::Equal(fmod(m_zoom, 1.0), 0.0);
 		
@@ -201,6 +248,7 @@ namespace FIFE {
 		m_layer->removeChangeListener(m_layerObserver);
 		delete m_layerObserver;
 		delete m_tree;
+		delete m_grid;
 	}
 
 	void LayerCache::setLayer(Layer* layer) {
@@ -230,10 +278,9 @@ namespace FIFE {
 		m_instance_map.clear();
 		m_entriesToUpdate.clear();
 		m_freeEntries.clear();
-		m_cacheImage.reset();
+		m_tileCache.clear();
 
-		delete m_tree;
-		m_tree = new CacheTree;
+		rebuildScreenIndex();
 		const std::vector<Instance*>& instances = m_layer->getInstances();
 		for(std::vector<Instance*>::const_iterator i = instances.begin();
 			i != instances.end(); ++i) {
@@ -269,6 +316,7 @@ namespace FIFE {
 			entry->entryIndex = index;
 		}
 
+		item->lodLevel = m_lodLevel;
 		entry->node = 0;
 		entry->forceUpdate = true;
 		entry->visible = true;
@@ -284,15 +332,25 @@ namespace FIFE {
 		assert(entry->instanceIndex == m_instance_map[instance]);
 		RenderItem* item = m_renderItems[entry->instanceIndex];
 		// removes entry from updates
-		std::set<int32_t>::iterator it = m_entriesToUpdate.find(entry->entryIndex);
-		if (it != m_entriesToUpdate.end()) {
-			m_entriesToUpdate.erase(it);
-		}
-		// removes entry from CacheTree
+		m_entriesToUpdate.erase(entry->entryIndex);
+		// removes entry from CacheTree or CacheGrid
 		if (entry->node) {
 			entry->node->data().erase(entry->entryIndex);
 			entry->node = 0;
 		}
+		if (m_grid) {
+			m_grid->remove(entry->entryIndex);
+		}
+		// the instance disappears from the cached tiles and the screen
+		if (item->image) {
+			if (m_layer->isStatic()) {
+				m_tileCache.invalidate(item->bbox);
+			}
+			Rect area = item->dimensions;
+			if (area.intersectInplace(m_camera->getViewPort())) {
+				RenderBackend::instance()->addDirtyRect(area);
+			}
+		}
 		entry->instanceIndex = -1;
 		entry->forceUpdate = false;
 		m_instance_map.erase(instance);
@@ -356,6 +414,10 @@ namespace FIFE {
 	}
 
 	void LayerCache::collect(const Rect& viewport, std::vector<int32_t>& index_list) {
+		if (m_grid) {
+			m_grid->collect(viewport, index_list);
+			return;
+		}
 		CacheTree::Node * node = m_tree->find_container(viewport);
 		CacheTreeCollector collector(index_list, viewport);
 		node->apply_visitor(collector);
@@ -370,8 +432,9 @@ namespace FIFE {
 		// this is only a bit faster, but works without this block too.
 		if(!m_layer->areInstancesVisible()) {
 			FL_DBG(_log, "Layer instances hidden");
-			std::set<int32_t>::const_iterator entry_it = m_entriesToUpdate.begin();
-			for (; entry_it != m_entriesToUpdate.end(); ++entry_it) {
+			std::vector<int32_t> indices;
+			m_entriesToUpdate.getIndices(indices);
+			for (std::vector<int32_t>::const_iterator entry_it = indices.begin(); entry_it != indices.end(); ++entry_it) {
 				Entry* entry = m_entries[*entry_it];
 				entry->forceUpdate = false;
 				entry->visible = false;
@@ -380,14 +443,30 @@ namespace FIFE {
 			renderlist.clear();
 			return;
 		}
+		// the screen index strategy of the layer changed
+		if (m_layer->getScreenIndexStrategy() != m_screenIndex) {
+			rebuildScreenIndex();
+		}
+		// the tiles of a static layer and the screen areas in dirty rect mode are
+		// rendered again where updated entries were or are now
+		std::vector<int32_t> changedEntries;
+		bool fullTransform = (transform & Camera::RotationTransform) == Camera::RotationTransform ||
+			(transform & Camera::TiltTransform) == Camera::TiltTransform ||
+			(transform & Camera::ZTransform) == Camera::ZTransform;
+		if (m_layer->isStatic() && fullTransform) {
+			m_tileCache.invalidate();
+		} else if (m_layer->isStatic() || RenderBackend::instance()->isDirtyRectsEnabled()) {
+			m_entriesToUpdate.getIndices(changedEntries);
+			markChangedEntries(changedEntries);
+		}
 		// if transform is none then we have only to update the instances with an update info.
 		if (transform == Camera::NoneTransform) {
 			if (!m_entriesToUpdate.empty()) {
-				std::set<int32_t> entryToRemove;
+				std::vector<int32_t> entryToRemove;
 				updateEntries(entryToRemove, renderlist);
 				//std::cout << "update entries: " << int32_t(m_entriesToUpdate.size()) << " remove entries: " << int32_t(entryToRemove.size()) <<"\n";
 				if (!entryToRemove.empty()) {
-					std::set<int32_t>::iterator entry_it = entryToRemove.begin();
+					std::vector<int32_t>::iterator entry_it = entryToRemove.begin();
 					for (; entry_it != entryToRemove.end(); ++entry_it) {
 						m_entriesToUpdate.erase(*entry_it);
 					}
@@ -397,6 +476,11 @@ namespace FIFE {
 			m_zoom = m_camera->getZoom();
 			m_zoomed = !Mathd::Equal(m_zoom, 1.0);
 			m_straightZoom = Mathd::Equal(fmod(m_zoom, 1.0), 0.0);
+			uint32_t lodLevel = ImageManager::instance()->getLodLevel(m_zoom);
+			if (lodLevel != m_lodLevel) {
+				m_lodLevel = lodLevel;
+				updateLodImages();
+			}
 			// clear old renderlist
 			renderlist.clear();
 			// update all entries
@@ -455,10 +539,47 @@ namespace FIFE {
 				sortRenderList(renderlist);
 			}
 		}
+		markChangedEntries(changedEntries);
 	}
 	
 	void LayerCache::fullUpdate(Camera::Transform transform) {
 		bool rotationChange = (transform & Camera::RotationTransform) == Camera::RotationTransform;
+		if (m_workerPool && m_entries.size() >= PARALLEL_ENTRY_COUNT) {
+			std::vector<EntryJob> jobs;
+			jobs.reserve(m_entries.size());
+			for (uint32_t i = 0; i != m_entries.size(); ++i) {
+				Entry* entry = m_entries[i];
+				if (entry->instanceIndex != -1) {
+					EntryJob job;
+					job.entry = entry;
+					job.instance = m_renderItems[entry->instanceIndex]->instance;
+					job.visual = rotationChange || entry->forceUpdate;
+					job.position = true;
+					job.coordinates = false;
+					job.zoomChange = false;
+					job.force = entry->forceUpdate;
+					job.onScreen = false;
+					jobs.push_back(job);
+				}
+			}
+			runEntryJobs(jobs);
+			for (std::vector<EntryJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+				if (!finishEntryJob(*it) || !it->visual) {
+					continue;
+				}
+				Entry* entry = it->entry;
+				if (it->force && !entry->forceUpdate) {
+					// no action
+					entry->updateInfo = EntryNoneUpdate;
+					m_entriesToUpdate.erase(entry->entryIndex);
+				} else if (!it->force && entry->forceUpdate) {
+					// new action
+					entry->updateInfo |= EntryVisualUpdate;
+					m_entriesToUpdate.insert(entry->entryIndex);
+				}
+			}
+			return;
+		}
 		for (uint32_t i = 0; i != m_entries.size(); ++i) {
 			Entry* entry = m_entries[i];
 			if (entry->instanceIndex != -1) {
@@ -482,6 +603,37 @@ namespace FIFE {
 
 	void LayerCache::fullCoordinateUpdate(Camera::Transform transform) {
 		bool zoomChange = (transform & Camera::ZoomTransform) == Camera::ZoomTransform;
+		if (m_workerPool && m_entries.size() >= PARALLEL_ENTRY_COUNT) {
+			std::vector<EntryJob> jobs;
+			jobs.reserve(m_entries.size());
+			for (uint32_t i = 0; i != m_entries.size(); ++i) {
+				Entry* entry = m_entries[i];
+				if (entry->instanceIndex != -1) {
+					EntryJob job;
+					job.entry = entry;
+					job.instance = m_renderItems[entry->instanceIndex]->instance;
+					job.visual = entry->forceUpdate;
+					job.position = entry->forceUpdate;
+					job.coordinates = !entry->forceUpdate;
+					job.zoomChange = zoomChange;
+					job.force = entry->forceUpdate;
+					job.onScreen = false;
+					jobs.push_back(job);
+				}
+			}
+			runEntryJobs(jobs);
+			for (std::vector<EntryJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+				if (!finishEntryJob(*it) || !it->visual) {
+					continue;
+				}
+				if (!it->entry->forceUpdate) {
+					// no action
+					it->entry->updateInfo = EntryNoneUpdate;
+					m_entriesToUpdate.erase(it->entry->entryIndex);
+				}
+			}
+			return;
+		}
 		for (uint32_t i = 0; i != m_entries.size(); ++i) {
 			Entry* entry = m_entries[i];
 			if (entry->instanceIndex != -1) {
@@ -500,73 +652,234 @@ namespace FIFE {
 		}
 	}
 
-	void LayerCache::updateEntries(std::set<int32_t>& removes, RenderList& renderlist) {
+	void LayerCache::updateEntries(std::vector<int32_t>& removes, RenderList& renderlist) {
 		RenderList needSorting;
 		Rect viewport = m_camera->getViewPort();
-		std::set<int32_t>::const_iterator entry_it = m_entriesToUpdate.begin();
-		for (; entry_it != m_entriesToUpdate.end(); ++entry_it) {
-			Entry* entry = m_entries[*entry_it];
-			entry->forceUpdate = false;
-			if (entry->instanceIndex == -1) {
-				entry->updateInfo = EntryNoneUpdate;
-				removes.insert(*entry_it);
-				continue;
+		// a copy, instance events during the update can add entries
+		std::vector<int32_t> indices;
+		m_entriesToUpdate.getIndices(indices);
+		if (m_workerPool && indices.size() >= PARALLEL_ENTRY_COUNT) {
+			std::vector<EntryJob> jobs;
+			jobs.reserve(indices.size());
+			std::vector<int32_t>::const_iterator entry_it = indices.begin();
+			for (; entry_it != indices.end(); ++entry_it) {
+				Entry* entry = m_entries[*entry_it];
+				entry->forceUpdate = false;
+				if (entry->instanceIndex == -1) {
+					entry->updateInfo = EntryNoneUpdate;
+					removes.push_back(*entry_it);
+					continue;
+				}
+				RenderItem* item = m_renderItems[entry->instanceIndex];
+				EntryJob job;
+				job.entry = entry;
+				job.instance = item->instance;
+				job.visual = (entry->updateInfo & EntryVisualUpdate) == EntryVisualUpdate;
+				job.position = (entry->updateInfo & EntryPositionUpdate) == EntryPositionUpdate;
+				job.coordinates = false;
+				job.zoomChange = false;
+				job.force = false;
+				job.onScreen = entry->visible && item->image && item->dimensions.intersects(viewport);
+				jobs.push_back(job);
 			}
-			RenderItem* item = m_renderItems[entry->instanceIndex];
-			bool onScreenA = entry->visible && item->image && item->dimensions.intersects(viewport);
-			bool positionUpdate = (entry->updateInfo & EntryPositionUpdate) == EntryPositionUpdate;
-			if ((entry->updateInfo & EntryVisualUpdate) == EntryVisualUpdate) {
-				positionUpdate |= updateVisual(entry);
+			runEntryJobs(jobs);
+			for (std::vector<EntryJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+				if (finishEntryJob(*it)) {
+					updateEntry(it->entry, it->onScreen, it->position, viewport, removes, renderlist, needSorting);
+				}
 			}
-			if (positionUpdate) {
-				updatePosition(entry);
+		} else {
+			std::vector<int32_t>::const_iterator entry_it = indices.begin();
+			for (; entry_it != indices.end(); ++entry_it) {
+				Entry* entry = m_entries[*entry_it];
+				entry->forceUpdate = false;
+				if (entry->instanceIndex == -1) {
+					entry->updateInfo = EntryNoneUpdate;
+					removes.push_back(*entry_it);
+					continue;
+				}
+				RenderItem* item = m_renderItems[entry->instanceIndex];
+				bool onScreenA = entry->visible && item->image && item->dimensions.intersects(viewport);
+				bool positionUpdate = (entry->updateInfo & EntryPositionUpdate) == EntryPositionUpdate;
+				if ((entry->updateInfo & EntryVisualUpdate) == EntryVisualUpdate) {
+					positionUpdate |= updateVisual(entry);
+				}
+				if (positionUpdate) {
+					updatePosition(entry);
+				}
+				updateEntry(entry, onScreenA, positionUpdate, viewport, removes, renderlist, needSorting);
 			}
-			bool onScreenB = entry->visible && item->image && item->dimensions.intersects(viewport);
-			if (onScreenA != onScreenB) {
-				if (!onScreenA) {
-					// add to renderlist and sort
-					renderlist.push_back(item);
-					needSorting.push_back(item);
+		}
+
+		if (!needSorting.empty()) {
+			if (m_needSorting) {
+				if (needSorting.size() * INCREMENTAL_SORT_RATIO <= renderlist.size()) {
+					repairRenderList(renderlist, needSorting);
 				} else {
-					// remove from renderlist
-					for (RenderList::iterator it = renderlist.begin(); it != renderlist.end(); ++it) {
-						if ((*it)->instance == item->instance) {
-							renderlist.erase(it);
-							break;
-						}
-					}
+					sortRenderList(renderlist);
 				}
-			} else if (onScreenA && onScreenB && positionUpdate) {
-				// sort
-				needSorting.push_back(item);
+			} else {
+				sortRenderList(needSorting);
 			}
+		}
+	}
 
-			if (!entry->forceUpdate) {
-				entry->forceUpdate = false;
-				entry->updateInfo = EntryNoneUpdate;
-				removes.insert(*entry_it);
+	void LayerCache::updateEntry(Entry* entry, bool onScreenA, bool positionUpdate, const Rect& viewport,
+		std::vector<int32_t>& removes, RenderList& renderlist, RenderList& needSorting) {
+		RenderItem* item = m_renderItems[entry->instanceIndex];
+		bool onScreenB = entry->visible && item->image && item->dimensions.intersects(viewport);
+		if (onScreenA != onScreenB) {
+			if (!onScreenA) {
+				// add to renderlist and sort
+				renderlist.push_back(item);
+				needSorting.push_back(item);
 			} else {
-				entry->updateInfo = EntryVisualUpdate;
+				// remove from renderlist
+				for (RenderList::iterator it = renderlist.begin(); it != renderlist.end(); ++it) {
+					if ((*it)->instance == item->instance) {
+						renderlist.erase(it);
+						break;
+					}
+				}
 			}
+		} else if (onScreenA && onScreenB && positionUpdate) {
+			// sort
+			needSorting.push_back(item);
 		}
 
-		if (!needSorting.empty()) {
-			if (m_needSorting) {
-				sortRenderList(renderlist);
+		if (!entry->forceUpdate) {
+			entry->forceUpdate = false;
+			entry->updateInfo = EntryNoneUpdate;
+			removes.push_back(entry->entryIndex);
+		} else {
+			entry->updateInfo = EntryVisualUpdate;
+		}
+	}
+
+	void LayerCache::runEntryJobs(std::vector<EntryJob>& jobs) {
+		if (jobs.empty()) {
+			return;
+		}
+		// every task updates a block of entries, the entries are independent
+		m_workerPool->parallelFor((static_cast<uint32_t>(jobs.size()) + ENTRY_JOB_BLOCK - 1) / ENTRY_JOB_BLOCK,
+			std::bind(&LayerCache::runEntryJob, this, std::ref(jobs), std::placeholders::_1));
+	}
+
+	void LayerCache::runEntryJob(std::vector<EntryJob>& jobs, uint32_t index) {
+		uint32_t end = std::min(static_cast<uint32_t>(jobs.size()), (index + 1) * ENTRY_JOB_BLOCK);
+		for (uint32_t i = index * ENTRY_JOB_BLOCK; i < end; ++i) {
+			EntryJob& job = jobs[i];
+			job.update.serial = false;
+			RenderItem* item = m_renderItems[job.entry->instanceIndex];
+			if (job.coordinates) {
+				updateScreenCoordinate(item, job.zoomChange);
+				continue;
+			}
+			// the item gets its new image on the main thread, the position already uses it
+			Image* image = item->image.get();
+			if (job.visual) {
+				job.position |= computeVisual(job.entry, job.update, true);
+				if (job.update.serial) {
+					continue;
+				}
+				image = job.update.image.image;
+			}
+			if (job.position) {
+				calculatePosition(item, image);
+			}
+		}
+	}
+
+	bool LayerCache::finishEntryJob(EntryJob& job) {
+		Entry* entry = job.entry;
+		if (job.visual) {
+			if (job.update.serial) {
+				// an image was not loaded, loading is only allowed on the main thread
+				job.position |= updateVisual(entry);
 			} else {
-				sortRenderList(needSorting);
+				applyVisual(entry, job.update);
+				callActionFrames(job.instance, job.update);
 			}
 		}
+		// an action frame listener can remove the instance, the entry is then already cleaned up
+		if (entry->instanceIndex == -1 || m_renderItems[entry->instanceIndex]->instance != job.instance) {
+			return false;
+		}
+		if (job.coordinates) {
+			return true;
+		}
+		if (job.position) {
+			if (job.update.serial) {
+				RenderItem* item = m_renderItems[entry->instanceIndex];
+				calculatePosition(item, item->image.get());
+			}
+			updateScreenIndex(entry);
+		}
+		return true;
+	}
+
+	bool LayerCache::pickFrame(Animation* animation, uint32_t time, VisualFrame& frame, bool worker) {
+		frame.animation = animation;
+		frame.index = animation->getFrameIndex(time);
+		frame.handle = 0;
+		frame.image = animation->getFrameImage(frame.index);
+		if (frame.image && frame.image->getState() != IResource::RES_LOADED) {
+			// images are only loaded on the main thread
+			if (worker) {
+				return false;
+			}
+			if (frame.image->getState() == IResource::RES_NOT_LOADED) {
+				frame.image->load();
+			}
+		}
+		return true;
+	}
+
+	ImagePtr LayerCache::getFrameImage(const VisualFrame& frame) {
+		if (frame.animation) {
+			return frame.animation->getFrame(frame.index);
+		}
+		if (frame.image) {
+			return ImageManager::instance()->get(frame.handle);
+		}
+		return ImagePtr();
+	}
+
+	void LayerCache::callActionFrames(Instance* instance, const VisualUpdate& update) {
+		std::vector<std::pair<Action*, int32_t> >::const_iterator it = update.actionFrames.begin();
+		for (; it != update.actionFrames.end(); ++it) {
+			instance->callOnActionFrame(it->first, it->second);
+		}
 	}
 
 	bool LayerCache::updateVisual(Entry* entry) {
+		VisualUpdate update;
+		bool newPosition = computeVisual(entry, update, false);
+		applyVisual(entry, update);
+		callActionFrames(m_renderItems[entry->instanceIndex]->instance, update);
+		return newPosition;
+	}
+
+	bool LayerCache::computeVisual(Entry* entry, VisualUpdate& update, bool worker) {
 		RenderItem* item = m_renderItems[entry->instanceIndex];
 		Instance* instance = item->instance;
 		InstanceVisual* visual = instance->getVisual<InstanceVisual>();
 		item->facingAngle = instance->getRotation();
 		int32_t angle = static_cast<int32_t>(m_camera->getRotation()) + item->facingAngle;
 		Action* action = instance->getCurrentAction();
-		ImagePtr image;
+
+		update.image.animation = NULL;
+		update.image.index = -1;
+		update.image.handle = 0;
+		update.image.image = NULL;
+		update.overlayFrames.clear();
+		update.overlayColors.clear();
+		update.animationOverlay = false;
+		update.animationColorOverlay = false;
+		update.colorOverlay = NULL;
+		update.colorOverlayFrames.clear();
+		update.actionFrames.clear();
+		update.serial = false;
 
 		if (visual) {
 			uint8_t layerTrans = m_layer->getLayerTransparency();
@@ -587,10 +900,15 @@ namespace FIFE {
 			// only visible if visual and layer are visible and item is not totally transparent
 			entry->visible = (visual->isVisible() && item->transparency != 0) && m_layer->areInstancesVisible();
 		}
-		// delete old overlay
-		item->deleteOverlayData();
 
 		if (!action) {
+			ObjectVisual* objVis = instance->getObject()->getVisual<ObjectVisual>();
+			bool colorOverlay = objVis && objVis->isColorOverlay();
+			if (worker && colorOverlay) {
+				// static color overlays are created on demand
+				update.serial = true;
+				return false;
+			}
 			// Try static images then default action.
 			int32_t image_id = item->getStaticImageIndexByAngle(angle, instance);
 			if (image_id == -1) {
@@ -598,7 +916,20 @@ namespace FIFE {
 					action = instance->getObject()->getDefaultAction();
 				}
 			} else {
-				image = ImageManager::instance()->get(image_id);
+				update.image.handle = image_id;
+				if (worker) {
+					update.image.image = ImageManager::instance()->find(image_id);
+					if (update.image.image && update.image.image->getState() != IResource::RES_LOADED) {
+						update.serial = true;
+						return false;
+					}
+				} else {
+					update.image.image = ImageManager::instance()->get(image_id).get();
+				}
+			}
+			if (colorOverlay) {
+				// set by getStaticImageIndexByAngle
+				update.colorOverlay = item->getColorOverlay();
 			}
 		}
 		entry->forceUpdate = (action != 0);
@@ -608,45 +939,57 @@ namespace FIFE {
 			bool colorOverlay = actionVisual->isColorOverlay();
 			// assumed all have the same size
 			if (actionVisual->isAnimationOverlay()) {
-				std::map<int32_t, AnimationPtr> animations = actionVisual->getAnimationOverlay(angle);
-				std::map<int32_t, AnimationPtr>::iterator it = animations.begin();
-				std::vector<ImagePtr>* animOverlays = new std::vector<ImagePtr>();
-				std::vector<OverlayColors*>* animationColorOverlays = colorOverlay ? new std::vector<OverlayColors*>() : 0;
-				for (; it != animations.end(); ++it) {
-					uint32_t animationTime = instance->getActionRuntime() % it->second->getDuration();
-					image = it->second->getFrameByTimestamp(animationTime);
-					animOverlays->push_back(image);
-					
-					if (colorOverlay) {
-						OverlayColors* co = actionVisual->getColorOverlay(angle, it->first);
-						if (co) {
-							AnimationPtr ovAnim = co->getColorOverlayAnimation();
-							animationTime = instance->getActionRuntime() % ovAnim->getDuration();
-							co->setColorOverlayImage(ovAnim->getFrameByTimestamp(animationTime));
+				update.animationOverlay = true;
+				update.animationColorOverlay = colorOverlay;
+				const std::map<int32_t, AnimationPtr>* animations = actionVisual->findAnimationOverlay(angle);
+				if (animations) {
+					std::map<int32_t, AnimationPtr>::const_iterator it = animations->begin();
+					for (; it != animations->end(); ++it) {
+						Animation* animation = it->second.get();
+						uint32_t animationTime = instance->getActionRuntime() % animation->getDuration();
+						if (!pickFrame(animation, animationTime, update.image, worker)) {
+							update.serial = true;
+							return false;
 						}
-						animationColorOverlays->push_back(co);
-					}
-					// works only for one animation
-					int32_t actionFrame = it->second->getActionFrame();
-					if (actionFrame != -1) {
-						int32_t newFrame = it->second->getFrameIndex(animationTime);
-						if (item->currentFrame != newFrame) {
-							if (actionFrame == newFrame) {
-								instance->callOnActionFrame(action, actionFrame);
-							// if action frame was skipped
-							} else if (newFrame > actionFrame && item->currentFrame < actionFrame) {
-								instance->callOnActionFrame(action, actionFrame);
+						update.overlayFrames.push_back(update.image);
+
+						if (colorOverlay) {
+							OverlayColors* co = actionVisual->getColorOverlay(angle, it->first);
+							if (co) {
+								Animation* ovAnim = co->findColorOverlayAnimation();
+								animationTime = instance->getActionRuntime() % ovAnim->getDuration();
+								VisualFrame overlayFrame;
+								if (!pickFrame(ovAnim, animationTime, overlayFrame, worker)) {
+									update.serial = true;
+									return false;
+								}
+								update.colorOverlayFrames.push_back(std::make_pair(co, overlayFrame));
+							}
+							update.overlayColors.push_back(co);
+						}
+						// works only for one animation
+						int32_t actionFrame = animation->getActionFrame();
+						if (actionFrame != -1) {
+							int32_t newFrame = animation->getFrameIndex(animationTime);
+							if (item->currentFrame != newFrame) {
+								if (actionFrame == newFrame) {
+									update.actionFrames.push_back(std::make_pair(action, actionFrame));
+								// if action frame was skipped
+								} else if (newFrame > actionFrame && item->currentFrame < actionFrame) {
+									update.actionFrames.push_back(std::make_pair(action, actionFrame));
+								}
+								item->currentFrame = newFrame;
 							}
-							item->currentFrame = newFrame;
 						}
 					}
 				}
-				// transfer ownership of the vectors to RenderItem
-				item->setAnimationOverlay(animOverlays, animationColorOverlays);
 			} else {
-				AnimationPtr animation = action->getVisual<ActionVisual>()->getAnimationByAngle(angle);
+				Animation* animation = actionVisual->findAnimationByAngle(angle);
 				uint32_t animationTime = instance->getActionRuntime() % animation->getDuration();
-				image = animation->getFrameByTimestamp(animationTime);
+				if (!pickFrame(animation, animationTime, update.image, worker)) {
+					update.serial = true;
+					return false;
+				}
 				// if the action have an animation with only one frame (idle animation) then
 				// a forced update is not necessary.
 				if (animation->getFrameCount() <= 1) {
@@ -655,21 +998,26 @@ namespace FIFE {
 				if (colorOverlay) {
 					OverlayColors* co = actionVisual->getColorOverlay(angle);
 					if (co) {
-						AnimationPtr ovAnim = co->getColorOverlayAnimation();
+						Animation* ovAnim = co->findColorOverlayAnimation();
 						animationTime = instance->getActionRuntime() % ovAnim->getDuration();
-						co->setColorOverlayImage(ovAnim->getFrameByTimestamp(animationTime));
-						item->setColorOverlay(co);
+						VisualFrame overlayFrame;
+						if (!pickFrame(ovAnim, animationTime, overlayFrame, worker)) {
+							update.serial = true;
+							return false;
+						}
+						update.colorOverlayFrames.push_back(std::make_pair(co, overlayFrame));
+						update.colorOverlay = co;
 					}
 				}
 				int32_t actionFrame = animation->getActionFrame();
 				if (actionFrame != -1) {
-					if (item->image != image) {
+					if (item->image.get() != update.image.image) {
 						int32_t newFrame = animation->getFrameIndex(animationTime);
 						if (actionFrame == newFrame) {
-							instance->callOnActionFrame(action, actionFrame);
+							update.actionFrames.push_back(std::make_pair(action, actionFrame));
 						// if action frame was skipped
 						} else if (newFrame > actionFrame && item->currentFrame < actionFrame) {
-							instance->callOnActionFrame(action, actionFrame);
+							update.actionFrames.push_back(std::make_pair(action, actionFrame));
 						}
 						item->currentFrame = newFrame;
 					}
@@ -677,27 +1025,66 @@ namespace FIFE {
 			}
 		}
 
+		Image* image = update.image.image;
+		Image* current = item->image.get();
 		bool newPosition = false;
-		if (image != item->image) {
-			if (!item->image || !image) {
+		if (image != current) {
+			if (!current || !image) {
 				newPosition = true;
-			} else if (image->getWidth() != item->image->getWidth() ||
-						image->getHeight() != item->image->getHeight() ||
-						image->getXShift() != item->image->getXShift() ||
-						image->getYShift() != item->image->getYShift()) {
+			} else if (image->getWidth() != current->getWidth() ||
+						image->getHeight() != current->getHeight() ||
+						image->getXShift() != current->getXShift() ||
+						image->getYShift() != current->getYShift()) {
 							newPosition = true;
 			}
-			item->image = image;
 		}
 		return newPosition;
 	}
 
+	void LayerCache::applyVisual(Entry* entry, const VisualUpdate& update) {
+		RenderItem* item = m_renderItems[entry->instanceIndex];
+		// delete old overlay
+		item->deleteOverlayData();
+		if (update.animationOverlay) {
+			std::vector<ImagePtr>* animOverlays = new std::vector<ImagePtr>();
+			animOverlays->reserve(update.overlayFrames.size());
+			std::vector<VisualFrame>::const_iterator it = update.overlayFrames.begin();
+			for (; it != update.overlayFrames.end(); ++it) {
+				animOverlays->push_back(getFrameImage(*it));
+			}
+			std::vector<OverlayColors*>* animationColorOverlays = update.animationColorOverlay ?
+				new std::vector<OverlayColors*>(update.overlayColors) : 0;
+			// transfer ownership of the vectors to RenderItem
+			item->setAnimationOverlay(animOverlays, animationColorOverlays);
+		} else if (update.colorOverlay) {
+			item->setColorOverlay(update.colorOverlay);
+		}
+		// color overlays are shared by instances with the same action
+		std::vector<std::pair<OverlayColors*, VisualFrame> >::const_iterator cit = update.colorOverlayFrames.begin();
+		for (; cit != update.colorOverlayFrames.end(); ++cit) {
+			cit->first->setColorOverlayImage(getFrameImage(cit->second));
+		}
+		if (item->image.get() != update.image.image) {
+			item->image = getFrameImage(update.image);
+		}
+	}
+
+	void LayerCache::updateLodImages() {
+		for (std::vector<RenderItem*>::iterator it = m_renderItems.begin(); it != m_renderItems.end(); ++it) {
+			(*it)->lodLevel = m_lodLevel;
+		}
+	}
+
 	void LayerCache::updatePosition(Entry* entry) {
 		RenderItem* item = m_renderItems[entry->instanceIndex];
+		calculatePosition(item, item->image.get());
+		updateScreenIndex(entry);
+	}
+
+	void LayerCache::calculatePosition(RenderItem* item, Image* image) {
 		Instance* instance = item->instance;
 		ExactModelCoordinate mapCoords = instance->getLocationRef().getMapCoordinates();
 		DoublePoint3D screenPosition = m_camera->toVirtualScreenCoordinates(mapCoords);
-		ImagePtr image = item->image;
 
 		if (image) {
 			int32_t w = image->getWidth();
@@ -715,7 +1102,14 @@ namespace FIFE {
 		item->bbox.y = static_cast<int32_t>(screenPosition.y);
 
 		updateScreenCoordinate(item);
+	}
 
+	void LayerCache::updateScreenIndex(Entry* entry) {
+		RenderItem* item = m_renderItems[entry->instanceIndex];
+		if (m_grid) {
+			m_grid->update(entry->entryIndex, item->bbox);
+			return;
+		}
 		CacheTree::Node* node = m_tree->find_container(item->bbox);
 		if (node) {
 			if (node != entry->node) {
@@ -728,6 +1122,27 @@ namespace FIFE {
 		}
 	}
 
+	void LayerCache::rebuildScreenIndex() {
+		for (std::vector<Entry*>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+			(*it)->node = 0;
+		}
+		delete m_tree;
+		delete m_grid;
+		m_tree = 0;
+		m_grid = 0;
+		m_screenIndex = m_layer->getScreenIndexStrategy();
+		if (m_screenIndex == SCREEN_INDEX_GRID) {
+			m_grid = new CacheGrid(SCREEN_GRID_BUCKET);
+		} else {
+			m_tree = new CacheTree;
+		}
+		for (std::vector<Entry*>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+			if ((*it)->instanceIndex != -1) {
+				updateScreenIndex(*it);
+			}
+		}
+	}
+
 	inline void LayerCache::updateScreenCoordinate(RenderItem* item, bool changedZoom) {
 		Point3D screenPoint = m_camera->virtualScreenToScreen(item->screenpoint);
 		// NOTE:
@@ -781,33 +1196,128 @@ namespace FIFE {
 				}
 			}
 		} else {
-			SortingStrategy strat = m_layer->getSortingStrategy();
-			switch (strat) {
-				case SORTING_CAMERA: {
-					InstanceDistanceSortCamera ids;
-					std::stable_sort(renderlist.begin(), renderlist.end(), ids);
-				} break;
-				case SORTING_LOCATION: {
-					InstanceDistanceSortLocation ids(m_camera->getRotation());
-					std::stable_sort(renderlist.begin(), renderlist.end(), ids);
-				} break;
-				case SORTING_CAMERA_AND_LOCATION: {
-					InstanceDistanceSortCameraAndLocation ids;
-					std::stable_sort(renderlist.begin(), renderlist.end(), ids);
-				} break;
-				default: {
-					InstanceDistanceSortCamera ids;
-					std::stable_sort(renderlist.begin(), renderlist.end(), ids);
-				} break;
+			RenderItemSortKey sortKey(m_layer->getSortingStrategy(), m_camera->getRotation());
+			const uint32_t count = renderlist.size();
+			m_sortEntries.resize(count);
+			for (uint32_t i = 0; i < count; ++i) {
+				sortKey(renderlist[i], m_sortEntries[i]);
+				m_sortEntries[i].index = i;
+			}
+			radixSort(m_sortEntries, m_sortScratch);
+
+			m_sortItems.resize(count);
+			for (uint32_t i = 0; i < count; ++i) {
+				m_sortItems[i] = renderlist[m_sortEntries[i].index];
 			}
+			renderlist.swap(m_sortItems);
 		}
 	}
 
-	ImagePtr LayerCache::getCacheImage() {
-		return m_cacheImage;
+	void LayerCache::repairRenderList(RenderList& renderlist, RenderList& changed) {
+		RenderItemSortKey sortKey(m_layer->getSortingStrategy(), m_camera->getRotation());
+
+		// take the changed items out, the remaining items are still in order
+		std::sort(changed.begin(), changed.end());
+		changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+		RenderList::iterator last = renderlist.begin();
+		for (RenderList::iterator it = renderlist.begin(); it != renderlist.end(); ++it) {
+			if (!std::binary_search(changed.begin(), changed.end(), *it)) {
+				*last++ = *it;
+			}
+		}
+		renderlist.erase(last, renderlist.end());
+
+		// sort the changed items and search their positions in the remaining items
+		const uint32_t count = changed.size();
+		m_sortEntries.resize(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			sortKey(changed[i], m_sortEntries[i]);
+			m_sortEntries[i].index = i;
+		}
+		std::stable_sort(m_sortEntries.begin(), m_sortEntries.end());
+
+		std::vector<uint32_t> positions(count);
+		RadixSortEntry probe;
+		uint32_t low = 0;
+		for (uint32_t i = 0; i < count; ++i) {
+			// upper bound, changed items go behind remaining items with the same key
+			uint32_t high = renderlist.size();
+			while (low < high) {
+				uint32_t mid = low + (high - low) / 2;
+				sortKey(renderlist[mid], probe);
+				if (m_sortEntries[i] < probe) {
+					high = mid;
+				} else {
+					low = mid + 1;
+				}
+			}
+			positions[i] = low;
+		}
+
+		// merge both lists
+		m_sortItems.clear();
+		m_sortItems.reserve(renderlist.size() + count);
+		uint32_t next = 0;
+		for (uint32_t i = 0; i < count; ++i) {
+			m_sortItems.insert(m_sortItems.end(), renderlist.begin() + next, renderlist.begin() + positions[i]);
+			m_sortItems.push_back(changed[m_sortEntries[i].index]);
+			next = positions[i];
+		}
+		m_sortItems.insert(m_sortItems.end(), renderlist.begin() + next, renderlist.end());
+		renderlist.swap(m_sortItems);
+	}
+
+	void LayerCache::markChangedEntries(const std::vector<int32_t>& indices) {
+		RenderBackend* renderbackend = RenderBackend::instance();
+		bool isStatic = m_layer->isStatic();
+		bool dirtyRects = renderbackend->isDirtyRectsEnabled();
+		const Rect& viewport = m_camera->getViewPort();
+		for (std::vector<int32_t>::const_iterator it = indices.begin(); it != indices.end(); ++it) {
+			Entry* entry = m_entries[*it];
+			if (entry->instanceIndex == -1) {
+				continue;
+			}
+			RenderItem* item = m_renderItems[entry->instanceIndex];
+			if (!item->image) {
+				continue;
+			}
+			if (isStatic) {
+				m_tileCache.invalidate(item->bbox);
+			}
+			if (dirtyRects && entry->visible) {
+				Rect area = item->dimensions;
+				if (area.intersectInplace(viewport)) {
+					renderbackend->addDirtyRect(area);
+				}
+			}
+		}
+	}
+
+	RenderTileCache& LayerCache::getTileCache() {
+		return m_tileCache;
+	}
+
+	void LayerCache::collectRenderItems(const Rect& area, RenderList& renderlist) {
+		renderlist.clear();
+		if (!m_layer->areInstancesVisible()) {
+			return;
+		}
+		std::vector<int32_t> indices;
+		collect(area, indices);
+		for (std::vector<int32_t>::const_iterator it = indices.begin(); it != indices.end(); ++it) {
+			Entry* entry = m_entries[*it];
+			if (entry->instanceIndex == -1 || !entry->visible) {
+				continue;
+			}
+			RenderItem* item = m_renderItems[entry->instanceIndex];
+			if (item->image && item->bbox.intersects(area)) {
+				renderlist.push_back(item);
+			}
+		}
+		sortRenderList(renderlist);
 	}
 
-	void LayerCache::setCacheImage(ImagePtr image) {
-		m_cacheImage = image;
+	void LayerCache::setWorkerPool(WorkerPool* pool) {
+		m_workerPool = pool;
 	}
 }
@@ -26,6 +26,8 @@
 #include <string>
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 // 3rd party library includes
 
@@ -37,14 +39,21 @@
 #include "util/math/matrix.h"
 #include "util/structures/rect.h"
 #include "util/structures/quadtree.h"
+#include "util/structures/radixsort.h"
 #include "model/metamodel/grids/cellgrid.h"
 
+#include "cachegrid.h"
 #include "rendererbase.h"
+#include "rendertilecache.h"
 
 namespace FIFE {
 
+	class Action;
+	class Animation;
 	class Camera;
 	class CacheLayerChangeListener;
+	class OverlayColors;
+	class WorkerPool;
 
 	class LayerCache {
 	public:
@@ -60,9 +69,18 @@ namespace FIFE {
 		void addInstance(Instance* instance);
 		void removeInstance(Instance* instance);
 		void updateInstance(Instance* instance);
-		
-		ImagePtr getCacheImage();
-		void setCacheImage(ImagePtr image);
+
+		/** Returns the render tiles of a static layer.
+		 */
+		RenderTileCache& getTileCache();
+
+		/** Collects the visible items that intersect the virtual screen area, sorted in render order.
+		 */
+		void collectRenderItems(const Rect& area, RenderList& renderlist);
+
+		/** Sets the pool that updates the entries in parallel, NULL updates them serially.
+		 */
+		void setWorkerPool(WorkerPool* pool);
 
 	private:
 		enum RenderEntryUpdateType {
@@ -73,6 +91,28 @@ namespace FIFE {
 		};
 		typedef uint8_t RenderEntryUpdate;
 
+		// Entries with a pending update, a dirty flag per entry and a list of the flagged entries
+		class DirtyEntries {
+		public:
+			DirtyEntries(): m_count(0) {}
+
+			void insert(int32_t index);
+			void erase(int32_t index);
+			void clear();
+			bool empty() const { return m_count == 0; }
+			uint32_t size() const { return m_count; }
+			// Copies the flagged entries in ascending order
+			void getIndices(std::vector<int32_t>& indices);
+
+		private:
+			void compact();
+
+			std::vector<uint8_t> m_flags;
+			// Can contain unflagged and duplicate indices until compact() is called
+			std::vector<int32_t> m_indices;
+			uint32_t m_count;
+		};
+
 		struct Entry {
 			// Node in m_tree;
 			CacheTree::Node* node;
@@ -88,33 +128,116 @@ namespace FIFE {
 			RenderEntryUpdate updateInfo;
 		};
 
+		// A frame picked by a visual update. Only plain pointers and indices, so worker
+		// threads never copy the shared pointers of images and animations.
+		struct VisualFrame {
+			// Animation of the frame, 0 for static images
+			Animation* animation;
+			// Frame index in the animation
+			int32_t index;
+			// Handle of a static image
+			ResourceHandle handle;
+			// The image, 0 if there is none
+			Image* image;
+		};
+
+		// Result of a visual update. It is computed on a worker thread or on the main thread,
+		// the render item takes it over on the main thread.
+		struct VisualUpdate {
+			// New image of the render item
+			VisualFrame image;
+			// Frames of the animation overlay, used if animationOverlay is set
+			std::vector<VisualFrame> overlayFrames;
+			// Color overlays of the animation overlay frames, used if animationColorOverlay is set
+			std::vector<OverlayColors*> overlayColors;
+			bool animationOverlay;
+			bool animationColorOverlay;
+			// Single color overlay
+			OverlayColors* colorOverlay;
+			// Frames for shared color overlays
+			std::vector<std::pair<OverlayColors*, VisualFrame> > colorOverlayFrames;
+			// Reached action frames
+			std::vector<std::pair<Action*, int32_t> > actionFrames;
+			// An image was not loaded, the visual update has to be repeated on the main thread
+			bool serial;
+		};
+
+		// Work of one entry in a parallel update
+		struct EntryJob {
+			// The entry
+			Entry* entry;
+			// Instance of the entry, an event can remove it
+			Instance* instance;
+			// Visual has to be updated
+			bool visual;
+			// Position has to be updated, also set if the image size changed
+			bool position;
+			// Only the screen coordinates have to be updated
+			bool coordinates;
+			// Zoom changed, for coordinate updates
+			bool zoomChange;
+			// Force update flag before the update
+			bool force;
+			// Entry was on screen before the update
+			bool onScreen;
+			// Visual update, taken over on the main thread
+			VisualUpdate update;
+		};
+
 		void collect(const Rect& viewport, std::vector<int32_t>& indices);
 		void reset();
 		void fullUpdate(Camera::Transform transform);
 		void fullCoordinateUpdate(Camera::Transform transform);
-		void updateEntries(std::set<int32_t>& removes, RenderList& renderlist);
+		void updateEntries(std::vector<int32_t>& removes, RenderList& renderlist);
+		void updateEntry(Entry* entry, bool onScreenA, bool positionUpdate, const Rect& viewport,
+			std::vector<int32_t>& removes, RenderList& renderlist, RenderList& needSorting);
 		bool updateVisual(Entry* entry);
+		bool computeVisual(Entry* entry, VisualUpdate& update, bool worker);
+		void applyVisual(Entry* entry, const VisualUpdate& update);
+		bool pickFrame(Animation* animation, uint32_t time, VisualFrame& frame, bool worker);
+		ImagePtr getFrameImage(const VisualFrame& frame);
+		void callActionFrames(Instance* instance, const VisualUpdate& update);
 		void updatePosition(Entry* entry);
+		void calculatePosition(RenderItem* item, Image* image);
+		void updateScreenIndex(Entry* entry);
+		void rebuildScreenIndex();
 		void updateScreenCoordinate(RenderItem* item, bool changedZoom = true);
+		void runEntryJobs(std::vector<EntryJob>& jobs);
+		void runEntryJob(std::vector<EntryJob>& jobs, uint32_t index);
+		bool finishEntryJob(EntryJob& job);
 		void sortRenderList(RenderList& renderlist);
+		void repairRenderList(RenderList& renderlist, RenderList& changed);
+		void markChangedEntries(const std::vector<int32_t>& indices);
+		void updateLodImages();
 
 		Camera* m_camera;
 		Layer* m_layer;
 		CacheLayerChangeListener* m_layerObserver;
 		CacheTree* m_tree;
-		ImagePtr m_cacheImage;
+		CacheGrid* m_grid;
+		ScreenIndexStrategy m_screenIndex;
+		RenderTileCache m_tileCache;
 
 		std::map<Instance*, int32_t> m_instance_map;
 		std::vector<Entry*> m_entries;
 		std::vector<RenderItem*> m_renderItems;
-		std::set<int32_t> m_entriesToUpdate;
+		DirtyEntries m_entriesToUpdate;
 		std::deque<int32_t> m_freeEntries;
 
+		WorkerPool* m_workerPool;
+
+		// Buffers of the render list sorting
+		std::vector<RadixSortEntry> m_sortEntries;
+		std::vector<RadixSortEntry> m_sortScratch;
+		RenderList m_sortItems;
+
 		bool m_needSorting;
 		double m_zMin;
 		double m_zMax;
 
 		double m_zoom;
+		// level of the downscaled image variants for m_zoom
+		uint32_t m_lodLevel;
 		bool m_zoomed;
 		bool m_straightZoom;
 	};
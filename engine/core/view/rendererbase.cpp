@@ -30,6 +30,7 @@
 #include "model/structures/layer.h"
 #include "model/structures/map.h"
 #include "util/log/logger.h"
+#include "video/renderbackend.h"
 #include "rendererbase.h"
 
 namespace FIFE {
@@ -82,15 +83,22 @@ namespace FIFE {
 	void RendererBase::addActiveLayer(Layer* layer) {
 		if (std::find(m_active_layers.begin(), m_active_layers.end(), layer) == m_active_layers.end()) {
 			m_active_layers.push_back(layer);
+			invalidateScreen();
 		}
 	}
 	
 	void RendererBase::removeActiveLayer(Layer* layer) {
-		m_active_layers.remove(layer);
+		if (isActivedLayer(layer)) {
+			m_active_layers.remove(layer);
+			invalidateScreen();
+		}
 	}
 	
 	void RendererBase::clearActiveLayers() {
-		m_active_layers.clear();
+		if (!m_active_layers.empty()) {
+			m_active_layers.clear();
+			invalidateScreen();
+		}
 	}
 	
 	bool RendererBase::isActivedLayer(Layer* layer) {
@@ -107,4 +115,10 @@ namespace FIFE {
 		}
 	}
 	
+	void RendererBase::invalidateScreen() {
+		if (m_renderbackend) {
+			m_renderbackend->invalidateScreen();
+		}
+	}
+	
 }
@@ -74,6 +74,13 @@ namespace FIFE {
 	
 	/** Base class for all view renderers
 	 * View renderer renders one aspect of the view shown on screen
+	 *
+	 * In dirty rect mode (see RenderBackend::setDirtyRectsEnabled) a renderer is only
+	 * called for cameras whose viewport is damaged. Enabling, disabling, moving in the
+	 * pipeline and changing the active layers damage the screen. Changes of the content
+	 * a renderer draws, e.g. the nodes of the GenericRenderer, the lights or the floating
+	 * texts, are not tracked. They show up with the next damage on the viewport, so
+	 * whoever changes them reports the area with RenderBackend::addDirtyRect.
 	 */
 	class RendererBase {
 	public:
@@ -166,6 +173,10 @@ namespace FIFE {
 	
 	protected:
 		RendererBase();
+
+		/** Marks the whole screen as damaged, used if the layers of the renderer changed.
+		 */
+		void invalidateScreen();
 		
 		std::list<Layer*> m_active_layers;
 		RenderBackend* m_renderbackend;
@@ -82,41 +82,38 @@ namespace FIFE {
 		Rect cv = cam->getViewPort();
 		CellCache* cache = layer->getCellCache();
 		if (cache) {
-			const std::vector<std::vector<Cell*> >& cells = cache->getCells();
-			std::vector<std::vector<Cell*> >::const_iterator it = cells.begin();
-			for (; it != cells.end(); ++it) {
-				std::vector<Cell*>::const_iterator cit = (*it).begin();
-				for (; cit != (*it).end(); ++cit) {
-					ExactModelCoordinate emc = FIFE::intPt2doublePt((*cit)->getLayerCoordinates());
-					ScreenPoint sp = cam->toScreenCoordinates(cg->toMapCoordinates(emc));
-					// if it is not in cameras view continue
-					if (sp.x < cv.x || sp.x > cv.x + cv.w ||
-						sp.y < cv.y || sp.y > cv.y + cv.h) {
-						continue;
-					}
-					if ((*cit)->getCellType() != CTYPE_NO_BLOCKER) {
-						std::vector<ExactModelCoordinate> vertices;
-						cg->getVertices(vertices, (*cit)->getLayerCoordinates());
-						std::vector<ExactModelCoordinate>::const_iterator it = vertices.begin();
-						int32_t halfind = vertices.size() / 2;
-						ScreenPoint firstpt = cam->toScreenCoordinates(cg->toMapCoordinates(*it));
-						Point pt1(firstpt.x, firstpt.y);
-						Point pt2;
-						++it;
-						for (; it != vertices.end(); it++) {
-							ScreenPoint pts = cam->toScreenCoordinates(cg->toMapCoordinates(*it));
-							pt2.x = pts.x;
-							pt2.y = pts.y;
-							m_renderbackend->drawLine(pt1, pt2, m_color.r, m_color.g, m_color.b);
-							pt1 = pt2;
-						}
-						m_renderbackend->drawLine(pt2, Point(firstpt.x, firstpt.y), m_color.r, m_color.g, m_color.b);
-						ScreenPoint spt1 = cam->toScreenCoordinates(cg->toMapCoordinates(vertices[0]));
-						Point pt3(spt1.x, spt1.y);
-						ScreenPoint spt2 = cam->toScreenCoordinates(cg->toMapCoordinates(vertices[halfind]));
-						Point pt4(spt2.x, spt2.y);
-						m_renderbackend->drawLine(pt3, pt4, m_color.r, m_color.g, m_color.b);
+			const std::vector<Cell*>& cells = cache->getCells();
+			std::vector<Cell*>::const_iterator cit = cells.begin();
+			for (; cit != cells.end(); ++cit) {
+				ExactModelCoordinate emc = FIFE::intPt2doublePt((*cit)->getLayerCoordinates());
+				ScreenPoint sp = cam->toScreenCoordinates(cg->toMapCoordinates(emc));
+				// if it is not in cameras view continue
+				if (sp.x < cv.x || sp.x > cv.x + cv.w ||
+					sp.y < cv.y || sp.y > cv.y + cv.h) {
+					continue;
+				}
+				if ((*cit)->getCellType() != CTYPE_NO_BLOCKER) {
+					std::vector<ExactModelCoordinate> vertices;
+					cg->getVertices(vertices, (*cit)->getLayerCoordinates());
+					std::vector<ExactModelCoordinate>::const_iterator it = vertices.begin();
+					int32_t halfind = vertices.size() / 2;
+					ScreenPoint firstpt = cam->toScreenCoordinates(cg->toMapCoordinates(*it));
+					Point pt1(firstpt.x, firstpt.y);
+					Point pt2;
+					++it;
+					for (; it != vertices.end(); it++) {
+						ScreenPoint pts = cam->toScreenCoordinates(cg->toMapCoordinates(*it));
+						pt2.x = pts.x;
+						pt2.y = pts.y;
+						m_renderbackend->drawLine(pt1, pt2, m_color.r, m_color.g, m_color.b);
+						pt1 = pt2;
 					}
+					m_renderbackend->drawLine(pt2, Point(firstpt.x, firstpt.y), m_color.r, m_color.g, m_color.b);
+					ScreenPoint spt1 = cam->toScreenCoordinates(cg->toMapCoordinates(vertices[0]));
+					Point pt3(spt1.x, spt1.y);
+					ScreenPoint spt2 = cam->toScreenCoordinates(cg->toMapCoordinates(vertices[halfind]));
+					Point pt4(spt2.x, spt2.y);
+					m_renderbackend->drawLine(pt3, pt4, m_color.r, m_color.g, m_color.b);
 				}
 			}
 		} else {
@@ -0,0 +1,140 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "video/imagemanager.h"
+
+#include "effectimagecache.h"
+
+namespace FIFE {
+
+	bool EffectKey::operator<(const EffectKey& rhs) const {
+		if (effect != rhs.effect) {
+			return effect < rhs.effect;
+		}
+		if (color != rhs.color) {
+			return color < rhs.color;
+		}
+		if (width != rhs.width) {
+			return width < rhs.width;
+		}
+		if (threshold != rhs.threshold) {
+			return threshold < rhs.threshold;
+		}
+		if (images != rhs.images) {
+			return images < rhs.images;
+		}
+		return colors < rhs.colors;
+	}
+
+	EffectImageCache::EffectImageCache(uint32_t maxSize):
+		m_maxSize(maxSize) {
+	}
+
+	ImagePtr EffectImageCache::get(const EffectKey& key, uint32_t now) {
+		EffectImageMap_t::iterator it = m_images.find(key);
+		if (it == m_images.end()) {
+			return ImagePtr();
+		}
+		if (it->second.image->getState() != IResource::RES_LOADED) {
+			remove(it);
+			return ImagePtr();
+		}
+		// most recently used first
+		m_usage.splice(m_usage.begin(), m_usage, it->second.use);
+		it->second.timestamp = now;
+		return it->second.image;
+	}
+
+	ImagePtr EffectImageCache::add(const EffectKey& key, Image* image, uint32_t now) {
+		EffectImageMap_t::iterator old = m_images.find(key);
+		if (old != m_images.end()) {
+			remove(old);
+		}
+		EffectImage entry;
+		entry.image = ImageManager::instance()->add(image);
+		m_usage.push_front(key);
+		entry.use = m_usage.begin();
+		entry.timestamp = now;
+		m_images.insert(std::make_pair(key, entry));
+
+		// removes the least recently used images, the new one is kept
+		while (m_images.size() > m_maxSize && m_usage.size() > 1) {
+			remove(m_images.find(m_usage.back()));
+		}
+		return entry.image;
+	}
+
+	bool EffectImageCache::contains(const EffectKey& key) const {
+		return m_images.find(key) != m_images.end();
+	}
+
+	void EffectImageCache::removeUnused(uint32_t now, uint32_t interval) {
+		while (!m_usage.empty()) {
+			EffectImageMap_t::iterator it = m_images.find(m_usage.back());
+			if (now - it->second.timestamp <= interval) {
+				break;
+			}
+			remove(it);
+		}
+	}
+
+	void EffectImageCache::clear() {
+		while (!m_images.empty()) {
+			remove(m_images.begin());
+		}
+	}
+
+	void EffectImageCache::setMaxSize(uint32_t size) {
+		m_maxSize = size;
+		while (m_images.size() > m_maxSize) {
+			remove(m_images.find(m_usage.back()));
+		}
+	}
+
+	uint32_t EffectImageCache::getMaxSize() const {
+		return m_maxSize;
+	}
+
+	uint32_t EffectImageCache::getSize() const {
+		return m_images.size();
+	}
+
+	bool EffectImageCache::empty() const {
+		return m_images.empty();
+	}
+
+	void EffectImageCache::remove(EffectImageMap_t::iterator it) {
+		// instances that still show the image keep it alive
+		if (ImageManager::instance()->exists(it->second.image->getHandle())) {
+			ImageManager::instance()->remove(it->second.image->getHandle());
+		}
+		m_usage.erase(it->second.use);
+		m_images.erase(it);
+	}
+}
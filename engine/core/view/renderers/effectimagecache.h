@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_EFFECTIMAGECACHE_H
+#define FIFE_EFFECTIMAGECACHE_H
+
+// Standard C++ library includes
+#include <list>
+#include <map>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/resource/resource.h"
+#include "video/image.h"
+
+namespace FIFE {
+
+	/** Identifies a generated outline or coloring image.
+	 */
+	struct EffectKey {
+		//! kind of the effect
+		uint8_t effect;
+		//! source images, more than one for animation overlays
+		std::vector<ResourceHandle> images;
+		//! color as R, G, B, A bytes
+		uint32_t color;
+		int32_t width;
+		int32_t threshold;
+		//! source and target colors of a color overlay
+		std::vector<uint32_t> colors;
+
+		bool operator<(const EffectKey& rhs) const;
+	};
+
+	/** Caches the generated effect images, so that instances with the same image and effect share one.
+	 * If the cache is full the least recently used image is removed.
+	 * The images are added to the ImageManager and removed from it together with the cache entry.
+	 */
+	class EffectImageCache {
+	public:
+		/** Constructor.
+		 * @param maxSize The maximal number of cached images.
+		 */
+		EffectImageCache(uint32_t maxSize);
+
+		/** Returns the cached image and marks it as used, an empty pointer if there is none.
+		 * Images that are not loaded anymore are removed.
+		 * @param now The current time in milliseconds.
+		 */
+		ImagePtr get(const EffectKey& key, uint32_t now);
+
+		/** Adds the image to the ImageManager and the cache, it becomes the most recently used one.
+		 * Removes the least recently used images if the cache is full.
+		 * @param now The current time in milliseconds.
+		 */
+		ImagePtr add(const EffectKey& key, Image* image, uint32_t now);
+
+		/** Returns true if the key is cached, without marking it as used.
+		 */
+		bool contains(const EffectKey& key) const;
+
+		/** Removes the images that were not used for longer than the interval.
+		 */
+		void removeUnused(uint32_t now, uint32_t interval);
+
+		/** Removes all images.
+		 */
+		void clear();
+
+		/** Sets the maximal number of cached images, removes the least recently used ones if needed.
+		 */
+		void setMaxSize(uint32_t size);
+
+		/** Gets the maximal number of cached images.
+		 */
+		uint32_t getMaxSize() const;
+
+		/** Gets the number of cached images.
+		 */
+		uint32_t getSize() const;
+
+		/** Returns true if there are no cached images.
+		 */
+		bool empty() const;
+
+	private:
+		EffectImageCache(const EffectImageCache& rhs); /* = delete */
+		EffectImageCache& operator=(const EffectImageCache& rhs); /* = delete */
+
+		struct EffectImage {
+			ImagePtr image;
+			//! position in m_usage
+			std::list<EffectKey>::iterator use;
+			//! time of the last use
+			uint32_t timestamp;
+		};
+		typedef std::map<EffectKey, EffectImage> EffectImageMap_t;
+
+		void remove(EffectImageMap_t::iterator it);
+
+		//! cached images
+		EffectImageMap_t m_images;
+		//! keys of the cached images, most recently used first
+		std::list<EffectKey> m_usage;
+		uint32_t m_maxSize;
+	};
+}
+
+#endif
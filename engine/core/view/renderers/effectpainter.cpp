@@ -0,0 +1,152 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "video/image.h"
+
+#include "effectpainter.h"
+
+namespace FIFE {
+
+	bool aboveThreshold(int32_t threshold, int32_t alpha, int32_t prev_alpha) {
+		if(threshold > 1) {
+			// new behavior
+			if (((alpha - threshold) >= 0 || (prev_alpha - threshold) >= 0) && (alpha != prev_alpha)) {
+				return true;
+			} else {
+				return false;
+			}
+		} else {
+			// old behavior
+			if((alpha == 0 || prev_alpha == 0) && (alpha != prev_alpha)) {
+				return true;
+			} else {
+				return false;
+			}
+		}
+	}
+
+	bool getOutlineAlpha(Image* image, bool useMask, std::vector<uint8_t>& alpha) {
+		const int32_t w = image->getWidth();
+		const int32_t h = image->getHeight();
+		alpha.assign(w * h, 0);
+		if (useMask) {
+			for (int32_t y = 0; y < h; ++y) {
+				uint8_t* row = &alpha[y * w];
+				for (int32_t x = 0; x < w; ++x) {
+					row[x] = image->isAlphaMaskHit(x, y) ? 255 : 0;
+				}
+			}
+			return true;
+		}
+		SDL_Surface* pixels = image->createRGBASurface();
+		if (!pixels) {
+			return false;
+		}
+		for (int32_t y = 0; y < h; ++y) {
+			const uint8_t* src = static_cast<const uint8_t*>(pixels->pixels) + y * pixels->pitch + 3;
+			uint8_t* row = &alpha[y * w];
+			for (int32_t x = 0; x < w; ++x) {
+				row[x] = src[x * 4];
+			}
+		}
+		SDL_FreeSurface(pixels);
+		return true;
+	}
+
+	void paintOutline(const std::vector<uint8_t>& alpha, int32_t w, int32_t h, SDL_Surface* target,
+		int32_t ox, int32_t oy, uint32_t color, int32_t width, int32_t threshold) {
+		if (w <= 0 || h <= 0) {
+			return;
+		}
+		uint32_t* pixels = static_cast<uint32_t*>(target->pixels);
+		const int32_t stride = target->pitch / 4;
+		const std::vector<uint8_t> zeros(w, 0);
+		std::vector<uint8_t> edges(w);
+
+		// vertical sweep, every row is compared with the row above
+		for (int32_t y = 0; y < h; ++y) {
+			const uint8_t* cur = &alpha[y * w];
+			const uint8_t* prev = y > 0 ? &alpha[(y - 1) * w] : &zeros[0];
+			for (int32_t x = 0; x < w; ++x) {
+				edges[x] = aboveThreshold(threshold, cur[x], prev[x]);
+			}
+			for (int32_t x = 0; x < w; ++x) {
+				const int32_t tx = x + ox;
+				if (!edges[x] || tx < 0 || tx >= target->w) {
+					continue;
+				}
+				// the outline is drawn on the transparent side of the edge
+				const int32_t start = (cur[x] < prev[x] ? y : y - width) + oy;
+				const int32_t y0 = std::max(start, 0);
+				const int32_t y1 = std::min(start + width, target->h);
+				for (int32_t ty = y0; ty < y1; ++ty) {
+					pixels[ty * stride + tx] = color;
+				}
+			}
+		}
+		// horizontal sweep, every pixel is compared with its left neighbor
+		for (int32_t y = 0; y < h; ++y) {
+			const int32_t ty = y + oy;
+			if (ty < 0 || ty >= target->h) {
+				continue;
+			}
+			const uint8_t* cur = &alpha[y * w];
+			uint32_t* row = pixels + ty * stride;
+			int32_t prev = 0;
+			for (int32_t x = 0; x < w; ++x) {
+				if (aboveThreshold(threshold, cur[x], prev)) {
+					const int32_t start = (cur[x] < prev ? x : x - width) + ox;
+					const int32_t x1 = std::min(start + width, target->w);
+					for (int32_t tx = std::max(start, 0); tx < x1; ++tx) {
+						row[tx] = color;
+					}
+				}
+				prev = cur[x];
+			}
+		}
+	}
+
+	void paintColoring(SDL_Surface* surface, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+		const uint32_t weight = a;
+		const uint32_t color[3] = { r * (255u - weight), g * (255u - weight), b * (255u - weight) };
+		for (int32_t y = 0; y < surface->h; ++y) {
+			uint8_t* p = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch;
+			for (int32_t x = 0; x < surface->w; ++x, p += 4) {
+				if (p[3] == 0) {
+					p[0] = p[1] = p[2] = 0;
+					continue;
+				}
+				p[0] = static_cast<uint8_t>((color[0] + p[0] * weight) / 255);
+				p[1] = static_cast<uint8_t>((color[1] + p[1] * weight) / 255);
+				p[2] = static_cast<uint8_t>((color[2] + p[2] * weight) / 255);
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_EFFECTPAINTER_H
+#define FIFE_EFFECTPAINTER_H
+
+// Standard C++ library includes
+#include <cstring>
+#include <vector>
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	class Image;
+
+	/** Packs the color as R, G, B, A bytes, the layout of the RGBA surfaces.
+	 */
+	inline uint32_t packRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+		const uint8_t bytes[4] = { r, g, b, a };
+		uint32_t color;
+		memcpy(&color, bytes, sizeof(color));
+		return color;
+	}
+
+	/** Returns true if there is an outline edge between two neighboring pixels.
+	 * Thresholds up to 1 only separate transparent and not transparent pixels (old behavior),
+	 * larger ones need one of the alpha values to reach the threshold (new behavior).
+	 */
+	bool aboveThreshold(int32_t threshold, int32_t alpha, int32_t prev_alpha);
+
+	/** Fills the alpha values of the image row by row.
+	 * With the old threshold behavior only transparent and not transparent pixels matter,
+	 * so the alpha mask of the image is used if its threshold is 1.
+	 * @return false if the pixels of the image are not available.
+	 */
+	bool getOutlineAlpha(Image* image, bool useMask, std::vector<uint8_t>& alpha);
+
+	/** Paints the outline of the alpha values into the RGBA surface.
+	 * The edges are the same as the ones of a vertical and a horizontal sweep over the pixels,
+	 * but whole rows are compared and written without locking or mapping single pixels.
+	 * Pixels outside of the surface are clipped.
+	 * @param ox, oy Position of the image in the surface.
+	 */
+	void paintOutline(const std::vector<uint8_t>& alpha, int32_t w, int32_t h, SDL_Surface* target,
+		int32_t ox, int32_t oy, uint32_t color, int32_t width, int32_t threshold);
+
+	/** Blends the color into the visible pixels of the RGBA surface.
+	 * @param a Weight of the image pixels, 255 keeps the image colors.
+	 */
+	void paintColoring(SDL_Surface* surface, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+}
+
+#endif
@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 
 // 3rd party library includes
 
@@ -47,6 +48,7 @@
 
 #include "view/camera.h"
 #include "view/visual.h"
+#include "effectpainter.h"
 #include "instancerenderer.h"
 
 
@@ -102,13 +104,9 @@ namespace FIFE {
 	}
 
 	InstanceRenderer::OutlineInfo::~OutlineInfo() {
-		renderer->addToCheck(outline);
 	}
 
 	InstanceRenderer::ColoringInfo::~ColoringInfo() {
-		if (renderer->needColorBinding()) {
-			renderer->addToCheck(overlay);
-		}
 	}
 
 	InstanceRenderer::AreaInfo::~AreaInfo() {
@@ -122,7 +120,8 @@ namespace FIFE {
 		RendererBase(renderbackend, position),
 		m_area_layer(false),
 		m_interval(60*1000),
-		m_timer_enabled(false) {
+		m_timer_enabled(false),
+		m_effect_cache(512) {
 		setEnabled(true);
 		if (m_renderbackend->getName() == "OpenGL" && m_renderbackend->isDepthBufferEnabled()) {
 			m_need_sorting = false;
@@ -146,7 +145,8 @@ namespace FIFE {
 		RendererBase(old),
 		m_area_layer(false),
 		m_interval(old.m_interval),
-		m_timer_enabled(false) {
+		m_timer_enabled(false),
+		m_effect_cache(old.m_effect_cache.getMaxSize()) {
 		setEnabled(true);
 		if (m_renderbackend->getName() == "OpenGL" && m_renderbackend->isDepthBufferEnabled()) {
 			m_need_sorting = false;
@@ -319,7 +319,7 @@ namespace FIFE {
 				renderOverlay(RENDER_DATA_MULTITEXTURE_Z, &vc, coloringColor, recoloring);
 			// no overlay
 			} else {
-				vc.image->renderZ(vc.dimensions, vertexZ, vc.transparency, recoloring ? coloringColor : 0);
+				vc.getRenderImage()->renderZ(vc.dimensions, vertexZ, vc.transparency, recoloring ? coloringColor : 0);
 			}
 
 			if (outlineImage) {
@@ -367,7 +367,7 @@ namespace FIFE {
 				renderOverlay(RENDER_DATA_MULTITEXTURE_Z, &vc, coloringColor, recoloring);
 			// no overlay
 			} else {
-				vc.image->renderZ(vc.dimensions, vertexZ, vc.transparency, recoloring ? coloringColor : 0);
+				vc.getRenderImage()->renderZ(vc.dimensions, vertexZ, vc.transparency, recoloring ? coloringColor : 0);
 			}
 
 			if (outlineImage) {
@@ -482,7 +482,7 @@ namespace FIFE {
 							break;
 						}
 					}
-					vc.image->render(vc.dimensions, vc.transparency, recoloring ? coloringColor : 0);
+					vc.getRenderImage()->render(vc.dimensions, vc.transparency, recoloring ? coloringColor : 0);
 					if (found) {
 						m_renderbackend->changeRenderInfos(RENDER_DATA_WITHOUT_Z, 1, 4, 5, false, true, 255, REPLACE, ALWAYS, recoloring ? OVERLAY_TYPE_COLOR : OVERLAY_TYPE_NONE);
 					} else {
@@ -500,7 +500,7 @@ namespace FIFE {
 				renderOverlay(RENDER_DATA_WITHOUT_Z, &vc, coloringColor, recoloring);
 			// no overlay
 			} else {
-				vc.image->render(vc.dimensions, vc.transparency, recoloring ? coloringColor : 0);
+				vc.getRenderImage()->render(vc.dimensions, vc.transparency, recoloring ? coloringColor : 0);
 			}
 
 			if (outlineImage) {
@@ -686,38 +686,27 @@ namespace FIFE {
 		}
 	}
 
-	inline bool aboveThreshold(int32_t threshold, int32_t alpha, int32_t prev_alpha) {
-		if(threshold > 1) {
-			// new behavior
-			if (((alpha - threshold) >= 0 || (prev_alpha - threshold) >= 0) && (alpha != prev_alpha)) {
-				return true;
-			} else {
-				return false;
-			}
-		} else {
-			// old behavior
-			if((alpha == 0 || prev_alpha == 0) && (alpha != prev_alpha)) {
-				return true;
-			} else {
-				return false;
-			}
+	ImagePtr InstanceRenderer::getEffectImage(const EffectKey& key) {
+		return m_effect_cache.get(key, TimeManager::instance()->getTime());
+	}
+
+	ImagePtr InstanceRenderer::addEffectImage(const EffectKey& key, SDL_Surface* surface) {
+		// In case of OpenGL backend, SDLImage needs to be converted
+		Image* img = m_renderbackend->createImage(surface);
+		img->setState(IResource::RES_LOADED);
+		if (!m_timer_enabled) {
+			m_timer_enabled = true;
+			m_timer.start();
 		}
+		return m_effect_cache.add(key, img, TimeManager::instance()->getTime());
 	}
 
 	Image* InstanceRenderer::bindOutline(OutlineInfo& info, RenderItem& vc, Camera* cam) {
-		bool valid = isValidImage(info.outline);
-		if (!info.dirty && info.curimg == vc.image.get() && valid) {
-			removeFromCheck(info.outline);
+		if (!info.dirty && info.curimg == vc.image.get() && isValidImage(info.outline)) {
 			// optimization for outline that has not changed
 			return info.outline.get();
-		} else {
-			info.curimg = vc.image.get();
-		}
-
-		// if outline has changed we can maybe free the old effect image
-		if (valid) {
-			addToCheck(info.outline);
 		}
+		info.curimg = vc.image.get();
 		// special case for animation overlay
 		if (vc.getAnimationOverlay()) {
 			return bindMultiOutline(info, vc, cam);
@@ -726,91 +715,32 @@ namespace FIFE {
 		// we need to first render normal image, and then its outline.
 		// This helps much with lighting stuff and doesn't require from us to copy image.
 
-		bool found = false;
-		// create name
-		std::stringstream sts;
-		sts << vc.image.get()->getName() << "," << static_cast<uint32_t>(info.r) << "," <<
-			static_cast<uint32_t>(info.g) << "," << static_cast<uint32_t>(info.b) << "," << info.width;
-		// search image
-		if (ImageManager::instance()->exists(sts.str())) {
-			info.outline = ImageManager::instance()->getPtr(sts.str());
-			if (isValidImage(info.outline)) {
-				removeFromCheck(info.outline);
-				// mark outline as not dirty since we found it here
-				info.dirty = false;
-				return info.outline.get();
+		EffectKey key;
+		key.effect = OUTLINE;
+		key.images.push_back(vc.image->getHandle());
+		key.color = packRGBA(info.r, info.g, info.b, 255);
+		key.width = info.width;
+		// all thresholds up to 1 use the old behavior
+		key.threshold = std::max(info.threshold, 1);
+		info.outline = getEffectImage(key);
+		if (!info.outline) {
+			// With lazy loading we can come upon a situation where we need to generate outline from
+			// uninitialised shared image
+			if(vc.image->isSharedImage()) {
+				vc.image->forceLoadInternal();
 			}
-			found = true;
-		}
 
-
-		// With lazy loading we can come upon a situation where we need to generate outline from
-		// uninitialised shared image
-		if(vc.image->isSharedImage()) {
-			vc.image->forceLoadInternal();
-		}
-
-		SDL_Surface* outline_surface = SDL_CreateRGBSurface(0,
-			vc.image->getWidth(), vc.image->getHeight(), 32,
-			RMASK, GMASK, BMASK, AMASK);
-
-		// TODO: optimize...
-		uint8_t r, g, b, a = 0;
-
-		// vertical sweep
-		for (int32_t x = 0; x < outline_surface->w; x ++) {
-			int32_t prev_a = 0;
-			for (int32_t y = 0; y < outline_surface->h; y ++) {
-				vc.image->getPixelRGBA(x, y, &r, &g, &b, &a);
-				if (aboveThreshold(info.threshold, static_cast<int32_t>(a), prev_a)) {
-					if (a < prev_a) {
-						for (int32_t yy = y; yy < y + info.width; yy++) {
-							Image::putPixel(outline_surface, x, yy, info.r, info.g, info.b);
-						}
-					} else {
-						for (int32_t yy = y - info.width; yy < y; yy++) {
-							Image::putPixel(outline_surface, x, yy, info.r, info.g, info.b);
-						}
-					}
-				}
-				prev_a = a;
+			const int32_t w = vc.image->getWidth();
+			const int32_t h = vc.image->getHeight();
+			SDL_Surface* outline_surface = SDL_CreateRGBSurface(0, w, h, 32, RMASK, GMASK, BMASK, AMASK);
+			std::vector<uint8_t> alpha;
+			const bool useMask = info.threshold <= 1 && m_renderbackend->getAlphaMaskThreshold() == 1;
+			if (getOutlineAlpha(vc.image.get(), useMask, alpha)) {
+				paintOutline(alpha, w, h, outline_surface, 0, 0, key.color, info.width, info.threshold);
 			}
+			info.outline = addEffectImage(key, outline_surface);
 		}
-		// horizontal sweep
-		for (int32_t y = 0; y < outline_surface->h; y ++) {
-			int32_t prev_a = 0;
-			for (int32_t x = 0; x < outline_surface->w; x ++) {
-				vc.image->getPixelRGBA(x, y, &r, &g, &b, &a);
-				if (aboveThreshold(info.threshold, static_cast<int32_t>(a), prev_a)) {
-					if (a < prev_a) {
-						for (int32_t xx = x; xx < x + info.width; xx++) {
-							Image::putPixel(outline_surface, xx, y, info.r, info.g, info.b);
-						}
-					} else {
-						for (int32_t xx = x - info.width; xx < x; xx++) {
-							Image::putPixel(outline_surface, xx, y, info.r, info.g, info.b);
-						}
-					}
-				}
-				prev_a = a;
-			}
-		}
-
-		// In case of OpenGL backend, SDLImage needs to be converted
-		Image* img = m_renderbackend->createImage(sts.str(), outline_surface);
-		img->setState(IResource::RES_LOADED);
-
-		if (found) {
-			// image exists but is not "loaded"
-			removeFromCheck(info.outline);
-			ImagePtr temp(img);
-			info.outline.get()->copySubimage(0, 0, temp);
-			info.outline.get()->setState(IResource::RES_LOADED);
-		} else {
-			// create and add image
-			info.outline = ImageManager::instance()->add(img);
-		}
-		// mark outline as not dirty since we created/recreated it here
+		// mark outline as not dirty since we found or created it here
 		info.dirty = false;
 
 		return info.outline.get();
@@ -821,184 +751,88 @@ namespace FIFE {
 		// we need to first render normal image, and then its outline.
 		// This helps much with lighting stuff and doesn't require from us to copy image.
 
-		bool found = false;
-		// create name
-		std::stringstream sts;
-		uint32_t mw = 0;
-		uint32_t mh = 0;
+		EffectKey key;
+		key.effect = OUTLINE;
+		key.color = packRGBA(info.r, info.g, info.b, 255);
+		key.width = info.width;
+		key.threshold = std::max(info.threshold, 1);
 		std::vector<ImagePtr>* animationOverlays = vc.getAnimationOverlay();
 		std::vector<ImagePtr>::iterator it = animationOverlays->begin();
 		for (; it != animationOverlays->end(); ++it) {
+			key.images.push_back((*it)->getHandle());
+		}
+		info.outline = getEffectImage(key);
+		if (info.outline) {
+			info.dirty = false;
+			return info.outline.get();
+		}
+
+		int32_t mw = 0;
+		int32_t mh = 0;
+		for (it = animationOverlays->begin(); it != animationOverlays->end(); ++it) {
 			// With lazy loading we can come upon a situation where we need to generate outline from
 			// uninitialised shared image
 			if ((*it)->isSharedImage()) {
 				(*it)->forceLoadInternal();
 			}
-			sts << (*it)->getName() << ",";
-			mw = std::max(mw, (*it)->getWidth());
-			mh = std::max(mh, (*it)->getHeight());
-		}
-		sts << static_cast<uint32_t>(info.r) << "," <<
-			static_cast<uint32_t>(info.g) << "," << static_cast<uint32_t>(info.b) << "," << info.width;
-		// search image
-		if (ImageManager::instance()->exists(sts.str())) {
-			info.outline = ImageManager::instance()->getPtr(sts.str());
-			if (isValidImage(info.outline)) {
-				removeFromCheck(info.outline);
-				// mark outline as not dirty since we found it here
-				info.dirty = false;
-				return info.outline.get();
-			}
-			found = true;
+			mw = std::max(mw, static_cast<int32_t>((*it)->getWidth()));
+			mh = std::max(mh, static_cast<int32_t>((*it)->getHeight()));
 		}
 
 		SDL_Surface* outline_surface = SDL_CreateRGBSurface(0, mw, mh, 32,
 			RMASK, GMASK, BMASK, AMASK);
 
-		// TODO: optimize...
-		uint8_t r, g, b, a = 0;
-
-		it = animationOverlays->begin();
-		for (; it != animationOverlays->end(); ++it) {
-			// vertical sweep
-			for (uint32_t x = 0; x < (*it)->getWidth(); x++) {
-				int32_t prev_a = 0;
-				for (uint32_t y = 0; y < (*it)->getHeight(); y++) {
-					(*it)->getPixelRGBA(x, y, &r, &g, &b, &a);
-					if (aboveThreshold(info.threshold, static_cast<int32_t>(a), prev_a)) {
-						if (a < prev_a) {
-							for (uint32_t yy = y; yy < y + info.width; yy++) {
-								int32_t tx = x + (mw/2 - (*it)->getWidth()/2);
-								int32_t ty = yy + (mh/2 - (*it)->getHeight()/2);
-								Image::putPixel(outline_surface, tx, ty, info.r, info.g, info.b);
-							}
-						} else {
-							for (uint32_t yy = y - info.width; yy < y; yy++) {
-								int32_t tx = x + (mw/2 - (*it)->getWidth()/2);
-								int32_t ty = yy + (mh/2 - (*it)->getHeight()/2);
-								Image::putPixel(outline_surface, tx, ty, info.r, info.g, info.b);
-							}
-						}
-					}
-					prev_a = a;
-				}
-			}
-
-			// horizontal sweep
-			for (uint32_t y = 0; y < (*it)->getHeight(); y++) {
-				int32_t prev_a = 0;
-				for (uint32_t x = 0; x < (*it)->getWidth(); x++) {
-					(*it)->getPixelRGBA(x, y, &r, &g, &b, &a);
-					if (aboveThreshold(info.threshold, static_cast<int32_t>(a), prev_a)) {
-						if (a < prev_a) {
-							for (uint32_t xx = x; xx < x + info.width; xx++) {
-								int32_t tx = xx + (mw/2 - (*it)->getWidth()/2);
-								int32_t ty = y + (mh/2 - (*it)->getHeight()/2);
-								Image::putPixel(outline_surface, tx, ty, info.r, info.g, info.b);
-							}
-						} else {
-							for (uint32_t xx = x - info.width; xx < x; xx++) {
-								int32_t tx = xx + (mw/2 - (*it)->getWidth()/2);
-								int32_t ty = y + (mh/2 - (*it)->getHeight()/2);
-								Image::putPixel(outline_surface, tx, ty, info.r, info.g, info.b);
-							}
-						}
-					}
-					prev_a = a;
-				}
+		const bool useMask = info.threshold <= 1 && m_renderbackend->getAlphaMaskThreshold() == 1;
+		std::vector<uint8_t> alpha;
+		for (it = animationOverlays->begin(); it != animationOverlays->end(); ++it) {
+			if (!getOutlineAlpha(it->get(), useMask, alpha)) {
+				continue;
 			}
+			// the overlays are centered
+			const int32_t w = (*it)->getWidth();
+			const int32_t h = (*it)->getHeight();
+			paintOutline(alpha, w, h, outline_surface, mw / 2 - w / 2, mh / 2 - h / 2, key.color, info.width, info.threshold);
 		}
 
-		// In case of OpenGL backend, SDLImage needs to be converted
-		Image* img = m_renderbackend->createImage(sts.str(), outline_surface);
-		img->setState(IResource::RES_LOADED);
-
-		if (found) {
-			// image exists but is not "loaded"
-			removeFromCheck(info.outline);
-			ImagePtr temp(img);
-			info.outline.get()->copySubimage(0, 0, temp);
-			info.outline.get()->setState(IResource::RES_LOADED);
-		} else {
-			// create and add image
-			info.outline = ImageManager::instance()->add(img);
-		}
-		// mark outline as not dirty since we created/recreated it here
+		info.outline = addEffectImage(key, outline_surface);
+		// mark outline as not dirty since we created it here
 		info.dirty = false;
 
 		return info.outline.get();
 	}
 
 	Image* InstanceRenderer::bindColoring(ColoringInfo& info, RenderItem& vc, Camera* cam) {
-		bool valid = isValidImage(info.overlay);
-		if (!info.dirty && info.curimg == vc.image.get() && valid) {
-			removeFromCheck(info.overlay);
+		if (!info.dirty && info.curimg == vc.image.get() && isValidImage(info.overlay)) {
 			// optimization for coloring that has not changed
 			return info.overlay.get();
-		} else {
-			info.curimg = vc.image.get();
 		}
-
-		// if coloring has changed we can maybe free the old effect image
-		if (valid) {
-			addToCheck(info.overlay);
-		}
-
-		bool found = false;
-		// create name
-		std::stringstream sts;
-		sts << vc.image.get()->getName() << "," << static_cast<uint32_t>(info.r) << "," <<
-			static_cast<uint32_t>(info.g) << "," << static_cast<uint32_t>(info.b) << "," << static_cast<uint32_t>(info.a);
-		// search image
-		if (ImageManager::instance()->exists(sts.str())) {
-			info.overlay = ImageManager::instance()->getPtr(sts.str());
-			valid = isValidImage(info.overlay);
-			if (valid) {
-				removeFromCheck(info.overlay);
-				// mark overlay as not dirty since we found it here
-				info.dirty = false;
-				return info.overlay.get();
+		info.curimg = vc.image.get();
+
+		EffectKey key;
+		key.effect = COLOR;
+		key.images.push_back(vc.image->getHandle());
+		key.color = packRGBA(info.r, info.g, info.b, info.a);
+		key.width = 0;
+		key.threshold = 0;
+		info.overlay = getEffectImage(key);
+		if (!info.overlay) {
+			// With lazy loading we can come upon a situation where we need to generate coloring from
+			// uninitialised shared image
+			if(vc.image->isSharedImage()) {
+				vc.image->forceLoadInternal();
 			}
-			found = true;
-		}
-
-		// With lazy loading we can come upon a situation where we need to generate coloring from
-		// uninitialised shared image
-		if(vc.image->isSharedImage()) {
-			vc.image->forceLoadInternal();
-		}
 
-		// not found so we create it
-		SDL_Surface* overlay_surface = SDL_CreateRGBSurface(0,
-			vc.image->getWidth(), vc.image->getHeight(), 32,
-			RMASK, GMASK, BMASK, AMASK);
-
-		uint8_t r, g, b, a = 0;
-		float alphaFactor = static_cast<float>(info.a/255.0);
-		for (int32_t x = 0; x < overlay_surface->w; x ++) {
-			for (int32_t y = 0; y < overlay_surface->h; y ++) {
-				vc.image->getPixelRGBA(x, y, &r, &g, &b, &a);
-				if (a > 0) {
-					Image::putPixel(overlay_surface, x, y, info.r*(1.0-alphaFactor) + r*alphaFactor, info.g*(1.0-alphaFactor) + g*alphaFactor, info.b*(1.0-alphaFactor) + b*alphaFactor, a);
-				}
+			// not found so we create it from a copy of the image
+			SDL_Surface* overlay_surface = vc.image->createRGBASurface();
+			if (overlay_surface) {
+				paintColoring(overlay_surface, info.r, info.g, info.b, info.a);
+			} else {
+				overlay_surface = SDL_CreateRGBSurface(0, vc.image->getWidth(), vc.image->getHeight(), 32,
+					RMASK, GMASK, BMASK, AMASK);
 			}
+			info.overlay = addEffectImage(key, overlay_surface);
 		}
-
-		// In case of OpenGL backend, SDLImage needs to be converted
-		Image* img = m_renderbackend->createImage(sts.str(), overlay_surface);
-
-		if (found) {
-			// image exists but is not "loaded"
-			removeFromCheck(info.overlay);
-			ImagePtr temp(img);
-			info.overlay.get()->copySubimage(0, 0, temp);
-			info.overlay.get()->setState(IResource::RES_LOADED);
-		} else {
-			// add image
-			img->setState(IResource::RES_LOADED);
-			info.overlay = ImageManager::instance()->add(img);
-		}
-		// mark overlay as not dirty since we created/recreated it here
+		// mark overlay as not dirty since we found or created it here
 		info.dirty = false;
 
 		return info.overlay.get();
@@ -1006,69 +840,36 @@ namespace FIFE {
 
 	ImagePtr InstanceRenderer::getMultiColorOverlay(const RenderItem& vc, OverlayColors* colors) {
 		// multi color overlay
-		const std::map<Color, Color>& colorMap = colors ? colors->getColors() : vc.getColorOverlay()->getColors();
-		std::map<Color, Color>::const_iterator it = colorMap.begin();
-		ImagePtr colorOverlayImage = colors ? colors->getColorOverlayImage() : vc.getColorOverlay()->getColorOverlayImage();
-		ImagePtr colorOverlay;
-
-		// create name
-		std::stringstream sts;
-		sts << colorOverlayImage.get()->getName();
-		for (; it != colorMap.end(); ++it) {
-			sts << "," << static_cast<uint32_t>(it->second.getR() | (it->second.getG() << 8) | (it->second.getB() << 16) | (it->second.getAlpha()<<24));
+		if (!colors) {
+			colors = vc.getColorOverlay();
 		}
-		bool exist = false;
-		bool found = false;
-		if (ImageManager::instance()->exists(sts.str())) {
-			exist = true;
-			colorOverlay = ImageManager::instance()->getPtr(sts.str());
-			if (isValidImage(colorOverlay)) {
-				removeFromCheck(colorOverlay);
-				found = true;
-			}
-		}
-		if (!exist || !found) {
+		ImagePtr colorOverlayImage = colors->getColorOverlayImage();
+
+		EffectKey key;
+		key.effect = RECOLOR;
+		key.images.push_back(colorOverlayImage->getHandle());
+		key.color = 0;
+		key.width = 0;
+		key.threshold = 0;
+		key.colors = colors->getPackedColors();
+		ImagePtr colorOverlay = getEffectImage(key);
+		if (!colorOverlay) {
 			// With lazy loading we can come upon a situation where we need to generate color overlay from
 			// uninitialised shared image
 			if (colorOverlayImage->isSharedImage()) {
 				colorOverlayImage->forceLoadInternal();
 			}
 
-			// not found so we create it
-			SDL_Surface* overlay_surface = SDL_CreateRGBSurface(0,
-				colorOverlayImage->getWidth(), colorOverlayImage->getHeight(), 32,
-				RMASK, GMASK, BMASK, AMASK);
-
-			uint8_t r, g, b, a = 0;
-			for (int32_t x = 0; x < overlay_surface->w; x++) {
-				for (int32_t y = 0; y < overlay_surface->h; y++) {
-					colorOverlayImage->getPixelRGBA(x, y, &r, &g, &b, &a);
-					Color c(r, g, b, a);
-					it = colorMap.find(c);
-					if (it != colorMap.end()) {
-						Image::putPixel(overlay_surface, x, y, it->second.getR(), it->second.getG(), it->second.getB(), it->second.getAlpha());
-					} else {
-						Image::putPixel(overlay_surface, x, y, r, g, b, a);
-					}
-				}
-			}
-
-			// In case of OpenGL backend, SDLImage needs to be converted
-			Image* img = m_renderbackend->createImage(sts.str(), overlay_surface);
-
-			if (exist) {
-				// image exists but is not "loaded"
-				removeFromCheck(colorOverlay);
-				ImagePtr temp(img);
-				colorOverlay.get()->setSurface(img->detachSurface());
-				colorOverlay.get()->setState(IResource::RES_LOADED);
+			// not found so we create it from a copy of the image
+			SDL_Surface* overlay_surface = colorOverlayImage->createRGBASurface();
+			if (overlay_surface) {
+				colors->recolor(overlay_surface);
 			} else {
-				// add image
-				img->setState(IResource::RES_LOADED);
-				colorOverlay = ImageManager::instance()->add(img);
+				overlay_surface = SDL_CreateRGBSurface(0, colorOverlayImage->getWidth(), colorOverlayImage->getHeight(), 32,
+					RMASK, GMASK, BMASK, AMASK);
 			}
+			colorOverlay = addEffectImage(key, overlay_surface);
 		}
-		addToCheck(colorOverlay);
 		return colorOverlay;
 	}
 
@@ -1092,7 +893,7 @@ namespace FIFE {
 			// already exists in the map so lets just update its outline info
 			OutlineInfo& info = insertiter.first->second;
 
-			if (info.r != r || info.g != g || info.b != b || info.width != width) {
+			if (info.r != r || info.g != g || info.b != b || info.width != width || info.threshold != threshold) {
 				// only update the outline info if its changed since the last call
 				// flag the outline info as dirty so it will get processed during rendering
 				info.r = r;
@@ -1290,6 +1091,16 @@ namespace FIFE {
 		}
 	}
 
+	bool InstanceRenderer::hasTransparentAreas(Layer* layer) const {
+		InstanceToAreas_t::const_iterator area_it = m_instance_areas.begin();
+		for (; area_it != m_instance_areas.end(); ++area_it) {
+			if (area_it->second.instance->getLocationRef().getLayer() == layer) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void InstanceRenderer::addIgnoreLight(const std::list<std::string> &groups) {
 		std::list<std::string>::const_iterator group_it = groups.begin();
 		for(;group_it != groups.end(); ++group_it) {
@@ -1319,6 +1130,7 @@ namespace FIFE {
 	void InstanceRenderer::reset() {
 		// stop timer
 		if (m_timer_enabled) {
+			m_timer_enabled = false;
 			m_timer.stop();
 		}
 		// remove all effects and listener
@@ -1328,6 +1140,7 @@ namespace FIFE {
 		removeAllIgnoreLight();
 		// removes the references to the effect images
 		m_check_images.clear();
+		m_effect_cache.clear();
 	}
 
 	void InstanceRenderer::setRemoveInterval(uint32_t interval) {
@@ -1341,6 +1154,14 @@ namespace FIFE {
 		return m_interval/1000;
 	}
 
+	void InstanceRenderer::setEffectCacheSize(uint32_t size) {
+		m_effect_cache.setMaxSize(size);
+	}
+
+	uint32_t InstanceRenderer::getEffectCacheSize() const {
+		return m_effect_cache.getMaxSize();
+	}
+
 	void InstanceRenderer::addToCheck(const ImagePtr& image) {
 		if (isValidImage(image)) {
 			// if image is already inserted then return
@@ -1377,30 +1198,15 @@ namespace FIFE {
 			}
 		}
 
-		if (m_check_images.empty() && m_timer_enabled) {
+		// removes the cached effect images that were not used for the interval
+		m_effect_cache.removeUnused(now, m_interval);
+
+		if (m_check_images.empty() && m_effect_cache.empty() && m_timer_enabled) {
 			m_timer_enabled = false;
 			m_timer.stop();
 		}
 	}
 
-	void InstanceRenderer::removeFromCheck(const ImagePtr& image) {
-		if (isValidImage(image)) {
-			// if the image is used then remove it here
-			ImagesToCheck_t::iterator it = m_check_images.begin();
-			for (; it != m_check_images.end(); ++it) {
-				if (it->image.get()->getName() == image.get()->getName()) {
-					m_check_images.erase(it);
-					break;
-				}
-			}
-
-			if (m_check_images.empty() && m_timer_enabled) {
-				m_timer_enabled = false;
-				m_timer.stop();
-			}
-		}
-	}
-
 	void InstanceRenderer::removeInstance(Instance* instance) {
 		InstanceToEffects_t::iterator it = m_assigned_instances.find(instance);
 		if (it != m_assigned_instances.end()) {
@@ -25,6 +25,8 @@
 // Standard C++ library includes
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
 
 // 3rd party library includes
 
@@ -35,6 +37,8 @@
 #include "view/rendererbase.h"
 #include "util/time/timer.h"
 
+#include "effectimagecache.h"
+
 namespace FIFE {
 	class Location;
 	class RenderBackend;
@@ -94,6 +98,10 @@ namespace FIFE {
 		 */
 		void removeAllTransparentAreas();
 
+		/** Returns true if a transparent area can change the transparency of instances on the layer.
+		 */
+		bool hasTransparentAreas(Layer* layer) const;
+
 		/** Add groups(Namespaces) into a list. All instances, whose namespace is in the list
 		 *  will not lighted from the LightRenderer.
 		 */
@@ -132,7 +140,8 @@ namespace FIFE {
 		 */
 		void addToCheck(const ImagePtr& image);
 
-		/** Timer callback, tried to remove old effect images
+		/** Timer callback, tried to remove old effect images.
+		 * Cached effect images that were not used for the interval are removed too.
 		 */
 		void check();
 
@@ -145,6 +154,15 @@ namespace FIFE {
 		 */
 		bool needColorBinding() { return m_need_bind_coloring; }
 
+		/** Sets the maximal number of cached outline and coloring images (default is 512).
+		 * Instances with the same image and effect share one cached image.
+		 */
+		void setEffectCacheSize(uint32_t size);
+
+		/** Gets the maximal number of cached outline and coloring images.
+		 */
+		uint32_t getEffectCacheSize() const;
+
 	private:
 		bool m_area_layer;
 		uint32_t m_interval;
@@ -157,7 +175,9 @@ namespace FIFE {
 			NOTHING = 0x00,
 			OUTLINE = 0x01,
 			COLOR = 0x02,
-			AREA = 0x04
+			AREA = 0x04,
+			// only used for cached color overlay images
+			RECOLOR = 0x08
 		};
 		typedef uint8_t Effect;
 
@@ -221,6 +241,9 @@ namespace FIFE {
 		// timer
 		Timer m_timer;
 
+		// cached effect images
+		EffectImageCache m_effect_cache;
+
 		// InstanceDeleteListener to automatically remove Instance effect (outline, coloring, ...)
 		InstanceDeleteListener* m_delete_listener;
 		typedef std::map<Instance*, Effect> InstanceToEffects_t;
@@ -239,7 +262,13 @@ namespace FIFE {
 		void renderUnsorted(Camera* cam, Layer* layer, RenderList& instances);
 		void renderAlreadySorted(Camera* cam, Layer* layer, RenderList& instances);
 
-		void removeFromCheck(const ImagePtr& image);
+		/** Returns the cached effect image, an empty pointer if there is none.
+		 */
+		ImagePtr getEffectImage(const EffectKey& key);
+		/** Creates an image from the surface and adds it to the cache.
+		 */
+		ImagePtr addEffectImage(const EffectKey& key, SDL_Surface* surface);
+
 		bool isValidImage(const ImagePtr& image);
 	};
 }
@@ -41,12 +41,15 @@ namespace FIFE {
 		void addTransparentArea(Instance* instance, const std::list<std::string> &groups, uint32_t w, uint32_t h, uint8_t trans, bool front = true);
 		void removeTransparentArea(Instance* instance);
 		void removeAllTransparentAreas();
+		bool hasTransparentAreas(Layer* layer) const;
 		void addIgnoreLight(const std::list<std::string> &groups);
 		void removeIgnoreLight(const std::list<std::string> &groups);
 		void removeAllIgnoreLight();
 		static InstanceRenderer* getInstance(IRendererContainer* cnt);
 		void setRemoveInterval(uint32_t interval);
 		uint32_t getRemoveInterval() const;
+		void setEffectCacheSize(uint32_t size);
+		uint32_t getEffectCacheSize() const;
 	private:
 		InstanceRenderer(RenderBackend* renderbackend, int32_t position);
 	};
@@ -30,6 +30,7 @@
 #include "model/structures/instance.h"
 #include "model/metamodel/object.h"
 #include "model/metamodel/action.h"
+#include "video/imagemanager.h"
 
 #include "visual.h"
 #include "renderitem.h"
@@ -54,6 +55,7 @@ namespace FIFE {
 		screenpoint(),
 		dimensions(),
 		vertexZ(0),
+		lodLevel(0),
 		facingAngle(0),
 		transparency(255),
 		currentFrame(-1),
@@ -133,10 +135,18 @@ namespace FIFE {
 		}
 	}
 
+	ImagePtr RenderItem::getRenderImage() const {
+		if (lodLevel == 0) {
+			return image;
+		}
+		return ImageManager::instance()->getLodImage(image, lodLevel);
+	}
+
 	void RenderItem::reset() {
 		instance = 0;
 		dimensions = Rect();
 		image.reset();
+		lodLevel = 0;
 		transparency = 255;
 		currentFrame = -1;
 		m_cachedStaticImgId = STATIC_IMAGE_NOT_INITIALIZED;
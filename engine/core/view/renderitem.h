@@ -96,6 +96,11 @@ namespace FIFE {
 			*/
 			void reset();
 
+			/** Returns the image to draw, the downscaled variant of lodLevel if there is one.
+			* The variant is looked up on every call and not kept, so it can be evicted.
+			*/
+			ImagePtr getRenderImage() const;
+
 			// point where instance was drawn during the previous render
 			DoublePoint3D screenpoint;
 
@@ -111,6 +116,9 @@ namespace FIFE {
 			// image used during previous render
 			ImagePtr image;
 
+			// level of the downscaled variant for the zoom, 0 draws image
+			uint32_t lodLevel;
+
 			// current facing angle
 			int32_t facingAngle;
 
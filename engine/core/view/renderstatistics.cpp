@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <sstream>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/base/stringutils.h"
+
+#include "renderstatistics.h"
+
+namespace FIFE {
+
+	RenderStatistic::RenderStatistic()
+	: milliseconds(0.0), items(0), culled(0) {
+	}
+
+	uint32_t RenderStatistics::getStatisticCount() const {
+		return static_cast<uint32_t>(m_statistics.size());
+	}
+
+	const RenderStatistic& RenderStatistics::getStatistic(uint32_t index) const {
+		if (index >= m_statistics.size()) {
+			throw IndexOverflow("render statistic index out of range");
+		}
+		return m_statistics[index];
+	}
+
+	RenderStatistic RenderStatistics::getTotal() const {
+		RenderStatistic total;
+		std::vector<RenderStatistic>::const_iterator it = m_statistics.begin();
+		for (; it != m_statistics.end(); ++it) {
+			total.milliseconds += it->milliseconds;
+			total.items += it->items;
+			total.counters += it->counters;
+		}
+		std::map<std::string, uint32_t>::const_iterator cit = m_culled.begin();
+		for (; cit != m_culled.end(); ++cit) {
+			total.culled += cit->second;
+		}
+		return total;
+	}
+
+	void RenderStatistics::setCulled(const std::string& layer, uint32_t culled) {
+		m_culled[layer] = culled;
+	}
+
+	uint32_t RenderStatistics::getCulled(const std::string& layer) const {
+		std::map<std::string, uint32_t>::const_iterator it = m_culled.find(layer);
+		return it != m_culled.end() ? it->second : 0;
+	}
+
+	std::string RenderStatistics::toJson() const {
+		std::ostringstream out;
+		out << '[';
+		std::vector<RenderStatistic>::const_iterator it = m_statistics.begin();
+		for (; it != m_statistics.end(); ++it) {
+			if (it != m_statistics.begin()) {
+				out << ", ";
+			}
+			out << "{\"layer\": ";
+			writeJsonString(out, it->layer);
+			out << ", \"renderer\": ";
+			writeJsonString(out, it->renderer);
+			out << ", \"milliseconds\": " << it->milliseconds
+				<< ", \"items\": " << it->items
+				<< ", \"culled\": " << it->culled
+				<< ", \"draw_calls\": " << it->counters.drawCalls
+				<< ", \"vertices\": " << it->counters.vertices
+				<< ", \"texture_binds\": " << it->counters.textureBinds
+				<< ", \"render_target_switches\": " << it->counters.renderTargetSwitches
+				<< ", \"flushes\": " << it->counters.flushes << '}';
+		}
+		out << ']';
+		return out.str();
+	}
+
+	void RenderStatistics::addStatistic(const RenderStatistic& statistic) {
+		std::vector<RenderStatistic>::iterator it = m_statistics.begin();
+		for (; it != m_statistics.end(); ++it) {
+			if (it->layer == statistic.layer && it->renderer == statistic.renderer) {
+				it->milliseconds += statistic.milliseconds;
+				it->items += statistic.items;
+				it->culled = statistic.culled;
+				it->counters += statistic.counters;
+				return;
+			}
+		}
+		m_statistics.push_back(statistic);
+	}
+
+	void RenderStatistics::clear() {
+		m_statistics.clear();
+		m_culled.clear();
+	}
+}
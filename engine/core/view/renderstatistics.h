@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VIEW_RENDERSTATISTICS_H
+#define FIFE_VIEW_RENDERSTATISTICS_H
+
+// Standard C++ library includes
+#include <map>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "video/renderbackend.h"
+
+namespace FIFE {
+
+	/** Measurements of one renderer on one layer during a camera render.
+	 */
+	struct RenderStatistic {
+		RenderStatistic();
+
+		//! id of the layer, empty for the camera overlay
+		std::string layer;
+		//! name of the renderer, "tiles" for the update of static layer tiles
+		std::string renderer;
+		//! wall clock time in milliseconds
+		double milliseconds;
+		//! number of render items passed to the renderer
+		uint32_t items;
+		//! number of layer instances that were not passed to the renderer, for the total
+		//! the instances of each layer that were not drawn, see RenderStatistics::setCulled
+		uint32_t culled;
+		//! work of the render backend
+		RenderCounters counters;
+	};
+
+	/** The measurements of one camera render, one entry per layer and renderer.
+	 */
+	class RenderStatistics {
+	public:
+		/** Returns the number of entries.
+		 */
+		uint32_t getStatisticCount() const;
+
+		/** Returns the entry with the given index.
+		 */
+		const RenderStatistic& getStatistic(uint32_t index) const;
+
+		/** Returns the sum of all entries. The culled instances are the sum of the
+		 * per layer values, see setCulled.
+		 */
+		RenderStatistic getTotal() const;
+
+		/** Sets the number of instances of the layer that were not drawn,
+		 * because they are outside of the viewport or occluded.
+		 */
+		void setCulled(const std::string& layer, uint32_t culled);
+
+		/** Returns the number of culled instances of the layer, 0 if none was set.
+		 */
+		uint32_t getCulled(const std::string& layer) const;
+
+		/** Returns the entries as json array of objects, one object per entry.
+		 */
+		std::string toJson() const;
+
+		/** Adds the values to the entry with the same layer and renderer,
+		 * appends a new entry if there is none.
+		 */
+		void addStatistic(const RenderStatistic& statistic);
+
+		/** Removes all entries and culled counts.
+		 */
+		void clear();
+
+	private:
+		std::vector<RenderStatistic> m_statistics;
+		std::map<std::string, uint32_t> m_culled;
+	};
+}
+
+#endif
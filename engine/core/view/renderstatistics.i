@@ -0,0 +1,45 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+%module fife
+%{
+#include "view/renderstatistics.h"
+%}
+
+namespace FIFE {
+	struct RenderStatistic {
+		std::string layer;
+		std::string renderer;
+		double milliseconds;
+		uint32_t items;
+		uint32_t culled;
+		RenderCounters counters;
+	};
+
+	class RenderStatistics {
+	public:
+		uint32_t getStatisticCount() const;
+		const RenderStatistic& getStatistic(uint32_t index) const;
+		RenderStatistic getTotal() const;
+		uint32_t getCulled(const std::string& layer) const;
+		std::string toJson() const;
+	};
+}
@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cmath>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "video/imagemanager.h"
+
+#include "rendertilecache.h"
+
+namespace FIFE {
+	RenderTileCache::RenderTileCache(uint32_t imageSize):
+		m_imageSize(imageSize),
+		m_tileSize(imageSize),
+		m_updates(0) {
+	}
+
+	RenderTileCache::~RenderTileCache() {
+		clear();
+	}
+
+	uint32_t RenderTileCache::getImageSize() const {
+		return m_imageSize;
+	}
+
+	void RenderTileCache::setTileSize(double size) {
+		if (size != m_tileSize) {
+			clear();
+			m_tileSize = size;
+		}
+	}
+
+	double RenderTileCache::getTileSize() const {
+		return m_tileSize;
+	}
+
+	void RenderTileCache::invalidate() {
+		for (TileMap::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it) {
+			it->second->dirty = true;
+		}
+	}
+
+	void RenderTileCache::invalidate(const Rect& area) {
+		if (m_tiles.empty() || area.w <= 0 || area.h <= 0) {
+			return;
+		}
+		int32_t x0, y0, x1, y1;
+		getTileRange(area, x0, y0, x1, y1);
+		if ((x1 - x0 + 1) * (y1 - y0 + 1) > static_cast<int32_t>(m_tiles.size())) {
+			for (TileMap::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it) {
+				Tile* tile = it->second;
+				if (tile->x >= x0 && tile->x <= x1 && tile->y >= y0 && tile->y <= y1) {
+					tile->dirty = true;
+				}
+			}
+			return;
+		}
+		for (int32_t y = y0; y <= y1; ++y) {
+			for (int32_t x = x0; x <= x1; ++x) {
+				TileMap::iterator it = m_tiles.find(std::make_pair(x, y));
+				if (it != m_tiles.end()) {
+					it->second->dirty = true;
+				}
+			}
+		}
+	}
+
+	const std::vector<RenderTileCache::Tile*>& RenderTileCache::update(const Rect& area) {
+		++m_updates;
+		m_visible.clear();
+		int32_t x0, y0, x1, y1;
+		getTileRange(area, x0, y0, x1, y1);
+		for (int32_t y = y0; y <= y1; ++y) {
+			for (int32_t x = x0; x <= x1; ++x) {
+				Tile*& tile = m_tiles[std::make_pair(x, y)];
+				if (!tile) {
+					tile = new Tile();
+					tile->x = x;
+					tile->y = y;
+					tile->image = ImageManager::instance()->loadBlank(m_imageSize, m_imageSize);
+					tile->dirty = true;
+				}
+				tile->lastUsed = m_updates;
+				m_visible.push_back(tile);
+			}
+		}
+
+		// removes the tiles that were not visible for a while
+		TileMap::iterator it = m_tiles.begin();
+		while (it != m_tiles.end()) {
+			Tile* tile = it->second;
+			if (m_updates - tile->lastUsed > TILE_KEEP_UPDATES) {
+				ImageManager::instance()->remove(tile->image);
+				delete tile;
+				m_tiles.erase(it++);
+			} else {
+				++it;
+			}
+		}
+		return m_visible;
+	}
+
+	const std::vector<RenderTileCache::Tile*>& RenderTileCache::getVisibleTiles() const {
+		return m_visible;
+	}
+
+	Rect RenderTileCache::getTileArea(const Tile& tile) const {
+		int32_t x = static_cast<int32_t>(std::floor(tile.x * m_tileSize));
+		int32_t y = static_cast<int32_t>(std::floor(tile.y * m_tileSize));
+		int32_t right = static_cast<int32_t>(std::ceil((tile.x + 1) * m_tileSize));
+		int32_t bottom = static_cast<int32_t>(std::ceil((tile.y + 1) * m_tileSize));
+		return Rect(x, y, right - x, bottom - y);
+	}
+
+	DoublePoint RenderTileCache::getTileOrigin(const Tile& tile) const {
+		return DoublePoint(tile.x * m_tileSize, tile.y * m_tileSize);
+	}
+
+	Point RenderTileCache::getScreenOrigin(const Tile& tile, const Point& base) const {
+		const int32_t size = static_cast<int32_t>(m_imageSize);
+		return Point(base.x + tile.x * size, base.y + tile.y * size);
+	}
+
+	void RenderTileCache::clear() {
+		for (TileMap::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it) {
+			ImageManager::instance()->remove(it->second->image);
+			delete it->second;
+		}
+		m_tiles.clear();
+		m_visible.clear();
+	}
+
+	void RenderTileCache::getTileRange(const Rect& area, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const {
+		x0 = static_cast<int32_t>(std::floor(area.x / m_tileSize));
+		y0 = static_cast<int32_t>(std::floor(area.y / m_tileSize));
+		x1 = static_cast<int32_t>(std::floor((area.x + area.w) / m_tileSize));
+		y1 = static_cast<int32_t>(std::floor((area.y + area.h) / m_tileSize));
+	}
+}
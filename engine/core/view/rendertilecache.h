@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VIEW_RENDERTILECACHE_H
+#define FIFE_VIEW_RENDERTILECACHE_H
+
+// Standard C++ library includes
+#include <map>
+#include <utility>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "video/image.h"
+
+namespace FIFE {
+
+	/** Render targets for fixed tiles in virtual screen space, used to cache static layers.
+	 *
+	 * A tile is only rendered again if it is dirty, panning the camera just composites
+	 * the visible tiles. Tiles that were not visible for a while are removed.
+	 */
+	class RenderTileCache {
+	public:
+		//! tiles that were not visible for this many updates are removed
+		static const uint32_t TILE_KEEP_UPDATES = 120;
+
+		struct Tile {
+			//! tile coordinates
+			int32_t x;
+			int32_t y;
+			//! render target of the tile
+			ImagePtr image;
+			//! content has to be rendered again
+			bool dirty;
+			//! last update in which the tile was visible
+			uint32_t lastUsed;
+		};
+
+		/** Constructor
+		 * @param imageSize Width and height of the tile images in screen pixels.
+		 */
+		RenderTileCache(uint32_t imageSize = 256);
+		~RenderTileCache();
+
+		/** Returns the width and height of the tile images in screen pixels.
+		 */
+		uint32_t getImageSize() const;
+
+		/** Sets the tile size in virtual screen pixels, e.g. image size divided by zoom.
+		 * All tiles are removed if it changed.
+		 */
+		void setTileSize(double size);
+
+		/** Returns the tile size in virtual screen pixels.
+		 */
+		double getTileSize() const;
+
+		/** Marks all tiles as dirty.
+		 */
+		void invalidate();
+
+		/** Marks the tiles that intersect the virtual screen area as dirty.
+		 */
+		void invalidate(const Rect& area);
+
+		/** Collects the tiles that intersect the virtual screen area, missing tiles are created as dirty.
+		 * Tiles that were not visible for a while are removed.
+		 * @return The visible tiles.
+		 */
+		const std::vector<Tile*>& update(const Rect& area);
+
+		/** Returns the tiles of the last update.
+		 */
+		const std::vector<Tile*>& getVisibleTiles() const;
+
+		/** Returns the virtual screen area of the tile.
+		 */
+		Rect getTileArea(const Tile& tile) const;
+
+		/** Returns the virtual screen position of the tile's top left corner.
+		 */
+		DoublePoint getTileOrigin(const Tile& tile) const;
+
+		/** Returns the screen position of the tile's top left corner.
+		 * Virtual screen to screen only scales by the zoom, so the tiles are exactly image size apart.
+		 * @param base Screen position of the virtual screen origin.
+		 */
+		Point getScreenOrigin(const Tile& tile, const Point& base) const;
+
+		/** Removes all tiles.
+		 */
+		void clear();
+
+	private:
+		typedef std::map<std::pair<int32_t, int32_t>, Tile*> TileMap;
+
+		void getTileRange(const Rect& area, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const;
+
+		//! size of the tile images in screen pixels
+		uint32_t m_imageSize;
+		//! size of a tile in virtual screen pixels
+		double m_tileSize;
+		//! all tiles by their coordinates
+		TileMap m_tiles;
+		//! tiles of the last update
+		std::vector<Tile*> m_visible;
+		//! number of updates
+		uint32_t m_updates;
+	};
+}
+
+#endif
@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <cstring>
 
 // 3rd party library includes
 
@@ -43,15 +44,21 @@ namespace FIFE {
 	 */
 	static Logger _log(LM_VIEW);
 
-	OverlayColors::OverlayColors() {
+	OverlayColors::OverlayColors():
+		m_lookupShift(0),
+		m_compiled(false) {
 	}
 
 	OverlayColors::OverlayColors(ImagePtr image):
-		m_image(image) {
+		m_image(image),
+		m_lookupShift(0),
+		m_compiled(false) {
 	}
 	
 	OverlayColors::OverlayColors(AnimationPtr animation):
-		m_animation(animation) {
+		m_animation(animation),
+		m_lookupShift(0),
+		m_compiled(false) {
 	}
 
 	OverlayColors::~OverlayColors() {
@@ -73,7 +80,12 @@ namespace FIFE {
 		return m_animation;
 	}
 
+	Animation* OverlayColors::findColorOverlayAnimation() const {
+		return m_animation.get();
+	}
+
 	void OverlayColors::changeColor(const Color& source, const Color& target) {
+		m_compiled = false;
 		std::pair<std::map<Color, Color>::iterator, bool> inserter = m_colorMap.insert(std::make_pair(source, target));
 		if (!inserter.second) {
 			Color& c = inserter.first->second;
@@ -87,6 +99,91 @@ namespace FIFE {
 
 	void OverlayColors::resetColors() {
 		m_colorMap.clear();
+		m_compiled = false;
+	}
+
+	/** Packs the color as R, G, B, A bytes, the layout of the RGBA surfaces.
+	 */
+	static uint32_t packColor(const Color& color) {
+		const uint8_t bytes[4] = { color.getR(), color.getG(), color.getB(), color.getAlpha() };
+		uint32_t packed;
+		memcpy(&packed, bytes, sizeof(packed));
+		return packed;
+	}
+
+	static uint32_t hashColor(uint32_t color, uint32_t shift) {
+		return (color * 2654435761U) >> shift;
+	}
+
+	void OverlayColors::compile() {
+		m_packedColors.clear();
+		m_packedColors.reserve(m_colorMap.size() * 2);
+		std::map<Color, Color>::const_iterator it = m_colorMap.begin();
+		for (; it != m_colorMap.end(); ++it) {
+			m_packedColors.push_back(packColor(it->first));
+			m_packedColors.push_back(packColor(it->second));
+		}
+
+		// at most a quarter of the slots is used, that keeps the probe sequences short
+		uint32_t bits = 4;
+		while ((1U << bits) < m_colorMap.size() * 4) {
+			++bits;
+		}
+		m_lookupShift = 32 - bits;
+		m_lookup.assign(1U << bits, -1);
+		const uint32_t mask = (1U << bits) - 1;
+		for (uint32_t i = 0; i < m_packedColors.size(); i += 2) {
+			uint32_t slot = hashColor(m_packedColors[i], m_lookupShift);
+			while (m_lookup[slot] != -1) {
+				slot = (slot + 1) & mask;
+			}
+			m_lookup[slot] = static_cast<int32_t>(i);
+		}
+		m_compiled = true;
+	}
+
+	const std::vector<uint32_t>& OverlayColors::getPackedColors() {
+		if (!m_compiled) {
+			compile();
+		}
+		return m_packedColors;
+	}
+
+	void OverlayColors::recolor(SDL_Surface* surface) {
+		if (!m_compiled) {
+			compile();
+		}
+		if (m_packedColors.empty()) {
+			return;
+		}
+		const uint32_t mask = static_cast<uint32_t>(m_lookup.size()) - 1;
+		// sprites have long runs of the same color, so the last result is reused
+		uint32_t lastSource = 0;
+		uint32_t lastTarget = 0;
+		bool lastValid = false;
+		for (int32_t y = 0; y < surface->h; ++y) {
+			uint8_t* row = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch;
+			for (int32_t x = 0; x < surface->w; ++x) {
+				uint32_t pixel;
+				memcpy(&pixel, row + x * 4, sizeof(pixel));
+				if (!lastValid || pixel != lastSource) {
+					lastSource = pixel;
+					lastTarget = pixel;
+					uint32_t slot = hashColor(pixel, m_lookupShift);
+					while (m_lookup[slot] != -1) {
+						if (m_packedColors[m_lookup[slot]] == pixel) {
+							lastTarget = m_packedColors[m_lookup[slot] + 1];
+							break;
+						}
+						slot = (slot + 1) & mask;
+					}
+					lastValid = true;
+				}
+				if (lastTarget != pixel) {
+					memcpy(row + x * 4, &lastTarget, sizeof(lastTarget));
+				}
+			}
+		}
 	}
 
 	Visual2DGfx::Visual2DGfx() {
@@ -244,7 +341,20 @@ namespace FIFE {
 
 	AnimationPtr ActionVisual::getAnimationByAngle(int32_t angle) {
 		int32_t closestMatch = 0;
-		return m_animation_map[getIndexByAngle(angle, m_map, closestMatch)];
+		AngleAnimationMap::const_iterator it = m_animation_map.find(getIndexByAngle(angle, m_map, closestMatch));
+		if (it == m_animation_map.end()) {
+			return AnimationPtr();
+		}
+		return it->second;
+	}
+
+	Animation* ActionVisual::findAnimationByAngle(int32_t angle) const {
+		int32_t closestMatch = 0;
+		AngleAnimationMap::const_iterator it = m_animation_map.find(getIndexByAngle(angle, m_map, closestMatch));
+		if (it == m_animation_map.end()) {
+			return NULL;
+		}
+		return it->second.get();
 	}
 
 	void ActionVisual::addAnimationOverlay(uint32_t angle, int32_t order, AnimationPtr animationptr) {
@@ -255,7 +365,20 @@ namespace FIFE {
 
 	std::map<int32_t, AnimationPtr> ActionVisual::getAnimationOverlay(int32_t angle) {
 		int32_t closestMatch = 0;
-		return m_animationOverlayMap[getIndexByAngle(angle, m_map, closestMatch)];
+		AngleAnimationOverlayMap::const_iterator it = m_animationOverlayMap.find(getIndexByAngle(angle, m_map, closestMatch));
+		if (it == m_animationOverlayMap.end()) {
+			return std::map<int32_t, AnimationPtr>();
+		}
+		return it->second;
+	}
+
+	const std::map<int32_t, AnimationPtr>* ActionVisual::findAnimationOverlay(int32_t angle) const {
+		int32_t closestMatch = 0;
+		AngleAnimationOverlayMap::const_iterator it = m_animationOverlayMap.find(getIndexByAngle(angle, m_map, closestMatch));
+		if (it == m_animationOverlayMap.end()) {
+			return NULL;
+		}
+		return &it->second;
 	}
 
 	void ActionVisual::removeAnimationOverlay(uint32_t angle, int32_t order) {
@@ -293,11 +416,11 @@ namespace FIFE {
 			return 0;
 		}
 		int32_t closestMatch = 0;
-		int32_t index = getIndexByAngle(angle, m_map, closestMatch);
-		if (m_colorOverlayMap.find(index) == m_colorOverlayMap.end()) {
+		AngleColorOverlayMap::iterator it = m_colorOverlayMap.find(getIndexByAngle(angle, m_map, closestMatch));
+		if (it == m_colorOverlayMap.end()) {
 			return 0;
 		}
-		return &m_colorOverlayMap[getIndexByAngle(angle, m_map, closestMatch)];
+		return &it->second;
 	}
 
 	void ActionVisual::removeColorOverlay(int32_t angle) {
@@ -336,7 +459,7 @@ namespace FIFE {
 		if (it != m_colorAnimationOverlayMap.end()) {
 			std::map<int32_t, OverlayColors>::iterator sit = it->second.find(order);
 			if (sit != it->second.end()) {
-				return &it->second[order];
+				return &sit->second;
 			}
 		}
 		return 0;
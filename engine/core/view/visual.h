@@ -23,6 +23,8 @@
 #define FIFE_VIEW_VISUAL_H
 
 // Standard C++ library includes
+#include <map>
+#include <vector>
 
 // 3rd party library includes
 
@@ -59,14 +61,41 @@ namespace FIFE {
 		ImagePtr getColorOverlayImage();
 		void setColorOverlayAnimation(AnimationPtr animation);
 		AnimationPtr getColorOverlayAnimation();
+
+		/** Returns the animation without taking a reference, can be called from worker threads.
+		 */
+		Animation* findColorOverlayAnimation() const;
+
 		void changeColor(const Color& source, const Color& target);
 		const std::map<Color, Color>& getColors();
 		void resetColors();
 
+		/** Replaces the mapped colors in the surface.
+		 * The surface has to be a 32 bit surface with R, G, B, A bytes, see Image::createRGBASurface().
+		 */
+		void recolor(SDL_Surface* surface);
+
+		/** Returns the source and target colors as pairs of packed R, G, B, A bytes.
+		 * The pairs are sorted like the color map, so equal overlays return equal vectors.
+		 */
+		const std::vector<uint32_t>& getPackedColors();
+
 	private:
+		/** Builds the lookup table from the color map.
+		 */
+		void compile();
+
 		std::map<Color, Color> m_colorMap;
 		ImagePtr m_image;
 		AnimationPtr m_animation;
+		// packed source and target colors, pairwise
+		std::vector<uint32_t> m_packedColors;
+		// open addressing hash table, index of the color pair or -1 for free slots
+		std::vector<int32_t> m_lookup;
+		// shift of the multiplicative hash
+		uint32_t m_lookupShift;
+		// lookup table matches the color map
+		bool m_compiled;
 	};
 
 	/** Base class for all 2 dimensional visual classes
@@ -228,6 +257,12 @@ namespace FIFE {
 		 */
 		AnimationPtr getAnimationByAngle(int32_t angle);
 
+		/** Gets the animation closest to given angle without taking a reference,
+		 * can be called from worker threads.
+		 * @return animation, 0 if no animations available
+		 */
+		Animation* findAnimationByAngle(int32_t angle) const;
+
 		/** Adds new animation overlay with given angle (degrees) and order
 		 */
 		void addAnimationOverlay(uint32_t angle, int32_t order, AnimationPtr animationptr);
@@ -237,6 +272,12 @@ namespace FIFE {
 		 */
 		std::map<int32_t, AnimationPtr> getAnimationOverlay(int32_t angle);
 
+		/** Gets the map with animations closest to given angle without copying it,
+		 * can be called from worker threads.
+		 * @return animation map, 0 if no animation overlay available
+		 */
+		const std::map<int32_t, AnimationPtr>* findAnimationOverlay(int32_t angle) const;
+
 		/** Removes animation overlay with given angle (degrees) and order
 		 */
 		void removeAnimationOverlay(uint32_t angle, int32_t order);
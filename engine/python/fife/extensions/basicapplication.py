@@ -117,6 +117,7 @@ class ApplicationBase(object):
 		engineSetting.setGLCompressImages(self._finalSetting['GLCompressImages'])
 		engineSetting.setGLUseFramebuffer(self._finalSetting['GLUseFramebuffer'])
 		engineSetting.setGLUseNPOT(self._finalSetting['GLUseNPOT'])
+		engineSetting.setGLUseVertexBuffers(self._finalSetting['GLUseVertexBuffers'])
 		engineSetting.setGLUseMipmapping(self._finalSetting['GLUseMipmapping'])
 		engineSetting.setGLUseMonochrome(self._finalSetting['GLUseMonochrome'])
 		engineSetting.setGLUseDepthBuffer(self._finalSetting['GLUseDepthBuffer'])
@@ -0,0 +1,182 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "video/alphamask.h"
+
+using namespace FIFE;
+
+// transparent 32 bit surface
+static SDL_Surface* createSurface(int32_t width, int32_t height) {
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, RMASK, GMASK, BMASK, AMASK);
+	SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, 0, 0, 0, 0));
+	return surface;
+}
+
+static void setAlpha(SDL_Surface* surface, int32_t x, int32_t y, uint8_t alpha) {
+	SDL_Rect rect;
+	rect.x = x;
+	rect.y = y;
+	rect.w = 1;
+	rect.h = 1;
+	SDL_FillRect(surface, &rect, SDL_MapRGBA(surface->format, 255, 255, 255, alpha));
+}
+
+TEST(alphamask_word_boundaries) {
+	// three words per row, the last one is partial
+	SDL_Surface* surface = createSurface(70, 3);
+	setAlpha(surface, 31, 0, 255);
+	setAlpha(surface, 32, 0, 255);
+	setAlpha(surface, 63, 0, 255);
+	setAlpha(surface, 64, 0, 255);
+	setAlpha(surface, 69, 0, 255);
+	// only in the middle word
+	setAlpha(surface, 40, 1, 255);
+	// first bit of a row
+	setAlpha(surface, 0, 2, 255);
+
+	AlphaMask mask;
+	mask.create(surface, Rect(0, 0, 70, 3), 1);
+	CHECK_EQUAL(70, mask.getWidth());
+	CHECK_EQUAL(3, mask.getHeight());
+	CHECK_EQUAL(static_cast<size_t>(3 * 3 * 4), mask.getSize());
+
+	CHECK(!mask.isSet(30, 0));
+	CHECK(mask.isSet(31, 0));
+	CHECK(mask.isSet(32, 0));
+	CHECK(!mask.isSet(33, 0));
+	CHECK(!mask.isSet(62, 0));
+	CHECK(mask.isSet(63, 0));
+	CHECK(mask.isSet(64, 0));
+	CHECK(!mask.isSet(65, 0));
+	CHECK(mask.isSet(69, 0));
+	CHECK(mask.isSet(40, 1));
+	CHECK(!mask.isSet(31, 1));
+	CHECK(mask.isSet(0, 2));
+	CHECK(!mask.isSet(69, 2));
+
+	// pixels outside of the mask are not set
+	CHECK(!mask.isSet(-1, 0));
+	CHECK(!mask.isSet(70, 0));
+	CHECK(!mask.isSet(0, 3));
+	CHECK(!mask.isSet(0, -1));
+
+	// one word
+	CHECK(!mask.isAnySet(Rect(0, 0, 31, 1)));
+	CHECK(mask.isAnySet(Rect(0, 0, 32, 1)));
+	CHECK(mask.isAnySet(Rect(31, 0, 1, 1)));
+	CHECK(!mask.isAnySet(Rect(33, 0, 30, 1)));
+	CHECK(!mask.isAnySet(Rect(65, 0, 4, 1)));
+	// first and last word
+	CHECK(mask.isAnySet(Rect(33, 0, 31, 1)));
+	CHECK(mask.isAnySet(Rect(20, 0, 12, 1)));
+	CHECK(mask.isAnySet(Rect(20, 0, 45, 1)));
+	CHECK(!mask.isAnySet(Rect(1, 1, 39, 1)));
+	// set bit only in a word between the first and the last
+	CHECK(mask.isAnySet(Rect(1, 1, 69, 1)));
+	CHECK(!mask.isAnySet(Rect(41, 1, 29, 2)));
+	// clipped to the mask
+	CHECK(mask.isAnySet(Rect(-10, 2, 11, 10)));
+	CHECK(mask.isAnySet(Rect(69, -10, 100, 11)));
+	CHECK(!mask.isAnySet(Rect(70, 0, 10, 3)));
+	CHECK(!mask.isAnySet(Rect(0, 3, 70, 10)));
+	CHECK(!mask.isAnySet(Rect(0, 0, 0, 3)));
+
+	mask.clear();
+	CHECK_EQUAL(0, mask.getWidth());
+	CHECK_EQUAL(static_cast<size_t>(0), mask.getSize());
+	CHECK(!mask.isSet(31, 0));
+	CHECK(!mask.isAnySet(Rect(0, 0, 70, 3)));
+	SDL_FreeSurface(surface);
+}
+
+TEST(alphamask_threshold) {
+	SDL_Surface* surface = createSurface(4, 1);
+	setAlpha(surface, 0, 0, 1);
+	setAlpha(surface, 1, 0, 127);
+	setAlpha(surface, 2, 0, 128);
+	setAlpha(surface, 3, 0, 255);
+
+	AlphaMask mask;
+	mask.create(surface, Rect(0, 0, 4, 1), 128);
+	CHECK_EQUAL(128, mask.getThreshold());
+	CHECK(!mask.isSet(0, 0));
+	CHECK(!mask.isSet(1, 0));
+	CHECK(mask.isSet(2, 0));
+	CHECK(mask.isSet(3, 0));
+
+	// a threshold of 0 would set transparent pixels
+	mask.create(surface, Rect(0, 0, 4, 1), 0);
+	CHECK_EQUAL(1, mask.getThreshold());
+	CHECK(mask.isSet(0, 0));
+	SDL_FreeSurface(surface);
+}
+
+TEST(alphamask_area) {
+	SDL_Surface* surface = createSurface(64, 16);
+	setAlpha(surface, 16, 8, 255);
+	setAlpha(surface, 55, 11, 255);
+	setAlpha(surface, 0, 0, 255);
+
+	// subimage of an atlas
+	AlphaMask mask;
+	mask.create(surface, Rect(16, 8, 40, 4), 1);
+	CHECK_EQUAL(40, mask.getWidth());
+	CHECK_EQUAL(4, mask.getHeight());
+	CHECK(mask.isSet(0, 0));
+	CHECK(mask.isSet(39, 3));
+	CHECK(!mask.isSet(1, 0));
+	CHECK(!mask.isAnySet(Rect(1, 0, 38, 4)));
+
+	// overlaps the surface, the pixels outside are not set
+	mask.create(surface, Rect(-4, -4, 8, 8), 1);
+	CHECK_EQUAL(8, mask.getWidth());
+	CHECK(mask.isSet(4, 4));
+	CHECK(!mask.isAnySet(Rect(0, 0, 8, 4)));
+	CHECK(!mask.isAnySet(Rect(0, 0, 4, 8)));
+
+	// completely outside
+	mask.create(surface, Rect(64, 0, 8, 8), 1);
+	CHECK_EQUAL(0, mask.getWidth());
+	CHECK(!mask.isSet(0, 0));
+
+	// no surface
+	mask.create(NULL, Rect(0, 0, 8, 8), 1);
+	CHECK_EQUAL(0, mask.getWidth());
+	SDL_FreeSurface(surface);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,225 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/quadtree.h"
+#include "util/structures/rect.h"
+#include "view/cachegrid.h"
+
+using namespace FIFE;
+
+typedef QuadTree<std::set<int32_t> > CacheTree;
+
+// the quadtree index of the LayerCache
+struct TreeIndex {
+	CacheTree tree;
+	std::vector<CacheTree::Node*> nodes;
+
+	void update(int32_t index, const Rect& bbox) {
+		if (static_cast<int32_t>(nodes.size()) <= index) {
+			nodes.resize(index + 1, 0);
+		}
+		CacheTree::Node* node = tree.find_container(bbox);
+		if (node && node != nodes[index]) {
+			if (nodes[index]) {
+				nodes[index]->data().erase(index);
+			}
+			nodes[index] = node;
+			node->data().insert(index);
+		}
+	}
+};
+
+class TreeCollector {
+public:
+	TreeCollector(std::vector<int32_t>& indices, const Rect& viewport): m_indices(indices), m_viewport(viewport) {
+	}
+	bool visit(CacheTree::Node* node, int32_t d = -1) {
+		if (!m_viewport.intersects(Rect(node->x(), node->y(), node->size(), node->size()))) {
+			return false;
+		}
+		m_indices.insert(m_indices.end(), node->data().begin(), node->data().end());
+		return true;
+	}
+private:
+	std::vector<int32_t>& m_indices;
+	Rect m_viewport;
+};
+
+static void collectTree(TreeIndex& index, const Rect& viewport, std::vector<int32_t>& indices) {
+	CacheTree::Node* node = index.tree.find_container(viewport);
+	TreeCollector collector(indices, viewport);
+	node->apply_visitor(collector);
+	node = node->parent();
+	while (node) {
+		collector.visit(node);
+		node = node->parent();
+	}
+}
+
+static std::vector<Rect> createBoxes(uint32_t count, int32_t extent) {
+	std::vector<Rect> boxes;
+	for (uint32_t i = 0; i < count; ++i) {
+		int32_t size = (i % 100 == 0) ? 300 : 32 + rand() % 64;
+		boxes.push_back(Rect(rand() % extent - extent / 2, rand() % extent - extent / 2, size, size));
+	}
+	return boxes;
+}
+
+static void moveBoxes(std::vector<Rect>& boxes, std::vector<int32_t>& moved, uint32_t count) {
+	moved.clear();
+	for (uint32_t i = 0; i < count; ++i) {
+		int32_t index = rand() % boxes.size();
+		boxes[index].x += rand() % 9 - 4;
+		boxes[index].y += rand() % 9 - 4;
+		moved.push_back(index);
+	}
+}
+
+static std::vector<int32_t> filter(const std::vector<Rect>& boxes, std::vector<int32_t> indices, const Rect& viewport) {
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+	std::vector<int32_t> visible;
+	for (uint32_t i = 0; i < indices.size(); ++i) {
+		if (boxes[indices[i]].intersects(viewport)) {
+			visible.push_back(indices[i]);
+		}
+	}
+	return visible;
+}
+
+// scrolled and zoomed viewport of the given frame
+static Rect getViewport(int32_t frame) {
+	int32_t zoom = 1 + frame % 4;
+	return Rect(frame * 37 - 4000, frame * 23 - 3000, 1024 * zoom, 768 * zoom);
+}
+
+TEST(cache_grid_collect) {
+	std::vector<Rect> boxes = createBoxes(5000, 8000);
+	// items far outside of the maximal grid are stored in the border buckets
+	boxes.push_back(Rect(CacheGrid::MAX_SIZE * 128 * 4, 0, 10, 10));
+	CacheGrid grid;
+	for (uint32_t i = 0; i < boxes.size(); ++i) {
+		grid.update(i, boxes[i]);
+	}
+	std::vector<int32_t> moved;
+	for (int32_t frame = 0; frame < 50; ++frame) {
+		moveBoxes(boxes, moved, 200);
+		for (uint32_t i = 0; i < moved.size(); ++i) {
+			grid.update(moved[i], boxes[moved[i]]);
+		}
+		if (frame == 25) {
+			grid.remove(7);
+			boxes[7] = Rect(0, 0, 0, 0);
+		}
+		Rect viewport = getViewport(frame);
+		std::vector<int32_t> all;
+		for (uint32_t i = 0; i < boxes.size(); ++i) {
+			all.push_back(i);
+		}
+		std::vector<int32_t> candidates;
+		grid.collect(viewport, candidates);
+		CHECK(filter(boxes, all, viewport) == filter(boxes, candidates, viewport));
+	}
+	{
+		std::vector<int32_t> candidates;
+		grid.collect(Rect(CacheGrid::MAX_SIZE * 128 * 4, 0, 100, 100), candidates);
+		CHECK(std::find(candidates.begin(), candidates.end(), static_cast<int32_t>(boxes.size() - 1)) != candidates.end());
+	}
+}
+
+TEST(cache_grid_benchmark) {
+	const int32_t frames = 200;
+	std::vector<Rect> boxes = createBoxes(50000, 20000);
+	std::vector<std::vector<int32_t> > moves(frames);
+	std::vector<Rect> treeBoxes(boxes);
+	std::vector<Rect> gridBoxes(boxes);
+
+	TreeIndex tree;
+	CacheGrid grid;
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < boxes.size(); ++i) {
+		tree.update(i, boxes[i]);
+	}
+	std::chrono::high_resolution_clock::time_point middle = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < boxes.size(); ++i) {
+		grid.update(i, boxes[i]);
+	}
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+	std::cout << "insert " << boxes.size() << " items: quadtree "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count() << " us, grid "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() << " us" << std::endl;
+
+	// the same moves for both indices
+	for (int32_t frame = 0; frame < frames; ++frame) {
+		moveBoxes(boxes, moves[frame], 1000);
+	}
+
+	int64_t treeTime = 0;
+	int64_t gridTime = 0;
+	for (int32_t frame = 0; frame < frames; ++frame) {
+		Rect viewport = getViewport(frame);
+		std::vector<int32_t> treeIndices;
+		std::vector<int32_t> gridIndices;
+
+		start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < moves[frame].size(); ++i) {
+			int32_t index = moves[frame][i];
+			treeBoxes[index] = boxes[index];
+			tree.update(index, treeBoxes[index]);
+		}
+		collectTree(tree, viewport, treeIndices);
+		middle = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < moves[frame].size(); ++i) {
+			int32_t index = moves[frame][i];
+			gridBoxes[index] = boxes[index];
+			grid.update(index, gridBoxes[index]);
+		}
+		grid.collect(viewport, gridIndices);
+		end = std::chrono::high_resolution_clock::now();
+
+		treeTime += std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count();
+		gridTime += std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count();
+		CHECK(filter(treeBoxes, treeIndices, viewport) == filter(gridBoxes, gridIndices, viewport));
+	}
+	std::cout << frames << " scrolled and zoomed frames: quadtree " << treeTime << " us, grid " << gridTime << " us" << std::endl;
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,253 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "util/time/timemanager.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/hexgrid.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+
+using namespace FIFE;
+
+// the rects of the cellcache hold the min and max coordinates
+static void checkCells(CellCache* cache, const Rect& size) {
+	CHECK_EQUAL(static_cast<uint32_t>(size.w - size.x + 1), cache->getWidth());
+	CHECK_EQUAL(static_cast<uint32_t>(size.h - size.y + 1), cache->getHeight());
+	for (int32_t y = size.y; y <= size.h; ++y) {
+		for (int32_t x = size.x; x <= size.w; ++x) {
+			ModelCoordinate mc(x, y);
+			Cell* cell = cache->getCell(mc);
+			CHECK(cell != 0);
+			if (!cell) {
+				continue;
+			}
+			CHECK(cell->getLayerCoordinates() == mc);
+			// neighbors must be cells of the current size
+			CellNeighbors neighbors = cell->getNeighbors();
+			for (CellNeighbors::iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
+				CHECK(cache->getCell((*it)->getLayerCoordinates()) == *it);
+			}
+		}
+	}
+}
+
+struct CellCacheEnvironment {
+	CellCacheEnvironment():
+		map("map", 0, std::vector<RendererBase*>()) {
+		layer = map.createLayer("layer", &grid);
+		layer->setWalkable(true);
+		layer->createCellCache();
+		cache = layer->getCellCache();
+		cache->createCells(0);
+	}
+
+	// the map needs the time
+	TimeManager timeManager;
+	SquareGrid grid;
+	Map map;
+	Layer* layer;
+	CellCache* cache;
+};
+
+TEST(cellcache_grow_shrink) {
+	CellCacheEnvironment env;
+	Rect small(0, 0, 3, 3);
+	Rect large(-2, -2, 5, 5);
+	env.cache->resize(small);
+	checkCells(env.cache, small);
+
+	// the cells of the grown part are freed again by the shrink
+	for (int32_t i = 0; i < 3; ++i) {
+		env.cache->resize(large);
+		checkCells(env.cache, large);
+		env.cache->resize(small);
+		checkCells(env.cache, small);
+	}
+}
+
+TEST(cellcache_shrink_grow) {
+	CellCacheEnvironment env;
+	Rect large(0, 0, 7, 7);
+	Rect small(2, 2, 4, 4);
+	env.cache->resize(large);
+	env.cache->resize(small);
+	checkCells(env.cache, small);
+	env.cache->resize(large);
+	checkCells(env.cache, large);
+	env.cache->resize(small);
+	checkCells(env.cache, small);
+}
+
+TEST(cellcache_disjoint_resize) {
+	CellCacheEnvironment env;
+	Rect first(0, 0, 3, 3);
+	Rect second(10, 10, 12, 14);
+	Rect third(-8, 20, -5, 22);
+	// no cell survives, every resize replaces all arenas
+	env.cache->resize(first);
+	env.cache->resize(second);
+	checkCells(env.cache, second);
+	env.cache->resize(third);
+	checkCells(env.cache, third);
+	env.cache->resize(first);
+	checkCells(env.cache, first);
+}
+
+// the grid neighbors of a cell follow the order of CellGrid::getAccessibleCoordinates
+static void checkNeighborOrder(CellGrid* grid, CellCache* cache, const ModelCoordinate& mc) {
+	std::vector<ModelCoordinate> coordinates;
+	grid->getAccessibleCoordinates(mc, coordinates);
+	std::vector<Cell*> expected;
+	for (std::vector<ModelCoordinate>::iterator it = coordinates.begin(); it != coordinates.end(); ++it) {
+		Cell* cell = cache->getCell(*it);
+		if (cell && !(*it == mc)) {
+			expected.push_back(cell);
+		}
+	}
+	CellNeighbors neighbors = cache->getCell(mc)->getNeighbors();
+	CHECK_EQUAL(static_cast<uint32_t>(expected.size()), neighbors.size());
+	for (uint32_t i = 0; i < neighbors.size() && i < expected.size(); ++i) {
+		CHECK(neighbors[i] == expected[i]);
+		CHECK(cache->getCell(mc)->isNeighbor(neighbors[i]));
+	}
+}
+
+TEST(cell_neighbor_order) {
+	CellCacheEnvironment env;
+	env.cache->resize(Rect(0, 0, 4, 4));
+	checkNeighborOrder(&env.grid, env.cache, ModelCoordinate(2, 2));
+	CHECK_EQUAL(4u, env.cache->getCell(ModelCoordinate(2, 2))->getNeighbors().size());
+
+	// all eight bits are used with diagonals
+	env.grid.setAllowDiagonals(true);
+	env.cache->resize(Rect(0, 0, 5, 5));
+	checkNeighborOrder(&env.grid, env.cache, ModelCoordinate(2, 2));
+	CHECK_EQUAL(8u, env.cache->getCell(ModelCoordinate(2, 2))->getNeighbors().size());
+	// borders have fewer neighbors
+	checkNeighborOrder(&env.grid, env.cache, ModelCoordinate(0, 0));
+	checkNeighborOrder(&env.grid, env.cache, ModelCoordinate(5, 2));
+	CHECK_EQUAL(3u, env.cache->getCell(ModelCoordinate(0, 0))->getNeighbors().size());
+
+	// on even and odd rows of a hex grid
+	HexGrid hexGrid;
+	Layer* hexLayer = env.map.createLayer("hex", &hexGrid);
+	hexLayer->setWalkable(true);
+	hexLayer->createCellCache();
+	CellCache* hexCache = hexLayer->getCellCache();
+	hexCache->createCells(0);
+	hexCache->resize(Rect(0, 0, 4, 4));
+	checkNeighborOrder(&hexGrid, hexCache, ModelCoordinate(2, 2));
+	checkNeighborOrder(&hexGrid, hexCache, ModelCoordinate(2, 1));
+	CHECK_EQUAL(6u, hexCache->getCell(ModelCoordinate(2, 1))->getNeighbors().size());
+}
+
+TEST(cell_transition_neighbor) {
+	CellCacheEnvironment env;
+	env.grid.setAllowDiagonals(true);
+	env.cache->resize(Rect(0, 0, 4, 4));
+	Cell* cell = env.cache->getCell(ModelCoordinate(2, 2));
+	Cell* target = env.cache->getCell(ModelCoordinate(4, 4));
+	cell->createTransition(env.layer, ModelCoordinate(4, 4));
+
+	// the transition cell comes first, followed by the grid neighbors
+	CellNeighbors neighbors = cell->getNeighbors();
+	CHECK_EQUAL(9u, neighbors.size());
+	CHECK(neighbors.front() == target);
+	CHECK(neighbors.back() == env.cache->getCell(ModelCoordinate(3, 3)));
+	CHECK(cell->isNeighbor(target));
+
+	// the same order after the neighbors were rebuilt
+	env.cache->resize(Rect(0, 0, 5, 5));
+	neighbors = cell->getNeighbors();
+	CHECK_EQUAL(9u, neighbors.size());
+	CHECK(neighbors.front() == target);
+
+	cell->deleteTransition();
+	CHECK_EQUAL(8u, cell->getNeighbors().size());
+	CHECK(!cell->isNeighbor(target));
+	CHECK(cell->getTransition() == 0);
+}
+
+// removes itself and lets the cell release its side data while it is called
+class SelfRemovingListener : public CellChangeListener {
+public:
+	SelfRemovingListener(): calls(0) {}
+
+	virtual void onInstanceEnteredCell(Cell* cell, Instance* instance) {
+		++calls;
+		cell->removeChangeListener(this);
+		cell->updateCellInfo();
+	}
+	virtual void onInstanceExitedCell(Cell* cell, Instance* instance) {
+		++calls;
+	}
+	virtual void onBlockingChangedCell(Cell* cell, CellTypeInfo type, bool blocks) {
+	}
+
+	int32_t calls;
+};
+
+TEST(cell_listener_removed_while_called) {
+	CellCacheEnvironment env;
+	env.cache->resize(Rect(0, 0, 2, 2));
+	Object object("object", "test_nspace");
+	Instance instance(&object, Location(env.layer));
+	Cell* cell = env.cache->getCell(ModelCoordinate(1, 1));
+
+	SelfRemovingListener first;
+	SelfRemovingListener second;
+	cell->addChangeListener(&first);
+	cell->addChangeListener(&second);
+	cell->addInstance(&instance);
+	// both are called once, the loop keeps running after the first removed itself
+	CHECK_EQUAL(1, first.calls);
+	CHECK_EQUAL(1, second.calls);
+
+	// the removed listeners are not called again, also after the side data was released
+	cell->removeInstance(&instance);
+	cell->updateCellInfo();
+	cell->addInstance(&instance);
+	cell->removeInstance(&instance);
+	CHECK_EQUAL(1, first.calls);
+	CHECK_EQUAL(1, second.calls);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
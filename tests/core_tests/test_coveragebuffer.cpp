@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "view/coveragebuffer.h"
+
+using namespace FIFE;
+
+TEST(coveragebuffer_empty) {
+	CoverageBuffer buffer(16);
+	buffer.reset(Rect(0, 0, 64, 64));
+	CHECK(!buffer.isCovered(Rect(0, 0, 16, 16)));
+	CHECK(!buffer.isCovered(Rect(0, 0, 0, 0)));
+
+	// empty rectangles neither cover nor are covered
+	buffer.cover(Rect(0, 0, 0, 64));
+	buffer.cover(Rect(0, 0, 64, -1));
+	CHECK(!buffer.isCovered(Rect(0, 0, 1, 1)));
+	buffer.cover(Rect(0, 0, 64, 64));
+	CHECK(!buffer.isCovered(Rect(8, 8, 0, 8)));
+}
+
+TEST(coveragebuffer_inward_rounding) {
+	CoverageBuffer buffer(16);
+	buffer.reset(Rect(0, 0, 64, 64));
+
+	// only cells 1 and 2 are completely inside
+	buffer.cover(Rect(8, 8, 40, 40));
+	CHECK(buffer.isCovered(Rect(16, 16, 32, 32)));
+	CHECK(buffer.isCovered(Rect(20, 20, 8, 8)));
+	CHECK(!buffer.isCovered(Rect(8, 16, 8, 8)));
+	CHECK(!buffer.isCovered(Rect(16, 8, 8, 8)));
+	CHECK(!buffer.isCovered(Rect(16, 16, 33, 32)));
+	CHECK(!buffer.isCovered(Rect(16, 16, 32, 33)));
+
+	// smaller than a cell
+	buffer.reset(Rect(0, 0, 64, 64));
+	buffer.cover(Rect(1, 1, 30, 30));
+	CHECK(!buffer.isCovered(Rect(16, 16, 1, 1)));
+	CHECK(!buffer.isCovered(Rect(1, 1, 1, 1)));
+
+	// aligned to the cells
+	buffer.cover(Rect(0, 0, 16, 16));
+	CHECK(buffer.isCovered(Rect(0, 0, 16, 16)));
+	CHECK(!buffer.isCovered(Rect(0, 0, 17, 16)));
+}
+
+TEST(coveragebuffer_border_clamping) {
+	CoverageBuffer buffer(16);
+	// 4x3 cells, the last column and row are partial
+	Rect area(10, 20, 50, 40);
+	buffer.reset(area);
+
+	// parts outside of the area are not drawn, the border cells count as covered
+	buffer.cover(Rect(-100, -100, 300, 300));
+	CHECK(buffer.isCovered(area));
+	CHECK(buffer.isCovered(Rect(55, 55, 5, 5)));
+	// only the part inside of the area is tested
+	CHECK(buffer.isCovered(Rect(0, 0, 100, 100)));
+	// rectangles outside of the area are never covered
+	CHECK(!buffer.isCovered(Rect(0, 0, 10, 20)));
+	CHECK(!buffer.isCovered(Rect(60, 20, 10, 10)));
+	CHECK(!buffer.isCovered(Rect(10, 60, 10, 10)));
+
+	// overlaps the right border, covers the last two columns
+	buffer.reset(area);
+	buffer.cover(Rect(area.x + 32, area.y, 100, 16));
+	CHECK(buffer.isCovered(Rect(area.x + 32, area.y, 18, 16)));
+	CHECK(buffer.isCovered(Rect(area.x + 32, area.y, 50, 10)));
+	CHECK(!buffer.isCovered(Rect(area.x + 31, area.y, 2, 16)));
+	CHECK(!buffer.isCovered(Rect(area.x + 32, area.y, 18, 17)));
+
+	// overlaps the left border, covers the first column
+	buffer.reset(area);
+	buffer.cover(Rect(area.x - 5, area.y, 21, 16));
+	CHECK(buffer.isCovered(Rect(area.x - 5, area.y, 21, 16)));
+	CHECK(!buffer.isCovered(Rect(area.x, area.y, 17, 16)));
+
+	// completely outside
+	buffer.reset(area);
+	buffer.cover(Rect(0, 0, 10, 100));
+	buffer.cover(Rect(0, 0, 100, 20));
+	CHECK(!buffer.isCovered(Rect(area.x, area.y, 1, 1)));
+}
+
+TEST(coveragebuffer_reset) {
+	CoverageBuffer buffer(8);
+	buffer.reset(Rect(0, 0, 32, 32));
+	buffer.cover(Rect(0, 0, 32, 32));
+	CHECK(buffer.isCovered(Rect(0, 0, 32, 32)));
+
+	// reset clears all cells
+	buffer.reset(Rect(0, 0, 32, 32));
+	CHECK(!buffer.isCovered(Rect(0, 0, 8, 8)));
+
+	// new area with an offset
+	buffer.reset(Rect(100, 100, 32, 32));
+	buffer.cover(Rect(108, 108, 8, 8));
+	CHECK(buffer.isCovered(Rect(108, 108, 8, 8)));
+	CHECK(!buffer.isCovered(Rect(8, 8, 8, 8)));
+	CHECK(!buffer.isCovered(Rect(100, 100, 8, 8)));
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "video/sdl/renderbackendsdl.h"
+
+using namespace FIFE;
+
+// The dirty rects are tracked by the backend base, it only needs the screen size
+class DirtyRectBackend : public RenderBackendSDL {
+public:
+	DirtyRectBackend():
+		RenderBackendSDL(SDL_Color()) {
+		m_screen = SDL_CreateRGBSurface(0, 800, 600, 32, RMASK, GMASK, BMASK, AMASK);
+		setDirtyRectsEnabled(true);
+		// enabling damages the whole screen
+		CHECK_EQUAL(1u, m_dirtyAreas.size());
+		CHECK(getDirtyArea() == Rect(0, 0, 800, 600));
+		m_dirtyAreas.clear();
+	}
+
+	~DirtyRectBackend() {
+		SDL_FreeSurface(m_screen);
+		m_screen = NULL;
+	}
+
+	// ends the frame without presenting it
+	void finishFrame() {
+		RenderBackend::endFrame();
+	}
+
+	const std::vector<Rect>& getDirtyRects() const {
+		return m_dirtyAreas;
+	}
+};
+
+TEST(dirtyrects_disabled) {
+	DirtyRectBackend backend;
+	backend.setDirtyRectsEnabled(false);
+	CHECK(!backend.isDirtyRectsEnabled());
+	backend.addDirtyRect(Rect(0, 0, 10, 10));
+	CHECK(backend.getDirtyRects().empty());
+	// everything is redrawn without dirty rects
+	CHECK(backend.isDirty(Rect(500, 500, 1, 1)));
+}
+
+TEST(dirtyrects_merge) {
+	DirtyRectBackend backend;
+	CHECK(!backend.isDirty(Rect(0, 0, 800, 600)));
+	CHECK(backend.getDirtyArea() == Rect());
+
+	backend.addDirtyRect(Rect(0, 0, 10, 10));
+	backend.addDirtyRect(Rect(5, 5, 10, 10));
+	CHECK_EQUAL(1u, backend.getDirtyRects().size());
+	CHECK(backend.getDirtyRects()[0] == Rect(0, 0, 15, 15));
+
+	// separate rects stay separate
+	backend.addDirtyRect(Rect(100, 100, 10, 10));
+	CHECK_EQUAL(2u, backend.getDirtyRects().size());
+
+	// a rect that overlaps both merges all three
+	backend.addDirtyRect(Rect(10, 10, 95, 95));
+	CHECK_EQUAL(1u, backend.getDirtyRects().size());
+	CHECK(backend.getDirtyRects()[0] == Rect(0, 0, 110, 110));
+	CHECK(backend.isDirty(Rect(50, 50, 1, 1)));
+	CHECK(!backend.isDirty(Rect(200, 200, 10, 10)));
+}
+
+TEST(dirtyrects_clip) {
+	DirtyRectBackend backend;
+	backend.addDirtyRect(Rect(-10, -10, 20, 20));
+	CHECK_EQUAL(1u, backend.getDirtyRects().size());
+	CHECK(backend.getDirtyRects()[0] == Rect(0, 0, 10, 10));
+
+	// off screen and empty rects are ignored
+	backend.addDirtyRect(Rect(900, 0, 10, 10));
+	backend.addDirtyRect(Rect(0, 700, 10, 10));
+	backend.addDirtyRect(Rect(300, 300, 0, 10));
+	CHECK_EQUAL(1u, backend.getDirtyRects().size());
+}
+
+TEST(dirtyrects_limit) {
+	DirtyRectBackend backend;
+	for (int32_t i = 0; i < 32; ++i) {
+		backend.addDirtyRect(Rect(i * 20, 0, 10, 10));
+	}
+	CHECK_EQUAL(32u, backend.getDirtyRects().size());
+	// too many rects are merged into their bounding box
+	backend.addDirtyRect(Rect(0, 100, 10, 10));
+	CHECK_EQUAL(1u, backend.getDirtyRects().size());
+	CHECK(backend.getDirtyRects()[0] == Rect(0, 0, 630, 110));
+}
+
+TEST(dirtyrects_frames) {
+	DirtyRectBackend backend;
+	backend.addDirtyRect(Rect(0, 0, 10, 10));
+	backend.addDirtyRect(Rect(100, 100, 10, 10));
+	// the backend clears and redraws the bounding box, so areas between the rects are dirty too
+	CHECK(backend.getDirtyArea() == Rect(0, 0, 110, 110));
+	CHECK(backend.isDirty(Rect(50, 50, 5, 5)));
+
+	// damage is redrawn in the next frame again
+	backend.finishFrame();
+	CHECK(backend.getDirtyRects().empty());
+	CHECK(backend.getDirtyArea() == Rect(0, 0, 110, 110));
+	backend.addDirtyRect(Rect(200, 200, 10, 10));
+	CHECK(backend.getDirtyArea() == Rect(0, 0, 210, 210));
+
+	backend.finishFrame();
+	CHECK(backend.getDirtyArea() == Rect(200, 200, 10, 10));
+	CHECK(!backend.isDirty(Rect(0, 0, 10, 10)));
+
+	backend.finishFrame();
+	CHECK(backend.getDirtyArea() == Rect());
+	CHECK(!backend.isDirty(Rect(0, 0, 800, 600)));
+
+	backend.invalidateScreen();
+	CHECK(backend.getDirtyArea() == Rect(0, 0, 800, 600));
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "video/image.h"
+#include "video/imagemanager.h"
+#include "view/renderers/effectimagecache.h"
+
+using namespace FIFE;
+
+// Image without a render backend
+class TestImage : public Image {
+public:
+	TestImage(): Image(SDL_CreateRGBSurface(0, 2, 2, 32, RMASK, GMASK, BMASK, AMASK)) {
+		setState(IResource::RES_LOADED);
+	}
+
+	virtual void invalidate() {}
+	virtual void render(const Rect&, uint8_t = 255, uint8_t const* = 0) {}
+	virtual void setSurface(SDL_Surface* surface) { reset(surface); }
+	virtual void useSharedImage(const ImagePtr&, const Rect&) {}
+	virtual void forceLoadInternal() {}
+};
+
+// outline key of one source image
+static EffectKey createKey(ResourceHandle image, uint32_t color = 0) {
+	EffectKey key;
+	key.effect = 1;
+	key.images.push_back(image);
+	key.color = color;
+	key.width = 1;
+	key.threshold = 1;
+	return key;
+}
+
+TEST(effectimagecache_key) {
+	CHECK(!(createKey(1) < createKey(1)));
+	CHECK(createKey(1) < createKey(2));
+	CHECK(createKey(2, 0) < createKey(1, 1));
+
+	EffectKey multi = createKey(1);
+	multi.images.push_back(2);
+	CHECK(createKey(1) < multi);
+
+	EffectKey recolor = createKey(1);
+	recolor.colors.push_back(0xffffffff);
+	CHECK(createKey(1) < recolor);
+	CHECK(!(recolor < createKey(1)));
+}
+
+TEST(effectimagecache_get) {
+	ImageManager manager;
+	EffectImageCache cache(4);
+	CHECK(!cache.get(createKey(1), 0));
+
+	ImagePtr image = cache.add(createKey(1), new TestImage(), 0);
+	CHECK(manager.exists(image->getHandle()));
+	CHECK(cache.get(createKey(1), 10) == image);
+	CHECK(!cache.get(createKey(1, 5), 10));
+	CHECK_EQUAL(1u, cache.getSize());
+
+	// images that are not loaded anymore are dropped
+	image->setState(IResource::RES_NOT_LOADED);
+	CHECK(!cache.get(createKey(1), 20));
+	CHECK(cache.empty());
+	CHECK(!manager.exists(image->getHandle()));
+}
+
+TEST(effectimagecache_lru_eviction) {
+	ImageManager manager;
+	EffectImageCache cache(3);
+	ImagePtr first = cache.add(createKey(1), new TestImage(), 0);
+	cache.add(createKey(2), new TestImage(), 1);
+	cache.add(createKey(3), new TestImage(), 2);
+	CHECK_EQUAL(3u, manager.getTotalResources());
+
+	// the first image is used again, so the second one is the least recently used
+	CHECK(cache.get(createKey(1), 3) == first);
+	cache.add(createKey(4), new TestImage(), 4);
+	CHECK_EQUAL(3u, cache.getSize());
+	CHECK(cache.contains(createKey(1)));
+	CHECK(!cache.contains(createKey(2)));
+	CHECK(cache.contains(createKey(3)));
+	CHECK(cache.contains(createKey(4)));
+	CHECK_EQUAL(3u, manager.getTotalResources());
+
+	// shrinking removes the least recently used images
+	cache.setMaxSize(1);
+	CHECK_EQUAL(1u, cache.getSize());
+	CHECK(cache.contains(createKey(4)));
+	CHECK_EQUAL(1u, manager.getTotalResources());
+
+	// the new image is kept even if the cache can not hold any
+	cache.setMaxSize(0);
+	ImagePtr last = cache.add(createKey(5), new TestImage(), 5);
+	CHECK(cache.get(createKey(5), 5) == last);
+	CHECK_EQUAL(1u, cache.getSize());
+
+	cache.clear();
+	CHECK(cache.empty());
+	CHECK_EQUAL(0u, manager.getTotalResources());
+}
+
+TEST(effectimagecache_remove_unused) {
+	ImageManager manager;
+	EffectImageCache cache(8);
+	cache.add(createKey(1), new TestImage(), 0);
+	cache.add(createKey(2), new TestImage(), 100);
+	cache.add(createKey(3), new TestImage(), 200);
+	cache.get(createKey(1), 250);
+
+	cache.removeUnused(300, 150);
+	CHECK(cache.contains(createKey(1)));
+	CHECK(!cache.contains(createKey(2)));
+	CHECK(cache.contains(createKey(3)));
+
+	cache.removeUnused(1000, 150);
+	CHECK(cache.empty());
+}
+
+TEST(effectimagecache_image_in_use) {
+	ImageManager manager;
+	EffectImageCache cache(1);
+	// an instance still shows the image after it was evicted
+	ImagePtr shown = cache.add(createKey(1), new TestImage(), 0);
+	cache.add(createKey(2), new TestImage(), 1);
+	CHECK(!cache.contains(createKey(1)));
+	CHECK(!manager.exists(shown->getHandle()));
+	CHECK_EQUAL(2u, shown->getWidth());
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,254 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "video/image.h"
+#include "view/renderers/effectpainter.h"
+
+using namespace FIFE;
+
+// Image without a render backend
+class TestImage : public Image {
+public:
+	TestImage(SDL_Surface* surface): Image(surface) {}
+
+	virtual void invalidate() {}
+	virtual void render(const Rect&, uint8_t = 255, uint8_t const* = 0) {}
+	virtual void setSurface(SDL_Surface* surface) { reset(surface); }
+	virtual void useSharedImage(const ImagePtr&, const Rect&) {}
+	virtual void forceLoadInternal() {}
+};
+
+static const uint32_t OUTLINE_COLOR = packRGBA(255, 0, 0, 255);
+
+// transparent RGBA surface like the one of the outline images
+static SDL_Surface* createTarget(int32_t w, int32_t h) {
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, w, h, 32, RMASK, GMASK, BMASK, AMASK);
+	SDL_FillRect(surface, NULL, 0);
+	return surface;
+}
+
+static bool isOutline(SDL_Surface* surface, int32_t x, int32_t y) {
+	const uint32_t* row = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch);
+	return row[x] == OUTLINE_COLOR;
+}
+
+static int32_t countOutline(SDL_Surface* surface) {
+	int32_t count = 0;
+	for (int32_t y = 0; y < surface->h; ++y) {
+		for (int32_t x = 0; x < surface->w; ++x) {
+			if (isOutline(surface, x, y)) {
+				++count;
+			}
+		}
+	}
+	return count;
+}
+
+// alpha values of a w x h image with one opaque pixel
+static std::vector<uint8_t> createDot(int32_t w, int32_t h, int32_t x, int32_t y) {
+	std::vector<uint8_t> alpha(w * h, 0);
+	alpha[y * w + x] = 255;
+	return alpha;
+}
+
+TEST(effectpainter_threshold_old_behavior) {
+	// thresholds up to 1 only separate transparent and not transparent pixels
+	for (int32_t threshold = 0; threshold <= 1; ++threshold) {
+		CHECK(aboveThreshold(threshold, 10, 0));
+		CHECK(aboveThreshold(threshold, 0, 255));
+		CHECK(!aboveThreshold(threshold, 10, 200));
+		CHECK(!aboveThreshold(threshold, 0, 0));
+		CHECK(!aboveThreshold(threshold, 255, 255));
+	}
+}
+
+TEST(effectpainter_threshold_new_behavior) {
+	CHECK(aboveThreshold(128, 200, 100));
+	CHECK(aboveThreshold(128, 100, 128));
+	CHECK(aboveThreshold(128, 0, 255));
+	// both below the threshold
+	CHECK(!aboveThreshold(128, 10, 0));
+	CHECK(!aboveThreshold(128, 100, 127));
+	// no edge between equal values
+	CHECK(!aboveThreshold(128, 200, 200));
+}
+
+TEST(effectpainter_outline_threshold) {
+	const int32_t alphaValues[3] = { 0, 100, 200 };
+	std::vector<uint8_t> alpha(alphaValues, alphaValues + 3);
+
+	// old behavior, the edge is between the transparent and the semi transparent pixel
+	SDL_Surface* target = createTarget(3, 1);
+	paintOutline(alpha, 3, 1, target, 0, 0, OUTLINE_COLOR, 1, 1);
+	CHECK(isOutline(target, 0, 0));
+	CHECK_EQUAL(1, countOutline(target));
+	SDL_FreeSurface(target);
+
+	// new behavior, the edge is at the first pixel that reaches the threshold
+	target = createTarget(3, 1);
+	paintOutline(alpha, 3, 1, target, 0, 0, OUTLINE_COLOR, 1, 150);
+	CHECK(isOutline(target, 1, 0));
+	CHECK_EQUAL(1, countOutline(target));
+	SDL_FreeSurface(target);
+}
+
+TEST(effectpainter_outline_width) {
+	// the outline is drawn on the transparent side of the edges
+	SDL_Surface* target = createTarget(3, 3);
+	paintOutline(createDot(3, 3, 1, 1), 3, 3, target, 0, 0, OUTLINE_COLOR, 1, 1);
+	CHECK(isOutline(target, 1, 0));
+	CHECK(isOutline(target, 1, 2));
+	CHECK(isOutline(target, 0, 1));
+	CHECK(isOutline(target, 2, 1));
+	CHECK(!isOutline(target, 1, 1));
+	CHECK_EQUAL(4, countOutline(target));
+	SDL_FreeSurface(target);
+
+	target = createTarget(5, 5);
+	paintOutline(createDot(5, 5, 2, 2), 5, 5, target, 0, 0, OUTLINE_COLOR, 2, 1);
+	for (int32_t i = 0; i < 2; ++i) {
+		CHECK(isOutline(target, 2, i));
+		CHECK(isOutline(target, 2, 3 + i));
+		CHECK(isOutline(target, i, 2));
+		CHECK(isOutline(target, 3 + i, 2));
+	}
+	CHECK(!isOutline(target, 2, 2));
+	CHECK_EQUAL(8, countOutline(target));
+	SDL_FreeSurface(target);
+}
+
+TEST(effectpainter_outline_clipping) {
+	// the image is moved over the top left border, only the bottom and right outline is inside
+	SDL_Surface* target = createTarget(3, 3);
+	paintOutline(createDot(3, 3, 1, 1), 3, 3, target, -1, -1, OUTLINE_COLOR, 2, 1);
+	CHECK(isOutline(target, 0, 1));
+	CHECK(isOutline(target, 0, 2));
+	CHECK(isOutline(target, 1, 0));
+	CHECK(isOutline(target, 2, 0));
+	CHECK_EQUAL(4, countOutline(target));
+	SDL_FreeSurface(target);
+
+	// and over the bottom right border
+	target = createTarget(3, 3);
+	paintOutline(createDot(3, 3, 1, 1), 3, 3, target, 1, 1, OUTLINE_COLOR, 2, 1);
+	CHECK(isOutline(target, 2, 0));
+	CHECK(isOutline(target, 2, 1));
+	CHECK(isOutline(target, 0, 2));
+	CHECK(isOutline(target, 1, 2));
+	CHECK_EQUAL(4, countOutline(target));
+	SDL_FreeSurface(target);
+
+	// completely outside
+	target = createTarget(3, 3);
+	paintOutline(createDot(3, 3, 1, 1), 3, 3, target, 10, -10, OUTLINE_COLOR, 2, 1);
+	CHECK_EQUAL(0, countOutline(target));
+	SDL_FreeSurface(target);
+}
+
+TEST(effectpainter_outline_centered_overlays) {
+	// animation overlays are centered in the largest one, like in InstanceRenderer::bindMultiOutline
+	const int32_t sizes[2][2] = { { 7, 5 }, { 3, 3 } };
+	const int32_t mw = 7;
+	const int32_t mh = 5;
+	SDL_Surface* target = createTarget(mw, mh);
+	for (int32_t i = 0; i < 2; ++i) {
+		const int32_t w = sizes[i][0];
+		const int32_t h = sizes[i][1];
+		paintOutline(createDot(w, h, w / 2, h / 2), w, h, target, mw / 2 - w / 2, mh / 2 - h / 2, OUTLINE_COLOR, 1, 1);
+	}
+	// both dots are at the center, so their outlines are the same
+	CHECK(isOutline(target, 3, 1));
+	CHECK(isOutline(target, 3, 3));
+	CHECK(isOutline(target, 2, 2));
+	CHECK(isOutline(target, 4, 2));
+	CHECK_EQUAL(4, countOutline(target));
+	SDL_FreeSurface(target);
+}
+
+TEST(effectpainter_outline_alpha) {
+	SDL_Surface* surface = createTarget(4, 2);
+	uint8_t* pixels = static_cast<uint8_t*>(surface->pixels);
+	pixels[1 * 4 + 3] = 100;
+	pixels[surface->pitch + 3 * 4 + 3] = 255;
+	TestImage image(surface);
+
+	std::vector<uint8_t> alpha;
+	CHECK(getOutlineAlpha(&image, false, alpha));
+	CHECK_EQUAL(8u, alpha.size());
+	CHECK_EQUAL(0, alpha[0]);
+	CHECK_EQUAL(100, alpha[1]);
+	CHECK_EQUAL(255, alpha[7]);
+
+	TestImage empty(NULL);
+	CHECK(!getOutlineAlpha(&empty, false, alpha));
+}
+
+TEST(effectpainter_coloring) {
+	SDL_Surface* surface = createTarget(2, 1);
+	uint8_t* pixels = static_cast<uint8_t*>(surface->pixels);
+	const uint8_t values[8] = { 10, 20, 30, 0, 200, 100, 0, 255 };
+	for (int32_t i = 0; i < 8; ++i) {
+		pixels[i] = values[i];
+	}
+
+	// the image colors are kept
+	paintColoring(surface, 0, 0, 255, 255);
+	CHECK_EQUAL(200, pixels[4]);
+	CHECK_EQUAL(100, pixels[5]);
+	CHECK_EQUAL(0, pixels[6]);
+	// transparent pixels are cleared
+	CHECK_EQUAL(0, pixels[0]);
+	CHECK_EQUAL(0, pixels[1]);
+	CHECK_EQUAL(0, pixels[2]);
+
+	// half image, half color
+	paintColoring(surface, 0, 0, 255, 128);
+	CHECK_EQUAL(100, pixels[4]);
+	CHECK_EQUAL(50, pixels[5]);
+	CHECK_EQUAL(127, pixels[6]);
+	CHECK_EQUAL(255, pixels[7]);
+
+	// only the color
+	paintColoring(surface, 1, 2, 3, 0);
+	CHECK_EQUAL(1, pixels[4]);
+	CHECK_EQUAL(2, pixels[5]);
+	CHECK_EQUAL(3, pixels[6]);
+	SDL_FreeSurface(surface);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
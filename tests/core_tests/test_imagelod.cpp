@@ -0,0 +1,199 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "video/image.h"
+#include "video/imagemanager.h"
+#include "video/sdl/renderbackendsdl.h"
+
+using namespace FIFE;
+
+// The variants are created by the render backend, it does not need a window for that
+struct LodEnvironment {
+	RenderBackendSDL backend;
+	ImageManager manager;
+
+	LodEnvironment():
+		backend(SDL_Color()) {
+		manager.setLodEnabled(true);
+	}
+
+	// transparent image with the given size
+	ImagePtr createImage(int32_t width, int32_t height) {
+		SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, RMASK, GMASK, BMASK, AMASK);
+		SDL_FillRect(surface, NULL, 0);
+		ImagePtr image = manager.add(backend.createImage(surface));
+		image->setState(IResource::RES_LOADED);
+		return image;
+	}
+};
+
+static void setPixel(const ImagePtr& image, int32_t x, int32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+	SDL_Surface* surface = image->getSurface();
+	uint8_t* p = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch + x * 4;
+	p[0] = r;
+	p[1] = g;
+	p[2] = b;
+	p[3] = a;
+}
+
+// memory used by the variant
+static size_t getMemory(const ImagePtr& image) {
+	return image->getSurface()->h * image->getSurface()->pitch;
+}
+
+static const uint8_t* getPixel(const ImagePtr& image, int32_t x, int32_t y) {
+	SDL_Surface* surface = image->getSurface();
+	return static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch + x * 4;
+}
+
+TEST(imagelod_level) {
+	LodEnvironment env;
+	CHECK_EQUAL(0u, env.manager.getLodLevel(2.0));
+	CHECK_EQUAL(0u, env.manager.getLodLevel(1.0));
+	CHECK_EQUAL(0u, env.manager.getLodLevel(0.75));
+	// the variant is never smaller than the zoomed image
+	CHECK_EQUAL(1u, env.manager.getLodLevel(0.5));
+	CHECK_EQUAL(1u, env.manager.getLodLevel(0.3));
+	CHECK_EQUAL(2u, env.manager.getLodLevel(0.25));
+	CHECK_EQUAL(3u, env.manager.getLodLevel(0.125));
+	// limited to the smallest variant
+	CHECK_EQUAL(4u, env.manager.getLodLevel(0.01));
+}
+
+TEST(imagelod_disabled) {
+	LodEnvironment env;
+	ImagePtr image = env.createImage(8, 8);
+	CHECK(env.manager.getLodImage(image, 0) == image);
+
+	env.manager.setLodEnabled(false);
+	CHECK(env.manager.getLodImage(image, 1) == image);
+	CHECK_EQUAL(0u, env.manager.getLodMemoryUsed());
+
+	// a single pixel can not be scaled
+	env.manager.setLodEnabled(true);
+	ImagePtr pixel = env.createImage(1, 1);
+	CHECK(env.manager.getLodImage(pixel, 1) == pixel);
+}
+
+TEST(imagelod_size) {
+	LodEnvironment env;
+	ImagePtr image = env.createImage(9, 4);
+	ImagePtr lod = env.manager.getLodImage(image, 1);
+	CHECK(lod != image);
+	CHECK_EQUAL(5u, lod->getWidth());
+	CHECK_EQUAL(2u, lod->getHeight());
+	// the same variant is returned again
+	CHECK(env.manager.getLodImage(image, 1) == lod);
+
+	// level 2 is filtered from level 1, both are cached
+	ImagePtr lod2 = env.manager.getLodImage(image, 2);
+	CHECK_EQUAL(3u, lod2->getWidth());
+	CHECK_EQUAL(1u, lod2->getHeight());
+	CHECK_EQUAL(getMemory(lod) + getMemory(lod2), env.manager.getLodMemoryUsed());
+}
+
+TEST(imagelod_alpha_weighted_filter) {
+	LodEnvironment env;
+	ImagePtr image = env.createImage(2, 2);
+	setPixel(image, 0, 0, 255, 0, 0, 255);
+	// the color of transparent pixels does not bleed into the variant
+	setPixel(image, 1, 0, 0, 0, 255, 0);
+	setPixel(image, 0, 1, 0, 255, 0, 255);
+	setPixel(image, 1, 1, 0, 0, 0, 0);
+
+	ImagePtr lod = env.manager.getLodImage(image, 1);
+	const uint8_t* p = getPixel(lod, 0, 0);
+	CHECK_EQUAL(128, p[0]);
+	CHECK_EQUAL(128, p[1]);
+	CHECK_EQUAL(0, p[2]);
+	CHECK_EQUAL(128, p[3]);
+
+	// a transparent block stays black and transparent
+	ImagePtr empty = env.createImage(2, 2);
+	setPixel(empty, 0, 0, 255, 255, 255, 0);
+	p = getPixel(env.manager.getLodImage(empty, 1), 0, 0);
+	CHECK_EQUAL(0, p[0]);
+	CHECK_EQUAL(0, p[3]);
+}
+
+TEST(imagelod_eviction) {
+	LodEnvironment env;
+	ImagePtr first = env.createImage(8, 8);
+	ImagePtr second = env.createImage(8, 8);
+	ImagePtr third = env.createImage(8, 8);
+	ImagePtr firstLod = env.manager.getLodImage(first, 1);
+	// room for two variants
+	const size_t size = getMemory(firstLod);
+	env.manager.setLodMemoryLimit(2 * size);
+	env.manager.getLodImage(second, 1);
+	// the first variant is used again, so the second one is the least recently used
+	CHECK(env.manager.getLodImage(first, 1) == firstLod);
+	env.manager.getLodImage(third, 1);
+	CHECK_EQUAL(2 * size, env.manager.getLodMemoryUsed());
+	CHECK(env.manager.getLodImage(first, 1) == firstLod);
+
+	// shrinking the limit removes the least recently used variants
+	env.manager.setLodMemoryLimit(size);
+	CHECK_EQUAL(size, env.manager.getLodMemoryUsed());
+	CHECK(env.manager.getLodImage(first, 1) == firstLod);
+
+	// removing the image removes its variants
+	env.manager.remove(first->getHandle());
+	CHECK_EQUAL(0u, env.manager.getLodMemoryUsed());
+}
+
+TEST(imagelod_above_limit) {
+	LodEnvironment env;
+	ImagePtr small = env.createImage(8, 8);
+	ImagePtr smallLod = env.manager.getLodImage(small, 1);
+	CHECK(smallLod != small);
+	const size_t size = getMemory(smallLod);
+	env.manager.setLodMemoryLimit(size);
+
+	// the variant would be evicted right away, so the full image is used
+	ImagePtr large = env.createImage(16, 16);
+	CHECK(env.manager.getLodImage(large, 1) == large);
+	CHECK_EQUAL(size, env.manager.getLodMemoryUsed());
+	CHECK(env.manager.getLodImage(small, 1) == smallLod);
+
+	// level 2 is filtered from level 1, so it falls back as well
+	CHECK(env.manager.getLodImage(large, 2) == large);
+	env.manager.setLodMemoryLimit(0);
+	CHECK(env.manager.getLodImage(small, 1) == small);
+	CHECK_EQUAL(0u, env.manager.getLodMemoryUsed());
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,168 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "view/instanceidbuffer.h"
+#include "view/renderitem.h"
+
+using namespace FIFE;
+
+// render list with items of the given screen dimensions
+struct ItemList {
+	RenderList items;
+
+	~ItemList() {
+		for (RenderList::iterator it = items.begin(); it != items.end(); ++it) {
+			delete *it;
+		}
+	}
+
+	void add(const Rect& dimensions) {
+		RenderItem* item = new RenderItem(0);
+		item->dimensions = dimensions;
+		items.push_back(item);
+	}
+};
+
+static std::vector<uint32_t> idsAt(const InstanceIdBuffer& buffer, const Point& point) {
+	std::vector<uint32_t> ids;
+	buffer.getIds(point, ids);
+	return ids;
+}
+
+static std::vector<uint32_t> idsIn(const InstanceIdBuffer& buffer, const Rect& rect) {
+	std::vector<uint32_t> ids;
+	buffer.getIds(rect, ids);
+	return ids;
+}
+
+static std::vector<uint32_t> makeIds(uint32_t a, int32_t b = -1, int32_t c = -1) {
+	std::vector<uint32_t> ids(1, a);
+	if (b != -1) {
+		ids.push_back(b);
+	}
+	if (c != -1) {
+		ids.push_back(c);
+	}
+	return ids;
+}
+
+TEST(instanceidbuffer_cells) {
+	ItemList list;
+	// cell 0,0
+	list.add(Rect(0, 0, 10, 10));
+	// cells 0,0 to 1,1
+	list.add(Rect(20, 20, 20, 20));
+	// overlaps the right and bottom border, cells 2,2 to 3,3
+	list.add(Rect(90, 90, 50, 50));
+	// outside
+	list.add(Rect(-50, -50, 10, 10));
+	// empty
+	list.add(Rect(40, 40, 0, 0));
+
+	// 4x4 cells, the last column and row are partial
+	InstanceIdBuffer buffer(32);
+	buffer.build(Rect(0, 0, 100, 100), list.items);
+
+	// topmost item first
+	CHECK(idsAt(buffer, Point(5, 5)) == makeIds(1, 0));
+	CHECK(idsAt(buffer, Point(31, 31)) == makeIds(1, 0));
+	CHECK(idsAt(buffer, Point(32, 32)) == makeIds(1));
+	CHECK(idsAt(buffer, Point(63, 63)) == makeIds(1));
+	CHECK(idsAt(buffer, Point(64, 64)) == makeIds(2));
+	CHECK(idsAt(buffer, Point(99, 99)) == makeIds(2));
+	CHECK(idsAt(buffer, Point(64, 0)).empty());
+
+	// points outside of the area
+	CHECK(idsAt(buffer, Point(100, 99)).empty());
+	CHECK(idsAt(buffer, Point(99, 100)).empty());
+	CHECK(idsAt(buffer, Point(-1, 0)).empty());
+	CHECK(idsAt(buffer, Point(0, -1)).empty());
+
+	// every id once, topmost first
+	CHECK(idsIn(buffer, Rect(0, 0, 64, 64)) == makeIds(1, 0));
+	CHECK(idsIn(buffer, Rect(0, 0, 100, 100)) == makeIds(2, 1, 0));
+	CHECK(idsIn(buffer, Rect(-100, -100, 400, 400)) == makeIds(2, 1, 0));
+	CHECK(idsIn(buffer, Rect(40, 40, 30, 30)) == makeIds(2, 1));
+	CHECK(idsIn(buffer, Rect(64, 0, 36, 32)).empty());
+	CHECK(idsIn(buffer, Rect(100, 100, 10, 10)).empty());
+	CHECK(idsIn(buffer, Rect(0, 0, 0, 0)).empty());
+}
+
+TEST(instanceidbuffer_offset_area) {
+	ItemList list;
+	list.add(Rect(50, 50, 16, 16));
+	list.add(Rect(90, 50, 16, 16));
+
+	// 2x2 cells
+	InstanceIdBuffer buffer(32);
+	buffer.build(Rect(50, 50, 64, 64), list.items);
+	CHECK(idsAt(buffer, Point(50, 50)) == makeIds(0));
+	CHECK(idsAt(buffer, Point(81, 81)) == makeIds(0));
+	CHECK(idsAt(buffer, Point(82, 50)) == makeIds(1));
+	CHECK(idsAt(buffer, Point(113, 113)).empty());
+	CHECK(idsAt(buffer, Point(49, 50)).empty());
+	CHECK(idsIn(buffer, Rect(0, 0, 100, 60)) == makeIds(1, 0));
+}
+
+TEST(instanceidbuffer_validity) {
+	ItemList list;
+	list.add(Rect(0, 0, 10, 10));
+	list.add(Rect(0, 0, 10, 10));
+
+	InstanceIdBuffer buffer(32);
+	CHECK(!buffer.isValid(0));
+	CHECK(idsAt(buffer, Point(0, 0)).empty());
+
+	buffer.build(Rect(0, 0, 64, 64), list.items);
+	CHECK(buffer.isValid(2));
+	CHECK(!buffer.isValid(3));
+	CHECK(idsAt(buffer, Point(0, 0)) == makeIds(1, 0));
+
+	buffer.invalidate();
+	CHECK(!buffer.isValid(2));
+	CHECK(idsAt(buffer, Point(0, 0)).empty());
+	CHECK(idsIn(buffer, Rect(0, 0, 64, 64)).empty());
+
+	// rebuilding reuses the buffer
+	list.add(Rect(40, 40, 10, 10));
+	buffer.build(Rect(0, 0, 64, 64), list.items);
+	CHECK(buffer.isValid(3));
+	CHECK(idsAt(buffer, Point(0, 0)) == makeIds(1, 0));
+	CHECK(idsAt(buffer, Point(40, 40)) == makeIds(2));
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,195 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "loaders/native/map/loadprofiler.h"
+#include "loaders/native/map/percentdonelistener.h"
+#include "vfs/vfs.h"
+#include "vfs/vfsdirectory.h"
+#include "vfs/raw/rawdata.h"
+
+using namespace FIFE;
+
+static const std::string PROFILER_FILE = "loadprofiler_test.dat";
+
+class PhaseListener : public PercentDoneListener {
+public:
+	virtual void OnEvent(unsigned int) {}
+	virtual void OnPhaseDone(const LoadPhase& phase) {
+		names.push_back(phase.name);
+	}
+
+	std::vector<std::string> names;
+};
+
+// the load of a map that fails in its second phase
+static void failingLoad(LoadProfiler& profiler) {
+	profiler.beginPhase("map");
+	LoadPhaseGuard guard(profiler);
+	profiler.beginPhase("layers");
+	throw NotFound("layer file");
+}
+
+TEST(loadprofiler_phases) {
+	LoadProfiler profiler(0, 0);
+	CHECK(!profiler.isPhaseRunning());
+	CHECK(profiler.endPhase() == 0);
+
+	profiler.beginPhase("imports");
+	profiler.addCount(3);
+	CHECK(profiler.isPhaseRunning());
+	// beginning a phase ends the running one
+	profiler.beginPhase("layers");
+	profiler.addCount();
+	profiler.addCount();
+	const LoadPhase* layers = profiler.endPhase();
+	CHECK(layers != 0);
+	CHECK(!profiler.isPhaseRunning());
+	// counts outside of a phase are dropped
+	profiler.addCount(10);
+
+	const LoadProfile& profile = profiler.getProfile();
+	CHECK_EQUAL(2u, profile.getPhaseCount());
+	CHECK_EQUAL("imports", profile.getPhase(0).name);
+	CHECK_EQUAL(3u, profile.getPhase(0).count);
+	CHECK_EQUAL("layers", profile.getPhase(1).name);
+	CHECK_EQUAL(2u, profile.getPhase(1).count);
+	CHECK(profile.getPhase(0).seconds >= 0.0);
+	CHECK_CLOSE(profile.getPhase(0).seconds + profile.getPhase(1).seconds, profile.getTotalSeconds(), 1e-9);
+	CHECK_THROW(profile.getPhase(2), IndexOverflow);
+
+	profiler.reset();
+	CHECK_EQUAL(0u, profiler.getProfile().getPhaseCount());
+}
+
+TEST(loadprofiler_json) {
+	LoadProfile profile;
+	CHECK_EQUAL("[]", profile.toJson());
+
+	LoadPhase phase;
+	phase.name = "\"map\"";
+	phase.count = 2;
+	phase.bytesRead = 100;
+	phase.processPeakMemory = 4096;
+	phase.peakMemoryGrowth = 1024;
+	profile.addPhase(phase);
+	phase.name = "layers";
+	profile.addPhase(phase);
+	const std::string json = profile.toJson();
+	CHECK_EQUAL(0u, json.find("[{\"name\": \"\\\"map\\\"\", \"seconds\": 0, \"count\": 2, \"bytes_read\": 100"));
+	CHECK(json.find("\"process_peak_memory\": 4096, \"peak_memory_growth\": 1024}, {\"name\": \"layers\"") != std::string::npos);
+	CHECK_EQUAL(']', json[json.size() - 1]);
+}
+
+TEST(loadprofiler_listener) {
+	PercentDoneCallback callback;
+	PhaseListener listener;
+	callback.addListener(&listener);
+	LoadProfiler profiler(0, 0, &callback);
+	profiler.beginPhase("map");
+	profiler.beginPhase("layers");
+	profiler.endPhase();
+	CHECK_EQUAL(2u, listener.names.size());
+	CHECK_EQUAL("map", listener.names[0]);
+	CHECK_EQUAL("layers", listener.names[1]);
+}
+
+TEST(loadprofiler_guard) {
+	PercentDoneCallback callback;
+	PhaseListener listener;
+	callback.addListener(&listener);
+	LoadProfiler profiler(0, 0, &callback);
+
+	// early returns and exceptions end the running phase
+	CHECK_THROW(failingLoad(profiler), NotFound);
+	CHECK(!profiler.isPhaseRunning());
+	CHECK_EQUAL(2u, profiler.getProfile().getPhaseCount());
+	CHECK_EQUAL(2u, listener.names.size());
+
+	// a phase that was already ended is not ended again
+	{
+		profiler.beginPhase("cameras");
+		LoadPhaseGuard guard(profiler);
+		profiler.endPhase();
+	}
+	CHECK_EQUAL(3u, profiler.getProfile().getPhaseCount());
+}
+
+TEST(loadprofiler_bytes_read) {
+	{
+		std::ofstream file(PROFILER_FILE.c_str(), std::ios::binary);
+		file << std::string(100, 'x');
+	}
+	VFS vfs;
+	vfs.addSource(new VFSDirectory(&vfs));
+	LoadProfiler profiler(&vfs, 0);
+	profiler.beginPhase("imports");
+	delete vfs.open(PROFILER_FILE);
+	const LoadPhase* imports = profiler.endPhase();
+	CHECK_EQUAL(100u, imports->bytesRead);
+
+	// only the bytes of the phase are counted
+	profiler.beginPhase("objects");
+	CHECK_EQUAL(0u, profiler.endPhase()->bytesRead);
+	std::remove(PROFILER_FILE.c_str());
+}
+
+TEST(loadprofiler_peak_memory) {
+	if (LoadProfiler::getPeakMemory() == 0) {
+		// unknown on this platform
+		return;
+	}
+	LoadProfiler profiler(0, 0);
+	profiler.beginPhase("layers");
+	// touches every page, so the resident memory grows
+	const size_t size = 64 * 1024 * 1024;
+	std::vector<char> memory(size, 1);
+	// copied, the next phase can move the phases of the profile
+	const LoadPhase layers = *profiler.endPhase();
+	CHECK(layers.peakMemoryGrowth >= size / 2);
+	CHECK(layers.processPeakMemory >= layers.peakMemoryGrowth);
+
+	// the peak does not grow again for memory that was already used
+	memory.assign(size, 2);
+	profiler.beginPhase("cameras");
+	const LoadPhase* cameras = profiler.endPhase();
+	CHECK(cameras->peakMemoryGrowth < size / 2);
+	CHECK(cameras->processPeakMemory >= layers.processPeakMemory);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,184 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <memory>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "util/time/timemanager.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "model/structures/mapreadsnapshot.h"
+
+using namespace FIFE;
+
+// the cell area holds the min and max coordinates, 40 rows are three bands
+static const Rect CELL_AREA(0, 0, 3, 39);
+
+struct SnapshotEnvironment {
+	SnapshotEnvironment():
+		map("map", 0, std::vector<RendererBase*>()),
+		object("object", "test_nspace") {
+		ground = createLayer("ground");
+		top = createLayer("top");
+		map.setReadSnapshotsEnabled(true);
+	}
+
+	Layer* createLayer(const std::string& id) {
+		Layer* layer = map.createLayer(id, &grid);
+		layer->setWalkable(true);
+		layer->createCellCache();
+		layer->getCellCache()->createCells(0);
+		layer->getCellCache()->resize(CELL_AREA);
+		layer->getCellCache()->setStaticSize(true);
+		return layer;
+	}
+
+	std::shared_ptr<const MapReadSnapshot> update() {
+		map.update();
+		return map.getReadSnapshot();
+	}
+
+	// the map update needs the time
+	TimeManager timeManager;
+	SquareGrid grid;
+	Map map;
+	Object object;
+	Layer* ground;
+	Layer* top;
+};
+
+TEST(mapreadsnapshot_unchanged_map) {
+	SnapshotEnvironment env;
+	env.ground->createInstance(&env.object, ModelCoordinate(1, 1));
+	std::shared_ptr<const MapReadSnapshot> first = env.update();
+	std::shared_ptr<const MapReadSnapshot> second = env.update();
+	CHECK(first && second);
+	CHECK_EQUAL(first->getVersion() + 1, second->getVersion());
+	CHECK_EQUAL(2u, static_cast<uint32_t>(second->getLayers().size()));
+
+	const LayerReadSnapshot* ground = second->getLayer("ground");
+	CHECK(ground != 0);
+	CHECK(second->getLayer("unknown") == 0);
+	CHECK(ground->sharesInstances(*first->getLayer("ground")));
+	CHECK_EQUAL(3u, ground->getCellBandCount());
+	for (uint32_t band = 0; band < ground->getCellBandCount(); ++band) {
+		CHECK(ground->sharesCellBand(*first->getLayer("ground"), band));
+		CHECK(second->getLayer("top")->sharesCellBand(*first->getLayer("top"), band));
+	}
+}
+
+TEST(mapreadsnapshot_changed_band) {
+	SnapshotEnvironment env;
+	std::shared_ptr<const MapReadSnapshot> first = env.update();
+
+	// only the middle band of the ground layer changes
+	CellCache* cache = env.ground->getCellCache();
+	cache->setCostMultiplier(cache->getCell(ModelCoordinate(3, 20)), 2.0);
+	std::shared_ptr<const MapReadSnapshot> second = env.update();
+
+	const LayerReadSnapshot* oldGround = first->getLayer("ground");
+	const LayerReadSnapshot* ground = second->getLayer("ground");
+	CHECK(ground->sharesCellBand(*oldGround, 0));
+	CHECK(!ground->sharesCellBand(*oldGround, 1));
+	CHECK(ground->sharesCellBand(*oldGround, 2));
+	CHECK(ground->sharesInstances(*oldGround));
+	for (uint32_t band = 0; band < 3; ++band) {
+		CHECK(second->getLayer("top")->sharesCellBand(*first->getLayer("top"), band));
+	}
+	// the old snapshot keeps its values
+	CHECK_CLOSE(2.0, ground->getCellCostMultiplier(ModelCoordinate(3, 20)), 0.0001);
+	CHECK_CLOSE(1.0, oldGround->getCellCostMultiplier(ModelCoordinate(3, 20)), 0.0001);
+
+	// a new cell type changes the band too
+	cache->getCell(ModelCoordinate(0, 39))->setCellType(CTYPE_CELL_BLOCKER);
+	std::shared_ptr<const MapReadSnapshot> third = env.update();
+	CHECK(third->getLayer("ground")->sharesCellBand(*ground, 1));
+	CHECK(!third->getLayer("ground")->sharesCellBand(*ground, 2));
+	CHECK(third->getLayer("ground")->isCellBlocking(ModelCoordinate(0, 39)));
+	CHECK(!ground->isCellBlocking(ModelCoordinate(0, 39)));
+
+	// a resize copies all bands
+	cache->resize(Rect(0, 0, 4, 39));
+	std::shared_ptr<const MapReadSnapshot> fourth = env.update();
+	for (uint32_t band = 0; band < 3; ++band) {
+		CHECK(!fourth->getLayer("ground")->sharesCellBand(*third->getLayer("ground"), band));
+	}
+	CHECK_EQUAL(4, fourth->getLayer("ground")->getCellArea().w);
+}
+
+TEST(mapreadsnapshot_changed_instances) {
+	SnapshotEnvironment env;
+	env.ground->createInstance(&env.object, ModelCoordinate(1, 1));
+	env.top->createInstance(&env.object, ModelCoordinate(2, 2));
+	std::shared_ptr<const MapReadSnapshot> first = env.update();
+
+	env.top->createInstance(&env.object, ModelCoordinate(3, 2));
+	std::shared_ptr<const MapReadSnapshot> second = env.update();
+	CHECK(second->getLayer("ground")->sharesInstances(*first->getLayer("ground")));
+	CHECK(!second->getLayer("top")->sharesInstances(*first->getLayer("top")));
+	CHECK_EQUAL(1u, static_cast<uint32_t>(first->getLayer("top")->getInstances().size()));
+	CHECK_EQUAL(2u, static_cast<uint32_t>(second->getLayer("top")->getInstances().size()));
+}
+
+TEST(mapreadsnapshot_instances_in) {
+	SnapshotEnvironment env;
+	env.ground->createInstance(&env.object, ModelCoordinate(1, 1));
+	env.ground->createInstance(&env.object, ModelCoordinate(2, 1));
+	env.ground->createInstance(&env.object, ModelCoordinate(1, 2));
+	env.ground->createInstance(&env.object, ModelCoordinate(3, 3));
+	std::shared_ptr<const MapReadSnapshot> snapshot = env.update();
+	const LayerReadSnapshot* ground = snapshot->getLayer("ground");
+
+	CHECK_EQUAL(1u, static_cast<uint32_t>(ground->getInstancesAt(ModelCoordinate(1, 1)).size()));
+	CHECK_EQUAL(0u, static_cast<uint32_t>(ground->getInstancesAt(ModelCoordinate(0, 0)).size()));
+	// width and height are exclusive
+	CHECK_EQUAL(1u, static_cast<uint32_t>(ground->getInstancesIn(Rect(1, 1, 1, 1)).size()));
+	CHECK_EQUAL(3u, static_cast<uint32_t>(ground->getInstancesIn(Rect(1, 1, 2, 2)).size()));
+	CHECK_EQUAL(4u, static_cast<uint32_t>(ground->getInstancesIn(Rect(0, 0, 4, 4)).size()));
+	CHECK_EQUAL(0u, static_cast<uint32_t>(ground->getInstancesIn(Rect(1, 1, 0, 0)).size()));
+	std::vector<InstanceReadState> row = ground->getInstancesIn(Rect(0, 1, 4, 1));
+	CHECK_EQUAL(2u, static_cast<uint32_t>(row.size()));
+	if (row.size() == 2) {
+		CHECK_EQUAL(1, row[0].cell.x);
+		CHECK_EQUAL(2, row[1].cell.x);
+	}
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
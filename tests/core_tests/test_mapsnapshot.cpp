@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/time/timemanager.h"
+#include "loaders/native/map/mapsnapshotloader.h"
+#include "model/model.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "savers/native/map/mapsnapshotsaver.h"
+#include "vfs/vfs.h"
+#include "vfs/vfsdirectory.h"
+
+using namespace FIFE;
+
+static const std::string SNAPSHOT_FILE = "mapsnapshot_test.fsnap";
+
+struct SnapshotFileEnvironment {
+	SnapshotFileEnvironment():
+		model(0, std::vector<RendererBase*>()) {
+		vfs.addSource(new VFSDirectory(&vfs));
+		object = model.createObject("object", "test_nspace");
+		map = model.createMap("map");
+		layer = map->createLayer("layer", &grid);
+	}
+
+	~SnapshotFileEnvironment() {
+		std::remove(SNAPSHOT_FILE.c_str());
+	}
+
+	// instances on a square with the given width
+	void createInstances(uint32_t count, int32_t width) {
+		for (uint32_t i = 0; i < count; ++i) {
+			layer->createInstance(object, ModelCoordinate(i % width, i / width));
+		}
+	}
+
+	TimeManager timeManager;
+	VFS vfs;
+	// the layers use the grid, so the model is destroyed first
+	SquareGrid grid;
+	Model model;
+	Object* object;
+	Map* map;
+	Layer* layer;
+};
+
+static uint32_t getMilliseconds(std::chrono::high_resolution_clock::time_point start,
+	std::chrono::high_resolution_clock::time_point end) {
+	return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+}
+
+TEST(mapsnapshot_round_trip) {
+	SnapshotFileEnvironment env;
+	Instance* saved = env.layer->createInstance(env.object, ModelCoordinate(2, 3), "saved");
+	saved->setRotation(90);
+	saved->setCellStackPosition(3);
+	env.createInstances(10, 5);
+	env.map->setTimeMultiplier(2.0);
+	MapSnapshotSaver().save(*env.map, SNAPSHOT_FILE);
+
+	// changes after the save are dropped by the load
+	env.layer->createInstance(env.object, ModelCoordinate(7, 7), "unsaved");
+	env.map->setTimeMultiplier(1.0);
+
+	MapSnapshotLoader loader(&env.model, &env.vfs);
+	CHECK(loader.isLoadable(SNAPSHOT_FILE));
+	loader.load(env.map, SNAPSHOT_FILE);
+	CHECK_EQUAL(11u, static_cast<uint32_t>(env.layer->getInstances().size()));
+	CHECK(env.layer->getInstance("unsaved") == 0);
+	Instance* loaded = env.layer->getInstance("saved");
+	CHECK(loaded != 0);
+	CHECK_EQUAL(90, loaded->getRotation());
+	CHECK_EQUAL(3, static_cast<int32_t>(loaded->getCellStackPosition()));
+	CHECK_EQUAL(ModelCoordinate(2, 3), loaded->getLocationRef().getLayerCoordinates());
+	CHECK_CLOSE(2.0, env.map->getTimeMultiplier(), 0.001);
+}
+
+TEST(mapsnapshot_benchmark) {
+	const uint32_t count = 100000;
+	SnapshotFileEnvironment env;
+	env.createInstances(count, 400);
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	MapSnapshotSaver().save(*env.map, SNAPSHOT_FILE);
+	std::chrono::high_resolution_clock::time_point middle = std::chrono::high_resolution_clock::now();
+	MapSnapshotLoader(&env.model, &env.vfs).load(env.map, SNAPSHOT_FILE);
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+	CHECK_EQUAL(count, static_cast<uint32_t>(env.layer->getInstances().size()));
+	std::cout << count << " instances: snapshot save " << getMilliseconds(start, middle)
+		<< " ms, load " << getMilliseconds(middle, end) << " ms" << std::endl;
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,191 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <set>
+#include <thread>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/objectpool.h"
+
+using namespace FIFE;
+
+// every test uses its own type, so it gets a fresh pool
+template<int32_t N>
+struct Pooled {
+	static void* operator new(std::size_t size) {
+		return ObjectPool<Pooled<N> >::instance().allocate(size);
+	}
+
+	static void operator delete(void* ptr, std::size_t size) {
+		ObjectPool<Pooled<N> >::instance().deallocate(ptr, size);
+	}
+
+	double value[4];
+};
+
+struct DerivedPooled : public Pooled<4> {
+	double extra[8];
+};
+
+TEST(test_alloc_free) {
+	typedef Pooled<1> Type;
+	ObjectPool<Type>& pool = ObjectPool<Type>::instance();
+	pool.setChunkSize(4);
+	CHECK_EQUAL(0u, pool.getCapacity());
+
+	Type* a = new Type();
+	Type* b = new Type();
+	CHECK(a != b);
+	ObjectPoolStats stats = pool.getStats();
+	CHECK_EQUAL(2u, stats.used);
+	CHECK_EQUAL(2u, stats.peak);
+	CHECK_EQUAL(4u, stats.capacity);
+	CHECK_EQUAL(1u, stats.chunks);
+	CHECK_EQUAL(4u, stats.chunkSize);
+	CHECK_EQUAL(2u, stats.allocations);
+
+	delete a;
+	delete b;
+	CHECK_EQUAL(0u, pool.getUsedCount());
+	CHECK_EQUAL(2u, pool.getPeakCount());
+	CHECK_EQUAL(2u, pool.getAllocationCount());
+
+	// deleting a null pointer is a no-op
+	Type* none = 0;
+	delete none;
+	CHECK_EQUAL(0u, pool.getUsedCount());
+}
+
+TEST(test_reuse) {
+	typedef Pooled<2> Type;
+	ObjectPool<Type>& pool = ObjectPool<Type>::instance();
+	pool.setChunkSize(4);
+
+	Type* first = new Type();
+	delete first;
+	// the last freed slot is handed out first
+	Type* second = new Type();
+	CHECK(first == second);
+	delete second;
+
+	// steady state churn never takes more memory from the heap
+	for (int32_t i = 0; i < 1000; ++i) {
+		Type* a = new Type();
+		Type* b = new Type();
+		delete a;
+		delete b;
+	}
+	CHECK_EQUAL(1u, pool.getChunkCount());
+	CHECK_EQUAL(4u, pool.getCapacity());
+	CHECK_EQUAL(2u, pool.getPeakCount());
+	CHECK_EQUAL(2002u, pool.getAllocationCount());
+	CHECK_EQUAL(0u, pool.getUsedCount());
+}
+
+TEST(test_growth) {
+	typedef Pooled<3> Type;
+	ObjectPool<Type>& pool = ObjectPool<Type>::instance();
+	pool.setChunkSize(4);
+
+	std::vector<Type*> objects;
+	for (int32_t i = 0; i < 6; ++i) {
+		objects.push_back(new Type());
+	}
+	CHECK_EQUAL(2u, pool.getChunkCount());
+	CHECK_EQUAL(8u, pool.getCapacity());
+
+	// chunks can differ in size
+	pool.setChunkSize(16);
+	for (int32_t i = 0; i < 4; ++i) {
+		objects.push_back(new Type());
+	}
+	CHECK_EQUAL(3u, pool.getChunkCount());
+	CHECK_EQUAL(24u, pool.getCapacity());
+	CHECK_EQUAL(10u, pool.getUsedCount());
+
+	// all objects got their own slot
+	std::set<Type*> unique(objects.begin(), objects.end());
+	CHECK_EQUAL(objects.size(), unique.size());
+
+	for (std::vector<Type*>::iterator it = objects.begin(); it != objects.end(); ++it) {
+		delete *it;
+	}
+	CHECK_EQUAL(0u, pool.getUsedCount());
+	CHECK_EQUAL(10u, pool.getPeakCount());
+	CHECK_EQUAL(24u, pool.getCapacity());
+}
+
+TEST(test_other_size) {
+	ObjectPool<Pooled<4> >& pool = ObjectPool<Pooled<4> >::instance();
+
+	// derived classes are bigger, they go to the global heap
+	DerivedPooled* derived = new DerivedPooled();
+	CHECK_EQUAL(0u, pool.getUsedCount());
+	CHECK_EQUAL(0u, pool.getAllocationCount());
+	CHECK_EQUAL(0u, pool.getChunkCount());
+	delete derived;
+	CHECK_EQUAL(0u, pool.getUsedCount());
+}
+
+TEST(test_threads) {
+	typedef Pooled<5> Type;
+	ObjectPool<Type>& pool = ObjectPool<Type>::instance();
+	const int32_t threadCount = 4;
+	const int32_t rounds = 10000;
+
+	std::vector<std::thread> threads;
+	for (int32_t t = 0; t < threadCount; ++t) {
+		threads.push_back(std::thread([&pool]() {
+			for (int32_t i = 0; i < rounds; ++i) {
+				Type* obj = new Type();
+				obj->value[0] = i;
+				// the counters are read under the lock while the others allocate
+				pool.getUsedCount();
+				pool.getStats();
+				delete obj;
+			}
+		}));
+	}
+	for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it) {
+		it->join();
+	}
+
+	ObjectPoolStats stats = pool.getStats();
+	CHECK_EQUAL(0u, stats.used);
+	CHECK(stats.peak <= static_cast<uint32_t>(threadCount));
+	CHECK_EQUAL(static_cast<uint64_t>(threadCount * rounds), stats.allocations);
+	CHECK_EQUAL(1u, stats.chunks);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
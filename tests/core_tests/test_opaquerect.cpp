@@ -0,0 +1,150 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/rect.h"
+#include "video/image.h"
+
+using namespace FIFE;
+
+// Image without a render backend, subimages share the surface like a GLImage of an atlas
+class TestImage : public Image {
+public:
+	TestImage(SDL_Surface* surface): Image(surface) {}
+	TestImage(): Image() {}
+
+	virtual void invalidate() {}
+	virtual void render(const Rect&, uint8_t = 255, uint8_t const* = 0) {}
+	virtual void setSurface(SDL_Surface* surface) { reset(surface); }
+	virtual void useSharedImage(const ImagePtr& shared, const Rect& region) {
+		m_surface = shared->getSurface();
+		m_shared = true;
+		m_subimagerect = region;
+	}
+	virtual void forceLoadInternal() {}
+};
+
+// transparent 32 bit surface
+static SDL_Surface* createSurface(int32_t width, int32_t height) {
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, RMASK, GMASK, BMASK, AMASK);
+	SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, 0, 0, 0, 0));
+	return surface;
+}
+
+static void fill(SDL_Surface* surface, int32_t x, int32_t y, int32_t w, int32_t h, uint8_t alpha) {
+	SDL_Rect rect;
+	rect.x = x;
+	rect.y = y;
+	rect.w = w;
+	rect.h = h;
+	SDL_FillRect(surface, &rect, SDL_MapRGBA(surface->format, 255, 255, 255, alpha));
+}
+
+static bool isRect(const Rect& rect, int32_t x, int32_t y, int32_t w, int32_t h) {
+	return rect.x == x && rect.y == y && rect.w == w && rect.h == h;
+}
+
+TEST(opaquerect_opaque) {
+	SDL_Surface* surface = createSurface(20, 10);
+	fill(surface, 0, 0, 20, 10, 255);
+	TestImage image(surface);
+	CHECK(isRect(image.getOpaqueRect(), 0, 0, 20, 10));
+
+	// without an alpha channel every pixel is opaque
+	TestImage rgb(SDL_CreateRGBSurface(0, 7, 5, 32, RMASK, GMASK, BMASK, 0));
+	CHECK(isRect(rgb.getOpaqueRect(), 0, 0, 7, 5));
+}
+
+TEST(opaquerect_transparent) {
+	TestImage image(createSurface(8, 8));
+	const Rect& opaque = image.getOpaqueRect();
+	CHECK_EQUAL(0, opaque.w);
+	CHECK_EQUAL(0, opaque.h);
+
+	TestImage empty;
+	CHECK_EQUAL(0, empty.getOpaqueRect().w);
+}
+
+TEST(opaquerect_partially_transparent) {
+	SDL_Surface* surface = createSurface(16, 12);
+	// a wide and a tall opaque block, the wide one is larger
+	fill(surface, 1, 2, 12, 3, 255);
+	fill(surface, 10, 0, 2, 12, 255);
+	// semi transparent pixels do not count
+	fill(surface, 0, 6, 16, 6, 254);
+	TestImage image(surface);
+	CHECK(isRect(image.getOpaqueRect(), 1, 2, 12, 3));
+
+	// a hole in the block splits it
+	fill(surface, 4, 3, 1, 1, 0);
+	TestImage holed(image.detachSurface());
+	CHECK(isRect(holed.getOpaqueRect(), 5, 2, 8, 3));
+}
+
+TEST(opaquerect_surface_change) {
+	SDL_Surface* surface = createSurface(4, 4);
+	fill(surface, 0, 0, 2, 2, 255);
+	TestImage image(surface);
+	CHECK(isRect(image.getOpaqueRect(), 0, 0, 2, 2));
+
+	// a new surface is scanned again on the next call
+	SDL_Surface* replaced = createSurface(6, 6);
+	fill(replaced, 1, 1, 5, 4, 255);
+	image.setSurface(replaced);
+	CHECK(isRect(image.getOpaqueRect(), 1, 1, 5, 4));
+}
+
+TEST(opaquerect_atlas_subimage) {
+	SDL_Surface* surface = createSurface(32, 16);
+	// opaque block of the first subimage reaches into the second one
+	fill(surface, 2, 4, 20, 6, 255);
+	ImagePtr atlas(new TestImage(surface));
+
+	TestImage first;
+	first.useSharedImage(atlas, Rect(0, 0, 16, 16));
+	// relative to the subimage and clipped to it
+	CHECK(isRect(first.getOpaqueRect(), 2, 4, 14, 6));
+
+	TestImage second;
+	second.useSharedImage(atlas, Rect(16, 8, 16, 8));
+	CHECK(isRect(second.getOpaqueRect(), 0, 0, 6, 2));
+
+	// a region outside of the atlas has no opaque area
+	TestImage outside;
+	outside.useSharedImage(atlas, Rect(40, 0, 8, 8));
+	CHECK_EQUAL(0, outside.getOpaqueRect().w);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "video/color.h"
+#include "view/visual.h"
+
+using namespace FIFE;
+
+// 32 bit surface with R, G, B, A bytes, like Image::createRGBASurface
+static SDL_Surface* createSurface(int32_t width, int32_t height) {
+	return SDL_CreateRGBSurface(0, width, height, 32, RMASK, GMASK, BMASK, AMASK);
+}
+
+static void setPixel(SDL_Surface* surface, int32_t x, int32_t y, const Color& color) {
+	uint8_t* p = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch + x * 4;
+	p[0] = color.getR();
+	p[1] = color.getG();
+	p[2] = color.getB();
+	p[3] = color.getAlpha();
+}
+
+static bool isPixel(SDL_Surface* surface, int32_t x, int32_t y, const Color& color) {
+	const uint8_t* p = static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch + x * 4;
+	return p[0] == color.getR() && p[1] == color.getG() && p[2] == color.getB() && p[3] == color.getAlpha();
+}
+
+TEST(overlaycolors_recolor) {
+	OverlayColors colors;
+	colors.changeColor(Color(255, 0, 0, 255), Color(0, 0, 255, 255));
+	colors.changeColor(Color(0, 255, 0, 255), Color(10, 20, 30, 40));
+
+	SDL_Surface* surface = createSurface(5, 2);
+	setPixel(surface, 0, 0, Color(255, 0, 0, 255));
+	setPixel(surface, 1, 0, Color(255, 0, 0, 255));
+	setPixel(surface, 2, 0, Color(0, 255, 0, 255));
+	// the alpha is part of the color
+	setPixel(surface, 3, 0, Color(255, 0, 0, 128));
+	setPixel(surface, 4, 0, Color(1, 2, 3, 4));
+	// runs of equal pixels across rows
+	for (int32_t x = 0; x < 5; ++x) {
+		setPixel(surface, x, 1, Color(0, 255, 0, 255));
+	}
+	setPixel(surface, 2, 1, Color(1, 2, 3, 4));
+
+	colors.recolor(surface);
+	CHECK(isPixel(surface, 0, 0, Color(0, 0, 255, 255)));
+	CHECK(isPixel(surface, 1, 0, Color(0, 0, 255, 255)));
+	CHECK(isPixel(surface, 2, 0, Color(10, 20, 30, 40)));
+	CHECK(isPixel(surface, 3, 0, Color(255, 0, 0, 128)));
+	CHECK(isPixel(surface, 4, 0, Color(1, 2, 3, 4)));
+	CHECK(isPixel(surface, 0, 1, Color(10, 20, 30, 40)));
+	CHECK(isPixel(surface, 1, 1, Color(10, 20, 30, 40)));
+	CHECK(isPixel(surface, 2, 1, Color(1, 2, 3, 4)));
+	CHECK(isPixel(surface, 3, 1, Color(10, 20, 30, 40)));
+	CHECK(isPixel(surface, 4, 1, Color(10, 20, 30, 40)));
+	SDL_FreeSurface(surface);
+}
+
+TEST(overlaycolors_changed_colors) {
+	OverlayColors colors;
+	SDL_Surface* surface = createSurface(2, 1);
+	setPixel(surface, 0, 0, Color(255, 0, 0, 255));
+	setPixel(surface, 1, 0, Color(0, 255, 0, 255));
+
+	// no colors, nothing changes
+	colors.recolor(surface);
+	CHECK(colors.getPackedColors().empty());
+	CHECK(isPixel(surface, 0, 0, Color(255, 0, 0, 255)));
+
+	// the lookup is rebuilt after a change
+	colors.changeColor(Color(255, 0, 0, 255), Color(1, 1, 1, 255));
+	colors.recolor(surface);
+	CHECK(isPixel(surface, 0, 0, Color(1, 1, 1, 255)));
+	CHECK(isPixel(surface, 1, 0, Color(0, 255, 0, 255)));
+
+	colors.changeColor(Color(0, 255, 0, 255), Color(2, 2, 2, 255));
+	colors.changeColor(Color(1, 1, 1, 255), Color(3, 3, 3, 255));
+	CHECK_EQUAL(static_cast<size_t>(6), colors.getPackedColors().size());
+	colors.recolor(surface);
+	CHECK(isPixel(surface, 0, 0, Color(3, 3, 3, 255)));
+	CHECK(isPixel(surface, 1, 0, Color(2, 2, 2, 255)));
+
+	colors.resetColors();
+	CHECK(colors.getPackedColors().empty());
+	colors.recolor(surface);
+	CHECK(isPixel(surface, 0, 0, Color(3, 3, 3, 255)));
+	SDL_FreeSurface(surface);
+}
+
+TEST(overlaycolors_packed_colors) {
+	// equal maps give equal packed colors, independent of the insert order
+	OverlayColors a;
+	a.changeColor(Color(1, 0, 0, 255), Color(2, 0, 0, 255));
+	a.changeColor(Color(0, 1, 0, 255), Color(0, 2, 0, 255));
+	OverlayColors b;
+	b.changeColor(Color(0, 1, 0, 255), Color(0, 2, 0, 255));
+	b.changeColor(Color(1, 0, 0, 255), Color(9, 9, 9, 255));
+	b.changeColor(Color(1, 0, 0, 255), Color(2, 0, 0, 255));
+	CHECK(a.getPackedColors() == b.getPackedColors());
+	CHECK_EQUAL(static_cast<size_t>(4), a.getPackedColors().size());
+}
+
+TEST(overlaycolors_probes) {
+	// enough colors that slots of the hash table collide
+	const int32_t count = 256;
+	OverlayColors colors;
+	for (int32_t i = 0; i < count; ++i) {
+		colors.changeColor(Color(i, (i * 7) & 255, (i * 13) & 255, 255), Color(255 - i, i, 0, 255));
+	}
+	SDL_Surface* surface = createSurface(count, 2);
+	for (int32_t i = 0; i < count; ++i) {
+		setPixel(surface, i, 0, Color(i, (i * 7) & 255, (i * 13) & 255, 255));
+		// unmapped colors whose probes run through the used slots
+		setPixel(surface, i, 1, Color(i, (i * 7) & 255, (i * 13) & 255, 254));
+	}
+	colors.recolor(surface);
+	bool mapped = true;
+	bool unmapped = true;
+	for (int32_t i = 0; i < count; ++i) {
+		mapped = mapped && isPixel(surface, i, 0, Color(255 - i, i, 0, 255));
+		unmapped = unmapped && isPixel(surface, i, 1, Color(i, (i * 7) & 255, (i * 13) & 255, 254));
+	}
+	CHECK(mapped);
+	CHECK(unmapped);
+	SDL_FreeSurface(surface);
+}
+
+TEST(overlaycolors_probe_wrap) {
+	// the sources hash to the last of the 16 slots, so the probes wrap to the first slots
+	const Color sources[3] = { Color(0, 3, 0, 255), Color(0, 17, 0, 255), Color(0, 26, 0, 255) };
+	OverlayColors colors;
+	for (int32_t i = 0; i < 3; ++i) {
+		colors.changeColor(sources[i], Color(100 + i, 0, 0, 255));
+	}
+	SDL_Surface* surface = createSurface(4, 1);
+	for (int32_t i = 0; i < 3; ++i) {
+		setPixel(surface, i, 0, sources[i]);
+	}
+	// unmapped, hashes to the last slot too and probes until the free slot
+	setPixel(surface, 3, 0, Color(0, 0, 14, 255));
+	colors.recolor(surface);
+	CHECK(isPixel(surface, 0, 0, Color(100, 0, 0, 255)));
+	CHECK(isPixel(surface, 1, 0, Color(101, 0, 0, 255)));
+	CHECK(isPixel(surface, 2, 0, Color(102, 0, 0, 255)));
+	CHECK(isPixel(surface, 3, 0, Color(0, 0, 14, 255)));
+	SDL_FreeSurface(surface);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/math/fife_math.h"
+#include "util/structures/radixsort.h"
+
+using namespace FIFE;
+
+// stand-in for a render item, z is the screenpoint z
+struct SortItem {
+	double z;
+	int32_t stackpos;
+};
+
+// the comparison function of the camera sorting strategy
+struct SortItemCompare {
+	bool operator()(SortItem* const & lhs, SortItem* const & rhs) const {
+		if (Mathd::Equal(lhs->z, rhs->z)) {
+			return lhs->stackpos < rhs->stackpos;
+		}
+		return lhs->z < rhs->z;
+	}
+};
+
+static double randomValue(int32_t range) {
+	return static_cast<double>(rand() % range - range / 2) / 4.0;
+}
+
+static std::vector<SortItem*> createItems(uint32_t count) {
+	std::vector<SortItem*> items;
+	for (uint32_t i = 0; i < count; ++i) {
+		SortItem* item = new SortItem();
+		item->z = randomValue(count / 4 + 2);
+		item->stackpos = rand() % 3;
+		items.push_back(item);
+	}
+	std::random_shuffle(items.begin(), items.end());
+	return items;
+}
+
+static void deleteItems(std::vector<SortItem*>& items) {
+	for (uint32_t i = 0; i < items.size(); ++i) {
+		delete items[i];
+	}
+	items.clear();
+}
+
+static void radixSortItems(std::vector<SortItem*>& items, std::vector<RadixSortEntry>& entries,
+	std::vector<RadixSortEntry>& scratch) {
+	entries.resize(items.size());
+	for (uint32_t i = 0; i < items.size(); ++i) {
+		entries[i].primary = radixKey(items[i]->z);
+		entries[i].secondary = 0;
+		entries[i].tertiary = radixKey(items[i]->stackpos);
+		entries[i].index = i;
+	}
+	radixSort(entries, scratch);
+	std::vector<SortItem*> sorted(items.size());
+	for (uint32_t i = 0; i < entries.size(); ++i) {
+		sorted[i] = items[entries[i].index];
+	}
+	items.swap(sorted);
+}
+
+TEST(radix_key_order) {
+	double values[] = { -1e300, -2.5, -1.0, -DBL_MIN, 0.0, DBL_MIN, 0.5, 1.0, 3.25, 1e300 };
+	for (uint32_t i = 1; i < sizeof(values) / sizeof(values[0]); ++i) {
+		CHECK(radixKey(values[i - 1]) < radixKey(values[i]));
+	}
+	CHECK(radixKey(-0.0) == radixKey(0.0));
+
+	int32_t ints[] = { -2147483647 - 1, -5, -1, 0, 1, 7, 2147483647 };
+	for (uint32_t i = 1; i < sizeof(ints) / sizeof(ints[0]); ++i) {
+		CHECK(radixKey(ints[i - 1]) < radixKey(ints[i]));
+	}
+}
+
+TEST(radix_sort_is_stable) {
+	uint32_t sizes[] = { 10, 100, 5000 };
+	for (uint32_t s = 0; s < 3; ++s) {
+		std::vector<RadixSortEntry> entries(sizes[s]);
+		for (uint32_t i = 0; i < entries.size(); ++i) {
+			entries[i].primary = radixKey(randomValue(16));
+			entries[i].secondary = radixKey(static_cast<int32_t>(rand() % 4));
+			entries[i].tertiary = radixKey(static_cast<int32_t>(rand() % 3 - 1));
+			entries[i].index = i;
+		}
+		std::vector<RadixSortEntry> expected(entries);
+		std::stable_sort(expected.begin(), expected.end());
+		std::vector<RadixSortEntry> scratch;
+		radixSort(entries, scratch);
+
+		CHECK_EQUAL(expected.size(), entries.size());
+		for (uint32_t i = 0; i < entries.size(); ++i) {
+			CHECK_EQUAL(expected[i].index, entries[i].index);
+		}
+	}
+}
+
+TEST(radix_sort_benchmark) {
+	uint32_t sizes[] = { 10000, 50000, 100000 };
+	std::vector<RadixSortEntry> entries;
+	std::vector<RadixSortEntry> scratch;
+	for (uint32_t s = 0; s < 3; ++s) {
+		std::vector<SortItem*> items = createItems(sizes[s]);
+		std::vector<SortItem*> compared(items);
+		std::vector<SortItem*> radix(items);
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		std::stable_sort(compared.begin(), compared.end(), SortItemCompare());
+		std::chrono::high_resolution_clock::time_point middle = std::chrono::high_resolution_clock::now();
+		radixSortItems(radix, entries, scratch);
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		CHECK(compared == radix);
+		std::cout << sizes[s] << " items: stable_sort "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count() << " us, radix sort "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() << " us" << std::endl;
+		deleteItems(items);
+	}
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
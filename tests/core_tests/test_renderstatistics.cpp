@@ -0,0 +1,127 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <string>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/base/fife_stdint.h"
+#include "view/renderstatistics.h"
+
+using namespace FIFE;
+
+static RenderStatistic makeStatistic(const std::string& layer, const std::string& renderer,
+	uint32_t items, uint32_t culled, uint32_t drawCalls) {
+	RenderStatistic statistic;
+	statistic.layer = layer;
+	statistic.renderer = renderer;
+	statistic.milliseconds = 1.5;
+	statistic.items = items;
+	statistic.culled = culled;
+	statistic.counters.drawCalls = drawCalls;
+	return statistic;
+}
+
+TEST(renderstatistics_merge_same_entry) {
+	RenderStatistics statistics;
+	statistics.addStatistic(makeStatistic("ground", "InstanceRenderer", 100, 20, 3));
+	// a second batch of the same renderer
+	statistics.addStatistic(makeStatistic("ground", "InstanceRenderer", 50, 20, 2));
+	statistics.addStatistic(makeStatistic("ground", "GridRenderer", 150, 0, 1));
+
+	CHECK_EQUAL(2u, statistics.getStatisticCount());
+	const RenderStatistic& first = statistics.getStatistic(0);
+	CHECK_EQUAL(150u, first.items);
+	CHECK_EQUAL(20u, first.culled);
+	CHECK_EQUAL(5u, first.counters.drawCalls);
+	CHECK_CLOSE(3.0, first.milliseconds, 0.0001);
+	CHECK_EQUAL(std::string("GridRenderer"), statistics.getStatistic(1).renderer);
+}
+
+TEST(renderstatistics_total_static_layer) {
+	RenderStatistics statistics;
+	// renderStaticLayer records the tile update before the renderers of the layer
+	statistics.addStatistic(makeStatistic("ground", "tiles", 4, 0, 4));
+	statistics.addStatistic(makeStatistic("ground", "InstanceRenderer", 9, 30, 9));
+	statistics.addStatistic(makeStatistic("ground", "CoordinateRenderer", 70, 30, 1));
+	statistics.setCulled("ground", 30);
+	statistics.addStatistic(makeStatistic("objects", "InstanceRenderer", 40, 12, 6));
+	statistics.addStatistic(makeStatistic("objects", "FloatingTextRenderer", 45, 7, 2));
+	statistics.setCulled("objects", 12);
+	statistics.addStatistic(makeStatistic("", "overlay", 0, 0, 1));
+
+	RenderStatistic total = statistics.getTotal();
+	CHECK_EQUAL(168u, total.items);
+	CHECK_EQUAL(42u, total.culled);
+	CHECK_EQUAL(23u, total.counters.drawCalls);
+	CHECK_CLOSE(9.0, total.milliseconds, 0.0001);
+	CHECK_EQUAL(30u, statistics.getCulled("ground"));
+	CHECK_EQUAL(0u, statistics.getCulled("unknown"));
+
+	// the value of the last render of the layer counts
+	statistics.setCulled("objects", 2);
+	CHECK_EQUAL(32u, statistics.getTotal().culled);
+
+	statistics.clear();
+	CHECK_EQUAL(0u, statistics.getStatisticCount());
+	CHECK_EQUAL(0u, statistics.getTotal().culled);
+	CHECK_EQUAL(0u, statistics.getCulled("ground"));
+}
+
+TEST(renderstatistics_index_overflow) {
+	RenderStatistics statistics;
+	statistics.addStatistic(makeStatistic("ground", "InstanceRenderer", 1, 0, 1));
+	CHECK_THROW(statistics.getStatistic(1), IndexOverflow);
+}
+
+TEST(renderstatistics_json) {
+	RenderStatistics statistics;
+	CHECK_EQUAL(std::string("[]"), statistics.toJson());
+
+	RenderStatistic statistic = makeStatistic("layer \"1\"\\", "InstanceRenderer", 3, 1, 2);
+	statistic.milliseconds = 0.5;
+	statistic.counters.vertices = 12;
+	statistic.counters.textureBinds = 1;
+	statistics.addStatistic(statistic);
+	statistic = makeStatistic("", "overlay", 0, 0, 0);
+	statistic.milliseconds = 0.25;
+	statistics.addStatistic(statistic);
+
+	CHECK_EQUAL(std::string("[{\"layer\": \"layer \\\"1\\\"\\\\\", \"renderer\": \"InstanceRenderer\", "
+		"\"milliseconds\": 0.5, \"items\": 3, \"culled\": 1, \"draw_calls\": 2, \"vertices\": 12, "
+		"\"texture_binds\": 1, \"render_target_switches\": 0, \"flushes\": 0}, "
+		"{\"layer\": \"\", \"renderer\": \"overlay\", \"milliseconds\": 0.25, \"items\": 0, "
+		"\"culled\": 0, \"draw_calls\": 0, \"vertices\": 0, \"texture_binds\": 0, "
+		"\"render_target_switches\": 0, \"flushes\": 0}]"), statistics.toJson());
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,246 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cmath>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/point.h"
+#include "util/structures/rect.h"
+#include "video/imagemanager.h"
+#include "video/sdl/renderbackendsdl.h"
+#include "view/rendertilecache.h"
+
+using namespace FIFE;
+
+// The tile images are created by the render backend, it does not need a window for that
+struct TileEnvironment {
+	RenderBackendSDL backend;
+	ImageManager manager;
+
+	TileEnvironment():
+		backend(SDL_Color()) {
+	}
+};
+
+typedef std::vector<RenderTileCache::Tile*> TileList;
+
+static RenderTileCache::Tile* findTile(const TileList& tiles, int32_t x, int32_t y) {
+	for (TileList::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+		if ((*it)->x == x && (*it)->y == y) {
+			return *it;
+		}
+	}
+	return 0;
+}
+
+static void markClean(const TileList& tiles) {
+	for (TileList::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+		(*it)->dirty = false;
+	}
+}
+
+TEST(rendertilecache_update) {
+	TileEnvironment env;
+	RenderTileCache cache(64);
+	CHECK_EQUAL(64u, cache.getImageSize());
+	CHECK_EQUAL(64.0, cache.getTileSize());
+
+	// the range includes the tiles at the right and bottom edge
+	const TileList& tiles = cache.update(Rect(0, 0, 100, 30));
+	CHECK_EQUAL(2u, tiles.size());
+	CHECK(findTile(tiles, 0, 0) != 0);
+	CHECK(findTile(tiles, 1, 0) != 0);
+	for (TileList::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+		CHECK((*it)->dirty);
+		CHECK_EQUAL(64u, (*it)->image->getWidth());
+		CHECK_EQUAL(64u, (*it)->image->getHeight());
+	}
+	CHECK_EQUAL(2u, env.manager.getTotalResources());
+
+	// negative coordinates round down
+	const TileList& negative = cache.update(Rect(-1, -65, 1, 1));
+	CHECK_EQUAL(4u, negative.size());
+	CHECK(findTile(negative, -1, -2) != 0);
+	CHECK(findTile(negative, 0, -1) != 0);
+	CHECK(cache.getVisibleTiles() == negative);
+}
+
+TEST(rendertilecache_pan) {
+	TileEnvironment env;
+	RenderTileCache cache(64);
+	TileList first = cache.update(Rect(0, 0, 127, 63));
+	CHECK_EQUAL(2u, first.size());
+	markClean(first);
+	ImagePtr image = findTile(first, 1, 0)->image;
+
+	// a small pan keeps the tiles
+	TileList panned = cache.update(Rect(10, 0, 117, 63));
+	CHECK(panned == first);
+
+	// a bigger pan reuses the overlapping tiles, only the new one has to be rendered
+	panned = cache.update(Rect(64, 0, 127, 63));
+	CHECK_EQUAL(2u, panned.size());
+	RenderTileCache::Tile* reused = findTile(panned, 1, 0);
+	CHECK(reused == findTile(first, 1, 0));
+	CHECK(!reused->dirty);
+	CHECK(reused->image == image);
+	CHECK(findTile(panned, 2, 0)->dirty);
+	// the tile that left the view is still cached
+	CHECK_EQUAL(3u, env.manager.getTotalResources());
+	TileList back = cache.update(Rect(0, 0, 127, 63));
+	CHECK(!findTile(back, 0, 0)->dirty);
+}
+
+TEST(rendertilecache_zoom) {
+	TileEnvironment env;
+	RenderTileCache cache(64);
+	markClean(cache.update(Rect(0, 0, 127, 127)));
+	CHECK_EQUAL(4u, env.manager.getTotalResources());
+
+	// the same size keeps the tiles
+	cache.setTileSize(64.0);
+	CHECK_EQUAL(4u, cache.getVisibleTiles().size());
+
+	// zooming changes the virtual size of the tiles, all of them are removed
+	cache.setTileSize(32.0);
+	CHECK_EQUAL(32.0, cache.getTileSize());
+	CHECK(cache.getVisibleTiles().empty());
+	CHECK_EQUAL(0u, env.manager.getTotalResources());
+
+	// the images keep their size, the tiles cover less virtual space
+	const TileList& tiles = cache.update(Rect(0, 0, 63, 63));
+	CHECK_EQUAL(4u, tiles.size());
+	CHECK(findTile(tiles, 1, 1)->dirty);
+	CHECK_EQUAL(64u, findTile(tiles, 1, 1)->image->getWidth());
+}
+
+TEST(rendertilecache_eviction) {
+	TileEnvironment env;
+	RenderTileCache cache(64);
+	markClean(cache.update(Rect(0, 0, 10, 10)));
+	CHECK_EQUAL(1u, env.manager.getTotalResources());
+
+	// kept while it was not visible for TILE_KEEP_UPDATES updates
+	for (uint32_t i = 0; i < RenderTileCache::TILE_KEEP_UPDATES - 1; ++i) {
+		cache.update(Rect(1000, 1000, 10, 10));
+	}
+	CHECK_EQUAL(2u, env.manager.getTotalResources());
+	TileList tiles = cache.update(Rect(0, 0, 10, 10));
+	CHECK(!tiles[0]->dirty);
+
+	// removed with its image after that
+	for (uint32_t i = 0; i < RenderTileCache::TILE_KEEP_UPDATES + 1; ++i) {
+		cache.update(Rect(1000, 1000, 10, 10));
+	}
+	CHECK_EQUAL(1u, env.manager.getTotalResources());
+	tiles = cache.update(Rect(0, 0, 10, 10));
+	CHECK(tiles[0]->dirty);
+}
+
+TEST(rendertilecache_invalidate) {
+	TileEnvironment env;
+	RenderTileCache cache(64);
+	TileList tiles = cache.update(Rect(0, 0, 191, 63));
+	CHECK_EQUAL(3u, tiles.size());
+	markClean(tiles);
+
+	cache.invalidate(Rect(70, 10, 5, 5));
+	CHECK(!findTile(tiles, 0, 0)->dirty);
+	CHECK(findTile(tiles, 1, 0)->dirty);
+	CHECK(!findTile(tiles, 2, 0)->dirty);
+
+	// areas bigger than the cache and empty areas
+	markClean(tiles);
+	cache.invalidate(Rect(-1000, -1000, 1100, 1100));
+	CHECK(findTile(tiles, 0, 0)->dirty);
+	CHECK(findTile(tiles, 1, 0)->dirty);
+	CHECK(!findTile(tiles, 2, 0)->dirty);
+	markClean(tiles);
+	cache.invalidate(Rect(0, 0, 0, 10));
+	CHECK(!findTile(tiles, 0, 0)->dirty);
+
+	cache.invalidate();
+	CHECK(findTile(tiles, 0, 0)->dirty);
+	CHECK(findTile(tiles, 2, 0)->dirty);
+
+	cache.clear();
+	CHECK(cache.getVisibleTiles().empty());
+	CHECK_EQUAL(0u, env.manager.getTotalResources());
+}
+
+TEST(rendertilecache_tile_area) {
+	RenderTileCache cache(256);
+	cache.setTileSize(256 / 1.5);
+	RenderTileCache::Tile tile;
+	tile.x = 1;
+	tile.y = -1;
+	DoublePoint origin = cache.getTileOrigin(tile);
+	CHECK_CLOSE(170.667, origin.x, 0.001);
+	CHECK_CLOSE(-170.667, origin.y, 0.001);
+
+	// the area covers the whole tile, neighbours overlap by the rounding
+	Rect area = cache.getTileArea(tile);
+	CHECK(area == Rect(170, -171, 172, 171));
+	RenderTileCache::Tile next = tile;
+	next.x = 2;
+	CHECK_EQUAL(341, cache.getTileArea(next).x);
+}
+
+TEST(rendertilecache_screen_origin) {
+	RenderTileCache cache(256);
+	RenderTileCache::Tile tile;
+	tile.x = -1;
+	tile.y = 2;
+	Point base(10, -20);
+	CHECK(cache.getScreenOrigin(tile, base) == Point(-246, 492));
+
+	// the tile size follows the zoom, the screen origin is the zoomed virtual origin
+	const double zooms[] = { 0.5, 1.0, 1.5, 2.0, 3.0 };
+	for (uint32_t i = 0; i < 5; ++i) {
+		cache.setTileSize(cache.getImageSize() / zooms[i]);
+		for (int32_t y = -3; y <= 3; ++y) {
+			for (int32_t x = -3; x <= 3; ++x) {
+				tile.x = x;
+				tile.y = y;
+				DoublePoint virtualOrigin = cache.getTileOrigin(tile);
+				Point origin = cache.getScreenOrigin(tile, base);
+				CHECK_EQUAL(static_cast<int32_t>(std::floor(base.x + virtualOrigin.x * zooms[i] + 0.5)), origin.x);
+				CHECK_EQUAL(static_cast<int32_t>(std::floor(base.y + virtualOrigin.y * zooms[i] + 0.5)), origin.y);
+			}
+		}
+	}
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/structures/smallvector.h"
+
+using namespace FIFE;
+
+typedef SmallVector<int32_t*, 2> PointerVector;
+
+static int32_t values[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+static bool hasValues(const PointerVector& vector, uint32_t first, uint32_t count) {
+	if (vector.size() != count) {
+		return false;
+	}
+	for (uint32_t i = 0; i < count; ++i) {
+		if (vector[i] != &values[first + i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(smallvector_inline) {
+	PointerVector vector;
+	CHECK(vector.empty());
+	CHECK_EQUAL(2u, vector.capacity());
+	vector.push_back(&values[0]);
+	vector.push_back(&values[1]);
+	CHECK_EQUAL(2u, vector.size());
+	CHECK_EQUAL(2u, vector.capacity());
+	CHECK(vector.front() == &values[0]);
+	CHECK(vector.back() == &values[1]);
+	// a single inline element shares its storage with the heap pointer
+	CHECK(sizeof(SmallVector<int32_t*, 1>) == sizeof(int32_t*) + 8);
+}
+
+TEST(smallvector_grow) {
+	PointerVector vector;
+	for (uint32_t i = 0; i < 8; ++i) {
+		vector.push_back(&values[i]);
+	}
+	CHECK(hasValues(vector, 0, 8));
+	CHECK_EQUAL(8u, vector.capacity());
+
+	// the heap memory is kept
+	vector.clear();
+	CHECK(vector.empty());
+	CHECK_EQUAL(8u, vector.capacity());
+	vector.push_back(&values[3]);
+	CHECK(hasValues(vector, 3, 1));
+
+	PointerVector reserved;
+	reserved.reserve(5);
+	CHECK_EQUAL(5u, reserved.capacity());
+	reserved.reserve(3);
+	CHECK_EQUAL(5u, reserved.capacity());
+}
+
+TEST(smallvector_erase) {
+	PointerVector vector;
+	for (uint32_t i = 0; i < 5; ++i) {
+		vector.push_back(&values[i]);
+	}
+	// keeps the order of the other elements
+	PointerVector::iterator it = vector.erase(vector.begin() + 1);
+	CHECK(*it == &values[2]);
+	CHECK_EQUAL(4u, vector.size());
+	CHECK(vector[0] == &values[0]);
+	CHECK(vector[1] == &values[2]);
+	CHECK(vector[3] == &values[4]);
+	it = vector.erase(vector.end() - 1);
+	CHECK(it == vector.end());
+	CHECK_EQUAL(3u, vector.size());
+
+	SmallVector<int32_t*, 1> single;
+	single.push_back(&values[7]);
+	single.erase(single.begin());
+	CHECK(single.empty());
+}
+
+TEST(smallvector_copy) {
+	PointerVector small;
+	small.push_back(&values[1]);
+	PointerVector large;
+	for (uint32_t i = 2; i < 7; ++i) {
+		large.push_back(&values[i]);
+	}
+
+	PointerVector copy(large);
+	CHECK(hasValues(copy, 2, 5));
+	// the copy has its own memory
+	copy[0] = &values[0];
+	CHECK(large[0] == &values[2]);
+
+	// heap to inline and inline to heap
+	copy = small;
+	CHECK(hasValues(copy, 1, 1));
+	PointerVector other(small);
+	other = large;
+	CHECK(hasValues(other, 2, 5));
+	PointerVector& same = other;
+	other = same;
+	CHECK(hasValues(other, 2, 5));
+
+	uint32_t count = 0;
+	for (PointerVector::const_iterator cit = large.begin(); cit != large.end(); ++cit) {
+		CHECK(*cit == &values[2 + count]);
+		++count;
+	}
+	CHECK_EQUAL(5u, count);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,205 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/filesystem/convenience.hpp>
+#include <tinyxml.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "loaders/native/map/xmldocumentcache.h"
+#include "vfs/vfs.h"
+#include "vfs/vfsdirectory.h"
+#include "vfs/raw/rawdata.h"
+
+using namespace FIFE;
+
+static const std::string CACHE_TEST_DIR = "xmlcachetestdir";
+static const uint32_t FILE_COUNT = 64;
+
+// directory source that remembers the threads it is used from
+class ThreadRecordingDirectory : public VFSDirectory {
+public:
+	ThreadRecordingDirectory(VFS* vfs): VFSDirectory(vfs) {}
+
+	virtual bool fileExists(const std::string& filename) const {
+		record();
+		return VFSDirectory::fileExists(filename);
+	}
+
+	virtual RawData* open(const std::string& filename) const {
+		record();
+		return VFSDirectory::open(filename);
+	}
+
+	virtual RawData* openMapped(const std::string& filename) const {
+		record();
+		++mappedCount;
+		return VFSDirectory::openMapped(filename);
+	}
+
+	void record() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		threads.insert(std::this_thread::get_id());
+	}
+
+	mutable std::mutex mutex;
+	mutable std::set<std::thread::id> threads;
+	mutable uint32_t mappedCount = 0;
+};
+
+static std::string fileName(uint32_t index) {
+	std::ostringstream name;
+	name << CACHE_TEST_DIR << "/object" << index << ".xml";
+	return name.str();
+}
+
+// writes FILE_COUNT object files with growing sizes, returns their total size
+static uint64_t writeFiles() {
+	boost::filesystem::remove_all(CACHE_TEST_DIR);
+	boost::filesystem::create_directory(CACHE_TEST_DIR);
+	uint64_t size = 0;
+	for (uint32_t i = 0; i < FILE_COUNT; ++i) {
+		std::ostringstream content;
+		content << "<?fife type=\"object\"?>\n<object id=\"object" << i << "\" namespace=\"test\">\n";
+		for (uint32_t j = 0; j < i * 16; ++j) {
+			content << "\t<action id=\"action" << j << "\" />\n";
+		}
+		content << "</object>\n";
+		std::ofstream file(fileName(i).c_str(), std::ios::binary);
+		file << content.str();
+		size += content.str().size();
+	}
+	return size;
+}
+
+TEST(test_prefetch) {
+	uint64_t size = writeFiles();
+	{
+		std::ofstream file((CACHE_TEST_DIR + "/broken.xml").c_str(), std::ios::binary);
+		file << "<object id=\"broken\">";
+	}
+	{
+		VFS vfs;
+		ThreadRecordingDirectory* source = new ThreadRecordingDirectory(&vfs);
+		vfs.addSource(source);
+
+		std::vector<std::string> files;
+		for (uint32_t i = 0; i < FILE_COUNT; ++i) {
+			files.push_back(fileName(i));
+		}
+		files.push_back(fileName(0));
+		files.push_back(CACHE_TEST_DIR + "/broken.xml");
+		files.push_back(CACHE_TEST_DIR + "/missing.xml");
+
+		XmlDocumentCache cache(&vfs);
+		cache.prefetch(files);
+
+		for (uint32_t i = 0; i < FILE_COUNT; ++i) {
+			TiXmlDocument* document = cache.get(fileName(i));
+			CHECK(document != 0);
+			if (!document) {
+				continue;
+			}
+			TiXmlElement* root = document->RootElement();
+			CHECK(root != 0);
+			std::ostringstream id;
+			id << "object" << i;
+			CHECK_EQUAL(id.str(), std::string(root->Attribute("id")));
+			uint32_t actions = 0;
+			for (TiXmlElement* action = root->FirstChildElement("action"); action; action = action->NextSiblingElement("action")) {
+				++actions;
+			}
+			CHECK_EQUAL(i * 16, actions);
+		}
+		// failed files are left to the loader
+		CHECK(cache.get(CACHE_TEST_DIR + "/broken.xml") == 0);
+		CHECK(cache.get(CACHE_TEST_DIR + "/missing.xml") == 0);
+
+		// the duplicate is opened once, all files are mapped
+		CHECK_EQUAL(FILE_COUNT + 1, source->mappedCount);
+		CHECK_EQUAL(size + 20, vfs.getBytesRead());
+
+		// the vfs is only used from the calling thread
+		CHECK_EQUAL(1u, source->threads.size());
+		CHECK(source->threads.count(std::this_thread::get_id()) == 1);
+
+		// cached files are not read again
+		cache.prefetch(files);
+		CHECK_EQUAL(FILE_COUNT + 2, source->mappedCount);
+		CHECK_EQUAL(size + 40, vfs.getBytesRead());
+	}
+	boost::filesystem::remove_all(CACHE_TEST_DIR);
+}
+
+TEST(test_prefetch_single) {
+	writeFiles();
+	{
+		VFS vfs;
+		vfs.addSource(new VFSDirectory(&vfs));
+		XmlDocumentCache cache(&vfs);
+		// a single file is parsed without the worker pool
+		cache.prefetch(std::vector<std::string>(1, fileName(3)));
+		CHECK(cache.get(fileName(3)) != 0);
+		CHECK(cache.get(fileName(4)) == 0);
+	}
+	boost::filesystem::remove_all(CACHE_TEST_DIR);
+}
+
+TEST(test_list_import_files) {
+	writeFiles();
+	boost::filesystem::create_directories(CACHE_TEST_DIR + "/nested/.svn");
+	{
+		std::ofstream nested((CACHE_TEST_DIR + "/nested/atlas.xml").c_str());
+		std::ofstream archive((CACHE_TEST_DIR + "/nested/objects.zip").c_str());
+		std::ofstream other((CACHE_TEST_DIR + "/nested/readme.txt").c_str());
+		std::ofstream svn((CACHE_TEST_DIR + "/nested/.svn/entries.xml").c_str());
+	}
+	{
+		VFS vfs;
+		vfs.addSource(new VFSDirectory(&vfs));
+		std::vector<std::string> files;
+		listImportFiles(&vfs, CACHE_TEST_DIR, files);
+		CHECK_EQUAL(FILE_COUNT + 2, files.size());
+		// the files of a directory come before the nested directories
+		CHECK_EQUAL(CACHE_TEST_DIR + "/nested/atlas.xml", files[FILE_COUNT]);
+		CHECK_EQUAL(CACHE_TEST_DIR + "/nested/objects.zip", files[FILE_COUNT + 1]);
+	}
+	boost::filesystem::remove_all(CACHE_TEST_DIR);
+}
+
+int32_t main() {
+	return UnitTest::RunAllTests();
+}
@@ -127,6 +127,29 @@ class ActionTests(unittest.TestCase):
 		self.engine.finalizePumping()
 		self.map.removeCamera("foo")
 
+	def testPoolCounters(self):
+		self.target.setLayerCoordinates(fife.ModelCoordinate(2,2))
+		self.inst.move('walk', self.target, 0.9)
+		actions = fife.Instance.getActionPoolStats()
+		routes = fife.RoutePather.getRoutePoolStats()
+		self.assertTrue(actions.used >= 1)
+		self.assertTrue(actions.used <= actions.capacity)
+		self.assertTrue(routes.used >= 1)
+		self.assertTrue(routes.peak >= routes.used)
+
+		# every move replaces the action and the route, the freed slots are reused
+		for i in range(100):
+			self.target.setLayerCoordinates(fife.ModelCoordinate(1 - i % 4, 2))
+			self.inst.move('walk', self.target, 0.9)
+		self.assertEqual(fife.Instance.getActionPoolStats().allocations, actions.allocations + 100)
+		self.assertEqual(fife.Instance.getActionPoolStats().chunks, actions.chunks)
+		self.assertEqual(fife.Instance.getActionPoolStats().used, actions.used)
+		self.assertEqual(fife.RoutePather.getRoutePoolStats().allocations, routes.allocations + 100)
+		self.assertEqual(fife.RoutePather.getRoutePoolStats().chunks, routes.chunks)
+
+		self.layer.deleteInstance(self.inst)
+		self.assertEqual(fife.Instance.getActionPoolStats().used, actions.used - 1)
+
 		
 
 TEST_CLASSES = [ActionTests]
@@ -25,6 +25,8 @@
 from __future__ import absolute_import
 from .swig_test_utils import *
 import math
+import os
+import sys
 
 
 class TestModel(unittest.TestCase):
@@ -140,6 +142,311 @@ class TestModel(unittest.TestCase):
         self.assertEqual(self.model.deleteObject(obj1), True)
         self.assertEqual(self.model.deleteObjects(), True)
 
+    def testParallelMapUpdate(self):
+        class ChangeListener(fife.InstanceChangeListener):
+            def __init__(self):
+                fife.InstanceChangeListener.__init__(self)
+                self.changes = 0
+
+            def onInstanceChanged(self, instance, info):
+                self.changes += 1
+
+        self.assertEqual(self.model.isParallelMapUpdate(), False)
+        self.model.setParallelMapUpdate(True, 2)
+        self.assertEqual(self.model.isParallelMapUpdate(), True)
+
+        grid = self.model.getCellGrid("square")
+        obj = self.model.createObject("object007", "test_nspace")
+        listeners = []
+        for i in range(4):
+            map = self.model.createMap("parallel%d" % i)
+            layer = map.createLayer("layer", grid)
+            inst = layer.createInstance(obj, fife.ModelCoordinate(i, i))
+            listener = ChangeListener()
+            inst.addChangeListener(listener)
+            inst.setRotation(90)
+            listeners.append(listener)
+
+        self.engine.initializePumping()
+        self.engine.pump()
+        self.engine.finalizePumping()
+
+        # listeners run on the main thread after the parallel part
+        for listener in listeners:
+            self.assertEqual(listener.changes, 1)
+
+        self.model.setParallelMapUpdate(False)
+        self.assertEqual(self.model.isParallelMapUpdate(), False)
+
+    def testMapSnapshot(self):
+        map = self.model.createMap("snapshot")
+        grid = self.model.getCellGrid("square")
+        obj = self.model.createObject("object008", "test_nspace")
+        walker = self.model.createObject("walker008", "test_nspace")
+        walker.setPather(self.model.getPather("RoutePather"))
+        fife.ActionVisual.create(walker.createAction("walk"))
+        layer = map.createLayer("layer", grid)
+        layer.setWalkable(True)
+        # the corners span the cellcache
+        layer.createInstance(obj, fife.ModelCoordinate(0, 0), "corner1")
+        layer.createInstance(obj, fife.ModelCoordinate(6, 6), "corner2")
+        inst = layer.createInstance(obj, fife.ModelCoordinate(2, 3), "saved")
+        inst.setRotation(90)
+        inst.setCost("road", 0.5)
+        map.initializeCellCaches()
+        map.finalizeCellCaches()
+        cache = layer.getCellCache()
+
+        # the route is searched by the pump, the mover starts to walk
+        mover = layer.createInstance(walker, fife.ModelCoordinate(0, 3), "mover")
+        target = fife.Location(layer)
+        target.setLayerCoordinates(fife.ModelCoordinate(6, 3))
+        mover.move("walk", target, 0.05)
+        self.engine.initializePumping()
+        for i in range(3):
+            self.engine.pump()
+        self.engine.finalizePumping()
+        self.assertNotEqual(mover.getRoute(), None)
+        moverCoords = mover.getLocationRef().getExactLayerCoordinates()
+
+        cell = cache.getCell(fife.ModelCoordinate(4, 4))
+        cell.setCostMultiplier(3.0)
+        cell.setCellType(fife.CTYPE_CELL_BLOCKER)
+        cache.registerCost("swamp", 4.0)
+        cache.addCellToCost("swamp", cache.getCell(fife.ModelCoordinate(1, 1)))
+        cache.addCellToArea("camp", cache.getCell(fife.ModelCoordinate(5, 1)))
+
+        controller = map.getTriggerController()
+        trigger = controller.createTriggerOnCoordinate("gate", layer, fife.ModelCoordinate(6, 3))
+        trigger.addTriggerCondition(fife.CELL_TRIGGER_ENTER)
+        trigger.enableForInstance(mover)
+        map.setTimeMultiplier(2.0)
+
+        fife.MapSnapshotSaver().save(map, "snapshot_test.fsnap")
+
+        # changes after the save are dropped by the load
+        layer.createInstance(obj, fife.ModelCoordinate(5, 5), "unsaved")
+        map.setTimeMultiplier(1.0)
+        cell.resetCostMultiplier()
+        cell.setCellType(fife.CTYPE_NO_BLOCKER)
+        cache.unregisterCost("swamp")
+        cache.removeArea("camp")
+        controller.deleteTrigger("gate")
+        controller.createTrigger("unsaved")
+
+        loader = fife.MapSnapshotLoader(self.model, self.engine.getVFS())
+        self.assertTrue(loader.isLoadable("snapshot_test.fsnap"))
+        loader.load(map, "snapshot_test.fsnap")
+
+        instances = dict((i.getId(), i) for i in layer.getInstances())
+        self.assertEqual(sorted(instances.keys()), ["corner1", "corner2", "mover", "saved"])
+        saved = instances["saved"]
+        self.assertEqual(saved.getRotation(), 90)
+        self.assertEqual(saved.getCostId(), "road")
+        self.assertEqual(map.getTimeMultiplier(), 2.0)
+
+        # the mover continues its route from the saved position
+        mover = instances["mover"]
+        self.assertEqual(mover.getCurrentAction().getId(), "walk")
+        self.assertEqual(mover.getMovementSpeed(), 0.05)
+        self.assertNotEqual(mover.getRoute(), None)
+        self.assertEqual(mover.getTargetLocation().getLayerCoordinates(), fife.ModelCoordinate(6, 3))
+        coords = mover.getLocationRef().getExactLayerCoordinates()
+        self.assertAlmostEqual(coords.x, moverCoords.x)
+        self.assertAlmostEqual(coords.y, moverCoords.y)
+
+        cell = cache.getCell(fife.ModelCoordinate(4, 4))
+        self.assertEqual(cell.getCostMultiplier(), 3.0)
+        self.assertEqual(cell.getCellType(), fife.CTYPE_CELL_BLOCKER)
+        self.assertEqual(cache.getCost("swamp"), 4.0)
+        costCells = cache.getCostCells("swamp")
+        self.assertEqual(len(costCells), 1)
+        self.assertEqual(costCells[0].getLayerCoordinates(), fife.ModelCoordinate(1, 1))
+        areaCells = cache.getAreaCells("camp")
+        self.assertEqual(len(areaCells), 1)
+        self.assertEqual(areaCells[0].getLayerCoordinates(), fife.ModelCoordinate(5, 1))
+
+        trigger = controller.getTrigger("gate")
+        self.assertNotEqual(trigger, None)
+        self.assertEqual(list(trigger.getTriggerConditions()), [fife.CELL_TRIGGER_ENTER])
+        assigned = trigger.getAssignedCells()
+        self.assertEqual(len(assigned), 1)
+        self.assertEqual(assigned[0].getLayerCoordinates(), fife.ModelCoordinate(6, 3))
+        self.assertEqual([i.getId() for i in trigger.getEnabledInstances()], ["mover"])
+        self.assertEqual(controller.getTrigger("unsaved"), None)
+        os.remove("snapshot_test.fsnap")
+
+    def _instancePositions(self, map):
+        positions = []
+        for layer in map.getLayers():
+            for inst in layer.getInstances():
+                coords = inst.getLocationRef().getExactLayerCoordinates()
+                positions.append((layer.getId(), inst.getObject().getId(), coords.x, coords.y, coords.z))
+        return sorted(positions)
+
+    def testBinaryMapRoundTrip(self):
+        # entries without object advance the implicit position as well
+        with open("roundtrip_test.xml", "w") as f:
+            f.write("""<?xml version="1.0" encoding="ascii"?>
+<map id="roundtrip" format="1.0">
+    <layer id="ground" grid_type="square" x_offset="0.0" y_offset="0.0" x_scale="1.0" y_scale="1.0" rotation="0.0" pathing="cell_edges_only">
+        <instances>
+            <i o="tile" ns="roundtrip" x="0" y="0"/>
+            <i o="tile"/>
+            <i/>
+            <i x="10"/>
+            <i o="tile"/>
+            <i o="tile" y="3"/>
+            <i o="missing" ns="roundtrip"/>
+            <i o="tile" z="1"/>
+        </instances>
+    </layer>
+    <layer id="top" grid_type="square" x_offset="0.0" y_offset="0.0" x_scale="1.0" y_scale="1.0" rotation="0.0" pathing="cell_edges_only">
+        <instances>
+            <i o="tile"/>
+            <i/>
+            <i o="tile" x="-2" y="-2"/>
+            <i/>
+            <i o="tile"/>
+        </instances>
+    </layer>
+</map>
+""")
+        sys.path.insert(0, "tools")
+        try:
+            import map_compiler
+        finally:
+            sys.path.remove("tools")
+        map_compiler.MapCompiler().compile("roundtrip_test.xml", "roundtrip_test.bmap")
+
+        self.model.createObject("tile", "roundtrip")
+        vfs = self.engine.getVFS()
+        imageManager = self.engine.getImageManager()
+        renderBackend = self.engine.getRenderBackend()
+
+        map = fife.MapLoader(self.model, vfs, imageManager, renderBackend).load("roundtrip_test.xml")
+        xmlPositions = self._instancePositions(map)
+        self.model.deleteMap(map)
+
+        loader = fife.BinaryMapLoader(self.model, vfs, imageManager, renderBackend)
+        self.assertTrue(loader.isLoadable("roundtrip_test.bmap"))
+        map = loader.load("roundtrip_test.bmap")
+        binaryPositions = self._instancePositions(map)
+
+        os.remove("roundtrip_test.xml")
+        os.remove("roundtrip_test.bmap")
+        self.assertEqual(len(xmlPositions), 8)
+        self.assertEqual(xmlPositions, binaryPositions)
+        self.assertTrue(("ground", "tile", 11.0, 0.0, 0.0) in xmlPositions)
+        self.assertTrue(("ground", "tile", 14.0, 3.0, 1.0) in xmlPositions)
+        self.assertTrue(("top", "tile", 0.0, -2.0, 0.0) in xmlPositions)
+
+    def testLayerJournal(self):
+        map = self.model.createMap("journal")
+        grid = self.model.getCellGrid("square")
+        obj = self.model.createObject("object009", "test_nspace")
+        layer = map.createLayer("layer", grid)
+        journal = layer.getJournal()
+        self.assertFalse(journal.isEnabled())
+        layer.createInstance(obj, fife.ModelCoordinate(0, 0), "unrecorded")
+        self.assertEqual(journal.getSequence(), 0)
+
+        journal.setCapacity(4)
+        self.assertTrue(journal.isEnabled())
+        cursor = journal.getSequence()
+        layer.createInstance(obj, fife.ModelCoordinate(1, 1), "first")
+        second = layer.createInstance(obj, fife.ModelCoordinate(2, 2), "second")
+        secondId = second.getFifeId()
+        layer.deleteInstance(second)
+
+        entries = fife.LayerJournalEntryVector()
+        cursor = journal.read(cursor, 0, entries)
+        self.assertEqual(cursor, 3)
+        self.assertEqual(len(entries), 3)
+        self.assertEqual(entries[0].events, fife.LJ_CREATE)
+        self.assertEqual(entries[0].instance.getId(), "first")
+        self.assertEqual(entries[2].events, fife.LJ_DELETE)
+        self.assertEqual(entries[2].instanceId, secondId)
+        # entries of a deleted instance do not point to it anymore
+        self.assertEqual(entries[1].instance, None)
+
+        # a reader that falls behind more than the capacity loses entries
+        for i in range(3):
+            layer.createInstance(obj, fife.ModelCoordinate(3, i), "more%d" % i)
+        self.assertEqual(journal.getOldestSequence(), 2)
+        self.assertTrue(journal.isLost(0))
+        self.assertFalse(journal.isLost(cursor))
+        entries.clear()
+        self.assertEqual(journal.read(cursor, 2, entries), 5)
+        self.assertEqual(len(entries), 2)
+
+        # deleting all instances clears every stored instance pointer
+        layer.deleteInstances()
+        entries.clear()
+        journal.read(journal.getOldestSequence(), 0, entries)
+        self.assertEqual(len(entries), 4)
+        for entry in entries:
+            self.assertEqual(entry.events, fife.LJ_DELETE)
+            self.assertEqual(entry.instance, None)
+
+    def testLazyObjectLoading(self):
+        with open("lazy_objects_test.xml", "w") as f:
+            f.write('<?fife type="object"?>\n<assets>\n'
+                    '\t<object id="lazy_a" namespace="lazy_nspace" blocking="1" static="1"/>\n'
+                    '\t<object id="lazy_b" namespace="lazy_nspace" blocking="0" static="1"/>\n'
+                    '\t<object id="lazy_c" namespace="lazy_nspace" blocking="0" static="0"/>\n'
+                    '</assets>\n')
+
+        loader = fife.ObjectLoader(self.model, self.engine.getVFS(),
+            self.engine.getImageManager(), self.engine.getAnimationManager())
+        loader.setLazyLoading(True)
+        self.assertTrue(loader.isLazyLoading())
+        loader.load("lazy_objects_test.xml")
+
+        # only the ids are known until the objects are requested
+        self.assertTrue(self.model.isObjectDeferred("lazy_a", "lazy_nspace"))
+        self.assertEqual(len(self.model.getObjects("lazy_nspace")), 0)
+
+        obj = self.model.getObject("lazy_a", "lazy_nspace")
+        self.assertTrue(obj)
+        self.assertTrue(obj.isBlocking())
+        self.assertFalse(self.model.isObjectDeferred("lazy_a", "lazy_nspace"))
+        self.assertEqual(len(self.model.getObjects("lazy_nspace")), 1)
+
+        self.model.preloadObjects("lazy_nspace", ["lazy_b"])
+        self.assertFalse(self.model.isObjectDeferred("lazy_b", "lazy_nspace"))
+        self.assertTrue(self.model.isObjectDeferred("lazy_c", "lazy_nspace"))
+        self.model.preloadObjects("lazy_nspace")
+        self.assertEqual(len(self.model.getObjects("lazy_nspace")), 3)
+
+        # deleted objects can be deferred again by loading the file a second time
+        self.assertTrue(self.model.deleteObjects())
+        loader.load("lazy_objects_test.xml")
+        self.assertTrue(self.model.isObjectDeferred("lazy_c", "lazy_nspace"))
+        self.assertTrue(self.model.deleteObjects())
+        self.assertFalse(self.model.isObjectDeferred("lazy_c", "lazy_nspace"))
+        loader.load("lazy_objects_test.xml")
+        self.assertTrue(self.model.getObject("lazy_c", "lazy_nspace"))
+        os.remove("lazy_objects_test.xml")
+
+    def testObjectLoaderOutlivesModel(self):
+        with open("lazy_objects_test.xml", "w") as f:
+            f.write('<?fife type="object"?>\n<assets>\n'
+                    '\t<object id="lazy_a" namespace="lazy_nspace" blocking="1" static="1"/>\n'
+                    '</assets>\n')
+
+        loader = fife.ObjectLoader(self.model, self.engine.getVFS(),
+            self.engine.getImageManager(), self.engine.getAnimationManager())
+        loader.setLazyLoading(True)
+        loader.load("lazy_objects_test.xml")
+        self.assertTrue(self.model.isObjectDeferred("lazy_a", "lazy_nspace"))
+        os.remove("lazy_objects_test.xml")
+
+        # the model goes first and the loader must not call back into it
+        self.engine.destroy()
+        del loader
+        self.engine = getEngine(True)
+
 
 class TestActionAngles(unittest.TestCase):
     def setUp(self):
@@ -37,6 +37,18 @@ class MyTimeEvent(fife.TimeEvent):
 		print("testing timer event... %d, %d" % (curtime, self.counter))
 		self.counter += 1
 
+class RecordingTimeEvent(fife.TimeEvent):
+	def __init__(self, manager, period, oneshot=False):
+		fife.TimeEvent.__init__(self, period)
+		self.manager = manager
+		self.oneshot = oneshot
+		self.times = []
+
+	def updateEvent(self, timedelta):
+		self.times.append(self.manager.getTime())
+		if self.oneshot:
+			self.manager.unregisterEvent(self)
+
 class TestTimer(unittest.TestCase):
 	def setUp(self):
 		self.engine = getEngine(True)
@@ -55,6 +67,93 @@ class TestTimer(unittest.TestCase):
 
 		self.timemanager.unregisterEvent(e)
 
+	def testUnregisterDuringUpdate(self):
+		class SelfRemovingEvent(fife.TimeEvent):
+			def __init__(self, manager):
+				fife.TimeEvent.__init__(self, 0)
+				self.manager = manager
+				self.counter = 0
+
+			def updateEvent(self, curtime):
+				self.counter += 1
+				self.manager.unregisterEvent(self)
+
+		e = SelfRemovingEvent(self.timemanager)
+		self.timemanager.registerEvent(e)
+
+		for i in range(3):
+			time.sleep(0.01)
+			self.timemanager.update()
+
+		self.assertEqual(e.counter, 1)
+
+	def _startTime(self):
+		# 56ms before a 65536ms boundary, so the first steps wrap the lowest wheel
+		# level and the next level at once
+		start = (self.timemanager.getTime() // 65536 + 2) * 65536 - 56
+		self.timemanager.update(start)
+		return start
+
+	def _step(self, start, end):
+		for time in range(start + 1, end + 1):
+			self.timemanager.update(time)
+
+	def testPeriodicWheelLevels(self):
+		start = self._startTime()
+		# level 0 holds 256ms, level 1 65536ms
+		periods = [1, 255, 256, 257, 1000, 65535, 65536, 70000]
+		events = [RecordingTimeEvent(self.timemanager, period) for period in periods]
+		for e in events:
+			self.timemanager.registerEvent(e)
+
+		end = start + 140001
+		self._step(start, end)
+
+		for period, e in zip(periods, events):
+			expected = list(range(start + period, end + 1, period))
+			self.assertEqual(e.times, expected, "period %d" % period)
+			self.timemanager.unregisterEvent(e)
+
+	def testOneShotWheelLevels(self):
+		start = self._startTime()
+		delays = [1, 255, 256, 300, 65535, 65536, 70000]
+		events = [RecordingTimeEvent(self.timemanager, delay, True) for delay in delays]
+		for e in events:
+			self.timemanager.registerEvent(e)
+
+		self._step(start, start + 80000)
+
+		for delay, e in zip(delays, events):
+			self.assertEqual(e.times, [start + delay], "delay %d" % delay)
+
+	def testRegisterAcrossLevels(self):
+		start = self._startTime()
+		e = RecordingTimeEvent(self.timemanager, 300)
+		# registered in the middle of a level 0 round, with a fire time in the next round
+		self._step(start, start + 200)
+		e.setLastUpdateTime(start + 200)
+		self.timemanager.registerEvent(e)
+		self._step(start + 200, start + 1500)
+		self.assertEqual(e.times, [start + 500, start + 800, start + 1100, start + 1400])
+
+		# a new period is used from the last update on
+		e.setPeriod(1000)
+		self._step(start + 1500, start + 3000)
+		self.assertEqual(e.times[4:], [start + 2400])
+		self.timemanager.unregisterEvent(e)
+
+	def testLongGap(self):
+		start = self._startTime()
+		e = RecordingTimeEvent(self.timemanager, 1000)
+		self.timemanager.registerEvent(e)
+
+		# gaps beyond the two lower levels rebuild the wheel, the event fires once
+		self.timemanager.update(start + 100000)
+		self.assertEqual(e.times, [start + 100000])
+		self._step(start + 100000, start + 102000)
+		self.assertEqual(e.times, [start + 100000, start + 101000, start + 102000])
+		self.timemanager.unregisterEvent(e)
+
 TEST_CLASSES = [TestTimer]
 
 if __name__ == '__main__':
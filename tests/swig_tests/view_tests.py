@@ -27,7 +27,22 @@ from __future__ import absolute_import
 from builtins import str
 from builtins import range
 from .swig_test_utils import *
+from fife.extensions.serializers.xmlanimation import loadXMLAnimation
+import os
+import struct
 import time
+import zlib
+
+def writeOpaquePng(filename, width, height):
+	"""Writes a white RGBA png without transparent pixels"""
+	def chunk(tag, data):
+		return struct.pack('>I', len(data)) + tag + data + struct.pack('>I', zlib.crc32(tag + data) & 0xffffffff)
+	rows = b''.join(b'\x00' + b'\xff' * (width * 4) for y in range(height))
+	with open(filename, 'wb') as f:
+		f.write(b'\x89PNG\r\n\x1a\n')
+		f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 6, 0, 0, 0)))
+		f.write(chunk(b'IDAT', zlib.compress(rows)))
+		f.write(chunk(b'IEND', b''))
 
 class TestView(unittest.TestCase):
 	
@@ -114,10 +129,203 @@ class TestView(unittest.TestCase):
 				cam.setZoom(cam.getZoom() - 0.010)
 			self.engine.pump()
 		self.engine.finalizePumping()
-	
-		
 
-TEST_CLASSES = [TestView]
+	def _statisticItems(self, cam, layer, renderer):
+		statistics = cam.getRenderStatistics()
+		for i in range(statistics.getStatisticCount()):
+			statistic = statistics.getStatistic(i)
+			if statistic.layer == layer.getId() and statistic.renderer == renderer:
+				return statistic.items
+		return None
+
+	def testOcclusionCulling(self):
+		rb = self.engine.getRenderBackend()
+		viewport = fife.Rect(0, 0, rb.getWidth(), rb.getHeight())
+
+		# big opaque instance on the upper layer hides the instance below
+		writeOpaquePng('opaque_test.png', 256, 256)
+		cover = self.model.createObject('cover', 'test_nspace')
+		fife.ObjectVisual.create(cover)
+		coverImage = self.imgMgr.load('opaque_test.png')
+		cover.get2dGfxVisual().addStaticImage(0, coverImage.getHandle())
+		os.remove('opaque_test.png')
+
+		top = self.map.createLayer("layer002", self.grid)
+		hidden = self.layer.createInstance(self.obj2, fife.ModelCoordinate(0, 0))
+		fife.InstanceVisual.create(hidden)
+		i = top.createInstance(cover, fife.ModelCoordinate(0, 0))
+		fife.InstanceVisual.create(i)
+
+		cam = self.map.addCamera("occlusion", viewport)
+		cam.setCellImageDimensions(self.screen_cell_w, self.screen_cell_h)
+		cam.setLocation(fife.Location(self.layer))
+		fife.InstanceRenderer.getInstance(cam).activateAllLayers(self.map)
+		coordinates = fife.CoordinateRenderer.getInstance(cam)
+		coordinates.activateAllLayers(self.map)
+		coordinates.setEnabled(True)
+		cam.setOcclusionCulling(True)
+		cam.setRenderStatisticsEnabled(True)
+
+		self.engine.initializePumping()
+		for i in range(3):
+			self.engine.pump()
+		self.engine.finalizePumping()
+
+		self.assertEqual(cam.getOccludedCount(), 1)
+		# only the InstanceRenderer skips the hidden instance
+		self.assertEqual(self._statisticItems(cam, self.layer, "InstanceRenderer"), 0)
+		self.assertEqual(self._statisticItems(cam, self.layer, "CoordinateRenderer"), 1)
+		self.assertEqual(self._statisticItems(cam, top, "InstanceRenderer"), 1)
+		# the InstanceRenderer drew nothing on the layer, each instance is counted once
+		# although two renderers draw the layer
+		statistics = cam.getRenderStatistics()
+		self.assertEqual(statistics.getCulled(self.layer.getId()), len(self.layer.getInstances()))
+		self.assertEqual(statistics.getTotal().culled,
+			statistics.getCulled(self.layer.getId()) + statistics.getCulled(top.getId()))
+
+	def _matchingIds(self, cam, rect):
+		return [i.getFifeId() for i in cam.getMatchingInstances(rect, self.layer)]
+
+	def testParallelUpdate(self):
+		rb = self.engine.getRenderBackend()
+		viewport = fife.Rect(0, 0, rb.getWidth(), rb.getHeight())
+
+		action = self.obj1.createAction('walk')
+		fife.ActionVisual.create(action)
+		for index, direction in enumerate(['e', 'ne', 'n', 'nw', 'w', 'sw', 's', 'se']):
+			animation = loadXMLAnimation(self.engine, 'tests/data/wolf_walk/wolf_walk_%s.xml' % direction)
+			action.get2dGfxVisual().addAnimation(45 * index, animation)
+
+		# both cameras render the same instances, one updates its layer cache in parallel
+		cams = []
+		for name, parallel in [("serial", False), ("parallel", True)]:
+			cam = self.map.addCamera(name, viewport)
+			cam.setCellImageDimensions(8, 8)
+			cam.setLocation(fife.Location(self.layer))
+			cam.setParallelUpdate(parallel, 4)
+			fife.InstanceRenderer.getInstance(cam).activateAllLayers(self.map)
+			cams.append(cam)
+
+		# enough entries for the parallel path
+		for y in range(-12, 12):
+			for x in range(-12, 12):
+				i = self.layer.createInstance(self.obj1, fife.ModelCoordinate(x, y))
+				fife.InstanceVisual.create(i)
+				i.actRepeat('walk', (x * 15 + y * 7) % 360)
+
+		self.engine.initializePumping()
+		for i in range(60):
+			for cam in cams:
+				if i > 20 and i < 30:
+					cam.setRotation(cam.getRotation() + 3)
+				elif i > 30 and i < 40:
+					cam.setZoom(cam.getZoom() + 0.05)
+			self.engine.pump()
+			self.assertEqual(self._matchingIds(cams[0], viewport), self._matchingIds(cams[1], viewport))
+			for y in range(0, viewport.h, 40):
+				for x in range(0, viewport.w, 40):
+					rect = fife.Rect(x, y, 4, 4)
+					self.assertEqual(self._matchingIds(cams[0], rect), self._matchingIds(cams[1], rect))
+		self.engine.finalizePumping()
+
+
+class TestDirtyRects(unittest.TestCase):
+
+	def setUp(self):
+		self.engine = getEngine(renderBackend='SDL')
+		self.renderbackend = self.engine.getRenderBackend()
+		self.renderbackend.setDirtyRectsEnabled(True)
+		self.model = self.engine.getModel()
+		self.map = self.model.createMap("map001")
+		grid = self.model.getCellGrid("square")
+		self.layer = self.map.createLayer("layer001", grid)
+
+		obj = self.model.createObject('0', 'test_nspace')
+		fife.ObjectVisual.create(obj)
+		img = self.engine.getImageManager().load('tests/data/earth_1.png')
+		obj.get2dGfxVisual().addStaticImage(0, img.getHandle())
+		for y in range(4):
+			for x in range(4):
+				i = self.layer.createInstance(obj, fife.ModelCoordinate(x, y))
+				fife.InstanceVisual.create(i)
+
+		# the camera covers the left half of the screen
+		self.width = self.renderbackend.getWidth()
+		self.height = self.renderbackend.getHeight()
+		self.cam = self.map.addCamera("dirty", fife.Rect(0, 0, self.width // 2, self.height))
+		self.cam.setCellImageDimensions(img.getWidth(), img.getHeight())
+		self.cam.setLocation(fife.Location(self.layer))
+		fife.InstanceRenderer.getInstance(self.cam).activateAllLayers(self.map)
+		self.cam.setRenderStatisticsEnabled(True)
+		self.engine.initializePumping()
+
+	def tearDown(self):
+		self.engine.finalizePumping()
+		self.engine.destroy()
+
+	def _rendered(self):
+		# a camera that returns early records no statistics
+		self.engine.pump()
+		return self.cam.getRenderStatistics().getStatisticCount() > 0
+
+	def _settle(self):
+		for i in range(10):
+			if not self._rendered():
+				return True
+		return False
+
+	def testSkipUndamagedCamera(self):
+		self.assertTrue(self._settle())
+		self.assertFalse(self._rendered())
+
+		# damage outside of the viewport
+		self.renderbackend.addDirtyRect(fife.Rect(self.width // 2 + 10, 10, 20, 20))
+		self.assertFalse(self._rendered())
+
+		# damage is redrawn in its frame and in the next one
+		self.renderbackend.addDirtyRect(fife.Rect(10, 10, 20, 20))
+		self.assertTrue(self._rendered())
+		self.assertTrue(self._rendered())
+		self.assertFalse(self._rendered())
+
+		# moving the camera redraws its viewport
+		self.cam.setRotation(self.cam.getRotation() + 10)
+		self.assertTrue(self._rendered())
+		self.assertTrue(self._settle())
+
+	def testRendererChanges(self):
+		coordinates = fife.CoordinateRenderer.getInstance(self.cam)
+		coordinates.activateAllLayers(self.map)
+		self.assertTrue(self._settle())
+
+		coordinates.setEnabled(True)
+		self.assertTrue(self._rendered())
+		self.assertTrue(self._settle())
+
+		coordinates.removeActiveLayer(self.layer)
+		self.assertTrue(self._rendered())
+		self.assertTrue(self._settle())
+
+		coordinates.setEnabled(False)
+		self.assertTrue(self._rendered())
+
+	def testRendererContentIsNotTracked(self):
+		generic = fife.GenericRenderer.getInstance(self.cam)
+		generic.addActiveLayer(self.layer)
+		generic.setEnabled(True)
+		self.assertTrue(self._settle())
+
+		# content changes of a renderer are not reported, the caller has to report them
+		location = fife.Location(self.layer)
+		location.setLayerCoordinates(fife.ModelCoordinate(1, 1))
+		generic.addPoint("points", fife.RendererNode(location), 255, 0, 0)
+		self.assertFalse(self._rendered())
+
+		self.renderbackend.addDirtyRect(self.cam.getViewPort())
+		self.assertTrue(self._rendered())
+		generic.removeAll("points")
+
+TEST_CLASSES = [TestView, TestDirtyRects]
 
 if __name__ == '__main__':
     unittest.main()
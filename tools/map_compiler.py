@@ -0,0 +1,349 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# ####################################################################
+#  Copyright (C) 2005-2019 by the FIFE team
+#  http://www.fifengine.net
+#  This file is part of FIFE.
+#
+#  FIFE is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU Lesser General Public
+#  License as published by the Free Software Foundation; either
+#  version 2.1 of the License, or (at your option) any later version.
+#
+#  This library is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#  Lesser General Public License for more details.
+#
+#  You should have received a copy of the GNU Lesser General Public
+#  License along with this library; if not, write to the
+#  Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+# ####################################################################
+
+""" Compiles xml map files into the binary map format of the BinaryMapLoader.
+
+The binary map holds the same data as the xml map, with all defaults and attribute
+fallbacks resolved, so the engine can map the file into memory and create the
+instances without any text parsing. Object, animation and atlas imports stay xml
+files and are referenced by the compiled map.
+
+The layout is documented in engine/core/loaders/native/map/binarymapformat.h,
+keep both in sync.
+
+Usage: map_compiler.py map.xml [output.bmap]
+"""
+
+from __future__ import print_function
+
+import os
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+MAGIC = b'FIFEBMAP'
+VERSION = 1
+END = 0x444E4521
+NO_STRING = 0xFFFFFFFF
+
+INSTANCE_ROTATION = 0x01
+INSTANCE_STACKPOS = 0x02
+INSTANCE_CELLSTACK = 0x04
+INSTANCE_COST = 0x08
+
+CELL_COST = 0x01
+CELL_SPEED = 0x02
+CELL_NARROW = 0x04
+
+CAMERA_ZTOY = 0x01
+CAMERA_VIEWPORT = 0x02
+
+PATHING = {'cell_edges_and_diagonals': 1}
+SORTING = {'location': 1, 'camera_and_location': 2}
+LAYER_TYPE = {'walkable': 1, 'interact': 2}
+CELL_BLOCKER = {'no_blocker': 1, 'blocker': 2}
+
+
+def to_int(value, default=0):
+	""" Same behaviour as the integer attribute queries of TinyXML """
+	if value is None:
+		return default
+	try:
+		return int(float(value))
+	except ValueError:
+		return default
+
+
+def to_float(value, default=0.0):
+	if value is None:
+		return default
+	try:
+		return float(value)
+	except ValueError:
+		return default
+
+
+class MapWriter(object):
+	""" Collects the packed data and the interned strings of a map """
+	def __init__(self):
+		self.strings = []
+		self.string_index = {}
+		self.data = []
+
+	def string(self, value):
+		""" Returns the index of the interned string, NO_STRING for None """
+		if value is None:
+			return NO_STRING
+		index = self.string_index.get(value)
+		if index is None:
+			index = len(self.strings)
+			self.strings.append(value)
+			self.string_index[value] = index
+		return index
+
+	def pack(self, fmt, *values):
+		self.data.append(struct.pack('<' + fmt, *values))
+
+	def str(self, value):
+		self.pack('I', self.string(value))
+
+	def write(self, path):
+		with open(path, 'wb') as f:
+			f.write(MAGIC)
+			f.write(struct.pack('<II', VERSION, len(self.strings)))
+			for value in self.strings:
+				encoded = value.encode('utf-8')
+				f.write(struct.pack('<I', len(encoded)))
+				f.write(encoded)
+			f.write(b''.join(self.data))
+
+
+class MapCompiler(object):
+	def __init__(self):
+		self.out = MapWriter()
+		# the namespace of instances is inherited over all layers
+		self.namespace = None
+
+	def compile(self, source, target):
+		root = ET.parse(source).getroot()
+		out = self.out
+
+		out.str(root.get('id'))
+		out.str(root.get('loaderName'))
+		out.pack('I', to_int(root.get('elements')))
+
+		imports = root.findall('import')
+		out.pack('I', len(imports))
+		for imp in imports:
+			out.str(imp.get('file'))
+			out.str(imp.get('dir'))
+
+		layers = [l for l in root.findall('layer') if self.is_valid_layer(l)]
+		out.pack('I', len(layers))
+		for layer in layers:
+			self.compile_layer(layer)
+
+		caches = [c for cs in root.findall('cellcaches') for c in cs.findall('cellcache') if c.get('id')]
+		out.pack('I', len(caches))
+		for cache in caches:
+			self.compile_cellcache(cache)
+
+		triggers = [t for ts in root.findall('triggers') for t in ts.findall('trigger')]
+		out.pack('I', len(triggers))
+		for trigger in triggers:
+			self.compile_trigger(trigger)
+
+		cameras = [c for c in root.findall('camera') if self.is_valid_camera(c)]
+		out.pack('I', len(cameras))
+		for camera in cameras:
+			self.compile_camera(camera)
+
+		out.pack('I', END)
+		out.write(target)
+
+	@staticmethod
+	def is_valid_layer(layer):
+		required = ('x_offset', 'y_offset', 'x_scale', 'y_scale', 'rotation', 'id', 'pathing', 'grid_type')
+		return all(layer.get(attr) is not None for attr in required)
+
+	def compile_layer(self, layer):
+		out = self.out
+		out.str(layer.get('id'))
+		out.str(layer.get('grid_type'))
+		out.pack('7d',
+			to_float(layer.get('x_offset')), to_float(layer.get('y_offset')), to_float(layer.get('z_offset')),
+			to_float(layer.get('x_scale'), 1.0), to_float(layer.get('y_scale'), 1.0), to_float(layer.get('z_scale'), 1.0),
+			to_float(layer.get('rotation')))
+		out.pack('BBB', PATHING.get(layer.get('pathing'), 0), SORTING.get(layer.get('sorting'), 0),
+			LAYER_TYPE.get(layer.get('layer_type'), 0))
+		out.str(layer.get('layer_type_id') if layer.get('layer_type') == 'interact' else None)
+
+		objects = []
+		object_index = {}
+		records = []
+		curr_x, curr_y = 0.0, 0.0
+		for instances in layer.findall('instances'):
+			for inst in instances.findall('i'):
+				object_id = inst.get('o') or inst.get('object') or inst.get('obj')
+				namespace = inst.get('ns') or inst.get('namespace')
+
+				# like MapLoader, entries without an object still advance the implicit position
+				x = inst.get('x')
+				if x is not None:
+					curr_x = to_float(x)
+				else:
+					curr_x += 1
+				y = inst.get('y')
+				if y is not None:
+					curr_y = to_float(y)
+
+				if object_id is None:
+					continue
+				if namespace is not None:
+					self.namespace = namespace
+
+				key = (self.namespace or '', object_id)
+				if key not in object_index:
+					object_index[key] = len(objects)
+					objects.append(key)
+
+				flags = 0
+				rotation = inst.get('r', inst.get('rotation'))
+				if rotation is not None:
+					flags |= INSTANCE_ROTATION
+				if inst.get('stackpos') is not None:
+					flags |= INSTANCE_STACKPOS
+				if inst.get('cellstack') is not None:
+					flags |= INSTANCE_CELLSTACK
+				cost_id = inst.get('cost_id')
+				if cost_id is not None and inst.get('cost') is not None:
+					flags |= INSTANCE_COST
+				else:
+					cost_id = None
+				records.append((object_index[key], inst.get('id'), curr_x, curr_y, to_float(inst.get('z')),
+					to_int(rotation), to_int(inst.get('stackpos')), cost_id, to_float(inst.get('cost')),
+					to_int(inst.get('cellstack')) & 0xFF, flags))
+
+		out.pack('I', len(objects))
+		for namespace, object_id in objects:
+			out.str(namespace)
+			out.str(object_id)
+		out.pack('I', len(records))
+		for (obj, inst_id, x, y, z, rotation, stackpos, cost_id, cost, cellstack, flags) in records:
+			out.pack('II3diiIdBBH', obj, out.string(inst_id), x, y, z, rotation, stackpos,
+				out.string(cost_id), cost, cellstack, flags, 0)
+
+	def compile_cellcache(self, cache):
+		out = self.out
+		out.str(cache.get('id'))
+		out.pack('ddB', to_float(cache.get('default_cost'), 1.0), to_float(cache.get('default_speed'), 1.0),
+			1 if to_int(cache.get('search_narrow')) != 0 else 0)
+
+		cells = [c for c in cache.findall('cell') if c.get('x') is not None and c.get('y') is not None]
+		out.pack('I', len(cells))
+		for cell in cells:
+			flags = 0
+			values = []
+			if cell.get('default_cost') is not None:
+				flags |= CELL_COST
+				values.append(to_float(cell.get('default_cost'), 1.0))
+			if cell.get('default_speed') is not None:
+				flags |= CELL_SPEED
+				values.append(to_float(cell.get('default_speed'), 1.0))
+			if to_int(cell.get('narrow')) != 0:
+				flags |= CELL_NARROW
+			out.pack('iiBB', to_int(cell.get('x')), to_int(cell.get('y')), flags,
+				CELL_BLOCKER.get(cell.get('blocker_type'), 0))
+			for value in values:
+				out.pack('d', value)
+
+			costs = [c for c in cell.findall('cost') if c.get('id') is not None and c.get('value') is not None]
+			out.pack('I', len(costs))
+			for cost in costs:
+				out.str(cost.get('id'))
+				out.pack('d', to_float(cost.get('value'), 1.0))
+
+			areas = [a for a in cell.findall('area') if a.get('id') is not None]
+			out.pack('I', len(areas))
+			for area in areas:
+				out.str(area.get('id'))
+
+			transitions = [t for t in cell.findall('transition') if t.get('x') is not None and t.get('y') is not None]
+			out.pack('I', len(transitions))
+			for transition in transitions:
+				out.str(transition.get('id'))
+				out.pack('iiiB', to_int(transition.get('x')), to_int(transition.get('y')), to_int(transition.get('z')),
+					1 if to_int(transition.get('immediate')) != 0 else 0)
+
+	def compile_trigger(self, trigger):
+		out = self.out
+		out.str(trigger.get('name'))
+		out.pack('BB', 1 if to_int(trigger.get('triggered')) > 0 else 0,
+			1 if to_int(trigger.get('all_instances')) > 0 else 0)
+		attached_instance = trigger.get('attached_instance')
+		attached_layer = trigger.get('attached_layer')
+		if attached_instance is None or attached_layer is None:
+			attached_instance, attached_layer = None, None
+		out.str(attached_instance)
+		out.str(attached_layer)
+
+		assigns = [a for a in trigger.findall('assign') if a.get('layer_id') is not None]
+		out.pack('I', len(assigns))
+		for assign in assigns:
+			out.str(assign.get('layer_id'))
+			out.pack('ii', to_int(assign.get('x')), to_int(assign.get('y')))
+
+		enabled = [e for e in trigger.findall('enabled') if e.get('layer_id') is not None and e.get('instance_id') is not None]
+		out.pack('I', len(enabled))
+		for inst in enabled:
+			out.str(inst.get('layer_id'))
+			out.str(inst.get('instance_id'))
+
+		conditions = [to_int(c.get('id'), -1) for c in trigger.findall('condition')]
+		conditions = [c for c in conditions if c != -1]
+		out.pack('I', len(conditions))
+		for condition in conditions:
+			out.pack('i', condition)
+
+	@staticmethod
+	def parse_viewport(camera):
+		viewport = camera.get('viewport')
+		if viewport is None:
+			return None
+		return [to_int(v) for v in viewport.split(',') if v.strip()]
+
+	def is_valid_camera(self, camera):
+		if camera.get('id') is None or camera.get('ref_cell_width') is None or camera.get('ref_cell_height') is None:
+			return False
+		viewport = self.parse_viewport(camera)
+		return viewport is None or len(viewport) == 4
+
+	def compile_camera(self, camera):
+		out = self.out
+		out.str(camera.get('id'))
+		flags = 0
+		if camera.get('ztoy') is not None:
+			flags |= CAMERA_ZTOY
+		viewport = self.parse_viewport(camera)
+		if viewport is not None:
+			flags |= CAMERA_VIEWPORT
+		else:
+			viewport = [0, 0, 0, 0]
+		out.pack('ii3dBd4i', to_int(camera.get('ref_cell_width')), to_int(camera.get('ref_cell_height')),
+			to_float(camera.get('tilt')), to_float(camera.get('zoom'), 1.0), to_float(camera.get('rotation')),
+			flags, to_float(camera.get('ztoy')), *viewport)
+
+
+def main(argv):
+	if len(argv) < 2:
+		print(__doc__)
+		return 1
+	source = argv[1]
+	target = argv[2] if len(argv) > 2 else os.path.splitext(source)[0] + '.bmap'
+	MapCompiler().compile(source, target)
+	print('compiled', source, 'to', target)
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main(sys.argv))